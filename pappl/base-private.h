@@ -105,6 +105,11 @@ typedef ipp_copycb_t ipp_copy_cb_t;
 #    define _papplRWLockRead(obj) fprintf(stderr, "%p/%s: rdlock %p(%s)\n", (void *)pthread_self(), __func__, (void *)obj, obj->name), pthread_rwlock_rdlock(&obj->rwlock)
 #    define _papplRWLockWrite(obj) fprintf(stderr, "%p/%s: wrlock %p(%s)\n", (void *)pthread_self(), __func__, (void *)obj, obj->name), pthread_rwlock_wrlock(&obj->rwlock)
 #    define _papplRWUnlock(obj) fprintf(stderr, "%p/%s: unlock %p(%s)\n", (void *)pthread_self(), __func__, (void *)obj, obj->name), pthread_rwlock_unlock(&obj->rwlock)
+#  elif defined(PAPPL_LOCK_PROFILE)
+#    define _PAPPL_DEBUG(...)
+#    define _papplRWLockRead(obj) _papplLockProfileAcquire(&obj->rwlock, false, #obj, __FILE__, __LINE__, __func__)
+#    define _papplRWLockWrite(obj) _papplLockProfileAcquire(&obj->rwlock, true, #obj, __FILE__, __LINE__, __func__)
+#    define _papplRWUnlock(obj) _papplLockProfileRelease(&obj->rwlock)
 #  else
 #    define _PAPPL_DEBUG(...)
 #    define _papplRWLockRead(obj) pthread_rwlock_rdlock(&obj->rwlock)
@@ -156,5 +161,10 @@ extern const char	*_papplLookupString(unsigned bit, size_t num_strings, const ch
 extern size_t		_papplLookupStrings(unsigned value, size_t max_keywords, char *keywords[], size_t num_strings, const char * const *strings) _PAPPL_PRIVATE;
 extern unsigned		_papplLookupValue(const char *keyword, size_t num_strings, const char * const *strings) _PAPPL_PRIVATE;
 
+#  ifdef PAPPL_LOCK_PROFILE
+extern int		_papplLockProfileAcquire(pthread_rwlock_t *rwlock, bool write, const char *lock, const char *file, int line, const char *func) _PAPPL_PRIVATE;
+extern int		_papplLockProfileRelease(pthread_rwlock_t *rwlock) _PAPPL_PRIVATE;
+#  endif // PAPPL_LOCK_PROFILE
+
 
 #endif // !_PAPPL_BASE_PRIVATE_H_
@@ -96,14 +96,20 @@ papplClientGetHostPort(
 //
 // This function returns the HTTP connection associated with the client and is
 // used when sending response data directly to the client using the CUPS
-// `httpXxx` functions.
+// `httpXxx` functions.  Any HTML that has been buffered by the
+// `papplClientHTML` functions is sent first.
 //
 
 http_t *				// O - HTTP connection
 papplClientGetHTTP(
     pappl_client_t *client)		// I - Client
 {
-  return (client ? client->http : NULL);
+  if (!client)
+    return (NULL);
+
+  _papplClientFlushHTML(client);
+
+  return (client->http);
 }
 
 
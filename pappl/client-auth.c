@@ -40,12 +40,174 @@ typedef struct _pappl_authdata_s	// PAM authentication data
 // Local functions...
 //
 
+static int	auth_cache_compare(_pappl_authcache_t *a, _pappl_authcache_t *b);
+static void	auth_cache_hash(pappl_system_t *system, const char *username, const char *password, unsigned char *hash);
 static int	pappl_authenticate_user(pappl_client_t *client, const char *username, const char *password);
+static int	pappl_get_groups(pappl_client_t *client, const char *username, gid_t *groups, int max_groups);
 #ifdef HAVE_LIBPAM
 static int	pappl_pam_func(int num_msg, const struct pam_message **msg, struct pam_response **resp, _pappl_authdata_t *data);
 #endif // HAVE_LIBPAM
 
 
+//
+// '_papplAuthCacheAdd()' - Add a successful authentication to the cache.
+//
+
+void
+_papplAuthCacheAdd(
+    pappl_system_t *system,		// I - System
+    const char     *username,		// I - Username string
+    const char     *password,		// I - Password string
+    int            num_groups,		// I - Number of groups
+    const gid_t    *groups)		// I - Group IDs
+{
+  _pappl_authcache_t	key,		// Search key
+			*entry,		// Cache entry
+			*current;	// Current entry
+  size_t		i;		// Looping var
+
+
+  pthread_mutex_lock(&system->auth_mutex);
+
+  if (!system->auth_cache)
+  {
+    // Create the cache with a random salt so the hashes are unique to this
+    // process...
+    if ((system->auth_cache = cupsArrayNew((cups_array_cb_t)auth_cache_compare, NULL, NULL, 0, NULL, (cups_afree_cb_t)free)) == NULL)
+    {
+      pthread_mutex_unlock(&system->auth_mutex);
+      return;
+    }
+
+    for (i = 0; i < sizeof(system->auth_salt); i ++)
+      system->auth_salt[i] = (unsigned char)papplGetRand();
+  }
+
+  auth_cache_hash(system, username, password, key.hash);
+
+  if ((entry = (_pappl_authcache_t *)cupsArrayFind(system->auth_cache, &key)) == NULL)
+  {
+    if (cupsArrayGetCount(system->auth_cache) >= _PAPPL_AUTH_CACHE_MAX)
+    {
+      // Remove the least recently used entry...
+      for (entry = current = (_pappl_authcache_t *)cupsArrayGetFirst(system->auth_cache); current; current = (_pappl_authcache_t *)cupsArrayGetNext(system->auth_cache))
+      {
+        if (current->used < entry->used)
+          entry = current;
+      }
+
+      cupsArrayRemove(system->auth_cache, entry);
+      system->ametrics.evictions ++;
+    }
+
+    if ((entry = (_pappl_authcache_t *)calloc(1, sizeof(_pappl_authcache_t))) == NULL)
+    {
+      pthread_mutex_unlock(&system->auth_mutex);
+      return;
+    }
+
+    memcpy(entry->hash, key.hash, sizeof(entry->hash));
+    cupsArrayAdd(system->auth_cache, entry);
+  }
+
+  if (num_groups > (int)(sizeof(entry->groups) / sizeof(entry->groups[0])))
+    num_groups = (int)(sizeof(entry->groups) / sizeof(entry->groups[0]));
+
+  entry->expires    = time(NULL) + _PAPPL_AUTH_CACHE_TTL;
+  entry->used       = ++ system->auth_uses;
+  entry->num_groups = num_groups;
+  memcpy(entry->groups, groups, (size_t)num_groups * sizeof(gid_t));
+
+  pthread_mutex_unlock(&system->auth_mutex);
+}
+
+
+//
+// '_papplAuthCacheCopyMetrics()' - Copy the authentication cache metrics.
+//
+
+void
+_papplAuthCacheCopyMetrics(
+    pappl_system_t   *system,		// I - System
+    pappl_ametrics_t *metrics)		// O - Metrics
+{
+  pthread_mutex_lock(&system->auth_mutex);
+  *metrics         = system->ametrics;
+  metrics->entries = (size_t)cupsArrayGetCount(system->auth_cache);
+  pthread_mutex_unlock(&system->auth_mutex);
+}
+
+
+//
+// '_papplAuthCacheFind()' - Find a cached authentication.
+//
+
+int					// O - Number of groups or `-1` if not cached
+_papplAuthCacheFind(
+    pappl_system_t *system,		// I - System
+    const char     *username,		// I - Username string
+    const char     *password,		// I - Password string
+    gid_t          *groups)		// O - Group IDs
+{
+  _pappl_authcache_t	key,		// Search key
+			*entry;		// Cache entry
+  int			num_groups = -1;// Number of groups
+
+
+  pthread_mutex_lock(&system->auth_mutex);
+
+  if (system->auth_cache)
+  {
+    auth_cache_hash(system, username, password, key.hash);
+
+    if ((entry = (_pappl_authcache_t *)cupsArrayFind(system->auth_cache, &key)) != NULL)
+    {
+      if (entry->expires > time(NULL))
+      {
+        num_groups  = entry->num_groups;
+        entry->used = ++ system->auth_uses;
+        memcpy(groups, entry->groups, (size_t)num_groups * sizeof(gid_t));
+      }
+      else
+      {
+        // Expired, authenticate again...
+        cupsArrayRemove(system->auth_cache, entry);
+      }
+    }
+  }
+
+  if (num_groups < 0)
+    system->ametrics.misses ++;
+  else
+    system->ametrics.hits ++;
+
+  pthread_mutex_unlock(&system->auth_mutex);
+
+  return (num_groups);
+}
+
+
+//
+// '_papplAuthCacheFlush()' - Invalidate all cached authentications.
+//
+// This function is called when the admin or print groups change so that group
+// membership is checked again.
+//
+
+void
+_papplAuthCacheFlush(
+    pappl_system_t *system)		// I - System
+{
+  pthread_mutex_lock(&system->auth_mutex);
+  if (cupsArrayGetCount(system->auth_cache) > 0)
+  {
+    cupsArrayClear(system->auth_cache);
+    system->ametrics.flushes ++;
+  }
+  pthread_mutex_unlock(&system->auth_mutex);
+}
+
+
 //
 // 'papplClientIsAuthorized()' - Determine whether a client is authorized for
 //                               administrative requests.
@@ -120,17 +282,9 @@ _papplClientIsAuthorizedForGroup(
 		*password;		// Password value
       cups_len_t userlen = sizeof(username);
 					// Length of username:password
-#if !_WIN32
-      struct passwd *user,		// User information
-		udata;			// User data
-      char	ubuffer[16384];		// User strings
-      int	num_groups;		// Number of autbenticated groups, if any
-#  ifdef __APPLE__
-      int	groups[32];		// Authenticated groups, if any
-#  else
+      int	i,			// Looping var
+		num_groups;		// Number of authenticated groups, if any
       gid_t	groups[32];		// Authenticated groups, if any
-#  endif // __APPLE__
-#endif // !_WIN32
 
       for (authorization += 6; *authorization && isspace(*authorization & 255); authorization ++)
         ;				// Skip whitespace
@@ -140,71 +294,56 @@ _papplClientIsAuthorizedForGroup(
       {
 	*password++ = '\0';
 
-        // Authenticate the username and password...
-	if (pappl_authenticate_user(client, username, password))
-	{
-	  // Return now if there is no group for authorization...
-	  if (!group)
-	    return (HTTP_STATUS_CONTINUE);
-
-#if _WIN32
-	  // No groups in stock Windows support...
-          return (HTTP_STATUS_CONTINUE);
-
-#else
-	  // Get the user information (groups, etc.)
-	  if (!getpwnam_r(username, &udata, ubuffer, sizeof(ubuffer), &user) && user)
+        // Use a recent authentication of the same username and password, if
+        // any, since PAM and group lookups can be slow...
+        if ((num_groups = _papplAuthCacheFind(client->system, username, password, groups)) < 0)
+        {
+          // Authenticate the username and password...
+	  if (!pappl_authenticate_user(client, username, password))
 	  {
-	    papplLogClient(client, PAPPL_LOGLEVEL_INFO, "Authenticated as \"%s\" using Basic.", username);
-	    papplCopyString(client->username, username, sizeof(client->username));
-
-	    num_groups = (int)(sizeof(groups) / sizeof(groups[0]));
-
-#  ifdef __APPLE__
-	    if (getgrouplist(username, (int)user->pw_gid, groups, &num_groups))
-#  else
-	    if (getgrouplist(username, user->pw_gid, groups, &num_groups))
-#  endif // __APPLE__
-	    {
-	      papplLogClient(client, PAPPL_LOGLEVEL_ERROR, "Unable to lookup groups for user '%s': %s", username, strerror(errno));
-	      num_groups = 0;
-	    }
-
-            // Check group membership...
-            if (groupid != (gid_t)-1)
-            {
-              if (user->pw_gid != groupid)
-              {
-                int i;			// Looping var
-
-                for (i = 0; i < num_groups; i ++)
-		{
-		  if ((gid_t)groups[i] == groupid)
-		    break;
-		}
-
-                if (i >= num_groups)
-                {
-                  // Not in the admin group, access is forbidden...
-                  return (HTTP_STATUS_FORBIDDEN);
-		}
-              }
-            }
-
-            // If we get this far, authentication and authorization are good...
-            return (HTTP_STATUS_CONTINUE);
+	    papplLogClient(client, PAPPL_LOGLEVEL_INFO, "Basic authentication of '%s' failed.", username);
+	    return (HTTP_STATUS_UNAUTHORIZED);
 	  }
-	  else
+
+	  // Get the user's groups...
+	  if ((num_groups = pappl_get_groups(client, username, groups, (int)(sizeof(groups) / sizeof(groups[0])))) < 0)
 	  {
+	    // Return now if there is no group for authorization...
+	    if (!group)
+	      return (HTTP_STATUS_CONTINUE);
+
 	    papplLogClient(client, PAPPL_LOGLEVEL_ERROR, "Unable to lookup user '%s'.", username);
 	    return (HTTP_STATUS_SERVER_ERROR);
 	  }
-#endif // _WIN32
+
+	  _papplAuthCacheAdd(client->system, username, password, num_groups, groups);
 	}
-	else
+
+	papplLogClient(client, PAPPL_LOGLEVEL_INFO, "Authenticated as \"%s\" using Basic.", username);
+	papplCopyString(client->username, username, sizeof(client->username));
+
+#if !_WIN32
+	// Check group membership (no groups in stock Windows support)...
+	if (group && groupid != (gid_t)-1)
 	{
-	  papplLogClient(client, PAPPL_LOGLEVEL_INFO, "Basic authentication of '%s' failed.", username);
+	  for (i = 0; i < num_groups; i ++)
+	  {
+	    if (groups[i] == groupid)
+	      break;
+	  }
+
+	  if (i >= num_groups)
+	  {
+	    // Not in the group, access is forbidden...
+	    return (HTTP_STATUS_FORBIDDEN);
+	  }
 	}
+#else
+	(void)i;
+#endif // !_WIN32
+
+	// If we get this far, authentication and authorization are good...
+	return (HTTP_STATUS_CONTINUE);
       }
       else
       {
@@ -224,6 +363,60 @@ _papplClientIsAuthorizedForGroup(
 }
 
 
+//
+// 'auth_cache_compare()' - Compare two authentication cache entries.
+//
+
+static int				// O - Result of comparison
+auth_cache_compare(
+    _pappl_authcache_t *a,		// I - First entry
+    _pappl_authcache_t *b)		// I - Second entry
+{
+  return (memcmp(a->hash, b->hash, sizeof(a->hash)));
+}
+
+
+//
+// 'auth_cache_hash()' - Compute the salted hash of a username and password.
+//
+// The authentication cache mutex must be held when calling this function.
+//
+
+static void
+auth_cache_hash(
+    pappl_system_t *system,		// I - System
+    const char     *username,		// I - Username string
+    const char     *password,		// I - Password string
+    unsigned char  *hash)		// O - SHA2-256 hash (32 bytes)
+{
+  unsigned char	data[1024];		// Data to hash
+  size_t	datalen,		// Length of data
+		userlen = strlen(username),
+					// Length of username
+		passlen = strlen(password);
+					// Length of password
+
+
+  // Credentials are decoded into a 512 byte buffer so they always fit...
+  if ((sizeof(system->auth_salt) + userlen + passlen + 1) > sizeof(data))
+    userlen = passlen = 0;
+
+  memcpy(data, system->auth_salt, sizeof(system->auth_salt));
+  datalen = sizeof(system->auth_salt);
+
+  memcpy(data + datalen, username, userlen);
+  datalen += userlen;
+  data[datalen ++] = ':';
+  memcpy(data + datalen, password, passlen);
+  datalen += passlen;
+
+  cupsHashData("sha2-256", data, datalen, hash, 32);
+
+  // Don't leave the password on the stack...
+  memset(data, 0, sizeof(data));
+}
+
+
 //
 // 'pappl_authenticate_user()' - Validate a username + password combination.
 //
@@ -292,6 +485,79 @@ pappl_authenticate_user(
 }
 
 
+//
+// 'pappl_get_groups()' - Get the groups for a user.
+//
+
+static int				// O - Number of groups or `-1` if the user does not exist
+pappl_get_groups(
+    pappl_client_t *client,		// I - Client
+    const char     *username,		// I - Username string
+    gid_t          *groups,		// O - Group IDs
+    int            max_groups)		// I - Maximum number of groups
+{
+#if _WIN32
+  (void)client;
+  (void)username;
+  (void)groups;
+  (void)max_groups;
+
+  return (0);
+
+#else
+  struct passwd	*user,			// User information
+		udata;			// User data
+  char		ubuffer[16384];		// User strings
+  int		i,			// Looping var
+		num_groups;		// Number of groups
+#  ifdef __APPLE__
+  int		agroups[32];		// Groups from getgrouplist
+#  endif // __APPLE__
+
+
+  if (getpwnam_r(username, &udata, ubuffer, sizeof(ubuffer), &user) || !user)
+    return (-1);
+
+#  ifdef __APPLE__
+  if ((num_groups = max_groups) > (int)(sizeof(agroups) / sizeof(agroups[0])))
+    num_groups = (int)(sizeof(agroups) / sizeof(agroups[0]));
+
+  if (getgrouplist(username, (int)user->pw_gid, agroups, &num_groups))
+#  else
+  num_groups = max_groups;
+
+  if (getgrouplist(username, user->pw_gid, groups, &num_groups))
+#  endif // __APPLE__
+  {
+    papplLogClient(client, PAPPL_LOGLEVEL_ERROR, "Unable to lookup groups for user '%s': %s", username, strerror(errno));
+    num_groups = 0;
+  }
+
+#  ifdef __APPLE__
+  for (i = 0; i < num_groups; i ++)
+    groups[i] = (gid_t)agroups[i];
+#  endif // __APPLE__
+
+  // Make sure the primary group is in the list...
+  for (i = 0; i < num_groups; i ++)
+  {
+    if (groups[i] == user->pw_gid)
+      break;
+  }
+
+  if (i >= num_groups)
+  {
+    if (num_groups >= max_groups)
+      num_groups = max_groups - 1;
+
+    groups[num_groups ++] = user->pw_gid;
+  }
+
+  return (num_groups);
+#endif // _WIN32
+}
+
+
 #ifdef HAVE_LIBPAM
 //
 // 'pappl_pam_func()' - PAM conversation function.
@@ -70,8 +70,13 @@ _papplClientProcessIPP(
   const char		*name;		// Name of attribute
   bool			printer_op = true;
 					// Printer operation?
+  bool			ret = true;	// Return value
+  struct timespec	start;		// Start time for metrics
 
 
+  if (client->system->metrics)
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
   // First build an empty response message for this request...
   client->operation_id = ippGetOperation(client->request);
   client->response     = ippNewResponse(client->request);
@@ -246,9 +251,12 @@ _papplClientProcessIPP(
   }
 
   if (httpGetState(client->http) != HTTP_STATE_WAITING)
-    return (papplClientRespond(client, HTTP_STATUS_OK, NULL, "application/ipp", 0, ippGetLength(client->response)));
-  else
-    return (true);
+    ret = papplClientRespond(client, HTTP_STATUS_OK, NULL, "application/ipp", 0, ippGetLength(client->response));
+
+  if (client->system->metrics)
+    _papplMetricsAddRequest(client, op, &start);
+
+  return (ret);
 }
 
 
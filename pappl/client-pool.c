@@ -0,0 +1,605 @@
+//
+// Client worker pool for the Printer Application Framework
+//
+// Copyright © 2023 by Michael R Sweet.
+//
+// Licensed under Apache License v2.0.  See the file "LICENSE" for more
+// information.
+//
+// The worker pool replaces the default thread-per-connection model when the
+// `PAPPL_SOPTIONS_WORKER_POOL` system option is set.  A single reactor thread
+// watches idle keep-alive connections using epoll and queues connections with
+// pending requests for a fixed number of worker threads.  Each worker
+// processes the request(s) that are ready and then hands the connection back
+// to the reactor.
+//
+// When the request queue is full, the reactor never blocks.  Ready
+// connections are deferred until a worker takes a request from the queue, and
+// the main loop stops accepting new connections until there is space again.
+//
+
+//
+// Include necessary headers...
+//
+
+#include "pappl-private.h"
+#ifdef HAVE_SYS_EPOLL_H
+#  include <sys/epoll.h>
+
+
+//
+// Local types...
+//
+
+typedef struct _pappl_pool_item_s	// Queued client request
+{
+  pappl_client_t	*client;		// Client connection
+  struct timespec	queued;			// Time request was queued
+} _pappl_pool_item_t;
+
+struct _pappl_pool_s			// Client worker pool
+{
+  pappl_system_t	*system;		// Containing system
+  pthread_mutex_t	mutex;			// Mutex for queue and idle list
+  pthread_cond_t	work_cond;		// Condition for queued work
+  int			epfd;			// epoll file descriptor
+  pthread_t		reactor;		// Reactor thread
+  size_t		num_workers;		// Number of worker threads
+  pthread_t		*workers;		// Worker threads
+  size_t		max_queue,		// Maximum number of queued requests
+			num_queue,		// Number of queued requests
+			first_queue;		// Index of first queued request
+  _pappl_pool_item_t	*queue;			// Request queue
+  cups_array_t		*idle,			// Idle (keep-alive) clients
+			*deferred;		// Ready clients waiting for queue space
+  bool			stopping;		// Is the pool stopping?
+};
+
+
+//
+// Local functions...
+//
+
+static bool	pool_idle_client(_pappl_pool_t *pool, pappl_client_t *client, int op);
+static void	pool_queue_client(_pappl_pool_t *pool, pappl_client_t *client);
+static void	*pool_reactor(_pappl_pool_t *pool);
+static void	*pool_worker(_pappl_pool_t *pool);
+
+
+//
+// '_papplClientPoolAdd()' - Add a newly accepted client to the worker pool.
+//
+// The client is parked in the reactor until the first request arrives.
+//
+
+bool					// O - `true` on success, `false` on error
+_papplClientPoolAdd(
+    pappl_system_t *system,		// I - System
+    pappl_client_t *client)		// I - Client
+{
+  _pappl_pool_t	*pool = system->pool;	// Worker pool
+  bool		ret;			// Return value
+
+
+  if (!pool)
+    return (false);
+
+  pthread_mutex_lock(&pool->mutex);
+  ret = !pool->stopping && pool_idle_client(pool, client, EPOLL_CTL_ADD);
+  pthread_mutex_unlock(&pool->mutex);
+
+  return (ret);
+}
+
+
+//
+// '_papplClientPoolCopyMetrics()' - Copy the client connection metrics.
+//
+// The system read lock must be held by the caller.
+//
+
+void
+_papplClientPoolCopyMetrics(
+    pappl_system_t   *system,		// I - System
+    pappl_cmetrics_t *metrics)		// I - Buffer for metrics data
+{
+  _pappl_pool_t	*pool = system->pool;	// Worker pool
+
+
+  if (pool)
+    pthread_mutex_lock(&pool->mutex);
+
+  memcpy(metrics, &system->cmetrics, sizeof(pappl_cmetrics_t));
+
+  if (pool)
+    pthread_mutex_unlock(&pool->mutex);
+}
+
+
+//
+// '_papplClientPoolIsFull()' - Determine whether the request queue is full.
+//
+// The main loop uses this to stop accepting new connections while all workers
+// are busy and the request queue is full.
+//
+
+bool					// O - `true` if full, `false` otherwise
+_papplClientPoolIsFull(
+    pappl_system_t *system)		// I - System
+{
+  _pappl_pool_t	*pool = system->pool;	// Worker pool
+  bool		ret;			// Return value
+
+
+  if (!pool)
+    return (false);
+
+  pthread_mutex_lock(&pool->mutex);
+  ret = pool->num_queue >= pool->max_queue;
+  pthread_mutex_unlock(&pool->mutex);
+
+  return (ret);
+}
+
+
+//
+// '_papplClientPoolStart()' - Start the client worker pool.
+//
+
+bool					// O - `true` on success, `false` on error
+_papplClientPoolStart(
+    pappl_system_t *system)		// I - System
+{
+  _pappl_pool_t	*pool;			// Worker pool
+  size_t	i;			// Looping var
+
+
+  if ((pool = calloc(1, sizeof(_pappl_pool_t))) == NULL)
+    return (false);
+
+  pool->system = system;
+  pool->epfd   = -1;
+
+  pthread_mutex_init(&pool->mutex, NULL);
+  pthread_cond_init(&pool->work_cond, NULL);
+
+  _papplRWLockRead(system);
+  pool->num_workers = system->pool_workers;
+  pool->max_queue   = system->pool_queue;
+  _papplRWUnlock(system);
+
+  if ((pool->workers = calloc(pool->num_workers, sizeof(pthread_t))) == NULL || (pool->queue = calloc(pool->max_queue, sizeof(_pappl_pool_item_t))) == NULL || (pool->idle = cupsArrayNew(NULL, NULL, NULL, 0, NULL, NULL)) == NULL || (pool->deferred = cupsArrayNew(NULL, NULL, NULL, 0, NULL, NULL)) == NULL)
+  {
+    papplLog(system, PAPPL_LOGLEVEL_ERROR, "Unable to allocate memory for client worker pool: %s", strerror(errno));
+    goto error;
+  }
+
+  if ((pool->epfd = epoll_create1(EPOLL_CLOEXEC)) < 0)
+  {
+    papplLog(system, PAPPL_LOGLEVEL_ERROR, "Unable to create client reactor: %s", strerror(errno));
+    goto error;
+  }
+
+  if (pthread_create(&pool->reactor, NULL, (void *(*)(void *))pool_reactor, pool))
+  {
+    papplLog(system, PAPPL_LOGLEVEL_ERROR, "Unable to create client reactor thread: %s", strerror(errno));
+    goto error;
+  }
+
+  for (i = 0; i < pool->num_workers; i ++)
+  {
+    if (pthread_create(pool->workers + i, NULL, (void *(*)(void *))pool_worker, pool))
+    {
+      papplLog(system, PAPPL_LOGLEVEL_ERROR, "Unable to create client worker thread: %s", strerror(errno));
+      break;
+    }
+  }
+
+  pool->num_workers = i;
+
+  _papplRWLockWrite(system);
+  system->pool = pool;
+  _papplRWUnlock(system);
+
+  if (i == 0)
+  {
+    // No workers, shut everything down and use a thread per connection...
+    _papplClientPoolStop(system);
+    return (false);
+  }
+
+  papplLog(system, PAPPL_LOGLEVEL_INFO, "Started client worker pool with %u workers and a queue depth of %u.", (unsigned)pool->num_workers, (unsigned)pool->max_queue);
+
+  return (true);
+
+  // If we get here something went wrong...
+  error:
+
+  if (pool->epfd >= 0)
+    close(pool->epfd);
+
+  cupsArrayDelete(pool->idle);
+  cupsArrayDelete(pool->deferred);
+  free(pool->queue);
+  free(pool->workers);
+
+  pthread_mutex_destroy(&pool->mutex);
+  pthread_cond_destroy(&pool->work_cond);
+
+  free(pool);
+
+  return (false);
+}
+
+
+//
+// '_papplClientPoolStop()' - Stop the client worker pool.
+//
+// Workers finish any requests in progress, then all remaining idle and queued
+// connections are closed.
+//
+
+void
+_papplClientPoolStop(
+    pappl_system_t *system)		// I - System
+{
+  _pappl_pool_t		*pool = system->pool;
+					// Worker pool
+  size_t		i;		// Looping var
+  pappl_client_t	*client;	// Current client
+
+
+  if (!pool)
+    return;
+
+  pthread_mutex_lock(&pool->mutex);
+  pool->stopping = true;
+  pthread_cond_broadcast(&pool->work_cond);
+  pthread_mutex_unlock(&pool->mutex);
+
+  pthread_join(pool->reactor, NULL);
+
+  for (i = 0; i < pool->num_workers; i ++)
+    pthread_join(pool->workers[i], NULL);
+
+  _papplRWLockWrite(system);
+  system->pool = NULL;
+  _papplRWUnlock(system);
+
+  // Close any remaining connections...
+  for (client = (pappl_client_t *)cupsArrayGetFirst(pool->idle); client; client = (pappl_client_t *)cupsArrayGetNext(pool->idle))
+    _papplClientDelete(client);
+
+  for (client = (pappl_client_t *)cupsArrayGetFirst(pool->deferred); client; client = (pappl_client_t *)cupsArrayGetNext(pool->deferred))
+    _papplClientDelete(client);
+
+  for (i = 0; i < pool->num_queue; i ++)
+    _papplClientDelete(pool->queue[(pool->first_queue + i) % pool->max_queue].client);
+
+  close(pool->epfd);
+
+  cupsArrayDelete(pool->idle);
+  cupsArrayDelete(pool->deferred);
+  free(pool->queue);
+  free(pool->workers);
+
+  pthread_mutex_destroy(&pool->mutex);
+  pthread_cond_destroy(&pool->work_cond);
+
+  free(pool);
+
+  papplLog(system, PAPPL_LOGLEVEL_INFO, "Stopped client worker pool.");
+}
+
+
+//
+// 'pool_idle_client()' - Park a client in the reactor until it is readable.
+//
+// The pool mutex must be held by the caller.
+//
+
+static bool				// O - `true` on success, `false` on error
+pool_idle_client(
+    _pappl_pool_t  *pool,		// I - Worker pool
+    pappl_client_t *client,		// I - Client
+    int            op)			// I - `EPOLL_CTL_ADD` or `EPOLL_CTL_MOD`
+{
+  struct epoll_event	event;		// Event data
+
+
+  client->idle_time = time(NULL);
+
+  event.events   = EPOLLIN | EPOLLRDHUP | EPOLLONESHOT;
+  event.data.ptr = client;
+
+  if (epoll_ctl(pool->epfd, op, httpGetFd(client->http), &event))
+  {
+    papplLogClient(client, PAPPL_LOGLEVEL_ERROR, "Unable to add connection to client reactor: %s", strerror(errno));
+    return (false);
+  }
+
+  cupsArrayAdd(pool->idle, client);
+  pool->system->cmetrics.idle_clients = (size_t)cupsArrayGetCount(pool->idle);
+
+  return (true);
+}
+
+
+//
+// 'pool_queue_client()' - Queue a ready client for the workers.
+//
+// If the request queue is full, the client is deferred until a worker takes
+// a request from the queue.  The pool mutex must be held by the caller.
+//
+
+static void
+pool_queue_client(
+    _pappl_pool_t  *pool,		// I - Worker pool
+    pappl_client_t *client)		// I - Client
+{
+  pappl_system_t	*system = pool->system;
+					// System
+  _pappl_pool_item_t	*item;		// Queued request
+
+
+  if (pool->num_queue >= pool->max_queue)
+  {
+    cupsArrayAdd(pool->deferred, client);
+    system->cmetrics.deferred ++;
+    return;
+  }
+
+  item = pool->queue + (pool->first_queue + pool->num_queue) % pool->max_queue;
+  item->client = client;
+  clock_gettime(CLOCK_MONOTONIC, &item->queued);
+
+  pool->num_queue ++;
+
+  system->cmetrics.requests ++;
+  if (pool->num_queue > system->cmetrics.max_queued)
+    system->cmetrics.max_queued = pool->num_queue;
+
+  pthread_cond_signal(&pool->work_cond);
+}
+
+
+//
+// 'pool_reactor()' - Watch idle connections and queue ready requests.
+//
+
+static void *				// O - Thread exit status
+pool_reactor(_pappl_pool_t *pool)	// I - Worker pool
+{
+  pappl_system_t	*system = pool->system;
+					// System
+  struct epoll_event	events[64];	// Ready connections
+  int			i,		// Looping var
+			nevents;	// Number of ready connections
+  pappl_client_t	*client;	// Current client
+  cups_array_t		*expired;	// Expired connections
+  time_t		curtime,	// Current time
+			expire_time = 0;// Next idle check time
+
+
+  expired = cupsArrayNew(NULL, NULL, NULL, 0, NULL, NULL);
+
+  for (;;)
+  {
+    // Wait up to 1 second for a request so we can notice shutdowns and
+    // expire idle connections...
+    if ((nevents = epoll_wait(pool->epfd, events, (int)(sizeof(events) / sizeof(events[0])), 1000)) < 0 && errno != EINTR)
+    {
+      papplLog(system, PAPPL_LOGLEVEL_ERROR, "Unable to wait for client requests: %s", strerror(errno));
+      break;
+    }
+
+    pthread_mutex_lock(&pool->mutex);
+
+    if (pool->stopping)
+    {
+      pthread_mutex_unlock(&pool->mutex);
+      break;
+    }
+
+    // Queue any connections that are ready (the EPOLLONESHOT flag keeps the
+    // kernel from reporting them again until a worker re-arms them)...
+    for (i = 0; i < nevents; i ++)
+    {
+      client = (pappl_client_t *)events[i].data.ptr;
+
+      cupsArrayRemove(pool->idle, client);
+      pool_queue_client(pool, client);
+    }
+
+    // Expire connections that have been idle for too long...
+    if ((curtime = time(NULL)) >= expire_time)
+    {
+      for (client = (pappl_client_t *)cupsArrayGetFirst(pool->idle); client; client = (pappl_client_t *)cupsArrayGetNext(pool->idle))
+      {
+        if ((curtime - client->idle_time) >= _PAPPL_POOL_TIMEOUT)
+        {
+          epoll_ctl(pool->epfd, EPOLL_CTL_DEL, httpGetFd(client->http), NULL);
+          cupsArrayRemove(pool->idle, client);
+          cupsArrayAdd(expired, client);
+        }
+      }
+
+      expire_time = curtime + 1;
+    }
+
+    system->cmetrics.idle_clients = (size_t)cupsArrayGetCount(pool->idle);
+    system->cmetrics.queued       = pool->num_queue;
+
+    pthread_mutex_unlock(&pool->mutex);
+
+    // Close expired connections outside the pool lock...
+    for (client = (pappl_client_t *)cupsArrayGetFirst(expired); client; client = (pappl_client_t *)cupsArrayGetNext(expired))
+      _papplClientDelete(client);
+
+    cupsArrayClear(expired);
+  }
+
+  cupsArrayDelete(expired);
+
+  return (NULL);
+}
+
+
+//
+// 'pool_worker()' - Process queued client requests.
+//
+
+static void *				// O - Thread exit status
+pool_worker(_pappl_pool_t *pool)	// I - Worker pool
+{
+  pappl_system_t	*system = pool->system;
+					// System
+  pappl_client_t	*client,	// Current client
+			*deferred;	// Deferred client
+  _pappl_pool_item_t	*item;		// Queued request
+  struct timespec	curtime,	// Current time
+			queued;		// Time request was queued
+  size_t		msecs;		// Milliseconds in the queue
+  bool			keep,		// Keep the connection open?
+			stopping;	// Is the pool stopping?
+
+
+  pthread_mutex_lock(&pool->mutex);
+
+  for (;;)
+  {
+    while (pool->num_queue == 0 && !pool->stopping)
+      pthread_cond_wait(&pool->work_cond, &pool->mutex);
+
+    if (pool->stopping)
+      break;
+
+    // Take the next request from the queue...
+    item   = pool->queue + pool->first_queue;
+    client = item->client;
+    queued = item->queued;
+
+    pool->first_queue = (pool->first_queue + 1) % pool->max_queue;
+    pool->num_queue --;
+
+    // Then queue the oldest deferred client, if any...
+    if ((deferred = (pappl_client_t *)cupsArrayGetFirst(pool->deferred)) != NULL)
+    {
+      cupsArrayRemove(pool->deferred, deferred);
+      pool_queue_client(pool, deferred);
+    }
+
+    // Update metrics...
+    clock_gettime(CLOCK_MONOTONIC, &curtime);
+    msecs = (size_t)((curtime.tv_sec - queued.tv_sec) * 1000 + (curtime.tv_nsec - queued.tv_nsec) / 1000000);
+
+    system->cmetrics.queue_msecs += msecs;
+    if (msecs > system->cmetrics.max_queue_msecs)
+      system->cmetrics.max_queue_msecs = msecs;
+
+    system->cmetrics.queued = pool->num_queue;
+    system->cmetrics.active_workers ++;
+    if (system->cmetrics.active_workers > system->cmetrics.max_active_workers)
+      system->cmetrics.max_active_workers = system->cmetrics.active_workers;
+
+    pthread_mutex_unlock(&pool->mutex);
+
+    // Process the request plus any pipelined/buffered requests that follow...
+    do
+    {
+      keep = _papplClientProcessRequest(client);
+
+      pthread_mutex_lock(&pool->mutex);
+      stopping = pool->stopping;
+      pthread_mutex_unlock(&pool->mutex);
+    }
+    while (keep && !stopping && httpGetReady(client->http));
+
+    // Then hand the connection back to the reactor or close it...
+    pthread_mutex_lock(&pool->mutex);
+
+    system->cmetrics.active_workers --;
+
+    if (keep && !pool->stopping && pool_idle_client(pool, client, EPOLL_CTL_MOD))
+      continue;
+
+    pthread_mutex_unlock(&pool->mutex);
+    _papplClientDelete(client);
+    pthread_mutex_lock(&pool->mutex);
+  }
+
+  pthread_mutex_unlock(&pool->mutex);
+
+  return (NULL);
+}
+
+
+#else
+//
+// '_papplClientPoolAdd()' - Add a newly accepted client to the worker pool.
+//
+
+bool					// O - `false` (not supported)
+_papplClientPoolAdd(
+    pappl_system_t *system,		// I - System
+    pappl_client_t *client)		// I - Client
+{
+  (void)system;
+  (void)client;
+
+  return (false);
+}
+
+
+//
+// '_papplClientPoolCopyMetrics()' - Copy the client connection metrics.
+//
+
+void
+_papplClientPoolCopyMetrics(
+    pappl_system_t   *system,		// I - System
+    pappl_cmetrics_t *metrics)		// I - Buffer for metrics data
+{
+  memcpy(metrics, &system->cmetrics, sizeof(pappl_cmetrics_t));
+}
+
+
+//
+// '_papplClientPoolIsFull()' - Determine whether the request queue is full.
+//
+
+bool					// O - `false` (not supported)
+_papplClientPoolIsFull(
+    pappl_system_t *system)		// I - System
+{
+  (void)system;
+
+  return (false);
+}
+
+
+//
+// '_papplClientPoolStart()' - Start the client worker pool.
+//
+
+bool					// O - `false` (not supported)
+_papplClientPoolStart(
+    pappl_system_t *system)		// I - System
+{
+  (void)system;
+
+  return (false);
+}
+
+
+//
+// '_papplClientPoolStop()' - Stop the client worker pool.
+//
+
+void
+_papplClientPoolStop(
+    pappl_system_t *system)		// I - System
+{
+  (void)system;
+}
+#endif // HAVE_SYS_EPOLL_H
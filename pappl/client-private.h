@@ -13,6 +13,14 @@
 #  include "base-private.h"
 #  include "client.h"
 #  include "log.h"
+#  include "system.h"
+
+
+//
+// Constants...
+//
+
+#  define _PAPPL_CLIENT_HTML_BUFSIZE 32768	// Size of HTML output buffer
 
 
 //
@@ -25,6 +33,8 @@ struct _pappl_client_s			// Client data
   int			number;			// Connection number
   pthread_t		thread_id;		// Thread ID
   http_t		*http;			// HTTP connection
+  bool			tls_checked;		// Checked for a TLS handshake?
+  time_t		idle_time;		// Time connection became idle (worker pool)
   ipp_t			*request,		// IPP request
 			*response;		// IPP response
   time_t		start;			// Request start time
@@ -44,6 +54,14 @@ struct _pappl_client_s			// Client data
   pappl_loc_t		*loc;			// Localization, if any
   int			num_files;		// Number of temporary files
   char			*files[10];		// Temporary files
+  char			*html_buffer;		// HTML output buffer
+  size_t		html_bufused,		// Bytes in HTML output buffer
+			html_flushes,		// Number of HTML output buffer flushes
+			html_bytes;		// Number of HTML bytes sent
+  char			*html_capture;		// HTML capture buffer, if any
+  size_t		html_capsize,		// Size of HTML capture buffer
+			html_caplen;		// Length of captured HTML
+  bool			html_caperror;		// Error while capturing HTML?
 };
 
 
@@ -51,18 +69,28 @@ struct _pappl_client_s			// Client data
 // Functions...
 //
 
+extern bool		_papplClientCheckIfModified(pappl_client_t *client, time_t last_modified) _PAPPL_PRIVATE;
 extern void		_papplClientCleanTempFiles(pappl_client_t *client) _PAPPL_PRIVATE;
 extern pappl_client_t	*_papplClientCreate(pappl_system_t *system, int sock) _PAPPL_PRIVATE;
 extern char		*_papplClientCreateTempFile(pappl_client_t *client, const void *data, size_t datasize) _PAPPL_PRIVATE;
 extern void		_papplClientDelete(pappl_client_t *client) _PAPPL_PRIVATE;
 extern void		_papplClientFlushDocumentData(pappl_client_t *client) _PAPPL_PRIVATE;
+extern void		_papplClientFlushHTML(pappl_client_t *client) _PAPPL_PRIVATE;
 extern const char	*_papplClientGetAuthWebScheme(pappl_client_t *client) _PAPPL_PRIVATE;
 extern bool		_papplClientHaveDocumentData(pappl_client_t *client) _PAPPL_PRIVATE;
 extern http_status_t	_papplClientIsAuthorizedForGroup(pappl_client_t *client, bool allow_remote, const char *group, gid_t groupid) _PAPPL_PUBLIC;
+extern bool		_papplClientPoolAdd(pappl_system_t *system, pappl_client_t *client) _PAPPL_PRIVATE;
+extern void		_papplClientPoolCopyMetrics(pappl_system_t *system, pappl_cmetrics_t *metrics) _PAPPL_PRIVATE;
+extern bool		_papplClientPoolIsFull(pappl_system_t *system) _PAPPL_PRIVATE;
+extern bool		_papplClientPoolStart(pappl_system_t *system) _PAPPL_PRIVATE;
+extern void		_papplClientPoolStop(pappl_system_t *system) _PAPPL_PRIVATE;
 extern bool		_papplClientProcessHTTP(pappl_client_t *client) _PAPPL_PRIVATE;
 extern bool		_papplClientProcessIPP(pappl_client_t *client) _PAPPL_PRIVATE;
+extern bool		_papplClientProcessRequest(pappl_client_t *client) _PAPPL_PRIVATE;
 extern void		_papplClientRespondIPPIgnored(pappl_client_t *client, ipp_attribute_t *attr) _PAPPL_PRIVATE;
 extern void		*_papplClientRun(pappl_client_t *client) _PAPPL_PRIVATE;
+extern char		*_papplClientHTMLEndCapture(pappl_client_t *client) _PAPPL_PRIVATE;
+extern bool		_papplClientHTMLStartCapture(pappl_client_t *client) _PAPPL_PRIVATE;
 extern void		_papplClientHTMLInfo(pappl_client_t *client, bool is_form, const char *dns_sd_name, const char *location, const char *geo_location, const char *organization, const char *org_unit, pappl_contact_t *contact);
 extern void		_papplClientHTMLPutLinks(pappl_client_t *client, cups_array_t *links, pappl_loptions_t which);
 
@@ -16,6 +16,56 @@
 #include <math.h>
 
 
+//
+// Local globals...
+//
+
+static const unsigned char html_special[256] =
+{					// Entity index for special characters
+  ['&']  = 1,
+  ['<']  = 2,
+  ['\"'] = 3
+};
+static const char * const html_entities[4] =
+{					// Entities for special characters
+  NULL,
+  "&amp;",
+  "&lt;",
+  "&quot;"
+};
+static const size_t	html_entlens[4] = { 0, 5, 4, 6 };
+					// Lengths of entities
+
+
+//
+// Local functions...
+//
+
+static void	html_write(pappl_client_t *client, const char *data, size_t bytes);
+
+
+//
+// '_papplClientFlushHTML()' - Send any buffered HTML to the client.
+//
+// This function must be called before writing to the client's HTTP connection
+// directly after using the `papplClientHTML` functions.
+//
+
+void
+_papplClientFlushHTML(
+    pappl_client_t *client)		// I - Client
+{
+  if (!client || !client->html_bufused)
+    return;
+
+  httpWrite(client->http, client->html_buffer, client->html_bufused);
+
+  client->html_flushes ++;
+  client->html_bytes   += client->html_bufused;
+  client->html_bufused = 0;
+}
+
+
 //
 // 'papplClientGetCookie()' - Get a cookie from the client.
 //
@@ -561,6 +611,41 @@ papplClientHTMLAuthorize(
 }
 
 
+//
+// '_papplClientHTMLEndCapture()' - Stop capturing HTML output.
+//
+// This function returns the HTML that was written since the call to
+// @link _papplClientHTMLStartCapture@.  The returned string must be freed
+// using `free`.  `NULL` is returned if memory could not be allocated for the
+// captured HTML.
+//
+
+char *					// O - Captured HTML or `NULL` on error
+_papplClientHTMLEndCapture(
+    pappl_client_t *client)		// I - Client
+{
+  char	*html = client->html_capture;	// Captured HTML
+
+
+  if (html && client->html_caperror)
+  {
+    free(html);
+    html = NULL;
+  }
+  else if (html)
+  {
+    html[client->html_caplen] = '\0';
+  }
+
+  client->html_capture  = NULL;
+  client->html_capsize  = 0;
+  client->html_caplen   = 0;
+  client->html_caperror = false;
+
+  return (html);
+}
+
+
 //
 // 'papplClientHTMLEscape()' - Send a string to a web browser client.
 //
@@ -577,33 +662,25 @@ papplClientHTMLEscape(
 {
   const char	*start,			// Start of segment
 		*end;			// End of string
+  unsigned char	special;		// Entity index
 
 
-  start = s;
-  end   = s + (slen > 0 ? slen : strlen(s));
+  end = s + (slen > 0 ? slen : strlen(s));
 
-  while (*s && s < end)
+  while (s < end && *s)
   {
-    if (*s == '&' || *s == '<' || *s == '\"')
-    {
-      if (s > start)
-        httpWrite(client->http, start, (size_t)(s - start));
+    // Copy characters up to the next special character in one write...
+    for (start = s; s < end && *s && !html_special[*s & 255]; s ++);
 
-      if (*s == '&')
-        httpWrite(client->http, "&amp;", 5);
-      else if (*s == '<')
-        httpWrite(client->http, "&lt;", 4);
-      else
-        httpWrite(client->http, "&quot;", 6);
+    if (s > start)
+      html_write(client, start, (size_t)(s - start));
 
-      start = s + 1;
+    if (s < end && (special = html_special[*s & 255]) != 0)
+    {
+      html_write(client, html_entities[special], html_entlens[special]);
+      s ++;
     }
-
-    s ++;
   }
-
-  if (s > start)
-    httpWrite(client->http, start, (size_t)(s - start));
 }
 
 
@@ -639,6 +716,7 @@ papplClientHTMLFooter(
   papplClientHTMLPuts(client,
 		      "  </body>\n"
 		      "</html>\n");
+  _papplClientFlushHTML(client);
   httpWrite(client->http, "", 0);
 }
 
@@ -1053,14 +1131,14 @@ papplClientHTMLPrintf(
     if (*format == '%')
     {
       if (format > start)
-        httpWrite(client->http, start, (size_t)(format - start));
+        html_write(client, start, (size_t)(format - start));
 
       tptr    = tformat;
       *tptr++ = *format++;
 
       if (*format == '%')
       {
-        httpWrite(client->http, "%", 1);
+        html_write(client, "%", 1);
         format ++;
 	start = format;
 	continue;
@@ -1167,7 +1245,7 @@ papplClientHTMLPrintf(
 
 	    snprintf(temp, sizeof(temp), tformat, va_arg(ap, double));
 
-            httpWrite(client->http, temp, strlen(temp));
+            html_write(client, temp, strlen(temp));
 	    break;
 
         case 'B' : // Integer formats
@@ -1191,7 +1269,7 @@ papplClientHTMLPrintf(
 	    else
 	      snprintf(temp, sizeof(temp), tformat, va_arg(ap, int));
 
-            httpWrite(client->http, temp, strlen(temp));
+            html_write(client, temp, strlen(temp));
 	    break;
 
 	case 'p' : // Pointer value
@@ -1200,7 +1278,7 @@ papplClientHTMLPrintf(
 
 	    snprintf(temp, sizeof(temp), tformat, va_arg(ap, void *));
 
-            httpWrite(client->http, temp, strlen(temp));
+            html_write(client, temp, strlen(temp));
 	    break;
 
         case 'c' : // Character or character array
@@ -1227,7 +1305,7 @@ papplClientHTMLPrintf(
   }
 
   if (format > start)
-    httpWrite(client->http, start, (size_t)(format - start));
+    html_write(client, start, (size_t)(format - start));
 
   va_end(ap);
 }
@@ -1287,7 +1365,34 @@ papplClientHTMLPuts(
     const char     *s)			// I - String
 {
   if (client && s && *s)
-    httpWrite(client->http, s, strlen(s));
+    html_write(client, s, strlen(s));
+}
+
+
+//
+// '_papplClientHTMLStartCapture()' - Start capturing HTML output.
+//
+// This function collects the output of the `papplClientHTML` functions in
+// memory instead of sending it to the client, for example to cache a
+// rendered fragment of a page.  Call @link _papplClientHTMLEndCapture@ to get
+// the captured HTML.
+//
+
+bool					// O - `true` on success, `false` on error
+_papplClientHTMLStartCapture(
+    pappl_client_t *client)		// I - Client
+{
+  if (client->html_capture)
+    return (false);
+
+  if ((client->html_capture = malloc(1024)) == NULL)
+    return (false);
+
+  client->html_capsize  = 1024;
+  client->html_caplen   = 0;
+  client->html_caperror = false;
+
+  return (true);
 }
 
 
@@ -1403,3 +1508,69 @@ papplClientSetCookie(
     httpSetCookie(client->http, buffer);
   }
 }
+
+
+//
+// 'html_write()' - Add data to the client's HTML output buffer.
+//
+// The buffer is allocated on first use and sent to the client when full.
+// Writes that are larger than the buffer are sent directly.  When capturing,
+// the data is instead added to the capture buffer.
+//
+
+static void
+html_write(pappl_client_t *client,	// I - Client
+           const char     *data,	// I - Data to write
+           size_t         bytes)	// I - Number of bytes
+{
+  if (client->html_capture)
+  {
+    // Capturing HTML, add it to the capture buffer (leaving room for a
+    // trailing nul)...
+    if (client->html_caperror)
+      return;
+
+    if ((client->html_caplen + bytes) >= client->html_capsize)
+    {
+      size_t	capsize = 2 * (client->html_caplen + bytes);
+					// New size of capture buffer
+      char	*capture;		// New capture buffer
+
+      if ((capture = realloc(client->html_capture, capsize)) == NULL)
+      {
+        client->html_caperror = true;
+        return;
+      }
+
+      client->html_capture = capture;
+      client->html_capsize = capsize;
+    }
+
+    memcpy(client->html_capture + client->html_caplen, data, bytes);
+    client->html_caplen += bytes;
+    return;
+  }
+
+  if (!client->html_buffer && (client->html_buffer = malloc(_PAPPL_CLIENT_HTML_BUFSIZE)) == NULL)
+  {
+    // No buffer, send the data directly...
+    httpWrite(client->http, data, bytes);
+    return;
+  }
+
+  if ((client->html_bufused + bytes) > _PAPPL_CLIENT_HTML_BUFSIZE)
+    _papplClientFlushHTML(client);
+
+  if (bytes >= _PAPPL_CLIENT_HTML_BUFSIZE)
+  {
+    httpWrite(client->http, data, bytes);
+
+    client->html_flushes ++;
+    client->html_bytes += bytes;
+  }
+  else
+  {
+    memcpy(client->html_buffer + client->html_bufused, data, bytes);
+    client->html_bufused += bytes;
+  }
+}
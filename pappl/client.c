@@ -22,6 +22,34 @@
 static bool	eval_if_modified(pappl_client_t *client, _pappl_resource_t *r);
 
 
+//
+// '_papplClientCheckIfModified()' - Check a dynamic page against the client's
+//                                   cached copy.
+//
+// This function compares the "If-Modified-Since" header, if any, with the
+// last modification time of a page.  `true` is returned if the page needs to
+// be sent.
+//
+
+bool					// O - `true` if modified, `false` otherwise
+_papplClientCheckIfModified(
+    pappl_client_t *client,		// I - Client
+    time_t         last_modified)	// I - Last modification time of page
+{
+  const char	*value;			// If-Modified-Since value
+  time_t	date;			// Time/date value
+
+
+  if (!last_modified || !*(value = httpGetField(client->http, HTTP_FIELD_IF_MODIFIED_SINCE)))
+    return (true);
+
+  if ((date = httpGetDateTime(value)) <= 0)
+    return (true);
+
+  return (date < last_modified);
+}
+
+
 //
 // '_papplClientCleanTempFiles()' - Clean temporary files...
 //
@@ -168,6 +196,8 @@ _papplClientDelete(
   ippDelete(client->request);
   ippDelete(client->response);
 
+  free(client->html_buffer);
+  free(client->html_capture);
   free(client);
 
   // Update the number of active clients...
@@ -353,10 +383,41 @@ _papplClientProcessHTTP(
         // See if we have a matching resource to serve...
         if ((resource = _papplSystemFindResourceForPath(client->system, client->uri)) != NULL)
         {
+          _pappl_rfile_t *file = NULL;	// File data
+          const void	*data;		// Resource data
+	  const char	*encoding = NULL;
+					// Content-Encoding for response
+          bool		ret;		// Return value
+
+          // Make sure the length and modification time of files are current...
+          if (resource->filename)
+          {
+            if ((file = _papplResourceGetFile(resource)) == NULL)
+	      return (papplClientRespond(client, HTTP_STATUS_NOT_FOUND, NULL, NULL, 0, 0));
+
+            data = file->fd < 0 ? file->data : NULL;
+          }
+          else
+          {
+            data = resource->data;
+          }
+
           if (eval_if_modified(client, resource))
-	    return (papplClientRespond(client, HTTP_STATUS_OK, NULL, resource->format, resource->last_modified, 0));
+          {
+	    // Use the same Content-Encoding as a GET request...
+	    if (*httpGetField(client->http, HTTP_FIELD_ACCEPT_ENCODING) && _papplResourceIsCompressible(resource, data, resource->length))
+	      encoding = httpGetContentEncoding(client->http);
+
+	    ret = papplClientRespond(client, HTTP_STATUS_OK, encoding, resource->format, resource->last_modified, resource->cb || encoding ? 0 : resource->length);
+	  }
           else
-            return (papplClientRespond(client, HTTP_STATUS_NOT_MODIFIED, NULL, NULL, resource->last_modified, 0));
+          {
+            ret = papplClientRespond(client, HTTP_STATUS_NOT_MODIFIED, NULL, NULL, resource->last_modified, 0);
+          }
+
+          _papplResourceReleaseFile(resource, file);
+
+          return (ret);
 	}
 
         // If we get here the resource wasn't found...
@@ -366,50 +427,104 @@ _papplClientProcessHTTP(
         // See if we have a matching resource to serve...
         if ((resource = _papplSystemFindResourceForPath(client->system, client->uri)) != NULL)
         {
-          if (!eval_if_modified(client, resource))
-          {
-            return (papplClientRespond(client, HTTP_STATUS_NOT_MODIFIED, NULL, NULL, resource->last_modified, 0));
-          }
-          else if (resource->cb)
+          _pappl_rfile_t *file = NULL;	// File data
+          const void	*data;		// Resource data
+          size_t	length;		// Length of resource data
+          time_t	last_modified;	// Last-Modified date/time
+	  const char	*encoding = NULL;
+					// Content-Encoding for response
+          bool		ret = true;	// Return value
+
+          if (resource->cb)
           {
             // Send output of a callback...
             return ((resource->cb)(client, resource->cbdata));
 	  }
-	  else if (resource->filename)
-	  {
-	    // Send an external file...
-	    int		fd;		// Resource file descriptor
-	    char	buffer[8192];	// Copy buffer
-	    ssize_t	bytes;		// Bytes read/written
 
-            if ((fd = open(resource->filename, O_RDONLY)) >= 0)
-	    {
-	      if (!papplClientRespond(client, HTTP_STATUS_OK, NULL, resource->format, resource->last_modified, 0))
-	      {
-	        close(fd);
-		return (false);
-	      }
+          // Get the data for the resource, loading files as needed.  Large
+          // files are not cached in memory and are sent in chunks below...
+          if (resource->filename)
+          {
+            if ((file = _papplResourceGetFile(resource)) == NULL)
+	      return (papplClientRespond(client, HTTP_STATUS_NOT_FOUND, NULL, NULL, 0, 0));
+
+            data          = file->fd < 0 ? file->data : NULL;
+            length        = file->length;
+            last_modified = file->last_modified;
+          }
+          else
+          {
+            data          = resource->data;
+            length        = resource->length;
+            last_modified = resource->last_modified;
+          }
 
-              while ((bytes = read(fd, buffer, sizeof(buffer))) > 0)
-                httpWrite(client->http, buffer, (size_t)bytes);
+          if (!eval_if_modified(client, resource))
+          {
+            _papplResourceReleaseFile(resource, file);
 
-	      httpWrite(client->http, "", 0);
+            return (papplClientRespond(client, HTTP_STATUS_NOT_MODIFIED, NULL, NULL, last_modified, 0));
+          }
 
-	      close(fd);
+	  // Send a static resource or file, compressing it if the client
+	  // accepts it...
+	  if (*httpGetField(client->http, HTTP_FIELD_ACCEPT_ENCODING) && _papplResourceIsCompressible(resource, data, length))
+	    encoding = httpGetContentEncoding(client->http);
 
-	      return (true);
-	    }
+	  if (!papplClientRespond(client, HTTP_STATUS_OK, encoding, resource->format, last_modified, encoding ? 0 : length))
+	  {
+	    ret = false;
 	  }
 	  else
 	  {
-	    // Send a static resource file...
-	    if (!papplClientRespond(client, HTTP_STATUS_OK, NULL, resource->format, resource->last_modified, resource->length))
-	      return (false);
+	    _papplResourceAddMetrics(client->system, resource, length, encoding != NULL);
 
-	    httpWrite(client->http, (const char *)resource->data, resource->length);
-	    httpFlushWrite(client->http);
-	    return (true);
+	    if (!data && length > 0)
+	    {
+	      // Send a large file through a bounded buffer...
+	      char	buffer[16384];	// Copy buffer
+	      size_t	offset;		// Offset in file
+	      ssize_t	bytes;		// Bytes read
+
+	      for (offset = 0; offset < length; offset += (size_t)bytes)
+	      {
+		if ((bytes = _papplResourceReadFile(resource, file, offset, buffer, sizeof(buffer))) <= 0)
+		{
+		  papplLogClient(client, PAPPL_LOGLEVEL_ERROR, "Unable to read '%s': %s", resource->filename, bytes < 0 ? strerror(errno) : "File truncated");
+		  ret = false;
+		  break;
+		}
+		else if (httpWrite(client->http, buffer, (size_t)bytes) < bytes)
+		{
+		  papplLogClient(client, PAPPL_LOGLEVEL_ERROR, "Unable to send '%s': %s", resource->path, cupsGetErrorString());
+		  ret = false;
+		  break;
+		}
+	      }
+
+	      if (ret)
+		httpFlushWrite(client->http);
+	    }
+	    else if (length > 0 && httpWrite(client->http, (const char *)data, length) < (ssize_t)length)
+	    {
+	      papplLogClient(client, PAPPL_LOGLEVEL_ERROR, "Unable to send '%s': %s", resource->path, cupsGetErrorString());
+	      ret = false;
+	    }
+	    else
+	    {
+	      if (encoding || length == 0)
+	      {
+		// Compressed and zero length content is sent chunked...
+		httpWrite(client->http, "", 0);
+	      }
+
+	      httpFlushWrite(client->http);
+	    }
 	  }
+
+	  _papplResourceReleaseFile(resource, file);
+
+	  return (ret);
 	}
 
         // If we get here then the resource wasn't found...
@@ -492,7 +607,8 @@ papplClientRespond(
     size_t         length)		// I - Length of response or `0` for variable-length
 {
   char	message[1024],			// Text message
-	last_str[256];			// Date string
+	last_str[256],			// Date string
+	lang_str[256];			// Content-Language string
 
 
   if (type)
@@ -521,8 +637,19 @@ papplClientRespond(
   httpClearFields(client->http);
   httpSetField(client->http, HTTP_FIELD_SERVER, papplSystemGetServerHeader(client->system));
   if (last_modified)
+  {
     httpSetField(client->http, HTTP_FIELD_LAST_MODIFIED, httpGetDateString(last_modified, last_str, sizeof(last_str)));
 
+    if (client->loc && (code == HTTP_STATUS_NOT_MODIFIED || (type && !strcmp(type, "text/html"))))
+    {
+      // Localized pages depend on the Accept-Language header.  Add a Vary:
+      // header after the Content-Language value since libcups does not
+      // directly support the Vary header...
+      snprintf(lang_str, sizeof(lang_str), "%s\r\nVary: Accept-Language", client->loc->name);
+      httpSetField(client->http, HTTP_FIELD_CONTENT_LANGUAGE, lang_str);
+    }
+  }
+
   if (code == HTTP_STATUS_METHOD_NOT_ALLOWED || client->operation == HTTP_STATE_OPTIONS)
     httpSetField(client->http, HTTP_FIELD_ALLOW, "GET, HEAD, OPTIONS, POST");
 
@@ -631,44 +758,75 @@ papplClientRespondRedirect(
 
 
 //
-// '_papplClientRun()' - Process client requests on a thread.
+// '_papplClientProcessRequest()' - Process a single request from a client.
+//
+// This function negotiates TLS on the first request as needed and then reads
+// and processes one HTTP request.  It is used by both the per-connection
+// client threads and the client worker pool.
 //
 
-void *					// O - Exit status
-_papplClientRun(
+bool					// O - `true` to keep the connection open, `false` to close it
+_papplClientProcessRequest(
     pappl_client_t *client)		// I - Client
 {
-  int first_time = 1;			// First time request?
+  bool	ret;				// Return value
 
 
-  // Loop until we are out of requests or timeout (30 seconds)...
-  while (httpWait(client->http, 30000))
+  if (!client->tls_checked && !(client->system->options & PAPPL_SOPTIONS_NO_TLS))
   {
-    if (first_time && !(client->system->options & PAPPL_SOPTIONS_NO_TLS))
+    // See if we need to negotiate a TLS connection...
+    char buf[1];			// First byte from client
+
+    if (recv(httpGetFd(client->http), buf, 1, MSG_PEEK) == 1 && (!buf[0] || !strchr("DGHOPT", buf[0])))
     {
-      // See if we need to negotiate a TLS connection...
-      char buf[1];			// First byte from client
+      papplLogClient(client, PAPPL_LOGLEVEL_INFO, "Starting HTTPS session.");
 
-      if (recv(httpGetFd(client->http), buf, 1, MSG_PEEK) == 1 && (!buf[0] || !strchr("DGHOPT", buf[0])))
+      if (!httpSetEncryption(client->http, HTTP_ENCRYPTION_ALWAYS))
       {
-        papplLogClient(client, PAPPL_LOGLEVEL_INFO, "Starting HTTPS session.");
-
-	if (!httpSetEncryption(client->http, HTTP_ENCRYPTION_ALWAYS))
-	{
-          papplLogClient(client, PAPPL_LOGLEVEL_ERROR, "Unable to encrypt connection: %s", cupsGetErrorString());
-	  break;
-        }
-
-        papplLogClient(client, PAPPL_LOGLEVEL_INFO, "Connection now encrypted.");
+        papplLogClient(client, PAPPL_LOGLEVEL_ERROR, "Unable to encrypt connection: %s", cupsGetErrorString());
+        return (false);
       }
 
-      first_time = 0;
+      papplLogClient(client, PAPPL_LOGLEVEL_INFO, "Connection now encrypted.");
     }
+  }
 
-    if (!_papplClientProcessHTTP(client))
-      break;
+  client->tls_checked = true;
+
+  ret = _papplClientProcessHTTP(client);
+
+  _papplClientFlushHTML(client);
+  _papplClientCleanTempFiles(client);
+
+  if (client->html_flushes)
+  {
+    // Update the HTML output metrics...
+    pthread_mutex_lock(&client->system->html_mutex);
+    client->system->html_flushes += client->html_flushes;
+    client->system->html_bytes   += client->html_bytes;
+    pthread_mutex_unlock(&client->system->html_mutex);
+
+    client->html_flushes = 0;
+    client->html_bytes   = 0;
+  }
+
+  return (ret);
+}
 
-    _papplClientCleanTempFiles(client);
+
+//
+// '_papplClientRun()' - Process client requests on a thread.
+//
+
+void *					// O - Exit status
+_papplClientRun(
+    pappl_client_t *client)		// I - Client
+{
+  // Loop until we are out of requests or timeout (30 seconds)...
+  while (httpWait(client->http, 30000))
+  {
+    if (!_papplClientProcessRequest(client))
+      break;
   }
 
   // Close the conection to the client and return...
@@ -22,6 +22,9 @@
 static void	pappl_file_close(pappl_device_t *device);
 static bool	pappl_file_open(pappl_device_t *device, const char *device_uri, const char *name);
 static ssize_t	pappl_file_write(pappl_device_t *device, const void *buffer, size_t bytes);
+#if !_WIN32
+static ssize_t	pappl_file_writev(pappl_device_t *device, const pappl_devbuf_t *bufs, size_t num_bufs);
+#endif // !_WIN32
 
 
 //
@@ -31,7 +34,11 @@ static ssize_t	pappl_file_write(pappl_device_t *device, const void *buffer, size
 void
 _papplDeviceAddFileSchemeNoLock(void)
 {
-  _papplDeviceAddSchemeNoLock("file", PAPPL_DEVTYPE_FILE, /*list_cb*/NULL, pappl_file_open, pappl_file_close, /*read_cb*/NULL, pappl_file_write, /*status_cb*/NULL, /*supplies_cb*/NULL, /*id_cb*/NULL);
+#if _WIN32
+  _papplDeviceAddSchemeNoLock("file", PAPPL_DEVTYPE_FILE, /*list_cb*/NULL, pappl_file_open, pappl_file_close, /*read_cb*/NULL, pappl_file_write, /*writev_cb*/NULL, /*status_cb*/NULL, /*supplies_cb*/NULL, /*id_cb*/NULL);
+#else
+  _papplDeviceAddSchemeNoLock("file", PAPPL_DEVTYPE_FILE, /*list_cb*/NULL, pappl_file_open, pappl_file_close, /*read_cb*/NULL, pappl_file_write, pappl_file_writev, /*status_cb*/NULL, /*supplies_cb*/NULL, /*id_cb*/NULL);
+#endif // _WIN32
 }
 
 
@@ -199,3 +206,26 @@ pappl_file_write(pappl_device_t *device,// I - Device
 
   return (count);
 }
+
+
+#if !_WIN32
+//
+// 'pappl_file_writev()' - Write multiple buffers to a file.
+//
+
+static ssize_t				// O - Number of bytes written or `-1` on error
+pappl_file_writev(
+    pappl_device_t       *device,	// I - Device
+    const pappl_devbuf_t *bufs,		// I - Buffers to write
+    size_t               num_bufs)	// I - Number of buffers
+{
+  int		*fd;			// File descriptor
+
+
+  // Make sure we have a valid file descriptor...
+  if ((fd = papplDeviceGetData(device)) == NULL || *fd < 0)
+    return (-1);
+
+  return (_papplDeviceWritevFd(*fd, bufs, num_bufs));
+}
+#endif // !_WIN32
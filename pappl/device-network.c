@@ -29,6 +29,9 @@
 
 #define _PAPPL_MAX_SNMP_SUPPLY	32	// Maximum number of SNMP supplies
 #define _PAPPL_SNMP_TIMEOUT	2.0	// Timeout for SNMP queries
+#define _PAPPL_SOCKET_ADDR_MAX	100	// Maximum number of cached addresses
+#define _PAPPL_SOCKET_ADDR_TTL	300	// Lifetime of cached addresses in seconds
+#define _PAPPL_SOCKET_ADDR_TIMEOUT 250	// Timeout for connecting to a cached address in milliseconds
 
 // Generic enum values
 #define _PAPPL_TC_other			1
@@ -100,6 +103,15 @@ typedef struct _pappl_socket_s		// Socket device data
 						// Supply units
 } _pappl_socket_t;
 
+typedef struct _pappl_saddr_s		// Cached socket address
+{
+  char			*uri;			// Device URI
+  char			*host;			// Hostname
+  int			port;			// Port number
+  http_addrlist_t	*list;			// Address list
+  time_t		expires;		// Expiration time
+} _pappl_saddr_t;
+
 typedef struct _pappl_dns_sd_dev_t	// DNS-SD browse data
 {
 #ifdef HAVE_MDNSRESPONDER
@@ -139,6 +151,10 @@ typedef enum _pappl_snmp_query_e	// SNMP query request IDs for each field
 // Local globals...
 //
 
+static pthread_mutex_t	pappl_socket_mutex = PTHREAD_MUTEX_INITIALIZER;
+					// Mutex for address cache
+static cups_array_t	*pappl_socket_addrs = NULL;
+					// Address cache
 static const int	DevicePrinterOID[] = { 1,3,6,1,2,1,25,3,1,5,-1 };
 					// Host MIB OID for "printer" type
 static const int	SysNameOID[] = { 1,3,6,1,2,1,1,5,0,-1 };
@@ -205,6 +221,11 @@ static bool		pappl_snmp_open_cb(const char *device_info, const char *device_uri,
 static void		pappl_snmp_read_response(cups_array_t *devices, int fd, pappl_deverror_cb_t err_cb, void *err_data);
 static void		pappl_snmp_walk_cb(_pappl_snmp_t *packet, _pappl_socket_t *sock);
 
+static void		pappl_socket_addr_add(const char *device_uri, _pappl_socket_t *sock);
+static int		pappl_socket_addr_compare(_pappl_saddr_t *a, _pappl_saddr_t *b);
+static bool		pappl_socket_addr_find(const char *device_uri, _pappl_socket_t *sock);
+static void		pappl_socket_addr_free(_pappl_saddr_t *saddr);
+static void		pappl_socket_addr_remove(const char *device_uri);
 static void		pappl_socket_close(pappl_device_t *device);
 static char		*pappl_socket_getid(pappl_device_t *device, char *buffer, size_t bufsize);
 static bool		pappl_socket_open(pappl_device_t *device, const char *device_uri, const char *name);
@@ -212,6 +233,7 @@ static ssize_t		pappl_socket_read(pappl_device_t *device, void *buffer, size_t b
 static pappl_preason_t	pappl_socket_status(pappl_device_t *device);
 static int		pappl_socket_supplies(pappl_device_t *device, int max_supplies, pappl_supply_t *supplies);
 static ssize_t		pappl_socket_write(pappl_device_t *device, const void *buffer, size_t bytes);
+static ssize_t		pappl_socket_writev(pappl_device_t *device, const pappl_devbuf_t *bufs, size_t num_bufs);
 static void		utf16_to_utf8(char *dst, const unsigned char *src, size_t srcsize, size_t dstsize, bool le);
 
 
@@ -223,10 +245,46 @@ void
 _papplDeviceAddNetworkSchemesNoLock(void)
 {
 #ifdef HAVE_DNSSD
-  _papplDeviceAddSchemeNoLock("dnssd", PAPPL_DEVTYPE_DNS_SD, pappl_dnssd_list, pappl_socket_open, pappl_socket_close, pappl_socket_read, pappl_socket_write, pappl_socket_status, pappl_socket_supplies, pappl_socket_getid);
+  _papplDeviceAddSchemeNoLock("dnssd", PAPPL_DEVTYPE_DNS_SD, pappl_dnssd_list, pappl_socket_open, pappl_socket_close, pappl_socket_read, pappl_socket_write, pappl_socket_writev, pappl_socket_status, pappl_socket_supplies, pappl_socket_getid);
 #endif // HAVE_DNSSD
-  _papplDeviceAddSchemeNoLock("snmp", PAPPL_DEVTYPE_SNMP, pappl_snmp_list, pappl_socket_open, pappl_socket_close, pappl_socket_read, pappl_socket_write, pappl_socket_status, pappl_socket_supplies, pappl_socket_getid);
-  _papplDeviceAddSchemeNoLock("socket", PAPPL_DEVTYPE_SOCKET, NULL, pappl_socket_open, pappl_socket_close, pappl_socket_read, pappl_socket_write, pappl_socket_status, pappl_socket_supplies, pappl_socket_getid);
+  _papplDeviceAddSchemeNoLock("snmp", PAPPL_DEVTYPE_SNMP, pappl_snmp_list, pappl_socket_open, pappl_socket_close, pappl_socket_read, pappl_socket_write, pappl_socket_writev, pappl_socket_status, pappl_socket_supplies, pappl_socket_getid);
+  _papplDeviceAddSchemeNoLock("socket", PAPPL_DEVTYPE_SOCKET, NULL, pappl_socket_open, pappl_socket_close, pappl_socket_read, pappl_socket_write, pappl_socket_writev, pappl_socket_status, pappl_socket_supplies, pappl_socket_getid);
+}
+
+
+//
+// '_papplDeviceIsConnected()' - Check whether a network device is still connected.
+//
+// This function checks whether the printer has closed the connection to a
+// network device without waiting.  `false` is returned for all other devices
+// since they cannot be kept open between jobs.
+//
+
+bool					// O - `true` if connected, `false` otherwise
+_papplDeviceIsConnected(
+    pappl_device_t *device)		// I - Device
+{
+  _pappl_socket_t	*sock;		// Socket device
+  struct pollfd		data;		// poll() data
+  char			ch;		// Peeked byte
+
+
+  if (!device || device->close_cb != pappl_socket_close || (sock = papplDeviceGetData(device)) == NULL || sock->fd < 0)
+    return (false);
+
+  data.fd      = sock->fd;
+  data.events  = POLLIN;
+  data.revents = 0;
+
+  if (poll(&data, 1, 0) < 0 || (data.revents & (POLLERR | POLLHUP | POLLNVAL)))
+    return (false);
+
+  // Printers can send status data at any time, so peek at the incoming data
+  // to tell it from an orderly shutdown...
+  if (data.revents & POLLIN)
+    return (recv(sock->fd, &ch, 1, MSG_PEEK) > 0);
+
+  return (true);
 }
 
 
@@ -1462,6 +1520,163 @@ pappl_snmp_walk_cb(
 }
 
 
+//
+// 'pappl_socket_addr_add()' - Add a resolved address to the address cache.
+//
+
+static void
+pappl_socket_addr_add(
+    const char      *device_uri,	// I - Device URI
+    _pappl_socket_t *sock)		// I - Socket device
+{
+  _pappl_saddr_t	key,		// Search key
+			*saddr;		// Cached address
+  time_t		curtime = time(NULL);
+					// Current time
+
+
+  pthread_mutex_lock(&pappl_socket_mutex);
+
+  if (!pappl_socket_addrs)
+    pappl_socket_addrs = cupsArrayNew((cups_array_cb_t)pappl_socket_addr_compare, NULL, NULL, 0, NULL, (cups_afree_cb_t)pappl_socket_addr_free);
+
+  // Replace any existing entry...
+  key.uri = (char *)device_uri;
+
+  if ((saddr = (_pappl_saddr_t *)cupsArrayFind(pappl_socket_addrs, &key)) != NULL)
+    cupsArrayRemove(pappl_socket_addrs, saddr);
+
+  // Make room as needed, starting with expired entries...
+  if (cupsArrayGetCount(pappl_socket_addrs) >= _PAPPL_SOCKET_ADDR_MAX)
+  {
+    for (saddr = (_pappl_saddr_t *)cupsArrayGetFirst(pappl_socket_addrs); saddr; saddr = (_pappl_saddr_t *)cupsArrayGetNext(pappl_socket_addrs))
+    {
+      if (saddr->expires <= curtime)
+        cupsArrayRemove(pappl_socket_addrs, saddr);
+    }
+
+    if (cupsArrayGetCount(pappl_socket_addrs) >= _PAPPL_SOCKET_ADDR_MAX)
+      cupsArrayRemove(pappl_socket_addrs, cupsArrayGetFirst(pappl_socket_addrs));
+  }
+
+  if ((saddr = (_pappl_saddr_t *)calloc(1, sizeof(_pappl_saddr_t))) != NULL)
+  {
+    saddr->uri     = strdup(device_uri);
+    saddr->host    = strdup(sock->host);
+    saddr->port    = sock->port;
+    saddr->list    = httpAddrCopyList(sock->list);
+    saddr->expires = curtime + _PAPPL_SOCKET_ADDR_TTL;
+
+    if (saddr->uri && saddr->host && saddr->list)
+      cupsArrayAdd(pappl_socket_addrs, saddr);
+    else
+      pappl_socket_addr_free(saddr);
+  }
+
+  pthread_mutex_unlock(&pappl_socket_mutex);
+}
+
+
+//
+// 'pappl_socket_addr_compare()' - Compare two cached addresses.
+//
+
+static int				// O - Result of comparison
+pappl_socket_addr_compare(
+    _pappl_saddr_t *a,			// I - First address
+    _pappl_saddr_t *b)			// I - Second address
+{
+  return (strcmp(a->uri, b->uri));
+}
+
+
+//
+// 'pappl_socket_addr_find()' - Find a resolved address in the address cache.
+//
+// The host, port, and a copy of the address list are stored in the socket
+// device.
+//
+
+static bool				// O - `true` if found, `false` otherwise
+pappl_socket_addr_find(
+    const char      *device_uri,	// I - Device URI
+    _pappl_socket_t *sock)		// I - Socket device
+{
+  _pappl_saddr_t	key,		// Search key
+			*saddr;		// Cached address
+
+
+  pthread_mutex_lock(&pappl_socket_mutex);
+
+  key.uri = (char *)device_uri;
+
+  if ((saddr = (_pappl_saddr_t *)cupsArrayFind(pappl_socket_addrs, &key)) != NULL)
+  {
+    if (saddr->expires > time(NULL))
+    {
+      sock->host = strdup(saddr->host);
+      sock->port = saddr->port;
+      sock->list = httpAddrCopyList(saddr->list);
+    }
+    else
+    {
+      cupsArrayRemove(pappl_socket_addrs, saddr);
+    }
+  }
+
+  pthread_mutex_unlock(&pappl_socket_mutex);
+
+  if (sock->host && sock->list)
+    return (true);
+
+  free(sock->host);
+  httpAddrFreeList(sock->list);
+
+  sock->host = NULL;
+  sock->list = NULL;
+
+  return (false);
+}
+
+
+//
+// 'pappl_socket_addr_free()' - Free a cached address.
+//
+
+static void
+pappl_socket_addr_free(
+    _pappl_saddr_t *saddr)		// I - Cached address
+{
+  free(saddr->uri);
+  free(saddr->host);
+  httpAddrFreeList(saddr->list);
+  free(saddr);
+}
+
+
+//
+// 'pappl_socket_addr_remove()' - Remove a stale address from the address cache.
+//
+
+static void
+pappl_socket_addr_remove(
+    const char *device_uri)		// I - Device URI
+{
+  _pappl_saddr_t	key,		// Search key
+			*saddr;		// Cached address
+
+
+  pthread_mutex_lock(&pappl_socket_mutex);
+
+  key.uri = (char *)device_uri;
+
+  if ((saddr = (_pappl_saddr_t *)cupsArrayFind(pappl_socket_addrs, &key)) != NULL)
+    cupsArrayRemove(pappl_socket_addrs, saddr);
+
+  pthread_mutex_unlock(&pappl_socket_mutex);
+}
+
+
 //
 // 'pappl_socket_close()' - Close a network socket.
 //
@@ -1579,10 +1794,34 @@ pappl_socket_open(
     return (false);
   }
 
+  sock->fd           = -1;
   sock->snmp_fd      = -1;
   sock->charset      = -1;
   sock->num_supplies = -1;
 
+  // Try the cached address first so that DNS-SD and SNMP devices don't need
+  // to be resolved again for every job.  Use a short timeout since a printer
+  // that has moved or is offline would otherwise delay every job...
+  if (pappl_socket_addr_find(device_uri, sock))
+  {
+    sock->addr = httpAddrConnect(sock->list, &sock->fd, _PAPPL_SOCKET_ADDR_TIMEOUT, NULL);
+
+    if (sock->fd >= 0)
+      goto connected;
+
+    // The printer may have moved, look it up again...
+    _PAPPL_DEBUG("pappl_socket_open: Cached address for '%s' is stale.\n", device_uri);
+
+    pappl_socket_addr_remove(device_uri);
+
+    free(sock->host);
+    httpAddrFreeList(sock->list);
+
+    sock->host = NULL;
+    sock->list = NULL;
+    sock->addr = NULL;
+  }
+
   // Split apart the URI...
   httpSeparateURI(HTTP_URI_CODING_ALL, device_uri, scheme, sizeof(scheme), userpass, sizeof(userpass), host, sizeof(host), &port, resource, sizeof(resource));
 
@@ -1683,7 +1922,6 @@ pappl_socket_open(
     goto error;
   }
 
-  sock->fd   = -1;
   sock->addr = httpAddrConnect(sock->list, &sock->fd, 30000, NULL);
 
   if (sock->fd < 0)
@@ -1692,7 +1930,11 @@ pappl_socket_open(
     goto error;
   }
 
+  pappl_socket_addr_add(device_uri, sock);
+
   // Open SNMP socket...
+  connected:
+
   if ((sock->snmp_fd = _papplSNMPOpen(httpAddrGetFamily(&(sock->addr->addr)))) < 0)
   {
     papplDeviceError(device, "Unable to open SNMP socket.");
@@ -1958,6 +2200,43 @@ pappl_socket_write(
 }
 
 
+//
+// 'pappl_socket_writev()' - Write multiple buffers to a network socket.
+//
+
+static ssize_t				// O - Number of bytes written or `-1` on error
+pappl_socket_writev(
+    pappl_device_t       *device,	// I - Device
+    const pappl_devbuf_t *bufs,		// I - Buffers to write
+    size_t               num_bufs)	// I - Number of buffers
+{
+  _pappl_socket_t	*sock;		// Socket device
+#if _WIN32
+  size_t		i;		// Looping var
+  ssize_t		count,		// Total bytes written
+			written;	// Bytes written for current buffer
+#endif // _WIN32
+
+
+  if ((sock = papplDeviceGetData(device)) == NULL)
+    return (-1);
+
+#if _WIN32
+  // No writev, so send each buffer...
+  for (i = 0, count = 0; i < num_bufs; i ++, count += written)
+  {
+    if ((written = pappl_socket_write(device, bufs[i].data, bufs[i].length)) < 0)
+      return (-1);
+  }
+
+  return (count);
+
+#else
+  return (_papplDeviceWritevFd(sock->fd, bufs, num_bufs));
+#endif // _WIN32
+}
+
+
 //
 // 'utf16_to_utf8()' - Convert UTF-16 text to UTF-8.
 //
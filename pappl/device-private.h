@@ -11,19 +11,26 @@
 #  define _PAPPL_DEVICE_PRIVATE_H_
 #  include "base-private.h"
 #  include "device.h"
+#  include "system.h"
 
 
 //
 // Constants...
 //
 
-#define PAPPL_DEVICE_BUFSIZE	8192	// Size of write buffer
+#define PAPPL_DEVICE_BUFSIZE	8192	// Initial size of write buffer
+#define _PAPPL_DEVICE_BUFMAX	262144	// Maximum size of write buffer
+#define _PAPPL_DEVICE_FLUSHMS	10	// Target time to write a full buffer in milliseconds
+#define _PAPPL_DEVICE_IOVMAX	16	// Maximum number of buffers for each gather write
 
 
 //
 // Types...
 //
 
+typedef ssize_t (*_pappl_devwritev_cb_t)(pappl_device_t *device, const pappl_devbuf_t *bufs, size_t num_bufs);
+					// Gather write callback
+
 struct _pappl_device_s			// Device connection data
 {
   pappl_devclose_cb_t	close_cb;		// Close callback
@@ -33,14 +40,19 @@ struct _pappl_device_s			// Device connection data
   pappl_devstatus_cb_t	status_cb;		// Status callback
   pappl_devsupplies_cb_t supplies_cb;		// Supplies callback
   pappl_devwrite_cb_t	write_cb;		// Write callback
+  _pappl_devwritev_cb_t	writev_cb;		// Gather write callback, if any
 
   void			*device_data,		// Data pointer for device
 			*error_data;		// Data pointer for error callback
 
-  char			buffer[PAPPL_DEVICE_BUFSIZE];
-						// Write buffer
-  size_t		bufused;		// Number of bytes in write buffer
+  char			*buffer;		// Write buffer
+  size_t		bufsize,		// Size of write buffer
+			bufused;		// Number of bytes in write buffer
+  bool			bufauto;		// Grow write buffer automatically?
   pappl_devmetrics_t	metrics;		// Device metrics
+  unsigned long long	read_nsecs,		// Nanoseconds spent reading
+			status_nsecs,		// Nanoseconds spent getting status
+			write_nsecs;		// Nanoseconds spent writing
 };
 
 typedef void (*_pappl_devscheme_cb_t)(const char *scheme, void *data);
@@ -52,6 +64,13 @@ typedef struct _pappl_dinfo_s		// Device information
 	*device_id;			// IEEE-1284 device ID string
 } _pappl_dinfo_t;
 
+typedef struct _pappl_devlist_s		// Device scheme list callback
+{
+  char			scheme[32];		// URI scheme
+  pappl_devtype_t	dtype;			// Device type
+  pappl_devlist_cb_t	list_cb;		// List devices callback
+} _pappl_devlist_t;
+
 
 //
 // Functions...
@@ -59,12 +78,20 @@ typedef struct _pappl_dinfo_s		// Device information
 
 extern void		_papplDeviceAddFileSchemeNoLock(void) _PAPPL_PRIVATE;
 extern void		_papplDeviceAddNetworkSchemesNoLock(void) _PAPPL_PRIVATE;
-extern void		_papplDeviceAddSchemeNoLock(const char *scheme, pappl_devtype_t dtype, pappl_devlist_cb_t list_cb, pappl_devopen_cb_t open_cb, pappl_devclose_cb_t close_cb, pappl_devread_cb_t read_cb, pappl_devwrite_cb_t write_cb, pappl_devstatus_cb_t status_cb, pappl_devsupplies_cb_t supplies_cb, pappl_devid_cb_t id_cb) _PAPPL_PRIVATE;
+extern void		_papplDeviceAddConnectionMetrics(pappl_system_t *system, size_t opens, size_t reuses, size_t stale, size_t idle_closes) _PAPPL_PRIVATE;
+extern void		_papplDeviceAddSchemeNoLock(const char *scheme, pappl_devtype_t dtype, pappl_devlist_cb_t list_cb, pappl_devopen_cb_t open_cb, pappl_devclose_cb_t close_cb, pappl_devread_cb_t read_cb, pappl_devwrite_cb_t write_cb, _pappl_devwritev_cb_t writev_cb, pappl_devstatus_cb_t status_cb, pappl_devsupplies_cb_t supplies_cb, pappl_devid_cb_t id_cb) _PAPPL_PRIVATE;
 extern void		_papplDeviceAddSupportedSchemes(ipp_t *attrs) _PAPPL_PRIVATE;
 extern void		_papplDeviceAddUSBSchemeNoLock(void) _PAPPL_PRIVATE;
+extern void		_papplDeviceCopyConnectionMetrics(pappl_system_t *system, pappl_dcmetrics_t *metrics) _PAPPL_PRIVATE;
+extern size_t		_papplDeviceCopyListSchemes(pappl_devtype_t types, size_t max_lists, _pappl_devlist_t *lists) _PAPPL_PRIVATE;
 extern void		_papplDeviceError(pappl_deverror_cb_t err_cb, void *err_data, const char *message, ...) _PAPPL_FORMAT(3,4) _PAPPL_PRIVATE;
 extern bool		_papplDeviceInfoCallback(const char *device_info, const char *device_uri, const char *device_id, cups_array_t *devices) _PAPPL_PRIVATE;
 extern cups_array_t	*_papplDeviceInfoCreateArray(void) _PAPPL_PRIVATE;
+extern bool		_papplDeviceIsConnected(pappl_device_t *device) _PAPPL_PRIVATE;
+extern void		_papplDeviceResetMetrics(pappl_device_t *device) _PAPPL_PRIVATE;
+#  if !_WIN32
+extern ssize_t		_papplDeviceWritevFd(int fd, const pappl_devbuf_t *bufs, size_t num_bufs) _PAPPL_PRIVATE;
+#  endif // !_WIN32
 
 
 #endif // !_PAPPL_DEVICE_H_
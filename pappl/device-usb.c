@@ -75,7 +75,7 @@ void
 _papplDeviceAddUSBSchemeNoLock(void)
 {
 #ifdef HAVE_LIBUSB
-  _papplDeviceAddSchemeNoLock("usb", PAPPL_DEVTYPE_USB, pappl_usb_list, pappl_usb_open, pappl_usb_close, pappl_usb_read, pappl_usb_write, pappl_usb_status, /*supplies_cb*/NULL, pappl_usb_getid);
+  _papplDeviceAddSchemeNoLock("usb", PAPPL_DEVTYPE_USB, pappl_usb_list, pappl_usb_open, pappl_usb_close, pappl_usb_read, pappl_usb_write, /*writev_cb*/NULL, pappl_usb_status, /*supplies_cb*/NULL, pappl_usb_getid);
 #endif // HAVE_LIBUSB
 }
 
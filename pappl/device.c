@@ -12,8 +12,12 @@
 //
 
 #include "device-private.h"
+#include "system-private.h"
 #include "printer.h"
 #include <stdarg.h>
+#if !_WIN32
+#  include <sys/uio.h>
+#endif // !_WIN32
 
 
 //
@@ -29,6 +33,7 @@ typedef struct _pappl_devscheme_s	// Device scheme data
   pappl_devclose_cb_t	close_cb;		// Close callback
   pappl_devread_cb_t	read_cb;		// Read callback
   pappl_devwrite_cb_t	write_cb;		// Write callback
+  _pappl_devwritev_cb_t	writev_cb;		// Gather write callback, if any
   pappl_devid_cb_t	id_cb;			// IEEE-1284 device ID callback, if any
   pappl_devstatus_cb_t	status_cb;		// Status callback, if any
   pappl_devsupplies_cb_t supplies_cb;		// Supplies callback, if any
@@ -49,11 +54,37 @@ static cups_array_t	*device_schemes = NULL;
 // Local functions...
 //
 
+static ssize_t		pappl_buffer_write(pappl_device_t *device, const void *buffer, size_t bytes);
 static int		pappl_compare_schemes(_pappl_devscheme_t *a, _pappl_devscheme_t *b);
 static void		pappl_create_schemes_no_lock(void);
 static void		pappl_default_error_cb(const char *message, void *data);
 static void		pappl_free_dinfo(_pappl_dinfo_t *d);
+static unsigned long long pappl_get_nsecs(void);
 static ssize_t		pappl_write(pappl_device_t *device, const void *buffer, size_t bytes);
+static ssize_t		pappl_writev(pappl_device_t *device, const pappl_devbuf_t *bufs, size_t num_bufs);
+
+
+//
+// '_papplDeviceAddConnectionMetrics()' - Add device connection counts.
+//
+
+void
+_papplDeviceAddConnectionMetrics(
+    pappl_system_t *system,		// I - System
+    size_t         opens,		// I - Number of connections opened
+    size_t         reuses,		// I - Number of connections reused
+    size_t         stale,		// I - Number of stale connections closed
+    size_t         idle_closes)		// I - Number of idle connections closed
+{
+  pthread_mutex_lock(&system->dcmetrics_mutex);
+
+  system->dcmetrics.opens       += opens;
+  system->dcmetrics.reuses      += reuses;
+  system->dcmetrics.stale       += stale;
+  system->dcmetrics.idle_closes += idle_closes;
+
+  pthread_mutex_unlock(&system->dcmetrics_mutex);
+}
 
 
 //
@@ -86,14 +117,15 @@ static ssize_t		pappl_write(pappl_device_t *device, const void *buffer, size_t b
 //   specific data as needed
 // - "read_cb": Reads data from a device
 // - "write_cb": Write data to a device
+// - "writev_cb": Write multiple buffers to a device (optional)
 // - "status_cb": Gets basic printer state information from a device (optional)
 // - "supplies_cb": Gets supply level information from a device (optional)
 // - "id_cb": Gets the current IEEE-1284 device ID from a device (optional)
 //
 // The "open_cb" callback typically calls @link papplDeviceSetData@ to store a
 // pointer to contextual information for the connection while the "close_cb",
-// "id_cb", "read_cb", "write_cb", "status_cb", and "supplies_cb" callbacks
-// typically call @link papplDeviceGetData@ to retrieve it.
+// "id_cb", "read_cb", "write_cb", "writev_cb", "status_cb", and "supplies_cb"
+// callbacks typically call @link papplDeviceGetData@ to retrieve it.
 //
 
 void
@@ -105,6 +137,7 @@ _papplDeviceAddSchemeNoLock(
     pappl_devclose_cb_t    close_cb,	// I - Close callback
     pappl_devread_cb_t     read_cb,	// I - Read callback
     pappl_devwrite_cb_t    write_cb,	// I - Write callback
+    _pappl_devwritev_cb_t  writev_cb,	// I - Gather write callback, if any
     pappl_devstatus_cb_t   status_cb,	// I - Status callback, if any
     pappl_devsupplies_cb_t supplies_cb,	// I - Supply level callback, if any
     pappl_devid_cb_t       id_cb)	// I - IEEE-1284 device ID callback, if any
@@ -143,6 +176,7 @@ _papplDeviceAddSchemeNoLock(
   ds->close_cb    = close_cb;
   ds->read_cb     = read_cb;
   ds->write_cb    = write_cb;
+  ds->writev_cb   = writev_cb;
   ds->status_cb   = status_cb;
   ds->supplies_cb = supplies_cb;
   ds->id_cb       = id_cb;
@@ -263,7 +297,7 @@ papplDeviceAddScheme2(
   if (!device_schemes)
     pappl_create_schemes_no_lock();
 
-  _papplDeviceAddSchemeNoLock(scheme, dtype, list_cb, open_cb, close_cb, read_cb, write_cb, status_cb, supplies_cb, id_cb);
+  _papplDeviceAddSchemeNoLock(scheme, dtype, list_cb, open_cb, close_cb, read_cb, write_cb, /*writev_cb*/NULL, status_cb, supplies_cb, id_cb);
 
   pthread_rwlock_unlock(&device_rwlock);
 }
@@ -313,11 +347,73 @@ papplDeviceClose(
       pappl_write(device, device->buffer, device->bufused);
 
     (device->close_cb)(device);
+    free(device->buffer);
     free(device);
   }
 }
 
 
+//
+// '_papplDeviceCopyConnectionMetrics()' - Copy the device connection metrics.
+//
+
+void
+_papplDeviceCopyConnectionMetrics(
+    pappl_system_t    *system,		// I - System
+    pappl_dcmetrics_t *metrics)		// I - Buffer for metrics data
+{
+  pthread_mutex_lock(&system->dcmetrics_mutex);
+  *metrics = system->dcmetrics;
+  pthread_mutex_unlock(&system->dcmetrics_mutex);
+}
+
+
+//
+// '_papplDeviceCopyListSchemes()' - Copy the list callbacks of the device schemes.
+//
+// This function copies the schemes that can list devices of the specified
+// types so that the list callbacks can be called without holding the device
+// lock, for example from separate discovery threads.
+//
+
+size_t					// O - Number of schemes
+_papplDeviceCopyListSchemes(
+    pappl_devtype_t  types,		// I - Device types
+    size_t           max_lists,		// I - Maximum number of schemes
+    _pappl_devlist_t *lists)		// I - Array of schemes
+{
+  size_t		num_lists = 0;	// Number of schemes
+  _pappl_devscheme_t	*ds;		// Current device scheme
+
+
+  pthread_rwlock_rdlock(&device_rwlock);
+
+  if (!device_schemes)
+  {
+    pthread_rwlock_unlock(&device_rwlock);
+    pthread_rwlock_wrlock(&device_rwlock);
+
+    if (!device_schemes)
+      pappl_create_schemes_no_lock();
+  }
+
+  for (ds = (_pappl_devscheme_t *)cupsArrayGetFirst(device_schemes); ds && num_lists < max_lists; ds = (_pappl_devscheme_t *)cupsArrayGetNext(device_schemes))
+  {
+    if ((types & ds->dtype) && ds->list_cb)
+    {
+      papplCopyString(lists[num_lists].scheme, ds->scheme, sizeof(lists[num_lists].scheme));
+      lists[num_lists].dtype   = ds->dtype;
+      lists[num_lists].list_cb = ds->list_cb;
+      num_lists ++;
+    }
+  }
+
+  pthread_rwlock_unlock(&device_rwlock);
+
+  return (num_lists);
+}
+
+
 //
 // '_papplDeviceError()' - Report an error.
 //
@@ -377,8 +473,8 @@ papplDeviceError(
 // 'papplDeviceFlush()' - Flush any buffered data to the device.
 //
 // This function flushes any pending write data sent using the
-// @link papplDevicePrintf@, @link papplDevicePuts@, or @link papplDeviceWrite@
-// functions to the device.
+// @link papplDevicePrintf@, @link papplDevicePuts@, @link papplDeviceWrite@, or
+// @link papplDeviceWritev@ functions to the device.
 //
 
 
@@ -393,6 +489,24 @@ papplDeviceFlush(pappl_device_t *device)// I - Device
 }
 
 
+//
+// 'papplDeviceGetBufferSize()' - Get the size of the device write buffer.
+//
+// This function returns the current size of the write buffer used by the
+// @link papplDevicePrintf@, @link papplDevicePuts@, @link papplDeviceWrite@,
+// and @link papplDeviceWritev@ functions.
+//
+// @since PAPPL 1.4@
+//
+
+size_t					// O - Write buffer size in bytes
+papplDeviceGetBufferSize(
+    pappl_device_t *device)		// I - Device
+{
+  return (device ? device->bufsize : 0);
+}
+
+
 //
 // 'papplDeviceGetData()' - Get device-specific data.
 //
@@ -426,8 +540,7 @@ papplDeviceGetID(
     char           *buffer,		// I - Buffer for IEEE-1284 device ID
     size_t         bufsize)		// I - Size of buffer
 {
-  struct timeval	starttime,	// Start time
-			endtime;	// End time
+  unsigned long long	starttime;	// Start time
   char			*ret;		// Return value
 
 
@@ -439,14 +552,14 @@ papplDeviceGetID(
     return (NULL);
 
   // Get the device ID and collect timing metrics...
-  gettimeofday(&starttime, NULL);
+  starttime = pappl_get_nsecs();
 
   ret = (device->id_cb)(device, buffer, bufsize);
 
-  gettimeofday(&endtime, NULL);
+  device->status_nsecs += pappl_get_nsecs() - starttime;
 
   device->metrics.status_requests ++;
-  device->metrics.status_msecs += (size_t)(1000 * (endtime.tv_sec - starttime.tv_sec) + (endtime.tv_usec - starttime.tv_usec) / 1000);
+  device->metrics.status_msecs = (size_t)(device->status_nsecs / 1000000);
 
   // Return the device ID
   return (ret);
@@ -504,23 +617,22 @@ pappl_preason_t				// O - IPP "printer-state-reasons" values
 papplDeviceGetStatus(
     pappl_device_t *device)		// I - Device
 {
-  struct timeval	starttime,	// Start time
-			endtime;	// End time
+  unsigned long long	starttime;	// Start time
   pappl_preason_t	status = PAPPL_PREASON_NONE;
 					// IPP "printer-state-reasons" values
 
 
   if (device)
   {
-    gettimeofday(&starttime, NULL);
+    starttime = pappl_get_nsecs();
 
     if (device->status_cb)
       status = (device->status_cb)(device);
 
-    gettimeofday(&endtime, NULL);
+    device->status_nsecs += pappl_get_nsecs() - starttime;
 
     device->metrics.status_requests ++;
-    device->metrics.status_msecs += (size_t)(1000 * (endtime.tv_sec - starttime.tv_sec) + (endtime.tv_usec - starttime.tv_usec) / 1000);
+    device->metrics.status_msecs = (size_t)(device->status_nsecs / 1000000);
   }
 
   return (status);
@@ -806,6 +918,9 @@ papplDeviceOpen(
   device->status_cb    = ds->status_cb;
   device->supplies_cb  = ds->supplies_cb;
   device->write_cb     = ds->write_cb;
+  device->writev_cb    = ds->writev_cb;
+  device->bufsize      = PAPPL_DEVICE_BUFSIZE;
+  device->bufauto      = true;
 
   if (!(ds->open_cb)(device, device_uri, name))
   {
@@ -952,8 +1067,7 @@ papplDeviceRead(
     void           *buffer,		// I - Read buffer
     size_t         bytes)		// I - Max bytes to read
 {
-  struct timeval	starttime,	// Start time
-			endtime;	// End time
+  unsigned long long	starttime;	// Start time
   ssize_t		count;		// Bytes read this time
 
 
@@ -964,14 +1078,14 @@ papplDeviceRead(
   if (device->bufused > 0)
     papplDeviceFlush(device);
 
-  gettimeofday(&starttime, NULL);
+  starttime = pappl_get_nsecs();
 
   count = (device->read_cb)(device, buffer, bytes);
 
-  gettimeofday(&endtime, NULL);
+  device->read_nsecs += pappl_get_nsecs() - starttime;
 
   device->metrics.read_requests ++;
-  device->metrics.read_msecs += (size_t)(1000 * (endtime.tv_sec - starttime.tv_sec) + (endtime.tv_usec - starttime.tv_usec) / 1000);
+  device->metrics.read_msecs = (size_t)(device->read_nsecs / 1000000);
   if (count > 0)
     device->metrics.read_bytes += (size_t)count;
 
@@ -1055,6 +1169,73 @@ papplDeviceRemoveTypes(
 }
 
 
+//
+// '_papplDeviceResetMetrics()' - Reset the device metrics for a new session.
+//
+// This function is used when a device connection is kept open for another job.
+//
+
+void
+_papplDeviceResetMetrics(
+    pappl_device_t *device)		// I - Device
+{
+  memset(&device->metrics, 0, sizeof(device->metrics));
+
+  device->read_nsecs   = 0;
+  device->status_nsecs = 0;
+  device->write_nsecs  = 0;
+}
+
+
+//
+// 'papplDeviceSetBufferSize()' - Set the size of the device write buffer.
+//
+// This function sets the size of the write buffer used by the
+// @link papplDevicePrintf@, @link papplDevicePuts@, @link papplDeviceWrite@,
+// and @link papplDeviceWritev@ functions.  Any buffered data is first sent to
+// the device.
+//
+// The default size of `0` starts with an 8k buffer that grows (up to 256k)
+// when the device accepts data faster than the buffer fills.  Other values set
+// a fixed buffer size.
+//
+// @since PAPPL 1.4@
+//
+
+bool					// O - `true` on success, `false` on error
+papplDeviceSetBufferSize(
+    pappl_device_t *device,		// I - Device
+    size_t         bufsize)		// I - Write buffer size in bytes or `0` for automatic
+{
+  char	*ptr;				// New buffer
+
+
+  if (!device)
+    return (false);
+
+  papplDeviceFlush(device);
+
+  device->bufauto = bufsize == 0;
+
+  if (bufsize == 0)
+    bufsize = PAPPL_DEVICE_BUFSIZE;
+  else if (bufsize > _PAPPL_DEVICE_BUFMAX)
+    bufsize = _PAPPL_DEVICE_BUFMAX;
+
+  if (device->buffer && bufsize != device->bufsize)
+  {
+    if ((ptr = realloc(device->buffer, bufsize)) == NULL)
+      return (false);
+
+    device->buffer = ptr;
+  }
+
+  device->bufsize = bufsize;
+
+  return (true);
+}
+
+
 //
 // 'papplDeviceSetData()' - Set device-specific data.
 //
@@ -1090,16 +1271,195 @@ papplDeviceWrite(
   if (!device)
     return (-1);
 
-  if ((device->bufused + bytes) > sizeof(device->buffer))
+  return (pappl_buffer_write(device, buffer, bytes));
+}
+
+
+//
+// 'papplDeviceWritev()' - Write multiple buffers to a device.
+//
+// This function writes data from multiple buffers to the device, for example a
+// command header followed by raster data.  If the buffers fit in the device's
+// write buffer they are copied there and sent later.  Otherwise the write
+// buffer and the new buffers are sent using a single gather write, or a few
+// for many buffers, when the device supports it.  Devices that don't support
+// gather writes, for example USB printers and custom URI schemes, buffer each
+// buffer as for @link papplDeviceWrite@.  Call the @link papplDeviceFlush@
+// function to ensure that the data is immediately sent to the device.
+//
+// @since PAPPL 1.4@
+//
+
+ssize_t					// O - Number of bytes written or -1 on error
+papplDeviceWritev(
+    pappl_device_t       *device,	// I - Device
+    const pappl_devbuf_t *bufs,		// I - Buffers to write
+    size_t               num_bufs)	// I - Number of buffers
+{
+  size_t	i,			// Looping var
+		num_iov;		// Number of gather buffers
+  ssize_t	count,			// Bytes written for current buffer
+		total = 0;		// Total bytes written
+  pappl_devbuf_t iov[_PAPPL_DEVICE_IOVMAX];
+					// Gather buffers
+
+
+  if (!device || (num_bufs > 0 && !bufs))
+    return (-1);
+
+  if (!device->writev_cb)
+  {
+    // No gather writes, buffer each buffer...
+    for (i = 0; i < num_bufs; i ++)
+    {
+      if ((count = pappl_buffer_write(device, bufs[i].data, bufs[i].length)) < 0)
+	return (-1);
+
+      total += count;
+    }
+
+    return (total);
+  }
+
+  for (i = 0; i < num_bufs; i ++)
+    total += (ssize_t)bufs[i].length;
+
+  if ((device->bufused + (size_t)total) < device->bufsize && (device->buffer || (device->buffer = malloc(device->bufsize)) != NULL))
+  {
+    // Copy the buffers to the write buffer...
+    for (i = 0; i < num_bufs; i ++)
+    {
+      memcpy(device->buffer + device->bufused, bufs[i].data, bufs[i].length);
+      device->bufused += bufs[i].length;
+    }
+
+    return (total);
+  }
+
+  // Send the write buffer followed by the new buffers...
+  num_iov = 0;
+
+  if (device->bufused > 0)
+  {
+    iov[0].data   = device->buffer;
+    iov[0].length = device->bufused;
+    num_iov       = 1;
+  }
+
+  for (i = 0; i < num_bufs; i ++)
+  {
+    if (bufs[i].length == 0)
+      continue;
+
+    if (num_iov >= _PAPPL_DEVICE_IOVMAX)
+    {
+      if (pappl_writev(device, iov, num_iov) < 0)
+        return (-1);
+
+      device->bufused = 0;
+      num_iov         = 0;
+    }
+
+    iov[num_iov ++] = bufs[i];
+  }
+
+  if (num_iov > 0 && pappl_writev(device, iov, num_iov) < 0)
+    return (-1);
+
+  device->bufused = 0;
+
+  return (total);
+}
+
+
+#if !_WIN32
+//
+// '_papplDeviceWritevFd()' - Write multiple buffers to a file descriptor.
+//
+// This function implements gather writes for devices that use a file
+// descriptor.  At most `_PAPPL_DEVICE_IOVMAX` buffers can be written.
+//
+
+ssize_t					// O - Number of bytes written or `-1` on error
+_papplDeviceWritevFd(
+    int                  fd,		// I - File descriptor
+    const pappl_devbuf_t *bufs,		// I - Buffers to write
+    size_t               num_bufs)	// I - Number of buffers
+{
+  size_t	i;			// Looping var
+  struct iovec	iov[_PAPPL_DEVICE_IOVMAX],
+					// I/O vector
+		*iovptr;		// Current I/O vector
+  int		iovcount;		// Number of I/O vectors left
+  ssize_t	count = 0,		// Total bytes written
+		written;		// Bytes written this time
+
+
+  if (num_bufs > _PAPPL_DEVICE_IOVMAX)
+    return (-1);
+
+  for (i = 0; i < num_bufs; i ++)
+  {
+    iov[i].iov_base = (void *)bufs[i].data;
+    iov[i].iov_len  = bufs[i].length;
+  }
+
+  for (iovptr = iov, iovcount = (int)num_bufs; iovcount > 0;)
+  {
+    if ((written = writev(fd, iovptr, iovcount)) < 0)
+    {
+      if (errno == EINTR || errno == EAGAIN)
+        continue;
+
+      return (-1);
+    }
+
+    count += written;
+
+    // Skip the buffers that have been written...
+    while (iovcount > 0 && (size_t)written >= iovptr->iov_len)
+    {
+      written -= (ssize_t)iovptr->iov_len;
+      iovptr ++;
+      iovcount --;
+    }
+
+    if (iovcount > 0)
+    {
+      iovptr->iov_base = (char *)iovptr->iov_base + written;
+      iovptr->iov_len  -= (size_t)written;
+    }
+  }
+
+  return (count);
+}
+#endif // !_WIN32
+
+
+//
+// 'pappl_buffer_write()' - Buffer data for the device.
+//
+
+static ssize_t				// O - Number of bytes written or `-1` on error
+pappl_buffer_write(
+    pappl_device_t *device,		// I - Device
+    const void     *buffer,		// I - Buffer
+    size_t         bytes)		// I - Bytes to write
+{
+  // Allocate the write buffer as needed...
+  if (!device->buffer && (device->buffer = malloc(device->bufsize)) == NULL)
+    return (pappl_write(device, buffer, bytes));
+
+  if ((device->bufused + bytes) > device->bufsize)
   {
     // Flush the write buffer...
-    if (pappl_write(device, device->buffer, device->bufused) < 0)
+    if (device->bufused > 0 && pappl_write(device, device->buffer, device->bufused) < 0)
       return (-1);
 
     device->bufused = 0;
   }
 
-  if (bytes < sizeof(device->buffer))
+  if (bytes < device->bufsize)
   {
     memcpy(device->buffer + device->bufused, buffer, bytes);
     device->bufused += bytes;
@@ -1165,6 +1525,22 @@ pappl_free_dinfo(_pappl_dinfo_t *d)	// I - Device info
 }
 
 
+//
+// 'pappl_get_nsecs()' - Get the current monotonic time in nanoseconds.
+//
+
+static unsigned long long		// O - Current time in nanoseconds
+pappl_get_nsecs(void)
+{
+  struct timespec	curtime;	// Current time
+
+
+  clock_gettime(CLOCK_MONOTONIC, &curtime);
+
+  return ((unsigned long long)curtime.tv_sec * 1000000000ULL + (unsigned long long)curtime.tv_nsec);
+}
+
+
 //
 // 'pappl_write()' - Write data to the device.
 //
@@ -1174,21 +1550,67 @@ pappl_write(pappl_device_t *device,	// I - Device
             const void     *buffer,	// I - Buffer
             size_t         bytes)	// I - Bytes to write
 {
-  struct timeval	starttime,	// Start time
-			endtime;	// End time
+  pappl_devbuf_t	buf;		// Buffer
+
+
+  buf.data   = buffer;
+  buf.length = bytes;
+
+  return (pappl_writev(device, &buf, 1));
+}
+
+
+//
+// 'pappl_writev()' - Write multiple buffers to the device.
+//
+// More than one buffer requires a gather write callback.
+//
+
+static ssize_t				// O - Number of bytes written or `-1` on error
+pappl_writev(
+    pappl_device_t       *device,	// I - Device
+    const pappl_devbuf_t *bufs,		// I - Buffers to write
+    size_t               num_bufs)	// I - Number of buffers
+{
+  unsigned long long	nsecs;		// Time spent writing
   ssize_t		count;		// Total bytes written
+  size_t		bufsize;	// New buffer size
+  char			*ptr;		// New buffer
 
 
-  gettimeofday(&starttime, NULL);
+  nsecs = pappl_get_nsecs();
 
-  count = (device->write_cb)(device, buffer, bytes);
+  if (num_bufs == 1)
+    count = (device->write_cb)(device, bufs[0].data, bufs[0].length);
+  else
+    count = (device->writev_cb)(device, bufs, num_bufs);
 
-  gettimeofday(&endtime, NULL);
+  nsecs = pappl_get_nsecs() - nsecs;
+
+  device->write_nsecs += nsecs;
 
   device->metrics.write_requests ++;
-  device->metrics.write_msecs += (size_t)(1000 * (endtime.tv_sec - starttime.tv_sec) + (endtime.tv_usec - starttime.tv_usec) / 1000);
+  device->metrics.write_msecs = (size_t)(device->write_nsecs / 1000000);
   if (count > 0)
     device->metrics.write_bytes += (size_t)count;
 
+  // Grow the write buffer when the device can take a full buffer in less than
+  // _PAPPL_DEVICE_FLUSHMS milliseconds, based on the throughput of writes that
+  // are at least half the current buffer size...
+  if (device->bufauto && device->bufsize < _PAPPL_DEVICE_BUFMAX && count > 0 && (size_t)count >= device->bufsize / 2 && (nsecs * device->bufsize / (size_t)count) < (_PAPPL_DEVICE_FLUSHMS * 1000000ULL))
+  {
+    bufsize = 2 * device->bufsize;
+
+    if (!device->buffer)
+    {
+      device->bufsize = bufsize;
+    }
+    else if ((ptr = realloc(device->buffer, bufsize)) != NULL)
+    {
+      device->buffer  = ptr;
+      device->bufsize = bufsize;
+    }
+  }
+
   return (count);
 }
@@ -19,6 +19,12 @@ extern "C" {
 // Types...
 //
 
+typedef struct pappl_devbuf_s		// Device write buffer @since PAPPL 1.4@
+{
+  const void	*data;				// Data to write
+  size_t	length;				// Number of bytes to write
+} pappl_devbuf_t;
+
 typedef struct pappl_devmetrics_s	// Device metrics
 {
   size_t	read_bytes;			// Total number of bytes read
@@ -78,6 +84,7 @@ extern void		papplDeviceAddScheme2(const char *scheme, pappl_devtype_t dtype, pa
 extern void		papplDeviceClose(pappl_device_t *device) _PAPPL_PUBLIC;
 extern void		papplDeviceError(pappl_device_t *device, const char *message, ...) _PAPPL_PUBLIC _PAPPL_FORMAT(2,3);
 extern void		papplDeviceFlush(pappl_device_t *device) _PAPPL_PUBLIC;
+extern size_t		papplDeviceGetBufferSize(pappl_device_t *device) _PAPPL_PUBLIC;
 extern void		*papplDeviceGetData(pappl_device_t *device) _PAPPL_PUBLIC;
 extern char		*papplDeviceGetID(pappl_device_t *device, char *buffer, size_t bufsize) _PAPPL_PUBLIC;
 extern pappl_devmetrics_t *papplDeviceGetMetrics(pappl_device_t *device, pappl_devmetrics_t *metrics) _PAPPL_PUBLIC;
@@ -92,8 +99,10 @@ extern ssize_t		papplDevicePuts(pappl_device_t *device, const char *s) _PAPPL_PU
 extern ssize_t		papplDeviceRead(pappl_device_t *device, void *buffer, size_t bytes) _PAPPL_PUBLIC;
 extern void		papplDeviceRemoveScheme(const char *scheme) _PAPPL_PUBLIC;
 extern void		papplDeviceRemoveTypes(pappl_devtype_t types) _PAPPL_PUBLIC;
+extern bool		papplDeviceSetBufferSize(pappl_device_t *device, size_t bufsize) _PAPPL_PUBLIC;
 extern void		papplDeviceSetData(pappl_device_t *device, void *data) _PAPPL_PUBLIC;
 extern ssize_t		papplDeviceWrite(pappl_device_t *device, const void *buffer, size_t bytes) _PAPPL_PUBLIC;
+extern ssize_t		papplDeviceWritev(pappl_device_t *device, const pappl_devbuf_t *bufs, size_t num_bufs) _PAPPL_PUBLIC;
 
 
 #  ifdef __cplusplus
@@ -0,0 +1,426 @@
+//
+// Device discovery cache for the Printer Application Framework
+//
+// Copyright © 2023 by Michael R Sweet.
+//
+// Licensed under Apache License v2.0.  See the file "LICENSE" for more
+// information.
+//
+// Listing devices can take a long time - DNS-SD browsing runs for several
+// seconds and SNMP discovery for up to 30 seconds.  The discovery cache keeps
+// the devices found for each URI scheme with the time of the last scan, and
+// each scheme is scanned on its own thread so that slow schemes don't hold
+// up the others.  Cached results are used immediately and refreshed in the
+// background once they are `_PAPPL_DISCOVERY_REFRESH` seconds old.  Results
+// older than `_PAPPL_DISCOVERY_MAX_AGE` seconds are not used without waiting
+// for a new scan.  A refresh that is requested while a scan is running queues
+// another scan, since the running scan may have started before the device was
+// connected.
+//
+
+//
+// Include necessary headers...
+//
+
+#include "pappl-private.h"
+
+
+//
+// Local constants...
+//
+
+#define _PAPPL_DISCOVERY_MAX	32	// Maximum number of schemes
+
+
+//
+// Local types...
+//
+
+typedef struct _pappl_dscheme_s		// Discovery cache for a scheme
+{
+  _pappl_devlist_t	list;		// Scheme and list callback
+  bool			scanning,	// Is a scan in progress?
+			rescan;		// Scan again when the current scan completes?
+  size_t		num_started,	// Number of scans started
+			num_completed;	// Number of scans completed
+  time_t		updated;	// Time of last completed scan
+  cups_array_t		*devices;	// Devices from last scan
+} _pappl_dscheme_t;
+
+struct _pappl_discovery_s		// Device discovery cache
+{
+  pthread_mutex_t	mutex;		// Discovery mutex
+  pthread_cond_t	cond;		// Scan completion condition variable
+  cups_array_t		*schemes;	// Schemes
+  size_t		num_scanning;	// Number of scans in progress
+};
+
+typedef struct _pappl_dscan_s		// Discovery scan thread data
+{
+  pappl_system_t	*system;	// System
+  _pappl_dscheme_t	*ds;		// Scheme to scan
+  _pappl_devlist_t	list;		// Copy of scheme and list callback
+} _pappl_dscan_t;
+
+
+//
+// Local functions...
+//
+
+static int	discovery_compare(_pappl_dscheme_t *a, _pappl_dscheme_t *b);
+static void	discovery_free(_pappl_dscheme_t *ds);
+static void	*discovery_scan(_pappl_dscan_t *scan);
+static bool	discovery_start(pappl_system_t *system, _pappl_dscheme_t *ds);
+
+
+//
+// '_papplDiscoveryCreate()' - Create a device discovery cache.
+//
+
+_pappl_discovery_t *			// O - Discovery cache or `NULL` on error
+_papplDiscoveryCreate(void)
+{
+  _pappl_discovery_t	*d;		// Discovery cache
+
+
+  if ((d = (_pappl_discovery_t *)calloc(1, sizeof(_pappl_discovery_t))) == NULL)
+    return (NULL);
+
+  if ((d->schemes = cupsArrayNew((cups_array_cb_t)discovery_compare, NULL, NULL, 0, NULL, (cups_afree_cb_t)discovery_free)) == NULL)
+  {
+    free(d);
+    return (NULL);
+  }
+
+  pthread_mutex_init(&d->mutex, NULL);
+  pthread_cond_init(&d->cond, NULL);
+
+  return (d);
+}
+
+
+//
+// '_papplDiscoveryDelete()' - Delete a device discovery cache.
+//
+// This function waits for any scans in progress to complete.
+//
+
+void
+_papplDiscoveryDelete(
+    _pappl_discovery_t *d)		// I - Discovery cache
+{
+  if (!d)
+    return;
+
+  pthread_mutex_lock(&d->mutex);
+  while (d->num_scanning > 0)
+    pthread_cond_wait(&d->cond, &d->mutex);
+  pthread_mutex_unlock(&d->mutex);
+
+  cupsArrayDelete(d->schemes);
+
+  pthread_cond_destroy(&d->cond);
+  pthread_mutex_destroy(&d->mutex);
+
+  free(d);
+}
+
+
+//
+// '_papplDiscoveryList()' - List devices from the discovery cache.
+//
+// This function calls the "cb" function once per cached device, starting new
+// scans as needed.  If "refresh_msecs" is greater than `0`, all schemes are
+// scanned again and the function waits up to "refresh_msecs" milliseconds for
+// the scans to complete.  Schemes that are already being scanned are scanned
+// again once the current scan completes.
+//
+
+bool					// O - `true` if the callback returned `true`, `false` otherwise
+_papplDiscoveryList(
+    pappl_system_t    *system,		// I - System
+    pappl_devtype_t   types,		// I - Device types
+    int               refresh_msecs,	// I - Milliseconds to wait for a refresh or `0` to use the cache
+    pappl_device_cb_t cb,		// I - Callback function
+    void              *data)		// I - User data for callback
+{
+  _pappl_discovery_t	*d = system->discovery;
+					// Discovery cache
+  bool			ret = false;	// Return value
+  size_t		i,		// Looping var
+			num_lists,	// Number of schemes
+			num_waits = 0;	// Number of schemes to wait for
+  _pappl_devlist_t	lists[_PAPPL_DISCOVERY_MAX];
+					// Schemes
+  _pappl_dscheme_t	key,		// Search key
+			*ds,		// Current scheme
+			*dss[_PAPPL_DISCOVERY_MAX],
+					// Matching schemes
+			*waits[_PAPPL_DISCOVERY_MAX];
+					// Schemes to wait for
+  size_t		wait_scans[_PAPPL_DISCOVERY_MAX];
+					// Scan numbers to wait for
+  time_t		curtime,	// Current time
+			age;		// Age of cached devices
+  struct timeval	deadline;	// Time to stop waiting
+  struct timespec	timeout;	// Timeout for wait
+  cups_array_t		*devices;	// Copy of cached devices
+  _pappl_dinfo_t	*dinfo;		// Current device
+
+
+  // Get the current schemes...
+  num_lists = _papplDeviceCopyListSchemes(types, sizeof(lists) / sizeof(lists[0]), lists);
+
+  if ((devices = _papplDeviceInfoCreateArray()) == NULL)
+    return (false);
+
+  // Start any scans that are needed...
+  pthread_mutex_lock(&d->mutex);
+
+  curtime = time(NULL);
+
+  for (i = 0; i < num_lists; i ++)
+  {
+    papplCopyString(key.list.scheme, lists[i].scheme, sizeof(key.list.scheme));
+
+    if ((ds = (_pappl_dscheme_t *)cupsArrayFind(d->schemes, &key)) == NULL)
+    {
+      // New scheme...
+      if ((ds = (_pappl_dscheme_t *)calloc(1, sizeof(_pappl_dscheme_t))) == NULL)
+        break;
+
+      ds->list = lists[i];
+      cupsArrayAdd(d->schemes, ds);
+    }
+    else
+    {
+      // Schemes can be replaced by the application...
+      ds->list = lists[i];
+    }
+
+    dss[i] = ds;
+    age    = curtime - ds->updated;
+
+    if (refresh_msecs > 0 || !ds->updated || age >= _PAPPL_DISCOVERY_MAX_AGE)
+    {
+      // Scan and wait...
+      if (ds->scanning)
+      {
+        // Wait for the current scan or, for a refresh, the one after it...
+        if (refresh_msecs > 0)
+          ds->rescan = true;
+
+        waits[num_waits]      = ds;
+        wait_scans[num_waits] = refresh_msecs > 0 ? ds->num_started + 1 : ds->num_started;
+        num_waits ++;
+      }
+      else if (discovery_start(system, ds))
+      {
+        waits[num_waits]      = ds;
+        wait_scans[num_waits] = ds->num_started;
+        num_waits ++;
+      }
+    }
+    else if (age >= _PAPPL_DISCOVERY_REFRESH && !ds->scanning)
+    {
+      // Scan in the background...
+      discovery_start(system, ds);
+    }
+  }
+
+  num_lists = i;
+
+  // Wait for scans to complete...
+  if (num_waits > 0)
+  {
+    gettimeofday(&deadline, NULL);
+
+    if (refresh_msecs > 0)
+    {
+      deadline.tv_sec  += refresh_msecs / 1000;
+      deadline.tv_usec += 1000 * (refresh_msecs % 1000);
+
+      if (deadline.tv_usec >= 1000000)
+      {
+        deadline.tv_sec ++;
+        deadline.tv_usec -= 1000000;
+      }
+    }
+    else
+    {
+      // Device list callbacks should stop on their own, this is just a
+      // safety net...
+      deadline.tv_sec += 2 * _PAPPL_DISCOVERY_REFRESH;
+    }
+
+    timeout.tv_sec  = deadline.tv_sec;
+    timeout.tv_nsec = deadline.tv_usec * 1000;
+
+    for (i = 0; i < num_waits;)
+    {
+      if (!waits[i]->scanning || waits[i]->num_completed >= wait_scans[i])
+      {
+        i ++;
+        continue;
+      }
+
+      if (pthread_cond_timedwait(&d->cond, &d->mutex, &timeout) == ETIMEDOUT)
+        break;
+    }
+  }
+
+  // Copy the cached devices so that the callback can be called without
+  // holding the mutex...
+  for (i = 0; i < num_lists; i ++)
+  {
+    for (dinfo = (_pappl_dinfo_t *)cupsArrayGetFirst(dss[i]->devices); dinfo; dinfo = (_pappl_dinfo_t *)cupsArrayGetNext(dss[i]->devices))
+      _papplDeviceInfoCallback(dinfo->device_info, dinfo->device_uri, dinfo->device_id, devices);
+  }
+
+  pthread_mutex_unlock(&d->mutex);
+
+  for (dinfo = (_pappl_dinfo_t *)cupsArrayGetFirst(devices); dinfo && !ret; dinfo = (_pappl_dinfo_t *)cupsArrayGetNext(devices))
+    ret = (cb)(dinfo->device_info, dinfo->device_uri, dinfo->device_id, data);
+
+  cupsArrayDelete(devices);
+
+  return (ret);
+}
+
+
+//
+// 'discovery_compare()' - Compare two discovery schemes.
+//
+
+static int				// O - Result of comparison
+discovery_compare(_pappl_dscheme_t *a,	// I - First scheme
+                  _pappl_dscheme_t *b)	// I - Second scheme
+{
+  return (strcmp(a->list.scheme, b->list.scheme));
+}
+
+
+//
+// 'discovery_free()' - Free a discovery scheme.
+//
+
+static void
+discovery_free(_pappl_dscheme_t *ds)	// I - Scheme
+{
+  cupsArrayDelete(ds->devices);
+  free(ds);
+}
+
+
+//
+// 'discovery_scan()' - Scan for devices using a single scheme.
+//
+
+static void *				// O - Thread exit status
+discovery_scan(_pappl_dscan_t *scan)	// I - Scan data
+{
+  pappl_system_t	*system = scan->system;
+					// System
+  _pappl_discovery_t	*d = system->discovery;
+					// Discovery cache
+  _pappl_dscheme_t	*ds = scan->ds;	// Scheme
+  cups_array_t		*devices;	// Devices found
+  struct timeval	start,		// Start time
+			end;		// End time
+
+
+  for (;;)
+  {
+    // Scan using the copy of the scheme so that the cache can be updated while
+    // we scan...
+    papplLog(system, PAPPL_LOGLEVEL_DEBUG, "Scanning for '%s' devices.", scan->list.scheme);
+
+    gettimeofday(&start, NULL);
+
+    if ((devices = _papplDeviceInfoCreateArray()) != NULL)
+      (scan->list.list_cb)((pappl_device_cb_t)_papplDeviceInfoCallback, devices, papplLogDevice, system);
+
+    gettimeofday(&end, NULL);
+
+    papplLog(system, PAPPL_LOGLEVEL_DEBUG, "Found %u '%s' device(s) in %.3f seconds.", (unsigned)cupsArrayGetCount(devices), scan->list.scheme, (end.tv_sec - start.tv_sec) + 0.000001 * (end.tv_usec - start.tv_usec));
+
+    // Replace the cached devices...
+    pthread_mutex_lock(&d->mutex);
+
+    if (devices)
+    {
+      cupsArrayDelete(ds->devices);
+      ds->devices = devices;
+      ds->updated = time(NULL);
+    }
+
+    ds->num_completed ++;
+
+    pthread_cond_broadcast(&d->cond);
+
+    if (!ds->rescan)
+      break;
+
+    // Scan again for a refresh that was requested during this scan...
+    ds->rescan = false;
+    ds->num_started ++;
+    scan->list = ds->list;
+
+    pthread_mutex_unlock(&d->mutex);
+  }
+
+  ds->scanning = false;
+  d->num_scanning --;
+
+  pthread_cond_broadcast(&d->cond);
+  pthread_mutex_unlock(&d->mutex);
+
+  free(scan);
+
+  return (NULL);
+}
+
+
+//
+// 'discovery_start()' - Start a scan for a scheme.
+//
+// The discovery mutex must be held when calling this function.
+//
+
+static bool				// O - `true` on success, `false` on error
+discovery_start(
+    pappl_system_t   *system,		// I - System
+    _pappl_dscheme_t *ds)		// I - Scheme
+{
+  _pappl_dscan_t	*scan;		// Scan data
+  pthread_t		tid;		// Scan thread
+
+
+  if ((scan = (_pappl_dscan_t *)calloc(1, sizeof(_pappl_dscan_t))) == NULL)
+    return (false);
+
+  scan->system = system;
+  scan->ds     = ds;
+  scan->list   = ds->list;
+  ds->scanning = true;
+  ds->rescan   = false;
+  ds->num_started ++;
+
+  system->discovery->num_scanning ++;
+
+  if (pthread_create(&tid, NULL, (void *(*)(void *))discovery_scan, scan))
+  {
+    papplLog(system, PAPPL_LOGLEVEL_ERROR, "Unable to create device discovery thread: %s", strerror(errno));
+
+    ds->scanning = false;
+    ds->num_started --;
+    system->discovery->num_scanning --;
+    free(scan);
+
+    return (false);
+  }
+
+  pthread_detach(tid);
+
+  return (true);
+}
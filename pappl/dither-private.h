@@ -0,0 +1,24 @@
+//
+// Private dither definitions for the Printer Application Framework
+//
+// Copyright © 2023 by Michael R Sweet.
+//
+// Licensed under Apache License v2.0.  See the file "LICENSE" for more
+// information.
+//
+
+#ifndef _PAPPL_DITHER_PRIVATE_H_
+#  define _PAPPL_DITHER_PRIVATE_H_
+#  include "base-private.h"
+
+
+//
+// Functions...
+//
+
+extern void		_papplDitherLine(unsigned char *line, const unsigned char *pixels, unsigned width, const unsigned char *dither, bool black) _PAPPL_PRIVATE;
+extern const char	*_papplDitherGetVariant(void) _PAPPL_PRIVATE;
+extern bool		_papplDitherSetVariant(const char *name) _PAPPL_PRIVATE;
+
+
+#endif // !_PAPPL_DITHER_PRIVATE_H_
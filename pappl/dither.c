@@ -0,0 +1,376 @@
+//
+// Dither functions for the Printer Application Framework
+//
+// Copyright © 2023 by Michael R Sweet.
+//
+// Licensed under Apache License v2.0.  See the file "LICENSE" for more
+// information.
+//
+// The dither functions convert a line of 8-bit grayscale or black pixels to a
+// 1-bit bitmap using a 16x16 ordered dither matrix.  Vectorized versions of
+// the conversion are provided for SSE2, AVX2, and NEON - the best version
+// supported by the current CPU is chosen the first time a line is dithered.
+// All versions produce the same output as the scalar version.
+//
+
+//
+// Include necessary headers...
+//
+
+#include "dither-private.h"
+#if defined(__x86_64__) || defined(_M_X64) || (defined(__i386__) && defined(__SSE2__))
+#  define _PAPPL_DITHER_SSE2 1
+#  include <emmintrin.h>
+#  if defined(__GNUC__) && (defined(__clang__) || __GNUC__ >= 5)
+#    define _PAPPL_DITHER_AVX2 1
+#    include <immintrin.h>
+#  endif // __GNUC__ && (__clang__ || __GNUC__ >= 5)
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#  define _PAPPL_DITHER_NEON 1
+#  include <arm_neon.h>
+#endif // __x86_64__ || _M_X64 || (__i386__ && __SSE2__)
+
+
+//
+// Local types...
+//
+
+typedef void (*_pappl_dither_cb_t)(unsigned char *line, const unsigned char *pixels, unsigned width, const unsigned char *dither, bool black);
+					// Dither function
+
+typedef struct _pappl_dither_variant_s	// Dither function variant
+{
+  const char		*name;		// Name of variant
+  _pappl_dither_cb_t	cb;		// Dither function
+  bool			(*supported_cb)(void);
+					// Is the variant supported by this CPU?
+} _pappl_dither_variant_t;
+
+
+//
+// Local functions...
+//
+
+#ifdef _PAPPL_DITHER_AVX2
+static void	dither_avx2(unsigned char *line, const unsigned char *pixels, unsigned width, const unsigned char *dither, bool black);
+static bool	dither_avx2_supported(void);
+#endif // _PAPPL_DITHER_AVX2
+static void	dither_init(void);
+#ifdef _PAPPL_DITHER_NEON
+static void	dither_neon(unsigned char *line, const unsigned char *pixels, unsigned width, const unsigned char *dither, bool black);
+#endif // _PAPPL_DITHER_NEON
+static void	dither_scalar(unsigned char *line, const unsigned char *pixels, unsigned width, const unsigned char *dither, bool black);
+#ifdef _PAPPL_DITHER_SSE2
+static void	dither_sse2(unsigned char *line, const unsigned char *pixels, unsigned width, const unsigned char *dither, bool black);
+#endif // _PAPPL_DITHER_SSE2
+
+
+//
+// Local globals...
+//
+
+static const _pappl_dither_variant_t dither_variants[] =
+{					// Dither variants, best first
+#ifdef _PAPPL_DITHER_AVX2
+  { "avx2", dither_avx2, dither_avx2_supported },
+#endif // _PAPPL_DITHER_AVX2
+#ifdef _PAPPL_DITHER_SSE2
+  { "sse2", dither_sse2, NULL },
+#endif // _PAPPL_DITHER_SSE2
+#ifdef _PAPPL_DITHER_NEON
+  { "neon", dither_neon, NULL },
+#endif // _PAPPL_DITHER_NEON
+  { "scalar", dither_scalar, NULL }
+};
+static pthread_once_t	dither_once = PTHREAD_ONCE_INIT;
+					// One-time initialization control
+static const _pappl_dither_variant_t *dither_variant = NULL;
+					// Current dither variant
+
+
+//
+// '_papplDitherGetVariant()' - Get the name of the current dither variant.
+//
+
+const char *				// O - Name of variant ("avx2", "neon", "scalar", or "sse2")
+_papplDitherGetVariant(void)
+{
+  pthread_once(&dither_once, dither_init);
+
+  return (dither_variant->name);
+}
+
+
+//
+// '_papplDitherLine()' - Dither a line of 8-bit pixels to a 1-bit bitmap.
+//
+// The "black" argument specifies the polarity of the pixels - `true` for black
+// (0 = white) pixels and `false` for grayscale (255 = white) pixels.  Pixel "x"
+// is compared against `dither[x & 15]` and bits are stored most significant
+// bit first.  Exactly `(width + 7) / 8` bytes are stored in the "line" buffer
+// with any unused bits in the last byte cleared.
+//
+
+void
+_papplDitherLine(
+    unsigned char       *line,		// I - Output bitmap line
+    const unsigned char *pixels,	// I - Input pixels
+    unsigned            width,		// I - Number of pixels
+    const unsigned char *dither,	// I - Dither matrix line (16 values)
+    bool                black)		// I - `true` for black pixels, `false` for grayscale pixels
+{
+  pthread_once(&dither_once, dither_init);
+
+  (dither_variant->cb)(line, pixels, width, dither, black);
+}
+
+
+//
+// '_papplDitherSetVariant()' - Set the current dither variant.
+//
+// This function is used by the unit tests and benchmarks to select a specific
+// variant.  Passing `NULL` selects the best variant for the current CPU.
+//
+
+bool					// O - `true` on success, `false` if not supported
+_papplDitherSetVariant(
+    const char *name)			// I - Name of variant or `NULL` for the default
+{
+  size_t	i;			// Looping var
+
+
+  pthread_once(&dither_once, dither_init);
+
+  for (i = 0; i < (sizeof(dither_variants) / sizeof(dither_variants[0])); i ++)
+  {
+    if (dither_variants[i].supported_cb && !(dither_variants[i].supported_cb)())
+      continue;
+
+    if (!name || !strcmp(name, dither_variants[i].name))
+    {
+      dither_variant = dither_variants + i;
+      return (true);
+    }
+  }
+
+  return (false);
+}
+
+
+#ifdef _PAPPL_DITHER_AVX2
+//
+// 'dither_avx2()' - Dither a line using AVX2 instructions.
+//
+
+__attribute__((target("avx2")))
+static void
+dither_avx2(
+    unsigned char       *line,		// I - Output bitmap line
+    const unsigned char *pixels,	// I - Input pixels
+    unsigned            width,		// I - Number of pixels
+    const unsigned char *dither,	// I - Dither matrix line (16 values)
+    bool                black)		// I - `true` for black pixels, `false` for grayscale pixels
+{
+  unsigned	x;			// Current column
+  __m256i	threshold,		// Dither values
+		weights,		// Bit weights for each pixel
+		zero,			// Zero vector
+		pixel,			// Pixels
+		mask;			// Comparison mask
+  uint64_t	bytes[4];		// Output bytes
+
+
+  threshold = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)dither));
+  weights   = _mm256_setr_epi8((char)128, 64, 32, 16, 8, 4, 2, 1, (char)128, 64, 32, 16, 8, 4, 2, 1, (char)128, 64, 32, 16, 8, 4, 2, 1, (char)128, 64, 32, 16, 8, 4, 2, 1);
+  zero      = _mm256_setzero_si256();
+
+  for (x = 0; (x + 32) <= width; x += 32, pixels += 32, line += 4)
+  {
+    // Compare 32 pixels (pixel <= dither) and sum the bit weights for each
+    // group of 8 pixels...
+    pixel = _mm256_loadu_si256((const __m256i *)pixels);
+    mask  = _mm256_cmpeq_epi8(_mm256_min_epu8(pixel, threshold), pixel);
+
+    if (black)
+      mask = _mm256_andnot_si256(mask, weights);
+    else
+      mask = _mm256_and_si256(mask, weights);
+
+    _mm256_storeu_si256((__m256i *)bytes, _mm256_sad_epu8(mask, zero));
+
+    line[0] = (unsigned char)bytes[0];
+    line[1] = (unsigned char)bytes[1];
+    line[2] = (unsigned char)bytes[2];
+    line[3] = (unsigned char)bytes[3];
+  }
+
+  // Dither any remaining pixels...
+  if (x < width)
+    dither_sse2(line, pixels, width - x, dither, black);
+}
+
+
+//
+// 'dither_avx2_supported()' - Determine whether the CPU supports AVX2.
+//
+
+static bool				// O - `true` if supported, `false` otherwise
+dither_avx2_supported(void)
+{
+  return (__builtin_cpu_supports("avx2") != 0);
+}
+#endif // _PAPPL_DITHER_AVX2
+
+
+//
+// 'dither_init()' - Choose the best dither variant for the current CPU.
+//
+
+static void
+dither_init(void)
+{
+  size_t	i;			// Looping var
+
+
+  for (i = 0; i < (sizeof(dither_variants) / sizeof(dither_variants[0])); i ++)
+  {
+    if (!dither_variants[i].supported_cb || (dither_variants[i].supported_cb)())
+      break;
+  }
+
+  dither_variant = dither_variants + i;
+}
+
+
+#ifdef _PAPPL_DITHER_NEON
+//
+// 'dither_neon()' - Dither a line using NEON instructions.
+//
+
+static void
+dither_neon(
+    unsigned char       *line,		// I - Output bitmap line
+    const unsigned char *pixels,	// I - Input pixels
+    unsigned            width,		// I - Number of pixels
+    const unsigned char *dither,	// I - Dither matrix line (16 values)
+    bool                black)		// I - `true` for black pixels, `false` for grayscale pixels
+{
+  unsigned	x;			// Current column
+  uint8x16_t	threshold,		// Dither values
+		weights,		// Bit weights for each pixel
+		mask;			// Comparison mask
+  uint64x2_t	bytes;			// Output bytes
+  static const unsigned char bits[16] = { 128, 64, 32, 16, 8, 4, 2, 1, 128, 64, 32, 16, 8, 4, 2, 1 };
+					// Bit weights
+
+
+  threshold = vld1q_u8(dither);
+  weights   = vld1q_u8(bits);
+
+  for (x = 0; (x + 16) <= width; x += 16, pixels += 16, line += 2)
+  {
+    // Compare 16 pixels (pixel <= dither) and sum the bit weights for each
+    // group of 8 pixels...
+    mask = vcleq_u8(vld1q_u8(pixels), threshold);
+
+    if (black)
+      mask = vmvnq_u8(mask);
+
+    bytes = vpaddlq_u32(vpaddlq_u16(vpaddlq_u8(vandq_u8(mask, weights))));
+
+    line[0] = (unsigned char)vgetq_lane_u64(bytes, 0);
+    line[1] = (unsigned char)vgetq_lane_u64(bytes, 1);
+  }
+
+  // Dither any remaining pixels...
+  if (x < width)
+    dither_scalar(line, pixels, width - x, dither, black);
+}
+#endif // _PAPPL_DITHER_NEON
+
+
+//
+// 'dither_scalar()' - Dither a line using portable C code.
+//
+
+static void
+dither_scalar(
+    unsigned char       *line,		// I - Output bitmap line
+    const unsigned char *pixels,	// I - Input pixels
+    unsigned            width,		// I - Number of pixels
+    const unsigned char *dither,	// I - Dither matrix line (16 values)
+    bool                black)		// I - `true` for black pixels, `false` for grayscale pixels
+{
+  unsigned	x;			// Current column
+  unsigned char	byte,			// Byte in line
+		bit;			// Current bit
+
+
+  for (x = 0, bit = 128, byte = 0; x < width; x ++, pixels ++)
+  {
+    if ((*pixels <= dither[x & 15]) != black)
+      byte |= bit;
+
+    if (bit == 1)
+    {
+      *line++ = byte;
+      byte    = 0;
+      bit     = 128;
+    }
+    else
+      bit /= 2;
+  }
+
+  if (bit < 128)
+    *line = byte;
+}
+
+
+#ifdef _PAPPL_DITHER_SSE2
+//
+// 'dither_sse2()' - Dither a line using SSE2 instructions.
+//
+
+static void
+dither_sse2(
+    unsigned char       *line,		// I - Output bitmap line
+    const unsigned char *pixels,	// I - Input pixels
+    unsigned            width,		// I - Number of pixels
+    const unsigned char *dither,	// I - Dither matrix line (16 values)
+    bool                black)		// I - `true` for black pixels, `false` for grayscale pixels
+{
+  unsigned	x;			// Current column
+  __m128i	threshold,		// Dither values
+		weights,		// Bit weights for each pixel
+		zero,			// Zero vector
+		pixel,			// Pixels
+		mask;			// Comparison mask
+
+
+  threshold = _mm_loadu_si128((const __m128i *)dither);
+  weights   = _mm_setr_epi8((char)128, 64, 32, 16, 8, 4, 2, 1, (char)128, 64, 32, 16, 8, 4, 2, 1);
+  zero      = _mm_setzero_si128();
+
+  for (x = 0; (x + 16) <= width; x += 16, pixels += 16, line += 2)
+  {
+    // Compare 16 pixels (pixel <= dither) and sum the bit weights for each
+    // group of 8 pixels...
+    pixel = _mm_loadu_si128((const __m128i *)pixels);
+    mask  = _mm_cmpeq_epi8(_mm_min_epu8(pixel, threshold), pixel);
+
+    if (black)
+      mask = _mm_andnot_si128(mask, weights);
+    else
+      mask = _mm_and_si128(mask, weights);
+
+    mask = _mm_sad_epu8(mask, zero);
+
+    line[0] = (unsigned char)_mm_cvtsi128_si32(mask);
+    line[1] = (unsigned char)_mm_extract_epi16(mask, 4);
+  }
+
+  // Dither any remaining pixels...
+  if (x < width)
+    dither_scalar(line, pixels, width - x, dither, black);
+}
+#endif // _PAPPL_DITHER_SSE2
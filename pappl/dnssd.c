@@ -519,6 +519,7 @@ _papplPrinterRegisterDNSSDNoLock(
       papplLogPrinter(printer, PAPPL_LOGLEVEL_INFO, "DNS-SD name collision, trying new DNS-SD service name '%s'.", printer->dns_sd_name);
 
       printer->dns_sd_collision = false;
+      printer->config_version ++;
     }
     else
     {
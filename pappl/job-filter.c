@@ -23,10 +23,47 @@
 #endif // HAVE_LIBPNG
 
 
+//
+// Local constants...
+//
+
+#define _PAPPL_IMAGE_BAND_LINES	32	// Number of lines buffered for portrait images
+#define _PAPPL_IMAGE_BAND_SIZE	(16 * 1024 * 1024)
+					// Maximum size of buffered band for other orientations
+
+
 //
 // Local types...
 //
 
+typedef struct _pappl_image_s		// Image source data
+{
+  pappl_job_t		*job;			// Job
+  pappl_image_row_cb_t	row_cb;			// Row callback, if any
+  void			*row_data;		// Row callback data
+  int			width,			// Width in columns
+			height,			// Height in lines
+			depth;			// Bytes per pixel
+  ipp_orient_t		orient;			// Orientation of image on page
+  int			rotated_height,		// Height of rotated image
+			band_lines;		// Maximum number of rotated lines in band
+  int			next_row;		// Next row from callback
+  size_t		num_reads;		// Number of passes through the image
+  unsigned char		*row,			// Row buffer for callback
+			*bandbuf;		// Band buffer for callback
+  const unsigned char	*band;			// Band of pixels
+  size_t		bandsize;		// Size of band in bytes
+  int			first,			// First rotated line in band
+			last;			// Last rotated line in band
+  int			sx,			// Left column of band in source image
+			sy,			// Top row of band in source image
+			sw,			// Width of band in source image
+			sh;			// Height of band in source image
+  ptrdiff_t		origin,			// Offset to rotated pixel (0,0)
+			xdir,			// Offset to next rotated column
+			ydir;			// Offset to next rotated line
+} _pappl_image_t;
+
 #ifdef HAVE_LIBJPEG
 typedef struct _pappl_jpeg_err_s	// JPEG error manager extension
 {
@@ -34,22 +71,84 @@ typedef struct _pappl_jpeg_err_s	// JPEG error manager extension
   jmp_buf	retbuf;				// setjmp() return buffer
   char		message[JMSG_LENGTH_MAX];	// Last error message
 } _pappl_jpeg_err_t;
+
+typedef struct _pappl_jpeg_s		// JPEG image reader data
+{
+  FILE			*fp;			// JPEG file
+  const char		*filename;		// JPEG filename
+  struct jpeg_decompress_struct	dinfo;		// Decompressor info
+  _pappl_jpeg_err_t	jerr;			// Error handler info
+  J_COLOR_SPACE		color_space;		// Output color space
+  int			next_row;		// Next row to decompress
+} _pappl_jpeg_t;
 #endif // HAVE_LIBJPEG
 
+#ifdef HAVE_LIBPNG
+typedef struct _pappl_png_s		// PNG image reader data
+{
+  FILE			*fp;			// PNG file
+  png_structp		pp;			// PNG read pointer
+  png_infop		info;			// PNG info pointer
+  int			next_row;		// Next row to read
+} _pappl_png_t;
+#endif // HAVE_LIBPNG
+
 
 //
 // Local functions...
 //
 
+static bool	filter_image(pappl_job_t *job, pappl_device_t *device, pappl_pr_options_t *options, _pappl_image_t *img, int ppi, bool smoothing);
+static bool	image_fill(_pappl_image_t *img, int first, int last);
+static void	image_layout(_pappl_image_t *img);
 #ifdef HAVE_LIBJPEG
 static void	jpeg_error_handler(j_common_ptr p) _PAPPL_NORETURN;
+static bool	jpeg_row_cb(pappl_job_t *job, int y, unsigned char *row, _pappl_jpeg_t *jpeg);
+static void	jpeg_start(_pappl_jpeg_t *jpeg);
 #endif // HAVE_LIBJPEG
 #ifdef HAVE_LIBPNG
 static void	png_error_func(png_structp pp, png_const_charp message);
+static bool	png_row_cb(pappl_job_t *job, int y, unsigned char *row, _pappl_png_t *png);
+static bool	png_start(pappl_job_t *job, _pappl_png_t *png);
 static void	png_warning_func(png_structp pp, png_const_charp message);
 #endif // HAVE_LIBPNG
 
 
+//
+// '_papplJobFilterAddImageMetrics()' - Add the image row counts for a job.
+//
+
+void
+_papplJobFilterAddImageMetrics(
+    pappl_system_t *system,		// I - System
+    size_t         reads,		// I - Number of passes through the image
+    size_t         rows)		// I - Number of rows in the image
+{
+  pthread_mutex_lock(&system->imetrics_mutex);
+
+  system->imetrics.images ++;
+  system->imetrics.reads += reads;
+  system->imetrics.rows  += rows;
+
+  pthread_mutex_unlock(&system->imetrics_mutex);
+}
+
+
+//
+// '_papplJobFilterCopyImageMetrics()' - Copy the image filter metrics.
+//
+
+void
+_papplJobFilterCopyImageMetrics(
+    pappl_system_t   *system,		// I - System
+    pappl_imetrics_t *metrics)		// I - Buffer for metrics data
+{
+  pthread_mutex_lock(&system->imetrics_mutex);
+  *metrics = system->imetrics;
+  pthread_mutex_unlock(&system->imetrics_mutex);
+}
+
+
 //
 // 'papplJobFilterImage()' - Filter an image in memory.
 //
@@ -64,6 +163,9 @@ static void	png_warning_func(png_structp pp, png_const_charp message);
 // some "print-scaling" modes.  Pass `0` if the image has no explicit resolution
 // information.
 //
+// Use the @link papplJobFilterImageRows@ function to print large images without
+// first loading the entire image into memory.
+//
 
 bool					// O - `true` on success, `false` otherwise
 papplJobFilterImage(
@@ -76,10 +178,350 @@ papplJobFilterImage(
     int                 depth,		// I - Bytes per pixel (`1` for grayscale or `3` for sRGB)
     int                 ppi,		// I - Pixels per inch (`0` for unknown)
     bool		smoothing)	// I - `true` to smooth/interpolate the image, `false` for nearest-neighbor sampling
+{
+  _pappl_image_t	img;		// Image source data
+
+
+  // The whole image is the band...
+  memset(&img, 0, sizeof(img));
+
+  img.job      = job;
+  img.width    = width;
+  img.height   = height;
+  img.depth    = depth;
+  img.band     = pixels;
+  img.bandsize = (size_t)width * (size_t)height * (size_t)depth;
+  img.sw       = width;
+  img.sh       = height;
+
+  return (filter_image(job, device, options, &img, ppi, smoothing));
+}
+
+
+//
+// 'papplJobFilterImageRows()' - Filter an image that is read a row at a time.
+//
+// This function will print a grayscale or sRGB image using the printer's raster
+// driver interface, scaling and positioning the image as necessary based on
+// the job options, and printing as many copies as requested.  Unlike
+// @link papplJobFilterImage@, the image is read one row at a time using the
+// "row_cb" callback and only a small band of the image is kept in memory.
+//
+// The "row_cb" callback is called with the row number ("y") and a buffer for
+// `width * depth` bytes of grayscale ("depth" = `1`) or sRGB ("depth" = `3`)
+// pixels.  Rows are always requested in order starting at row `0`.  When the
+// image needs to be read again, for example to print multiple copies or a
+// rotated image, the callback is called with row `0` and must restart at the
+// top of the image.  The callback returns `true` on success or `false` on
+// error.
+//
+// The image resolution ("ppi") is expressed in pixels per inch and is used for
+// some "print-scaling" modes.  Pass `0` if the image has no explicit resolution
+// information.
+//
+// @since PAPPL 1.4@
+//
+
+bool					// O - `true` on success, `false` otherwise
+papplJobFilterImageRows(
+    pappl_job_t          *job,		// I - Job
+    pappl_device_t       *device,	// I - Device
+    pappl_pr_options_t   *options,	// I - Print options
+    pappl_image_row_cb_t row_cb,	// I - Row callback
+    void                 *row_data,	// I - Row callback data
+    int                  width,		// I - Width in columns
+    int                  height,	// I - Height in lines
+    int                  depth,		// I - Bytes per pixel (`1` for grayscale or `3` for sRGB)
+    int                  ppi,		// I - Pixels per inch (`0` for unknown)
+    bool                 smoothing)	// I - `true` to smooth/interpolate the image, `false` for nearest-neighbor sampling
+{
+  _pappl_image_t	img;		// Image source data
+  bool			ret;		// Return value
+
+
+  if (!row_cb || width < 1 || height < 1 || (depth != 1 && depth != 3))
+    return (false);
+
+  // Start with an empty band...
+  memset(&img, 0, sizeof(img));
+
+  img.job      = job;
+  img.row_cb   = row_cb;
+  img.row_data = row_data;
+  img.width    = width;
+  img.height   = height;
+  img.depth    = depth;
+  img.last     = -1;
+
+  ret = filter_image(job, device, options, &img, ppi, smoothing);
+
+  _papplJobFilterAddImageMetrics(job->system, img.num_reads, (size_t)height);
+
+  free(img.row);
+  free(img.bandbuf);
+
+  return (ret);
+}
+
+
+//
+// '_papplJobFilterJPEG()' - Filter a JPEG image file.
+//
+
+#ifdef HAVE_LIBJPEG
+bool
+_papplJobFilterJPEG(
+    pappl_job_t    *job,		// I - Job
+    pappl_device_t *device,		// I - Device
+    void           *data)		// I - Filter data (unused)
+{
+  _pappl_jpeg_t		jpeg;		// JPEG reader data
+  pappl_pr_options_t	*options = NULL;// Job options
+  int			xdpi,		// X pixels per inch
+			ydpi;		// Y pixels per inch
+  bool			ret = false;	// Return value
+
+
+  (void)data;
+
+  // Open the JPEG file...
+  memset(&jpeg, 0, sizeof(jpeg));
+
+  jpeg.filename = papplJobGetFilename(job);
+  if ((jpeg.fp = fopen(jpeg.filename, "rb")) == NULL)
+  {
+    papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to open JPEG file '%s': %s", jpeg.filename, strerror(errno));
+    return (false);
+  }
+
+  // Read the image header...
+  jpeg_std_error(&jpeg.jerr.jerr);
+  jpeg.jerr.jerr.error_exit = jpeg_error_handler;
+
+  if (setjmp(jpeg.jerr.retbuf))
+  {
+    // JPEG library errors are directed to this point...
+    papplJobSetReasons(job, PAPPL_JREASON_DOCUMENT_FORMAT_ERROR, PAPPL_JREASON_NONE);
+    papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to open JPEG file '%s': %s", jpeg.filename, jpeg.jerr.message);
+    ret = false;
+    goto finish_jpeg;
+  }
+
+  jpeg.dinfo.err = (struct jpeg_error_mgr *)&jpeg.jerr;
+  jpeg_create_decompress(&jpeg.dinfo);
+  jpeg_stdio_src(&jpeg.dinfo, jpeg.fp);
+  jpeg_read_header(&jpeg.dinfo, TRUE);
+
+  // Get job options and request the image data in the format we need...
+  options = papplJobCreatePrintOptions(job, 1, jpeg.dinfo.num_components > 1);
+
+  jpeg.color_space = options->header.cupsNumColors == 1 ? JCS_GRAYSCALE : JCS_RGB;
+
+  jpeg_start(&jpeg);
+
+  papplLogJob(job, PAPPL_LOGLEVEL_INFO, "JPEG image dimensions are %ux%ux%d", jpeg.dinfo.output_width, jpeg.dinfo.output_height, jpeg.dinfo.output_components);
+
+  if (jpeg.dinfo.output_width < 1 || jpeg.dinfo.output_width > (JDIMENSION)job->system->max_image_width || jpeg.dinfo.output_height < 1 || jpeg.dinfo.output_height > (JDIMENSION)job->system->max_image_height || ((size_t)jpeg.dinfo.output_width * (size_t)jpeg.dinfo.output_height * (size_t)jpeg.dinfo.output_components) > job->system->max_image_size)
+  {
+    papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "JPEG image is too large to print.");
+    papplJobSetReasons(job, PAPPL_JREASON_DOCUMENT_UNPRINTABLE_ERROR, PAPPL_JREASON_NONE);
+    goto finish_jpeg;
+  }
+
+  switch (jpeg.dinfo.density_unit)
+  {
+    default :
+    case 0 : // Unknown units
+	xdpi = ydpi = 0;
+	break;
+    case 1 : // Dots-per-inch
+	xdpi = jpeg.dinfo.X_density;
+	ydpi = jpeg.dinfo.Y_density;
+	break;
+    case 2 : // Dots-per-centimeter
+	xdpi = jpeg.dinfo.X_density * 254 / 100;
+	ydpi = jpeg.dinfo.Y_density * 254 / 100;
+	break;
+  }
+
+  papplLogJob(job, PAPPL_LOGLEVEL_INFO, "JPEG image resolution is %dx%ddpi", xdpi, ydpi);
+  if (xdpi != ydpi)
+  {
+    papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "JPEG image has non-square aspect ratio - not currently supported.");
+    papplJobSetReasons(job, PAPPL_JREASON_DOCUMENT_UNPRINTABLE_ERROR, PAPPL_JREASON_NONE);
+    goto finish_jpeg;
+  }
+
+  // Decompress and print the image a band at a time...
+  jpeg_start_decompress(&jpeg.dinfo);
+
+  ret = papplJobFilterImageRows(job, device, options, (pappl_image_row_cb_t)jpeg_row_cb, &jpeg, (int)jpeg.dinfo.output_width, (int)jpeg.dinfo.output_height, jpeg.dinfo.output_components, xdpi, true);
+
+  finish_jpeg:
+
+  papplJobDeletePrintOptions(options);
+  jpeg_destroy_decompress(&jpeg.dinfo);
+  fclose(jpeg.fp);
+
+  return (ret);
+}
+#endif // HAVE_LIBJPEG
+
+
+//
+// 'process_png()' - Process a PNG image file.
+//
+
+#ifdef HAVE_LIBPNG
+bool					// O - `true` on success and `false` otherwise
+_papplJobFilterPNG(
+    pappl_job_t    *job,		// I - Job
+    pappl_device_t *device,		// I - Device
+    void           *data)		// I - Filter data (unused)
+{
+  const char		*filename;	// Job filename
+  _pappl_png_t		png;		// PNG reader data
+  pappl_pr_options_t	*options = NULL;// Job options
+  png_bytep		*rows = NULL;	// PNG row pointers
+  int			i,		// Looping var
+			width,		// Width in columns
+			height,		// Height in lines
+			depth,		// Bytes per pixel
+			xdpi,		// X resolution
+			ydpi;		// Y resolution
+  unsigned char		*pixels = NULL;	// Image pixels
+  bool			ret = false;	// Return value
+
+
+  // Open the PNG file...
+  (void)data;
+
+  memset(&png, 0, sizeof(png));
+
+  filename = papplJobGetFilename(job);
+  if ((png.fp = fopen(filename, "rb")) == NULL)
+  {
+    papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to open PNG file '%s': %s", filename, strerror(errno));
+    return (false);
+  }
+
+  // Get the image dimensions and depth...
+  if (!png_start(job, &png))
+    goto finish_png;
+
+  width  = (int)png_get_image_width(png.pp, png.info);
+  height = (int)png_get_image_height(png.pp, png.info);
+
+  if (png_get_color_type(png.pp, png.info) & PNG_COLOR_MASK_COLOR)
+    depth = 3;
+  else
+    depth = 1;
+
+  papplLogJob(job, PAPPL_LOGLEVEL_INFO, "PNG image dimensions are %dx%dx%d", width, height, depth);
+
+  if (width < 1 || width > job->system->max_image_width || height < 1 || height > job->system->max_image_height || (size_t)(width * height * depth) > job->system->max_image_size)
+  {
+    papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "PNG image is too large to print.");
+    papplJobSetReasons(job, PAPPL_JREASON_DOCUMENT_UNPRINTABLE_ERROR, PAPPL_JREASON_NONE);
+    goto finish_png;
+  }
+
+  xdpi = (int)png_get_x_pixels_per_inch(png.pp, png.info);
+  ydpi = (int)png_get_y_pixels_per_inch(png.pp, png.info);
+
+  papplLogJob(job, PAPPL_LOGLEVEL_INFO, "PNG image resolution is %dx%ddpi", xdpi, ydpi);
+
+  if (xdpi != ydpi)
+  {
+    papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "PNG image has non-square aspect ratio - not currently supported.");
+    papplJobSetReasons(job, PAPPL_JREASON_DOCUMENT_UNPRINTABLE_ERROR, PAPPL_JREASON_NONE);
+    goto finish_png;
+  }
+
+  // Prepare options...
+  options = papplJobCreatePrintOptions(job, 1, depth == 3);
+
+  if (png_get_interlace_type(png.pp, png.info) == PNG_INTERLACE_NONE)
+  {
+    // Read and print the image a band at a time...
+    ret = papplJobFilterImageRows(job, device, options, (pappl_image_row_cb_t)png_row_cb, &png, width, height, depth, xdpi, false);
+    goto finish_png;
+  }
+
+  // Interlaced images need to be loaded into memory...
+  if ((pixels = (unsigned char *)calloc(1, (size_t)(width * height * depth))) == NULL)
+  {
+    papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to allocate memory for PNG image: %s", strerror(errno));
+    papplJobSetReasons(job, PAPPL_JREASON_DOCUMENT_UNPRINTABLE_ERROR, PAPPL_JREASON_NONE);
+    goto finish_png;
+  }
+
+  if ((rows = (png_bytep *)calloc((size_t)height, sizeof(png_bytep))) == NULL)
+  {
+    papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to allocate memory for PNG image: %s", strerror(errno));
+    papplJobSetReasons(job, PAPPL_JREASON_DOCUMENT_UNPRINTABLE_ERROR, PAPPL_JREASON_NONE);
+    goto finish_png;
+  }
+
+  for (i = 0; i < height; i ++)
+    rows[i] = pixels + i * width * depth;
+
+  if (setjmp(png_jmpbuf(png.pp)))
+  {
+    // If we get here, PNG loading failed and any errors/warnings were logged
+    // via the corresponding callback functions...
+    papplJobSetReasons(job, PAPPL_JREASON_DOCUMENT_FORMAT_ERROR, PAPPL_JREASON_NONE);
+    goto finish_png;
+  }
+
+  // Read the image...
+  for (i = png_set_interlace_handling(png.pp); i > 0; i --)
+    png_read_rows(png.pp, rows, NULL, (png_uint_32)height);
+
+  // Print the image...
+  ret = papplJobFilterImage(job, device, options, pixels, width, height, depth, xdpi, false);
+
+  // Finish up...
+  finish_png:
+
+  if (png.pp)
+    png_destroy_read_struct(&png.pp, &png.info, NULL);
+
+  fclose(png.fp);
+
+  papplJobDeletePrintOptions(options);
+
+  free(pixels);
+  free(rows);
+
+  return (ret);
+}
+#endif // HAVE_LIBPNG
+
+
+//
+// 'filter_image()' - Scale, rotate, dither, and print an image.
+//
+
+static bool				// O - `true` on success, `false` otherwise
+filter_image(
+    pappl_job_t         *job,		// I - Job
+    pappl_device_t      *device,	// I - Device
+    pappl_pr_options_t  *options,	// I - Print options
+    _pappl_image_t      *img,		// I - Image source data
+    int                 ppi,		// I - Pixels per inch (`0` for unknown)
+    bool		smoothing)	// I - `true` to smooth/interpolate the image, `false` for nearest-neighbor sampling
 {
   bool			started = false;// Have we started the job?
   pappl_pr_driver_data_t driver_data;	// Printer driver data
   const unsigned char	*dither;	// Dither line
+  unsigned char		xdither[16];	// Rotated dither line
+  int			width = img->width,
+					// Width of image
+			height = img->height,
+					// Height of image
+			depth = img->depth;
+					// Bytes per pixel
   int			ileft,		// Imageable left margin
 			itop,		// Imageable top margin
 			iwidth,		// Imageable width
@@ -87,32 +529,34 @@ papplJobFilterImage(
   unsigned char		white,		// White color
 			*line = NULL,	// Output line
 			*lineptr,	// Pointer in line
-			byte,		// Byte in line
-			bit;		// Current bit
-  const unsigned char	*pixbase,	// Pointer to first pixel
-			*pixline,	// Pointer to start of current line
+			*gray = NULL,	// Sampled pixels for dithering
+			*grayptr;	// Pointer in sampled pixels
+  const unsigned char	*pixstart,	// Start of band
 			*pixptr,	// Pointer into image
-			*pixend;	// End of image
+			*pixend;	// End of band
   int			pixel0,		// Temporary pixel value
 			pixel1,		// ...
 			img_width,	// Rotated image width
 			img_height,	// Rotated image height
+			ix,		// Starting column in rotated image
+			iy,		// Current line in rotated image
 			x,		// X position
 			xsize,		// Scaled width
 			xstart,		// X start position
 			xend,		// X end position
+			xfirst,		// First dithered column
+			xbyte,		// Column at start of first dithered byte
 			y,		// Y position
 			ysize,		// Scaled height
 			ystart,		// Y start position
 			yend;		// Y end position
-  int			xdir,		// X direction
-			xerr,		// X error accumulator
+  ptrdiff_t		xdir,		// X direction
+			xstep;		// X step
+  int			xerr,		// X error accumulator
 			xmod,		// X modulus
-			xstep,		// X step
 			yerr,		// Y error accumulator
 			ymod,		// Y modulus
-			ystep,		// Y step
-			ydir;		// Y direction
+			ystep;		// Y step
 
 
   // Images contain a single page/impression...
@@ -202,38 +646,9 @@ papplJobFilterImage(
   {
     default :
     case IPP_ORIENT_PORTRAIT :
-        pixbase    = pixels;
-        img_width  = width;
-        img_height = height;
-        xdir       = (int)depth;
-        ydir       = (int)depth * (int)width;
-
-        if (options->print_scaling == PAPPL_SCALING_NONE)
-        {
-          // No scaling
-	  xsize = img_width * options->printer_resolution[0] / ppi;
-	  ysize = img_height * options->printer_resolution[1] / ppi;
-        }
-        else
-	{
-	  // Fit/fill
-	  xsize = iwidth;
-	  ysize = xsize * height / width;
-
-	  if ((ysize > iheight && options->print_scaling == PAPPL_SCALING_FIT) || (ysize < iheight && options->print_scaling == PAPPL_SCALING_FILL))
-	  {
-	    ysize = iheight;
-	    xsize = ysize * width / height;
-	  }
-	}
-	break;
-
     case IPP_ORIENT_REVERSE_PORTRAIT :
-        pixbase    = pixels + depth * width * height - depth;
         img_width  = width;
         img_height = height;
-        xdir       = -(int)depth;
-        ydir       = -(int)depth * (int)width;
 
         if (options->print_scaling == PAPPL_SCALING_NONE)
         {
@@ -256,38 +671,9 @@ papplJobFilterImage(
 	break;
 
     case IPP_ORIENT_LANDSCAPE : // 90 counter-clockwise
-        pixbase    = pixels + depth * width - depth;
-        img_width  = height;
-        img_height = width;
-        xdir       = (int)depth * (int)width;
-        ydir       = -(int)depth;
-
-        if (options->print_scaling == PAPPL_SCALING_NONE)
-        {
-          // No scaling
-	  xsize = img_width * options->printer_resolution[0] / ppi;
-	  ysize = img_height * options->printer_resolution[1] / ppi;
-        }
-        else
-	{
-	  // Fit/fill
-	  xsize = iwidth;
-	  ysize = xsize * width / height;
-
-	  if ((ysize > iheight && options->print_scaling == PAPPL_SCALING_FIT) || (ysize < iheight && options->print_scaling == PAPPL_SCALING_FILL))
-	  {
-	    ysize = iheight;
-	    xsize = ysize * height / width;
-	  }
-	}
-	break;
-
     case IPP_ORIENT_REVERSE_LANDSCAPE : // 90 clockwise
-        pixbase    = pixels + depth * (height - 1) * width;
         img_width  = height;
         img_height = width;
-        xdir       = -(int)depth * (int)width;
-        ydir       = (int)depth;
 
         if (options->print_scaling == PAPPL_SCALING_NONE)
         {
@@ -310,6 +696,9 @@ papplJobFilterImage(
         break;
   }
 
+  img->orient         = options->orientation_requested;
+  img->rotated_height = img_height;
+
   // Don't rotate in the driver...
   options->orientation_requested = IPP_ORIENT_PORTRAIT;
 
@@ -319,10 +708,8 @@ papplJobFilterImage(
   yend   = ystart + ysize;
 
   xmod   = (int)(img_width % xsize);
-  xstep  = (int)(img_width / xsize) * xdir;
-
   ymod   = (int)(img_height % ysize);
-  ystep  = (int)(img_height / ysize) * ydir;
+  ystep  = (int)(img_height / ysize);
 
   if (xend > (int)options->header.cupsWidth)
     xend = (int)options->header.cupsWidth;
@@ -330,12 +717,49 @@ papplJobFilterImage(
   if (yend > (int)options->header.cupsHeight)
     yend = (int)options->header.cupsHeight;
 
-  papplLogJob(job, PAPPL_LOGLEVEL_DEBUG, "xsize=%d, xstart=%d, xend=%d, xdir=%d, xmod=%d, xstep=%d", xsize, xstart, xend, xdir, xmod, xstep);
-  papplLogJob(job, PAPPL_LOGLEVEL_DEBUG, "ysize=%d, ystart=%d, yend=%d, ydir=%d, ymod=%d, ystep=%d", ysize, ystart, yend, ydir, ymod, ystep);
+  papplLogJob(job, PAPPL_LOGLEVEL_DEBUG, "xsize=%d, xstart=%d, xend=%d, xmod=%d", xsize, xstart, xend, xmod);
+  papplLogJob(job, PAPPL_LOGLEVEL_DEBUG, "ysize=%d, ystart=%d, yend=%d, ymod=%d, ystep=%d", ysize, ystart, yend, ymod, ystep);
+
+  if (img->row_cb)
+  {
+    // Allocate the row and band buffers - portrait images are read in order
+    // and only need a few lines, while the other orientations read the image
+    // from the bottom or side and buffer as many lines as fit in the band...
+    size_t linesize = (size_t)img_width * (size_t)depth;
+					// Size of a rotated line
+
+    if (img->orient == IPP_ORIENT_LANDSCAPE || img->orient == IPP_ORIENT_REVERSE_LANDSCAPE || img->orient == IPP_ORIENT_REVERSE_PORTRAIT)
+      img->band_lines = (int)(_PAPPL_IMAGE_BAND_SIZE / linesize);
+    else
+      img->band_lines = _PAPPL_IMAGE_BAND_LINES;
+
+    if (img->band_lines < 2)
+      img->band_lines = 2;
+    else if (img->band_lines > img_height)
+      img->band_lines = img_height;
+
+    papplLogJob(job, PAPPL_LOGLEVEL_DEBUG, "Buffering %d of %d image lines.", img->band_lines, img_height);
+
+    if ((img->row = malloc((size_t)width * (size_t)depth)) == NULL || (img->bandbuf = malloc((size_t)img->band_lines * linesize)) == NULL)
+    {
+      papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to allocate memory for image band.");
+      goto abort_job;
+    }
+
+    img->band = img->bandbuf;
+  }
+  else
+  {
+    // The whole image is in memory...
+    img->first = 0;
+    img->last  = img_height - 1;
+
+    image_layout(img);
+  }
 
   papplPrinterGetDriverData(papplJobGetPrinter(job), &driver_data);
 
-  if ((line = malloc(options->header.cupsBytesPerLine)) == NULL)
+  if ((line = malloc(options->header.cupsBytesPerLine)) == NULL || (options->header.cupsBitsPerPixel == 1 && (gray = malloc(options->header.cupsWidth)) == NULL))
   {
     papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to allocate memory for raster line.");
     goto abort_job;
@@ -355,8 +779,6 @@ papplJobFilterImage(
   else
     white = 0xff;
 
-  pixend = pixels + width * height * depth;
-
   // Print every copy...
   while (papplJobGetCopiesCompleted(job) < papplJobGetCopies(job))
   {
@@ -382,42 +804,59 @@ papplJobFilterImage(
 
     if (ystart < 0)
     {
-      pixline = pixbase - (ystart * ymod / ysize) * ydir;
-      yerr    = -ymod / 2 - (ystart * ymod) % ysize;
+      iy   = -(ystart * ymod / ysize);
+      yerr = -ymod / 2 - (ystart * ymod) % ysize;
     }
     else
     {
-      pixline = pixbase;
-      yerr    = -ymod / 2;
+      iy   = 0;
+      yerr = -ymod / 2;
     }
 
     // Now RIP the image...
     for (; y < yend && !job->is_canceled; y ++)
     {
-      pixptr = pixline;
+      // Make sure the current line (and the next one for smoothing) is loaded...
+      if (iy >= img_height)
+        iy = img_height - 1;
+
+      if (!image_fill(img, iy, (smoothing && iy < (img_height - 1)) ? iy + 1 : iy))
+      {
+	papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to read image line %d.", iy);
+	goto abort_job;
+      }
+
+      pixstart = img->band;
+      pixend   = img->band + img->bandsize;
+      xdir     = img->xdir;
+      xstep    = (ptrdiff_t)(img_width / xsize) * xdir;
 
       if (xstart < 0)
       {
-	pixptr -= (xstart * xmod / xsize) * xdir;
+	ix   = -(xstart * xmod / xsize);
 	x    = 0;
 	xerr = -xmod / 2 - (xstart * xmod) % xsize;
       }
       else
       {
+	ix   = 0;
 	x    = xstart;
 	xerr = -xmod / 2;
       }
 
+      pixptr = img->band + (img->origin + ix * xdir + iy * img->ydir);
+
       if (options->header.cupsBitsPerPixel == 1)
       {
-        // Need to dither the image to 1-bit black...
-	dither = options->dither[y & 15];
+        // Need to dither the image to 1-bit black, so sample the pixels for
+        // this line first...
+	xfirst = x;
+	xbyte  = x & ~7;
 
-	for (lineptr = line + x / 8, bit = 128 >> (x & 7), byte = 0; x < xend; x ++)
+	for (grayptr = gray + x; x < xend; x ++)
 	{
-	  // Dither the current pixel...
-	  if (*pixptr <= dither[x & 15])
-	    byte |= bit;
+	  // Copy the current pixel...
+	  *grayptr++ = *pixptr;
 
 	  // Advance to the next pixel...
 	  pixptr += xstep;
@@ -428,21 +867,26 @@ papplJobFilterImage(
 	    xerr -= xsize;
 	    pixptr += xdir;
 	  }
+	}
 
-	  // and the next bit
-	  if (bit == 1)
+	if (xend > xfirst)
+	{
+	  // Then dither starting at a byte boundary, rotating the dither line as
+	  // needed...
+	  dither = options->dither[y & 15];
+
+	  if (xbyte & 8)
 	  {
-	    // Current byte is "full", save it...
-	    *lineptr++ = byte;
-	    byte = 0;
-	    bit  = 128;
+	    memcpy(xdither, dither + 8, 8);
+	    memcpy(xdither + 8, dither, 8);
+	    dither = xdither;
 	  }
-	  else
-	    bit /= 2;
-	}
 
-	if (bit < 128)
-	  *lineptr = byte;
+	  _papplDitherLine(line + xbyte / 8, gray + xbyte, (unsigned)(xend - xbyte), dither, false);
+
+	  // Clear any bits to the left of the image...
+	  line[xbyte / 8] &= 0xff >> (xfirst & 7);
+	}
       }
       else if (options->header.cupsColorSpace == CUPS_CSPACE_K)
       {
@@ -453,15 +897,15 @@ papplJobFilterImage(
 	  if (smoothing && yerr >= 0 && xerr >= 0)
 	  {
 	    const unsigned char	*rt = pixptr + xdir,
-				*dn = pixptr + ydir,
-				*dnrt = pixptr + xdir + ydir;
+				*dn = pixptr + img->ydir,
+				*dnrt = pixptr + xdir + img->ydir;
 					// Pointers to adjacent pixels
 
-	    if (rt < pixels || rt >= pixend)
+	    if (rt < pixstart || rt >= pixend)
 	      rt = pixptr;
-	    if (dn < pixels || dn >= pixend)
+	    if (dn < pixstart || dn >= pixend)
 	      dn = pixptr;
-	    if (dnrt < pixels || dnrt >= pixend)
+	    if (dnrt < pixstart || dnrt >= pixend)
 	      dnrt = pixptr;
 
 	    pixel0     = ((xsize - xerr) * *pixptr + xerr * *rt) / xsize;
@@ -496,15 +940,15 @@ papplJobFilterImage(
 	  {
 	    int			j;	// Looping var
 	    const unsigned char	*rt = pixptr + xdir,
-				*dn = pixptr + ydir,
-				*dnrt = pixptr + xdir + ydir;
+				*dn = pixptr + img->ydir,
+				*dnrt = pixptr + xdir + img->ydir;
 					// Pointers to adjacent pixels
 
-	    if (rt < pixels || rt >= pixend)
+	    if (rt < pixstart || rt >= pixend)
 	      rt = pixptr;
-	    if (dn < pixels || dn >= pixend)
+	    if (dn < pixstart || dn >= pixend)
 	      dn = pixptr;
-	    if (dnrt < pixels || dnrt >= pixend)
+	    if (dnrt < pixstart || dnrt >= pixend)
 	      dnrt = pixptr;
 
             for (j = 0; j < bpp; j ++)
@@ -538,11 +982,11 @@ papplJobFilterImage(
 	goto abort_job;
       }
 
-      pixline += ystep;
+      iy += ystep;
       yerr += ymod;
       if (yerr >= ysize)
       {
-        pixline += ydir;
+        iy ++;
         yerr -= ysize;
       }
     }
@@ -576,395 +1020,412 @@ papplJobFilterImage(
     goto abort_job;
   }
 
-  // Free memory and return...
-  free(line);
+  // Free memory and return...
+  free(line);
+  free(gray);
+
+  return (true);
+
+  // Abort the job...
+  abort_job:
+
+  if (started)
+    (driver_data.rendjob_cb)(job, options, device);
+
+  free(line);
+  free(gray);
+
+  return (false);
+}
+
+
+//
+// 'image_fill()' - Make sure the specified rotated lines are in the band.
+//
+// Portrait images are read sequentially, with any lines that are still needed
+// kept at the top of the band.  Reverse portrait images start at the bottom of
+// the image and rotated images need every source row to fill a band, so the
+// image is read again for each band.  Their bands are sized to hold the whole
+// image when it fits in `_PAPPL_IMAGE_BAND_SIZE` bytes.
+//
+
+static bool				// O - `true` on success, `false` on error
+image_fill(_pappl_image_t *img,		// I - Image source data
+           int            first,	// I - First rotated line needed
+           int            last)		// I - Last rotated line needed
+{
+  int		bfirst,			// First rotated line in new band
+		blast,			// Last rotated line in new band
+		sx, sy,			// Band origin in source image
+		sw, sh,			// Band size in source image
+		row;			// First source row to read
+  size_t	rowsize;		// Bytes per band row
+  unsigned char	*dst;			// Destination for source row
+
+
+  // See if the band already has the lines we need...
+  if (first >= img->first && last <= img->last)
+    return (true);
+  else if (!img->row_cb)
+    return (false);
+
+  // Figure out the new band...
+  bfirst = first;
+  blast  = first + img->band_lines - 1;
+
+  if (blast >= img->rotated_height)
+    blast = img->rotated_height - 1;
+  if (blast < last)
+    blast = last;
+
+  switch (img->orient)
+  {
+    default :
+    case IPP_ORIENT_PORTRAIT :
+        sx = 0;
+        sw = img->width;
+        sy = bfirst;
+        sh = blast - bfirst + 1;
+        break;
+
+    case IPP_ORIENT_REVERSE_PORTRAIT :
+        sx = 0;
+        sw = img->width;
+        sy = img->height - 1 - blast;
+        sh = blast - bfirst + 1;
+        break;
+
+    case IPP_ORIENT_LANDSCAPE :
+        sx = img->width - 1 - blast;
+        sw = blast - bfirst + 1;
+        sy = 0;
+        sh = img->height;
+        break;
+
+    case IPP_ORIENT_REVERSE_LANDSCAPE :
+        sx = bfirst;
+        sw = blast - bfirst + 1;
+        sy = 0;
+        sh = img->height;
+        break;
+  }
+
+  rowsize = (size_t)sw * (size_t)img->depth;
+  row     = sy;
+
+  if (sx == img->sx && sw == img->sw && sy >= img->sy && sy < (img->sy + img->sh) && img->next_row == (img->sy + img->sh))
+  {
+    // Moving forward through the image, keep the rows we already have...
+    int keep = img->sy + img->sh - sy;	// Number of rows to keep
+
+    memmove(img->bandbuf, img->bandbuf + (size_t)(sy - img->sy) * rowsize, (size_t)keep * rowsize);
+    row = sy + keep;
+  }
+  else if (img->next_row > sy)
+  {
+    // Start over at the top of the image...
+    img->next_row = 0;
+  }
+
+  // Read rows from the image, saving the ones in the band...
+  while (img->next_row < (sy + sh))
+  {
+    if (img->next_row == 0)
+      img->num_reads ++;
+
+    if (img->next_row >= row && sw == img->width)
+      dst = img->bandbuf + (size_t)(img->next_row - sy) * rowsize;
+    else
+      dst = img->row;
+
+    if (!(img->row_cb)(img->job, img->next_row, dst, img->row_data))
+      return (false);
+
+    if (img->next_row >= row && sw != img->width)
+      memcpy(img->bandbuf + (size_t)(img->next_row - sy) * rowsize, img->row + (size_t)sx * (size_t)img->depth, rowsize);
+
+    img->next_row ++;
+  }
+
+  img->first    = bfirst;
+  img->last     = blast;
+  img->sx       = sx;
+  img->sy       = sy;
+  img->sw       = sw;
+  img->sh       = sh;
+  img->bandsize = (size_t)sh * rowsize;
+
+  image_layout(img);
+
+  return (true);
+}
+
+
+//
+// 'image_layout()' - Compute the band offsets for the image orientation.
+//
+
+static void
+image_layout(_pappl_image_t *img)	// I - Image source data
+{
+  ptrdiff_t	depth = img->depth,	// Bytes per pixel
+		stride = (ptrdiff_t)img->sw * depth;
+					// Bytes per band row
+
+
+  switch (img->orient)
+  {
+    default :
+    case IPP_ORIENT_PORTRAIT :
+        img->xdir   = depth;
+        img->ydir   = stride;
+        img->origin = -img->sy * stride - img->sx * depth;
+        break;
+
+    case IPP_ORIENT_REVERSE_PORTRAIT :
+        img->xdir   = -depth;
+        img->ydir   = -stride;
+        img->origin = (img->height - 1 - img->sy) * stride + (img->width - 1 - img->sx) * depth;
+        break;
+
+    case IPP_ORIENT_LANDSCAPE : // 90 counter-clockwise
+        img->xdir   = stride;
+        img->ydir   = -depth;
+        img->origin = -img->sy * stride + (img->width - 1 - img->sx) * depth;
+        break;
+
+    case IPP_ORIENT_REVERSE_LANDSCAPE : // 90 clockwise
+        img->xdir   = -stride;
+        img->ydir   = depth;
+        img->origin = (img->height - 1 - img->sy) * stride - img->sx * depth;
+        break;
+  }
+}
+
 
-  return (true);
+#ifdef HAVE_LIBJPEG
+//
+// 'jpeg_error_handler()' - Handle JPEG errors by not exiting.
+//
 
-  // Abort the job...
-  abort_job:
+static void
+jpeg_error_handler(j_common_ptr p)	// I - JPEG data
+{
+  _pappl_jpeg_err_t	*jerr = (_pappl_jpeg_err_t *)p->err;
+					// JPEG error handler
 
-  if (started)
-    (driver_data.rendjob_cb)(job, options, device);
 
-  free(line);
+  // Save the error message in the string buffer...
+  (jerr->jerr.format_message)(p, jerr->message);
 
-  return (false);
+  // Return to the point we called setjmp()...
+  longjmp(jerr->retbuf, 1);
 }
 
 
 //
-// '_papplJobFilterJPEG()' - Filter a JPEG image file.
+// 'jpeg_row_cb()' - Decompress the next row of a JPEG image.
 //
 
-#ifdef HAVE_LIBJPEG
-bool
-_papplJobFilterJPEG(
-    pappl_job_t    *job,		// I - Job
-    pappl_device_t *device,		// I - Device
-    void           *data)		// I - Filter data (unused)
+static bool				// O - `true` on success, `false` on error
+jpeg_row_cb(pappl_job_t   *job,		// I - Job
+            int           y,		// I - Row number
+            unsigned char *row,		// I - Row buffer
+            _pappl_jpeg_t *jpeg)	// I - JPEG reader data
 {
-  const char		*filename;	// JPEG filename
-  FILE			*fp;		// JPEG file
-  pappl_pr_options_t	*options = NULL;// Job options
-  struct jpeg_decompress_struct	dinfo;	// Decompressor info
-  int			xdpi,		// X pixels per inch
-			ydpi;		// Y pixels per inch
-  _pappl_jpeg_err_t	jerr;		// Error handler info
-  unsigned char		*pixels = NULL;	// Image pixels
-  JSAMPROW		row;		// Sample row pointer
-  bool			ret = false;	// Return value
+  JSAMPROW	samprow = (JSAMPROW)row;// Sample row pointer
 
 
-  (void)data;
-
-  // Open the JPEG file...
-  filename = papplJobGetFilename(job);
-  if ((fp = fopen(filename, "rb")) == NULL)
+  if (setjmp(jpeg->jerr.retbuf))
   {
-    papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to open JPEG file '%s': %s", filename, strerror(errno));
+    // JPEG library errors are directed to this point...
+    papplJobSetReasons(job, PAPPL_JREASON_DOCUMENT_FORMAT_ERROR, PAPPL_JREASON_NONE);
+    papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to read JPEG file '%s': %s", jpeg->filename, jpeg->jerr.message);
     return (false);
   }
 
-  // Read the image header...
-  jpeg_std_error(&jerr.jerr);
-  jerr.jerr.error_exit = jpeg_error_handler;
-
-  if (setjmp(jerr.retbuf))
+  if (y < jpeg->next_row)
   {
-    // JPEG library errors are directed to this point...
-    papplJobSetReasons(job, PAPPL_JREASON_DOCUMENT_FORMAT_ERROR, PAPPL_JREASON_NONE);
-    papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to open JPEG file '%s': %s", filename, jerr.message);
-    ret = false;
-    goto finish_jpeg;
+    // Start over at the top of the image...
+    jpeg_abort_decompress(&jpeg->dinfo);
+    rewind(jpeg->fp);
+    jpeg_stdio_src(&jpeg->dinfo, jpeg->fp);
+    jpeg_read_header(&jpeg->dinfo, TRUE);
+    jpeg_start(jpeg);
+    jpeg_start_decompress(&jpeg->dinfo);
+
+    jpeg->next_row = 0;
   }
 
-  dinfo.err = (struct jpeg_error_mgr *)&jerr;
-  jpeg_create_decompress(&dinfo);
-  jpeg_stdio_src(&dinfo, fp);
-  jpeg_read_header(&dinfo, TRUE);
+  jpeg_read_scanlines(&jpeg->dinfo, &samprow, 1);
+  jpeg->next_row ++;
 
-  // Get job options and request the image data in the format we need...
-  options = papplJobCreatePrintOptions(job, 1, dinfo.num_components > 1);
+  return (true);
+}
 
-  dinfo.quantize_colors = FALSE;
 
-  if (options->header.cupsNumColors == 1)
-  {
-    dinfo.out_color_space      = JCS_GRAYSCALE;
-    dinfo.out_color_components = 1;
-    dinfo.output_components    = 1;
-  }
-  else
-  {
-    dinfo.out_color_space      = JCS_RGB;
-    dinfo.out_color_components = 3;
-    dinfo.output_components    = 3;
-  }
+//
+// 'jpeg_start()' - Set the output format for a JPEG image.
+//
 
-  jpeg_calc_output_dimensions(&dinfo);
+static void
+jpeg_start(_pappl_jpeg_t *jpeg)		// I - JPEG reader data
+{
+  jpeg->dinfo.quantize_colors      = FALSE;
+  jpeg->dinfo.out_color_space      = jpeg->color_space;
+  jpeg->dinfo.out_color_components = jpeg->color_space == JCS_GRAYSCALE ? 1 : 3;
+  jpeg->dinfo.output_components    = jpeg->dinfo.out_color_components;
 
-  papplLogJob(job, PAPPL_LOGLEVEL_INFO, "JPEG image dimensions are %ux%ux%d", dinfo.output_width, dinfo.output_height, dinfo.output_components);
+  jpeg_calc_output_dimensions(&jpeg->dinfo);
+}
+#endif // HAVE_LIBJPEG
 
-  if (dinfo.output_width < 1 || dinfo.output_width > (JDIMENSION)job->system->max_image_width || dinfo.output_height < 1 || dinfo.output_height > (JDIMENSION)job->system->max_image_height || ((size_t)dinfo.output_width * (size_t)dinfo.output_height * (size_t)dinfo.output_components) > job->system->max_image_size)
-  {
-    papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "JPEG image is too large to print.");
-    papplJobSetReasons(job, PAPPL_JREASON_DOCUMENT_UNPRINTABLE_ERROR, PAPPL_JREASON_NONE);
-    goto finish_jpeg;
-  }
 
-  if ((pixels = (unsigned char *)malloc((size_t)dinfo.output_width * (size_t)dinfo.output_height * (size_t)dinfo.output_components)) == NULL)
-  {
-    papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to allocate memory for %ux%ux%d JPEG image.", dinfo.output_width, dinfo.output_height, dinfo.output_components);
-    papplJobSetReasons(job, PAPPL_JREASON_ERRORS_DETECTED, PAPPL_JREASON_NONE);
-    goto finish_jpeg;
-  }
+#ifdef HAVE_LIBPNG
+//
+// 'png_error_func()' - PNG error message function.
+//
 
-  jpeg_start_decompress(&dinfo);
+static void
+png_error_func(
+    png_structp     pp,			// I - PNG pointer
+    png_const_charp message)		// I - Error message
+{
+  pappl_job_t	*job = (pappl_job_t *)png_get_error_ptr(pp);
+					// Job
 
-  while (dinfo.output_scanline < dinfo.output_height)
-  {
-    row = (JSAMPROW)(pixels + (size_t)dinfo.output_scanline * (size_t)dinfo.output_width * (size_t)dinfo.output_components);
-    jpeg_read_scanlines(&dinfo, &row, 1);
-  }
 
-  switch (dinfo.density_unit)
-  {
-    default :
-    case 0 : // Unknown units
-	xdpi = ydpi = 0;
-	break;
-    case 1 : // Dots-per-inch
-	xdpi = dinfo.X_density;
-	ydpi = dinfo.Y_density;
-	break;
-    case 2 : // Dots-per-centimeter
-	xdpi = dinfo.X_density * 254 / 100;
-	ydpi = dinfo.Y_density * 254 / 100;
-	break;
-  }
+  papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "PNG: %s", message);
+}
 
-  papplLogJob(job, PAPPL_LOGLEVEL_INFO, "JPEG image resolution is %dx%ddpi", xdpi, ydpi);
-  if (xdpi != ydpi)
-  {
-    papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "JPEG image has non-square aspect ratio - not currently supported.");
-    papplJobSetReasons(job, PAPPL_JREASON_DOCUMENT_UNPRINTABLE_ERROR, PAPPL_JREASON_NONE);
-    goto finish_jpeg;
-  }
 
-  ret = papplJobFilterImage(job, device, options, pixels, (int)dinfo.output_width, (int)dinfo.output_height, dinfo.output_components, xdpi, true);
+//
+// 'png_row_cb()' - Read the next row of a PNG image.
+//
 
-  jpeg_finish_decompress(&dinfo);
+static bool				// O - `true` on success, `false` on error
+png_row_cb(pappl_job_t   *job,		// I - Job
+           int           y,		// I - Row number
+           unsigned char *row,		// I - Row buffer
+           _pappl_png_t  *png)		// I - PNG reader data
+{
+  // Start over at the top of the image as needed...
+  if (y < png->next_row && !png_start(job, png))
+    return (false);
 
-  finish_jpeg:
+  if (setjmp(png_jmpbuf(png->pp)))
+  {
+    // If we get here, PNG loading failed and any errors/warnings were logged
+    // via the corresponding callback functions...
+    papplJobSetReasons(job, PAPPL_JREASON_DOCUMENT_FORMAT_ERROR, PAPPL_JREASON_NONE);
+    return (false);
+  }
 
-  papplJobDeletePrintOptions(options);
-  free(pixels);
-  jpeg_destroy_decompress(&dinfo);
-  fclose(fp);
+  png_read_row(png->pp, (png_bytep)row, NULL);
+  png->next_row ++;
 
-  return (ret);
+  return (true);
 }
-#endif // HAVE_LIBJPEG
 
 
 //
-// 'process_png()' - Process a PNG image file.
+// 'png_start()' - Start reading a PNG image from the beginning of the file.
 //
 
-#ifdef HAVE_LIBPNG
-bool					// O - `true` on success and `false` otherwise
-_papplJobFilterPNG(
-    pappl_job_t    *job,		// I - Job
-    pappl_device_t *device,		// I - Device
-    void           *data)		// I - Filter data (unused)
+static bool				// O - `true` on success, `false` on error
+png_start(pappl_job_t  *job,		// I - Job
+          _pappl_png_t *png)		// I - PNG reader data
 {
-  const char		*filename;	// Job filename
-  FILE			*fp;		// PNG file
-  pappl_pr_options_t	*options = NULL;// Job options
-  png_structp		pp = NULL;	// PNG read pointer
-  png_infop		info = NULL;	// PNG info pointers
-  png_bytep		*rows = NULL;	// PNG row pointers
-  png_color_16		bg;		// Background color
-  int			i,		// Looping var
-			color_type,	// PNG color mode
-			width,		// Width in columns
-			height,		// Height in lines
-			depth,		// Bytes per pixel
-			xdpi,		// X resolution
-			ydpi;		// Y resolution
-  unsigned char		*pixels = NULL;	// Image pixels
-  bool			ret = false;	// Return value
+  png_color_16	bg;			// Background color
+  int		color_type;		// PNG color mode
 
 
-  // Open the PNG file...
-  (void)data;
+  if (png->pp)
+    png_destroy_read_struct(&png->pp, &png->info, NULL);
 
-  filename = papplJobGetFilename(job);
-  if ((fp = fopen(filename, "rb")) == NULL)
-  {
-    papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to open PNG file '%s': %s", filename, strerror(errno));
-    return (false);
-  }
+  rewind(png->fp);
+
+  png->next_row = 0;
 
   // Setup PNG data structures...
-  if ((pp = png_create_read_struct(PNG_LIBPNG_VER_STRING, (png_voidp)job, png_error_func, png_warning_func)) == NULL)
+  if ((png->pp = png_create_read_struct(PNG_LIBPNG_VER_STRING, (png_voidp)job, png_error_func, png_warning_func)) == NULL)
   {
     papplJobSetReasons(job, PAPPL_JREASON_DOCUMENT_FORMAT_ERROR, PAPPL_JREASON_NONE);
     papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to allocate memory for PNG file '%s': %s", job->filename, strerror(errno));
-    goto finish_png;
+    return (false);
   }
 
-  if ((info = png_create_info_struct(pp)) == NULL)
+  if ((png->info = png_create_info_struct(png->pp)) == NULL)
   {
     papplJobSetReasons(job, PAPPL_JREASON_DOCUMENT_FORMAT_ERROR, PAPPL_JREASON_NONE);
     papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to allocate memory for PNG file '%s': %s", job->filename, strerror(errno));
-    goto finish_png;
+    return (false);
   }
 
-  if (setjmp(png_jmpbuf(pp)))
+  if (setjmp(png_jmpbuf(png->pp)))
   {
     // If we get here, PNG loading failed and any errors/warnings were logged
     // via the corresponding callback functions...
     papplJobSetReasons(job, PAPPL_JREASON_DOCUMENT_FORMAT_ERROR, PAPPL_JREASON_NONE);
-    goto finish_png;
+    return (false);
   }
 
   // Start reading...
-  png_init_io(pp, fp);
+  png_init_io(png->pp, png->fp);
 
 #  if defined(PNG_SKIP_sRGB_CHECK_PROFILE) && defined(PNG_SET_OPTION_SUPPORTED)
   // Don't throw errors with "invalid" sRGB profiles produced by Adobe apps.
-  png_set_option(pp, PNG_SKIP_sRGB_CHECK_PROFILE, PNG_OPTION_ON);
+  png_set_option(png->pp, PNG_SKIP_sRGB_CHECK_PROFILE, PNG_OPTION_ON);
 #  endif // PNG_SKIP_sRGB_CHECK_PROFILE && PNG_SET_OPTION_SUPPORTED
 
   // Get the image dimensions and depth...
-  png_read_info(pp, info);
-
-  width      = (int)png_get_image_width(pp, info);
-  height     = (int)png_get_image_height(pp, info);
-  color_type = png_get_color_type(pp, info);
-
-  if (color_type & PNG_COLOR_MASK_COLOR)
-    depth = 3;
-  else
-    depth = 1;
-
-  papplLogJob(job, PAPPL_LOGLEVEL_INFO, "PNG image dimensions are %dx%dx%d", width, height, depth);
-
-  if (width < 1 || width > job->system->max_image_width || height < 1 || height > job->system->max_image_height || (size_t)(width * height * depth) > job->system->max_image_size)
-  {
-    papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "PNG image is too large to print.");
-    papplJobSetReasons(job, PAPPL_JREASON_DOCUMENT_UNPRINTABLE_ERROR, PAPPL_JREASON_NONE);
-    goto finish_png;
-  }
+  png_read_info(png->pp, png->info);
 
-  xdpi = (int)png_get_x_pixels_per_inch(pp, info);
-  ydpi = (int)png_get_y_pixels_per_inch(pp, info);
-
-  papplLogJob(job, PAPPL_LOGLEVEL_INFO, "PNG image resolution is %dx%ddpi", xdpi, ydpi);
-
-  if (xdpi != ydpi)
-  {
-    papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "PNG image has non-square aspect ratio - not currently supported.");
-    papplJobSetReasons(job, PAPPL_JREASON_DOCUMENT_UNPRINTABLE_ERROR, PAPPL_JREASON_NONE);
-    goto finish_png;
-  }
+  color_type = png_get_color_type(png->pp, png->info);
 
   // Set decoding options...
-  if (png_get_valid(pp, info, PNG_INFO_tRNS))
+  if (png_get_valid(png->pp, png->info, PNG_INFO_tRNS))
   {
     // Map transparency to alpha
-    png_set_tRNS_to_alpha(pp);
+    png_set_tRNS_to_alpha(png->pp);
     color_type |= PNG_COLOR_MASK_ALPHA;
   }
 
 #ifdef PNG_TRANSFORM_SCALE_16
-  if (png_get_bit_depth(pp, info) > 8)
+  if (png_get_bit_depth(png->pp, png->info) > 8)
   {
     // Scale 16-bit values to 8-bit gamma-corrected ones
-    png_set_scale_16(pp);
+    png_set_scale_16(png->pp);
     papplLogJob(job, PAPPL_LOGLEVEL_DEBUG, "Scaling 16-bit PNG data to 8-bits.");
   }
 #else
-  if (png_get_bit_depth(pp, info) > 8)
+  if (png_get_bit_depth(png->pp, png->info) > 8)
   {
     // Strip the bottom bits of 16-bit values
-    png_set_strip_16(pp);
+    png_set_strip_16(png->pp);
     papplLogJob(job, PAPPL_LOGLEVEL_DEBUG, "Stripping 16-bit PNG data to 8-bits.");
   }
 #endif // PNG_TRANSFORM_SCALE_16
 
-  if (png_get_bit_depth(pp, info) < 8)
+  if (png_get_bit_depth(png->pp, png->info) < 8)
   {
     // Expand 1, 2, and 4-bit values to 8 bits
-    if (depth == 1)
-      png_set_expand_gray_1_2_4_to_8(pp);
+    if (!(color_type & PNG_COLOR_MASK_COLOR))
+      png_set_expand_gray_1_2_4_to_8(png->pp);
     else
-      png_set_packing(pp);
+      png_set_packing(png->pp);
   }
   if (color_type & PNG_COLOR_MASK_PALETTE)
   {
     // Convert indexed images to RGB...
-    png_set_palette_to_rgb(pp);
+    png_set_palette_to_rgb(png->pp);
   }
 
   // Remove alpha by compositing over white...
   bg.red = bg.green = bg.blue = 65535;
-  png_set_background(pp, &bg, PNG_BACKGROUND_GAMMA_SCREEN, 0, 1);
-
-  // Allocate memory for the image...
-  if ((pixels = (unsigned char *)calloc(1, (size_t)(width * height * depth))) == NULL)
-  {
-    papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to allocate memory for PNG image: %s", strerror(errno));
-    papplJobSetReasons(job, PAPPL_JREASON_DOCUMENT_UNPRINTABLE_ERROR, PAPPL_JREASON_NONE);
-    goto finish_png;
-  }
-
-  if ((rows = (png_bytep *)calloc((size_t)height, sizeof(png_bytep))) == NULL)
-  {
-    papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to allocate memory for PNG image: %s", strerror(errno));
-    papplJobSetReasons(job, PAPPL_JREASON_DOCUMENT_UNPRINTABLE_ERROR, PAPPL_JREASON_NONE);
-    goto finish_png;
-  }
-
-  for (i = 0; i < height; i ++)
-    rows[i] = pixels + i * width * depth;
-
-  // Read the image...
-  for (i = png_set_interlace_handling(pp); i > 0; i --)
-    png_read_rows(pp, rows, NULL, (png_uint_32)height);
-
-  // Prepare options...
-  options = papplJobCreatePrintOptions(job, 1, depth == 3);
-
-  // Print the image...
-  ret = papplJobFilterImage(job, device, options, pixels, width, height, depth, (int)png_get_x_pixels_per_inch(pp, info), false);
-
-  // Finish up...
-  finish_png:
-
-  if (pp && info)
-  {
-    png_read_end(pp, info);
-    png_destroy_read_struct(&pp, &info, NULL);
-    pp   = NULL;
-    info = NULL;
-  }
-
-  fclose(fp);
-  fp = NULL;
-
-  papplJobDeletePrintOptions(options);
-  options = NULL;
-
-  free(pixels);
-  pixels = NULL;
-
-  free(rows);
-  rows = NULL;
-
-  return (ret);
-}
-#endif // HAVE_LIBPNG
-
-
-#ifdef HAVE_LIBJPEG
-//
-// 'jpeg_error_handler()' - Handle JPEG errors by not exiting.
-//
+  png_set_background(png->pp, &bg, PNG_BACKGROUND_GAMMA_SCREEN, 0, 1);
 
-static void
-jpeg_error_handler(j_common_ptr p)	// I - JPEG data
-{
-  _pappl_jpeg_err_t	*jerr = (_pappl_jpeg_err_t *)p->err;
-					// JPEG error handler
-
-
-  // Save the error message in the string buffer...
-  (jerr->jerr.format_message)(p, jerr->message);
-
-  // Return to the point we called setjmp()...
-  longjmp(jerr->retbuf, 1);
-}
-#endif // HAVE_LIBJPEG
-
-
-#ifdef HAVE_LIBPNG
-//
-// 'png_error_func()' - PNG error message function.
-//
-
-static void
-png_error_func(
-    png_structp     pp,			// I - PNG pointer
-    png_const_charp message)		// I - Error message
-{
-  pappl_job_t	*job = (pappl_job_t *)png_get_error_ptr(pp);
-					// Job
-
-
-  papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "PNG: %s", message);
+  return (true);
 }
 
 
@@ -0,0 +1,407 @@
+//
+// Raster processing pipeline for the Printer Application Framework
+//
+// Copyright © 2023 by Michael R Sweet.
+//
+// Licensed under Apache License v2.0.  See the file "LICENSE" for more
+// information.
+//
+// The raster pipeline splits each page into bands of lines that are read from
+// the client by the job thread, dithered (when needed) by a convert thread,
+// and sent to the driver's raster write line callback by an output thread.
+// The bands form a fixed-size ring, so a slow printer or driver stops the job
+// thread from reading more data until a band is free.  Lines are always
+// written to the driver in order and from a single thread.
+//
+
+//
+// Include necessary headers...
+//
+
+#include "pappl-private.h"
+
+
+//
+// Types...
+//
+
+typedef struct _pappl_band_s		// Band of raster lines
+{
+  unsigned		y,		// First line in band
+			count;		// Number of lines in band
+  unsigned char		*pixels,	// Incoming pixel lines
+			*lines;		// Output (bitmap) lines
+} _pappl_band_t;
+
+struct _pappl_pipeline_s		// Raster processing pipeline
+{
+  pthread_mutex_t	mutex;		// Pipeline mutex
+  pthread_cond_t	cond;		// Pipeline condition variable
+  pappl_job_t		*job;		// Job
+  pappl_pr_options_t	*options;	// Options for current page
+  unsigned		band_lines,	// Number of lines per band
+			num_bands;	// Number of bands
+  _pappl_band_t		bands[_PAPPL_PIPELINE_BANDS];
+					// Bands
+  size_t		pixels_alloc,	// Allocated bytes per pixel line
+			lines_alloc,	// Allocated bytes per output line
+			pixel_bytes,	// Bytes per pixel line for current page
+			line_bytes;	// Bytes per output line for current page
+  unsigned		width;		// Width of current page in pixels
+  bool			dither,		// Dither the current page?
+			black;		// Black (vs. grayscale) pixels?
+  size_t		filled,		// Number of bands read
+			converted,	// Number of bands converted
+			written;	// Number of bands written
+  bool			stopping;	// Stop the pipeline threads?
+  pthread_t		convert_tid,	// Convert thread
+			output_tid;	// Output thread
+};
+
+
+//
+// Local functions...
+//
+
+static void	*pipeline_convert(_pappl_pipeline_t *pl);
+static void	*pipeline_output(_pappl_pipeline_t *pl);
+
+
+//
+// '_papplJobPipelineCreate()' - Create a raster processing pipeline for a job.
+//
+// The "lines" argument specifies the number of lines in each band, with 0
+// selecting the default (`_PAPPL_PIPELINE_LINES`).
+//
+
+_pappl_pipeline_t *			// O - Pipeline or `NULL` on error
+_papplJobPipelineCreate(
+    pappl_job_t *job,			// I - Job
+    unsigned    lines)			// I - Lines per band or `0` for default
+{
+  _pappl_pipeline_t	*pl;		// Pipeline
+
+
+  if ((pl = (_pappl_pipeline_t *)calloc(1, sizeof(_pappl_pipeline_t))) == NULL)
+    return (NULL);
+
+  pthread_mutex_init(&pl->mutex, NULL);
+  pthread_cond_init(&pl->cond, NULL);
+
+  pl->job        = job;
+  pl->band_lines = lines > 0 ? lines : _PAPPL_PIPELINE_LINES;
+  pl->num_bands  = _PAPPL_PIPELINE_BANDS;
+
+  if (pthread_create(&pl->convert_tid, NULL, (void *(*)(void *))pipeline_convert, pl))
+  {
+    papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to create raster convert thread: %s", strerror(errno));
+    pthread_cond_destroy(&pl->cond);
+    pthread_mutex_destroy(&pl->mutex);
+    free(pl);
+    return (NULL);
+  }
+
+  if (pthread_create(&pl->output_tid, NULL, (void *(*)(void *))pipeline_output, pl))
+  {
+    papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to create raster output thread: %s", strerror(errno));
+
+    pthread_mutex_lock(&pl->mutex);
+    pl->stopping = true;
+    pthread_cond_broadcast(&pl->cond);
+    pthread_mutex_unlock(&pl->mutex);
+
+    pthread_join(pl->convert_tid, NULL);
+
+    pthread_cond_destroy(&pl->cond);
+    pthread_mutex_destroy(&pl->mutex);
+    free(pl);
+    return (NULL);
+  }
+
+  papplLogJob(job, PAPPL_LOGLEVEL_DEBUG, "Using raster pipeline with %u bands of %u lines.", pl->num_bands, pl->band_lines);
+
+  return (pl);
+}
+
+
+//
+// '_papplJobPipelineDelete()' - Stop and free a raster processing pipeline.
+//
+
+void
+_papplJobPipelineDelete(
+    _pappl_pipeline_t *pl)		// I - Pipeline
+{
+  unsigned	i;			// Looping var
+
+
+  if (!pl)
+    return;
+
+  pthread_mutex_lock(&pl->mutex);
+  pl->stopping = true;
+  pthread_cond_broadcast(&pl->cond);
+  pthread_mutex_unlock(&pl->mutex);
+
+  pthread_join(pl->convert_tid, NULL);
+  pthread_join(pl->output_tid, NULL);
+
+  for (i = 0; i < pl->num_bands; i ++)
+  {
+    free(pl->bands[i].pixels);
+    free(pl->bands[i].lines);
+  }
+
+  pthread_cond_destroy(&pl->cond);
+  pthread_mutex_destroy(&pl->mutex);
+
+  free(pl);
+}
+
+
+//
+// '_papplJobPipelineProcessPage()' - Read, convert, and write the lines of a page.
+//
+// This function reads the lines of the current page from the raster stream
+// and queues them for the convert and output threads, waiting for a free band
+// as needed.  It returns once every line that was read has been written to the
+// driver, with "y" set to the number of lines read.  Lines that could not be
+// read (short page) or were not read (canceled job) are handled by the caller.
+//
+
+bool					// O - `true` on success, `false` on error
+_papplJobPipelineProcessPage(
+    _pappl_pipeline_t  *pl,		// I - Pipeline
+    cups_raster_t      *ras,		// I - Raster stream
+    cups_page_header_t *header,		// I - Page header from client
+    pappl_pr_options_t *options,	// I - Print options for page
+    unsigned           *y)		// O - Number of lines read
+{
+  unsigned	i,			// Looping var
+		height,			// Number of lines to read
+		count;			// Lines in current band
+  size_t	pixel_bytes,		// Bytes per pixel line
+		line_bytes;		// Bytes per output line
+  _pappl_band_t	*band;			// Current band
+  bool		eof = false;		// End of raster data?
+  pappl_job_t	*job = pl->job;		// Job
+
+
+  *y = 0;
+
+  // Size the band buffers for this page - the pipeline threads are idle since
+  // the previous page was drained before returning...
+  pixel_bytes = options->header.cupsBytesPerLine > header->cupsBytesPerLine ? options->header.cupsBytesPerLine : header->cupsBytesPerLine;
+  line_bytes  = options->header.cupsBytesPerLine;
+
+  for (i = 0; i < pl->num_bands; i ++)
+  {
+    unsigned char	*ptr;		// New buffer
+
+    band = pl->bands + i;
+
+    if (pixel_bytes > pl->pixels_alloc || !band->pixels)
+    {
+      if ((ptr = realloc(band->pixels, pixel_bytes * pl->band_lines)) == NULL)
+      {
+        papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to allocate raster band.");
+        return (false);
+      }
+
+      band->pixels = ptr;
+    }
+
+    if (line_bytes > pl->lines_alloc || !band->lines)
+    {
+      if ((ptr = realloc(band->lines, line_bytes * pl->band_lines)) == NULL)
+      {
+        papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to allocate raster band.");
+        return (false);
+      }
+
+      band->lines = ptr;
+    }
+
+    // Clear to white when the output line is wider than the input line...
+    if (options->header.cupsBytesPerLine > header->cupsBytesPerLine)
+      memset(band->pixels, options->header.cupsColorSpace == CUPS_CSPACE_K ? 0 : 255, pixel_bytes * pl->band_lines);
+  }
+
+  if (pixel_bytes > pl->pixels_alloc)
+    pl->pixels_alloc = pixel_bytes;
+  if (line_bytes > pl->lines_alloc)
+    pl->lines_alloc = line_bytes;
+
+  pthread_mutex_lock(&pl->mutex);
+
+  pl->options     = options;
+  pl->pixel_bytes = pixel_bytes;
+  pl->line_bytes  = line_bytes;
+  pl->width       = header->cupsWidth;
+  pl->dither      = header->cupsBitsPerPixel == 8 && options->header.cupsBitsPerPixel == 1;
+  pl->black       = header->cupsColorSpace == CUPS_CSPACE_K;
+
+  pthread_mutex_unlock(&pl->mutex);
+
+  height = header->cupsHeight < options->header.cupsHeight ? header->cupsHeight : options->header.cupsHeight;
+
+  while (!eof && !job->is_canceled && *y < height)
+  {
+    // Wait for a free band...
+    pthread_mutex_lock(&pl->mutex);
+    while ((pl->filled - pl->written) >= pl->num_bands)
+      pthread_cond_wait(&pl->cond, &pl->mutex);
+    band = pl->bands + (pl->filled % pl->num_bands);
+    pthread_mutex_unlock(&pl->mutex);
+
+    // Read lines into the band...
+    band->y = *y;
+
+    for (count = 0; count < pl->band_lines && *y < height && !job->is_canceled; count ++, (*y) ++)
+    {
+      if (!cupsRasterReadPixels(ras, band->pixels + count * pixel_bytes, header->cupsBytesPerLine))
+      {
+        eof = true;
+        break;
+      }
+    }
+
+    band->count = count;
+
+    if (count > 0)
+    {
+      // Queue the band for conversion...
+      pthread_mutex_lock(&pl->mutex);
+      pl->filled ++;
+      pthread_cond_broadcast(&pl->cond);
+      pthread_mutex_unlock(&pl->mutex);
+    }
+  }
+
+  // Wait for the output thread to write all of the queued lines...
+  pthread_mutex_lock(&pl->mutex);
+  while (pl->written < pl->filled)
+    pthread_cond_wait(&pl->cond, &pl->mutex);
+  pthread_mutex_unlock(&pl->mutex);
+
+  return (true);
+}
+
+
+//
+// 'pipeline_convert()' - Convert bands of pixels to output lines.
+//
+
+static void *				// O - Thread exit status
+pipeline_convert(
+    _pappl_pipeline_t *pl)		// I - Pipeline
+{
+  unsigned		i;		// Looping var
+  _pappl_band_t		*band;		// Current band
+  pappl_pr_options_t	*options;	// Print options
+  size_t		pixel_bytes,	// Bytes per pixel line
+			line_bytes;	// Bytes per output line
+  unsigned		width;		// Width in pixels
+  bool			dither,		// Dither lines?
+			black;		// Black pixels?
+  unsigned char		*line;		// Current output line
+
+
+  pthread_mutex_lock(&pl->mutex);
+
+  while (!pl->stopping)
+  {
+    if (pl->converted >= pl->filled)
+    {
+      pthread_cond_wait(&pl->cond, &pl->mutex);
+      continue;
+    }
+
+    band        = pl->bands + (pl->converted % pl->num_bands);
+    options     = pl->options;
+    pixel_bytes = pl->pixel_bytes;
+    line_bytes  = pl->line_bytes;
+    width       = pl->width;
+    dither      = pl->dither;
+    black       = pl->black;
+
+    pthread_mutex_unlock(&pl->mutex);
+
+    if (dither)
+    {
+      // Dither the lines...
+      for (i = 0, line = band->lines; i < band->count; i ++, line += line_bytes)
+      {
+        memset(line, 0, line_bytes);
+        _papplDitherLine(line, band->pixels + i * pixel_bytes, width, options->dither[(band->y + i) & 15], black);
+      }
+    }
+
+    pthread_mutex_lock(&pl->mutex);
+    pl->converted ++;
+    pthread_cond_broadcast(&pl->cond);
+  }
+
+  pthread_mutex_unlock(&pl->mutex);
+
+  return (NULL);
+}
+
+
+//
+// 'pipeline_output()' - Write converted bands to the driver.
+//
+
+static void *				// O - Thread exit status
+pipeline_output(
+    _pappl_pipeline_t *pl)		// I - Pipeline
+{
+  unsigned		i;		// Looping var
+  _pappl_band_t		*band;		// Current band
+  pappl_job_t		*job = pl->job;	// Job
+  pappl_printer_t	*printer = job->printer;
+					// Printer
+  pappl_pr_options_t	*options;	// Print options
+  unsigned char		*line;		// Current line
+  size_t		bytes;		// Bytes per line
+
+
+  pthread_mutex_lock(&pl->mutex);
+
+  while (!pl->stopping)
+  {
+    if (pl->written >= pl->converted)
+    {
+      pthread_cond_wait(&pl->cond, &pl->mutex);
+      continue;
+    }
+
+    band    = pl->bands + (pl->written % pl->num_bands);
+    options = pl->options;
+
+    if (pl->dither)
+    {
+      line  = band->lines;
+      bytes = pl->line_bytes;
+    }
+    else
+    {
+      line  = band->pixels;
+      bytes = pl->pixel_bytes;
+    }
+
+    pthread_mutex_unlock(&pl->mutex);
+
+    // Write the lines, skipping them if the job has been canceled...
+    for (i = 0; i < band->count && !job->is_canceled; i ++, line += bytes)
+      (printer->driver_data.rwriteline_cb)(job, options, printer->device, band->y + i, line);
+
+    pthread_mutex_lock(&pl->mutex);
+    pl->written ++;
+    pthread_cond_broadcast(&pl->cond);
+  }
+
+  pthread_mutex_unlock(&pl->mutex);
+
+  return (NULL);
+}
@@ -11,14 +11,27 @@
 #ifndef _PAPPL_JOB_PRIVATE_H_
 #  define _PAPPL_JOB_PRIVATE_H_
 #  include "base-private.h"
+#  include "dither-private.h"
 #  include "job.h"
 #  include "log.h"
+#  include "system.h"
+
+
+//
+// Constants...
+//
+
+#  define _PAPPL_PIPELINE_BANDS	4	// Number of bands in the raster pipeline
+#  define _PAPPL_PIPELINE_LINES	64	// Default number of lines per band
 
 
 //
 // Types and structures...
 //
 
+typedef struct _pappl_pipeline_s _pappl_pipeline_t;
+					// Raster processing pipeline
+
 struct _pappl_job_s			// Job data
 {
   pthread_rwlock_t	rwlock;			// Reader/writer lock
@@ -38,6 +51,9 @@ struct _pappl_job_s			// Job data
 			completed,		// "[date-]time-at-completed" value
 			hold_until,		// "job-hold-until[-time]" value
 			retain_until;		// "job-retain-until[-interval,-time]" value
+  struct timespec	created_mono,		// Monotonic creation time
+			processing_mono,	// Monotonic processing time
+			completed_mono;		// Monotonic completion time
   int			copies,			// "copies" value
 			copcompleted,		// "copies-completed" value
 			impressions,		// "job-impressions" value
@@ -45,7 +61,8 @@ struct _pappl_job_s			// Job data
   ipp_t			*attrs;			// Static attributes
   char			*filename;		// Print file name
   int			fd;			// Print file descriptor
-  bool			streaming;		// Streaming job?
+  bool			streaming,		// Streaming job?
+			stream_ready;		// Is the driver about to read the streamed data?
   void			*data;			// Per-job driver data
 };
 
@@ -63,6 +80,8 @@ extern void		_papplJobCopyStateNoLock(pappl_job_t *job, ipp_tag_t group_tag, ipp
 extern pappl_job_t	*_papplJobCreate(pappl_printer_t *printer, int job_id, const char *username, const char *format, const char *job_name, ipp_t *attrs) _PAPPL_PRIVATE;
 extern void		_papplJobDelete(pappl_job_t *job) _PAPPL_PRIVATE;
 #  ifdef HAVE_LIBJPEG
+extern void		_papplJobFilterAddImageMetrics(pappl_system_t *system, size_t reads, size_t rows) _PAPPL_PRIVATE;
+extern void		_papplJobFilterCopyImageMetrics(pappl_system_t *system, pappl_imetrics_t *metrics) _PAPPL_PRIVATE;
 extern bool		_papplJobFilterJPEG(pappl_job_t *job, pappl_device_t *device, void *data);
 #  endif // HAVE_LIBJPEG
 #  ifdef HAVE_LIBPNG
@@ -70,12 +89,22 @@ extern bool		_papplJobFilterPNG(pappl_job_t *job, pappl_device_t *device, void *
 #  endif // HAVE_LIBPNG
 extern bool		_papplJobHoldNoLock(pappl_job_t *job, const char *username, const char *until, time_t until_time) _PAPPL_PRIVATE;
 extern void		*_papplJobProcess(pappl_job_t *job) _PAPPL_PRIVATE;
+extern void		_papplJobProcessAddRasterMetrics(pappl_system_t *system, size_t options, size_t options_reused, size_t buffers, size_t buffers_reused) _PAPPL_PRIVATE;
+extern void		_papplJobProcessCopyRasterMetrics(pappl_system_t *system, pappl_rsmetrics_t *metrics) _PAPPL_PRIVATE;
 extern void		_papplJobProcessIPP(pappl_client_t *client) _PAPPL_PRIVATE;
+extern _pappl_pipeline_t	*_papplJobPipelineCreate(pappl_job_t *job, unsigned lines) _PAPPL_PRIVATE;
+extern void		_papplJobPipelineDelete(_pappl_pipeline_t *pl) _PAPPL_PRIVATE;
+extern bool		_papplJobPipelineProcessPage(_pappl_pipeline_t *pl, cups_raster_t *ras, cups_page_header_t *header, pappl_pr_options_t *options, unsigned *y) _PAPPL_PRIVATE;
 extern void		_papplJobProcessRaster(pappl_job_t *job, pappl_client_t *client) _PAPPL_PRIVATE;
 extern const char	*_papplJobReasonString(pappl_jreason_t reason) _PAPPL_PRIVATE;
 extern void		_papplJobReleaseNoLock(pappl_job_t *job, const char *username) _PAPPL_PRIVATE;
 extern void		_papplJobRemoveFile(pappl_job_t *job) _PAPPL_PRIVATE;
 extern bool		_papplJobRetainNoLock(pappl_job_t *job, const char *username, const char *until, int until_interval, time_t until_time) _PAPPL_PRIVATE;
+extern void		_papplJobSchedulerAdd(pappl_printer_t *printer) _PAPPL_PRIVATE;
+extern void		_papplJobSchedulerCopyMetrics(pappl_system_t *system, pappl_jmetrics_t *metrics) _PAPPL_PRIVATE;
+extern void		_papplJobSchedulerRemove(pappl_printer_t *printer) _PAPPL_PRIVATE;
+extern void		_papplJobSchedulerStart(pappl_system_t *system) _PAPPL_PRIVATE;
+extern void		_papplJobSchedulerStop(pappl_system_t *system) _PAPPL_PRIVATE;
 extern void		_papplJobSetRetain(pappl_job_t *job) _PAPPL_PRIVATE;
 extern void		_papplJobSetState(pappl_job_t *job, ipp_jstate_t state) _PAPPL_PRIVATE;
 extern void		_papplJobSubmitFile(pappl_job_t *job, const char *filename) _PAPPL_PRIVATE;
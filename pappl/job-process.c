@@ -21,6 +21,7 @@
 static const char *cups_cspace_string(cups_cspace_t cspace);
 static bool	filter_raw(pappl_job_t *job, pappl_device_t *device);
 static void	finish_job(pappl_job_t *job);
+static bool	grow_buffer(unsigned char **buffer, size_t *bufsize, size_t size, size_t *allocs, size_t *reuses);
 static bool	start_job(pappl_job_t *job);
 
 
@@ -562,6 +563,44 @@ _papplJobProcess(pappl_job_t *job)	// I - Job
 }
 
 
+//
+// '_papplJobProcessAddRasterMetrics()' - Add the raster buffer counts for a job.
+//
+
+void
+_papplJobProcessAddRasterMetrics(
+    pappl_system_t *system,		// I - System
+    size_t         options,		// I - Number of print options created
+    size_t         options_reused,	// I - Number of times print options were reused
+    size_t         buffers,		// I - Number of line buffers allocated
+    size_t         buffers_reused)	// I - Number of times line buffers were reused
+{
+  pthread_mutex_lock(&system->rsmetrics_mutex);
+
+  system->rsmetrics.options        += options;
+  system->rsmetrics.options_reused += options_reused;
+  system->rsmetrics.buffers        += buffers;
+  system->rsmetrics.buffers_reused += buffers_reused;
+
+  pthread_mutex_unlock(&system->rsmetrics_mutex);
+}
+
+
+//
+// '_papplJobProcessCopyRasterMetrics()' - Copy the raster processing metrics.
+//
+
+void
+_papplJobProcessCopyRasterMetrics(
+    pappl_system_t    *system,		// I - System
+    pappl_rsmetrics_t *metrics)		// I - Buffer for metrics data
+{
+  pthread_mutex_lock(&system->rsmetrics_mutex);
+  *metrics = system->rsmetrics;
+  pthread_mutex_unlock(&system->rsmetrics_mutex);
+}
+
+
 //
 // '_papplJobProcessRaster()' - Process an Apple/PWG Raster file.
 //
@@ -575,17 +614,22 @@ _papplJobProcessRaster(
 					// Printer for job
   pappl_pr_options_t	*options = NULL;// Job options
   cups_raster_t		*ras = NULL;	// Raster stream
-  cups_page_header_t	header;		// Page header
+  _pappl_pipeline_t	*pl = NULL;	// Raster pipeline, if any
+  cups_page_header_t	header,		// Page header
+			options_header;	// Page header for current options
+  int			options_pages;	// Number of pages for current options
   unsigned		header_pages;	// Number of pages from page header
-  const unsigned char	*dither;	// Dither line
-  unsigned char		*pixels,	// Incoming pixel line
-			*pixptr,	// Pixel pointer in line
-			*line,		// Output (bitmap) line
-			*lineptr,	// Pointer in line
-			byte,		// Byte in line
-			bit;		// Current bit
+  unsigned char		*pixels = NULL,	// Incoming pixel line
+			*line = NULL;	// Output (bitmap) line
+  size_t		pixels_size = 0,// Size of pixel line buffer
+			line_size = 0;	// Size of output line buffer
+  size_t		num_options = 0,// Number of print options created
+			num_options_reused = 0,
+					// Number of times print options were reused
+			num_buffers = 0,// Number of line buffers allocated
+			num_buffers_reused = 0;
+					// Number of times line buffers were reused
   unsigned		page = 0,	// Current page
-			x,		// Current column
 			y;		// Current line
   int			job_pages_per_set;
 					// "job-pages-per-set" value, if any
@@ -631,7 +675,11 @@ _papplJobProcessRaster(
   if ((header_pages = header.cupsInteger[CUPS_RASTER_PWG_TotalPageCount]) > 0 && job_pages_per_set == 0)
     papplJobSetImpressions(job, (int)header.cupsInteger[CUPS_RASTER_PWG_TotalPageCount]);
 
-  options = papplJobCreatePrintOptions(job, (unsigned)job->impressions, header.cupsBitsPerPixel > 8);
+  options        = papplJobCreatePrintOptions(job, (unsigned)job->impressions, header.cupsBitsPerPixel > 8);
+  options_header = header;
+  options_pages  = job->impressions;
+
+  num_options ++;
 
   if (!(printer->driver_data.rstartjob_cb)(job, options, job->printer->device))
   {
@@ -639,6 +687,9 @@ _papplJobProcessRaster(
     goto complete_job;
   }
 
+  if (printer->driver_data.raster_pipeline && (pl = _papplJobPipelineCreate(job, printer->driver_data.raster_band_height > 0 ? (unsigned)printer->driver_data.raster_band_height : 0)) == NULL)
+    papplLogJob(job, PAPPL_LOGLEVEL_WARN, "Unable to create raster pipeline, processing lines serially.");
+
   // Print pages...
   do
   {
@@ -652,9 +703,22 @@ _papplJobProcessRaster(
 
     papplSystemAddEvent(printer->system, printer, job, PAPPL_EVENT_JOB_PROGRESS, NULL);
 
-    // Set options for this page...
-    papplJobDeletePrintOptions(options);
-    options = papplJobCreatePrintOptions(job, (unsigned)job->impressions, header.cupsBitsPerPixel > 8);
+    // Set options for this page, reusing the current options when the page
+    // header is unchanged...
+    if (options && options_pages == job->impressions && !memcmp(&header, &options_header, sizeof(header)))
+    {
+      num_options_reused ++;
+    }
+    else
+    {
+      papplJobDeletePrintOptions(options);
+
+      options        = papplJobCreatePrintOptions(job, (unsigned)job->impressions, header.cupsBitsPerPixel > 8);
+      options_header = header;
+      options_pages  = job->impressions;
+
+      num_options ++;
+    }
 
     if (header.cupsWidth == 0 || header.cupsHeight == 0 || (header.cupsBitsPerColor != 1 && header.cupsBitsPerColor != 8) || header.cupsColorOrder != CUPS_ORDER_CHUNKED || (header.cupsBytesPerLine != ((header.cupsWidth * header.cupsBitsPerPixel + 7) / 8)))
     {
@@ -681,101 +745,53 @@ _papplJobProcessRaster(
       break;
     }
 
-    if (options->header.cupsBytesPerLine > header.cupsBytesPerLine)
+    // Make sure the line buffers are large enough for the entire input and
+    // output lines - they are reused for the following pages...
+    if (!grow_buffer(&pixels, &pixels_size, options->header.cupsBytesPerLine > header.cupsBytesPerLine ? options->header.cupsBytesPerLine : header.cupsBytesPerLine, &num_buffers, &num_buffers_reused) || !grow_buffer(&line, &line_size, options->header.cupsBytesPerLine, &num_buffers, &num_buffers_reused))
     {
-      // Allocate enough space for the entire output line and clear to white
-      if ((pixels = malloc(options->header.cupsBytesPerLine)) == NULL)
-      {
-        papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to allocate raster line.");
-	job->state = IPP_JSTATE_ABORTED;
-	break;
-      }
+      papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to allocate raster line.");
+      job->state = IPP_JSTATE_ABORTED;
+      break;
+    }
 
+    if (options->header.cupsBytesPerLine > header.cupsBytesPerLine)
+    {
+      // Clear the output line to white
       if (options->header.cupsColorSpace == CUPS_CSPACE_K)
         memset(pixels, 0, options->header.cupsBytesPerLine);
       else
         memset(pixels, 255, options->header.cupsBytesPerLine);
     }
-    else
+
+    if (pl)
     {
-      // The input raster is at least as wide as the output raster...
-      if ((pixels = malloc(header.cupsBytesPerLine)) == NULL)
+      // Read, convert, and write lines in parallel...
+      if (!_papplJobPipelineProcessPage(pl, ras, &header, options, &y))
       {
-        papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to allocate raster line.");
-	job->state = IPP_JSTATE_ABORTED;
-	break;
+        job->state = IPP_JSTATE_ABORTED;
+        break;
       }
     }
-
-    if ((line = malloc(options->header.cupsBytesPerLine)) == NULL)
-    {
-      free(pixels);
-
-      papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to allocate raster line.");
-      job->state = IPP_JSTATE_ABORTED;
-      break;
-    }
-
-    for (y = 0; !job->is_canceled && y < header.cupsHeight && y < options->header.cupsHeight; y ++)
+    else
     {
-      if (cupsRasterReadPixels(ras, pixels, header.cupsBytesPerLine))
+      for (y = 0; !job->is_canceled && y < header.cupsHeight && y < options->header.cupsHeight; y ++)
       {
-        if (header.cupsBitsPerPixel == 8 && options->header.cupsBitsPerPixel == 1)
+        if (cupsRasterReadPixels(ras, pixels, header.cupsBytesPerLine))
         {
-          // Dither the line...
-	  dither = options->dither[y & 15];
-	  memset(line, 0, options->header.cupsBytesPerLine);
-
-          if (header.cupsColorSpace == CUPS_CSPACE_K)
+          if (header.cupsBitsPerPixel == 8 && options->header.cupsBitsPerPixel == 1)
           {
-            // Black...
-	    for (x = 0, lineptr = line, pixptr = pixels, bit = 128, byte = 0; x < header.cupsWidth; x ++, pixptr ++)
-	    {
-	      if (*pixptr > dither[x & 15])
-	        byte |= bit;
-
-	      if (bit == 1)
-	      {
-	        *lineptr++ = byte;
-	        byte       = 0;
-	        bit        = 128;
-	      }
-	      else
-	        bit /= 2;
-	    }
-
-	    if (bit < 128)
-	      *lineptr = byte;
-	  }
-	  else
-	  {
-	    // Grayscale to black...
-	    for (x = 0, lineptr = line, pixptr = pixels, bit = 128, byte = 0; x < header.cupsWidth; x ++, pixptr ++)
-	    {
-	      if (*pixptr <= dither[x & 15])
-	        byte |= bit;
-
-	      if (bit == 1)
-	      {
-	        *lineptr++ = byte;
-	        byte       = 0;
-	        bit        = 128;
-	      }
-	      else
-	        bit /= 2;
-	    }
-
-	    if (bit < 128)
-	      *lineptr = byte;
-	  }
-
-          (printer->driver_data.rwriteline_cb)(job, options, job->printer->device, y, line);
+            // Dither the line...
+	    memset(line, 0, options->header.cupsBytesPerLine);
+	    _papplDitherLine(line, pixels, header.cupsWidth, options->dither[y & 15], header.cupsColorSpace == CUPS_CSPACE_K);
+
+            (printer->driver_data.rwriteline_cb)(job, options, job->printer->device, y, line);
+          }
+          else
+            (printer->driver_data.rwriteline_cb)(job, options, job->printer->device, y, pixels);
         }
         else
-          (printer->driver_data.rwriteline_cb)(job, options, job->printer->device, y, pixels);
+          break;
       }
-      else
-        break;
     }
 
     if (!job->is_canceled && y < header.cupsHeight)
@@ -815,9 +831,6 @@ _papplJobProcessRaster(
       }
     }
 
-    free(pixels);
-    free(line);
-
     if (!(printer->driver_data.rendpage_cb)(job, options, job->printer->device, page))
     {
       job->state = IPP_JSTATE_ABORTED;
@@ -857,8 +870,18 @@ _papplJobProcessRaster(
 
   complete_job:
 
+  _papplJobPipelineDelete(pl);
   papplJobDeletePrintOptions(options);
 
+  free(pixels);
+  free(line);
+
+  if (num_options > 0)
+  {
+    papplLogJob(job, PAPPL_LOGLEVEL_DEBUG, "Created %u print options (%u reused) and %u line buffers (%u reused).", (unsigned)num_options, (unsigned)num_options_reused, (unsigned)num_buffers, (unsigned)num_buffers_reused);
+    _papplJobProcessAddRasterMetrics(printer->system, num_options, num_options_reused, num_buffers, num_buffers_reused);
+  }
+
   if (httpGetState(client->http) == HTTP_STATE_POST_RECV)
   {
     // Flush excess data...
@@ -1024,6 +1047,15 @@ filter_raw(pappl_job_t    *job,		// I - Job
   papplJobSetImpressions(job, 1);
   options = papplJobCreatePrintOptions(job, 0, job->printer->driver_data.ppm_color > 0);
 
+  if (job->streaming)
+  {
+    // Let the socket print thread know that the driver will open the FIFO...
+    pthread_mutex_lock(&job->printer->raw_mutex);
+    job->stream_ready = true;
+    pthread_cond_broadcast(&job->printer->raw_cond);
+    pthread_mutex_unlock(&job->printer->raw_mutex);
+  }
+
   if (!(job->printer->driver_data.printfile_cb)(job, options, device))
   {
     papplJobDeletePrintOptions(options);
@@ -1069,13 +1101,19 @@ finish_job(pappl_job_t  *job)		// I - Job
   papplLogJob(job, PAPPL_LOGLEVEL_INFO, "%s, job-impressions-completed=%d.", job_states[job->state - IPP_JSTATE_PENDING], job->impcompleted);
 
   if (job->state >= IPP_JSTATE_CANCELED)
+  {
     job->completed = time(NULL);
+    clock_gettime(CLOCK_MONOTONIC, &job->completed_mono);
+  }
+
+  if (job->system->metrics)
+    _papplMetricsAddJob(job);
 
   _papplJobSetRetain(job);
 
   printer->processing_job = NULL;
 
-  if (job->state >= IPP_JSTATE_CANCELED && (!printer->max_preserved_jobs || !job->retain_until))
+  if (job->state >= IPP_JSTATE_CANCELED && (job->streaming || !printer->max_preserved_jobs || !job->retain_until))
     _papplJobRemoveFile(job);
 
   _papplSystemAddEventNoLock(job->system, job->printer, job, PAPPL_EVENT_JOB_COMPLETED, NULL);
@@ -1111,7 +1149,12 @@ finish_job(pappl_job_t  *job)		// I - Job
 
   _papplRWUnlock(printer);
 
-  _papplSystemConfigChanged(printer->system);
+  _papplSystemJobChanged(printer->system, job);
+
+  // Let the raw socket listener know that it can accept another job...
+  pthread_mutex_lock(&printer->raw_mutex);
+  pthread_cond_broadcast(&printer->raw_cond);
+  pthread_mutex_unlock(&printer->raw_mutex);
 
   if (printer->is_deleted)
   {
@@ -1127,10 +1170,12 @@ finish_job(pappl_job_t  *job)		// I - Job
     papplLogJob(job, PAPPL_LOGLEVEL_DEBUG, "Device read metrics: %lu requests, %lu bytes, %lu msecs", (unsigned long)metrics.read_requests, (unsigned long)metrics.read_bytes, (unsigned long)metrics.read_msecs);
     papplLogJob(job, PAPPL_LOGLEVEL_DEBUG, "Device write metrics: %lu requests, %lu bytes, %lu msecs", (unsigned long)metrics.write_requests, (unsigned long)metrics.write_bytes, (unsigned long)metrics.write_msecs);
 
+    if (job->system->metrics)
+      _papplMetricsAddDevice(printer, &metrics);
+
 //    papplLogPrinter(printer, PAPPL_LOGLEVEL_DEBUG, "Closing device for job %d.", job->job_id);
 
-    papplDeviceClose(printer->device);
-    printer->device = NULL;
+    _papplPrinterReleaseDeviceNoLock(printer);
 
     _papplRWUnlock(printer);
   }
@@ -1140,6 +1185,38 @@ finish_job(pappl_job_t  *job)		// I - Job
 }
 
 
+//
+// 'grow_buffer()' - Make sure a reusable buffer is large enough.
+//
+
+static bool				// O - `true` on success, `false` on error
+grow_buffer(unsigned char **buffer,	// IO - Buffer
+            size_t        *bufsize,	// IO - Allocated size of buffer
+            size_t        size,		// I  - Required size
+            size_t        *allocs,	// IO - Number of allocations
+            size_t        *reuses)	// IO - Number of reuses
+{
+  unsigned char	*ptr;			// New buffer
+
+
+  if (*buffer && size <= *bufsize)
+  {
+    (*reuses) ++;
+    return (true);
+  }
+
+  if ((ptr = realloc(*buffer, size)) == NULL)
+    return (false);
+
+  *buffer  = ptr;
+  *bufsize = size;
+
+  (*allocs) ++;
+
+  return (true);
+}
+
+
 //
 // 'start_job()' - Start processing a job...
 //
@@ -1150,6 +1227,9 @@ start_job(pappl_job_t *job)		// I - Job
   pappl_printer_t *printer = job->printer;
 					// Printer
   bool	first_open = true;		// Is this the first time we try to open the device?
+  size_t	opens = 0,			// Number of device connections opened
+	reuses = 0,			// Number of device connections reused
+	stale = 0;			// Number of stale device connections
 
 
   // Move the job to the 'processing' state...
@@ -1162,6 +1242,8 @@ start_job(pappl_job_t *job)		// I - Job
   job->processing         = time(NULL);
   printer->processing_job = job;
 
+  clock_gettime(CLOCK_MONOTONIC, &job->processing_mono);
+
   _papplSystemAddEventNoLock(printer->system, printer, job, PAPPL_EVENT_JOB_STATE_CHANGED, NULL);
 
   _papplRWUnlock(job);
@@ -1179,11 +1261,31 @@ start_job(pappl_job_t *job)		// I - Job
     }
   }
 
+  if (printer->device && printer->device_idle)
+  {
+    // Reuse a kept-alive connection if the printer hasn't closed it...
+    if (_papplDeviceIsConnected(printer->device))
+    {
+      papplLogJob(job, PAPPL_LOGLEVEL_DEBUG, "Reusing open device connection.");
+      reuses ++;
+    }
+    else
+    {
+      papplLogJob(job, PAPPL_LOGLEVEL_DEBUG, "Device connection was closed by the printer, reconnecting.");
+      papplDeviceClose(printer->device);
+      printer->device = NULL;
+      stale ++;
+    }
+
+    printer->device_idle = 0;
+  }
+
   while (!printer->device && !printer->is_deleted && !job->is_canceled && papplSystemIsRunning(printer->system))
   {
 //    papplLogPrinter(printer, PAPPL_LOGLEVEL_DEBUG, "Opening device for job %d.", job->job_id);
 
-    printer->device = papplDeviceOpen(printer->device_uri, job->name, papplLogDevice, job->system);
+    if ((printer->device = papplDeviceOpen(printer->device_uri, job->name, papplLogDevice, job->system)) != NULL)
+      opens ++;
 
     if (!printer->device && !printer->is_deleted && !job->is_canceled)
     {
@@ -1227,5 +1329,7 @@ start_job(pappl_job_t *job)		// I - Job
 
   _papplRWUnlock(printer);
 
+  _papplDeviceAddConnectionMetrics(printer->system, opens, reuses, stale, 0);
+
   return (printer->device != NULL);
 }
@@ -0,0 +1,304 @@
+//
+// Job scheduler for the Printer Application Framework
+//
+// Copyright © 2023 by Michael R Sweet.
+//
+// Licensed under Apache License v2.0.  See the file "LICENSE" for more
+// information.
+//
+// The job scheduler limits the number of jobs that are processed at the same
+// time.  Printers with a pending job are queued in FIFO order and a bounded
+// set of worker threads processes one job from the first printer in the queue.
+// When a job completes, the printer goes to the back of the queue if it has
+// more pending jobs, so that every printer gets a fair share of the workers.
+//
+
+//
+// Include necessary headers...
+//
+
+#include "pappl-private.h"
+
+
+//
+// Local functions...
+//
+
+static pappl_job_t	*scheduler_next_job(pappl_printer_t *printer);
+static void		*scheduler_worker(pappl_system_t *system);
+
+
+//
+// '_papplJobSchedulerAdd()' - Queue a printer with a pending job.
+//
+// Printers that are already queued are not queued again.
+//
+
+void
+_papplJobSchedulerAdd(
+    pappl_printer_t *printer)		// I - Printer
+{
+  pappl_system_t	*system = printer->system;
+					// System
+  size_t		count;		// Number of queued printers
+
+
+  pthread_mutex_lock(&system->sched_mutex);
+
+  if (printer->sched_queued || system->sched_stopping)
+  {
+    pthread_mutex_unlock(&system->sched_mutex);
+    return;
+  }
+
+  papplLogPrinter(printer, PAPPL_LOGLEVEL_DEBUG, "Queuing printer for job processing.");
+
+  printer->sched_queued = true;
+  clock_gettime(CLOCK_MONOTONIC, &printer->sched_time);
+
+  cupsArrayAdd(system->sched_printers, printer);
+
+  count = (size_t)cupsArrayGetCount(system->sched_printers);
+
+  system->jmetrics.queued = count;
+  if (count > system->jmetrics.max_queued)
+    system->jmetrics.max_queued = count;
+
+  if ((size_t)system->sched_idle < count && system->sched_workers < system->max_processing_jobs)
+  {
+    // Start another worker thread...
+    pthread_t	t;			// Thread
+
+    if (pthread_create(&t, NULL, (void *(*)(void *))scheduler_worker, system))
+    {
+      papplLog(system, PAPPL_LOGLEVEL_ERROR, "Unable to create job worker thread: %s", strerror(errno));
+    }
+    else
+    {
+      pthread_detach(t);
+
+      system->sched_workers ++;
+      system->sched_idle ++;
+    }
+  }
+
+  pthread_cond_signal(&system->sched_cond);
+  pthread_mutex_unlock(&system->sched_mutex);
+}
+
+
+//
+// '_papplJobSchedulerCopyMetrics()' - Copy the job scheduler metrics.
+//
+
+void
+_papplJobSchedulerCopyMetrics(
+    pappl_system_t   *system,		// I - System
+    pappl_jmetrics_t *metrics)		// I - Buffer for metrics data
+{
+  pthread_mutex_lock(&system->sched_mutex);
+  memcpy(metrics, &system->jmetrics, sizeof(pappl_jmetrics_t));
+  pthread_mutex_unlock(&system->sched_mutex);
+}
+
+
+//
+// '_papplJobSchedulerRemove()' - Remove a printer from the job scheduler queue.
+//
+// This function also waits for any worker that is claiming a job for the
+// printer, so that the printer can be safely deleted afterwards.
+//
+
+void
+_papplJobSchedulerRemove(
+    pappl_printer_t *printer)		// I - Printer
+{
+  pappl_system_t	*system = printer->system;
+					// System
+
+
+  pthread_mutex_lock(&system->sched_mutex);
+
+  if (printer->sched_queued)
+  {
+    cupsArrayRemove(system->sched_printers, printer);
+    printer->sched_queued = false;
+
+    system->jmetrics.queued = (size_t)cupsArrayGetCount(system->sched_printers);
+  }
+
+  while (printer->sched_busy > 0)
+    pthread_cond_wait(&system->sched_cond, &system->sched_mutex);
+
+  pthread_mutex_unlock(&system->sched_mutex);
+}
+
+
+//
+// '_papplJobSchedulerStart()' - Allow the job scheduler to start jobs.
+//
+
+void
+_papplJobSchedulerStart(
+    pappl_system_t *system)		// I - System
+{
+  pthread_mutex_lock(&system->sched_mutex);
+  system->sched_stopping = false;
+  pthread_mutex_unlock(&system->sched_mutex);
+}
+
+
+//
+// '_papplJobSchedulerStop()' - Stop the job scheduler.
+//
+// Jobs that are processing are allowed to complete and pending jobs remain
+// pending.  This function waits for all of the worker threads to exit.
+//
+
+void
+_papplJobSchedulerStop(
+    pappl_system_t *system)		// I - System
+{
+  pappl_printer_t	*printer;	// Current printer
+
+
+  pthread_mutex_lock(&system->sched_mutex);
+
+  system->sched_stopping = true;
+
+  for (printer = (pappl_printer_t *)cupsArrayGetFirst(system->sched_printers); printer; printer = (pappl_printer_t *)cupsArrayGetNext(system->sched_printers))
+    printer->sched_queued = false;
+
+  cupsArrayClear(system->sched_printers);
+  system->jmetrics.queued = 0;
+
+  pthread_cond_broadcast(&system->sched_cond);
+
+  while (system->sched_workers > 0)
+    pthread_cond_wait(&system->sched_cond, &system->sched_mutex);
+
+  pthread_mutex_unlock(&system->sched_mutex);
+}
+
+
+//
+// 'scheduler_next_job()' - Claim the next pending job for a printer.
+//
+
+static pappl_job_t *			// O - Job or `NULL` if none
+scheduler_next_job(
+    pappl_printer_t *printer)		// I - Printer
+{
+  pappl_job_t	*job = NULL;		// Current job
+
+
+  _papplRWLockWrite(printer);
+
+  if (!printer->processing_job && !printer->device_in_use && !printer->is_deleted && !printer->is_stopped && printer->state != IPP_PSTATE_STOPPED)
+  {
+    // Since we have a writer (exclusive) lock, we are the only thread
+    // enumerating and can use cupsArrayGetFirst/Last...
+    for (job = (pappl_job_t *)cupsArrayGetFirst(printer->active_jobs); job; job = (pappl_job_t *)cupsArrayGetNext(printer->active_jobs))
+    {
+      if (job->state == IPP_JSTATE_PENDING)
+        break;
+    }
+
+    // Claim the printer so that other threads don't start another job...
+    if (job)
+      printer->processing_job = job;
+  }
+
+  _papplRWUnlock(printer);
+
+  return (job);
+}
+
+
+//
+// 'scheduler_worker()' - Process jobs from the job scheduler queue.
+//
+
+static void *				// O - Thread exit status
+scheduler_worker(
+    pappl_system_t *system)		// I - System
+{
+  pappl_printer_t	*printer;	// Current printer
+  pappl_job_t		*job;		// Current job
+  struct timespec	curtime;	// Current time
+  size_t		msecs;		// Milliseconds in the queue
+
+
+  pthread_mutex_lock(&system->sched_mutex);
+
+  for (;;)
+  {
+    while (cupsArrayGetCount(system->sched_printers) == 0 && !system->sched_stopping && system->sched_workers <= system->max_processing_jobs)
+      pthread_cond_wait(&system->sched_cond, &system->sched_mutex);
+
+    if (system->sched_stopping || system->sched_workers > system->max_processing_jobs)
+      break;
+
+    // Take the first printer from the queue...
+    printer = (pappl_printer_t *)cupsArrayGetFirst(system->sched_printers);
+
+    cupsArrayRemove(system->sched_printers, printer);
+    printer->sched_queued = false;
+    printer->sched_busy ++;
+
+    system->jmetrics.queued = (size_t)cupsArrayGetCount(system->sched_printers);
+    system->sched_idle --;
+
+    // Calculate the time the printer spent in the queue...
+    clock_gettime(CLOCK_MONOTONIC, &curtime);
+    msecs = (size_t)((curtime.tv_sec - printer->sched_time.tv_sec) * 1000 + (curtime.tv_nsec - printer->sched_time.tv_nsec) / 1000000);
+
+    // Claim the next job without holding the scheduler lock, since
+    // _papplPrinterCheckJobs queues printers while holding the printer lock.
+    // The busy count keeps _papplJobSchedulerRemove from returning (and the
+    // printer from being deleted) until we are done...
+    pthread_mutex_unlock(&system->sched_mutex);
+    job = scheduler_next_job(printer);
+    pthread_mutex_lock(&system->sched_mutex);
+
+    if (-- printer->sched_busy == 0)
+      pthread_cond_broadcast(&system->sched_cond);
+
+    if (!job)
+    {
+      system->sched_idle ++;
+      continue;
+    }
+
+    // Update metrics...
+    system->jmetrics.dispatched ++;
+    system->jmetrics.queue_msecs += msecs;
+    if (msecs > system->jmetrics.max_queue_msecs)
+      system->jmetrics.max_queue_msecs = msecs;
+
+    system->jmetrics.processing_jobs ++;
+    if (system->jmetrics.processing_jobs > system->jmetrics.max_processing_jobs)
+      system->jmetrics.max_processing_jobs = system->jmetrics.processing_jobs;
+
+    pthread_mutex_unlock(&system->sched_mutex);
+
+    // Process the job...
+    papplLogPrinter(printer, PAPPL_LOGLEVEL_DEBUG, "Starting job %d.", job->job_id);
+
+    _papplJobProcess(job);
+
+    pthread_mutex_lock(&system->sched_mutex);
+
+    system->jmetrics.processing_jobs --;
+    system->sched_idle ++;
+  }
+
+  system->sched_workers --;
+  system->sched_idle --;
+
+  // Let _papplJobSchedulerStop know we are done...
+  pthread_cond_broadcast(&system->sched_cond);
+  pthread_mutex_unlock(&system->sched_mutex);
+
+  return (NULL);
+}
@@ -15,6 +15,15 @@
 #include "pappl-private.h"
 
 
+//
+// Local functions...
+//
+
+static int	compare_ujobs(_pappl_ujobs_t *a, _pappl_ujobs_t *b);
+static int	compare_user_jobs(pappl_job_t *a, pappl_job_t *b);
+static void	free_ujobs(_pappl_ujobs_t *ujobs);
+
+
 //
 // 'papplJobCancel()' - Cancel a job.
 //
@@ -106,6 +115,8 @@ _papplJobCreate(
   job->system  = printer->system;
   job->created = time(NULL);
 
+  clock_gettime(CLOCK_MONOTONIC, &job->created_mono);
+
   if (attrs)
   {
     // Copy all of the job attributes...
@@ -175,6 +186,7 @@ _papplJobCreate(
   ippAddString(job->attrs, IPP_TAG_JOB, IPP_TAG_URI, "job-printer-uri", NULL, job_printer_uri);
 
   cupsArrayAdd(printer->all_jobs, job);
+  _papplPrinterAddUserJobNoLock(printer, job);
 
   if (!job_id)
     cupsArrayAdd(printer->active_jobs, job);
@@ -183,7 +195,7 @@ _papplJobCreate(
 
   papplSystemAddEvent(printer->system, printer, job, PAPPL_EVENT_JOB_CREATED, NULL);
 
-  _papplSystemConfigChanged(printer->system);
+  _papplSystemJobChanged(printer->system, job);
 
   return (job);
 }
@@ -889,9 +901,54 @@ _papplJobSubmitFile(
 }
 
 
+//
+// '_papplPrinterAddUserJobNoLock()' - Add a job to the username index.
+//
+
+void
+_papplPrinterAddUserJobNoLock(
+    pappl_printer_t *printer,		// I - Printer
+    pappl_job_t     *job)		// I - Job
+{
+  _pappl_ujobs_t	key,		// Search key
+			*ujobs;		// Jobs for user
+
+
+  if (!printer->user_jobs && (printer->user_jobs = cupsArrayNew((cups_array_cb_t)compare_ujobs, NULL, NULL, 0, NULL, (cups_afree_cb_t)free_ujobs)) == NULL)
+    goto error;
+
+  key.username = (char *)(job->username ? job->username : "");
+
+  if ((ujobs = (_pappl_ujobs_t *)cupsArrayFind(printer->user_jobs, &key)) == NULL)
+  {
+    // First job for this user...
+    if ((ujobs = (_pappl_ujobs_t *)calloc(1, sizeof(_pappl_ujobs_t))) == NULL)
+      goto error;
+
+    if ((ujobs->username = strdup(key.username)) == NULL || (ujobs->jobs = cupsArrayNew((cups_array_cb_t)compare_user_jobs, NULL, NULL, 0, NULL, NULL)) == NULL)
+    {
+      free_ujobs(ujobs);
+      goto error;
+    }
+
+    cupsArrayAdd(printer->user_jobs, ujobs);
+  }
+
+  if (cupsArrayAdd(ujobs->jobs, job))
+    return;
+
+  error:
+
+  papplLogPrinter(printer, PAPPL_LOGLEVEL_ERROR, "Unable to add job %d to the username index: %s", job->job_id, strerror(errno));
+}
+
+
 //
 // '_papplPrinterCheckJobs()' - Check for new jobs to process.
 //
+// Printers with a pending job are queued in the system's job scheduler, which
+// limits the number of jobs that are processed at the same time.
+//
 
 void
 _papplPrinterCheckJobs(
@@ -939,23 +996,8 @@ _papplPrinterCheckJobs(
 
     if (job->state == IPP_JSTATE_PENDING)
     {
-      pthread_t	t;			// Thread
-
-      papplLogPrinter(printer, PAPPL_LOGLEVEL_DEBUG, "Starting job %d.", job->job_id);
-
-      if (pthread_create(&t, NULL, (void *(*)(void *))_papplJobProcess, job))
-      {
-	job->state     = IPP_JSTATE_ABORTED;
-	job->completed = time(NULL);
-
-	cupsArrayRemove(printer->active_jobs, job);
-	cupsArrayAdd(printer->completed_jobs, job);
-
-	if (!printer->system->clean_time)
-	  printer->system->clean_time = time(NULL) + 60;
-      }
-      else
-	pthread_detach(t);
+      // Let the job scheduler start the job when a worker is available...
+      _papplJobSchedulerAdd(printer);
       break;
     }
   }
@@ -989,7 +1031,10 @@ _papplPrinterCleanJobsNoLock(
   {
     if (job->completed && job->completed < cleantime && printer->max_completed_jobs > 0 && (int)cupsArrayGetCount(printer->completed_jobs) > printer->max_completed_jobs)
     {
+      _papplSystemJobChanged(printer->system, job);
+
       cupsArrayRemove(printer->completed_jobs, job);
+      _papplPrinterRemoveUserJobNoLock(printer, job);
       cupsArrayRemove(printer->all_jobs, job);
     }
     else if (printer->max_preserved_jobs > 0)
@@ -997,7 +1042,10 @@ _papplPrinterCleanJobsNoLock(
       if (job->filename)
       {
 	if ((preserved + 1) > printer->max_preserved_jobs || (job->retain_until && time(NULL) > job->retain_until))
+	{
 	  _papplJobRemoveFile(job);
+	  _papplSystemJobChanged(printer->system, job);
+	}
 	else
 	  preserved ++;
       }
@@ -1010,6 +1058,31 @@ _papplPrinterCleanJobsNoLock(
 }
 
 
+//
+// '_papplPrinterFindUserJobsNoLock()' - Find the jobs for a user.
+//
+// The returned array contains all of the user's jobs, sorted by descending
+// "job-id".  `NULL` is returned if the user has no jobs.
+//
+
+cups_array_t *				// O - Array of jobs or `NULL` for none
+_papplPrinterFindUserJobsNoLock(
+    pappl_printer_t *printer,		// I - Printer
+    const char      *username)		// I - Username
+{
+  _pappl_ujobs_t	key,		// Search key
+			*ujobs;		// Jobs for user
+
+
+  key.username = (char *)username;
+
+  if ((ujobs = (_pappl_ujobs_t *)cupsArrayFind(printer->user_jobs, &key)) != NULL)
+    return (ujobs->jobs);
+  else
+    return (NULL);
+}
+
+
 //
 // 'papplPrinterFindJob()' - Find a job.
 //
@@ -1035,6 +1108,31 @@ papplPrinterFindJob(
 }
 
 
+//
+// '_papplPrinterRemoveUserJobNoLock()' - Remove a job from the username index.
+//
+
+void
+_papplPrinterRemoveUserJobNoLock(
+    pappl_printer_t *printer,		// I - Printer
+    pappl_job_t     *job)		// I - Job
+{
+  _pappl_ujobs_t	key,		// Search key
+			*ujobs;		// Jobs for user
+
+
+  key.username = (char *)(job->username ? job->username : "");
+
+  if ((ujobs = (_pappl_ujobs_t *)cupsArrayFind(printer->user_jobs, &key)) != NULL)
+  {
+    cupsArrayRemove(ujobs->jobs, job);
+
+    if (cupsArrayGetCount(ujobs->jobs) == 0)
+      cupsArrayRemove(printer->user_jobs, ujobs);
+  }
+}
+
+
 //
 // 'papplSystemCleanJobs()' - Clean out old (completed) jobs.
 //
@@ -1075,3 +1173,40 @@ papplSystemCleanJobs(
 
   _papplRWUnlock(system);
 }
+
+
+//
+// 'compare_ujobs()' - Compare the usernames for two job indices.
+//
+
+static int				// O - Result of comparison
+compare_ujobs(_pappl_ujobs_t *a,	// I - First user
+              _pappl_ujobs_t *b)	// I - Second user
+{
+  return (strcasecmp(a->username, b->username));
+}
+
+
+//
+// 'compare_user_jobs()' - Compare two jobs for a user.
+//
+
+static int				// O - Result of comparison
+compare_user_jobs(pappl_job_t *a,	// I - First job
+                  pappl_job_t *b)	// I - Second job
+{
+  return (b->job_id - a->job_id);
+}
+
+
+//
+// 'free_ujobs()' - Free the job index for a user.
+//
+
+static void
+free_ujobs(_pappl_ujobs_t *ujobs)	// I - Jobs for user
+{
+  free(ujobs->username);
+  cupsArrayDelete(ujobs->jobs);
+  free(ujobs);
+}
@@ -53,6 +53,14 @@ enum pappl_jreason_e			// IPP "job-state-reasons" bit values
 typedef unsigned int pappl_jreason_t;	// Bitfield for IPP "job-state-reasons" values
 
 
+//
+// Callback functions...
+//
+
+typedef bool (*pappl_image_row_cb_t)(pappl_job_t *job, int y, unsigned char *row, void *data);
+					// papplJobFilterImageRows callback @since PAPPL 1.4@
+
+
 //
 // Functions...
 //
@@ -64,6 +72,7 @@ extern pappl_job_t	*papplJobCreateWithFile(pappl_printer_t *printer, const char
 extern void		papplJobDeletePrintOptions(pappl_pr_options_t *options);
 
 extern bool		papplJobFilterImage(pappl_job_t *job, pappl_device_t *device, pappl_pr_options_t *options, const unsigned char *pixels, int width, int height, int depth, int ppi, bool smoothing) _PAPPL_PUBLIC;
+extern bool		papplJobFilterImageRows(pappl_job_t *job, pappl_device_t *device, pappl_pr_options_t *options, pappl_image_row_cb_t row_cb, void *row_data, int width, int height, int depth, int ppi, bool smoothing) _PAPPL_PUBLIC;
 
 extern ipp_attribute_t	*papplJobGetAttribute(pappl_job_t *job, const char *name) _PAPPL_PUBLIC;
 extern int		papplJobGetCopies(pappl_job_t *job) _PAPPL_PUBLIC;
@@ -56,7 +56,10 @@ papplPrinterAddLink(
   l.options     = options;
 
   if (!cupsArrayFind(printer->links, &l))
+  {
     cupsArrayAdd(printer->links, &l);
+    printer->config_version ++;
+  }
 
   _papplRWUnlock(printer);
 }
@@ -83,7 +86,8 @@ papplPrinterRemoveLink(
 
   l.label = (char *)label;
 
-  cupsArrayRemove(printer->links, &l);
+  if (cupsArrayRemove(printer->links, &l))
+    printer->config_version ++;
 
   _papplRWUnlock(printer);
 }
@@ -0,0 +1,521 @@
+//
+// Lock contention profiler for the Printer Application Framework
+//
+// Copyright © 2023 by Michael R Sweet.
+//
+// Licensed under Apache License v2.0.  See the file "LICENSE" for more
+// information.
+//
+// When PAPPL is configured with `--enable-lock-profile`, the `_papplRWLock`
+// macros call the functions in this file instead of the pthread functions.
+// Each thread counts the acquisitions, wait time, and hold time for every
+// lock call site in its own table, so profiling does not add any shared
+// locks.  The counters are relaxed atomics so that other threads can read them
+// while the owning thread updates them.  Locks are first tried without blocking and only contended locks
+// are timed while waiting.  The hold time of uncontended locks is sampled.
+//
+
+//
+// Include necessary headers...
+//
+
+#include "pappl-private.h"
+
+
+#ifdef PAPPL_LOCK_PROFILE
+#  ifdef HAVE_STDATOMIC_H
+#    include <stdatomic.h>
+#  else
+#    error "Lock profiling requires <stdatomic.h>."
+#  endif // HAVE_STDATOMIC_H
+
+
+//
+// Local constants...
+//
+
+#  define _PAPPL_LOCK_HELD	16	// Maximum number of tracked locks per thread
+#  define _PAPPL_LOCK_SAMPLE	16	// Sample hold time for every Nth uncontended lock
+#  define _PAPPL_LOCK_SITES	512	// Number of call sites per thread (power of 2)
+
+
+//
+// Local types...
+//
+
+typedef struct _pappl_lsite_s		// Lock call site counters
+{
+  const char		*lock,		// Lock expression
+			*func;		// Function name
+  _Atomic(const char *)	file;		// Source filename (stored last to publish the site)
+  int			line;		// Source line number
+  bool			write;		// Write lock?
+  atomic_size_t		acquires,	// Number of acquisitions
+			contended,	// Number of contended acquisitions
+			hold_samples;	// Number of hold time samples
+  atomic_ullong		wait_nsecs,	// Total wait time
+			max_wait_nsecs,	// Maximum wait time
+			hold_nsecs,	// Total sampled hold time
+			max_hold_nsecs;	// Maximum sampled hold time
+} _pappl_lsite_t;
+
+typedef struct _pappl_lheld_s		// Held lock
+{
+  pthread_rwlock_t	*rwlock;	// Lock
+  _pappl_lsite_t	*site;		// Call site
+  unsigned long long	start;		// Time of acquisition or `0` if not sampled
+} _pappl_lheld_t;
+
+typedef struct _pappl_lthread_s		// Per-thread lock counters
+{
+  struct _pappl_lthread_s *prev,	// Previous thread
+			*next;		// Next thread
+  size_t		num_held;	// Number of held locks
+  _pappl_lheld_t	held[_PAPPL_LOCK_HELD];
+					// Held locks
+  _pappl_lsite_t	sites[_PAPPL_LOCK_SITES];
+					// Call sites (hash table)
+} _pappl_lthread_t;
+
+
+//
+// Local globals...
+//
+
+static pthread_key_t	lock_key;	// Thread-specific data key
+static pthread_mutex_t	lock_mutex = PTHREAD_MUTEX_INITIALIZER;
+					// Mutex for thread list
+static pthread_once_t	lock_once = PTHREAD_ONCE_INIT;
+					// One-time initialization
+static _pappl_lthread_t	lock_retired;	// Counters from exited threads
+static _pappl_lthread_t	*lock_threads = NULL;
+					// Active threads
+
+
+//
+// Local functions...
+//
+
+static int		lock_compare(_pappl_lsite_t *a, _pappl_lsite_t *b);
+static void		lock_exit(_pappl_lthread_t *t);
+static void		lock_init(void);
+static void		lock_max(atomic_ullong *max, unsigned long long value);
+static void		lock_merge(_pappl_lthread_t *to, _pappl_lthread_t *from);
+static unsigned long long lock_nsecs(void);
+static _pappl_lsite_t	*lock_site(_pappl_lthread_t *t, const char *lock, const char *file, int line, const char *func, bool write);
+static _pappl_lthread_t	*lock_thread(void);
+
+
+//
+// '_papplLockProfileAcquire()' - Acquire a reader/writer lock and update the
+//                                call site counters.
+//
+
+int					// O - 0 on success, error number otherwise
+_papplLockProfileAcquire(
+    pthread_rwlock_t *rwlock,		// I - Lock
+    bool             write,		// I - Acquire a write lock?
+    const char       *lock,		// I - Lock expression
+    const char       *file,		// I - Source filename
+    int              line,		// I - Source line number
+    const char       *func)		// I - Function name
+{
+  int			ret;		// Return value
+  size_t		acquires;	// Number of acquisitions
+  bool			contended = false;
+					// Was the lock busy?
+  unsigned long long	start = 0,	// Start of wait
+			now = 0;	// Time of acquisition
+  _pappl_lthread_t	*t;		// Thread counters
+  _pappl_lsite_t	*site;		// Call site counters
+  _pappl_lheld_t	*held;		// Held lock
+
+
+  // Try the lock first, then time the wait if it is busy...
+  if ((ret = write ? pthread_rwlock_trywrlock(rwlock) : pthread_rwlock_tryrdlock(rwlock)) == EBUSY || ret == EAGAIN)
+  {
+    contended = true;
+    start     = lock_nsecs();
+    ret       = write ? pthread_rwlock_wrlock(rwlock) : pthread_rwlock_rdlock(rwlock);
+    now       = lock_nsecs();
+  }
+
+  if (ret || (t = lock_thread()) == NULL || (site = lock_site(t, lock, file, line, func, write)) == NULL)
+    return (ret);
+
+  acquires = atomic_fetch_add_explicit(&site->acquires, 1, memory_order_relaxed) + 1;
+
+  if (contended)
+  {
+    atomic_fetch_add_explicit(&site->contended, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&site->wait_nsecs, now - start, memory_order_relaxed);
+    lock_max(&site->max_wait_nsecs, now - start);
+  }
+  else if ((acquires % _PAPPL_LOCK_SAMPLE) == 1)
+  {
+    now = lock_nsecs();
+  }
+
+  if (t->num_held < _PAPPL_LOCK_HELD)
+  {
+    held = t->held + t->num_held;
+    t->num_held ++;
+
+    held->rwlock = rwlock;
+    held->site   = site;
+    held->start  = now;
+  }
+
+  return (0);
+}
+
+
+//
+// '_papplLockProfileCopyStats()' - Copy the lock statistics from all threads.
+//
+
+size_t					// O - Number of lock call sites
+_papplLockProfileCopyStats(
+    size_t           max_stats,		// I - Maximum number of call sites
+    pappl_lockstat_t *stats)		// I - Lock call site statistics
+{
+  size_t		i,		// Looping var
+			count,		// Number of call sites
+			acquires,	// Number of acquisitions
+			hold_samples;	// Number of hold time samples
+  _pappl_lthread_t	*all,		// Counters for all threads
+			*t;		// Current thread
+  _pappl_lsite_t	*site;		// Current call site
+
+
+  if ((all = (_pappl_lthread_t *)calloc(1, sizeof(_pappl_lthread_t))) == NULL)
+    return (0);
+
+  pthread_once(&lock_once, lock_init);
+
+  pthread_mutex_lock(&lock_mutex);
+
+  lock_merge(all, &lock_retired);
+  for (t = lock_threads; t; t = t->next)
+    lock_merge(all, t);
+
+  pthread_mutex_unlock(&lock_mutex);
+
+  // Move the used call sites to the front of the table and sort them...
+  for (i = 0, count = 0, site = all->sites; i < _PAPPL_LOCK_SITES; i ++, site ++)
+  {
+    if (atomic_load_explicit(&site->acquires, memory_order_relaxed))
+    {
+      if (count < i)
+        all->sites[count] = *site;
+
+      count ++;
+    }
+  }
+
+  qsort(all->sites, count, sizeof(_pappl_lsite_t), (int (*)(const void *, const void *))lock_compare);
+
+  if (count > max_stats)
+    count = max_stats;
+
+  for (i = 0, site = all->sites; i < count; i ++, site ++, stats ++)
+  {
+    acquires     = atomic_load_explicit(&site->acquires, memory_order_relaxed);
+    hold_samples = atomic_load_explicit(&site->hold_samples, memory_order_relaxed);
+
+    stats->lock           = site->lock;
+    stats->func           = site->func;
+    stats->file           = atomic_load_explicit(&site->file, memory_order_relaxed);
+    stats->line           = site->line;
+    stats->write          = site->write;
+    stats->acquires       = acquires;
+    stats->contended      = atomic_load_explicit(&site->contended, memory_order_relaxed);
+    stats->wait_usecs     = (size_t)(atomic_load_explicit(&site->wait_nsecs, memory_order_relaxed) / 1000);
+    stats->max_wait_usecs = (size_t)(atomic_load_explicit(&site->max_wait_nsecs, memory_order_relaxed) / 1000);
+    stats->hold_usecs     = hold_samples ? (size_t)(atomic_load_explicit(&site->hold_nsecs, memory_order_relaxed) / 1000 * acquires / hold_samples) : 0;
+    stats->max_hold_usecs = (size_t)(atomic_load_explicit(&site->max_hold_nsecs, memory_order_relaxed) / 1000);
+  }
+
+  free(all);
+
+  return (count);
+}
+
+
+//
+// '_papplLockProfileRelease()' - Release a reader/writer lock and update the
+//                                call site counters.
+//
+
+int					// O - 0 on success, error number otherwise
+_papplLockProfileRelease(
+    pthread_rwlock_t *rwlock)		// I - Lock
+{
+  size_t		i;		// Looping var
+  unsigned long long	hold;		// Hold time
+  _pappl_lthread_t	*t;		// Thread counters
+  _pappl_lheld_t	*held;		// Held lock
+
+
+  pthread_once(&lock_once, lock_init);
+
+  if ((t = (_pappl_lthread_t *)pthread_getspecific(lock_key)) != NULL && t->num_held > 0)
+  {
+    // Find the most recent acquisition of this lock...
+    for (i = t->num_held, held = t->held + i - 1; i > 0; i --, held --)
+    {
+      if (held->rwlock == rwlock)
+        break;
+    }
+
+    if (i > 0)
+    {
+      if (held->start)
+      {
+        hold = lock_nsecs() - held->start;
+
+        atomic_fetch_add_explicit(&held->site->hold_samples, 1, memory_order_relaxed);
+        atomic_fetch_add_explicit(&held->site->hold_nsecs, hold, memory_order_relaxed);
+        lock_max(&held->site->max_hold_nsecs, hold);
+      }
+
+      t->num_held --;
+      if (i <= t->num_held)
+        memmove(held, held + 1, (t->num_held - i + 1) * sizeof(_pappl_lheld_t));
+    }
+  }
+
+  return (pthread_rwlock_unlock(rwlock));
+}
+
+
+//
+// 'lock_compare()' - Compare two call sites by wait time, contention, and
+//                    acquisitions.
+//
+
+static int				// O - Result of comparison
+lock_compare(_pappl_lsite_t *a,		// I - First call site
+             _pappl_lsite_t *b)		// I - Second call site
+{
+  unsigned long long	await = atomic_load_explicit(&a->wait_nsecs, memory_order_relaxed),
+			bwait = atomic_load_explicit(&b->wait_nsecs, memory_order_relaxed);
+					// Total wait times
+  size_t		acontended = atomic_load_explicit(&a->contended, memory_order_relaxed),
+			bcontended = atomic_load_explicit(&b->contended, memory_order_relaxed),
+					// Contended acquisitions
+			aacquires = atomic_load_explicit(&a->acquires, memory_order_relaxed),
+			bacquires = atomic_load_explicit(&b->acquires, memory_order_relaxed);
+					// Acquisitions
+
+
+  if (await != bwait)
+    return (await > bwait ? -1 : 1);
+  else if (acontended != bcontended)
+    return (acontended > bcontended ? -1 : 1);
+  else if (aacquires != bacquires)
+    return (aacquires > bacquires ? -1 : 1);
+  else
+    return (0);
+}
+
+
+//
+// 'lock_exit()' - Save the counters for an exiting thread.
+//
+
+static void
+lock_exit(_pappl_lthread_t *t)		// I - Thread counters
+{
+  pthread_mutex_lock(&lock_mutex);
+
+  lock_merge(&lock_retired, t);
+
+  if (t->prev)
+    t->prev->next = t->next;
+  else
+    lock_threads = t->next;
+
+  if (t->next)
+    t->next->prev = t->prev;
+
+  pthread_mutex_unlock(&lock_mutex);
+
+  free(t);
+}
+
+
+//
+// 'lock_init()' - Initialize the thread-specific data key.
+//
+
+static void
+lock_init(void)
+{
+  pthread_key_create(&lock_key, (void (*)(void *))lock_exit);
+}
+
+
+//
+// 'lock_max()' - Update a maximum time counter.
+//
+// Only the owning thread (or the merging thread while holding `lock_mutex`)
+// updates a counter, so a relaxed load and store is enough.
+//
+
+static void
+lock_max(atomic_ullong      *max,	// I - Maximum counter
+         unsigned long long value)	// I - New value
+{
+  if (value > atomic_load_explicit(max, memory_order_relaxed))
+    atomic_store_explicit(max, value, memory_order_relaxed);
+}
+
+
+//
+// 'lock_merge()' - Add the call site counters from one table to another.
+//
+
+static void
+lock_merge(_pappl_lthread_t *to,	// I - Destination counters
+           _pappl_lthread_t *from)	// I - Source counters
+{
+  size_t		i;		// Looping var
+  _pappl_lsite_t	*fsite,		// Source call site
+			*tsite;		// Destination call site
+  const char		*ffile;		// Source call site filename
+  size_t		acquires;	// Source acquisitions
+
+
+  for (i = 0, fsite = from->sites; i < _PAPPL_LOCK_SITES; i ++, fsite ++)
+  {
+    // The source thread may be adding call sites and updating the counters
+    // while we merge, so only look at sites that have been published...
+    if ((ffile = atomic_load_explicit(&fsite->file, memory_order_acquire)) == NULL || (acquires = atomic_load_explicit(&fsite->acquires, memory_order_relaxed)) == 0 || (tsite = lock_site(to, fsite->lock, ffile, fsite->line, fsite->func, fsite->write)) == NULL)
+      continue;
+
+    atomic_fetch_add_explicit(&tsite->acquires, acquires, memory_order_relaxed);
+    atomic_fetch_add_explicit(&tsite->contended, atomic_load_explicit(&fsite->contended, memory_order_relaxed), memory_order_relaxed);
+    atomic_fetch_add_explicit(&tsite->hold_samples, atomic_load_explicit(&fsite->hold_samples, memory_order_relaxed), memory_order_relaxed);
+    atomic_fetch_add_explicit(&tsite->wait_nsecs, atomic_load_explicit(&fsite->wait_nsecs, memory_order_relaxed), memory_order_relaxed);
+    atomic_fetch_add_explicit(&tsite->hold_nsecs, atomic_load_explicit(&fsite->hold_nsecs, memory_order_relaxed), memory_order_relaxed);
+
+    lock_max(&tsite->max_wait_nsecs, atomic_load_explicit(&fsite->max_wait_nsecs, memory_order_relaxed));
+    lock_max(&tsite->max_hold_nsecs, atomic_load_explicit(&fsite->max_hold_nsecs, memory_order_relaxed));
+  }
+}
+
+
+//
+// 'lock_nsecs()' - Get the current monotonic time in nanoseconds.
+//
+
+static unsigned long long		// O - Time in nanoseconds
+lock_nsecs(void)
+{
+  struct timespec	curtime;	// Current time
+
+
+  clock_gettime(CLOCK_MONOTONIC, &curtime);
+
+  return ((unsigned long long)curtime.tv_sec * 1000000000ULL + (unsigned long long)curtime.tv_nsec);
+}
+
+
+//
+// 'lock_site()' - Find or add a call site in a thread's table.
+//
+
+static _pappl_lsite_t *			// O - Call site or `NULL` if the table is full
+lock_site(_pappl_lthread_t *t,		// I - Thread counters
+          const char       *lock,	// I - Lock expression
+          const char       *file,	// I - Source filename
+          int              line,	// I - Source line number
+          const char       *func,	// I - Function name
+          bool             write)	// I - Write lock?
+{
+  size_t		i,		// Looping var
+			hash;		// Hash for call site
+  _pappl_lsite_t	*site;		// Current call site
+  const char		*sfile;		// Call site filename
+
+
+  // The filename and function are string constants, so just hash the pointer
+  // and line number...
+  hash = (((size_t)file >> 4) ^ ((size_t)line * 31) ^ (write ? 1 : 0)) & (_PAPPL_LOCK_SITES - 1);
+
+  for (i = 0; i < _PAPPL_LOCK_SITES; i ++, hash = (hash + 1) & (_PAPPL_LOCK_SITES - 1))
+  {
+    site = t->sites + hash;
+
+    // Only this thread adds sites to its table, so a relaxed load is enough
+    // here; other threads read the filename with an acquire load...
+    if ((sfile = atomic_load_explicit(&site->file, memory_order_relaxed)) == NULL)
+    {
+      site->lock  = lock;
+      site->func  = func;
+      site->line  = line;
+      site->write = write;
+
+      atomic_store_explicit(&site->file, file, memory_order_release);
+
+      return (site);
+    }
+    else if (site->line == line && sfile == file && site->write == write)
+    {
+      return (site);
+    }
+  }
+
+  return (NULL);
+}
+
+
+//
+// 'lock_thread()' - Get the counters for the current thread.
+//
+
+static _pappl_lthread_t *		// O - Thread counters or `NULL` on error
+lock_thread(void)
+{
+  _pappl_lthread_t	*t;		// Thread counters
+
+
+  pthread_once(&lock_once, lock_init);
+
+  if ((t = (_pappl_lthread_t *)pthread_getspecific(lock_key)) == NULL)
+  {
+    if ((t = (_pappl_lthread_t *)calloc(1, sizeof(_pappl_lthread_t))) == NULL)
+      return (NULL);
+
+    pthread_mutex_lock(&lock_mutex);
+
+    if ((t->next = lock_threads) != NULL)
+      lock_threads->prev = t;
+    lock_threads = t;
+
+    pthread_mutex_unlock(&lock_mutex);
+
+    pthread_setspecific(lock_key, t);
+  }
+
+  return (t);
+}
+
+
+#else
+//
+// '_papplLockProfileCopyStats()' - Copy the lock statistics (not supported).
+//
+
+size_t					// O - Number of lock call sites
+_papplLockProfileCopyStats(
+    size_t           max_stats,		// I - Maximum number of call sites
+    pappl_lockstat_t *stats)		// I - Lock call site statistics
+{
+  (void)max_stats;
+  (void)stats;
+
+  return (0);
+}
+#endif // PAPPL_LOCK_PROFILE
@@ -11,6 +11,15 @@
 #  define _PAPPL_LOG_PRIVATE_H_
 #  include "base-private.h"
 #  include "log.h"
+#  include "system.h"
+
+
+//
+// Types...
+//
+
+typedef struct _pappl_logq_s _pappl_logq_t;
+					// Asynchronous log queue
 
 
 //
@@ -18,6 +27,8 @@
 //
 
 extern void	_papplLogAttributes(pappl_client_t *client, const char *title, ipp_t *ipp, bool is_response) _PAPPL_PRIVATE;
+extern void	_papplLogClose(pappl_system_t *system) _PAPPL_PRIVATE;
+extern void	_papplLogCopyMetrics(pappl_system_t *system, pappl_lmetrics_t *metrics) _PAPPL_PRIVATE;
 extern void	_papplLogOpen(pappl_system_t *system) _PAPPL_PRIVATE;
 
 #endif // !_PAPPL_LOG_PRIVATE_H_
@@ -19,15 +19,73 @@
 #include <stdarg.h>
 #if !_WIN32
 #  include <syslog.h>
+#  include <sys/uio.h>
 #endif // !_WIN32
+#if defined(HAVE_STDATOMIC_H) && !_WIN32
+#  define _PAPPL_LOG_ASYNC 1
+#  include <stdatomic.h>
+#endif // HAVE_STDATOMIC_H && !_WIN32
+
+
+//
+// Local constants...
+//
+
+#define _PAPPL_LOG_BATCH	64	// Maximum number of lines per write
+#define _PAPPL_LOG_LINE_SIZE	2048	// Maximum size of a log line
+#define _PAPPL_LOG_QUEUE_SIZE	256	// Number of lines in the log queue (power of 2)
+
+
+//
+// Local types...
+//
+
+#ifdef _PAPPL_LOG_ASYNC
+typedef struct _pappl_logq_line_s	// Queued log line
+{
+  atomic_size_t		seq;		// Sequence number
+  size_t		length;		// Length of line
+  char			data[_PAPPL_LOG_LINE_SIZE];
+					// Line data
+} _pappl_logq_line_t;
+
+struct _pappl_logq_s			// Asynchronous log queue
+{
+  pthread_t		thread;		// Writer thread
+  pthread_mutex_t	mutex;		// Writer mutex
+  pthread_cond_t	cond,		// Writer condition variable
+			wcond;		// Written condition variable
+  atomic_bool		running,	// Is the writer thread running?
+			waiting;	// Is the writer thread waiting for lines?
+  bool			stopping;	// Is the writer thread stopping?
+  atomic_size_t		head,		// Next line to queue
+			tail;		// Next line to write
+  size_t		written;	// Number of lines written
+  atomic_size_t		queued,		// Total number of lines queued
+			dropped,	// Number of lines dropped
+			max_queued;	// Maximum number of lines in the queue
+  size_t		writes,		// Number of writes
+			bytes;		// Number of bytes written
+  _pappl_logq_line_t	lines[_PAPPL_LOG_QUEUE_SIZE];
+					// Queued lines
+};
+#endif // _PAPPL_LOG_ASYNC
 
 
 //
 // Local functions...
 //
 
-static void	rotate_log(pappl_system_t *system);
+static void	log_started(pappl_system_t *system);
+static void	open_log(pappl_system_t *system);
+#ifdef _PAPPL_LOG_ASYNC
+static bool	queue_log(pappl_system_t *system, pappl_loglevel_t level, const char *line, size_t length);
+#endif // _PAPPL_LOG_ASYNC
+static bool	rotate_log(pappl_system_t *system);
 static void	write_log(pappl_system_t *system, pappl_loglevel_t level, const char *message, va_list ap);
+#ifdef _PAPPL_LOG_ASYNC
+static void	*write_log_thread(pappl_system_t *system);
+#endif // _PAPPL_LOG_ASYNC
 
 
 //
@@ -35,7 +93,7 @@ static void	write_log(pappl_system_t *system, pappl_loglevel_t level, const char
 //
 
 static pthread_mutex_t	log_mutex = PTHREAD_MUTEX_INITIALIZER;
-					// Log rotation mutex
+					// Log file mutex
 #if !_WIN32
 static const int	syslevels[] =	// Mapping of log levels to syslog
 {
@@ -209,6 +267,82 @@ papplLogClient(
 }
 
 
+//
+// '_papplLogClose()' - Close the log file.
+//
+// This function stops the log writer thread, if any, after writing any queued
+// log lines.
+//
+
+void
+_papplLogClose(
+    pappl_system_t *system)		// I - System
+{
+#ifdef _PAPPL_LOG_ASYNC
+  _pappl_logq_t	*logq = system->logq;	// Log queue
+
+
+  if (logq)
+  {
+    // Stop the writer thread, which writes any queued lines before exiting...
+    atomic_store(&logq->running, false);
+
+    pthread_mutex_lock(&logq->mutex);
+    logq->stopping = true;
+    pthread_cond_signal(&logq->cond);
+    pthread_cond_broadcast(&logq->wcond);
+    pthread_mutex_unlock(&logq->mutex);
+
+    pthread_join(logq->thread, NULL);
+
+    pthread_cond_destroy(&logq->cond);
+    pthread_cond_destroy(&logq->wcond);
+    pthread_mutex_destroy(&logq->mutex);
+
+    free(logq);
+    system->logq = NULL;
+  }
+#endif // _PAPPL_LOG_ASYNC
+
+  if (system->logfd >= 0 && system->logfd != 2)
+    close(system->logfd);
+
+  system->logfd = -1;
+}
+
+
+//
+// '_papplLogCopyMetrics()' - Copy the log metrics.
+//
+
+void
+_papplLogCopyMetrics(
+    pappl_system_t   *system,		// I - System
+    pappl_lmetrics_t *metrics)		// I - Buffer for metrics data
+{
+  memset(metrics, 0, sizeof(pappl_lmetrics_t));
+
+#ifdef _PAPPL_LOG_ASYNC
+  _pappl_logq_t	*logq = system->logq;	// Log queue
+
+
+  if (logq)
+  {
+    metrics->queued     = atomic_load(&logq->queued);
+    metrics->dropped    = atomic_load(&logq->dropped);
+    metrics->max_queued = atomic_load(&logq->max_queued);
+
+    pthread_mutex_lock(&logq->mutex);
+    metrics->writes = logq->writes;
+    metrics->bytes  = logq->bytes;
+    pthread_mutex_unlock(&logq->mutex);
+  }
+#else
+  (void)system;
+#endif // _PAPPL_LOG_ASYNC
+}
+
+
 //
 // 'papplLogDevice()' - Log a device error for the system...
 //
@@ -285,36 +419,48 @@ _papplLogOpen(
     pappl_system_t *system)		// I - System
 {
   // Open the log file...
-  if (!strcmp(system->logfile, "syslog"))
-  {
-    // Log to syslog...
-    system->logfd = -1;
-  }
-  else if (!strcmp(system->logfile, "-"))
-  {
-    // Log to stderr...
-    system->logfd = 2;
-  }
-  else
+  pthread_mutex_lock(&log_mutex);
+  open_log(system);
+  pthread_mutex_unlock(&log_mutex);
+
+#ifdef _PAPPL_LOG_ASYNC
+  // Start the log writer thread as needed...
+  if (system->logfd >= 0 && !system->logq)
   {
-    int	oldfd = system->logfd;		// Old log file descriptor
+    _pappl_logq_t	*logq;		// Log queue
+    size_t		i;		// Looping var
 
-    // Log to a file...
-    if ((system->logfd = open(system->logfile, O_CREAT | O_WRONLY | O_APPEND | O_NOFOLLOW | O_CLOEXEC, 0600)) < 0)
+    if ((logq = calloc(1, sizeof(_pappl_logq_t))) != NULL)
     {
-      // Fallback to logging to stderr if we can't open the log file...
-      perror(system->logfile);
+      pthread_mutex_init(&logq->mutex, NULL);
+      pthread_cond_init(&logq->cond, NULL);
+      pthread_cond_init(&logq->wcond, NULL);
 
-      system->logfd = 2;
-    }
+      for (i = 0; i < _PAPPL_LOG_QUEUE_SIZE; i ++)
+        atomic_init(&logq->lines[i].seq, i);
 
-    // Close any old file...
-    if (oldfd != -1)
-      close(oldfd);
+      atomic_init(&logq->running, true);
+
+      system->logq = logq;
+
+      if (pthread_create(&logq->thread, NULL, (void *(*)(void *))write_log_thread, system))
+      {
+        // Unable to create the writer thread, log synchronously...
+        perror("Unable to create log writer thread");
+
+        system->logq = NULL;
+
+        pthread_cond_destroy(&logq->cond);
+        pthread_cond_destroy(&logq->wcond);
+        pthread_mutex_destroy(&logq->mutex);
+        free(logq);
+      }
+    }
   }
+#endif // _PAPPL_LOG_ASYNC
 
   // Log the system status information
-  papplLog(system, PAPPL_LOGLEVEL_INFO, "Starting log, system up %ld second(s), %d printer(s), listening for connections on '%s:%d' from up to %d clients.", (long)(time(NULL) - system->start_time), (int)cupsArrayGetCount(system->printers), system->hostname, system->port, system->max_clients);
+  log_started(system);
 }
 
 
@@ -382,17 +528,187 @@ papplLogPrinter(
 
 
 //
-// 'rotate_log()' - Rotate the log file...
+// 'log_started()' - Log the system status information after opening the log.
 //
 
 static void
-rotate_log(pappl_system_t *system)	// I - System
+log_started(pappl_system_t *system)	// I - System
+{
+  papplLog(system, PAPPL_LOGLEVEL_INFO, "Starting log, system up %ld second(s), %d printer(s), listening for connections on '%s:%d' from up to %d clients.", (long)(time(NULL) - system->start_time), (int)cupsArrayGetCount(system->printers), system->hostname, system->port, system->max_clients);
+}
+
+
+//
+// 'open_log()' - Open the log file.
+//
+// The caller must hold the log mutex.
+//
+
+static void
+open_log(pappl_system_t *system)	// I - System
+{
+  struct stat	loginfo;		// Log file information
+
+
+  system->logsize = 0;
+
+  if (!strcmp(system->logfile, "syslog"))
+  {
+    // Log to syslog...
+    system->logfd = -1;
+  }
+  else if (!strcmp(system->logfile, "-"))
+  {
+    // Log to stderr...
+    system->logfd = 2;
+  }
+  else
+  {
+    int	oldfd = system->logfd;		// Old log file descriptor
+
+    // Log to a file...
+    if ((system->logfd = open(system->logfile, O_CREAT | O_WRONLY | O_APPEND | O_NOFOLLOW | O_CLOEXEC, 0600)) < 0)
+    {
+      // Fallback to logging to stderr if we can't open the log file...
+      perror(system->logfile);
+
+      system->logfd = 2;
+    }
+    else if (!fstat(system->logfd, &loginfo))
+    {
+      // Track the size of the log file from here on...
+      system->logsize = loginfo.st_size;
+    }
+
+    // Close any old file...
+    if (oldfd != -1 && oldfd != 2)
+      close(oldfd);
+  }
+}
+
+
+#ifdef _PAPPL_LOG_ASYNC
+//
+// 'queue_log()' - Queue a line for the log writer thread.
+//
+// Debug lines are dropped when the queue is full while other lines wait for the
+// writer thread to free up space.  Error and fatal error lines are written
+// before this function returns, so that they are not lost when the program
+// exits.
+//
+
+static bool				// O - `true` if queued or dropped, `false` if the writer isn't running
+queue_log(pappl_system_t   *system,	// I - System
+          pappl_loglevel_t level,	// I - Log level
+          const char       *line,	// I - Line
+          size_t           length)	// I - Length of line
 {
-  struct stat	loginfo;		// Lof file information
+  _pappl_logq_t		*logq = system->logq;
+					// Log queue
+  _pappl_logq_line_t	*qline;		// Queued line
+  size_t		pos,		// Position in queue
+			count,		// Number of queued lines
+			max_queued;	// Maximum number of queued lines
+  ptrdiff_t		diff;		// Difference between sequence and position
+
+
+  if (!logq || !atomic_load(&logq->running) || pthread_equal(logq->thread, pthread_self()))
+    return (false);			// Write directly from the writer thread
+
+  // Claim a line in the queue - each line's sequence number matches the
+  // position when it is free...
+  pos = atomic_load_explicit(&logq->head, memory_order_relaxed);
+
+  for (;;)
+  {
+    qline = logq->lines + (pos & (_PAPPL_LOG_QUEUE_SIZE - 1));
+    diff  = (ptrdiff_t)(atomic_load_explicit(&qline->seq, memory_order_acquire) - pos);
+
+    if (diff == 0)
+    {
+      if (atomic_compare_exchange_weak_explicit(&logq->head, &pos, pos + 1, memory_order_relaxed, memory_order_relaxed))
+        break;
+    }
+    else if (diff < 0)
+    {
+      // Queue is full, drop debug messages...
+      if (level <= PAPPL_LOGLEVEL_DEBUG)
+      {
+	atomic_fetch_add(&logq->dropped, 1);
+	return (true);
+      }
+
+      // Otherwise wait for the writer thread to free a line...
+      pthread_mutex_lock(&logq->mutex);
+
+      pthread_cond_signal(&logq->cond);
+
+      while ((atomic_load(&logq->tail) + _PAPPL_LOG_QUEUE_SIZE) <= pos && !logq->stopping)
+        pthread_cond_wait(&logq->wcond, &logq->mutex);
+
+      pthread_mutex_unlock(&logq->mutex);
+
+      if (!atomic_load(&logq->running))
+        return (false);
+
+      pos = atomic_load_explicit(&logq->head, memory_order_relaxed);
+    }
+    else
+    {
+      // Another thread claimed this line...
+      pos = atomic_load_explicit(&logq->head, memory_order_relaxed);
+    }
+  }
+
+  // Copy the line and hand it to the writer thread...
+  memcpy(qline->data, line, length);
+  qline->length = length;
+
+  atomic_store(&qline->seq, pos + 1);
+  atomic_fetch_add(&logq->queued, 1);
 
+  // Update the high water mark - the writer thread may already be past this
+  // line...
+  if ((diff = (ptrdiff_t)(pos + 1 - atomic_load(&logq->tail))) > 0)
+  {
+    count      = (size_t)diff > _PAPPL_LOG_QUEUE_SIZE ? _PAPPL_LOG_QUEUE_SIZE : (size_t)diff;
+    max_queued = atomic_load(&logq->max_queued);
+
+    while (count > max_queued && !atomic_compare_exchange_weak(&logq->max_queued, &max_queued, count));
+  }
 
-  // Re-check whether we need to rotate the log file...
-  if (!fstat(system->logfd, &loginfo) && loginfo.st_size >= (off_t)system->logmaxsize)
+  if (atomic_load(&logq->waiting) || level >= PAPPL_LOGLEVEL_ERROR)
+  {
+    pthread_mutex_lock(&logq->mutex);
+
+    pthread_cond_signal(&logq->cond);
+
+    if (level >= PAPPL_LOGLEVEL_ERROR)
+    {
+      // Wait for the line to be written...
+      while (logq->written <= pos && !logq->stopping)
+        pthread_cond_wait(&logq->wcond, &logq->mutex);
+    }
+
+    pthread_mutex_unlock(&logq->mutex);
+  }
+
+  return (true);
+}
+#endif // _PAPPL_LOG_ASYNC
+
+
+//
+// 'rotate_log()' - Rotate the log file as needed.
+//
+// The caller must hold the log mutex.
+//
+
+static bool				// O - `true` if rotated, `false` otherwise
+rotate_log(pappl_system_t *system)	// I - System
+{
+  // Only rotate log files that have reached the maximum size...
+  if (system->logmaxsize > 0 && system->logfd >= 0 && system->logfd != 2 && system->logsize >= (off_t)system->logmaxsize)
   {
     // Rename existing log file to "xxx.O"
     char	backname[1024];		// Backup log filename
@@ -407,8 +723,12 @@ rotate_log(pappl_system_t *system)	// I - System
     unlink(backname);
     rename(system->logfile, backname);
 
-    _papplLogOpen(system);
+    open_log(system);
+
+    return (true);
   }
+
+  return (false);
 }
 
 
@@ -422,8 +742,8 @@ write_log(pappl_system_t   *system,	// I - System
           const char       *message,	// I - Printf-style message string
           va_list          ap)		// I - Pointer to additional arguments
 {
-  struct stat	loginfo;		// Log file information
-  char		buffer[2048],		// Output buffer
+  char		buffer[_PAPPL_LOG_LINE_SIZE],
+					// Output buffer
 		*bufptr,		// Pointer into buffer
 		*bufend;		// Pointer to end of buffer
   struct timeval curtime;		// Current time
@@ -437,16 +757,10 @@ write_log(pappl_system_t   *system,	// I - System
 		prec;			// Number of characters of precision
   char		tformat[100],		// Temporary format string for sprintf()
 		*tptr;			// Pointer into temporary format
+  ssize_t	bytes;			// Bytes written
+  bool		rotated;		// Was the log file rotated?
 
 
-  // Rotate log as needed...
-  if (system->logmaxsize > 0 && !fstat(system->logfd, &loginfo) && loginfo.st_size >= (off_t)system->logmaxsize)
-  {
-    pthread_mutex_lock(&log_mutex);
-    rotate_log(system);
-    pthread_mutex_unlock(&log_mutex);
-  }
-
   // Each log line starts with a standard prefix of log level and date/time...
   gettimeofday(&curtime, NULL);
 #if _WIN32
@@ -671,5 +985,154 @@ write_log(pappl_system_t   *system,	// I - System
   // Add a newline and write it out...
   *bufptr++ = '\n';
 
-  write(system->logfd, buffer, (size_t)(bufptr - buffer));
+#ifdef _PAPPL_LOG_ASYNC
+  if (queue_log(system, level, buffer, (size_t)(bufptr - buffer)))
+    return;
+#endif // _PAPPL_LOG_ASYNC
+
+  // Write the line directly when there is no writer thread...
+  pthread_mutex_lock(&log_mutex);
+
+  rotated = rotate_log(system);
+
+  if ((bytes = write(system->logfd, buffer, (size_t)(bufptr - buffer))) > 0)
+    system->logsize += bytes;
+
+  pthread_mutex_unlock(&log_mutex);
+
+  if (rotated)
+    log_started(system);
+}
+
+
+#ifdef _PAPPL_LOG_ASYNC
+//
+// 'write_log_thread()' - Write queued lines to the log file.
+//
+
+static void *				// O - Thread exit status
+write_log_thread(
+    pappl_system_t *system)		// I - System
+{
+  _pappl_logq_t		*logq = system->logq;
+					// Log queue
+  _pappl_logq_line_t	*qline;		// Queued line
+  struct iovec		iov[_PAPPL_LOG_BATCH],
+					// Lines to write
+			*iovptr;	// Current line
+  int			i,		// Looping var
+			count,		// Number of lines
+			iovcount;	// Number of lines left to write
+  size_t		tail,		// Next line to write
+			total;		// Total bytes written
+  ssize_t		bytes;		// Bytes written
+  bool			rotated;	// Was the log file rotated?
+  struct timespec	timeout;	// Timeout for wait
+
+
+  pthread_mutex_lock(&logq->mutex);
+
+  for (;;)
+  {
+    // Gather the lines that are ready to be written...
+    tail = atomic_load_explicit(&logq->tail, memory_order_relaxed);
+
+    for (count = 0; count < _PAPPL_LOG_BATCH; count ++)
+    {
+      qline = logq->lines + ((tail + (size_t)count) & (_PAPPL_LOG_QUEUE_SIZE - 1));
+
+      if (atomic_load_explicit(&qline->seq, memory_order_acquire) != (tail + (size_t)count + 1))
+        break;
+
+      iov[count].iov_base = qline->data;
+      iov[count].iov_len  = qline->length;
+    }
+
+    if (count == 0)
+    {
+      if (logq->stopping)
+        break;
+
+      // Wait for more lines, re-checking after telling producers we are
+      // waiting so we don't miss a wakeup...
+      atomic_store(&logq->waiting, true);
+
+      qline = logq->lines + (tail & (_PAPPL_LOG_QUEUE_SIZE - 1));
+
+      if (atomic_load(&qline->seq) != (tail + 1))
+      {
+	clock_gettime(CLOCK_REALTIME, &timeout);
+	timeout.tv_sec ++;
+
+	pthread_cond_timedwait(&logq->cond, &logq->mutex, &timeout);
+      }
+
+      atomic_store(&logq->waiting, false);
+      continue;
+    }
+
+    pthread_mutex_unlock(&logq->mutex);
+
+    // Write the lines...
+    pthread_mutex_lock(&log_mutex);
+
+    rotated = rotate_log(system);
+
+    for (iovptr = iov, iovcount = count, total = 0; iovcount > 0;)
+    {
+      if ((bytes = writev(system->logfd, iovptr, iovcount)) < 0)
+      {
+        if (errno == EINTR)
+          continue;
+
+        break;
+      }
+
+      system->logsize += bytes;
+      total           += (size_t)bytes;
+
+      // Skip the lines that have been written...
+      while (iovcount > 0 && (size_t)bytes >= iovptr->iov_len)
+      {
+        bytes -= (ssize_t)iovptr->iov_len;
+        iovptr ++;
+        iovcount --;
+      }
+
+      if (iovcount > 0)
+      {
+        iovptr->iov_base = (char *)iovptr->iov_base + bytes;
+        iovptr->iov_len  -= (size_t)bytes;
+      }
+    }
+
+    pthread_mutex_unlock(&log_mutex);
+
+    // Free the lines for reuse...
+    for (i = 0; i < count; i ++)
+      atomic_store_explicit(&logq->lines[(tail + (size_t)i) & (_PAPPL_LOG_QUEUE_SIZE - 1)].seq, tail + (size_t)i + _PAPPL_LOG_QUEUE_SIZE, memory_order_release);
+
+    atomic_store(&logq->tail, tail + (size_t)count);
+
+    pthread_mutex_lock(&logq->mutex);
+
+    logq->written = tail + (size_t)count;
+    logq->writes ++;
+    logq->bytes += total;
+
+    pthread_cond_broadcast(&logq->wcond);
+
+    if (rotated)
+    {
+      pthread_mutex_unlock(&logq->mutex);
+      log_started(system);
+      pthread_mutex_lock(&logq->mutex);
+    }
+  }
+
+  pthread_mutex_unlock(&logq->mutex);
+
+  return (NULL);
 }
+#endif // _PAPPL_LOG_ASYNC
+
@@ -1676,6 +1676,8 @@ default_system_cb(
         soptions = PAPPL_SOPTIONS_NONE;
       else if (!strcmp(valptr, "dnssd-host") || !strncmp(valptr, "dnssd-host,", 11))
         soptions |= PAPPL_SOPTIONS_DNSSD_HOST;
+      else if (!strcmp(valptr, "metrics") || !strncmp(valptr, "metrics,", 8))
+        soptions |= PAPPL_SOPTIONS_METRICS;
       else if (!strcmp(valptr, "no-multi-queue") || !strncmp(valptr, "no-multi-queue,", 15))
         soptions &= (pappl_soptions_t)~PAPPL_SOPTIONS_MULTI_QUEUE;
       else if (!strcmp(valptr, "raw-socket") || !strncmp(valptr, "raw-socket,", 11))
@@ -0,0 +1,636 @@
+//
+// Request, job, and device metrics for the Printer Application Framework
+//
+// Copyright © 2023 by Michael R Sweet.
+//
+// Licensed under Apache License v2.0.  See the file "LICENSE" for more
+// information.
+//
+// Metrics are only collected when the system is created with the
+// `PAPPL_SOPTIONS_METRICS` option, otherwise the instrumentation points only
+// check for a `NULL` pointer.  The collected values are provided in the
+// Prometheus text format by the "/metrics" resource.
+//
+
+//
+// Include necessary headers...
+//
+
+#include "pappl-private.h"
+
+
+//
+// Local constants...
+//
+
+#define _PAPPL_METRICS_BUCKETS	16	// Number of histogram buckets, including "+Inf"
+#define _PAPPL_METRICS_OPS	160	// Number of operation slots (IPP + CUPS)
+
+
+//
+// Local types...
+//
+
+typedef struct _pappl_histogram_s	// Latency histogram
+{
+  size_t		counts[_PAPPL_METRICS_BUCKETS];
+					// Counts for each bucket
+  size_t		count;		// Total number of samples
+  unsigned long long	nsecs;		// Total nanoseconds
+} _pappl_histogram_t;
+
+typedef struct _pappl_mop_s		// Operation metrics
+{
+  _pappl_histogram_t	latency;	// Request latency
+  unsigned long long	request_bytes,	// Request message bytes
+			response_bytes;	// Response message bytes
+} _pappl_mop_t;
+
+typedef struct _pappl_mprinter_s	// Printer metrics
+{
+  int			printer_id;	// "printer-id" value
+  char			resource[512];	// Resource path of printer, escaped for labels
+  _pappl_histogram_t	latency,	// Request latency
+			queue,		// Job queue wait time
+			processing;	// Job processing time
+  size_t		jobs[3];	// Canceled, aborted, and completed jobs
+  unsigned long long	write_requests,	// Device write requests
+			write_bytes,	// Device bytes written
+			write_msecs;	// Device write milliseconds
+} _pappl_mprinter_t;
+
+struct _pappl_metrics_s			// Metrics data
+{
+  pthread_mutex_t	mutex;		// Mutex for metrics
+  _pappl_mop_t		ops[_PAPPL_METRICS_OPS];
+					// Operation metrics
+  cups_array_t		*printers;	// Printer metrics, sorted by ID
+};
+
+
+//
+// Local globals...
+//
+
+static const unsigned long long metrics_bounds[_PAPPL_METRICS_BUCKETS - 1] =
+{					// Histogram bucket limits in nanoseconds
+  1000000ULL,
+  2500000ULL,
+  5000000ULL,
+  10000000ULL,
+  25000000ULL,
+  50000000ULL,
+  100000000ULL,
+  250000000ULL,
+  500000000ULL,
+  1000000000ULL,
+  2500000000ULL,
+  5000000000ULL,
+  10000000000ULL,
+  30000000000ULL,
+  60000000000ULL
+};
+static const char * const metrics_les[_PAPPL_METRICS_BUCKETS] =
+{					// Histogram bucket "le" labels
+  "0.001",
+  "0.0025",
+  "0.005",
+  "0.01",
+  "0.025",
+  "0.05",
+  "0.1",
+  "0.25",
+  "0.5",
+  "1",
+  "2.5",
+  "5",
+  "10",
+  "30",
+  "60",
+  "+Inf"
+};
+
+
+//
+// Local functions...
+//
+
+static void		add_sample(_pappl_histogram_t *h, unsigned long long nsecs);
+static int		compare_printers(_pappl_mprinter_t *a, _pappl_mprinter_t *b, void *data);
+static void		copy_label(char *dst, const char *src, size_t dstsize);
+static _pappl_mprinter_t *find_printer(_pappl_metrics_t *m, pappl_printer_t *printer);
+static void		write_histogram(http_t *http, const char *name, const char *labels, _pappl_histogram_t *h);
+
+
+//
+// '_papplMetricsAddDevice()' - Add the device metrics for a printer.
+//
+// This function is called before the printer's device is closed.
+//
+
+void
+_papplMetricsAddDevice(
+    pappl_printer_t    *printer,	// I - Printer
+    pappl_devmetrics_t *dmetrics)	// I - Device metrics
+{
+  _pappl_metrics_t	*m = printer->system->metrics;
+					// Metrics
+  _pappl_mprinter_t	*mp;		// Printer metrics
+
+
+  if (!m)
+    return;
+
+  pthread_mutex_lock(&m->mutex);
+
+  if ((mp = find_printer(m, printer)) != NULL)
+  {
+    mp->write_requests += dmetrics->write_requests;
+    mp->write_bytes    += dmetrics->write_bytes;
+    mp->write_msecs    += dmetrics->write_msecs;
+  }
+
+  pthread_mutex_unlock(&m->mutex);
+}
+
+
+//
+// '_papplMetricsAddJob()' - Add the queue and processing times for a finished job.
+//
+
+void
+_papplMetricsAddJob(
+    pappl_job_t *job)			// I - Job
+{
+  _pappl_metrics_t	*m = job->system->metrics;
+					// Metrics
+  _pappl_mprinter_t	*mp;		// Printer metrics
+
+
+  if (!m || job->state < IPP_JSTATE_CANCELED)
+    return;
+
+  pthread_mutex_lock(&m->mutex);
+
+  if ((mp = find_printer(m, job->printer)) != NULL)
+  {
+    mp->jobs[job->state - IPP_JSTATE_CANCELED] ++;
+
+    if (job->processing)
+    {
+      // Jobs loaded from the state file have no monotonic creation time, so
+      // fall back to the wall clock (in whole seconds) for the queue time...
+      if (job->created_mono.tv_sec || job->created_mono.tv_nsec)
+        add_sample(&mp->queue, (unsigned long long)(job->processing_mono.tv_sec - job->created_mono.tv_sec) * 1000000000ULL + (unsigned long long)job->processing_mono.tv_nsec - (unsigned long long)job->created_mono.tv_nsec);
+      else
+        add_sample(&mp->queue, (unsigned long long)(job->processing - job->created) * 1000000000ULL);
+
+      add_sample(&mp->processing, (unsigned long long)(job->completed_mono.tv_sec - job->processing_mono.tv_sec) * 1000000000ULL + (unsigned long long)job->completed_mono.tv_nsec - (unsigned long long)job->processing_mono.tv_nsec);
+    }
+  }
+
+  pthread_mutex_unlock(&m->mutex);
+}
+
+
+//
+// '_papplMetricsAddRequest()' - Add the latency and sizes of an IPP request.
+//
+
+void
+_papplMetricsAddRequest(
+    pappl_client_t        *client,	// I - Client
+    ipp_op_t              op,		// I - Operation code
+    const struct timespec *start)	// I - Start time
+{
+  _pappl_metrics_t	*m = client->system->metrics;
+					// Metrics
+  _pappl_mop_t		*mop;		// Operation metrics
+  _pappl_mprinter_t	*mp;		// Printer metrics
+  struct timespec	curtime;	// Current time
+  unsigned long long	nsecs;		// Elapsed nanoseconds
+
+
+  if (!m)
+    return;
+
+  clock_gettime(CLOCK_MONOTONIC, &curtime);
+
+  nsecs = (unsigned long long)(curtime.tv_sec - start->tv_sec) * 1000000000ULL + (unsigned long long)curtime.tv_nsec - (unsigned long long)start->tv_nsec;
+
+  // Operations 0x0001 to 0x007f map directly, CUPS operations use the slots
+  // after that, and everything else is counted in slot 0...
+  if (op >= IPP_OP_CUPS_GET_DEFAULT && op < (ipp_op_t)(IPP_OP_CUPS_GET_DEFAULT + _PAPPL_METRICS_OPS - 0x81))
+    op = (ipp_op_t)(op - IPP_OP_CUPS_GET_DEFAULT + 0x81);
+  else if (op < 0 || op > 0x7f)
+    op = (ipp_op_t)0;
+
+  pthread_mutex_lock(&m->mutex);
+
+  mop = m->ops + op;
+
+  add_sample(&mop->latency, nsecs);
+  mop->request_bytes  += ippGetLength(client->request);
+  mop->response_bytes += ippGetLength(client->response);
+
+  if (client->printer && (mp = find_printer(m, client->printer)) != NULL)
+    add_sample(&mp->latency, nsecs);
+
+  pthread_mutex_unlock(&m->mutex);
+}
+
+
+//
+// '_papplMetricsCreate()' - Create the metrics data.
+//
+
+_pappl_metrics_t *			// O - Metrics data or `NULL` on error
+_papplMetricsCreate(void)
+{
+  _pappl_metrics_t	*m;		// Metrics
+
+
+  if ((m = (_pappl_metrics_t *)calloc(1, sizeof(_pappl_metrics_t))) == NULL)
+    return (NULL);
+
+  if ((m->printers = cupsArrayNew((cups_array_cb_t)compare_printers, NULL, NULL, 0, NULL, NULL)) == NULL)
+  {
+    free(m);
+    return (NULL);
+  }
+
+  pthread_mutex_init(&m->mutex, NULL);
+
+  return (m);
+}
+
+
+//
+// '_papplMetricsDelete()' - Free the metrics data.
+//
+
+void
+_papplMetricsDelete(
+    _pappl_metrics_t *m)		// I - Metrics data
+{
+  _pappl_mprinter_t	*mp;		// Printer metrics
+
+
+  if (!m)
+    return;
+
+  for (mp = (_pappl_mprinter_t *)cupsArrayGetFirst(m->printers); mp; mp = (_pappl_mprinter_t *)cupsArrayGetNext(m->printers))
+    free(mp);
+
+  cupsArrayDelete(m->printers);
+  pthread_mutex_destroy(&m->mutex);
+  free(m);
+}
+
+
+//
+// '_papplMetricsRemovePrinter()' - Remove the metrics for a deleted printer.
+//
+
+void
+_papplMetricsRemovePrinter(
+    pappl_printer_t *printer)		// I - Printer
+{
+  _pappl_metrics_t	*m = printer->system->metrics;
+					// Metrics
+  _pappl_mprinter_t	key,		// Search key
+			*mp;		// Printer metrics
+
+
+  if (!m)
+    return;
+
+  key.printer_id = printer->printer_id;
+
+  pthread_mutex_lock(&m->mutex);
+
+  if ((mp = (_pappl_mprinter_t *)cupsArrayFind(m->printers, &key)) != NULL)
+  {
+    cupsArrayRemove(m->printers, mp);
+    free(mp);
+  }
+
+  pthread_mutex_unlock(&m->mutex);
+}
+
+
+//
+// '_papplSystemWebMetrics()' - Return the system metrics in the Prometheus text
+//                              format.
+//
+
+void
+_papplSystemWebMetrics(
+    pappl_client_t *client,		// I - Client
+    pappl_system_t *system)		// I - System
+{
+  _pappl_metrics_t	*m = system->metrics;
+					// Metrics
+  http_status_t		status;		// Authorization status
+  _pappl_mop_t		*ops;		// Copy of operation metrics
+  _pappl_mprinter_t	*printers,	// Copy of printer metrics
+			*mp;		// Current printer metrics
+  size_t		i,		// Looping var
+			num_printers;	// Number of printers
+  pappl_ametrics_t	ametrics;	// Authentication cache metrics
+  pappl_cmetrics_t	cmetrics;	// Client metrics
+  pappl_dcmetrics_t	dcmetrics;	// Device connection metrics
+  pappl_imetrics_t	imetrics;	// Image filter metrics
+  pappl_jmetrics_t	jmetrics;	// Job metrics
+  int			num_clients,	// Number of clients
+			job_workers,	// Number of job worker threads
+			job_idle;	// Number of idle job worker threads
+  ipp_op_t		op;		// Operation code
+  char			labels[1024];	// Labels for values
+
+
+  if ((status = papplClientIsAuthorized(client)) != HTTP_STATUS_CONTINUE)
+  {
+    papplClientRespond(client, status, NULL, NULL, 0, 0);
+    return;
+  }
+
+  if (client->operation != HTTP_STATE_GET)
+  {
+    papplClientRespond(client, HTTP_STATUS_BAD_REQUEST, NULL, NULL, 0, 0);
+    return;
+  }
+
+  // Copy the current values so that we don't hold any locks while writing to
+  // the client...
+  papplSystemGetAuthMetrics(system, &ametrics);
+  papplSystemGetClientMetrics(system, &cmetrics);
+  papplSystemGetDeviceMetrics(system, &dcmetrics);
+  papplSystemGetImageMetrics(system, &imetrics);
+  papplSystemGetJobMetrics(system, &jmetrics);
+
+  _papplRWLockRead(system);
+  num_clients = system->num_clients;
+  _papplRWUnlock(system);
+
+  pthread_mutex_lock(&system->sched_mutex);
+  job_workers = system->sched_workers;
+  job_idle    = system->sched_idle;
+  pthread_mutex_unlock(&system->sched_mutex);
+
+  pthread_mutex_lock(&m->mutex);
+
+  num_printers = (size_t)cupsArrayGetCount(m->printers);
+  ops          = (_pappl_mop_t *)malloc(sizeof(m->ops));
+  printers     = (_pappl_mprinter_t *)calloc(num_printers + 1, sizeof(_pappl_mprinter_t));
+
+  if (ops && printers)
+  {
+    memcpy(ops, m->ops, sizeof(m->ops));
+
+    for (i = 0, mp = (_pappl_mprinter_t *)cupsArrayGetFirst(m->printers); mp; i ++, mp = (_pappl_mprinter_t *)cupsArrayGetNext(m->printers))
+      memcpy(printers + i, mp, sizeof(_pappl_mprinter_t));
+  }
+
+  pthread_mutex_unlock(&m->mutex);
+
+  if (!ops || !printers)
+  {
+    free(ops);
+    free(printers);
+
+    papplClientRespond(client, HTTP_STATUS_SERVER_ERROR, NULL, NULL, 0, 0);
+    return;
+  }
+
+  if (!papplClientRespond(client, HTTP_STATUS_OK, NULL, "text/plain; version=0.0.4", 0, 0))
+    goto done;
+
+  // Current state...
+  httpPrintf(client->http, "# HELP pappl_clients Current number of client connections.\n# TYPE pappl_clients gauge\npappl_clients %d\n", num_clients);
+  httpPrintf(client->http, "# HELP pappl_client_workers_active Current number of busy client worker threads.\n# TYPE pappl_client_workers_active gauge\npappl_client_workers_active %lu\n", (unsigned long)cmetrics.active_workers);
+  httpPrintf(client->http, "# HELP pappl_client_requests_queued Current number of client requests waiting for a worker thread.\n# TYPE pappl_client_requests_queued gauge\npappl_client_requests_queued %lu\n", (unsigned long)cmetrics.queued);
+  httpPrintf(client->http, "# HELP pappl_client_requests_deferred_total Client requests deferred because the request queue was full.\n# TYPE pappl_client_requests_deferred_total counter\npappl_client_requests_deferred_total %lu\n", (unsigned long)cmetrics.deferred);
+  httpPrintf(client->http, "# HELP pappl_client_html_flushes_total HTML output buffer flushes.\n# TYPE pappl_client_html_flushes_total counter\npappl_client_html_flushes_total %lu\n", (unsigned long)cmetrics.html_flushes);
+  httpPrintf(client->http, "# HELP pappl_client_html_bytes_total HTML bytes sent.\n# TYPE pappl_client_html_bytes_total counter\npappl_client_html_bytes_total %lu\n", (unsigned long)cmetrics.html_bytes);
+  httpPrintf(client->http, "# HELP pappl_job_workers Current number of job worker threads.\n# TYPE pappl_job_workers gauge\npappl_job_workers %d\n", job_workers);
+  httpPrintf(client->http, "# HELP pappl_job_workers_idle Current number of idle job worker threads.\n# TYPE pappl_job_workers_idle gauge\npappl_job_workers_idle %d\n", job_idle);
+  httpPrintf(client->http, "# HELP pappl_jobs_processing Current number of processing jobs.\n# TYPE pappl_jobs_processing gauge\npappl_jobs_processing %lu\n", (unsigned long)jmetrics.processing_jobs);
+  httpPrintf(client->http, "# HELP pappl_jobs_queued Current number of printers waiting for a job worker thread.\n# TYPE pappl_jobs_queued gauge\npappl_jobs_queued %lu\n", (unsigned long)jmetrics.queued);
+  httpPrintf(client->http, "# HELP pappl_auth_cache_entries Current number of cached authentications.\n# TYPE pappl_auth_cache_entries gauge\npappl_auth_cache_entries %lu\n", (unsigned long)ametrics.entries);
+  httpPrintf(client->http, "# HELP pappl_auth_cache_hits_total Requests that used a cached authentication.\n# TYPE pappl_auth_cache_hits_total counter\npappl_auth_cache_hits_total %lu\n", (unsigned long)ametrics.hits);
+  httpPrintf(client->http, "# HELP pappl_auth_cache_misses_total Requests that needed a full authentication.\n# TYPE pappl_auth_cache_misses_total counter\npappl_auth_cache_misses_total %lu\n", (unsigned long)ametrics.misses);
+  httpPrintf(client->http, "# HELP pappl_device_opens_total Device connections opened for jobs.\n# TYPE pappl_device_opens_total counter\npappl_device_opens_total %lu\n", (unsigned long)dcmetrics.opens);
+  httpPrintf(client->http, "# HELP pappl_device_reuses_total Jobs that reused an open device connection.\n# TYPE pappl_device_reuses_total counter\npappl_device_reuses_total %lu\n", (unsigned long)dcmetrics.reuses);
+  httpPrintf(client->http, "# HELP pappl_device_stale_total Kept-alive device connections closed by the printer.\n# TYPE pappl_device_stale_total counter\npappl_device_stale_total %lu\n", (unsigned long)dcmetrics.stale);
+  httpPrintf(client->http, "# HELP pappl_device_idle_closes_total Kept-alive device connections closed after the idle timeout.\n# TYPE pappl_device_idle_closes_total counter\npappl_device_idle_closes_total %lu\n", (unsigned long)dcmetrics.idle_closes);
+  httpPrintf(client->http, "# HELP pappl_images_total Images printed by the image filter.\n# TYPE pappl_images_total counter\npappl_images_total %lu\n", (unsigned long)imetrics.images);
+  httpPrintf(client->http, "# HELP pappl_image_reads_total Passes through images by the image filter.\n# TYPE pappl_image_reads_total counter\npappl_image_reads_total %lu\n", (unsigned long)imetrics.reads);
+  httpPrintf(client->http, "# HELP pappl_image_rows_total Image rows printed by the image filter.\n# TYPE pappl_image_rows_total counter\npappl_image_rows_total %lu\n", (unsigned long)imetrics.rows);
+
+  // Operation metrics...
+  httpPrintf(client->http, "# HELP pappl_ipp_request_duration_seconds IPP request processing time.\n# TYPE pappl_ipp_request_duration_seconds histogram\n");
+  for (i = 0; i < _PAPPL_METRICS_OPS; i ++)
+  {
+    if (!ops[i].latency.count)
+      continue;
+
+    op = i > 0x80 ? (ipp_op_t)(i - 0x81 + IPP_OP_CUPS_GET_DEFAULT) : (ipp_op_t)i;
+    snprintf(labels, sizeof(labels), "operation=\"%s\"", i ? ippOpString(op) : "unknown");
+    write_histogram(client->http, "pappl_ipp_request_duration_seconds", labels, &ops[i].latency);
+  }
+
+  httpPrintf(client->http, "# HELP pappl_ipp_request_bytes_total IPP request message bytes.\n# TYPE pappl_ipp_request_bytes_total counter\n");
+  for (i = 0; i < _PAPPL_METRICS_OPS; i ++)
+  {
+    if (!ops[i].latency.count)
+      continue;
+
+    op = i > 0x80 ? (ipp_op_t)(i - 0x81 + IPP_OP_CUPS_GET_DEFAULT) : (ipp_op_t)i;
+    httpPrintf(client->http, "pappl_ipp_request_bytes_total{operation=\"%s\"} %llu\n", i ? ippOpString(op) : "unknown", ops[i].request_bytes);
+  }
+
+  httpPrintf(client->http, "# HELP pappl_ipp_response_bytes_total IPP response message bytes.\n# TYPE pappl_ipp_response_bytes_total counter\n");
+  for (i = 0; i < _PAPPL_METRICS_OPS; i ++)
+  {
+    if (!ops[i].latency.count)
+      continue;
+
+    op = i > 0x80 ? (ipp_op_t)(i - 0x81 + IPP_OP_CUPS_GET_DEFAULT) : (ipp_op_t)i;
+    httpPrintf(client->http, "pappl_ipp_response_bytes_total{operation=\"%s\"} %llu\n", i ? ippOpString(op) : "unknown", ops[i].response_bytes);
+  }
+
+  // Printer metrics...
+  httpPrintf(client->http, "# HELP pappl_printer_request_duration_seconds IPP request processing time for each printer.\n# TYPE pappl_printer_request_duration_seconds histogram\n");
+  for (i = 0, mp = printers; i < num_printers; i ++, mp ++)
+  {
+    snprintf(labels, sizeof(labels), "printer_id=\"%d\",printer=\"%s\"", mp->printer_id, mp->resource);
+    write_histogram(client->http, "pappl_printer_request_duration_seconds", labels, &mp->latency);
+  }
+
+  httpPrintf(client->http, "# HELP pappl_job_queue_seconds Time jobs waited before processing.\n# TYPE pappl_job_queue_seconds histogram\n");
+  for (i = 0, mp = printers; i < num_printers; i ++, mp ++)
+  {
+    snprintf(labels, sizeof(labels), "printer_id=\"%d\",printer=\"%s\"", mp->printer_id, mp->resource);
+    write_histogram(client->http, "pappl_job_queue_seconds", labels, &mp->queue);
+  }
+
+  httpPrintf(client->http, "# HELP pappl_job_processing_seconds Time spent processing jobs.\n# TYPE pappl_job_processing_seconds histogram\n");
+  for (i = 0, mp = printers; i < num_printers; i ++, mp ++)
+  {
+    snprintf(labels, sizeof(labels), "printer_id=\"%d\",printer=\"%s\"", mp->printer_id, mp->resource);
+    write_histogram(client->http, "pappl_job_processing_seconds", labels, &mp->processing);
+  }
+
+  httpPrintf(client->http, "# HELP pappl_jobs_total Number of finished jobs.\n# TYPE pappl_jobs_total counter\n");
+  for (i = 0, mp = printers; i < num_printers; i ++, mp ++)
+  {
+    httpPrintf(client->http, "pappl_jobs_total{printer_id=\"%d\",printer=\"%s\",state=\"canceled\"} %lu\n", mp->printer_id, mp->resource, (unsigned long)mp->jobs[0]);
+    httpPrintf(client->http, "pappl_jobs_total{printer_id=\"%d\",printer=\"%s\",state=\"aborted\"} %lu\n", mp->printer_id, mp->resource, (unsigned long)mp->jobs[1]);
+    httpPrintf(client->http, "pappl_jobs_total{printer_id=\"%d\",printer=\"%s\",state=\"completed\"} %lu\n", mp->printer_id, mp->resource, (unsigned long)mp->jobs[2]);
+  }
+
+  httpPrintf(client->http, "# HELP pappl_device_write_bytes_total Bytes written to the printer device.\n# TYPE pappl_device_write_bytes_total counter\n");
+  for (i = 0, mp = printers; i < num_printers; i ++, mp ++)
+    httpPrintf(client->http, "pappl_device_write_bytes_total{printer_id=\"%d\",printer=\"%s\"} %llu\n", mp->printer_id, mp->resource, mp->write_bytes);
+
+  httpPrintf(client->http, "# HELP pappl_device_write_requests_total Write requests sent to the printer device.\n# TYPE pappl_device_write_requests_total counter\n");
+  for (i = 0, mp = printers; i < num_printers; i ++, mp ++)
+    httpPrintf(client->http, "pappl_device_write_requests_total{printer_id=\"%d\",printer=\"%s\"} %llu\n", mp->printer_id, mp->resource, mp->write_requests);
+
+  httpPrintf(client->http, "# HELP pappl_device_write_seconds_total Time spent writing to the printer device.\n# TYPE pappl_device_write_seconds_total counter\n");
+  for (i = 0, mp = printers; i < num_printers; i ++, mp ++)
+    httpPrintf(client->http, "pappl_device_write_seconds_total{printer_id=\"%d\",printer=\"%s\"} %.3f\n", mp->printer_id, mp->resource, 0.001 * mp->write_msecs);
+
+  httpWrite(client->http, "", 0);
+
+  done:
+
+  free(ops);
+  free(printers);
+}
+
+
+//
+// 'add_sample()' - Add a sample to a histogram.
+//
+
+static void
+add_sample(_pappl_histogram_t *h,	// I - Histogram
+           unsigned long long nsecs)	// I - Sample in nanoseconds
+{
+  size_t	i;			// Looping var
+
+
+  for (i = 0; i < (_PAPPL_METRICS_BUCKETS - 1) && nsecs > metrics_bounds[i]; i ++);
+
+  h->counts[i] ++;
+  h->count ++;
+  h->nsecs += nsecs;
+}
+
+
+//
+// 'compare_printers()' - Compare the IDs of two printer metrics.
+//
+
+static int				// O - Result of comparison
+compare_printers(
+    _pappl_mprinter_t *a,		// I - First printer metrics
+    _pappl_mprinter_t *b,		// I - Second printer metrics
+    void              *data)		// I - Callback data (not used)
+{
+  (void)data;
+
+  return (a->printer_id - b->printer_id);
+}
+
+
+//
+// 'copy_label()' - Copy a string, escaping it for a Prometheus label value.
+//
+
+static void
+copy_label(char       *dst,		// I - Destination buffer
+           const char *src,		// I - Source string
+           size_t     dstsize)		// I - Size of destination buffer
+{
+  char	*dstptr,			// Pointer into destination
+	*dstend = dst + dstsize - 1;	// End of destination
+
+
+  for (dstptr = dst; *src && dstptr < dstend; src ++)
+  {
+    if (*src == '\\' || *src == '"' || *src == '\n')
+    {
+      if ((dstptr + 1) >= dstend)
+        break;
+
+      *dstptr++ = '\\';
+      *dstptr++ = *src == '\n' ? 'n' : *src;
+    }
+    else
+    {
+      *dstptr++ = *src;
+    }
+  }
+
+  *dstptr = '\0';
+}
+
+
+//
+// 'find_printer()' - Find or add the metrics for a printer.
+//
+// The metrics mutex must be held when calling this function.
+//
+
+static _pappl_mprinter_t *		// O - Printer metrics or `NULL` on error
+find_printer(_pappl_metrics_t *m,	// I - Metrics
+             pappl_printer_t  *printer)	// I - Printer
+{
+  _pappl_mprinter_t	key,		// Search key
+			*mp;		// Printer metrics
+
+
+  key.printer_id = printer->printer_id;
+
+  if ((mp = (_pappl_mprinter_t *)cupsArrayFind(m->printers, &key)) == NULL)
+  {
+    if ((mp = (_pappl_mprinter_t *)calloc(1, sizeof(_pappl_mprinter_t))) == NULL)
+      return (NULL);
+
+    mp->printer_id = printer->printer_id;
+    copy_label(mp->resource, printer->resource, sizeof(mp->resource));
+
+    cupsArrayAdd(m->printers, mp);
+  }
+
+  return (mp);
+}
+
+
+//
+// 'write_histogram()' - Write a histogram in the Prometheus text format.
+//
+
+static void
+write_histogram(
+    http_t             *http,		// I - HTTP connection
+    const char         *name,		// I - Metric name
+    const char         *labels,		// I - Labels
+    _pappl_histogram_t *h)		// I - Histogram
+{
+  size_t	i,			// Looping var
+		count;			// Cumulative count
+
+
+  for (i = 0, count = 0; i < _PAPPL_METRICS_BUCKETS; i ++)
+  {
+    count += h->counts[i];
+    httpPrintf(http, "%s_bucket{%s,le=\"%s\"} %lu\n", name, labels, metrics_les[i], (unsigned long)count);
+  }
+
+  httpPrintf(http, "%s_sum{%s} %.9f\n", name, labels, 0.000000001 * h->nsecs);
+  httpPrintf(http, "%s_count{%s} %lu\n", name, labels, (unsigned long)h->count);
+}
@@ -12,6 +12,7 @@
 //
 
 #include "printer-private.h"
+#include "device-private.h"
 #include "job-private.h"
 #include "system-private.h"
 
@@ -20,7 +21,9 @@
 // 'papplPrinterCloseDevice()' - Close the device associated with the printer.
 //
 // This function closes the device for a printer.  The device must have been
-// previously opened using the @link papplPrinterOpenDevice@ function.
+// previously opened using the @link papplPrinterOpenDevice@ function.  Network
+// devices are kept open if the printer has a keep-alive time set using the
+// @link papplPrinterSetDeviceKeepAlive@ function.
 //
 
 void
@@ -43,9 +46,7 @@ papplPrinterCloseDevice(
 
 //    papplLogPrinter(printer, PAPPL_LOGLEVEL_DEBUG, "Closing device.");
 
-    papplDeviceClose(printer->device);
-
-    printer->device = NULL;
+    _papplPrinterReleaseDeviceNoLock(printer);
 
     _papplRWUnlock(printer);
   }
@@ -132,6 +133,23 @@ papplPrinterGetDeviceID(
 }
 
 
+//
+// 'papplPrinterGetDeviceKeepAlive()' - Get the device keep-alive time.
+//
+// This function returns the number of seconds an idle network device is kept
+// open as set by the @link papplPrinterSetDeviceKeepAlive@ function.
+//
+// @since PAPPL 1.4@
+//
+
+int					// O - Keep-alive time in seconds, `0` to close after each use
+papplPrinterGetDeviceKeepAlive(
+    pappl_printer_t *printer)		// I - Printer
+{
+  return (printer ? printer->device_keepalive : 0);
+}
+
+
 //
 // 'papplPrinterGetDeviceURI()' - Get the URI of the device associated with the
 //                                printer.
@@ -515,7 +533,8 @@ papplPrinterGetPrintGroup(
 //
 // This function returns the current printer state reasons bitfield, which can
 // be updated by the printer driver and/or by the @link papplPrinterSetReasons@
-// function.
+// function.  The driver's status callback is called periodically as set by the
+// @link papplSystemSetStatusInterval@ function.
 //
 
 pappl_preason_t				// O - "printer-state-reasons" bit values
@@ -525,9 +544,9 @@ papplPrinterGetReasons(
   if (!printer)
     return (PAPPL_PREASON_NONE);
 
-  if (!printer->device_in_use && !printer->processing_job && (time(NULL) - printer->status_time) > 1 && printer->driver_data.status_cb)
+  if (!papplSystemGetStatusInterval(printer->system) && !printer->device_in_use && !printer->processing_job && (time(NULL) - printer->status_time) > 1 && printer->driver_data.status_cb)
   {
-    // Update printer status...
+    // Update printer status on demand since there is no status thread...
     (printer->driver_data.status_cb)(printer);
     printer->status_time = time(NULL);
   }
@@ -638,6 +657,7 @@ papplPrinterHoldNewJobs(
     // Set the 'hold-new-jobs' flag...
     printer->hold_new_jobs = true;
     printer->config_time   = time(NULL);
+    printer->config_version ++;
     ret                    = true;
 
     // Notify of the change in state...
@@ -903,7 +923,18 @@ papplPrinterOpenDevice(
   {
 //    papplLogPrinter(printer, PAPPL_LOGLEVEL_DEBUG, "Opening device for status/maintenance.");
 
-    printer->device        = device = papplDeviceOpen(printer->device_uri, "printer", papplLogDevice, printer->system);
+    if (printer->device && !_papplDeviceIsConnected(printer->device))
+    {
+      // Kept-alive connection was closed by the printer...
+      papplDeviceClose(printer->device);
+      printer->device = NULL;
+    }
+
+    if (!printer->device)
+      printer->device = papplDeviceOpen(printer->device_uri, "printer", papplLogDevice, printer->system);
+
+    device                 = printer->device;
+    printer->device_idle   = 0;
     printer->device_in_use = device != NULL;
   }
 
@@ -969,6 +1000,7 @@ papplPrinterReleaseHeldNewJobs(
     // Release jobs and clear the 'hold-new-jobs' flag...
     printer->hold_new_jobs = false;
     printer->config_time   = time(NULL);
+    printer->config_version ++;
     ret                    = true;
 
     _papplSystemAddEventNoLock(printer->system, printer, NULL, PAPPL_EVENT_PRINTER_CONFIG_CHANGED, "Releasing held new jobs.");
@@ -1040,6 +1072,7 @@ papplPrinterSetContact(
 
   printer->contact     = *contact;
   printer->config_time = time(NULL);
+  printer->config_version ++;
 
   _papplRWUnlock(printer);
 
@@ -1047,6 +1080,38 @@ papplPrinterSetContact(
 }
 
 
+//
+// 'papplPrinterSetDeviceKeepAlive()' - Set the device keep-alive time.
+//
+// This function sets the number of seconds a network ("dnssd", "snmp", or
+// "socket") device is kept open after a job or status query so that the next
+// job can reuse the connection instead of looking up and connecting to the
+// printer again.  The connection is checked before it is reused and is closed
+// when the printer closes it or when it has been idle for "seconds" seconds.
+//
+// The default value of `0` closes the device after each use.  Some printers
+// only print the last page of a job when the connection is closed, so only
+// enable this for printers and drivers that end each job explicitly.
+//
+// @since PAPPL 1.4@
+//
+
+void
+papplPrinterSetDeviceKeepAlive(
+    pappl_printer_t *printer,		// I - Printer
+    int             seconds)		// I - Keep-alive time in seconds, `0` to close after each use
+{
+  if (!printer || seconds < 0)
+    return;
+
+  _papplRWLockWrite(printer);
+
+  printer->device_keepalive = seconds;
+
+  _papplRWUnlock(printer);
+}
+
+
 //
 // 'papplPrinterSetDNSSDName()' - Set the DNS-SD service name.
 //
@@ -1069,6 +1134,7 @@ papplPrinterSetDNSSDName(
   printer->dns_sd_collision = false;
   printer->dns_sd_serial    = 0;
   printer->config_time      = time(NULL);
+  printer->config_version ++;
 
   if (!value)
     _papplPrinterUnregisterDNSSDNoLock(printer);
@@ -1108,6 +1174,7 @@ papplPrinterSetGeoLocation(
   free(printer->geo_location);
   printer->geo_location = value && *value ? strdup(value) : NULL;
   printer->config_time  = time(NULL);
+  printer->config_version ++;
 
   _papplPrinterRegisterDNSSDNoLock(printer);
 
@@ -1164,6 +1231,7 @@ papplPrinterSetLocation(
   free(printer->location);
   printer->location    = value ? strdup(value) : NULL;
   printer->config_time = time(NULL);
+  printer->config_version ++;
 
   _papplPrinterRegisterDNSSDNoLock(printer);
 
@@ -1196,6 +1264,7 @@ papplPrinterSetMaxActiveJobs(
 
   printer->max_active_jobs = max_active_jobs;
   printer->config_time     = time(NULL);
+  printer->config_version ++;
 
   _papplRWUnlock(printer);
 
@@ -1223,6 +1292,7 @@ papplPrinterSetMaxCompletedJobs(
 
   printer->max_completed_jobs = max_completed_jobs;
   printer->config_time        = time(NULL);
+  printer->config_version ++;
 
   _papplRWUnlock(printer);
 
@@ -1250,6 +1320,7 @@ papplPrinterSetMaxPreservedJobs(
 
   printer->max_preserved_jobs = max_preserved_jobs;
   printer->config_time        = time(NULL);
+  printer->config_version ++;
 
   _papplRWUnlock(printer);
 
@@ -1279,6 +1350,7 @@ papplPrinterSetNextJobID(
 
   printer->next_job_id = next_job_id;
   printer->config_time = time(NULL);
+  printer->config_version ++;
 
   _papplRWUnlock(printer);
 
@@ -1306,6 +1378,7 @@ papplPrinterSetOrganization(
   free(printer->organization);
   printer->organization = value ? strdup(value) : NULL;
   printer->config_time  = time(NULL);
+  printer->config_version ++;
 
   _papplRWUnlock(printer);
 
@@ -1333,6 +1406,7 @@ papplPrinterSetOrganizationalUnit(
   free(printer->org_unit);
   printer->org_unit    = value ? strdup(value) : NULL;
   printer->config_time = time(NULL);
+  printer->config_version ++;
 
   _papplRWUnlock(printer);
 
@@ -1363,6 +1437,7 @@ papplPrinterSetPrintGroup(
   free(printer->print_group);
   printer->print_group = value ? strdup(value) : NULL;
   printer->config_time = time(NULL);
+  printer->config_version ++;
 
 #if !_WIN32
   if (printer->print_group && strcmp(printer->print_group, "none"))
@@ -1382,6 +1457,7 @@ papplPrinterSetPrintGroup(
 
   _papplRWUnlock(printer);
 
+  _papplAuthCacheFlush(printer->system);
   _papplSystemConfigChanged(printer->system);
 }
 
@@ -1436,6 +1512,7 @@ papplPrinterSetSupplies(
   if (supplies)
     memcpy(printer->supply, supplies, (size_t)num_supplies * sizeof(pappl_supply_t));
   printer->state_time = time(NULL);
+  printer->supply_version ++;
 
   _papplRWUnlock(printer);
 }
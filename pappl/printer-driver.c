@@ -196,6 +196,8 @@ papplPrinterSetDriverData(
   if (attrs)
     ippCopyAttributes(printer->driver_attrs, attrs, 0, NULL, NULL);
 
+  printer->config_version ++;
+
   _papplRWUnlock(printer);
 
   return (true);
@@ -296,6 +298,7 @@ papplPrinterSetDriverDefaults(
   }
 
   printer->config_time = time(NULL);
+  printer->config_version ++;
 
   _papplRWUnlock(printer);
 
@@ -347,6 +350,7 @@ papplPrinterSetReadyMedia(
   }
 
   printer->state_time = time(NULL);
+  printer->config_version ++;
 
   _papplRWUnlock(printer);
 
@@ -31,6 +31,9 @@ typedef struct _pappl_attr_s		// Input attribute structure
 // Local functions...
 //
 
+static bool		copy_cached_attrs(pappl_printer_t *printer, pappl_client_t *client, cups_array_t *ra, const char *format, const char *webscheme);
+static void		copy_config_attrs(pappl_printer_t *printer, pappl_client_t *client, ipp_t *ipp, cups_array_t *ra, const char *format, const char *webscheme);
+static void		copy_state_attrs(pappl_printer_t *printer, pappl_client_t *client, cups_array_t *ra, const char *webscheme);
 static pappl_job_t	*create_job(pappl_client_t *client);
 
 static void		ipp_cancel_current_job(pappl_client_t *client);
@@ -55,6 +58,11 @@ static bool		valid_job_attributes(pappl_client_t *client);
 //
 // '_papplPrinterCopyAttributesNoLock()' - Copy printer attributes to a response...
 //
+// The static, driver, and generated configuration attributes are cached for
+// each combination of requested attributes, document format, and client URI
+// host so that repeated requests only need to copy the cached attributes and
+// add the current state values.
+//
 
 void
 _papplPrinterCopyAttributesNoLock(
@@ -63,1202 +71,1370 @@ _papplPrinterCopyAttributesNoLock(
     cups_array_t    *ra,		// I - Requested attributes
     const char      *format)		// I - "document-format" value, if any
 {
-  cups_len_t	i,			// Looping var
-		num_values;		// Number of values
-  unsigned	bit;			// Current bit value
-  const char	*svalues[100];		// String values
-  int		ivalues[100];		// Integer values
-  pappl_pr_driver_data_t *data = &printer->driver_data;
-					// Driver data
   const char	*webscheme = (httpAddrIsLocalhost(httpGetAddress(client->http)) || !papplSystemGetTLSOnly(client->system)) ? "http" : "https";
 					// URL scheme for resources
 
 
-  _papplCopyAttributes(client->response, printer->attrs, ra, IPP_TAG_ZERO, IPP_TAG_CUPS_CONST);
-  _papplCopyAttributes(client->response, printer->driver_attrs, ra, IPP_TAG_ZERO, IPP_TAG_CUPS_CONST);
-  _papplPrinterCopyStateNoLock(printer, IPP_TAG_PRINTER, client->response, client, ra);
-
-  if (!ra || cupsArrayFind(ra, "copies-supported"))
-  {
-    // Filter copies-supported value based on the document format...
-    // (no copy support for streaming raster formats)
-    if (format && (!strcmp(format, "image/pwg-raster") || !strcmp(format, "image/urf")))
-      ippAddRange(client->response, IPP_TAG_PRINTER, "copies-supported", 1, 1);
-    else
-      ippAddRange(client->response, IPP_TAG_PRINTER, "copies-supported", 1, 999);
-  }
-
-  if (!ra || cupsArrayFind(ra, "identify-actions-default"))
+  if (!copy_cached_attrs(printer, client, ra, format, webscheme))
   {
-    for (num_values = 0, bit = PAPPL_IDENTIFY_ACTIONS_DISPLAY; bit <= PAPPL_IDENTIFY_ACTIONS_SPEAK; bit *= 2)
-    {
-      if (data->identify_default & bit)
-	svalues[num_values ++] = _papplIdentifyActionsString(bit);
-    }
+    _papplCopyAttributes(client->response, printer->attrs, ra, IPP_TAG_ZERO, IPP_TAG_CUPS_CONST);
+    _papplCopyAttributes(client->response, printer->driver_attrs, ra, IPP_TAG_ZERO, IPP_TAG_CUPS_CONST);
 
-    if (num_values > 0)
-      ippAddStrings(client->response, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "identify-actions-default", IPP_NUM_CAST num_values, NULL, svalues);
-    else
-      ippAddString(client->response, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "identify-actions-default", NULL, "none");
+    copy_config_attrs(printer, client, client->response, ra, format, webscheme);
   }
 
-  if (printer->max_preserved_jobs > 0)
-  {
-    static const char * const job_retain_until[] =
-    {					// job-retain-until-supported values
-      "day-time",
-      "evening",
-      "indefinite",
-      "night",
-      "no-hold",
-      "second-shift",
-      "third-shift",
-      "weekend"
-    };
-
-    if (!ra || cupsArrayFind(ra, "job-retain-until-default"))
-      ippAddString(client->response, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "job-retain-until-default", NULL, "none");
-
-    if (!ra || cupsArrayFind(ra, "job-retain-until-interval-default"))
-      ippAddOutOfBand(client->response, IPP_TAG_PRINTER, IPP_TAG_NOVALUE, "job-retain-until-interval-default");
+  copy_state_attrs(printer, client, ra, webscheme);
+}
 
-    if (!ra || cupsArrayFind(ra, "job-retain-until-interval-supported"))
-      ippAddRange(client->response, IPP_TAG_PRINTER, "job-retain-until-interval-supported", 0, 86400);
 
-    if (!ra || cupsArrayFind(ra, "job-retain-until-supported"))
-      ippAddStrings(client->response, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "job-retain-until-supported", (cups_len_t)(sizeof(job_retain_until) / sizeof(job_retain_until[0])), NULL, job_retain_until);
+//
+// '_papplPrinterCopyStateNoLock()' - Copy the printer-state-xxx attributes.
+//
 
-    if (!ra || cupsArrayFind(ra, "job-retain-until-time-supported"))
-      ippAddRange(client->response, IPP_TAG_PRINTER, "job-retain-until-time-supported", 0, 86400);
-  }
+void
+_papplPrinterCopyStateNoLock(
+    pappl_printer_t *printer,		// I - Printer
+    ipp_tag_t       group_tag,		// I - Group tag
+    ipp_t           *ipp,		// I - IPP message
+    pappl_client_t  *client,		// I - Client connection
+    cups_array_t    *ra)		// I - Requested attributes
+{
+  if (!ra || cupsArrayFind(ra, "printer-is-accepting-jobs"))
+    ippAddBoolean(ipp, group_tag, "printer-is-accepting-jobs", printer->is_accepting);
 
-  if (!ra || cupsArrayFind(ra, "job-spooling-supported"))
-    ippAddString(client->response, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "job-spooling-supported", NULL, (printer->max_active_jobs == 1 || (format && (!strcmp(format, "image/pwg-raster") || !strcmp(format, "image/urf")))) ? "stream" : "spool");
+  if (!ra || cupsArrayFind(ra, "printer-state"))
+    ippAddInteger(ipp, group_tag, IPP_TAG_ENUM, "printer-state", (int)printer->state);
 
-  if ((!ra || cupsArrayFind(ra, "label-mode-configured")) && data->mode_configured)
-    ippAddString(client->response, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "label-mode-configured", NULL, _papplLabelModeString(data->mode_configured));
+  if (!ra || cupsArrayFind(ra, "printer-state-message"))
+  {
+    static const char * const messages[] = { "Idle.", "Printing.", "Stopped." };
 
-  if ((!ra || cupsArrayFind(ra, "label-tear-offset-configured")) && data->tear_offset_supported[1] > 0)
-    ippAddInteger(client->response, IPP_TAG_PRINTER, IPP_TAG_INTEGER, "label-tear-offset-configured", data->tear_offset_configured);
+    ippAddString(ipp, group_tag, IPP_CONST_TAG(IPP_TAG_TEXT), "printer-state-message", NULL, messages[printer->state - IPP_PSTATE_IDLE]);
+  }
 
-  if (printer->num_supply > 0)
+  if (!ra || cupsArrayFind(ra, "printer-state-reasons"))
   {
-    pappl_supply_t *supply = printer->supply;
-					// Supply values...
+    ipp_attribute_t	*attr = NULL;	// printer-state-reasons
+    bool		wifi_not_configured = false;
+					// Need the 'wifi-not-configured' reason?
 
-    if (!ra || cupsArrayFind(ra, "marker-colors"))
+    if (client && client->system->wifi_status_cb && httpAddrIsLocalhost(httpGetAddress(client->http)))
     {
-      for (i = 0; i < (cups_len_t)printer->num_supply; i ++)
-        svalues[i] = _papplMarkerColorString(supply[i].color);
+      pappl_wifi_t	wifi;		// Wi-Fi status
 
-      ippAddStrings(client->response, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_NAME), "marker-colors", IPP_NUM_CAST printer->num_supply, NULL, svalues);
+      if ((client->system->wifi_status_cb)(client->system, client->system->wifi_cbdata, &wifi))
+      {
+        if (wifi.state == PAPPL_WIFI_STATE_NOT_CONFIGURED)
+          wifi_not_configured = true;
+      }
     }
 
-    if (!ra || cupsArrayFind(ra, "marker-high-levels"))
+    if (printer->state_reasons == PAPPL_PREASON_NONE)
     {
-      for (i = 0; i < (cups_len_t)printer->num_supply; i ++)
-        ivalues[i] = supply[i].is_consumed ? 100 : 90;
+      if (printer->is_stopped)
+	attr = ippAddString(ipp, group_tag, IPP_CONST_TAG(IPP_TAG_KEYWORD), "printer-state-reasons", NULL, "moving-to-paused");
+      else if (printer->state == IPP_PSTATE_STOPPED)
+	attr = ippAddString(ipp, group_tag, IPP_CONST_TAG(IPP_TAG_KEYWORD), "printer-state-reasons", NULL, "paused");
 
-      ippAddIntegers(client->response, IPP_TAG_PRINTER, IPP_TAG_INTEGER, "marker-high-levels", IPP_NUM_CAST printer->num_supply, ivalues);
-    }
+      if (printer->hold_new_jobs)
+      {
+        if (attr)
+          ippSetString(ipp, &attr, ippGetCount(attr), "hold-new-jobs");
+	else
+          attr = ippAddString(ipp, group_tag, IPP_CONST_TAG(IPP_TAG_KEYWORD), "printer-state-reasons", NULL, "hold-new-jobs");
+      }
 
-    if (!ra || cupsArrayFind(ra, "marker-levels"))
+      if (wifi_not_configured)
+      {
+        if (attr)
+          ippSetString(ipp, &attr, ippGetCount(attr), "wifi-not-configured-report");
+	else
+          attr = ippAddString(ipp, group_tag, IPP_CONST_TAG(IPP_TAG_KEYWORD), "printer-state-reasons", NULL, "wifi-not-configured-report");
+      }
+      else if (!attr)
+	ippAddString(ipp, group_tag, IPP_CONST_TAG(IPP_TAG_KEYWORD), "printer-state-reasons", NULL, "none");
+    }
+    else
     {
-      for (i = 0; i < (cups_len_t)printer->num_supply; i ++)
-        ivalues[i] = supply[i].level;
+      pappl_preason_t	bit;			// Reason bit
 
-      ippAddIntegers(client->response, IPP_TAG_PRINTER, IPP_TAG_INTEGER, "marker-levels", IPP_NUM_CAST printer->num_supply, ivalues);
-    }
+      for (bit = PAPPL_PREASON_OTHER; bit <= PAPPL_PREASON_TONER_LOW; bit *= 2)
+      {
+        if (printer->state_reasons & bit)
+	{
+	  if (attr)
+	    ippSetString(ipp, &attr, ippGetCount(attr), _papplPrinterReasonString(bit));
+	  else
+	    attr = ippAddString(ipp, group_tag, IPP_CONST_TAG(IPP_TAG_KEYWORD), "printer-state-reasons", NULL, _papplPrinterReasonString(bit));
+	}
+      }
 
-    if (!ra || cupsArrayFind(ra, "marker-low-levels"))
-    {
-      for (i = 0; i < (cups_len_t)printer->num_supply; i ++)
-        ivalues[i] = supply[i].is_consumed ? 10 : 0;
+      if (printer->is_stopped)
+	ippSetString(ipp, &attr, ippGetCount(attr), "moving-to-paused");
+      else if (printer->state == IPP_PSTATE_STOPPED)
+	ippSetString(ipp, &attr, ippGetCount(attr), "paused");
 
-      ippAddIntegers(client->response, IPP_TAG_PRINTER, IPP_TAG_INTEGER, "marker-low-levels", IPP_NUM_CAST printer->num_supply, ivalues);
+      if (printer->hold_new_jobs)
+	ippSetString(ipp, &attr, ippGetCount(attr), "hold-new-jobs");
+
+      if (wifi_not_configured)
+	ippSetString(ipp, &attr, ippGetCount(attr), "wifi-not-configured-report");
     }
+  }
+}
 
-    if (!ra || cupsArrayFind(ra, "marker-names"))
-    {
-      for (i = 0; i < (cups_len_t)printer->num_supply; i ++)
-        svalues[i] = supply[i].description;
 
-      ippAddStrings(client->response, IPP_TAG_PRINTER, IPP_TAG_NAME, "marker-names", IPP_NUM_CAST printer->num_supply, NULL, svalues);
-    }
+//
+// '_papplPrinterCopyXRINoLock()' - Copy the "printer-xri-supported" attribute.
+//
 
-    if (!ra || cupsArrayFind(ra, "marker-types"))
-    {
-      for (i = 0; i < (cups_len_t)printer->num_supply; i ++)
-        svalues[i] = _papplMarkerTypeString(supply[i].type);
+void
+_papplPrinterCopyXRINoLock(
+    pappl_printer_t *printer,		// I - Printer
+    ipp_t           *ipp,		// I - IPP message
+    pappl_client_t  *client)		// I - Client
+{
+  char	uri[1024];			// URI value
+  int	i,				// Looping var
+	num_values = 0;			// Number of values
+  ipp_t	*col,				// Current collection value
+	*values[2];			// Values for attribute
 
-      ippAddStrings(client->response, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "marker-types", IPP_NUM_CAST printer->num_supply, NULL, svalues);
-    }
-  }
 
-  if ((!ra || cupsArrayFind(ra, "media-col-default")) && data->media_default.size_name[0])
+  if (httpAddrIsLocalhost(httpGetAddress(client->http)) || !papplSystemGetTLSOnly(client->system))
   {
-    ipp_t *col = _papplMediaColExport(&printer->driver_data, &data->media_default, 0);
-					// Collection value
+    // Add ipp: URI...
+    httpAssembleURI(HTTP_URI_CODING_ALL, uri, sizeof(uri), "ipp", NULL, client->host_field, client->host_port, printer->resource);
+    col = ippNew();
 
-    ippAddCollection(client->response, IPP_TAG_PRINTER, "media-col-default", col);
-    ippDelete(col);
+    ippAddString(col, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "xri-authentication", NULL, "none");
+    ippAddString(col, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "xri-security", NULL, "none");
+    ippAddString(col, IPP_TAG_PRINTER, IPP_TAG_URI, "xri-uri", NULL, uri);
+
+    values[num_values ++] = col;
   }
 
-  if (!ra || cupsArrayFind(ra, "media-col-ready"))
+  if (!httpAddrIsLocalhost(httpGetAddress(client->http)) && !(client->system->options & PAPPL_SOPTIONS_NO_TLS))
   {
-    cups_len_t		j,		// Looping var
-			count;		// Number of values
-    ipp_t		*col;		// Collection value
-    ipp_attribute_t	*attr;		// media-col-ready attribute
-    pappl_media_col_t	media;		// Current media...
+    // Add ipps: URI...
+    httpAssembleURI(HTTP_URI_CODING_ALL, uri, sizeof(uri), "ipps", NULL, client->host_field, client->host_port, printer->resource);
+    col = ippNew();
 
-    for (i = 0, count = 0; i < (cups_len_t)printer->num_ready; i ++)
-    {
-      if (data->media_ready[i].size_name[0])
-        count ++;
-    }
+    ippAddString(col, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "xri-authentication", NULL, papplSystemGetAuthService(client->system) ? "basic" : "none");
+    ippAddString(col, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "xri-security", NULL, "tls");
+    ippAddString(col, IPP_TAG_PRINTER, IPP_TAG_URI, "xri-uri", NULL, uri);
 
-    if (data->borderless && (data->bottom_top != 0 || data->left_right != 0))
-      count *= 2;			// Need to report ready media for borderless, too...
+    values[num_values ++] = col;
+  }
 
-    if (count > 0)
-    {
-      attr = ippAddCollections(client->response, IPP_TAG_PRINTER, "media-col-ready", IPP_NUM_CAST count, NULL);
+  if (num_values > 0)
+    ippAddCollections(ipp, IPP_TAG_PRINTER, "printer-xri-supported", IPP_NUM_CAST num_values, (const ipp_t **)values);
 
-      for (i = 0, j = 0; i < (cups_len_t)printer->num_ready && j < count; i ++)
-      {
-	if (data->media_ready[i].size_name[0])
-	{
-          if (data->borderless && (data->bottom_top != 0 || data->left_right != 0))
-	  {
-	    // Report both bordered and borderless media-col values...
-	    media = data->media_ready[i];
+  for (i = 0; i < num_values; i ++)
+    ippDelete(values[i]);
+}
 
-	    media.bottom_margin = media.top_margin   = data->bottom_top;
-	    media.left_margin   = media.right_margin = data->left_right;
-	    col = _papplMediaColExport(&printer->driver_data, &media, 0);
-	    ippSetCollection(client->response, &attr, IPP_NUM_CAST j ++, col);
-	    ippDelete(col);
 
-	    media.bottom_margin = media.top_margin   = 0;
-	    media.left_margin   = media.right_margin = 0;
-	    col = _papplMediaColExport(&printer->driver_data, &media, 0);
-	    ippSetCollection(client->response, &attr, IPP_NUM_CAST j ++, col);
-	    ippDelete(col);
-	  }
-	  else
-	  {
-	    // Just report the single media-col value...
-	    col = _papplMediaColExport(&printer->driver_data, data->media_ready + i, 0);
-	    ippSetCollection(client->response, &attr, IPP_NUM_CAST j ++, col);
-	    ippDelete(col);
-	  }
-	}
-      }
-    }
-  }
+//
+// '_papplPrinterIsAuthorized()' - Authorize access to a printer.
+//
 
-  if ((!ra || cupsArrayFind(ra, "media-default")) && data->media_default.size_name[0])
-    ippAddString(client->response, IPP_TAG_PRINTER, IPP_TAG_KEYWORD, "media-default", NULL, data->media_default.size_name);
+bool					// O - `true` on success, `false` on failure
+_papplPrinterIsAuthorized(
+    pappl_client_t  *client)		// I - Client
+{
+  http_status_t code = _papplClientIsAuthorizedForGroup(client, true, client->printer->print_group, client->printer->print_gid);
 
-  if (!ra || cupsArrayFind(ra, "media-ready"))
+  if (code == HTTP_STATUS_CONTINUE && client->job && client->job->username && strcmp(client->username, client->job->username))
   {
-    cups_len_t		j,		// Looping vars
-			count;		// Number of values
-    ipp_attribute_t	*attr;		// media-col-ready attribute
-
-    for (i = 0, count = 0; i < (cups_len_t)printer->num_ready; i ++)
-    {
-      if (data->media_ready[i].size_name[0])
-        count ++;
-    }
-
-    if (count > 0)
-    {
-      attr = ippAddStrings(client->response, IPP_TAG_PRINTER, IPP_TAG_KEYWORD, "media-ready", IPP_NUM_CAST count, NULL, NULL);
-
-      for (i = 0, j = 0; i < (cups_len_t)printer->num_ready && j < count; i ++)
-      {
-	if (data->media_ready[i].size_name[0])
-	  ippSetString(client->response, &attr, IPP_NUM_CAST j ++, data->media_ready[i].size_name);
-      }
-    }
+    // Not the owner, try authorizing with admin group...
+    code = _papplClientIsAuthorizedForGroup(client, true, client->system->admin_group, client->system->admin_gid);
   }
 
-  if (!ra || cupsArrayFind(ra, "multiple-document-handling-default"))
-    ippAddString(client->response, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "multiple-document-handling-default", NULL, "separate-documents-collated-copies");
-
-  if (!ra || cupsArrayFind(ra, "orientation-requested-default"))
-    ippAddInteger(client->response, IPP_TAG_PRINTER, IPP_TAG_ENUM, "orientation-requested-default", (int)data->orient_default);
+  if (code == HTTP_STATUS_CONTINUE)
+    return (true);
 
-  if (!ra || cupsArrayFind(ra, "output-bin-default"))
-  {
-    if (data->num_bin > 0)
-      ippAddString(client->response, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "output-bin-default", NULL, data->bin[data->bin_default]);
-    else if (data->output_face_up)
-      ippAddString(client->response, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "output-bin-default", NULL, "face-up");
-    else
-      ippAddString(client->response, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "output-bin-default", NULL, "face-down");
-  }
+  papplClientRespond(client, code, NULL, NULL, 0, 0);
+  return (false);
+}
 
-  if ((!ra || cupsArrayFind(ra, "print-color-mode-default")) && data->color_default)
-    ippAddString(client->response, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "print-color-mode-default", NULL, _papplColorModeString(data->color_default));
 
-  if (!ra || cupsArrayFind(ra, "print-content-optimize-default"))
-  {
-    if (data->content_default)
-      ippAddString(client->response, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "print-content-optimize-default", NULL, _papplContentString(data->content_default));
-    else
-      ippAddString(client->response, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "print-content-optimize-default", NULL, "auto");
-  }
+//
+// '_papplPrinterProcessIPP()' - Process an IPP Printer request.
+//
 
-  if (!ra || cupsArrayFind(ra, "print-quality-default"))
+void
+_papplPrinterProcessIPP(
+    pappl_client_t *client)		// I - Client
+{
+  if (!client->printer)
   {
-    if (data->quality_default)
-      ippAddInteger(client->response, IPP_TAG_PRINTER, IPP_TAG_ENUM, "print-quality-default", (int)data->quality_default);
-    else
-      ippAddInteger(client->response, IPP_TAG_PRINTER, IPP_TAG_ENUM, "print-quality-default", IPP_QUALITY_NORMAL);
+    papplClientRespondIPP(client, IPP_STATUS_ERROR_NOT_FOUND, "No printer found.");
+    return;
   }
 
-  if (!ra || cupsArrayFind(ra, "print-scaling-default"))
+  switch (ippGetOperation(client->request))
   {
-    if (data->scaling_default)
-      ippAddString(client->response, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "print-scaling-default", NULL, _papplScalingString(data->scaling_default));
-    else
-      ippAddString(client->response, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "print-scaling-default", NULL, "auto");
-  }
+    case IPP_OP_PRINT_JOB :
+	ipp_print_job(client);
+	break;
 
-  if (!ra || cupsArrayFind(ra, "printer-config-change-date-time"))
-    ippAddDate(client->response, IPP_TAG_PRINTER, "printer-config-change-date-time", ippTimeToDate(printer->config_time));
+    case IPP_OP_VALIDATE_JOB :
+	ipp_validate_job(client);
+	break;
 
-  if (!ra || cupsArrayFind(ra, "printer-config-change-time"))
-  {
-    if (printer->config_time > printer->start_time)
-      ippAddInteger(client->response, IPP_TAG_PRINTER, IPP_TAG_INTEGER, "printer-config-change-time", (int)(printer->config_time - printer->start_time));
-    else
-      ippAddInteger(client->response, IPP_TAG_PRINTER, IPP_TAG_INTEGER, "printer-config-change-time", 1);
-  }
+    case IPP_OP_CREATE_JOB :
+	ipp_create_job(client);
+	break;
 
-  if (!ra || cupsArrayFind(ra, "printer-contact-col"))
-  {
-    ipp_t *col = _papplContactExport(&printer->contact);
-    ippAddCollection(client->response, IPP_TAG_PRINTER, "printer-contact-col", col);
-    ippDelete(col);
-  }
+    case IPP_OP_CANCEL_CURRENT_JOB :
+	ipp_cancel_current_job(client);
+	break;
 
-  if (!ra || cupsArrayFind(ra, "printer-current-time"))
-    ippAddDate(client->response, IPP_TAG_PRINTER, "printer-current-time", ippTimeToDate(time(NULL)));
+    case IPP_OP_CANCEL_JOBS :
+    case IPP_OP_CANCEL_MY_JOBS :
+	ipp_cancel_jobs(client);
+	break;
 
-  if ((!ra || cupsArrayFind(ra, "printer-darkness-configured")) && data->darkness_supported > 0)
-    ippAddInteger(client->response, IPP_TAG_PRINTER, IPP_TAG_INTEGER, "printer-darkness-configured", data->darkness_configured);
+    case IPP_OP_GET_JOBS :
+	ipp_get_jobs(client);
+	break;
 
-  if (!ra || cupsArrayFind(ra, "printer-dns-sd-name"))
-    ippAddString(client->response, IPP_TAG_PRINTER, IPP_TAG_NAME, "printer-dns-sd-name", NULL, printer->dns_sd_name ? printer->dns_sd_name : "");
+    case IPP_OP_GET_PRINTER_ATTRIBUTES :
+    case IPP_OP_GET_PRINTER_SUPPORTED_VALUES :
+    case IPP_OP_CUPS_GET_DEFAULT :
+	ipp_get_printer_attributes(client);
+	break;
 
-//  _papplRWLockRead(client->system);
-  _papplSystemExportVersions(client->system, client->response, IPP_TAG_PRINTER, ra);
-//  _papplRWUnlock(client->system);
+    case IPP_OP_SET_PRINTER_ATTRIBUTES :
+	ipp_set_printer_attributes(client);
+	break;
 
-  if (!ra || cupsArrayFind(ra, "printer-geo-location"))
-  {
-    if (printer->geo_location)
-      ippAddString(client->response, IPP_TAG_PRINTER, IPP_TAG_URI, "printer-geo-location", NULL, printer->geo_location);
-    else
-      ippAddOutOfBand(client->response, IPP_TAG_PRINTER, IPP_TAG_UNKNOWN, "printer-geo-location");
-  }
+    case IPP_OP_IDENTIFY_PRINTER :
+	ipp_identify_printer(client);
+	break;
 
-  if (!ra || cupsArrayFind(ra, "printer-icons"))
-  {
-    char	uris[3][1024];		// Buffers for URIs
-    const char	*values[3];		// Values for attribute
+    case IPP_OP_PAUSE_PRINTER :
+    case IPP_OP_PAUSE_PRINTER_AFTER_CURRENT_JOB :
+	ipp_pause_printer(client);
+	break;
 
-    httpAssembleURIf(HTTP_URI_CODING_ALL, uris[0], sizeof(uris[0]), webscheme, NULL, client->host_field, client->host_port, "%s/icon-sm.png", printer->uriname);
-    httpAssembleURIf(HTTP_URI_CODING_ALL, uris[1], sizeof(uris[1]), webscheme, NULL, client->host_field, client->host_port, "%s/icon-md.png", printer->uriname);
-    httpAssembleURIf(HTTP_URI_CODING_ALL, uris[2], sizeof(uris[2]), webscheme, NULL, client->host_field, client->host_port, "%s/icon-lg.png", printer->uriname);
+    case IPP_OP_RESUME_PRINTER :
+	ipp_resume_printer(client);
+	break;
 
-    values[0] = uris[0];
-    values[1] = uris[1];
-    values[2] = uris[2];
+    case IPP_OP_ENABLE_PRINTER :
+        ipp_enable_printer(client);
+        break;
 
-    ippAddStrings(client->response, IPP_TAG_PRINTER, IPP_TAG_URI, "printer-icons", 3, NULL, values);
-  }
+    case IPP_OP_DISABLE_PRINTER :
+        ipp_disable_printer(client);
+        break;
 
-  if (!ra || cupsArrayFind(ra, "printer-impressions-completed"))
-    ippAddInteger(client->response, IPP_TAG_PRINTER, IPP_TAG_INTEGER, "printer-impressions-completed", printer->impcompleted);
+    case IPP_OP_HOLD_NEW_JOBS :
+        ipp_hold_new_jobs(client);
+        break;
 
-  if (!ra || cupsArrayFind(ra, "printer-input-tray"))
-  {
-    ipp_attribute_t	*attr = NULL;	// "printer-input-tray" attribute
-    char		value[256];	// Value for current tray
-    pappl_media_col_t	*media;		// Media in the tray
+    case IPP_OP_RELEASE_HELD_NEW_JOBS :
+        ipp_release_held_new_jobs(client);
+        break;
 
-    for (i = 0, media = data->media_ready; i < (cups_len_t)data->num_source; i ++, media ++)
-    {
-      const char	*type;		// Tray type
+    case IPP_OP_CREATE_PRINTER_SUBSCRIPTIONS :
+    case IPP_OP_CREATE_JOB_SUBSCRIPTIONS :
+        _papplSubscriptionIPPCreate(client);
+        break;
 
-      if (!strcmp(data->source[i], "manual"))
-        type = "sheetFeedManual";
-      else if (!strcmp(data->source[i], "by-pass-tray"))
-        type = "sheetFeedAutoNonRemovableTray";
-      else
-        type = "sheetFeedAutoRemovableTray";
+    case IPP_OP_GET_SUBSCRIPTION_ATTRIBUTES :
+        _papplSubscriptionIPPGetAttributes(client);
+        break;
 
-      snprintf(value, sizeof(value), "type=%s;mediafeed=%d;mediaxfeed=%d;maxcapacity=%d;level=-2;status=0;name=%s;", type, media->size_length, media->size_width, !strcmp(media->source, "manual") ? 1 : -2, media->source);
+    case IPP_OP_GET_SUBSCRIPTIONS :
+        _papplSubscriptionIPPList(client);
+        break;
 
-      if (attr)
-        ippSetOctetString(client->response, &attr, ippGetCount(attr), value, IPP_NUM_CAST strlen(value));
-      else
-        attr = ippAddOctetString(client->response, IPP_TAG_PRINTER, "printer-input-tray", value, IPP_NUM_CAST strlen(value));
-    }
+    case IPP_OP_RENEW_SUBSCRIPTION :
+        _papplSubscriptionIPPRenew(client);
+        break;
 
-    // The "auto" tray is a dummy entry...
-    papplCopyString(value, "type=other;mediafeed=0;mediaxfeed=0;maxcapacity=-2;level=-2;status=0;name=auto;", sizeof(value));
-    ippSetOctetString(client->response, &attr, ippGetCount(attr), value, IPP_NUM_CAST strlen(value));
-  }
+    case IPP_OP_CANCEL_SUBSCRIPTION :
+        _papplSubscriptionIPPCancel(client);
+        break;
 
-  if (!ra || cupsArrayFind(ra, "printer-location"))
-    ippAddString(client->response, IPP_TAG_PRINTER, IPP_TAG_TEXT, "printer-location", NULL, printer->location ? printer->location : "");
+    case IPP_OP_GET_NOTIFICATIONS :
+        _papplSubscriptionIPPGetNotifications(client);
+        break;
 
-  if (!ra || cupsArrayFind(ra, "printer-more-info"))
-  {
-    char	uri[1024];		// URI value
+    default :
+        if (client->system->op_cb && (client->system->op_cb)(client, client->system->op_cbdata))
+          break;
 
-    httpAssembleURIf(HTTP_URI_CODING_ALL, uri, sizeof(uri), webscheme, NULL, client->host_field, client->host_port, "%s/", printer->uriname);
-    ippAddString(client->response, IPP_TAG_PRINTER, IPP_TAG_URI, "printer-more-info", NULL, uri);
+	papplClientRespondIPP(client, IPP_STATUS_ERROR_OPERATION_NOT_SUPPORTED, "Operation not supported.");
+	break;
   }
+}
 
-  if (!ra || cupsArrayFind(ra, "printer-organization"))
-    ippAddString(client->response, IPP_TAG_PRINTER, IPP_TAG_TEXT, "printer-organization", NULL, printer->organization ? printer->organization : "");
-
-  if (!ra || cupsArrayFind(ra, "printer-organizational-unit"))
-    ippAddString(client->response, IPP_TAG_PRINTER, IPP_TAG_TEXT, "printer-organizational-unit", NULL, printer->org_unit ? printer->org_unit : "");
-
-  if (!ra || cupsArrayFind(ra, "printer-resolution-default"))
-    ippAddResolution(client->response, IPP_TAG_PRINTER, "printer-resolution-default", IPP_RES_PER_INCH, data->x_default, data->y_default);
-
-  if (!ra || cupsArrayFind(ra, "printer-speed-default"))
-    ippAddInteger(client->response, IPP_TAG_PRINTER, IPP_TAG_INTEGER, "printer-speed-default", data->speed_default);
-
-  if (!ra || cupsArrayFind(ra, "printer-state-change-date-time"))
-    ippAddDate(client->response, IPP_TAG_PRINTER, "printer-state-change-date-time", ippTimeToDate(printer->state_time));
 
-  if (!ra || cupsArrayFind(ra, "printer-state-change-time"))
-    ippAddInteger(client->response, IPP_TAG_PRINTER, IPP_TAG_INTEGER, "printer-state-change-time", (int)(printer->state_time - printer->start_time));
+//
+// '_papplPrinterSetAttributes()' - Set printer attributes.
+//
 
-  if (!ra || cupsArrayFind(ra, "printer-strings-languages-supported"))
+bool					// O - `true` if OK, `false` otherwise
+_papplPrinterSetAttributes(
+    pappl_client_t  *client,		// I - Client
+    pappl_printer_t *printer)		// I - Printer
+{
+  int			create_printer;	// Create-Printer request?
+  ipp_attribute_t	*rattr;		// Current request attribute
+  ipp_tag_t		value_tag;	// Value tag
+  cups_len_t		count;		// Number of values
+  const char		*name;		// Attribute name
+  char			defname[128],	// xxx-default name
+			value[1024];	// xxx-default value
+  cups_len_t		i, j;		// Looping vars
+  pwg_media_t		*pwg;		// PWG media size data
+  pappl_pr_driver_data_t driver_data;	// Printer driver data
+  bool			do_defaults = false,
+					// Update defaults?
+			do_ready = false;
+					// Update ready media?
+  cups_len_t		num_vendor = 0;	// Number of vendor defaults
+  cups_option_t		*vendor = NULL;	// Vendor defaults
+  pappl_contact_t	contact;	// printer-contact value
+  bool			do_contact = false;
+					// Update contact?
+  const char		*geo_location = NULL,
+					// printer-geo-location value
+			*location = NULL,
+					// printer-location value
+			*organization = NULL,
+					// printer-organization value
+			*org_unit = NULL;
+					// printer-organizational-unit value
+  char			wifi_ssid[256] = "",
+					// printer-wifi-ssid value
+			wifi_password[256] = "";
+					// printer-wifi-password value
+  bool			do_wifi = false;// Join a Wi-Fi network?
+  static _pappl_attr_t	pattrs[] =	// Settable printer attributes
   {
-    _pappl_resource_t	*r;		// Current resource
-    cups_len_t		rcount;		// Number of resources
-
-//    _papplRWLockRead(printer->system);
-
-    // Cannot use cupsArrayGetFirst/Last since other threads might be iterating
-    // this array...
-    for (i = 0, num_values = 0, rcount = cupsArrayGetCount(printer->system->resources); i < rcount && num_values < (cups_len_t)(sizeof(svalues) / sizeof(svalues[0])); i ++)
-    {
-      r = (_pappl_resource_t *)cupsArrayGetElement(printer->system->resources, (size_t)i);
+    { "label-mode-configured",		IPP_TAG_KEYWORD,	1 },
+    { "label-tear-off-configured",	IPP_TAG_INTEGER,	1 },
+    { "media-col-default",		IPP_TAG_BEGIN_COLLECTION, 1 },
+    { "media-col-ready",		IPP_TAG_BEGIN_COLLECTION, PAPPL_MAX_SOURCE },
+    { "media-default",			IPP_TAG_KEYWORD,	1 },
+    { "media-ready",			IPP_TAG_KEYWORD,	PAPPL_MAX_SOURCE },
+    { "orientation-requested-default",	IPP_TAG_ENUM,		1 },
+    { "print-color-mode-default",	IPP_TAG_KEYWORD,	1 },
+    { "print-content-optimize-default",	IPP_TAG_KEYWORD,	1 },
+    { "print-darkness-default",		IPP_TAG_INTEGER,	1 },
+    { "print-quality-default",		IPP_TAG_ENUM,		1 },
+    { "print-speed-default",		IPP_TAG_INTEGER,	1 },
+    { "printer-contact-col",		IPP_TAG_BEGIN_COLLECTION, 1 },
+    { "printer-darkness-configured",	IPP_TAG_INTEGER,	1 },
+    { "printer-geo-location",		IPP_TAG_URI,		1 },
+    { "printer-location",		IPP_TAG_TEXT,		1 },
+    { "printer-organization",		IPP_TAG_TEXT,		1 },
+    { "printer-organizational-unit",	IPP_TAG_TEXT,		1 },
+    { "printer-resolution-default",	IPP_TAG_RESOLUTION,	1 },
+    { "printer-wifi-password",		IPP_TAG_STRING,		1 },
+    { "printer-wifi-ssid",		IPP_TAG_NAME,		1 }
+  };
 
-      if (r->language)
-        svalues[num_values ++] = r->language;
-    }
-//    _papplRWUnlock(printer->system);
 
-    if (num_values > 0)
-      ippAddStrings(printer->attrs, IPP_TAG_PRINTER, IPP_TAG_LANGUAGE, "printer-strings-languages-supported", IPP_NUM_CAST num_values, NULL, svalues);
-  }
+  // Preflight request attributes...
+  create_printer = ippGetOperation(client->request) == IPP_OP_CREATE_PRINTER;
 
-  if (!ra || cupsArrayFind(ra, "printer-strings-uri"))
+  papplPrinterGetDriverData(printer, &driver_data);
+
+  for (rattr = ippGetFirstAttribute(client->request); rattr; rattr = ippGetNextAttribute(client->request))
   {
-    const char	*lang = ippGetString(ippFindAttribute(client->request, "attributes-natural-language", IPP_TAG_LANGUAGE), 0, NULL);
-					// Language
-    char	baselang[3],		// Base language
-		uri[1024];		// Strings file URI
-    _pappl_resource_t	*r;		// Current resource
-    cups_len_t	rcount;			// Number of resources
+    papplLogClient(client, PAPPL_LOGLEVEL_DEBUG, "%s %s %s%s ...", ippTagString(ippGetGroupTag(rattr)), ippGetName(rattr), ippGetCount(rattr) > 1 ? "1setOf " : "", ippTagString(ippGetValueTag(rattr)));
 
-    papplCopyString(baselang, lang, sizeof(baselang));
+    if (ippGetGroupTag(rattr) == IPP_TAG_OPERATION || (name = ippGetName(rattr)) == NULL)
+    {
+      continue;
+    }
+    else if (ippGetGroupTag(rattr) != IPP_TAG_PRINTER)
+    {
+      papplClientRespondIPPUnsupported(client, rattr);
+      continue;
+    }
 
-//    _papplRWLockRead(printer->system);
+    if (create_printer && (!strcmp(name, "printer-device-id") || !strcmp(name, "printer-name") || !strcmp(name, "smi55357-device-uri") || !strcmp(name, "smi55357-driver")))
+      continue;
 
-    // Cannot use cupsArrayGetFirst/Last since other threads might be iterating
-    // this array...
-    for (i = 0, rcount = cupsArrayGetCount(printer->system->resources); i < rcount; i ++)
+    if ((create_printer || !httpAddrIsLocalhost(httpGetAddress(client->http)) || !client->system->wifi_join_cb) && (!strcmp(name, "printer-wifi-password") || !strcmp(name, "printer-wifi-ssid")))
     {
-      r = (_pappl_resource_t *)cupsArrayGetElement(printer->system->resources, i);
-
-      if (r->language && (!strcmp(r->language, lang) || !strcmp(r->language, baselang)))
-      {
-        httpAssembleURI(HTTP_URI_CODING_ALL, uri, sizeof(uri), webscheme, NULL, client->host_field, client->host_port, r->path);
-        ippAddString(client->response, IPP_TAG_PRINTER, IPP_TAG_URI, "printer-strings-uri", NULL, uri);
-        break;
-      }
+      // Wi-Fi configuration can only be done over localhost...
+      papplClientRespondIPPUnsupported(client, rattr);
+      continue;
     }
 
-//    _papplRWUnlock(printer->system);
-  }
-
-  if (printer->num_supply > 0)
-  {
-    pappl_supply_t	 *supply = printer->supply;
-					// Supply values...
+    // Validate syntax of provided attributes...
+    value_tag = ippGetValueTag(rattr);
+    count     = ippGetCount(rattr);
 
-    if (!ra || cupsArrayFind(ra, "printer-supply"))
+    for (i = 0; i < (cups_len_t)(sizeof(pattrs) / sizeof(pattrs[0])); i ++)
     {
-      char		value[256];	// "printer-supply" value
-      ipp_attribute_t	*attr = NULL;	// "printer-supply" attribute
+      if (!strcmp(name, pattrs[i].name) && value_tag == pattrs[i].value_tag && count <= pattrs[i].max_count)
+        break;
+    }
 
-      for (i = 0; i < (cups_len_t)printer->num_supply; i ++)
+    if (i >= (int)(sizeof(pattrs) / sizeof(pattrs[0])))
+    {
+      for (j = 0; j < (cups_len_t)printer->driver_data.num_vendor; j ++)
       {
-	snprintf(value, sizeof(value), "index=%u;type=%s;maxcapacity=100;level=%d;colorantname=%s;", (unsigned)i, _papplSupplyTypeString(supply[i].type), supply[i].level, _papplSupplyColorString(supply[i].color));
-
-	if (attr)
-	  ippSetOctetString(client->response, &attr, ippGetCount(attr), value, IPP_NUM_CAST strlen(value));
-	else
-	  attr = ippAddOctetString(client->response, IPP_TAG_PRINTER, "printer-supply", value, IPP_NUM_CAST strlen(value));
+        snprintf(defname, sizeof(defname), "%s-default", printer->driver_data.vendor[j]);
+        if (!strcmp(name, defname))
+        {
+          ippAttributeString(rattr, value, sizeof(value));
+          num_vendor = cupsAddOption(printer->driver_data.vendor[j], value, num_vendor, &vendor);
+          do_defaults = true;
+          break;
+	}
       }
+
+      if (j >= (cups_len_t)printer->driver_data.num_vendor)
+        papplClientRespondIPPUnsupported(client, rattr);
     }
 
-    if (!ra || cupsArrayFind(ra, "printer-supply-description"))
+    // Then copy the xxx-default values to the
+    if (!strcmp(name, "identify-actions-default"))
     {
-      for (i = 0; i < (cups_len_t)printer->num_supply; i ++)
-        svalues[i] = supply[i].description;
+      driver_data.identify_default = PAPPL_IDENTIFY_ACTIONS_NONE;
 
-      ippAddStrings(client->response, IPP_TAG_PRINTER, IPP_TAG_TEXT, "printer-supply-description", IPP_NUM_CAST printer->num_supply, NULL, svalues);
+      for (i = 0, count = ippGetCount(rattr); i < count; i ++)
+        driver_data.identify_default |= _papplIdentifyActionsValue(ippGetString(rattr, i, NULL));
+      do_defaults = true;
     }
-  }
-
-  if (!ra || cupsArrayFind(ra, "printer-supply-info-uri"))
-  {
-    char	uri[1024];		// URI value
-
-    httpAssembleURIf(HTTP_URI_CODING_ALL, uri, sizeof(uri), webscheme, NULL, client->host_field, client->host_port, "%s/supplies", printer->uriname);
-    ippAddString(client->response, IPP_TAG_PRINTER, IPP_TAG_URI, "printer-supply-info-uri", NULL, uri);
-  }
-
-  if (!ra || cupsArrayFind(ra, "printer-up-time"))
-    ippAddInteger(client->response, IPP_TAG_PRINTER, IPP_TAG_INTEGER, "printer-up-time", (int)(time(NULL) - printer->start_time));
-
-  if (!ra || cupsArrayFind(ra, "printer-uri-supported"))
-  {
-    char	uris[2][1024];		// Buffers for URIs
-    const char	*values[2];		// Values for attribute
-
-    num_values = 0;
-
-    if (httpAddrIsLocalhost(httpGetAddress(client->http)) || !papplSystemGetTLSOnly(client->system))
+    else if (!strcmp(name, "label-mode-configured"))
     {
-      httpAssembleURI(HTTP_URI_CODING_ALL, uris[num_values], sizeof(uris[0]), "ipp", NULL, client->host_field, client->host_port, printer->resource);
-      values[num_values] = uris[num_values];
-      num_values ++;
+      driver_data.mode_configured = _papplLabelModeValue(ippGetString(rattr, 0, NULL));
+      do_defaults = true;
     }
-
-    if (!httpAddrIsLocalhost(httpGetAddress(client->http)) && !(client->system->options & PAPPL_SOPTIONS_NO_TLS))
+    else if (!strcmp(name, "label-tear-offset-configured"))
     {
-      httpAssembleURI(HTTP_URI_CODING_ALL, uris[num_values], sizeof(uris[0]), "ipps", NULL, client->host_field, client->host_port, printer->resource);
-      values[num_values] = uris[num_values];
-      num_values ++;
+      driver_data.tear_offset_configured = ippGetInteger(rattr, 0);
+      do_defaults = true;
+    }
+    else if (!strcmp(name, "media-col-default"))
+    {
+      _papplMediaColImport(ippGetCollection(rattr, 0), &driver_data.media_default);
+      do_defaults = true;
     }
+    else if (!strcmp(name, "media-col-ready"))
+    {
+      count = ippGetCount(rattr);
 
-    if (num_values > 0)
-      ippAddStrings(client->response, IPP_TAG_PRINTER, IPP_TAG_URI, "printer-uri-supported", IPP_NUM_CAST num_values, NULL, values);
-  }
+      for (i = 0; i < count; i ++)
+        _papplMediaColImport(ippGetCollection(rattr, i), driver_data.media_ready + i);
 
-  if (client->system->wifi_status_cb && httpAddrIsLocalhost(httpGetAddress(client->http)) && (!ra || cupsArrayFind(ra, "printer-wifi-ssid") || cupsArrayFind(ra, "printer-wifi-state")))
-  {
-    // Get Wi-Fi status...
-    pappl_wifi_t	wifi;		// Wi-Fi status
+      for (; i < PAPPL_MAX_SOURCE; i ++)
+        memset(driver_data.media_ready + i, 0, sizeof(pappl_media_col_t));
 
-    if ((client->system->wifi_status_cb)(client->system, client->system->wifi_cbdata, &wifi))
+      do_ready = true;
+    }
+    else if (!strcmp(name, "media-default"))
     {
-      if (!ra || cupsArrayFind(ra, "printer-wifi-ssid"))
-        ippAddString(client->response, IPP_TAG_PRINTER, IPP_TAG_NAME, "printer-wifi-ssid", NULL, wifi.ssid);
+      if ((pwg = pwgMediaForPWG(ippGetString(rattr, 0, NULL))) != NULL)
+      {
+        papplCopyString(driver_data.media_default.size_name, pwg->pwg, sizeof(driver_data.media_default.size_name));
+        driver_data.media_default.size_width  = pwg->width;
+        driver_data.media_default.size_length = pwg->length;
+      }
 
-      if (!ra || cupsArrayFind(ra, "printer-wifi-state"))
-        ippAddInteger(client->response, IPP_TAG_PRINTER, IPP_TAG_ENUM, "printer-wifi-state", (int)wifi.state);
+      do_defaults = true;
     }
-  }
-
-  if (!ra || cupsArrayFind(ra, "printer-xri-supported"))
-    _papplPrinterCopyXRINoLock(printer, client->response, client);
+    else if (!strcmp(name, "media-ready"))
+    {
+      count = ippGetCount(rattr);
 
-  if (!ra || cupsArrayFind(ra, "queued-job-count"))
-    ippAddInteger(client->response, IPP_TAG_PRINTER, IPP_TAG_INTEGER, "queued-job-count", (int)cupsArrayGetCount(printer->active_jobs));
+      for (i = 0; i < count; i ++)
+      {
+        if ((pwg = pwgMediaForPWG(ippGetString(rattr, i, NULL))) != NULL)
+        {
+          papplCopyString(driver_data.media_ready[i].size_name, pwg->pwg, sizeof(driver_data.media_ready[i].size_name));
+	  driver_data.media_ready[i].size_width  = pwg->width;
+	  driver_data.media_ready[i].size_length = pwg->length;
+	}
+      }
 
-  if (!ra || cupsArrayFind(ra, "sides-default"))
-  {
-    if (data->sides_default)
-      ippAddString(client->response, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "sides-default", NULL, _papplSidesString(data->sides_default));
-    else
-      ippAddString(client->response, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "sides-default", NULL, "one-sided");
-  }
+      for (; i < PAPPL_MAX_SOURCE; i ++)
+      {
+        driver_data.media_ready[i].size_name[0] = '\0';
+        driver_data.media_ready[i].size_width   = 0;
+        driver_data.media_ready[i].size_length  = 0;
+      }
 
-  if (!ra || cupsArrayFind(ra, "uri-authentication-supported"))
-  {
-    // For each supported printer-uri value, report whether authentication is
-    // supported.  Since we only support authentication over a secure (TLS)
-    // channel, the value is always 'none' for the "ipp" URI and either 'none'
-    // or 'basic' for the "ipps" URI...
-    if (httpAddrIsLocalhost(httpGetAddress(client->http)) || (client->system->options & PAPPL_SOPTIONS_NO_TLS))
+      do_ready = true;
+    }
+    else if (!strcmp(name, "orientation-requested-default"))
     {
-      ippAddString(client->response, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "uri-authentication-supported", NULL, "none");
+      driver_data.orient_default = (ipp_orient_t)ippGetInteger(rattr, 0);
+      do_defaults = true;
     }
-    else if (papplSystemGetTLSOnly(client->system))
+    else if (!strcmp(name, "print-color-mode-default"))
     {
-      if (papplSystemGetAuthService(client->system))
-        ippAddString(client->response, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "uri-authentication-supported", NULL, "basic");
-      else
-        ippAddString(client->response, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "uri-authentication-supported", NULL, "none");
+      driver_data.color_default = _papplColorModeValue(ippGetString(rattr, 0, NULL));
+      do_defaults = true;
     }
-    else if (papplSystemGetAuthService(client->system))
+    else if (!strcmp(name, "print-content-optimize-default"))
     {
-      static const char * const uri_authentication_basic[] =
-      {					// uri-authentication-supported values
-	"none",
-	"basic"
-      };
-
-      ippAddStrings(client->response, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "uri-authentication-supported", 2, NULL, uri_authentication_basic);
+      driver_data.content_default = _papplContentValue(ippGetString(rattr, 0, NULL));
+      do_defaults = true;
     }
-    else
+    else if (!strcmp(name, "print-darkness-default"))
     {
-      static const char * const uri_authentication_none[] =
-      {					// uri-authentication-supported values
-	"none",
-	"none"
-      };
-
-      ippAddStrings(client->response, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "uri-authentication-supported", 2, NULL, uri_authentication_none);
+      driver_data.darkness_default = ippGetInteger(rattr, 0);
+      do_defaults = true;
     }
-  }
-}
-
-
-//
-// '_papplPrinterCopyStateNoLock()' - Copy the printer-state-xxx attributes.
-//
+    else if (!strcmp(name, "print-quality-default"))
+    {
+      driver_data.quality_default = (ipp_quality_t)ippGetInteger(rattr, 0);
+      do_defaults = true;
+    }
+    else if (!strcmp(name, "print-scaling-default"))
+    {
+      driver_data.scaling_default = _papplScalingValue(ippGetString(rattr, 0, NULL));
+      do_defaults = true;
+    }
+    else if (!strcmp(name, "print-speed-default"))
+    {
+      driver_data.speed_default = ippGetInteger(rattr, 0);
+      do_defaults = true;
+    }
+    else if (!strcmp(name, "printer-contact-col"))
+    {
+      _papplContactImport(ippGetCollection(rattr, 0), &contact);
+      do_contact = true;
+    }
+    else if (!strcmp(name, "printer-darkness-configured"))
+    {
+      driver_data.darkness_configured = ippGetInteger(rattr, 0);
+      do_defaults = true;
+    }
+    else if (!strcmp(name, "printer-geo-location"))
+    {
+      float geo_lat, geo_lon;		// Latitude and longitude
 
-void
-_papplPrinterCopyStateNoLock(
-    pappl_printer_t *printer,		// I - Printer
-    ipp_tag_t       group_tag,		// I - Group tag
-    ipp_t           *ipp,		// I - IPP message
-    pappl_client_t  *client,		// I - Client connection
-    cups_array_t    *ra)		// I - Requested attributes
-{
-  if (!ra || cupsArrayFind(ra, "printer-is-accepting-jobs"))
-    ippAddBoolean(ipp, group_tag, "printer-is-accepting-jobs", printer->is_accepting);
+      geo_location = ippGetString(rattr, 0, NULL);
+      if (sscanf(geo_location, "geo:%f,%f", &geo_lat, &geo_lon) != 2 || geo_lat < -90.0 || geo_lat > 90.0 || geo_lon < -180.0 || geo_lon > 180.0)
+        papplClientRespondIPPUnsupported(client, rattr);
+    }
+    else if (!strcmp(name, "printer-location"))
+    {
+      location = ippGetString(rattr, 0, NULL);
+    }
+    else if (!strcmp(name, "printer-organization"))
+    {
+      organization = ippGetString(rattr, 0, NULL);
+    }
+    else if (!strcmp(name, "printer-organization-unit"))
+    {
+      org_unit = ippGetString(rattr, 0, NULL);
+    }
+    else if (!strcmp(name, "printer-resolution-default"))
+    {
+      ipp_res_t units;			// Resolution units
 
-  if (!ra || cupsArrayFind(ra, "printer-state"))
-    ippAddInteger(ipp, group_tag, IPP_TAG_ENUM, "printer-state", (int)printer->state);
+      driver_data.x_default = ippGetResolution(rattr, 0, &driver_data.y_default, &units);
+      do_defaults = true;
+    }
+    else if (!strcmp(name, "printer-wifi-password"))
+    {
+      void		*data;		// Password
+      cups_len_t	datalen;	// Length of password
 
-  if (!ra || cupsArrayFind(ra, "printer-state-message"))
+      data = ippGetOctetString(rattr, 0, &datalen);
+      if (datalen > ((int)sizeof(wifi_password) - 1))
+      {
+	papplClientRespondIPPUnsupported(client, rattr);
+	continue;
+      }
+
+      memcpy(wifi_password, data, datalen);
+      wifi_password[datalen] = '\0';
+
+      do_wifi = true;
+    }
+    else if (!strcmp(name, "printer-wifi-ssid"))
+    {
+      papplCopyString(wifi_ssid, ippGetString(rattr, 0, NULL), sizeof(wifi_ssid));
+      do_wifi = true;
+    }
+  }
+
+  if (ippGetStatusCode(client->response) != IPP_STATUS_OK)
   {
-    static const char * const messages[] = { "Idle.", "Printing.", "Stopped." };
+    cupsFreeOptions(num_vendor, vendor);
+    return (false);
+  }
 
-    ippAddString(ipp, group_tag, IPP_CONST_TAG(IPP_TAG_TEXT), "printer-state-message", NULL, messages[printer->state - IPP_PSTATE_IDLE]);
+  // Now apply changes...
+  if (do_defaults && !papplPrinterSetDriverDefaults(printer, &driver_data, (int)num_vendor, vendor))
+  {
+    papplClientRespondIPP(client, IPP_STATUS_ERROR_ATTRIBUTES_OR_VALUES, "One or more attribute values were not supported.");
+    cupsFreeOptions(num_vendor, vendor);
+    return (false);
   }
 
-  if (!ra || cupsArrayFind(ra, "printer-state-reasons"))
+  cupsFreeOptions(num_vendor, vendor);
+
+  if (do_ready && !papplPrinterSetReadyMedia(printer, driver_data.num_source, driver_data.media_ready))
   {
-    ipp_attribute_t	*attr = NULL;	// printer-state-reasons
-    bool		wifi_not_configured = false;
-					// Need the 'wifi-not-configured' reason?
+    papplClientRespondIPP(client, IPP_STATUS_ERROR_ATTRIBUTES_OR_VALUES, "One or more attribute values were not supported.");
+    return (false);
+  }
 
-    if (client && client->system->wifi_status_cb && httpAddrIsLocalhost(httpGetAddress(client->http)))
+  if (do_wifi)
+  {
+    if (!(printer->system->wifi_join_cb)(printer->system, printer->system->wifi_cbdata, wifi_ssid, wifi_password))
     {
-      pappl_wifi_t	wifi;		// Wi-Fi status
-
-      if ((client->system->wifi_status_cb)(client->system, client->system->wifi_cbdata, &wifi))
-      {
-        if (wifi.state == PAPPL_WIFI_STATE_NOT_CONFIGURED)
-          wifi_not_configured = true;
-      }
+      papplClientRespondIPP(client, IPP_STATUS_ERROR_ATTRIBUTES_OR_VALUES, "Unable to join Wi-Fi network '%s'.", wifi_ssid);
+      return (false);
     }
+  }
 
-    if (printer->state_reasons == PAPPL_PREASON_NONE)
-    {
-      if (printer->is_stopped)
-	attr = ippAddString(ipp, group_tag, IPP_CONST_TAG(IPP_TAG_KEYWORD), "printer-state-reasons", NULL, "moving-to-paused");
-      else if (printer->state == IPP_PSTATE_STOPPED)
-	attr = ippAddString(ipp, group_tag, IPP_CONST_TAG(IPP_TAG_KEYWORD), "printer-state-reasons", NULL, "paused");
+  if (do_contact)
+    papplPrinterSetContact(printer, &contact);
 
-      if (printer->hold_new_jobs)
-      {
-        if (attr)
-          ippSetString(ipp, &attr, ippGetCount(attr), "hold-new-jobs");
-	else
-          attr = ippAddString(ipp, group_tag, IPP_CONST_TAG(IPP_TAG_KEYWORD), "printer-state-reasons", NULL, "hold-new-jobs");
-      }
+  if (geo_location)
+    papplPrinterSetGeoLocation(printer, geo_location);
 
-      if (wifi_not_configured)
-      {
-        if (attr)
-          ippSetString(ipp, &attr, ippGetCount(attr), "wifi-not-configured-report");
-	else
-          attr = ippAddString(ipp, group_tag, IPP_CONST_TAG(IPP_TAG_KEYWORD), "printer-state-reasons", NULL, "wifi-not-configured-report");
-      }
-      else if (!attr)
-	ippAddString(ipp, group_tag, IPP_CONST_TAG(IPP_TAG_KEYWORD), "printer-state-reasons", NULL, "none");
-    }
-    else
-    {
-      pappl_preason_t	bit;			// Reason bit
+  if (location)
+    papplPrinterSetGeoLocation(printer, location);
 
-      for (bit = PAPPL_PREASON_OTHER; bit <= PAPPL_PREASON_TONER_LOW; bit *= 2)
-      {
-        if (printer->state_reasons & bit)
-	{
-	  if (attr)
-	    ippSetString(ipp, &attr, ippGetCount(attr), _papplPrinterReasonString(bit));
-	  else
-	    attr = ippAddString(ipp, group_tag, IPP_CONST_TAG(IPP_TAG_KEYWORD), "printer-state-reasons", NULL, _papplPrinterReasonString(bit));
-	}
-      }
+  if (organization)
+    papplPrinterSetGeoLocation(printer, organization);
 
-      if (printer->is_stopped)
-	ippSetString(ipp, &attr, ippGetCount(attr), "moving-to-paused");
-      else if (printer->state == IPP_PSTATE_STOPPED)
-	ippSetString(ipp, &attr, ippGetCount(attr), "paused");
+  if (org_unit)
+    papplPrinterSetGeoLocation(printer, org_unit);
 
-      if (printer->hold_new_jobs)
-	ippSetString(ipp, &attr, ippGetCount(attr), "hold-new-jobs");
+  papplSystemAddEvent(printer->system, printer, NULL, PAPPL_EVENT_PRINTER_CONFIG_CHANGED, NULL);
 
-      if (wifi_not_configured)
-	ippSetString(ipp, &attr, ippGetCount(attr), "wifi-not-configured-report");
-    }
-  }
+  return (true);
 }
 
 
 //
-// '_papplPrinterCopyXRINoLock()' - Copy the "printer-xri-supported" attribute.
+// 'copy_cached_attrs()' - Copy the cached printer configuration attributes.
+//
+// This function copies the static, driver, and configuration attributes for
+// the request from the printer's cache, (re)generating them when the request
+// has not been seen before or the printer configuration has changed since they
+// were cached.  The static and driver attributes are copied (not referenced)
+// into the cache since the driver attributes are replaced when the driver
+// changes.
 //
 
-void
-_papplPrinterCopyXRINoLock(
+static bool				// O - `true` on success, `false` if the attributes cannot be cached
+copy_cached_attrs(
     pappl_printer_t *printer,		// I - Printer
-    ipp_t           *ipp,		// I - IPP message
-    pappl_client_t  *client)		// I - Client
+    pappl_client_t  *client,		// I - Client
+    cups_array_t    *ra,		// I - Requested attributes
+    const char      *format,		// I - "document-format" value, if any
+    const char      *webscheme)		// I - URL scheme for resources
 {
-  char	uri[1024];			// URI value
-  int	i,				// Looping var
-	num_values = 0;			// Number of values
-  ipp_t	*col,				// Current collection value
-	*values[2];			// Values for attribute
+  size_t	i,			// Looping var
+		keylen,			// Length of key
+		namelen;		// Length of attribute name
+  char		*key,			// Key for request
+		*keyptr;		// Pointer into key
+  const char	*name;			// Requested attribute name
+  _pappl_pattrs_t *pattrs,		// Cached attributes
+		*pptr;			// Current cached attributes
 
 
-  if (httpAddrIsLocalhost(httpGetAddress(client->http)) || !papplSystemGetTLSOnly(client->system))
+  // Build a key from everything that affects the configuration attributes -
+  // the (sorted) requested attributes, document format, URL scheme, client
+  // host, and authentication...
+  keylen = (format ? strlen(format) : 0) + strlen(client->host_field) + 32;
+
+  if (ra)
   {
-    // Add ipp: URI...
-    httpAssembleURI(HTTP_URI_CODING_ALL, uri, sizeof(uri), "ipp", NULL, client->host_field, client->host_port, printer->resource);
-    col = ippNew();
+    for (name = (const char *)cupsArrayGetFirst(ra); name; name = (const char *)cupsArrayGetNext(ra))
+      keylen += strlen(name) + 1;
+  }
 
-    ippAddString(col, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "xri-authentication", NULL, "none");
-    ippAddString(col, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "xri-security", NULL, "none");
-    ippAddString(col, IPP_TAG_PRINTER, IPP_TAG_URI, "xri-uri", NULL, uri);
+  if ((key = malloc(keylen)) == NULL)
+    return (false);
 
-    values[num_values ++] = col;
-  }
+  snprintf(key, keylen, "%s|%s|%s:%d|%c%c|", format ? format : "", webscheme, client->host_field, client->host_port, httpAddrIsLocalhost(httpGetAddress(client->http)) ? 'L' : 'R', papplSystemGetAuthService(client->system) ? 'A' : '-');
+  keyptr = key + strlen(key);
 
-  if (!httpAddrIsLocalhost(httpGetAddress(client->http)) && !(client->system->options & PAPPL_SOPTIONS_NO_TLS))
+  if (ra)
   {
-    // Add ipps: URI...
-    httpAssembleURI(HTTP_URI_CODING_ALL, uri, sizeof(uri), "ipps", NULL, client->host_field, client->host_port, printer->resource);
-    col = ippNew();
+    for (name = (const char *)cupsArrayGetFirst(ra); name; name = (const char *)cupsArrayGetNext(ra))
+    {
+      namelen = strlen(name);
+      memcpy(keyptr, name, namelen);
+      keyptr += namelen;
+      *keyptr++ = ',';
+    }
+  }
+  else
+  {
+    *keyptr++ = '*';
+  }
 
-    ippAddString(col, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "xri-authentication", NULL, papplSystemGetAuthService(client->system) ? "basic" : "none");
-    ippAddString(col, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "xri-security", NULL, "tls");
-    ippAddString(col, IPP_TAG_PRINTER, IPP_TAG_URI, "xri-uri", NULL, uri);
+  *keyptr = '\0';
 
-    values[num_values ++] = col;
+  // Find the cached attributes for the key, or the least recently used cache
+  // entry to replace...
+  pthread_mutex_lock(&printer->pattrs_mutex);
+
+  for (i = 0, pattrs = NULL, pptr = printer->pattrs; i < _PAPPL_MAX_PATTRS; i ++, pptr ++)
+  {
+    if (pptr->key && !strcmp(pptr->key, key))
+    {
+      pattrs = pptr;
+      break;
+    }
+    else if (!pattrs || (pattrs->key && (!pptr->key || pptr->use < pattrs->use)))
+    {
+      pattrs = pptr;
+    }
   }
 
-  if (num_values > 0)
-    ippAddCollections(ipp, IPP_TAG_PRINTER, "printer-xri-supported", IPP_NUM_CAST num_values, (const ipp_t **)values);
+  if (i >= _PAPPL_MAX_PATTRS || pattrs->version != printer->config_version)
+  {
+    // (Re)generate the configuration attributes...
+    free(pattrs->key);
+    ippDelete(pattrs->ipp);
 
-  for (i = 0; i < num_values; i ++)
-    ippDelete(values[i]);
-}
+    if ((pattrs->ipp = ippNew()) == NULL)
+    {
+      pattrs->key = NULL;
 
+      pthread_mutex_unlock(&printer->pattrs_mutex);
+      free(key);
 
-//
-// '_papplPrinterIsAuthorized()' - Authorize access to a printer.
-//
+      return (false);
+    }
 
-bool					// O - `true` on success, `false` on failure
-_papplPrinterIsAuthorized(
-    pappl_client_t  *client)		// I - Client
-{
-  http_status_t code = _papplClientIsAuthorizedForGroup(client, true, client->printer->print_group, client->printer->print_gid);
+    pattrs->key     = key;
+    pattrs->version = printer->config_version;
+    key             = NULL;
 
-  if (code == HTTP_STATUS_CONTINUE && client->job && client->job->username && strcmp(client->username, client->job->username))
-  {
-    // Not the owner, try authorizing with admin group...
-    code = _papplClientIsAuthorizedForGroup(client, true, client->system->admin_group, client->system->admin_gid);
+    _papplCopyAttributes(pattrs->ipp, printer->attrs, ra, IPP_TAG_ZERO, 0);
+    _papplCopyAttributes(pattrs->ipp, printer->driver_attrs, ra, IPP_TAG_ZERO, 0);
+
+    copy_config_attrs(printer, client, pattrs->ipp, ra, format, webscheme);
   }
 
-  if (code == HTTP_STATUS_CONTINUE)
-    return (true);
+  // Copy the attributes to the response...
+  pattrs->use = ++ printer->pattrs_use;
 
-  papplClientRespond(client, code, NULL, NULL, 0, 0);
-  return (false);
-}
+  ippCopyAttributes(client->response, pattrs->ipp, 0, NULL, NULL);
 
+  pthread_mutex_unlock(&printer->pattrs_mutex);
 
-//
-// '_papplPrinterProcessIPP()' - Process an IPP Printer request.
+  free(key);
+
+  return (true);
+}
+
+
+//
+// 'copy_config_attrs()' - Copy the printer configuration attributes.
+//
+// This function generates the attributes that only change when the printer
+// configuration changes.
 //
 
-void
-_papplPrinterProcessIPP(
-    pappl_client_t *client)		// I - Client
+static void
+copy_config_attrs(
+    pappl_printer_t *printer,		// I - Printer
+    pappl_client_t  *client,		// I - Client
+    ipp_t           *ipp,		// I - IPP message
+    cups_array_t    *ra,		// I - Requested attributes
+    const char      *format,		// I - "document-format" value, if any
+    const char      *webscheme)		// I - URL scheme for resources
 {
-  if (!client->printer)
+  cups_len_t	i,			// Looping var
+		num_values;		// Number of values
+  unsigned	bit;			// Current bit value
+  const char	*svalues[100];		// String values
+  pappl_pr_driver_data_t *data = &printer->driver_data;
+					// Driver data
+
+
+  if (!ra || cupsArrayFind(ra, "copies-supported"))
   {
-    papplClientRespondIPP(client, IPP_STATUS_ERROR_NOT_FOUND, "No printer found.");
-    return;
+    // Filter copies-supported value based on the document format...
+    // (no copy support for streaming raster formats)
+    if (format && (!strcmp(format, "image/pwg-raster") || !strcmp(format, "image/urf")))
+      ippAddRange(ipp, IPP_TAG_PRINTER, "copies-supported", 1, 1);
+    else
+      ippAddRange(ipp, IPP_TAG_PRINTER, "copies-supported", 1, 999);
   }
 
-  switch (ippGetOperation(client->request))
+  if (!ra || cupsArrayFind(ra, "identify-actions-default"))
   {
-    case IPP_OP_PRINT_JOB :
-	ipp_print_job(client);
-	break;
+    for (num_values = 0, bit = PAPPL_IDENTIFY_ACTIONS_DISPLAY; bit <= PAPPL_IDENTIFY_ACTIONS_SPEAK; bit *= 2)
+    {
+      if (data->identify_default & bit)
+	svalues[num_values ++] = _papplIdentifyActionsString(bit);
+    }
 
-    case IPP_OP_VALIDATE_JOB :
-	ipp_validate_job(client);
-	break;
+    if (num_values > 0)
+      ippAddStrings(ipp, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "identify-actions-default", IPP_NUM_CAST num_values, NULL, svalues);
+    else
+      ippAddString(ipp, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "identify-actions-default", NULL, "none");
+  }
 
-    case IPP_OP_CREATE_JOB :
-	ipp_create_job(client);
-	break;
+  if (printer->max_preserved_jobs > 0)
+  {
+    static const char * const job_retain_until[] =
+    {					// job-retain-until-supported values
+      "day-time",
+      "evening",
+      "indefinite",
+      "night",
+      "no-hold",
+      "second-shift",
+      "third-shift",
+      "weekend"
+    };
 
-    case IPP_OP_CANCEL_CURRENT_JOB :
-	ipp_cancel_current_job(client);
-	break;
+    if (!ra || cupsArrayFind(ra, "job-retain-until-default"))
+      ippAddString(ipp, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "job-retain-until-default", NULL, "none");
 
-    case IPP_OP_CANCEL_JOBS :
-    case IPP_OP_CANCEL_MY_JOBS :
-	ipp_cancel_jobs(client);
-	break;
+    if (!ra || cupsArrayFind(ra, "job-retain-until-interval-default"))
+      ippAddOutOfBand(ipp, IPP_TAG_PRINTER, IPP_TAG_NOVALUE, "job-retain-until-interval-default");
 
-    case IPP_OP_GET_JOBS :
-	ipp_get_jobs(client);
-	break;
+    if (!ra || cupsArrayFind(ra, "job-retain-until-interval-supported"))
+      ippAddRange(ipp, IPP_TAG_PRINTER, "job-retain-until-interval-supported", 0, 86400);
 
-    case IPP_OP_GET_PRINTER_ATTRIBUTES :
-    case IPP_OP_GET_PRINTER_SUPPORTED_VALUES :
-    case IPP_OP_CUPS_GET_DEFAULT :
-	ipp_get_printer_attributes(client);
-	break;
+    if (!ra || cupsArrayFind(ra, "job-retain-until-supported"))
+      ippAddStrings(ipp, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "job-retain-until-supported", (cups_len_t)(sizeof(job_retain_until) / sizeof(job_retain_until[0])), NULL, job_retain_until);
 
-    case IPP_OP_SET_PRINTER_ATTRIBUTES :
-	ipp_set_printer_attributes(client);
-	break;
+    if (!ra || cupsArrayFind(ra, "job-retain-until-time-supported"))
+      ippAddRange(ipp, IPP_TAG_PRINTER, "job-retain-until-time-supported", 0, 86400);
+  }
 
-    case IPP_OP_IDENTIFY_PRINTER :
-	ipp_identify_printer(client);
-	break;
+  if (!ra || cupsArrayFind(ra, "job-spooling-supported"))
+    ippAddString(ipp, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "job-spooling-supported", NULL, (printer->max_active_jobs == 1 || (format && (!strcmp(format, "image/pwg-raster") || !strcmp(format, "image/urf")))) ? "stream" : "spool");
 
-    case IPP_OP_PAUSE_PRINTER :
-    case IPP_OP_PAUSE_PRINTER_AFTER_CURRENT_JOB :
-	ipp_pause_printer(client);
-	break;
+  if ((!ra || cupsArrayFind(ra, "label-mode-configured")) && data->mode_configured)
+    ippAddString(ipp, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "label-mode-configured", NULL, _papplLabelModeString(data->mode_configured));
 
-    case IPP_OP_RESUME_PRINTER :
-	ipp_resume_printer(client);
-	break;
+  if ((!ra || cupsArrayFind(ra, "label-tear-offset-configured")) && data->tear_offset_supported[1] > 0)
+    ippAddInteger(ipp, IPP_TAG_PRINTER, IPP_TAG_INTEGER, "label-tear-offset-configured", data->tear_offset_configured);
 
-    case IPP_OP_ENABLE_PRINTER :
-        ipp_enable_printer(client);
-        break;
+  if ((!ra || cupsArrayFind(ra, "media-col-default")) && data->media_default.size_name[0])
+  {
+    ipp_t *col = _papplMediaColExport(&printer->driver_data, &data->media_default, 0);
+					// Collection value
 
-    case IPP_OP_DISABLE_PRINTER :
-        ipp_disable_printer(client);
-        break;
+    ippAddCollection(ipp, IPP_TAG_PRINTER, "media-col-default", col);
+    ippDelete(col);
+  }
 
-    case IPP_OP_HOLD_NEW_JOBS :
-        ipp_hold_new_jobs(client);
-        break;
+  if (!ra || cupsArrayFind(ra, "media-col-ready"))
+  {
+    cups_len_t		j,		// Looping var
+			count;		// Number of values
+    ipp_t		*col;		// Collection value
+    ipp_attribute_t	*attr;		// media-col-ready attribute
+    pappl_media_col_t	media;		// Current media...
 
-    case IPP_OP_RELEASE_HELD_NEW_JOBS :
-        ipp_release_held_new_jobs(client);
-        break;
+    for (i = 0, count = 0; i < (cups_len_t)printer->num_ready; i ++)
+    {
+      if (data->media_ready[i].size_name[0])
+        count ++;
+    }
 
-    case IPP_OP_CREATE_PRINTER_SUBSCRIPTIONS :
-    case IPP_OP_CREATE_JOB_SUBSCRIPTIONS :
-        _papplSubscriptionIPPCreate(client);
-        break;
+    if (data->borderless && (data->bottom_top != 0 || data->left_right != 0))
+      count *= 2;			// Need to report ready media for borderless, too...
 
-    case IPP_OP_GET_SUBSCRIPTION_ATTRIBUTES :
-        _papplSubscriptionIPPGetAttributes(client);
-        break;
+    if (count > 0)
+    {
+      attr = ippAddCollections(ipp, IPP_TAG_PRINTER, "media-col-ready", IPP_NUM_CAST count, NULL);
 
-    case IPP_OP_GET_SUBSCRIPTIONS :
-        _papplSubscriptionIPPList(client);
-        break;
+      for (i = 0, j = 0; i < (cups_len_t)printer->num_ready && j < count; i ++)
+      {
+	if (data->media_ready[i].size_name[0])
+	{
+          if (data->borderless && (data->bottom_top != 0 || data->left_right != 0))
+	  {
+	    // Report both bordered and borderless media-col values...
+	    media = data->media_ready[i];
 
-    case IPP_OP_RENEW_SUBSCRIPTION :
-        _papplSubscriptionIPPRenew(client);
-        break;
+	    media.bottom_margin = media.top_margin   = data->bottom_top;
+	    media.left_margin   = media.right_margin = data->left_right;
+	    col = _papplMediaColExport(&printer->driver_data, &media, 0);
+	    ippSetCollection(ipp, &attr, IPP_NUM_CAST j ++, col);
+	    ippDelete(col);
 
-    case IPP_OP_CANCEL_SUBSCRIPTION :
-        _papplSubscriptionIPPCancel(client);
-        break;
+	    media.bottom_margin = media.top_margin   = 0;
+	    media.left_margin   = media.right_margin = 0;
+	    col = _papplMediaColExport(&printer->driver_data, &media, 0);
+	    ippSetCollection(ipp, &attr, IPP_NUM_CAST j ++, col);
+	    ippDelete(col);
+	  }
+	  else
+	  {
+	    // Just report the single media-col value...
+	    col = _papplMediaColExport(&printer->driver_data, data->media_ready + i, 0);
+	    ippSetCollection(ipp, &attr, IPP_NUM_CAST j ++, col);
+	    ippDelete(col);
+	  }
+	}
+      }
+    }
+  }
 
-    case IPP_OP_GET_NOTIFICATIONS :
-        _papplSubscriptionIPPGetNotifications(client);
-        break;
+  if ((!ra || cupsArrayFind(ra, "media-default")) && data->media_default.size_name[0])
+    ippAddString(ipp, IPP_TAG_PRINTER, IPP_TAG_KEYWORD, "media-default", NULL, data->media_default.size_name);
 
-    default :
-        if (client->system->op_cb && (client->system->op_cb)(client, client->system->op_cbdata))
-          break;
+  if (!ra || cupsArrayFind(ra, "media-ready"))
+  {
+    cups_len_t		j,		// Looping vars
+			count;		// Number of values
+    ipp_attribute_t	*attr;		// media-col-ready attribute
 
-	papplClientRespondIPP(client, IPP_STATUS_ERROR_OPERATION_NOT_SUPPORTED, "Operation not supported.");
-	break;
+    for (i = 0, count = 0; i < (cups_len_t)printer->num_ready; i ++)
+    {
+      if (data->media_ready[i].size_name[0])
+        count ++;
+    }
+
+    if (count > 0)
+    {
+      attr = ippAddStrings(ipp, IPP_TAG_PRINTER, IPP_TAG_KEYWORD, "media-ready", IPP_NUM_CAST count, NULL, NULL);
+
+      for (i = 0, j = 0; i < (cups_len_t)printer->num_ready && j < count; i ++)
+      {
+	if (data->media_ready[i].size_name[0])
+	  ippSetString(ipp, &attr, IPP_NUM_CAST j ++, data->media_ready[i].size_name);
+      }
+    }
   }
-}
 
+  if (!ra || cupsArrayFind(ra, "multiple-document-handling-default"))
+    ippAddString(ipp, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "multiple-document-handling-default", NULL, "separate-documents-collated-copies");
 
-//
-// '_papplPrinterSetAttributes()' - Set printer attributes.
-//
+  if (!ra || cupsArrayFind(ra, "orientation-requested-default"))
+    ippAddInteger(ipp, IPP_TAG_PRINTER, IPP_TAG_ENUM, "orientation-requested-default", (int)data->orient_default);
 
-bool					// O - `true` if OK, `false` otherwise
-_papplPrinterSetAttributes(
-    pappl_client_t  *client,		// I - Client
-    pappl_printer_t *printer)		// I - Printer
-{
-  int			create_printer;	// Create-Printer request?
-  ipp_attribute_t	*rattr;		// Current request attribute
-  ipp_tag_t		value_tag;	// Value tag
-  cups_len_t		count;		// Number of values
-  const char		*name;		// Attribute name
-  char			defname[128],	// xxx-default name
-			value[1024];	// xxx-default value
-  cups_len_t		i, j;		// Looping vars
-  pwg_media_t		*pwg;		// PWG media size data
-  pappl_pr_driver_data_t driver_data;	// Printer driver data
-  bool			do_defaults = false,
-					// Update defaults?
-			do_ready = false;
-					// Update ready media?
-  cups_len_t		num_vendor = 0;	// Number of vendor defaults
-  cups_option_t		*vendor = NULL;	// Vendor defaults
-  pappl_contact_t	contact;	// printer-contact value
-  bool			do_contact = false;
-					// Update contact?
-  const char		*geo_location = NULL,
-					// printer-geo-location value
-			*location = NULL,
-					// printer-location value
-			*organization = NULL,
-					// printer-organization value
-			*org_unit = NULL;
-					// printer-organizational-unit value
-  char			wifi_ssid[256] = "",
-					// printer-wifi-ssid value
-			wifi_password[256] = "";
-					// printer-wifi-password value
-  bool			do_wifi = false;// Join a Wi-Fi network?
-  static _pappl_attr_t	pattrs[] =	// Settable printer attributes
+  if (!ra || cupsArrayFind(ra, "output-bin-default"))
   {
-    { "label-mode-configured",		IPP_TAG_KEYWORD,	1 },
-    { "label-tear-off-configured",	IPP_TAG_INTEGER,	1 },
-    { "media-col-default",		IPP_TAG_BEGIN_COLLECTION, 1 },
-    { "media-col-ready",		IPP_TAG_BEGIN_COLLECTION, PAPPL_MAX_SOURCE },
-    { "media-default",			IPP_TAG_KEYWORD,	1 },
-    { "media-ready",			IPP_TAG_KEYWORD,	PAPPL_MAX_SOURCE },
-    { "orientation-requested-default",	IPP_TAG_ENUM,		1 },
-    { "print-color-mode-default",	IPP_TAG_KEYWORD,	1 },
-    { "print-content-optimize-default",	IPP_TAG_KEYWORD,	1 },
-    { "print-darkness-default",		IPP_TAG_INTEGER,	1 },
-    { "print-quality-default",		IPP_TAG_ENUM,		1 },
-    { "print-speed-default",		IPP_TAG_INTEGER,	1 },
-    { "printer-contact-col",		IPP_TAG_BEGIN_COLLECTION, 1 },
-    { "printer-darkness-configured",	IPP_TAG_INTEGER,	1 },
-    { "printer-geo-location",		IPP_TAG_URI,		1 },
-    { "printer-location",		IPP_TAG_TEXT,		1 },
-    { "printer-organization",		IPP_TAG_TEXT,		1 },
-    { "printer-organizational-unit",	IPP_TAG_TEXT,		1 },
-    { "printer-resolution-default",	IPP_TAG_RESOLUTION,	1 },
-    { "printer-wifi-password",		IPP_TAG_STRING,		1 },
-    { "printer-wifi-ssid",		IPP_TAG_NAME,		1 }
-  };
+    if (data->num_bin > 0)
+      ippAddString(ipp, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "output-bin-default", NULL, data->bin[data->bin_default]);
+    else if (data->output_face_up)
+      ippAddString(ipp, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "output-bin-default", NULL, "face-up");
+    else
+      ippAddString(ipp, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "output-bin-default", NULL, "face-down");
+  }
 
+  if ((!ra || cupsArrayFind(ra, "print-color-mode-default")) && data->color_default)
+    ippAddString(ipp, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "print-color-mode-default", NULL, _papplColorModeString(data->color_default));
 
-  // Preflight request attributes...
-  create_printer = ippGetOperation(client->request) == IPP_OP_CREATE_PRINTER;
+  if (!ra || cupsArrayFind(ra, "print-content-optimize-default"))
+  {
+    if (data->content_default)
+      ippAddString(ipp, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "print-content-optimize-default", NULL, _papplContentString(data->content_default));
+    else
+      ippAddString(ipp, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "print-content-optimize-default", NULL, "auto");
+  }
 
-  papplPrinterGetDriverData(printer, &driver_data);
+  if (!ra || cupsArrayFind(ra, "print-quality-default"))
+  {
+    if (data->quality_default)
+      ippAddInteger(ipp, IPP_TAG_PRINTER, IPP_TAG_ENUM, "print-quality-default", (int)data->quality_default);
+    else
+      ippAddInteger(ipp, IPP_TAG_PRINTER, IPP_TAG_ENUM, "print-quality-default", IPP_QUALITY_NORMAL);
+  }
 
-  for (rattr = ippGetFirstAttribute(client->request); rattr; rattr = ippGetNextAttribute(client->request))
+  if (!ra || cupsArrayFind(ra, "print-scaling-default"))
   {
-    papplLogClient(client, PAPPL_LOGLEVEL_DEBUG, "%s %s %s%s ...", ippTagString(ippGetGroupTag(rattr)), ippGetName(rattr), ippGetCount(rattr) > 1 ? "1setOf " : "", ippTagString(ippGetValueTag(rattr)));
+    if (data->scaling_default)
+      ippAddString(ipp, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "print-scaling-default", NULL, _papplScalingString(data->scaling_default));
+    else
+      ippAddString(ipp, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "print-scaling-default", NULL, "auto");
+  }
 
-    if (ippGetGroupTag(rattr) == IPP_TAG_OPERATION || (name = ippGetName(rattr)) == NULL)
-    {
-      continue;
-    }
-    else if (ippGetGroupTag(rattr) != IPP_TAG_PRINTER)
-    {
-      papplClientRespondIPPUnsupported(client, rattr);
-      continue;
-    }
+  if (!ra || cupsArrayFind(ra, "printer-config-change-date-time"))
+    ippAddDate(ipp, IPP_TAG_PRINTER, "printer-config-change-date-time", ippTimeToDate(printer->config_time));
 
-    if (create_printer && (!strcmp(name, "printer-device-id") || !strcmp(name, "printer-name") || !strcmp(name, "smi55357-device-uri") || !strcmp(name, "smi55357-driver")))
-      continue;
+  if (!ra || cupsArrayFind(ra, "printer-config-change-time"))
+  {
+    if (printer->config_time > printer->start_time)
+      ippAddInteger(ipp, IPP_TAG_PRINTER, IPP_TAG_INTEGER, "printer-config-change-time", (int)(printer->config_time - printer->start_time));
+    else
+      ippAddInteger(ipp, IPP_TAG_PRINTER, IPP_TAG_INTEGER, "printer-config-change-time", 1);
+  }
 
-    if ((create_printer || !httpAddrIsLocalhost(httpGetAddress(client->http)) || !client->system->wifi_join_cb) && (!strcmp(name, "printer-wifi-password") || !strcmp(name, "printer-wifi-ssid")))
-    {
-      // Wi-Fi configuration can only be done over localhost...
-      papplClientRespondIPPUnsupported(client, rattr);
-      continue;
-    }
+  if (!ra || cupsArrayFind(ra, "printer-contact-col"))
+  {
+    ipp_t *col = _papplContactExport(&printer->contact);
+    ippAddCollection(ipp, IPP_TAG_PRINTER, "printer-contact-col", col);
+    ippDelete(col);
+  }
 
-    // Validate syntax of provided attributes...
-    value_tag = ippGetValueTag(rattr);
-    count     = ippGetCount(rattr);
+  if ((!ra || cupsArrayFind(ra, "printer-darkness-configured")) && data->darkness_supported > 0)
+    ippAddInteger(ipp, IPP_TAG_PRINTER, IPP_TAG_INTEGER, "printer-darkness-configured", data->darkness_configured);
 
-    for (i = 0; i < (cups_len_t)(sizeof(pattrs) / sizeof(pattrs[0])); i ++)
-    {
-      if (!strcmp(name, pattrs[i].name) && value_tag == pattrs[i].value_tag && count <= pattrs[i].max_count)
-        break;
-    }
+  if (!ra || cupsArrayFind(ra, "printer-dns-sd-name"))
+    ippAddString(ipp, IPP_TAG_PRINTER, IPP_TAG_NAME, "printer-dns-sd-name", NULL, printer->dns_sd_name ? printer->dns_sd_name : "");
 
-    if (i >= (int)(sizeof(pattrs) / sizeof(pattrs[0])))
-    {
-      for (j = 0; j < (cups_len_t)printer->driver_data.num_vendor; j ++)
-      {
-        snprintf(defname, sizeof(defname), "%s-default", printer->driver_data.vendor[j]);
-        if (!strcmp(name, defname))
-        {
-          ippAttributeString(rattr, value, sizeof(value));
-          num_vendor = cupsAddOption(printer->driver_data.vendor[j], value, num_vendor, &vendor);
-          do_defaults = true;
-          break;
-	}
-      }
+  if (!ra || cupsArrayFind(ra, "printer-geo-location"))
+  {
+    if (printer->geo_location)
+      ippAddString(ipp, IPP_TAG_PRINTER, IPP_TAG_URI, "printer-geo-location", NULL, printer->geo_location);
+    else
+      ippAddOutOfBand(ipp, IPP_TAG_PRINTER, IPP_TAG_UNKNOWN, "printer-geo-location");
+  }
 
-      if (j >= (cups_len_t)printer->driver_data.num_vendor)
-        papplClientRespondIPPUnsupported(client, rattr);
-    }
+  if (!ra || cupsArrayFind(ra, "printer-icons"))
+  {
+    char	uris[3][1024];		// Buffers for URIs
+    const char	*values[3];		// Values for attribute
 
-    // Then copy the xxx-default values to the
-    if (!strcmp(name, "identify-actions-default"))
-    {
-      driver_data.identify_default = PAPPL_IDENTIFY_ACTIONS_NONE;
+    httpAssembleURIf(HTTP_URI_CODING_ALL, uris[0], sizeof(uris[0]), webscheme, NULL, client->host_field, client->host_port, "%s/icon-sm.png", printer->uriname);
+    httpAssembleURIf(HTTP_URI_CODING_ALL, uris[1], sizeof(uris[1]), webscheme, NULL, client->host_field, client->host_port, "%s/icon-md.png", printer->uriname);
+    httpAssembleURIf(HTTP_URI_CODING_ALL, uris[2], sizeof(uris[2]), webscheme, NULL, client->host_field, client->host_port, "%s/icon-lg.png", printer->uriname);
 
-      for (i = 0, count = ippGetCount(rattr); i < count; i ++)
-        driver_data.identify_default |= _papplIdentifyActionsValue(ippGetString(rattr, i, NULL));
-      do_defaults = true;
-    }
-    else if (!strcmp(name, "label-mode-configured"))
-    {
-      driver_data.mode_configured = _papplLabelModeValue(ippGetString(rattr, 0, NULL));
-      do_defaults = true;
-    }
-    else if (!strcmp(name, "label-tear-offset-configured"))
-    {
-      driver_data.tear_offset_configured = ippGetInteger(rattr, 0);
-      do_defaults = true;
-    }
-    else if (!strcmp(name, "media-col-default"))
-    {
-      _papplMediaColImport(ippGetCollection(rattr, 0), &driver_data.media_default);
-      do_defaults = true;
-    }
-    else if (!strcmp(name, "media-col-ready"))
-    {
-      count = ippGetCount(rattr);
+    values[0] = uris[0];
+    values[1] = uris[1];
+    values[2] = uris[2];
 
-      for (i = 0; i < count; i ++)
-        _papplMediaColImport(ippGetCollection(rattr, i), driver_data.media_ready + i);
+    ippAddStrings(ipp, IPP_TAG_PRINTER, IPP_TAG_URI, "printer-icons", 3, NULL, values);
+  }
 
-      for (; i < PAPPL_MAX_SOURCE; i ++)
-        memset(driver_data.media_ready + i, 0, sizeof(pappl_media_col_t));
+  if (!ra || cupsArrayFind(ra, "printer-input-tray"))
+  {
+    ipp_attribute_t	*attr = NULL;	// "printer-input-tray" attribute
+    char		value[256];	// Value for current tray
+    pappl_media_col_t	*media;		// Media in the tray
 
-      do_ready = true;
-    }
-    else if (!strcmp(name, "media-default"))
+    for (i = 0, media = data->media_ready; i < (cups_len_t)data->num_source; i ++, media ++)
     {
-      if ((pwg = pwgMediaForPWG(ippGetString(rattr, 0, NULL))) != NULL)
-      {
-        papplCopyString(driver_data.media_default.size_name, pwg->pwg, sizeof(driver_data.media_default.size_name));
-        driver_data.media_default.size_width  = pwg->width;
-        driver_data.media_default.size_length = pwg->length;
-      }
+      const char	*type;		// Tray type
 
-      do_defaults = true;
+      if (!strcmp(data->source[i], "manual"))
+        type = "sheetFeedManual";
+      else if (!strcmp(data->source[i], "by-pass-tray"))
+        type = "sheetFeedAutoNonRemovableTray";
+      else
+        type = "sheetFeedAutoRemovableTray";
+
+      snprintf(value, sizeof(value), "type=%s;mediafeed=%d;mediaxfeed=%d;maxcapacity=%d;level=-2;status=0;name=%s;", type, media->size_length, media->size_width, !strcmp(media->source, "manual") ? 1 : -2, media->source);
+
+      if (attr)
+        ippSetOctetString(ipp, &attr, ippGetCount(attr), value, IPP_NUM_CAST strlen(value));
+      else
+        attr = ippAddOctetString(ipp, IPP_TAG_PRINTER, "printer-input-tray", value, IPP_NUM_CAST strlen(value));
     }
-    else if (!strcmp(name, "media-ready"))
-    {
-      count = ippGetCount(rattr);
 
-      for (i = 0; i < count; i ++)
-      {
-        if ((pwg = pwgMediaForPWG(ippGetString(rattr, i, NULL))) != NULL)
-        {
-          papplCopyString(driver_data.media_ready[i].size_name, pwg->pwg, sizeof(driver_data.media_ready[i].size_name));
-	  driver_data.media_ready[i].size_width  = pwg->width;
-	  driver_data.media_ready[i].size_length = pwg->length;
-	}
-      }
+    // The "auto" tray is a dummy entry...
+    papplCopyString(value, "type=other;mediafeed=0;mediaxfeed=0;maxcapacity=-2;level=-2;status=0;name=auto;", sizeof(value));
+    ippSetOctetString(ipp, &attr, ippGetCount(attr), value, IPP_NUM_CAST strlen(value));
+  }
 
-      for (; i < PAPPL_MAX_SOURCE; i ++)
-      {
-        driver_data.media_ready[i].size_name[0] = '\0';
-        driver_data.media_ready[i].size_width   = 0;
-        driver_data.media_ready[i].size_length  = 0;
-      }
+  if (!ra || cupsArrayFind(ra, "printer-location"))
+    ippAddString(ipp, IPP_TAG_PRINTER, IPP_TAG_TEXT, "printer-location", NULL, printer->location ? printer->location : "");
 
-      do_ready = true;
-    }
-    else if (!strcmp(name, "orientation-requested-default"))
-    {
-      driver_data.orient_default = (ipp_orient_t)ippGetInteger(rattr, 0);
-      do_defaults = true;
-    }
-    else if (!strcmp(name, "print-color-mode-default"))
-    {
-      driver_data.color_default = _papplColorModeValue(ippGetString(rattr, 0, NULL));
-      do_defaults = true;
-    }
-    else if (!strcmp(name, "print-content-optimize-default"))
+  if (!ra || cupsArrayFind(ra, "printer-more-info"))
+  {
+    char	uri[1024];		// URI value
+
+    httpAssembleURIf(HTTP_URI_CODING_ALL, uri, sizeof(uri), webscheme, NULL, client->host_field, client->host_port, "%s/", printer->uriname);
+    ippAddString(ipp, IPP_TAG_PRINTER, IPP_TAG_URI, "printer-more-info", NULL, uri);
+  }
+
+  if (!ra || cupsArrayFind(ra, "printer-organization"))
+    ippAddString(ipp, IPP_TAG_PRINTER, IPP_TAG_TEXT, "printer-organization", NULL, printer->organization ? printer->organization : "");
+
+  if (!ra || cupsArrayFind(ra, "printer-organizational-unit"))
+    ippAddString(ipp, IPP_TAG_PRINTER, IPP_TAG_TEXT, "printer-organizational-unit", NULL, printer->org_unit ? printer->org_unit : "");
+
+  if (!ra || cupsArrayFind(ra, "printer-resolution-default"))
+    ippAddResolution(ipp, IPP_TAG_PRINTER, "printer-resolution-default", IPP_RES_PER_INCH, data->x_default, data->y_default);
+
+  if (!ra || cupsArrayFind(ra, "printer-speed-default"))
+    ippAddInteger(ipp, IPP_TAG_PRINTER, IPP_TAG_INTEGER, "printer-speed-default", data->speed_default);
+
+  if (!ra || cupsArrayFind(ra, "printer-supply-info-uri"))
+  {
+    char	uri[1024];		// URI value
+
+    httpAssembleURIf(HTTP_URI_CODING_ALL, uri, sizeof(uri), webscheme, NULL, client->host_field, client->host_port, "%s/supplies", printer->uriname);
+    ippAddString(ipp, IPP_TAG_PRINTER, IPP_TAG_URI, "printer-supply-info-uri", NULL, uri);
+  }
+
+  if (!ra || cupsArrayFind(ra, "printer-uri-supported"))
+  {
+    char	uris[2][1024];		// Buffers for URIs
+    const char	*values[2];		// Values for attribute
+
+    num_values = 0;
+
+    if (httpAddrIsLocalhost(httpGetAddress(client->http)) || !papplSystemGetTLSOnly(client->system))
     {
-      driver_data.content_default = _papplContentValue(ippGetString(rattr, 0, NULL));
-      do_defaults = true;
+      httpAssembleURI(HTTP_URI_CODING_ALL, uris[num_values], sizeof(uris[0]), "ipp", NULL, client->host_field, client->host_port, printer->resource);
+      values[num_values] = uris[num_values];
+      num_values ++;
     }
-    else if (!strcmp(name, "print-darkness-default"))
+
+    if (!httpAddrIsLocalhost(httpGetAddress(client->http)) && !(client->system->options & PAPPL_SOPTIONS_NO_TLS))
     {
-      driver_data.darkness_default = ippGetInteger(rattr, 0);
-      do_defaults = true;
+      httpAssembleURI(HTTP_URI_CODING_ALL, uris[num_values], sizeof(uris[0]), "ipps", NULL, client->host_field, client->host_port, printer->resource);
+      values[num_values] = uris[num_values];
+      num_values ++;
     }
-    else if (!strcmp(name, "print-quality-default"))
+
+    if (num_values > 0)
+      ippAddStrings(ipp, IPP_TAG_PRINTER, IPP_TAG_URI, "printer-uri-supported", IPP_NUM_CAST num_values, NULL, values);
+  }
+
+  if (!ra || cupsArrayFind(ra, "printer-xri-supported"))
+    _papplPrinterCopyXRINoLock(printer, ipp, client);
+
+  if (!ra || cupsArrayFind(ra, "sides-default"))
+  {
+    if (data->sides_default)
+      ippAddString(ipp, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "sides-default", NULL, _papplSidesString(data->sides_default));
+    else
+      ippAddString(ipp, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "sides-default", NULL, "one-sided");
+  }
+
+  if (!ra || cupsArrayFind(ra, "uri-authentication-supported"))
+  {
+    // For each supported printer-uri value, report whether authentication is
+    // supported.  Since we only support authentication over a secure (TLS)
+    // channel, the value is always 'none' for the "ipp" URI and either 'none'
+    // or 'basic' for the "ipps" URI...
+    if (httpAddrIsLocalhost(httpGetAddress(client->http)) || (client->system->options & PAPPL_SOPTIONS_NO_TLS))
     {
-      driver_data.quality_default = (ipp_quality_t)ippGetInteger(rattr, 0);
-      do_defaults = true;
+      ippAddString(ipp, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "uri-authentication-supported", NULL, "none");
     }
-    else if (!strcmp(name, "print-scaling-default"))
+    else if (papplSystemGetTLSOnly(client->system))
     {
-      driver_data.scaling_default = _papplScalingValue(ippGetString(rattr, 0, NULL));
-      do_defaults = true;
+      if (papplSystemGetAuthService(client->system))
+        ippAddString(ipp, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "uri-authentication-supported", NULL, "basic");
+      else
+        ippAddString(ipp, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "uri-authentication-supported", NULL, "none");
     }
-    else if (!strcmp(name, "print-speed-default"))
+    else if (papplSystemGetAuthService(client->system))
     {
-      driver_data.speed_default = ippGetInteger(rattr, 0);
-      do_defaults = true;
+      static const char * const uri_authentication_basic[] =
+      {					// uri-authentication-supported values
+	"none",
+	"basic"
+      };
+
+      ippAddStrings(ipp, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "uri-authentication-supported", 2, NULL, uri_authentication_basic);
     }
-    else if (!strcmp(name, "printer-contact-col"))
+    else
     {
-      _papplContactImport(ippGetCollection(rattr, 0), &contact);
-      do_contact = true;
+      static const char * const uri_authentication_none[] =
+      {					// uri-authentication-supported values
+	"none",
+	"none"
+      };
+
+      ippAddStrings(ipp, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "uri-authentication-supported", 2, NULL, uri_authentication_none);
     }
-    else if (!strcmp(name, "printer-darkness-configured"))
+  }
+}
+
+
+//
+// 'copy_state_attrs()' - Copy the printer state attributes.
+//
+// This function copies the attributes that change with the printer state,
+// supply levels, and current time.
+//
+
+static void
+copy_state_attrs(
+    pappl_printer_t *printer,		// I - Printer
+    pappl_client_t  *client,		// I - Client
+    cups_array_t    *ra,		// I - Requested attributes
+    const char      *webscheme)		// I - URL scheme for resources
+{
+  cups_len_t	i,			// Looping var
+		num_values;		// Number of values
+  const char	*svalues[100];		// String values
+  int		ivalues[100];		// Integer values
+
+
+  _papplPrinterCopyStateNoLock(printer, IPP_TAG_PRINTER, client->response, client, ra);
+
+  if (printer->num_supply > 0)
+  {
+    pappl_supply_t *supply = printer->supply;
+					// Supply values...
+
+    if (!ra || cupsArrayFind(ra, "marker-colors"))
     {
-      driver_data.darkness_configured = ippGetInteger(rattr, 0);
-      do_defaults = true;
+      for (i = 0; i < (cups_len_t)printer->num_supply; i ++)
+        svalues[i] = _papplMarkerColorString(supply[i].color);
+
+      ippAddStrings(client->response, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_NAME), "marker-colors", IPP_NUM_CAST printer->num_supply, NULL, svalues);
     }
-    else if (!strcmp(name, "printer-geo-location"))
+
+    if (!ra || cupsArrayFind(ra, "marker-high-levels"))
     {
-      float geo_lat, geo_lon;		// Latitude and longitude
+      for (i = 0; i < (cups_len_t)printer->num_supply; i ++)
+        ivalues[i] = supply[i].is_consumed ? 100 : 90;
 
-      geo_location = ippGetString(rattr, 0, NULL);
-      if (sscanf(geo_location, "geo:%f,%f", &geo_lat, &geo_lon) != 2 || geo_lat < -90.0 || geo_lat > 90.0 || geo_lon < -180.0 || geo_lon > 180.0)
-        papplClientRespondIPPUnsupported(client, rattr);
+      ippAddIntegers(client->response, IPP_TAG_PRINTER, IPP_TAG_INTEGER, "marker-high-levels", IPP_NUM_CAST printer->num_supply, ivalues);
     }
-    else if (!strcmp(name, "printer-location"))
+
+    if (!ra || cupsArrayFind(ra, "marker-levels"))
     {
-      location = ippGetString(rattr, 0, NULL);
+      for (i = 0; i < (cups_len_t)printer->num_supply; i ++)
+        ivalues[i] = supply[i].level;
+
+      ippAddIntegers(client->response, IPP_TAG_PRINTER, IPP_TAG_INTEGER, "marker-levels", IPP_NUM_CAST printer->num_supply, ivalues);
     }
-    else if (!strcmp(name, "printer-organization"))
+
+    if (!ra || cupsArrayFind(ra, "marker-low-levels"))
     {
-      organization = ippGetString(rattr, 0, NULL);
+      for (i = 0; i < (cups_len_t)printer->num_supply; i ++)
+        ivalues[i] = supply[i].is_consumed ? 10 : 0;
+
+      ippAddIntegers(client->response, IPP_TAG_PRINTER, IPP_TAG_INTEGER, "marker-low-levels", IPP_NUM_CAST printer->num_supply, ivalues);
     }
-    else if (!strcmp(name, "printer-organization-unit"))
+
+    if (!ra || cupsArrayFind(ra, "marker-names"))
     {
-      org_unit = ippGetString(rattr, 0, NULL);
+      for (i = 0; i < (cups_len_t)printer->num_supply; i ++)
+        svalues[i] = supply[i].description;
+
+      ippAddStrings(client->response, IPP_TAG_PRINTER, IPP_TAG_NAME, "marker-names", IPP_NUM_CAST printer->num_supply, NULL, svalues);
     }
-    else if (!strcmp(name, "printer-resolution-default"))
+
+    if (!ra || cupsArrayFind(ra, "marker-types"))
     {
-      ipp_res_t units;			// Resolution units
+      for (i = 0; i < (cups_len_t)printer->num_supply; i ++)
+        svalues[i] = _papplMarkerTypeString(supply[i].type);
 
-      driver_data.x_default = ippGetResolution(rattr, 0, &driver_data.y_default, &units);
-      do_defaults = true;
+      ippAddStrings(client->response, IPP_TAG_PRINTER, IPP_CONST_TAG(IPP_TAG_KEYWORD), "marker-types", IPP_NUM_CAST printer->num_supply, NULL, svalues);
     }
-    else if (!strcmp(name, "printer-wifi-password"))
-    {
-      void		*data;		// Password
-      cups_len_t	datalen;	// Length of password
+  }
 
-      data = ippGetOctetString(rattr, 0, &datalen);
-      if (datalen > ((int)sizeof(wifi_password) - 1))
-      {
-	papplClientRespondIPPUnsupported(client, rattr);
-	continue;
-      }
+  if (!ra || cupsArrayFind(ra, "printer-current-time"))
+    ippAddDate(client->response, IPP_TAG_PRINTER, "printer-current-time", ippTimeToDate(time(NULL)));
 
-      memcpy(wifi_password, data, datalen);
-      wifi_password[datalen] = '\0';
+//  _papplRWLockRead(client->system);
+  _papplSystemExportVersions(client->system, client->response, IPP_TAG_PRINTER, ra);
+//  _papplRWUnlock(client->system);
 
-      do_wifi = true;
-    }
-    else if (!strcmp(name, "printer-wifi-ssid"))
+  if (!ra || cupsArrayFind(ra, "printer-impressions-completed"))
+    ippAddInteger(client->response, IPP_TAG_PRINTER, IPP_TAG_INTEGER, "printer-impressions-completed", printer->impcompleted);
+
+  if (!ra || cupsArrayFind(ra, "printer-state-change-date-time"))
+    ippAddDate(client->response, IPP_TAG_PRINTER, "printer-state-change-date-time", ippTimeToDate(printer->state_time));
+
+  if (!ra || cupsArrayFind(ra, "printer-state-change-time"))
+    ippAddInteger(client->response, IPP_TAG_PRINTER, IPP_TAG_INTEGER, "printer-state-change-time", (int)(printer->state_time - printer->start_time));
+
+  if (!ra || cupsArrayFind(ra, "printer-strings-languages-supported"))
+  {
+    _pappl_resource_t	*r;		// Current resource
+    cups_len_t		rcount;		// Number of resources
+
+//    _papplRWLockRead(printer->system);
+
+    // Cannot use cupsArrayGetFirst/Last since other threads might be iterating
+    // this array...
+    for (i = 0, num_values = 0, rcount = cupsArrayGetCount(printer->system->resources); i < rcount && num_values < (cups_len_t)(sizeof(svalues) / sizeof(svalues[0])); i ++)
     {
-      papplCopyString(wifi_ssid, ippGetString(rattr, 0, NULL), sizeof(wifi_ssid));
-      do_wifi = true;
+      r = (_pappl_resource_t *)cupsArrayGetElement(printer->system->resources, (size_t)i);
+
+      if (r->language)
+        svalues[num_values ++] = r->language;
     }
-  }
+//    _papplRWUnlock(printer->system);
 
-  if (ippGetStatusCode(client->response) != IPP_STATUS_OK)
-  {
-    cupsFreeOptions(num_vendor, vendor);
-    return (false);
+    if (num_values > 0)
+      ippAddStrings(client->response, IPP_TAG_PRINTER, IPP_TAG_LANGUAGE, "printer-strings-languages-supported", IPP_NUM_CAST num_values, NULL, svalues);
   }
 
-  // Now apply changes...
-  if (do_defaults && !papplPrinterSetDriverDefaults(printer, &driver_data, (int)num_vendor, vendor))
+  if (!ra || cupsArrayFind(ra, "printer-strings-uri"))
   {
-    papplClientRespondIPP(client, IPP_STATUS_ERROR_ATTRIBUTES_OR_VALUES, "One or more attribute values were not supported.");
-    cupsFreeOptions(num_vendor, vendor);
-    return (false);
-  }
+    const char	*lang = ippGetString(ippFindAttribute(client->request, "attributes-natural-language", IPP_TAG_LANGUAGE), 0, NULL);
+					// Language
+    char	baselang[3],		// Base language
+		uri[1024];		// Strings file URI
+    _pappl_resource_t	*r;		// Current resource
+    cups_len_t	rcount;			// Number of resources
 
-  cupsFreeOptions(num_vendor, vendor);
+    papplCopyString(baselang, lang, sizeof(baselang));
 
-  if (do_ready && !papplPrinterSetReadyMedia(printer, driver_data.num_source, driver_data.media_ready))
-  {
-    papplClientRespondIPP(client, IPP_STATUS_ERROR_ATTRIBUTES_OR_VALUES, "One or more attribute values were not supported.");
-    return (false);
+//    _papplRWLockRead(printer->system);
+
+    // Cannot use cupsArrayGetFirst/Last since other threads might be iterating
+    // this array...
+    for (i = 0, rcount = cupsArrayGetCount(printer->system->resources); i < rcount; i ++)
+    {
+      r = (_pappl_resource_t *)cupsArrayGetElement(printer->system->resources, i);
+
+      if (r->language && (!strcmp(r->language, lang) || !strcmp(r->language, baselang)))
+      {
+        httpAssembleURI(HTTP_URI_CODING_ALL, uri, sizeof(uri), webscheme, NULL, client->host_field, client->host_port, r->path);
+        ippAddString(client->response, IPP_TAG_PRINTER, IPP_TAG_URI, "printer-strings-uri", NULL, uri);
+        break;
+      }
+    }
+
+//    _papplRWUnlock(printer->system);
   }
 
-  if (do_wifi)
+  if (printer->num_supply > 0)
   {
-    if (!(printer->system->wifi_join_cb)(printer->system, printer->system->wifi_cbdata, wifi_ssid, wifi_password))
+    pappl_supply_t	 *supply = printer->supply;
+					// Supply values...
+
+    if (!ra || cupsArrayFind(ra, "printer-supply"))
     {
-      papplClientRespondIPP(client, IPP_STATUS_ERROR_ATTRIBUTES_OR_VALUES, "Unable to join Wi-Fi network '%s'.", wifi_ssid);
-      return (false);
+      char		value[256];	// "printer-supply" value
+      ipp_attribute_t	*attr = NULL;	// "printer-supply" attribute
+
+      for (i = 0; i < (cups_len_t)printer->num_supply; i ++)
+      {
+	snprintf(value, sizeof(value), "index=%u;type=%s;maxcapacity=100;level=%d;colorantname=%s;", (unsigned)i, _papplSupplyTypeString(supply[i].type), supply[i].level, _papplSupplyColorString(supply[i].color));
+
+	if (attr)
+	  ippSetOctetString(client->response, &attr, ippGetCount(attr), value, IPP_NUM_CAST strlen(value));
+	else
+	  attr = ippAddOctetString(client->response, IPP_TAG_PRINTER, "printer-supply", value, IPP_NUM_CAST strlen(value));
+      }
     }
-  }
 
-  if (do_contact)
-    papplPrinterSetContact(printer, &contact);
+    if (!ra || cupsArrayFind(ra, "printer-supply-description"))
+    {
+      for (i = 0; i < (cups_len_t)printer->num_supply; i ++)
+        svalues[i] = supply[i].description;
 
-  if (geo_location)
-    papplPrinterSetGeoLocation(printer, geo_location);
+      ippAddStrings(client->response, IPP_TAG_PRINTER, IPP_TAG_TEXT, "printer-supply-description", IPP_NUM_CAST printer->num_supply, NULL, svalues);
+    }
+  }
 
-  if (location)
-    papplPrinterSetGeoLocation(printer, location);
+  if (!ra || cupsArrayFind(ra, "printer-up-time"))
+    ippAddInteger(client->response, IPP_TAG_PRINTER, IPP_TAG_INTEGER, "printer-up-time", (int)(time(NULL) - printer->start_time));
 
-  if (organization)
-    papplPrinterSetGeoLocation(printer, organization);
+  if (client->system->wifi_status_cb && httpAddrIsLocalhost(httpGetAddress(client->http)) && (!ra || cupsArrayFind(ra, "printer-wifi-ssid") || cupsArrayFind(ra, "printer-wifi-state")))
+  {
+    // Get Wi-Fi status...
+    pappl_wifi_t	wifi;		// Wi-Fi status
 
-  if (org_unit)
-    papplPrinterSetGeoLocation(printer, org_unit);
+    if ((client->system->wifi_status_cb)(client->system, client->system->wifi_cbdata, &wifi))
+    {
+      if (!ra || cupsArrayFind(ra, "printer-wifi-ssid"))
+        ippAddString(client->response, IPP_TAG_PRINTER, IPP_TAG_NAME, "printer-wifi-ssid", NULL, wifi.ssid);
 
-  papplSystemAddEvent(printer->system, printer, NULL, PAPPL_EVENT_PRINTER_CONFIG_CHANGED, NULL);
+      if (!ra || cupsArrayFind(ra, "printer-wifi-state"))
+        ippAddInteger(client->response, IPP_TAG_PRINTER, IPP_TAG_ENUM, "printer-wifi-state", (int)wifi.state);
+    }
+  }
 
-  return (true);
+  if (!ra || cupsArrayFind(ra, "queued-job-count"))
+    ippAddInteger(client->response, IPP_TAG_PRINTER, IPP_TAG_INTEGER, "queued-job-count", (int)cupsArrayGetCount(printer->active_jobs));
 }
 
 
@@ -1469,6 +1645,7 @@ ipp_get_jobs(pappl_client_t *client)	// I - Client
   ipp_jstate_t		job_state;	// job-state value
   cups_len_t		i,		// Looping var
 			limit,		// Maximum number of jobs to return
+			num_jobs,	// Number of jobs in list
 			count;		// Number of jobs that match
   const char		*username;	// Username
   cups_array_t		*list;		// Jobs list
@@ -1556,11 +1733,17 @@ ipp_get_jobs(pappl_client_t *client)	// I - Client
 
   _papplRWLockRead(client->printer);
 
-  count = cupsArrayGetCount(list);
-  if (limit == 0 || limit > count)
-    limit = count;
+  // The active jobs array is short, but there may be thousands of completed
+  // jobs so use the username index for "my-jobs"...
+  if (username && list != client->printer->active_jobs)
+    list = _papplPrinterFindUserJobsNoLock(client->printer, username);
+
+  num_jobs = cupsArrayGetCount(list);
+  if (limit == 0 || limit > num_jobs)
+    limit = num_jobs;
 
-  for (count = 0, i = 0; i < limit; i ++)
+  // Copy the first "limit" jobs that match...
+  for (count = 0, i = 0; i < num_jobs && count < limit; i ++)
   {
     job = (pappl_job_t *)cupsArrayGetElement(list, i);
 
@@ -1594,9 +1777,9 @@ ipp_get_printer_attributes(
 					// Printer
 
 
-  if (!printer->device_in_use && !printer->processing_job && (time(NULL) - printer->status_time) > 1 && printer->driver_data.status_cb)
+  if (!papplSystemGetStatusInterval(printer->system) && !printer->device_in_use && !printer->processing_job && (time(NULL) - printer->status_time) > 1 && printer->driver_data.status_cb)
   {
-    // Update printer status...
+    // Update printer status on demand since there is no status thread...
     (printer->driver_data.status_cb)(printer);
     printer->status_time = time(NULL);
   }
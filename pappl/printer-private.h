@@ -30,10 +30,61 @@
 #  include "device.h"
 
 
+//
+// Constants...
+//
+
+#  define _PAPPL_MAX_PATTRS	8	// Maximum number of cached printer attribute responses
+#  define _PAPPL_MAX_PWEB	8	// Maximum number of cached web status fragments
+#  define _PAPPL_MAX_RAW_CONNS	4	// Maximum number of raw socket connections
+#  define _PAPPL_RAW_RING	262144	// Size of raw socket stream buffer
+#  define _PAPPL_RAW_TIMEOUT	60	// Raw socket inactivity timeout in seconds
+
+
 //
 // Types and structures...
 //
 
+typedef struct _pappl_pattrs_s		// Cached printer attributes
+{
+  char			*key;			// Request key (requested attributes, format, URI host, etc.)
+  size_t		version;		// Configuration version
+  size_t		use;			// Last use (for LRU replacement)
+  ipp_t			*ipp;			// Printer, driver, and configuration attributes
+} _pappl_pattrs_t;
+
+typedef struct _pappl_phtml_s		// Cached web HTML fragment
+{
+  size_t		use;			// Use count
+  char			html[1];		// Rendered HTML
+} _pappl_phtml_t;
+
+typedef struct _pappl_pwkey_s		// Web status key
+{
+  ipp_pstate_t		state;			// "printer-state" value
+  pappl_preason_t	reasons;		// "printer-state-reasons" values
+  int			num_jobs;		// Number of active jobs
+  bool			hold_new_jobs;		// Holding new jobs?
+  bool			is_default;		// Default printer?
+  bool			is_home;		// Shown on the system home page?
+  size_t		config_version;		// Configuration version
+} _pappl_pwkey_t;
+
+typedef struct _pappl_pweb_s		// Cached web status fragment
+{
+  pappl_loc_t		*loc;			// Localization used
+  _pappl_pwkey_t	key;			// Status key
+  char			*context;		// Client context (URL prefix and CSRF token)
+  size_t		use;			// Last use (for LRU replacement)
+  _pappl_phtml_t	*html;			// Rendered HTML
+} _pappl_pweb_t;
+
+typedef struct _pappl_ujobs_s		// Jobs for a user
+{
+  char			*username;		// Username
+  cups_array_t		*jobs;			// Jobs, sorted by descending "job-id"
+} _pappl_ujobs_t;
+
 struct _pappl_printer_s			// Printer data
 {
   pthread_rwlock_t	rwlock;			// Reader/writer lock
@@ -59,27 +110,50 @@ struct _pappl_printer_s			// Printer data
 			*device_uri;		// Device URI
   pappl_device_t	*device;		// Current connection to device (if any)
   bool			device_in_use;		// Is the device in use?
+  int			device_keepalive;	// Seconds to keep an idle network device open
+  time_t		device_idle;		// Time the device became idle, if kept open
   char			*driver_name;		// Driver name
   pappl_pr_driver_data_t driver_data;		// Driver data
   ipp_t			*driver_attrs;		// Driver attributes
   int			num_ready;		// Number of ready media
   ipp_t			*attrs;			// Other (static) printer attributes
+  pthread_mutex_t	pattrs_mutex;		// Mutex for cached attributes
+  size_t		pattrs_use;		// Use counter for cached attributes
+  _pappl_pattrs_t	pattrs[_PAPPL_MAX_PATTRS];
+						// Cached attributes for Get-Printer-Attributes
+  pthread_mutex_t	pweb_mutex;		// Mutex for cached web status
+  size_t		pweb_use;		// Use counter for cached web status
+  _pappl_pweb_t		pweb[_PAPPL_MAX_PWEB];	// Cached web status fragments
+  _pappl_pwkey_t	pweb_key;		// Current web status key
+  time_t		pweb_time;		// Time web status key last changed
+  size_t		pweb_supply_version;	// Supply version of cached supplies table
+  _pappl_phtml_t	*pweb_supplies;		// Cached supplies table
   time_t		start_time;		// Startup time
   time_t		config_time;		// "printer-config-change-time" value
+  size_t		config_version;		// Configuration version, incremented on each change
   time_t		status_time;		// Last time status was updated
+  time_t		status_next;		// Next time to update status
+  int			status_failures;	// Number of consecutive status failures
+  bool			status_busy,		// Is the status thread polling the printer?
+			status_removed;		// Has the printer been removed from the status thread?
   char			*print_group;		// PAM printing group, if any
   gid_t			print_gid;		// PAM printing group ID
   int			num_supply;		// Number of "printer-supply" values
   pappl_supply_t	supply[PAPPL_MAX_SUPPLY];
 						// "printer-supply" values
+  size_t		supply_version;		// Supply version, incremented on each change
   pappl_job_t		*processing_job;	// Currently printing job, if any
+  bool			sched_queued;		// Queued in the job scheduler?
+  int			sched_busy;		// Number of job workers claiming a job
+  struct timespec	sched_time;		// Time printer was queued in the job scheduler
   bool			hold_new_jobs;		// Hold new jobs
   int			max_active_jobs,	// Maximum number of active jobs to accept
 			max_completed_jobs,	// Maximum number of completed jobs to retain in history
 			max_preserved_jobs;	// Maximum number of completed jobs to preserve in history
   cups_array_t		*active_jobs,		// Array of active jobs
 			*all_jobs,		// Array of all jobs
-			*completed_jobs;	// Array of completed jobs
+			*completed_jobs,	// Array of completed jobs
+			*user_jobs;		// Array of jobs by username
   int			next_job_id,		// Next "job-id" value
 			impcompleted;		// "printer-impressions-completed" value
   cups_array_t		*links;			// Web navigation links
@@ -98,6 +172,9 @@ struct _pappl_printer_s			// Printer data
   bool			dns_sd_collision;	// Was there a name collision?
   int			dns_sd_serial;		// DNS-SD serial number (for collisions)
   bool			raw_active;		// Raw listener active?
+  pthread_mutex_t	raw_mutex;		// Raw connection mutex
+  pthread_cond_t	raw_cond;		// Raw connection condition variable
+  int			raw_connections;	// Number of raw socket connections
   int			num_raw_listeners;	// Number of raw socket listeners
   struct pollfd		raw_listeners[2];	// Raw socket listeners
   bool			usb_active;		// USB gadget active?
@@ -119,16 +196,21 @@ extern void		*_papplPrinterRunRaw(pappl_printer_t *printer) _PAPPL_PRIVATE;
 
 extern void		*_papplPrinterRunUSB(pappl_printer_t *printer) _PAPPL_PRIVATE;
 
+extern void		_papplPrinterAddUserJobNoLock(pappl_printer_t *printer, pappl_job_t *job) _PAPPL_PRIVATE;
 extern void		_papplPrinterCheckJobs(pappl_printer_t *printer) _PAPPL_PRIVATE;
 extern void		_papplPrinterCleanJobsNoLock(pappl_printer_t *printer) _PAPPL_PRIVATE;
+extern void		_papplPrinterCloseIdleDevice(pappl_printer_t *printer, time_t curtime) _PAPPL_PRIVATE;
 extern void		_papplPrinterCopyAttributesNoLock(pappl_printer_t *printer, pappl_client_t *client, cups_array_t *ra, const char *format) _PAPPL_PRIVATE;
 extern void		_papplPrinterCopyStateNoLock(pappl_printer_t *printer, ipp_tag_t group_tag, ipp_t *ipp, pappl_client_t *client, cups_array_t *ra) _PAPPL_PRIVATE;
 extern void		_papplPrinterCopyXRINoLock(pappl_printer_t *printer, ipp_t *ipp, pappl_client_t *client) _PAPPL_PRIVATE;
 extern void		_papplPrinterDelete(pappl_printer_t *printer) _PAPPL_PRIVATE;
+extern cups_array_t	*_papplPrinterFindUserJobsNoLock(pappl_printer_t *printer, const char *username) _PAPPL_PRIVATE;
 extern void		_papplPrinterInitDriverData(pappl_pr_driver_data_t *d) _PAPPL_PRIVATE;
 extern bool		_papplPrinterIsAuthorized(pappl_client_t *client) _PAPPL_PRIVATE;
 extern void		_papplPrinterProcessIPP(pappl_client_t *client) _PAPPL_PRIVATE;
 extern bool		_papplPrinterRegisterDNSSDNoLock(pappl_printer_t *printer) _PAPPL_PRIVATE;
+extern void		_papplPrinterReleaseDeviceNoLock(pappl_printer_t *printer) _PAPPL_PRIVATE;
+extern void		_papplPrinterRemoveUserJobNoLock(pappl_printer_t *printer, pappl_job_t *job) _PAPPL_PRIVATE;
 extern bool		_papplPrinterSetAttributes(pappl_client_t *client, pappl_printer_t *printer) _PAPPL_PRIVATE;
 extern void		_papplPrinterUnregisterDNSSDNoLock(pappl_printer_t *printer) _PAPPL_PRIVATE;
 
@@ -137,6 +219,7 @@ extern void		_papplPrinterWebConfig(pappl_client_t *client, pappl_printer_t *pri
 extern void		_papplPrinterWebConfigFinalize(pappl_printer_t *printer, cups_len_t num_form, cups_option_t *form) _PAPPL_PRIVATE;
 extern void		_papplPrinterWebDefaults(pappl_client_t *client, pappl_printer_t *printer) _PAPPL_PRIVATE;
 extern void		_papplPrinterWebDelete(pappl_client_t *client, pappl_printer_t *printer) _PAPPL_PRIVATE;
+extern time_t		_papplPrinterWebGetStatusTime(pappl_printer_t *printer) _PAPPL_PRIVATE;
 extern void		_papplPrinterWebHome(pappl_client_t *client, pappl_printer_t *printer) _PAPPL_PRIVATE;
 extern void		_papplPrinterWebIteratorCallback(pappl_printer_t *printer, pappl_client_t *client) _PAPPL_PRIVATE;
 extern void		_papplPrinterWebJobs(pappl_client_t *client, pappl_printer_t *printer) _PAPPL_PRIVATE;
@@ -7,12 +7,45 @@
 // Licensed under Apache License v2.0.  See the file "LICENSE" for more
 // information.
 //
+// Each raw socket connection is handled by its own thread.  When the driver
+// supports it, print data is sent to the driver's print file callback through
+// a FIFO as it arrives, using a bounded memory buffer and spilling to a
+// temporary file when the printer cannot keep up.  Otherwise the print data is
+// spooled to disk before the job is queued.  The listener stops accepting new
+// connections when the printer has the maximum number of active jobs, leaving
+// new connections in the listen queue.
+//
 
 //
 // Include necessary headers...
 //
 
 #include "pappl-private.h"
+#if !_WIN32
+#  include <signal.h>
+#endif // !_WIN32
+
+
+//
+// Local types...
+//
+
+typedef struct _pappl_rawconn_s		// Raw socket connection
+{
+  pappl_job_t		*job;		// Print job
+  int			sock;		// Client socket
+} _pappl_rawconn_t;
+
+
+//
+// Local functions...
+//
+
+static void	*raw_connection(_pappl_rawconn_t *rc);
+static bool	raw_spool(pappl_job_t *job, int sock);
+#if !_WIN32
+static bool	raw_stream(pappl_job_t *job, int sock);
+#endif // !_WIN32
 
 
 //
@@ -80,26 +113,34 @@ void *					// O - Thread exit value
 _papplPrinterRunRaw(
     pappl_printer_t *printer)		// I - Printer
 {
-  int	i;				// Looping var
+  int			i;		// Looping var
+  pthread_attr_t	tattr;		// Thread creation attributes
+  pthread_t		tid;		// Connection thread
+  struct timespec	timeout;	// Timeout for wait
 
 
   papplLogPrinter(printer, PAPPL_LOGLEVEL_DEBUG, "Running socket print thread with %d listeners.", printer->num_raw_listeners);
 
+  pthread_attr_init(&tattr);
+  pthread_attr_setdetachstate(&tattr, PTHREAD_CREATE_DETACHED);
+
   _papplRWLockWrite(printer);
   printer->raw_active = true;
   _papplRWUnlock(printer);
 
   while (!papplPrinterIsDeleted(printer) && papplSystemIsRunning(printer->system))
   {
-    // Don't accept connections if we can't accept a new job...
-    _papplRWLockRead(printer);
-    while ((int)cupsArrayGetCount(printer->active_jobs) >= printer->max_active_jobs && !printer->is_deleted && papplSystemIsRunning(printer->system))
+    // Don't accept connections if we can't accept a new job - the clients
+    // wait in the listen queue until a job completes...
+    pthread_mutex_lock(&printer->raw_mutex);
+    while (!papplPrinterIsDeleted(printer) && papplSystemIsRunning(printer->system) && (printer->raw_connections >= _PAPPL_MAX_RAW_CONNS || papplPrinterGetNumberOfActiveJobs(printer) >= papplPrinterGetMaxActiveJobs(printer)))
     {
-      _papplRWUnlock(printer);
-      usleep(100000);
-      _papplRWLockRead(printer);
+      timeout.tv_sec  = time(NULL) + 1;
+      timeout.tv_nsec = 0;
+
+      pthread_cond_timedwait(&printer->raw_cond, &printer->raw_mutex, &timeout);
     }
-    _papplRWUnlock(printer);
+    pthread_mutex_unlock(&printer->raw_mutex);
 
     if (papplPrinterIsDeleted(printer) || !papplSystemIsRunning(printer->system))
       break;
@@ -115,15 +156,12 @@ _papplPrinterRunRaw(
       {
         if (printer->raw_listeners[i].revents & POLLIN)
         {
-          time_t	activity;	// Network activity watchdog
           int		sock;		// Client socket
           http_addr_t	sockaddr;	// Client address
           socklen_t	sockaddrlen;	// Length of client address
-          struct pollfd	sockp;		// poll() data for client socket
           pappl_job_t	*job;		// New print job
-          ssize_t	bytes;		// Bytes read from socket
-          char		buffer[8192];	// Copy buffer
-          char		filename[1024];	// Job filename
+          _pappl_rawconn_t *rc;		// Connection data
+          char		hostname[256];	// Client address string
 
           // Accept the connection...
           sockaddrlen = sizeof(sockaddr);
@@ -134,105 +172,518 @@ _papplPrinterRunRaw(
           }
 
 	  // Create a new job with default attributes...
-	  papplLogPrinter(printer, PAPPL_LOGLEVEL_INFO, "Accepted socket print connection from '%s'.", httpAddrGetString(&sockaddr, buffer, sizeof(buffer)));
+	  papplLogPrinter(printer, PAPPL_LOGLEVEL_INFO, "Accepted socket print connection from '%s'.", httpAddrGetString(&sockaddr, hostname, sizeof(hostname)));
           if ((job = _papplJobCreate(printer, 0, "guest", printer->driver_data.format ? printer->driver_data.format : "application/octet-stream", "Untitled", NULL)) == NULL)
           {
             close(sock);
             continue;
           }
 
-          // Read the print data from the socket...
-	  if ((job->fd = papplJobOpenFile(job, filename, sizeof(filename), printer->system->directory, NULL, "w")) < 0)
-	  {
-	    papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to create print file: %s", strerror(errno));
+          // Read the print data from a separate thread...
+          if ((rc = (_pappl_rawconn_t *)calloc(1, sizeof(_pappl_rawconn_t))) == NULL)
+          {
+            papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to allocate memory for socket print connection: %s", strerror(errno));
+            close(sock);
+            continue;
+          }
 
-	    goto abort_job;
-	  }
+          rc->job  = job;
+          rc->sock = sock;
 
-	  if ((job->filename = strdup(filename)) == NULL)
-	  {
-            unlink(filename);
-	    goto abort_job;
-	  }
+          pthread_mutex_lock(&printer->raw_mutex);
+          printer->raw_connections ++;
+          pthread_mutex_unlock(&printer->raw_mutex);
 
-	  papplLogJob(job, PAPPL_LOGLEVEL_DEBUG, "Created job file \"%s\", format \"%s\".", filename, job->format);
+          if (pthread_create(&tid, &tattr, (void *(*)(void *))raw_connection, rc))
+          {
+            papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to create socket print thread: %s", strerror(errno));
 
-          activity     = time(NULL);
-          sockp.fd     = sock;
-          sockp.events = POLLIN | POLLERR;
+            pthread_mutex_lock(&printer->raw_mutex);
+            printer->raw_connections --;
+            pthread_mutex_unlock(&printer->raw_mutex);
 
-          for (;;)
-          {
-	    if (papplPrinterIsDeleted(printer) || !papplSystemIsRunning(printer->system))
-	    {
-	      bytes = -1;
-	      break;
-	    }
-
-            if ((bytes = poll(&sockp, 1, 1000)) < 0)
-	    {
-	      if ((time(NULL) - activity) >= 60)
-	        break;
-	      else
-	        continue;
-	    }
-
-            activity = time(NULL);
-
-            if (sockp.revents & POLLIN)
-            {
-              if ((bytes = recv(sock, buffer, sizeof(buffer), 0)) > 0)
-                write(job->fd, buffer, (size_t)bytes);
-              else
-                break;
-            }
-            else if (sockp.revents & POLLERR)
-            {
-              bytes = -1;
-              break;
-            }
+            close(sock);
+            free(rc);
           }
+        }
+      }
+    }
+    else if (i < 0 && errno != EAGAIN)
+      break;
+  }
 
-          close(sock);
-	  close(job->fd);
-	  job->fd = -1;
+  pthread_attr_destroy(&tattr);
 
-          if (bytes < 0)
-          {
-            // Error while reading
-	    goto abort_job;
-	  }
+  // Wait for connection threads to finish...
+  pthread_mutex_lock(&printer->raw_mutex);
+  while (printer->raw_connections > 0)
+  {
+    timeout.tv_sec  = time(NULL) + 1;
+    timeout.tv_nsec = 0;
+
+    pthread_cond_timedwait(&printer->raw_cond, &printer->raw_mutex, &timeout);
+  }
+  pthread_mutex_unlock(&printer->raw_mutex);
+
+  _papplRWLockWrite(printer);
+  printer->raw_active = false;
+  _papplRWUnlock(printer);
+
+  return (NULL);
+}
 
-	  // Finish the job...
-	  job->state = IPP_JSTATE_PENDING;
 
-	  _papplPrinterCheckJobs(printer);
-	  continue;
+//
+// 'raw_connection()' - Receive a raw print job over a socket.
+//
 
-	  // Abort the job...
-	  abort_job:
+static void *				// O - Thread exit value
+raw_connection(_pappl_rawconn_t *rc)	// I - Connection data
+{
+  pappl_job_t		*job = rc->job;	// Print job
+  pappl_printer_t	*printer = job->printer;
+					// Printer
+  bool			stream;		// Stream the print data?
+  bool			ret;		// Did we receive the print data?
+#if !_WIN32
+  sigset_t		mask;		// Signal mask
+#endif // !_WIN32
+
+
+#if _WIN32
+  stream = false;
+#else
+  // Writes to a FIFO without a reader return EPIPE instead of SIGPIPE...
+  sigemptyset(&mask);
+  sigaddset(&mask, SIGPIPE);
+  pthread_sigmask(SIG_BLOCK, &mask, NULL);
+
+  // Only stream print data that goes straight to the driver...
+  _papplRWLockRead(printer);
+  stream = printer->driver_data.raw_streaming && printer->driver_data.printfile_cb && printer->driver_data.format && !strcmp(job->format, printer->driver_data.format) && !printer->hold_new_jobs;
+  _papplRWUnlock(printer);
 
-	  job->state     = IPP_JSTATE_ABORTED;
-	  job->completed = time(NULL);
+  if (stream && (_papplSystemFindMIMEFilter(printer->system, job->format, job->format) || _papplSystemFindMIMEFilter(printer->system, job->format, "image/pwg-raster")))
+    stream = false;
+#endif // _WIN32
 
-	  _papplRWLockWrite(printer);
+#if !_WIN32
+  if (stream)
+    ret = raw_stream(job, rc->sock);
+  else
+#endif // !_WIN32
+  ret = raw_spool(job, rc->sock);
+
+  close(rc->sock);
+
+  if (!ret)
+  {
+    // Abort the job...
+    job->state     = IPP_JSTATE_ABORTED;
+    job->completed = time(NULL);
+
+    _papplRWLockWrite(printer);
+
+    cupsArrayRemove(printer->active_jobs, job);
+    cupsArrayAdd(printer->completed_jobs, job);
+
+    _papplSystemNeedClean(printer->system);
+
+    _papplRWUnlock(printer);
+  }
 
-	  cupsArrayRemove(printer->active_jobs, job);
-	  cupsArrayAdd(printer->completed_jobs, job);
+  free(rc);
 
-	  _papplSystemNeedClean(printer->system);
+  pthread_mutex_lock(&printer->raw_mutex);
+  printer->raw_connections --;
+  pthread_cond_broadcast(&printer->raw_cond);
+  pthread_mutex_unlock(&printer->raw_mutex);
 
-	  _papplRWUnlock(printer);
+  return (NULL);
+}
+
+
+//
+// 'raw_spool()' - Spool the print data to a file and queue the job.
+//
+
+static bool				// O - `true` on success, `false` to abort the job
+raw_spool(pappl_job_t *job,		// I - Job
+          int         sock)		// I - Client socket
+{
+  pappl_printer_t *printer = job->printer;
+					// Printer
+  time_t	activity;		// Network activity watchdog
+  struct pollfd	sockp;			// poll() data for client socket
+  ssize_t	bytes;			// Bytes read from socket
+  char		buffer[8192];		// Copy buffer
+  char		filename[1024];		// Job filename
+
+
+  if ((job->fd = papplJobOpenFile(job, filename, sizeof(filename), printer->system->directory, NULL, "w")) < 0)
+  {
+    papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to create print file: %s", strerror(errno));
+    return (false);
+  }
+
+  papplLogJob(job, PAPPL_LOGLEVEL_DEBUG, "Created job file \"%s\", format \"%s\".", filename, job->format);
+
+  activity     = time(NULL);
+  sockp.fd     = sock;
+  sockp.events = POLLIN | POLLERR;
+
+  for (;;)
+  {
+    if (papplPrinterIsDeleted(printer) || !papplSystemIsRunning(printer->system))
+    {
+      bytes = -1;
+      break;
+    }
+
+    if ((bytes = poll(&sockp, 1, 1000)) < 0)
+    {
+      if ((time(NULL) - activity) >= _PAPPL_RAW_TIMEOUT)
+        break;
+      else
+        continue;
+    }
+
+    activity = time(NULL);
+
+    if (sockp.revents & POLLIN)
+    {
+      if ((bytes = recv(sock, buffer, sizeof(buffer), 0)) > 0)
+        write(job->fd, buffer, (size_t)bytes);
+      else
+        break;
+    }
+    else if (sockp.revents & POLLERR)
+    {
+      bytes = -1;
+      break;
+    }
+  }
+
+  close(job->fd);
+  job->fd = -1;
+
+  if (bytes < 0)
+  {
+    // Error while reading
+    unlink(filename);
+    return (false);
+  }
+
+  // Finish the job...
+  if ((job->filename = strdup(filename)) == NULL)
+  {
+    unlink(filename);
+    return (false);
+  }
+
+  job->state = IPP_JSTATE_PENDING;
+
+  _papplPrinterCheckJobs(printer);
+
+  return (true);
+}
+
+
+#if !_WIN32
+//
+// 'raw_stream()' - Stream the print data to the driver as it arrives.
+//
+// The print data is sent through a FIFO that the driver's print file callback
+// reads from.  Incoming data goes to a memory buffer of `_PAPPL_RAW_RING` bytes
+// and, when the buffer is full because the job has not started or the printer
+// is slower than the network, to a temporary spill file.  The job ends when the
+// client closes the connection or sends nothing for `_PAPPL_RAW_TIMEOUT`
+// seconds.
+//
+
+static bool				// O - `true` on success, `false` to abort the job
+raw_stream(pappl_job_t *job,		// I - Job
+           int         sock)		// I - Client socket
+{
+  pappl_printer_t *printer = job->printer;
+					// Printer
+  bool		ret = true,		// Return value
+		eof = false,		// End of print data?
+		ready;			// Is the driver about to open the FIFO?
+  ipp_jstate_t	state;			// Job state
+  unsigned char	*ring;			// Memory buffer
+  size_t	head = 0,		// Bytes added to memory buffer
+		tail = 0,		// Bytes written from memory buffer
+		offset,			// Offset in memory buffer
+		count,			// Contiguous bytes in memory buffer
+		total = 0,		// Total bytes received
+		spilled = 0;		// Total bytes spilled to disk
+  int		fifo = -1,		// FIFO for driver
+		spill = -1;		// Spill file
+  off_t		spill_in = 0,		// Bytes written to spill file
+		spill_out = 0;		// Bytes read back from spill file
+  time_t	activity;		// Network activity watchdog
+  struct timespec timeout;		// Timeout for wait
+  struct pollfd	pfds[2];		// poll() data
+  nfds_t	nfds;			// Number of poll() descriptors
+  int		sockidx,		// Index of socket in poll() data
+		fifoidx;		// Index of FIFO in poll() data
+  ssize_t	bytes;			// Bytes read/written
+  char		buffer[8192],		// Spill buffer
+		filename[1024],		// FIFO filename
+		spillname[1024];	// Spill filename
+
+
+  // Create the FIFO and buffer...
+  papplJobOpenFile(job, filename, sizeof(filename), printer->system->directory, NULL, "x");
+
+  if (mkfifo(filename, 0600))
+  {
+    papplLogJob(job, PAPPL_LOGLEVEL_WARN, "Unable to create print FIFO, spooling instead: %s", strerror(errno));
+    return (raw_spool(job, sock));
+  }
+
+  if ((ring = malloc(_PAPPL_RAW_RING)) == NULL)
+  {
+    papplLogJob(job, PAPPL_LOGLEVEL_WARN, "Unable to allocate print buffer, spooling instead: %s", strerror(errno));
+    unlink(filename);
+    return (raw_spool(job, sock));
+  }
+
+  papplLogJob(job, PAPPL_LOGLEVEL_DEBUG, "Streaming print data through \"%s\", format \"%s\".", filename, job->format);
+
+  // Queue the job so that it starts as soon as the printer is available...
+  job->streaming = true;
+
+  _papplJobSubmitFile(job, filename);
+
+  activity = time(NULL);
+
+  while (!papplPrinterIsDeleted(printer) && papplSystemIsRunning(printer->system))
+  {
+    // Stop when the job is done, whether or not the driver read everything,
+    // and abort if the job has been held or stopped...
+    if ((state = papplJobGetState(job)) >= IPP_JSTATE_CANCELED)
+    {
+      break;
+    }
+    else if (state != IPP_JSTATE_PENDING && state != IPP_JSTATE_PROCESSING)
+    {
+      papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Job is no longer pending or processing, aborting.");
+      ret = false;
+      break;
+    }
+
+    // Move spilled data back into the memory buffer as space allows...
+    while (spill_out < spill_in && (head - tail) < _PAPPL_RAW_RING)
+    {
+      offset = head % _PAPPL_RAW_RING;
+      count  = _PAPPL_RAW_RING - offset;
+
+      if (count > (_PAPPL_RAW_RING - (head - tail)))
+        count = _PAPPL_RAW_RING - (head - tail);
+      if ((off_t)count > (spill_in - spill_out))
+        count = (size_t)(spill_in - spill_out);
+
+      if ((bytes = pread(spill, ring + offset, count, spill_out)) <= 0)
+      {
+        papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to read spill file: %s", strerror(errno));
+        ret = false;
+        break;
+      }
+
+      head      += (size_t)bytes;
+      spill_out += bytes;
+    }
+
+    if (!ret)
+      break;
+
+    if (spill_out == spill_in)
+      spill_in = spill_out = 0;		// Reuse the spill file from the start
+
+    // See if the driver has opened the FIFO...
+    pthread_mutex_lock(&printer->raw_mutex);
+    ready = job->stream_ready;
+    pthread_mutex_unlock(&printer->raw_mutex);
+
+    if (fifo < 0 && ready && (fifo = open(filename, O_WRONLY | O_NONBLOCK | O_CLOEXEC)) < 0 && errno != ENXIO)
+    {
+      papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to open print FIFO: %s", strerror(errno));
+      ret = false;
+      break;
+    }
+
+    if (fifo < 0 && eof)
+    {
+      // No more print data to read, so wait for the job to start (or end).
+      // Once the driver is ready we only need to wait for it to call open()...
+      pthread_mutex_lock(&printer->raw_mutex);
+
+      clock_gettime(CLOCK_REALTIME, &timeout);
+
+      if (job->stream_ready)
+      {
+        if ((timeout.tv_nsec += 10000000) >= 1000000000)
+        {
+          timeout.tv_sec ++;
+          timeout.tv_nsec -= 1000000000;
         }
       }
+      else
+      {
+        timeout.tv_sec ++;
+      }
+
+      pthread_cond_timedwait(&printer->raw_cond, &printer->raw_mutex, &timeout);
+      pthread_mutex_unlock(&printer->raw_mutex);
+      continue;
     }
-    else if (i < 0 && errno != EAGAIN)
+
+    if (eof && fifo >= 0 && head == tail && spill_in == 0)
+      break;				// All data written
+
+    // Wait for data from the client and/or space in the FIFO...
+    nfds    = 0;
+    sockidx = fifoidx = -1;
+
+    if (!eof)
+    {
+      pfds[nfds].fd     = sock;
+      pfds[nfds].events = POLLIN;
+      sockidx           = (int)nfds ++;
+    }
+
+    if (fifo >= 0 && head > tail)
+    {
+      pfds[nfds].fd     = fifo;
+      pfds[nfds].events = POLLOUT;
+      fifoidx           = (int)nfds ++;
+    }
+
+    if ((bytes = poll(pfds, nfds, fifo < 0 && ready ? 10 : 1000)) < 0)
+    {
+      if (errno == EINTR || errno == EAGAIN)
+        continue;
+
+      papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to poll socket print connection: %s", strerror(errno));
+      ret = false;
       break;
+    }
+
+    if (sockidx >= 0 && pfds[sockidx].revents)
+    {
+      // Read print data into the memory buffer or spill file...
+      activity = time(NULL);
+
+      if (spill_in == 0 && (head - tail) < _PAPPL_RAW_RING)
+      {
+        offset = head % _PAPPL_RAW_RING;
+        count  = _PAPPL_RAW_RING - offset;
+
+        if (count > (_PAPPL_RAW_RING - (head - tail)))
+          count = _PAPPL_RAW_RING - (head - tail);
+
+        if ((bytes = recv(sock, ring + offset, count, 0)) > 0)
+          head += (size_t)bytes;
+      }
+      else
+      {
+        if (spill < 0)
+        {
+          if ((spill = papplJobOpenFile(job, spillname, sizeof(spillname), NULL, "spill", "w")) < 0)
+          {
+            papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to create spill file: %s", strerror(errno));
+            ret = false;
+            break;
+          }
+
+          unlink(spillname);		// Remove when closed
+        }
+
+        if ((bytes = recv(sock, buffer, sizeof(buffer), 0)) > 0)
+        {
+          if (pwrite(spill, buffer, (size_t)bytes, spill_in) < bytes)
+          {
+            papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to write spill file: %s", strerror(errno));
+            ret = false;
+            break;
+          }
+
+          spill_in += bytes;
+          spilled  += (size_t)bytes;
+        }
+      }
+
+      if (bytes > 0)
+        total += (size_t)bytes;
+      else if (bytes == 0)
+        eof = true;
+      else if (errno != EINTR && errno != EAGAIN)
+      {
+        papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to read socket print data: %s", strerror(errno));
+        ret = false;
+        break;
+      }
+    }
+    else if (!eof && (time(NULL) - activity) >= _PAPPL_RAW_TIMEOUT)
+    {
+      papplLogJob(job, PAPPL_LOGLEVEL_INFO, "No print data for %d seconds, ending job.", _PAPPL_RAW_TIMEOUT);
+      eof = true;
+    }
+
+    if (fifoidx >= 0 && pfds[fifoidx].revents)
+    {
+      // Write buffered data to the driver...
+      offset = tail % _PAPPL_RAW_RING;
+      count  = _PAPPL_RAW_RING - offset;
+
+      if (count > (head - tail))
+        count = head - tail;
+
+      if ((bytes = write(fifo, ring + offset, count)) > 0)
+      {
+        tail += (size_t)bytes;
+      }
+      else if (bytes < 0 && errno == EPIPE)
+      {
+        // Driver stopped reading...
+        papplLogJob(job, PAPPL_LOGLEVEL_DEBUG, "Print FIFO closed by driver.");
+        break;
+      }
+      else if (bytes < 0 && errno != EINTR && errno != EAGAIN)
+      {
+        papplLogJob(job, PAPPL_LOGLEVEL_ERROR, "Unable to write print FIFO: %s", strerror(errno));
+        ret = false;
+        break;
+      }
+    }
   }
 
-  _papplRWLockWrite(printer);
-  printer->raw_active = false;
-  _papplRWUnlock(printer);
+  if (papplPrinterIsDeleted(printer) || !papplSystemIsRunning(printer->system))
+    ret = false;
 
-  return (NULL);
+  papplLogJob(job, PAPPL_LOGLEVEL_INFO, "Received %lu bytes of document data (%lu bytes spilled to disk).", (unsigned long)total, (unsigned long)spilled);
+
+  // Make sure a driver that is waiting to open the FIFO sees the end of the
+  // data, then remove it so that nobody else tries to open it...
+  if (fifo < 0)
+    fifo = open(filename, O_WRONLY | O_NONBLOCK | O_CLOEXEC);
+
+  unlink(filename);
+
+  if (fifo >= 0)
+    close(fifo);
+
+  if (spill >= 0)
+    close(spill);
+
+  free(ring);
+
+  if (!ret)
+    papplJobCancel(job);
+
+  // The job has already been queued, so don't let the caller abort it...
+  return (true);
 }
+#endif // !_WIN32
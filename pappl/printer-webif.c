@@ -19,11 +19,16 @@
 // Local functions...
 //
 
+static _pappl_phtml_t *html_end_capture(pappl_client_t *client);
+static void	html_release(pappl_printer_t *printer, _pappl_phtml_t *html);
 static void	job_cb(pappl_job_t *job, pappl_client_t *client);
 static void	job_pager(pappl_client_t *client, pappl_printer_t *printer, int job_index, int limit);
 static char	*localize_keyword(pappl_client_t *client, const char *attrname, const char *keyword, char *buffer, size_t bufsize);
 static char	*localize_media(pappl_client_t *client, pappl_media_col_t *media, bool include_source, char *buffer, size_t bufsize);
 static void	media_chooser(pappl_client_t *client, pappl_pr_driver_data_t *driver_data, const char *title, const char *name, pappl_media_col_t *media);
+static void	status_key(pappl_printer_t *printer, _pappl_pwkey_t *key);
+static void	status_render(pappl_client_t *client, pappl_printer_t *printer, _pappl_pwkey_t *key);
+static size_t	supplies_render(pappl_client_t *client, pappl_printer_t *printer);
 static char	*time_string(pappl_client_t *client, time_t tv, char *buffer, size_t bufsize);
 
 
@@ -905,108 +910,127 @@ _papplPrinterWebHome(
 }
 
 
+//
+// '_papplPrinterWebGetStatusTime()' - Get the time the printer's web status
+//                                     last changed.
+//
+// The returned time is used for the "Last-Modified" date of pages that show
+// the printer status.
+//
+
+time_t					// O - Time of last status change
+_papplPrinterWebGetStatusTime(
+    pappl_printer_t *printer)		// I - Printer
+{
+  _pappl_pwkey_t	key;		// Current status key
+  time_t		status_time;	// Time of last status change
+
+
+  status_key(printer, &key);
+
+  pthread_mutex_lock(&printer->pweb_mutex);
+
+  if (!printer->pweb_time || memcmp(&key, &printer->pweb_key, sizeof(key)))
+  {
+    printer->pweb_key  = key;
+    printer->pweb_time = time(NULL);
+  }
+
+  status_time = printer->pweb_time;
+
+  pthread_mutex_unlock(&printer->pweb_mutex);
+
+  return (status_time);
+}
+
+
 //
 // '_papplPrinterWebIteratorCallback()' - Show the printer status.
 //
+// The rendered status only depends on the printer status and configuration,
+// the client's localization, and the URL prefix and CSRF token used for the
+// links and forms, so it is cached in the printer and replaced when any of
+// these change.
+//
 
 void
 _papplPrinterWebIteratorCallback(
     pappl_printer_t *printer,		// I - Printer
     pappl_client_t  *client)		// I - Client
 {
-  pappl_preason_t	reason,		// Current reason
-			printer_reasons;// Printer state reasons
-  ipp_pstate_t		printer_state;	// Printer state
-  int			printer_jobs;	// Number of queued jobs
-  char			state_str[8],	// State string
-			jobs_str[256],	// Number of jobs string
-			uri[256],	// Form URI
-			text[1024];	// Localized text
-
+  size_t		i;		// Looping var
+  _pappl_pwkey_t	key;		// Current status key
+  pappl_loc_t		*loc = papplClientGetLoc(client);
+					// Client localization
+  char			context[1024],	// Client context
+			token[65];	// CSRF token
+  _pappl_pweb_t		*pweb,		// Cached status
+			*pptr;		// Current cached status
+  _pappl_phtml_t	*html = NULL;	// HTML to send
 
-  printer_jobs    = papplPrinterGetNumberOfActiveJobs(printer);
-  printer_state   = papplPrinterGetState(printer);
-  printer_reasons = papplPrinterGetReasons(printer);
 
-  snprintf(uri, sizeof(uri), "%s/", printer->uriname);
+  status_key(printer, &key);
+  key.is_home = !strcmp(client->uri, "/");
 
-  if (!strcmp(client->uri, "/") && (client->system->options & PAPPL_SOPTIONS_MULTI_QUEUE))
-    papplClientHTMLPrintf(client,
-			  "          <h2 class=\"title\"><a href=\"%s/\">%s</a> <a class=\"btn\" href=\"%s://%s:%d%s/delete\">%s</a></h2>\n", printer->uriname, printer->name, _papplClientGetAuthWebScheme(client), client->host_field, client->host_port, printer->uriname, papplClientGetLocString(client, _PAPPL_LOC("Delete")));
-  else
-    papplClientHTMLPrintf(client, "          <h1 class=\"title\">%s</h1>\n", papplClientGetLocString(client, _PAPPL_LOC("Status")));
+  snprintf(context, sizeof(context), "%s://%s:%d %s", _papplClientGetAuthWebScheme(client), client->host_field, client->host_port, papplClientGetCSRFToken(client, token, sizeof(token)));
 
-  snprintf(state_str, sizeof(state_str), "%d", (int)printer_state);
-  papplLocFormatString(papplClientGetLoc(client), jobs_str, sizeof(jobs_str), printer_jobs == 1 ? _PAPPL_LOC("%d job") : _PAPPL_LOC("%d jobs"), printer_jobs);
+  // Find the cached status for the key, localization, and context, or the
+  // least recently used cache entry to replace...
+  pthread_mutex_lock(&printer->pweb_mutex);
 
-  papplClientHTMLPrintf(client,
-			"          <p><img class=\"%s\" src=\"%s/icon-md.png\">%s, %s", ippEnumString("printer-state", (int)printer_state), printer->uriname, localize_keyword(client, "printer-state", state_str, text, sizeof(text)), jobs_str);
-  if ((printer->system->options & PAPPL_SOPTIONS_MULTI_QUEUE) && printer->printer_id == printer->system->default_printer_id)
-    papplClientHTMLPrintf(client, ", %s", papplClientGetLocString(client, _PAPPL_LOC("default printer")));
-  if (printer->hold_new_jobs)
-    papplClientHTMLPrintf(client, ", %s", papplClientGetLocString(client, _PAPPL_LOC("holding new jobs")));
-  for (reason = PAPPL_PREASON_OTHER; reason <= PAPPL_PREASON_TONER_LOW; reason *= 2)
+  for (i = 0, pweb = NULL, pptr = printer->pweb; i < _PAPPL_MAX_PWEB; i ++, pptr ++)
   {
-    if (printer_reasons & reason)
-      papplClientHTMLPrintf(client, ", %s", localize_keyword(client, "printer-state-reasons", _papplPrinterReasonString(reason), text, sizeof(text)));
+    if (pptr->html && pptr->loc == loc && !memcmp(&pptr->key, &key, sizeof(key)) && !strcmp(pptr->context, context))
+    {
+      pweb = pptr;
+      break;
+    }
+    else if (!pweb || (pweb->html && (!pptr->html || pptr->use < pweb->use)))
+    {
+      pweb = pptr;
+    }
   }
 
-  if (strcmp(printer->name, printer->driver_data.make_and_model))
-    papplClientHTMLPrintf(client, ".<br>%s</p>\n", printer->driver_data.make_and_model);
-  else
-    papplClientHTMLPuts(client, ".</p>\n");
+  if (i >= _PAPPL_MAX_PWEB && _papplClientHTMLStartCapture(client))
+  {
+    // Render the status for the cache...
+    status_render(client, printer, &key);
 
-  papplClientHTMLPuts(client, "          <div class=\"btn\">");
-  _papplClientHTMLPutLinks(client, printer->links, PAPPL_LOPTIONS_STATUS);
+    if (pweb->html && -- pweb->html->use == 0)
+      free(pweb->html);
 
-  if (!printer->hold_new_jobs && papplPrinterGetMaxActiveJobs(printer) != 1)
-  {
-    papplClientHTMLStartForm(client, uri, false);
-    papplClientHTMLPrintf(client, "<input type=\"hidden\" name=\"action\" value=\"hold-new-jobs\"><input type=\"submit\" value=\"%s\"></form>", papplClientGetLocString(client, _PAPPL_LOC("Hold New Jobs")));
-  }
+    free(pweb->context);
 
-  if (printer->driver_data.identify_supported)
-  {
-    papplClientHTMLStartForm(client, uri, false);
-    papplClientHTMLPrintf(client, "<input type=\"hidden\" name=\"action\" value=\"identify-printer\"><input type=\"submit\" value=\"%s\"></form>", papplClientGetLocString(client, _PAPPL_LOC("Identify Printer")));
+    pweb->loc     = loc;
+    pweb->key     = key;
+    pweb->html    = html_end_capture(client);
+    pweb->context = pweb->html ? strdup(context) : NULL;
+
+    if (!pweb->context && pweb->html)
+    {
+      free(pweb->html);
+      pweb->html = NULL;
+    }
   }
 
-  if (printer->driver_data.testpage_cb)
+  if ((html = pweb->html) != NULL)
   {
-    papplClientHTMLStartForm(client, uri, false);
-    papplClientHTMLPrintf(client, "<input type=\"hidden\" name=\"action\" value=\"print-test-page\"><input type=\"submit\" value=\"%s\"></form>", papplClientGetLocString(client, _PAPPL_LOC("Print Test Page")));
+    pweb->use = ++ printer->pweb_use;
+    html->use ++;
   }
 
-  if (printer->hold_new_jobs && papplPrinterGetMaxActiveJobs(printer) != 1)
+  pthread_mutex_unlock(&printer->pweb_mutex);
+
+  // Send the status without holding the mutex...
+  if (html)
   {
-    papplClientHTMLStartForm(client, uri, false);
-    papplClientHTMLPrintf(client, "<input type=\"hidden\" name=\"action\" value=\"release-held-new-jobs\"><input type=\"submit\" value=\"%s\"></form>", papplClientGetLocString(client, _PAPPL_LOC("Release Held New Jobs")));
+    papplClientHTMLPuts(client, html->html);
+    html_release(printer, html);
   }
-
-  if (printer->system->options & PAPPL_SOPTIONS_MULTI_QUEUE)
+  else
   {
-    if (printer->state == IPP_PSTATE_STOPPED)
-    {
-      papplClientHTMLStartForm(client, uri, false);
-      papplClientHTMLPrintf(client, "<input type=\"hidden\" name=\"action\" value=\"resume-printer\"><input type=\"submit\" value=\"%s\"></form>", papplClientGetLocString(client, _PAPPL_LOC("Resume Printing")));
-    }
-    else
-    {
-      papplClientHTMLStartForm(client, uri, false);
-      papplClientHTMLPrintf(client, "<input type=\"hidden\" name=\"action\" value=\"pause-printer\"><input type=\"submit\" value=\"%s\"></form>", papplClientGetLocString(client, _PAPPL_LOC("Pause Printing")));
-    }
-
-    if (printer->printer_id != printer->system->default_printer_id)
-    {
-      papplClientHTMLStartForm(client, uri, false);
-      papplClientHTMLPrintf(client, "<input type=\"hidden\" name=\"action\" value=\"set-as-default\"><input type=\"submit\" value=\"%s\"></form>", papplClientGetLocString(client, _PAPPL_LOC("Set as Default")));
-    }
+    status_render(client, printer, &key);
   }
-
-  if (strcmp(client->uri, "/") && (client->system->options & PAPPL_SOPTIONS_MULTI_QUEUE))
-    papplClientHTMLPrintf(client, " <a class=\"btn\" href=\"%s://%s:%d%s/delete\">%s</a>", _papplClientGetAuthWebScheme(client), client->host_field, client->host_port, printer->uriname, papplClientGetLocString(client, _PAPPL_LOC("Delete Printer")));
-
-  papplClientHTMLPuts(client, "<br clear=\"all\"></div>\n");
 }
 
 
@@ -1377,57 +1401,95 @@ _papplPrinterWebSupplies(
     pappl_client_t  *client,		// I - Client
     pappl_printer_t *printer)		// I - Printer
 {
-  int		i,			// Looping var
-		num_supply;		// Number of supplies
-  pappl_supply_t supply[100];		// Supplies
-  static const char * const backgrounds[] =
+  size_t		supply_version;	// Supply version
+  _pappl_phtml_t	*html;		// Supplies table HTML
+
+
+  // The supplies table only changes with the supply levels, so use the cached
+  // copy when possible...
+  _papplRWLockRead(printer);
+  supply_version = printer->supply_version;
+  _papplRWUnlock(printer);
+
+  pthread_mutex_lock(&printer->pweb_mutex);
+
+  if ((!printer->pweb_supplies || printer->pweb_supply_version != supply_version) && _papplClientHTMLStartCapture(client))
   {
-    "url(data:image/png;base64,"
-      "iVBORw0KGgoAAAANSUhEUgAAAAwAAAAMCAYAAABWdVznAAAAAXNSR0IArs4c"
-      "6QAAAERlWElmTU0AKgAAAAgAAYdpAAQAAAABAAAAGgAAAAAAA6ABAAMAAAAB"
-      "AAEAAKACAAQAAAABAAAADKADAAQAAAABAAAADAAAAAATDPpdAAAAaUlEQVQo"
-      "FY2R0Q3AIAhEa7siCet0HeKQtGeiwWKR+wH0HWAsRKTHK2ZGWEpExvmJLAuD"
-      "LbXWNgHFV7Zzv2sTemHjCsYmS8MfjIbOEMHOsIMnQwYehiwMw6WqNxKr6F/c"
-      "oyMYm0yGHYwtHq4fKZD9DnawAAAAAElFTkSuQmCC)",
-					// no-color
-    "#222",				// black - not 100% black for dark mode UI
-    "#0FF",				// cyan
-    "#777",				// gray
-    "#0C0",				// green
-    "#7FF",				// light-cyan
-    "#CCC",				// light-gray
-    "#FCF",				// light-magenta
-    "#F0F",				// magenta
-    "#F70",				// orange
-    "#707",				// violet
-    "#FF0"				// yellow
-  };
+    printer->pweb_supply_version = supplies_render(client, printer);
 
+    if (printer->pweb_supplies && -- printer->pweb_supplies->use == 0)
+      free(printer->pweb_supplies);
+
+    printer->pweb_supplies = html_end_capture(client);
+  }
 
-  num_supply = papplPrinterGetSupplies(printer, (int)(sizeof(supply) / sizeof(supply[0])), supply);
+  if ((html = printer->pweb_supplies) != NULL)
+    html->use ++;
+
+  pthread_mutex_unlock(&printer->pweb_mutex);
 
   papplClientHTMLPrinterHeader(client, printer, _PAPPL_LOC("Supplies"), 0, NULL, NULL);
 
-  papplClientHTMLPuts(client,
-		      "          <table class=\"meter\" summary=\"Supplies\">\n"
-		      "            <thead>\n"
-		      "              <tr><th></th><td></td><td></td><td></td><td></td></tr>\n"
-		      "            </thead>\n"
-		      "            <tbody>\n");
+  if (html)
+  {
+    papplClientHTMLPuts(client, html->html);
+    html_release(printer, html);
+  }
+  else
+  {
+    supplies_render(client, printer);
+  }
 
-  for (i = 0; i < num_supply; i ++)
+  papplClientHTMLPrinterFooter(client);
+}
+
+
+//
+// 'html_end_capture()' - Stop capturing HTML output for the cache.
+//
+// The returned fragment has a use count of 1 for the cache's reference.
+//
+
+static _pappl_phtml_t *			// O - Cached HTML fragment or `NULL` on error
+html_end_capture(
+    pappl_client_t *client)		// I - Client
+{
+  char			*capture;	// Captured HTML
+  size_t		caplen;		// Length of captured HTML
+  _pappl_phtml_t	*html;		// Cached HTML fragment
+
+
+  if ((capture = _papplClientHTMLEndCapture(client)) == NULL)
+    return (NULL);
+
+  caplen = strlen(capture);
+
+  if ((html = (_pappl_phtml_t *)malloc(sizeof(_pappl_phtml_t) + caplen)) != NULL)
   {
-    papplClientHTMLPrintf(client, "<tr><th>%s</th><td colspan=\"4\"><span class=\"bar\" style=\"background: %s; padding: 0px %.1f%%;\" title=\"%d%%\"></span><span class=\"bar\" style=\"background: transparent; padding: 0px %.1f%%;\" title=\"%d%%\"></span></td></tr>\n", supply[i].description, backgrounds[supply[i].color], supply[i].level * 0.5, supply[i].level, 50.0 - supply[i].level * 0.5, supply[i].level);
+    html->use = 1;
+    memcpy(html->html, capture, caplen + 1);
   }
 
-  papplClientHTMLPuts(client,
-                      "            </tbody>\n"
-                      "            <tfoot>\n"
-                      "              <tr><th></th><td></td><td></td><td></td><td></td></tr>\n"
-                      "            </tfoot>\n"
-                      "          </table>\n");
+  free(capture);
 
-  papplClientHTMLPrinterFooter(client);
+  return (html);
+}
+
+
+//
+// 'html_release()' - Release a cached HTML fragment.
+//
+
+static void
+html_release(pappl_printer_t *printer,	// I - Printer
+             _pappl_phtml_t  *html)	// I - Cached HTML fragment
+{
+  pthread_mutex_lock(&printer->pweb_mutex);
+
+  if (-- html->use == 0)
+    free(html);
+
+  pthread_mutex_unlock(&printer->pweb_mutex);
 }
 
 
@@ -1822,6 +1884,200 @@ media_chooser(
 }
 
 
+//
+// 'status_key()' - Get the current web status key for a printer.
+//
+// The key uses the cached printer state and does not poll the printer for its
+// current status.
+//
+
+static void
+status_key(pappl_printer_t *printer,	// I - Printer
+           _pappl_pwkey_t  *key)	// O - Status key
+{
+  // Clear the whole key so that it can be compared using memcmp...
+  memset(key, 0, sizeof(_pappl_pwkey_t));
+
+  _papplRWLockRead(printer);
+
+  key->state          = printer->state;
+  key->reasons        = printer->state_reasons;
+  key->num_jobs       = (int)cupsArrayGetCount(printer->active_jobs);
+  key->hold_new_jobs  = printer->hold_new_jobs;
+  key->is_default     = (printer->system->options & PAPPL_SOPTIONS_MULTI_QUEUE) && printer->printer_id == printer->system->default_printer_id;
+  key->config_version = printer->config_version;
+
+  _papplRWUnlock(printer);
+}
+
+
+//
+// 'status_render()' - Show the printer status.
+//
+
+static void
+status_render(pappl_client_t  *client,	// I - Client
+              pappl_printer_t *printer,	// I - Printer
+              _pappl_pwkey_t  *key)	// I - Status key
+{
+  pappl_preason_t	reason;		// Current reason
+  char			uri[256],	// Form URI
+			state_str[8],	// State string
+			jobs_str[256],	// Number of jobs string
+			text[1024];	// Localized text
+
+
+  snprintf(uri, sizeof(uri), "%s/", printer->uriname);
+
+  if (key->is_home && (client->system->options & PAPPL_SOPTIONS_MULTI_QUEUE))
+    papplClientHTMLPrintf(client,
+			  "          <h2 class=\"title\"><a href=\"%s/\">%s</a> <a class=\"btn\" href=\"%s://%s:%d%s/delete\">%s</a></h2>\n", printer->uriname, printer->name, _papplClientGetAuthWebScheme(client), client->host_field, client->host_port, printer->uriname, papplClientGetLocString(client, _PAPPL_LOC("Delete")));
+  else
+    papplClientHTMLPrintf(client, "          <h1 class=\"title\">%s</h1>\n", papplClientGetLocString(client, _PAPPL_LOC("Status")));
+
+  snprintf(state_str, sizeof(state_str), "%d", (int)key->state);
+  papplLocFormatString(papplClientGetLoc(client), jobs_str, sizeof(jobs_str), key->num_jobs == 1 ? _PAPPL_LOC("%d job") : _PAPPL_LOC("%d jobs"), key->num_jobs);
+
+  papplClientHTMLPrintf(client,
+			"          <p><img class=\"%s\" src=\"%s/icon-md.png\">%s, %s", ippEnumString("printer-state", (int)key->state), printer->uriname, localize_keyword(client, "printer-state", state_str, text, sizeof(text)), jobs_str);
+  if (key->is_default)
+    papplClientHTMLPrintf(client, ", %s", papplClientGetLocString(client, _PAPPL_LOC("default printer")));
+  if (key->hold_new_jobs)
+    papplClientHTMLPrintf(client, ", %s", papplClientGetLocString(client, _PAPPL_LOC("holding new jobs")));
+  for (reason = PAPPL_PREASON_OTHER; reason <= PAPPL_PREASON_TONER_LOW; reason *= 2)
+  {
+    if (key->reasons & reason)
+      papplClientHTMLPrintf(client, ", %s", localize_keyword(client, "printer-state-reasons", _papplPrinterReasonString(reason), text, sizeof(text)));
+  }
+
+  if (strcmp(printer->name, printer->driver_data.make_and_model))
+    papplClientHTMLPrintf(client, ".<br>%s</p>\n", printer->driver_data.make_and_model);
+  else
+    papplClientHTMLPuts(client, ".</p>\n");
+
+  papplClientHTMLPuts(client, "          <div class=\"btn\">");
+  _papplClientHTMLPutLinks(client, printer->links, PAPPL_LOPTIONS_STATUS);
+
+  if (!key->hold_new_jobs && papplPrinterGetMaxActiveJobs(printer) != 1)
+  {
+    papplClientHTMLStartForm(client, uri, false);
+    papplClientHTMLPrintf(client, "<input type=\"hidden\" name=\"action\" value=\"hold-new-jobs\"><input type=\"submit\" value=\"%s\"></form>", papplClientGetLocString(client, _PAPPL_LOC("Hold New Jobs")));
+  }
+
+  if (printer->driver_data.identify_supported)
+  {
+    papplClientHTMLStartForm(client, uri, false);
+    papplClientHTMLPrintf(client, "<input type=\"hidden\" name=\"action\" value=\"identify-printer\"><input type=\"submit\" value=\"%s\"></form>", papplClientGetLocString(client, _PAPPL_LOC("Identify Printer")));
+  }
+
+  if (printer->driver_data.testpage_cb)
+  {
+    papplClientHTMLStartForm(client, uri, false);
+    papplClientHTMLPrintf(client, "<input type=\"hidden\" name=\"action\" value=\"print-test-page\"><input type=\"submit\" value=\"%s\"></form>", papplClientGetLocString(client, _PAPPL_LOC("Print Test Page")));
+  }
+
+  if (key->hold_new_jobs && papplPrinterGetMaxActiveJobs(printer) != 1)
+  {
+    papplClientHTMLStartForm(client, uri, false);
+    papplClientHTMLPrintf(client, "<input type=\"hidden\" name=\"action\" value=\"release-held-new-jobs\"><input type=\"submit\" value=\"%s\"></form>", papplClientGetLocString(client, _PAPPL_LOC("Release Held New Jobs")));
+  }
+
+  if (printer->system->options & PAPPL_SOPTIONS_MULTI_QUEUE)
+  {
+    if (key->state == IPP_PSTATE_STOPPED)
+    {
+      papplClientHTMLStartForm(client, uri, false);
+      papplClientHTMLPrintf(client, "<input type=\"hidden\" name=\"action\" value=\"resume-printer\"><input type=\"submit\" value=\"%s\"></form>", papplClientGetLocString(client, _PAPPL_LOC("Resume Printing")));
+    }
+    else
+    {
+      papplClientHTMLStartForm(client, uri, false);
+      papplClientHTMLPrintf(client, "<input type=\"hidden\" name=\"action\" value=\"pause-printer\"><input type=\"submit\" value=\"%s\"></form>", papplClientGetLocString(client, _PAPPL_LOC("Pause Printing")));
+    }
+
+    if (!key->is_default)
+    {
+      papplClientHTMLStartForm(client, uri, false);
+      papplClientHTMLPrintf(client, "<input type=\"hidden\" name=\"action\" value=\"set-as-default\"><input type=\"submit\" value=\"%s\"></form>", papplClientGetLocString(client, _PAPPL_LOC("Set as Default")));
+    }
+  }
+
+  if (!key->is_home && (client->system->options & PAPPL_SOPTIONS_MULTI_QUEUE))
+    papplClientHTMLPrintf(client, " <a class=\"btn\" href=\"%s://%s:%d%s/delete\">%s</a>", _papplClientGetAuthWebScheme(client), client->host_field, client->host_port, printer->uriname, papplClientGetLocString(client, _PAPPL_LOC("Delete Printer")));
+
+  papplClientHTMLPuts(client, "<br clear=\"all\"></div>\n");
+}
+
+
+//
+// 'supplies_render()' - Show the printer supplies table.
+//
+
+static size_t				// O - Supply version
+supplies_render(
+    pappl_client_t  *client,		// I - Client
+    pappl_printer_t *printer)		// I - Printer
+{
+  int		i,			// Looping var
+		num_supply;		// Number of supplies
+  pappl_supply_t supply[PAPPL_MAX_SUPPLY];
+					// Supplies
+  size_t	supply_version;		// Supply version
+  static const char * const backgrounds[] =
+  {
+    "url(data:image/png;base64,"
+      "iVBORw0KGgoAAAANSUhEUgAAAAwAAAAMCAYAAABWdVznAAAAAXNSR0IArs4c"
+      "6QAAAERlWElmTU0AKgAAAAgAAYdpAAQAAAABAAAAGgAAAAAAA6ABAAMAAAAB"
+      "AAEAAKACAAQAAAABAAAADKADAAQAAAABAAAADAAAAAATDPpdAAAAaUlEQVQo"
+      "FY2R0Q3AIAhEa7siCet0HeKQtGeiwWKR+wH0HWAsRKTHK2ZGWEpExvmJLAuD"
+      "LbXWNgHFV7Zzv2sTemHjCsYmS8MfjIbOEMHOsIMnQwYehiwMw6WqNxKr6F/c"
+      "oyMYm0yGHYwtHq4fKZD9DnawAAAAAElFTkSuQmCC)",
+					// no-color
+    "#222",				// black - not 100% black for dark mode UI
+    "#0FF",				// cyan
+    "#777",				// gray
+    "#0C0",				// green
+    "#7FF",				// light-cyan
+    "#CCC",				// light-gray
+    "#FCF",				// light-magenta
+    "#F0F",				// magenta
+    "#F70",				// orange
+    "#707",				// violet
+    "#FF0"				// yellow
+  };
+
+
+  _papplRWLockRead(printer);
+
+  num_supply     = printer->num_supply;
+  supply_version = printer->supply_version;
+  memcpy(supply, printer->supply, (size_t)num_supply * sizeof(pappl_supply_t));
+
+  _papplRWUnlock(printer);
+
+  papplClientHTMLPuts(client,
+		      "          <table class=\"meter\" summary=\"Supplies\">\n"
+		      "            <thead>\n"
+		      "              <tr><th></th><td></td><td></td><td></td><td></td></tr>\n"
+		      "            </thead>\n"
+		      "            <tbody>\n");
+
+  for (i = 0; i < num_supply; i ++)
+  {
+    papplClientHTMLPrintf(client, "<tr><th>%s</th><td colspan=\"4\"><span class=\"bar\" style=\"background: %s; padding: 0px %.1f%%;\" title=\"%d%%\"></span><span class=\"bar\" style=\"background: transparent; padding: 0px %.1f%%;\" title=\"%d%%\"></span></td></tr>\n", supply[i].description, backgrounds[supply[i].color], supply[i].level * 0.5, supply[i].level, 50.0 - supply[i].level * 0.5, supply[i].level);
+  }
+
+  papplClientHTMLPuts(client,
+                      "            </tbody>\n"
+                      "            <tfoot>\n"
+                      "              <tr><th></th><td></td><td></td><td></td><td></td></tr>\n"
+                      "            </tfoot>\n"
+                      "          </table>\n");
+
+  return (supply_version);
+}
+
+
 //
 // 'time_string()' - Return the local time in hours, minutes, and seconds.
 //
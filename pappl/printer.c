@@ -70,6 +70,47 @@ papplPrinterCancelAllJobs(
 }
 
 
+//
+// '_papplPrinterCloseIdleDevice()' - Close a kept-alive device that is no
+//                                    longer needed.
+//
+// This function is called from the system housekeeping to close network
+// devices that have been idle longer than the printer's keep-alive time or
+// that have been closed by the printer.
+//
+
+void
+_papplPrinterCloseIdleDevice(
+    pappl_printer_t *printer,		// I - Printer
+    time_t          curtime)		// I - Current time
+{
+  bool	closed = false;			// Did we close the device?
+
+
+  // Most printers don't have an idle device, so check before locking...
+  if (!printer->device_idle)
+    return;
+
+  _papplRWLockWrite(printer);
+
+  if (printer->device && printer->device_idle && !printer->device_in_use && !printer->processing_job && (curtime >= (printer->device_idle + printer->device_keepalive) || !_papplDeviceIsConnected(printer->device)))
+  {
+    papplLogPrinter(printer, PAPPL_LOGLEVEL_DEBUG, "Closing idle device.");
+
+    papplDeviceClose(printer->device);
+
+    printer->device      = NULL;
+    printer->device_idle = 0;
+    closed               = true;
+  }
+
+  _papplRWUnlock(printer);
+
+  if (closed)
+    _papplDeviceAddConnectionMetrics(printer->system, 0, 0, 0, 1);
+}
+
+
 //
 // 'papplPrinterCreate()' - Create a new printer.
 //
@@ -346,6 +387,10 @@ papplPrinterCreate(
 
   // Initialize printer structure and attributes...
   pthread_rwlock_init(&printer->rwlock, NULL);
+  pthread_mutex_init(&printer->pattrs_mutex, NULL);
+  pthread_mutex_init(&printer->pweb_mutex, NULL);
+  pthread_mutex_init(&printer->raw_mutex, NULL);
+  pthread_cond_init(&printer->raw_cond, NULL);
 
   printer->system             = system;
   printer->name               = strdup(printer_name);
@@ -675,6 +720,9 @@ _papplPrinterDelete(
   }
   _papplRWUnlock(printer);
 
+  // Remove the printer from the job scheduler queue...
+  _papplJobSchedulerRemove(printer);
+
   // Close raw listener sockets...
   for (i = 0; i < printer->num_raw_listeners; i ++)
   {
@@ -708,11 +756,20 @@ _papplPrinterDelete(
   if (printer->driver_data.delete_cb)
     (printer->driver_data.delete_cb)(printer, &printer->driver_data);
 
+  // Close any kept-alive device...
+  if (printer->device)
+    papplDeviceClose(printer->device);
+
   // Delete jobs...
   cupsArrayDelete(printer->active_jobs);
   cupsArrayDelete(printer->completed_jobs);
+  cupsArrayDelete(printer->user_jobs);
   cupsArrayDelete(printer->all_jobs);
 
+  // Remove the printer metrics now that the device is closed and the jobs are
+  // gone...
+  _papplMetricsRemovePrinter(printer);
+
   // Free memory...
   free(printer->name);
   free(printer->dns_sd_name);
@@ -729,8 +786,26 @@ _papplPrinterDelete(
   ippDelete(printer->driver_attrs);
   ippDelete(printer->attrs);
 
+  for (i = 0; i < _PAPPL_MAX_PATTRS; i ++)
+  {
+    free(printer->pattrs[i].key);
+    ippDelete(printer->pattrs[i].ipp);
+  }
+
+  for (i = 0; i < _PAPPL_MAX_PWEB; i ++)
+  {
+    free(printer->pweb[i].context);
+    free(printer->pweb[i].html);
+  }
+
+  free(printer->pweb_supplies);
+
   cupsArrayDelete(printer->links);
 
+  pthread_mutex_destroy(&printer->pattrs_mutex);
+  pthread_mutex_destroy(&printer->pweb_mutex);
+  pthread_mutex_destroy(&printer->raw_mutex);
+  pthread_cond_destroy(&printer->raw_cond);
   pthread_rwlock_destroy(&printer->rwlock);
 
   free(printer);
@@ -755,9 +830,12 @@ papplPrinterDelete(
   // Deliver delete event...
   papplSystemAddEvent(system, printer, NULL, PAPPL_EVENT_PRINTER_DELETED | PAPPL_EVENT_SYSTEM_CONFIG_CHANGED, NULL);
 
+  // Wait for any status update to finish...
+  _papplStatusPollerRemove(printer);
+
   // Remove the printer from the system object...
   _papplRWLockWrite(system);
-  cupsArrayRemove(system->printers, printer);
+  _papplSystemRemovePrinterNoLock(system, printer);
   _papplRWUnlock(system);
 
   _papplSystemConfigChanged(system);
@@ -851,6 +929,38 @@ papplPrinterOpenFile(
 }
 
 
+//
+// '_papplPrinterReleaseDeviceNoLock()' - Close or keep a device after use.
+//
+// Network devices are flushed and kept open for the printer's keep-alive time
+// so that the next job can reuse the connection.  All other devices are
+// closed.  The printer's writer lock must be held when calling this function.
+//
+
+void
+_papplPrinterReleaseDeviceNoLock(
+    pappl_printer_t *printer)		// I - Printer
+{
+  if (!printer->device)
+    return;
+
+  if (printer->device_keepalive > 0 && !printer->is_deleted && _papplDeviceIsConnected(printer->device))
+  {
+    papplDeviceFlush(printer->device);
+    _papplDeviceResetMetrics(printer->device);
+
+    printer->device_idle = time(NULL);
+  }
+  else
+  {
+    papplDeviceClose(printer->device);
+
+    printer->device      = NULL;
+    printer->device_idle = 0;
+  }
+}
+
+
 //
 // 'compare_active_jobs()' - Compare two active jobs.
 //
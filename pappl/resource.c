@@ -14,6 +14,9 @@
 
 #include "pappl-private.h"
 #include <cups/dir.h>
+#ifdef HAVE_LIBZ
+#  include <zlib.h>
+#endif // HAVE_LIBZ
 
 
 //
@@ -23,7 +26,231 @@
 static void		add_resource(pappl_system_t *system, _pappl_resource_t *r);
 static int		compare_resources(_pappl_resource_t *a, _pappl_resource_t *b);
 static _pappl_resource_t *copy_resource(_pappl_resource_t *r);
+static void		free_file(_pappl_rfile_t *file);
 static void		free_resource(_pappl_resource_t *r);
+static _pappl_rfile_t	*load_file(_pappl_resource_t *r);
+static size_t		measure_gzip(const void *data, size_t length);
+
+
+//
+// '_papplResourceAddMetrics()' - Add a static resource response to the metrics.
+//
+
+void
+_papplResourceAddMetrics(
+    pappl_system_t    *system,		// I - System
+    _pappl_resource_t *r,		// I - Resource
+    size_t            length,		// I - Length of resource data
+    bool              compressed)	// I - Was the resource sent compressed?
+{
+  size_t	gzip_length;		// Compressed length
+
+
+  pthread_mutex_lock(&r->mutex);
+  gzip_length = r->gzip_length;
+  pthread_mutex_unlock(&r->mutex);
+
+  pthread_mutex_lock(&system->rmetrics_mutex);
+
+  system->rmetrics.responses ++;
+  system->rmetrics.bytes += length;
+
+  if (compressed)
+  {
+    system->rmetrics.compressed ++;
+
+    if (gzip_length > 0 && gzip_length < length)
+      system->rmetrics.saved_bytes += length - gzip_length;
+  }
+
+  pthread_mutex_unlock(&system->rmetrics_mutex);
+}
+
+
+//
+// '_papplResourceCopyMetrics()' - Copy the static resource metrics.
+//
+
+void
+_papplResourceCopyMetrics(
+    pappl_system_t   *system,		// I - System
+    pappl_rmetrics_t *metrics)		// I - Buffer for metrics data
+{
+  pthread_mutex_lock(&system->rmetrics_mutex);
+  *metrics = system->rmetrics;
+  pthread_mutex_unlock(&system->rmetrics_mutex);
+}
+
+
+//
+// '_papplResourceGetFile()' - Get the cached file data for a resource.
+//
+// This function checks the file for a resource on each call and loads it the
+// first time and whenever its size, modification time, or inode changes.
+// Files of up to `_PAPPL_RFILE_MAX` bytes are read into memory while larger
+// files are kept open and read with `_papplResourceReadFile`.  The
+// "last_modified" and "length" members of the resource are updated from the
+// file.  Each file that is returned must be released with
+// `_papplResourceReleaseFile`, so a request keeps using the same data even if
+// the file changes while it is being sent.
+//
+// `NULL` is returned if the resource does not refer to a file or the file
+// cannot be read.
+//
+
+_pappl_rfile_t *			// O - File data or `NULL` on error
+_papplResourceGetFile(
+    _pappl_resource_t *r)		// I - Resource
+{
+  _pappl_rfile_t	*file;		// File data
+  struct stat		fileinfo;	// File information
+
+
+  if (!r || !r->filename)
+    return (NULL);
+
+  pthread_mutex_lock(&r->mutex);
+
+  if ((file = r->file) != NULL && (stat(r->filename, &fileinfo) || fileinfo.st_dev != file->device || fileinfo.st_ino != file->inode || fileinfo.st_mtime != file->last_modified || (size_t)fileinfo.st_size != file->length))
+  {
+    // File has changed or is gone, drop the cached copy...
+    r->file = NULL;
+
+    if (-- file->use == 0)
+      free_file(file);
+
+    file = NULL;
+  }
+
+  if (!file && (file = load_file(r)) != NULL)
+  {
+    // Cache the new file data...
+    r->file             = file;
+    r->last_modified    = file->last_modified;
+    r->length           = file->length;
+    r->compress_checked = false;
+    r->gzip_length      = 0;
+  }
+
+  if (file)
+    file->use ++;
+
+  pthread_mutex_unlock(&r->mutex);
+
+  return (file);
+}
+
+
+//
+// '_papplResourceIsCompressible()' - Determine whether a resource should be
+//                                    sent compressed.
+//
+// Text, JavaScript, JSON, and SVG resources of at least `_PAPPL_COMPRESS_MIN`
+// bytes are compressible.  The first call for a resource compresses the data
+// once to measure the savings, and resources that do not shrink by at least
+// 10% are always sent uncompressed.
+//
+
+bool					// O - `true` to compress, `false` otherwise
+_papplResourceIsCompressible(
+    _pappl_resource_t *r,		// I - Resource
+    const void        *data,		// I - Resource data
+    size_t            length)		// I - Length of resource data
+{
+  bool	compress;			// Compress the resource?
+
+
+  if (!r || !data || r->cb)
+    return (false);
+
+  pthread_mutex_lock(&r->mutex);
+
+  if (!r->compress_checked)
+  {
+    r->compress_checked = true;
+    r->compress         = length >= _PAPPL_COMPRESS_MIN && (!strncmp(r->format, "text/", 5) || !strcmp(r->format, "application/javascript") || !strcmp(r->format, "application/json") || !strcmp(r->format, "image/svg+xml"));
+
+    if (r->compress && (r->gzip_length = measure_gzip(data, length)) > 0)
+      r->compress = r->gzip_length < (length - length / 10);
+  }
+
+  compress = r->compress;
+
+  pthread_mutex_unlock(&r->mutex);
+
+  return (compress);
+}
+
+
+//
+// '_papplResourceReadFile()' - Read data from a resource file.
+//
+// This function reads up to "bufsize" bytes starting at "offset" from a file
+// that is too large to be cached in memory.  For cached files, the data is
+// copied from memory.
+//
+
+ssize_t					// O - Number of bytes read or `-1` on error
+_papplResourceReadFile(
+    _pappl_resource_t *r,		// I - Resource
+    _pappl_rfile_t    *file,		// I - File data
+    size_t            offset,		// I - Offset in file
+    char              *buffer,		// I - Buffer
+    size_t            bufsize)		// I - Size of buffer
+{
+  ssize_t	bytes;			// Bytes read
+
+
+  if (!r || !file || !buffer || offset > file->length)
+    return (-1);
+
+  if (bufsize > (file->length - offset))
+    bufsize = file->length - offset;
+
+  if (file->fd < 0)
+  {
+    memcpy(buffer, file->data + offset, bufsize);
+    return ((ssize_t)bufsize);
+  }
+
+#if _WIN32
+  // No pread, so serialize seeking and reading with the resource mutex...
+  pthread_mutex_lock(&r->mutex);
+
+  if (lseek(file->fd, (off_t)offset, SEEK_SET) == (off_t)offset)
+    bytes = read(file->fd, buffer, (unsigned)bufsize);
+  else
+    bytes = -1;
+
+  pthread_mutex_unlock(&r->mutex);
+
+#else
+  bytes = pread(file->fd, buffer, bufsize, (off_t)offset);
+#endif // _WIN32
+
+  return (bytes);
+}
+
+
+//
+// '_papplResourceReleaseFile()' - Release file data for a resource.
+//
+
+void
+_papplResourceReleaseFile(
+    _pappl_resource_t *r,		// I - Resource
+    _pappl_rfile_t    *file)		// I - File data
+{
+  if (!r || !file)
+    return;
+
+  pthread_mutex_lock(&r->mutex);
+
+  if (-- file->use == 0)
+    free_file(file);
+
+  pthread_mutex_unlock(&r->mutex);
+}
 
 
 //
@@ -490,6 +717,8 @@ copy_resource(_pappl_resource_t *r)	// I - Resource to copy
     newr->cb            = r->cb;
     newr->cbdata        = r->cbdata;
 
+    pthread_mutex_init(&newr->mutex, NULL);
+
     if (r->filename)
       newr->filename = strdup(r->filename);
     if (r->language)
@@ -506,6 +735,20 @@ copy_resource(_pappl_resource_t *r)	// I - Resource to copy
 }
 
 
+//
+// 'free_file()' - Free the data for a resource file.
+//
+
+static void
+free_file(_pappl_rfile_t *file)		// I - File data
+{
+  if (file->fd >= 0)
+    close(file->fd);
+
+  free(file);
+}
+
+
 //
 // 'free_resource()' - Free the memory used for a resource.
 //
@@ -513,6 +756,11 @@ copy_resource(_pappl_resource_t *r)	// I - Resource to copy
 static void
 free_resource(_pappl_resource_t *r)	// I - Resource
 {
+  if (r->file && -- r->file->use == 0)
+    free_file(r->file);
+
+  pthread_mutex_destroy(&r->mutex);
+
   free(r->path);
   free(r->format);
   free(r->filename);
@@ -520,3 +768,112 @@ free_resource(_pappl_resource_t *r)	// I - Resource
 
   free(r);
 }
+
+
+//
+// 'load_file()' - Load the file for a resource.
+//
+// Files of up to `_PAPPL_RFILE_MAX` bytes are read into a private buffer so
+// that changes to the file cannot affect responses that are being sent.
+// Larger files are kept open so they can be sent through a bounded buffer
+// without keeping them in memory.  The returned file data has a use count of 1
+// for the resource.  The caller must hold the resource mutex.
+//
+
+static _pappl_rfile_t *			// O - File data or `NULL` on error
+load_file(_pappl_resource_t *r)		// I - Resource
+{
+  int			fd;		// File descriptor
+  struct stat		fileinfo;	// File information
+  _pappl_rfile_t	*file;		// File data
+  char			*bufptr;	// Pointer into file data
+  size_t		bufremaining,	// Bytes remaining
+			count;		// Bytes to read
+  ssize_t		bytes;		// Bytes read
+
+
+  if ((fd = open(r->filename, O_RDONLY | O_CLOEXEC | O_BINARY)) < 0)
+    return (NULL);
+
+  if (fstat(fd, &fileinfo) || !S_ISREG(fileinfo.st_mode) || (file = (_pappl_rfile_t *)malloc(sizeof(_pappl_rfile_t) + (fileinfo.st_size > _PAPPL_RFILE_MAX ? 0 : (size_t)fileinfo.st_size))) == NULL)
+  {
+    close(fd);
+    return (NULL);
+  }
+
+  file->use           = 1;
+  file->device        = fileinfo.st_dev;
+  file->inode         = fileinfo.st_ino;
+  file->last_modified = fileinfo.st_mtime;
+  file->length        = (size_t)fileinfo.st_size;
+
+  if (file->length > _PAPPL_RFILE_MAX)
+  {
+    // Keep large files open instead of reading them into memory...
+    file->fd = fd;
+    return (file);
+  }
+
+  file->fd = -1;
+
+  for (bufptr = file->data, bufremaining = file->length; bufremaining > 0; bufptr += bytes, bufremaining -= (size_t)bytes)
+  {
+    count = bufremaining > 65536 ? 65536 : bufremaining;
+
+    if ((bytes = read(fd, bufptr, (unsigned)count)) <= 0)
+      break;
+  }
+
+  close(fd);
+
+  if (bufremaining > 0)
+  {
+    // File was truncated while we read it...
+    free(file);
+    return (NULL);
+  }
+
+  return (file);
+}
+
+
+//
+// 'measure_gzip()' - Measure the gzip-compressed length of some data.
+//
+
+static size_t				// O - Compressed length or `0` if unknown
+measure_gzip(const void *data,		// I - Data
+             size_t     length)		// I - Length of data
+{
+#ifdef HAVE_LIBZ
+  z_stream	stream;			// Compression stream
+  Bytef		buffer[16384];		// Output buffer (discarded)
+  int		status;			// Compression status
+
+
+  memset(&stream, 0, sizeof(stream));
+
+  if (deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 31, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+    return (0);
+
+  stream.next_in  = (Bytef *)data;
+  stream.avail_in = (uInt)length;
+
+  do
+  {
+    stream.next_out  = buffer;
+    stream.avail_out = sizeof(buffer);
+  }
+  while ((status = deflate(&stream, Z_FINISH)) == Z_OK);
+
+  deflateEnd(&stream);
+
+  return (status == Z_STREAM_END ? (size_t)stream.total_out : 0);
+
+#else
+  (void)data;
+  (void)length;
+
+  return (0);
+#endif // HAVE_LIBZ
+}
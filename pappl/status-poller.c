@@ -0,0 +1,287 @@
+//
+// Printer status poller for the Printer Application Framework
+//
+// Copyright © 2023 by Michael R Sweet.
+//
+// Licensed under Apache License v2.0.  See the file "LICENSE" for more
+// information.
+//
+// The status poller calls the driver status callback for each printer from a
+// single background thread so that IPP and web requests only read the cached
+// "printer-state-reasons" and supply values.  Printers are polled at the
+// system's status interval plus some random jitter, and printers whose status
+// callback fails are polled less often until they respond again.  The poller
+// is idle until an interval is set with `papplSystemSetStatusInterval`.
+//
+
+//
+// Include necessary headers...
+//
+
+#include "pappl-private.h"
+
+
+//
+// Local functions...
+//
+
+static void	*status_poller(pappl_system_t *system);
+static time_t	status_update(pappl_printer_t *printer, int interval, time_t curtime);
+
+
+//
+// '_papplStatusPollerRemove()' - Remove a printer from the status poller.
+//
+// This function waits for any status callback for the printer to finish.  The
+// caller must not hold the system lock.
+//
+
+void
+_papplStatusPollerRemove(
+    pappl_printer_t *printer)		// I - Printer
+{
+  pappl_system_t	*system = printer->system;
+					// System
+
+
+  pthread_mutex_lock(&system->status_mutex);
+
+  printer->status_removed = true;
+
+  while (printer->status_busy)
+    pthread_cond_wait(&system->status_cond, &system->status_mutex);
+
+  pthread_mutex_unlock(&system->status_mutex);
+}
+
+
+//
+// '_papplStatusPollerStart()' - Start the printer status poller.
+//
+
+void
+_papplStatusPollerStart(
+    pappl_system_t *system)		// I - System
+{
+  pthread_mutex_lock(&system->status_mutex);
+
+  if (!system->status_running)
+  {
+    system->status_stopping = false;
+
+    if (pthread_create(&system->status_tid, NULL, (void *(*)(void *))status_poller, system))
+      papplLog(system, PAPPL_LOGLEVEL_ERROR, "Unable to create printer status thread: %s", strerror(errno));
+    else
+      system->status_running = true;
+  }
+
+  pthread_mutex_unlock(&system->status_mutex);
+}
+
+
+//
+// '_papplStatusPollerStop()' - Stop the printer status poller.
+//
+// This function waits for the status thread to exit, which may take as long as
+// a single driver status callback.
+//
+
+void
+_papplStatusPollerStop(
+    pappl_system_t *system)		// I - System
+{
+  pthread_mutex_lock(&system->status_mutex);
+
+  if (!system->status_running)
+  {
+    pthread_mutex_unlock(&system->status_mutex);
+    return;
+  }
+
+  system->status_stopping = true;
+
+  pthread_cond_broadcast(&system->status_cond);
+  pthread_mutex_unlock(&system->status_mutex);
+
+  pthread_join(system->status_tid, NULL);
+
+  pthread_mutex_lock(&system->status_mutex);
+  system->status_running = false;
+  pthread_mutex_unlock(&system->status_mutex);
+}
+
+
+//
+// 'status_poller()' - Poll the status of each printer.
+//
+
+static void *				// O - Thread exit status
+status_poller(
+    pappl_system_t *system)		// I - System
+{
+  cups_len_t		i,		// Looping var
+			count;		// Number of printers
+  cups_array_t		*due;		// Printers that are due
+  pappl_printer_t	*printer;	// Current printer
+  bool			stopping;	// Stopping the thread?
+  int			interval;	// Status interval
+  time_t		curtime,	// Current time
+			next,		// Next time for a printer
+			wakeup;		// Next time to wake up
+  struct timespec	timeout;	// Timeout for wait
+
+
+  papplLog(system, PAPPL_LOGLEVEL_DEBUG, "Starting printer status thread.");
+
+  if ((due = cupsArrayNew(NULL, NULL, NULL, 0, NULL, NULL)) == NULL)
+  {
+    papplLog(system, PAPPL_LOGLEVEL_ERROR, "Unable to allocate printer status array: %s", strerror(errno));
+    return (NULL);
+  }
+
+  pthread_mutex_lock(&system->status_mutex);
+
+  while (!system->status_stopping)
+  {
+    interval = system->status_interval;
+
+    pthread_mutex_unlock(&system->status_mutex);
+
+    curtime = time(NULL);
+    wakeup  = curtime + (interval > 0 ? interval : 60);
+
+    if (interval > 0)
+    {
+      // Find the printers that are due.  Each one is marked busy so that
+      // papplPrinterDelete waits for its status callback to finish...
+      _papplRWLockRead(system);
+      pthread_mutex_lock(&system->status_mutex);
+
+      for (i = 0, count = cupsArrayGetCount(system->printers); i < count; i ++)
+      {
+        printer = (pappl_printer_t *)cupsArrayGetElement(system->printers, i);
+
+        if (printer->is_deleted || printer->status_removed || !printer->driver_data.status_cb)
+          continue;
+
+        if (printer->status_next <= curtime)
+        {
+          printer->status_busy = true;
+          cupsArrayAdd(due, printer);
+        }
+        else if (printer->status_next < wakeup)
+        {
+          wakeup = printer->status_next;
+        }
+      }
+
+      pthread_mutex_unlock(&system->status_mutex);
+      _papplRWUnlock(system);
+
+      // Then poll them without holding the system lock...
+      for (i = 0, count = cupsArrayGetCount(due); i < count; i ++)
+      {
+        printer = (pappl_printer_t *)cupsArrayGetElement(due, i);
+
+        pthread_mutex_lock(&system->status_mutex);
+        stopping = system->status_stopping;
+        pthread_mutex_unlock(&system->status_mutex);
+
+        if (!stopping)
+        {
+          next = printer->status_next = status_update(printer, interval, curtime);
+
+          if (next < wakeup)
+            wakeup = next;
+        }
+
+        pthread_mutex_lock(&system->status_mutex);
+        printer->status_busy = false;
+        pthread_cond_broadcast(&system->status_cond);
+        pthread_mutex_unlock(&system->status_mutex);
+      }
+
+      cupsArrayClear(due);
+    }
+
+    // Wait until the next printer is due or we are told to stop...
+    pthread_mutex_lock(&system->status_mutex);
+
+    if (!system->status_stopping && wakeup > time(NULL))
+    {
+      timeout.tv_sec  = wakeup;
+      timeout.tv_nsec = 0;
+
+      pthread_cond_timedwait(&system->status_cond, &system->status_mutex, &timeout);
+    }
+  }
+
+  pthread_mutex_unlock(&system->status_mutex);
+
+  cupsArrayDelete(due);
+
+  papplLog(system, PAPPL_LOGLEVEL_DEBUG, "Printer status thread exiting.");
+
+  return (NULL);
+}
+
+
+//
+// 'status_update()' - Update the status of a printer.
+//
+// Printers that are busy are skipped.  Each consecutive failure doubles the
+// polling interval, up to `_PAPPL_STATUS_BACKOFF` seconds.
+//
+
+static time_t				// O - Next time to poll the printer
+status_update(
+    pappl_printer_t *printer,		// I - Printer
+    int             interval,		// I - Status interval in seconds
+    time_t          curtime)		// I - Current time
+{
+  bool	busy,				// Is the printer busy?
+	success;			// Did the status callback succeed?
+  int	i,				// Looping var
+	delay;				// Delay until next poll
+
+
+  _papplRWLockRead(printer);
+  busy = printer->device_in_use || printer->processing_job != NULL;
+  _papplRWUnlock(printer);
+
+  if (busy)
+    return (curtime + interval);
+
+  success = (printer->driver_data.status_cb)(printer);
+
+  _papplRWLockWrite(printer);
+
+  printer->status_time = time(NULL);
+
+  if (success)
+  {
+    if (printer->status_failures > 0)
+      papplLogPrinter(printer, PAPPL_LOGLEVEL_INFO, "Printer status is available again.");
+
+    printer->status_failures = 0;
+    delay                    = interval;
+  }
+  else
+  {
+    if (printer->status_failures == 0)
+      papplLogPrinter(printer, PAPPL_LOGLEVEL_WARN, "Unable to get printer status, retrying less often.");
+
+    printer->status_failures ++;
+
+    for (i = 0, delay = interval; i < printer->status_failures && delay < _PAPPL_STATUS_BACKOFF; i ++)
+      delay *= 2;
+
+    if (delay > _PAPPL_STATUS_BACKOFF && interval < _PAPPL_STATUS_BACKOFF)
+      delay = _PAPPL_STATUS_BACKOFF;
+  }
+
+  _papplRWUnlock(printer);
+
+  // Add up to 25% jitter so that printers don't all get polled together...
+  return (printer->status_time + delay + (time_t)(papplGetRand() % (unsigned)(delay / 4 + 1)));
+}
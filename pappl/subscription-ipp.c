@@ -329,7 +329,6 @@ _papplSubscriptionIPPGetNotifications(
   cups_len_t		i,		// Looping vars
 			count;		// Number of IDs
   int			seq_num;	// Sequence number
-  ipp_t			*event;		// Current event
   int			num_events = 0;	// Number of events returned
 
 
@@ -393,7 +392,7 @@ _papplSubscriptionIPPGetNotifications(
       }
 
       // Copy events to the output...
-      for (event = (ipp_t *)cupsArrayGetElement(sub->events, (cups_len_t)(seq_num - sub->first_sequence)); event; event = (ipp_t *)cupsArrayGetNext(sub->events))
+      for (; seq_num <= sub->last_sequence; seq_num ++)
       {
 	if (num_events == 0)
 	{
@@ -411,8 +410,8 @@ _papplSubscriptionIPPGetNotifications(
 	  ippAddSeparator(client->response);
 	}
 
-	ippCopyAttributes(client->response, event, 0, NULL, NULL);
-	num_events ++;
+	if (_papplSubscriptionCopyNotifyNoLock(sub, seq_num, client->response))
+	  num_events ++;
       }
 
       _papplRWUnlock(sub);
@@ -29,6 +29,20 @@ extern "C" {
 // Types...
 //
 
+typedef struct _pappl_notify_s		// Shared event notification
+{
+  pthread_mutex_t	mutex;			// Reference count mutex
+  size_t		refcount;		// Reference count
+  pappl_event_t		event;			// IPP "notify-events" bit value
+  bool			is_printer;		// Printer (vs. system) event?
+  char			*uri,			// "notify-printer-uri" or "notify-system-uri" value
+			*text;			// "notify-text" value, if any
+  int			job_id,			// "notify-job-id" value, if any
+			up_time;		// "printer-up-time" or "system-up-time" value
+  ipp_t			*job_attrs,		// Job attributes, if any
+			*printer_attrs;		// Printer attributes, if any
+} _pappl_notify_t;
+
 struct _pappl_subscription_s		// Subscription data
 {
   pthread_rwlock_t	rwlock;			// Reader/writer lock
@@ -48,7 +62,8 @@ struct _pappl_subscription_s		// Subscription data
 			interval;		// Notification interval
   int			first_sequence,		// First notify-sequence-number used
 			last_sequence;		// Last notify-sequence-number used
-  cups_array_t		*events;		// Events (ipp_t *'s)
+  _pappl_notify_t	*events[PAPPL_MAX_EVENTS];
+						// Event ring buffer, indexed by sequence number
   bool			is_canceled;		// Has this subscription been canceled?
 };
 
@@ -64,6 +79,11 @@ extern const char * const _papplEvents[31];
 // Functions...
 //
 
+extern _pappl_notify_t	*_papplNotifyCreate(pappl_system_t *system, pappl_printer_t *printer, pappl_job_t *job, pappl_event_t event, const char *text) _PAPPL_PRIVATE;
+extern void		_papplNotifyRelease(_pappl_notify_t *n) _PAPPL_PRIVATE;
+
+extern void		_papplSubscriptionAddNotifyNoLock(pappl_subscription_t *sub, _pappl_notify_t *n) _PAPPL_PRIVATE;
+extern bool		_papplSubscriptionCopyNotifyNoLock(pappl_subscription_t *sub, int seq_num, ipp_t *ipp) _PAPPL_PRIVATE;
 extern void		_papplSubscriptionDelete(pappl_subscription_t *sub) _PAPPL_PRIVATE;
 extern ipp_attribute_t	*_papplSubscriptionEventExport(ipp_t *ipp, const char *name, ipp_tag_t group_tag, pappl_event_t value) _PAPPL_PRIVATE;
 extern pappl_event_t	_papplSubscriptionEventImport(ipp_attribute_t *value) _PAPPL_PRIVATE;
@@ -59,6 +59,140 @@ const char * const _papplEvents[31] =
 };
 
 
+//
+// '_papplNotifyCreate()' - Create a shared event notification.
+//
+// This function creates a reference-counted event notification that is shared
+// by all of the subscriptions that receive the event.  The caller must hold a
+// lock on the printer and job, if any.  The subscription-specific attributes
+// are added when the notification is copied to a Get-Notifications response.
+//
+
+_pappl_notify_t *			// O - Notification or `NULL` on error
+_papplNotifyCreate(
+    pappl_system_t  *system,		// I - System
+    pappl_printer_t *printer,		// I - Associated printer, if any
+    pappl_job_t     *job,		// I - Associated job, if any
+    pappl_event_t   event,		// I - IPP "notify-events" bit value
+    const char      *text)		// I - "notify-text" value or `NULL` for none
+{
+  _pappl_notify_t	*n;		// Notification
+  char			uri[1024];	// "notify-printer/system-uri" value
+
+
+  if ((n = (_pappl_notify_t *)calloc(1, sizeof(_pappl_notify_t))) == NULL)
+    return (NULL);
+
+  pthread_mutex_init(&n->mutex, NULL);
+
+  n->refcount   = 1;
+  n->event      = event;
+  n->is_printer = printer != NULL;
+
+  httpAssembleURI(HTTP_URI_CODING_ALL, uri, sizeof(uri), "ipps", NULL, system->hostname, system->port, printer ? printer->resource : "/ipp/system");
+  n->uri = strdup(uri);
+
+  if (text)
+    n->text = strdup(text);
+
+  if (job)
+    n->job_id = job->job_id;
+
+  if (printer)
+    n->up_time = (int)(time(NULL) - printer->start_time);
+  else
+    n->up_time = (int)(time(NULL) - system->start_time);
+
+  if (job && (event & PAPPL_EVENT_JOB_ALL) && (n->job_attrs = ippNew()) != NULL)
+  {
+    _papplJobCopyStateNoLock(job, IPP_TAG_EVENT_NOTIFICATION, n->job_attrs, NULL);
+
+    if (event == PAPPL_EVENT_JOB_CREATED)
+    {
+      ippAddString(n->job_attrs, IPP_TAG_EVENT_NOTIFICATION, IPP_TAG_NAME, "job-name", NULL, job->name);
+      ippAddString(n->job_attrs, IPP_TAG_EVENT_NOTIFICATION, IPP_TAG_NAME, "job-originating-user-name", NULL, job->username);
+    }
+  }
+
+  if (printer && (event & PAPPL_EVENT_PRINTER_ALL) && (n->printer_attrs = ippNew()) != NULL)
+    _papplPrinterCopyStateNoLock(printer, IPP_TAG_EVENT_NOTIFICATION, n->printer_attrs, NULL, NULL);
+
+  if (!n->uri || (text && !n->text) || (job && (event & PAPPL_EVENT_JOB_ALL) && !n->job_attrs) || (printer && (event & PAPPL_EVENT_PRINTER_ALL) && !n->printer_attrs))
+  {
+    _papplNotifyRelease(n);
+    return (NULL);
+  }
+
+  return (n);
+}
+
+
+//
+// '_papplNotifyRelease()' - Release a reference to a shared event notification.
+//
+
+void
+_papplNotifyRelease(
+    _pappl_notify_t *n)			// I - Notification
+{
+  size_t	refcount;		// New reference count
+
+
+  if (!n)
+    return;
+
+  pthread_mutex_lock(&n->mutex);
+  refcount = -- n->refcount;
+  pthread_mutex_unlock(&n->mutex);
+
+  if (refcount > 0)
+    return;
+
+  pthread_mutex_destroy(&n->mutex);
+
+  free(n->uri);
+  free(n->text);
+  ippDelete(n->job_attrs);
+  ippDelete(n->printer_attrs);
+  free(n);
+}
+
+
+//
+// '_papplSubscriptionAddNotifyNoLock()' - Add a notification to a subscription.
+//
+// This function adds a reference to the shared notification to the
+// subscription's event ring buffer, replacing the oldest event when the
+// buffer is full.  The caller must hold a write lock on the subscription.
+//
+
+void
+_papplSubscriptionAddNotifyNoLock(
+    pappl_subscription_t *sub,		// I - Subscription
+    _pappl_notify_t      *n)		// I - Notification
+{
+  _pappl_notify_t	**slot;		// Ring buffer slot
+
+
+  pthread_mutex_lock(&n->mutex);
+  n->refcount ++;
+  pthread_mutex_unlock(&n->mutex);
+
+  sub->last_sequence ++;
+
+  slot = sub->events + sub->last_sequence % PAPPL_MAX_EVENTS;
+
+  if (*slot)
+  {
+    // Drop the oldest event...
+    _papplNotifyRelease(*slot);
+    sub->first_sequence ++;
+  }
+
+  *slot = n;
+}
+
+
 //
 // 'papplSubscriptionCancel()' - Cancel a subscription.
 //
@@ -74,6 +208,48 @@ papplSubscriptionCancel(
 }
 
 
+//
+// '_papplSubscriptionCopyNotifyNoLock()' - Copy a notification to an IPP message.
+//
+// This function adds the event notification attributes for the specified
+// sequence number to the IPP message.  The caller must hold a lock on the
+// subscription.
+//
+
+bool					// O - `true` on success, `false` if the event is not available
+_papplSubscriptionCopyNotifyNoLock(
+    pappl_subscription_t *sub,		// I - Subscription
+    int                  seq_num,	// I - "notify-sequence-number" value
+    ipp_t                *ipp)		// I - IPP message
+{
+  _pappl_notify_t	*n;		// Notification
+
+
+  if (seq_num < sub->first_sequence || seq_num > sub->last_sequence || (n = sub->events[seq_num % PAPPL_MAX_EVENTS]) == NULL)
+    return (false);
+
+  ippAddString(ipp, IPP_TAG_EVENT_NOTIFICATION, IPP_CONST_TAG(IPP_TAG_CHARSET), "notify-charset", NULL, "utf-8");
+  ippAddString(ipp, IPP_TAG_EVENT_NOTIFICATION, IPP_TAG_LANGUAGE, "notify-natural-language", NULL, sub->language);
+  ippAddString(ipp, IPP_TAG_EVENT_NOTIFICATION, IPP_TAG_URI, n->is_printer ? "notify-printer-uri" : "notify-system-uri", NULL, n->uri);
+  if (n->job_id)
+    ippAddInteger(ipp, IPP_TAG_EVENT_NOTIFICATION, IPP_TAG_INTEGER, "notify-job-id", n->job_id);
+  ippAddInteger(ipp, IPP_TAG_EVENT_NOTIFICATION, IPP_TAG_INTEGER, "notify-subscription-id", sub->subscription_id);
+  ippAddString(ipp, IPP_TAG_EVENT_NOTIFICATION, IPP_TAG_URI, "notify-subscription-uuid", NULL, sub->uuid);
+  ippAddInteger(ipp, IPP_TAG_EVENT_NOTIFICATION, IPP_TAG_INTEGER, "notify-sequence-number", seq_num);
+  ippAddString(ipp, IPP_TAG_EVENT_NOTIFICATION, IPP_CONST_TAG(IPP_TAG_KEYWORD), "notify-subscribed-event", NULL, _papplSubscriptionEventString(n->event));
+  if (n->text)
+    ippAddString(ipp, IPP_TAG_EVENT_NOTIFICATION, IPP_TAG_TEXT, "notify-text", NULL, n->text);
+  if (n->job_attrs)
+    ippCopyAttributes(ipp, n->job_attrs, 0, NULL, NULL);
+  if (!sub->job && n->printer_attrs)
+    ippCopyAttributes(ipp, n->printer_attrs, 0, NULL, NULL);
+  // TODO: add system event notifications
+  ippAddInteger(ipp, IPP_TAG_EVENT_NOTIFICATION, IPP_TAG_INTEGER, n->is_printer ? "printer-up-time" : "system-up-time", n->up_time);
+
+  return (true);
+}
+
+
 //
 // 'papplSubscriptionCreate()' - Create a subscription.
 //
@@ -114,6 +290,7 @@ papplSubscriptionCreate(
   sub->language        = strdup(language ? language : "en");
   sub->interval        = interval;
   sub->lease           = lease;
+  sub->first_sequence  = 1;
 
   if (lease)
     sub->expire = time(NULL) + lease;
@@ -137,17 +314,16 @@ papplSubscriptionCreate(
     ippAddInteger(sub->attrs, IPP_TAG_SUBSCRIPTION, IPP_TAG_INTEGER, "notify-job-id", job->job_id);
   else
     ippAddInteger(sub->attrs, IPP_TAG_SUBSCRIPTION, IPP_TAG_INTEGER, "notify-lease-duration", sub->lease);
-  ippAddString(sub->attrs, IPP_TAG_SUBSCRIPTION, IPP_CONST_TAG(IPP_TAG_LANGUAGE), "notify-natural-language", NULL, sub->language);
+  ippAddString(sub->attrs, IPP_TAG_SUBSCRIPTION, IPP_TAG_LANGUAGE, "notify-natural-language", NULL, sub->language);
   ippAddString(sub->attrs, IPP_TAG_SUBSCRIPTION, IPP_CONST_TAG(IPP_TAG_KEYWORD), "notify-pull-method", NULL, "ippget");
   ippAddInteger(sub->attrs, IPP_TAG_SUBSCRIPTION, IPP_TAG_INTEGER, "notify-subscription-id", sub->subscription_id);
   ippAddString(sub->attrs, IPP_TAG_SUBSCRIPTION, IPP_CONST_TAG(IPP_TAG_NAME), "notify-subscriber-user-name", NULL, sub->username);
   _papplSystemMakeUUID(system, printer ? printer->name : NULL, -sub->subscription_id, uuid, sizeof(uuid));
   ippAddString(sub->attrs, IPP_TAG_SUBSCRIPTION, IPP_TAG_URI, "notify-subscription-uuid", NULL, uuid);
+  sub->uuid = strdup(uuid);
   if (data && datalen > 0)
     ippAddOctetString(sub->attrs, IPP_TAG_SUBSCRIPTION, "notify-user-data", data, (cups_len_t)datalen);
 
-  sub->events = cupsArrayNew(NULL, NULL, NULL, 0, NULL, (cups_afree_cb_t)ippDelete);
-
   return (sub);
 }
 
@@ -160,12 +336,18 @@ void
 _papplSubscriptionDelete(
     pappl_subscription_t *sub)		// I - Subscription
 {
+  size_t	i;			// Looping var
+
+
   _papplRWLockWrite(sub);
 
   ippDelete(sub->attrs);
   free(sub->username);
   free(sub->language);
-  cupsArrayDelete(sub->events);
+  free(sub->uuid);
+
+  for (i = 0; i < PAPPL_MAX_EVENTS; i ++)
+    _papplNotifyRelease(sub->events[i]);
 
   _papplRWUnlock(sub);
   pthread_rwlock_destroy(&sub->rwlock);
@@ -33,7 +33,6 @@
 
 static bool		add_listeners(pappl_system_t *system, const char *name, int port, int family);
 static int		compare_filters(_pappl_mime_filter_t *a, _pappl_mime_filter_t *b);
-static int		compare_timers(_pappl_timer_t *a, _pappl_timer_t *b);
 static _pappl_mime_filter_t *copy_filter(_pappl_mime_filter_t *f);
 
 
@@ -217,10 +216,10 @@ papplSystemAddMIMEFilter(
 //
 // 'papplSystemAddTimerCallback()' - Add a timer callback to a system.
 //
-// This function schedules a function that will be called on the main run loop
+// This function schedules a function that will be called on the system's timer
 // thread at the specified time and optionally every "interval" seconds
-// thereafter.  The timimg accuracy is typically within a few milliseconds but
-// is not guaranteed.  Since the callback is run on the main run loop thread,
+// thereafter.  The timing accuracy is typically within 100 milliseconds but is
+// not guaranteed.  Since all timer callbacks are run on the same thread,
 // functions should create a new thread for any long-running operations.
 //
 // The callback function receives the "system" and "cb_data" pointers and
@@ -243,32 +242,12 @@ papplSystemAddTimerCallback(
     pappl_timer_cb_t cb,		// I - Callback function
     void             *cb_data)		// I - Callback data
 {
-  _pappl_timer_t	*newt;		// New timer
-
-
   // Range check input...
   if (!system || !cb || interval < 0)
     return (false);
 
-  // Allocate the new timer...
-  if ((newt = calloc(1, sizeof(_pappl_timer_t))) == NULL)
-    return (false);
-
-  _papplRWLockWrite(system);
-
-  if (!system->timers)
-    system->timers = cupsArrayNew((cups_array_cb_t)compare_timers, NULL, NULL, 0, NULL, NULL);
-
-  newt->cb       = cb;
-  newt->cb_data  = cb_data;
-  newt->next     = start ? start : time(NULL) + interval;
-  newt->interval = interval;
-
-  cupsArrayAdd(system->timers, newt);
-
-  _papplRWUnlock(system);
-
-  return (true);
+  // Add the timer to the wheel...
+  return (_papplTimerWheelAdd(system, start, interval, cb, cb_data));
 }
 
 
@@ -470,6 +449,32 @@ papplSystemGetAdminGroup(
 }
 
 
+//
+// 'papplSystemGetAuthMetrics()' - Get the authentication cache metrics.
+//
+// This function returns a copy of the authentication cache metrics, which
+// include the number of requests that used a cached PAM authentication ("hits"),
+// the number of requests that needed a full PAM authentication ("misses"), and
+// the number of cached authentications.  Successful authentications are cached
+// for five minutes and are discarded when the admin or print groups change.
+//
+// @since PAPPL 1.4@
+//
+
+pappl_ametrics_t *			// O - Metrics data
+papplSystemGetAuthMetrics(
+    pappl_system_t   *system,		// I - System
+    pappl_ametrics_t *metrics)		// I - Buffer for metrics data
+{
+  if (system && metrics)
+    _papplAuthCacheCopyMetrics(system, metrics);
+  else if (metrics)
+    memset(metrics, 0, sizeof(pappl_ametrics_t));
+
+  return (metrics);
+}
+
+
 //
 // 'papplSystemGetAuthService()' - Get the PAM authorization service, if any.
 //
@@ -485,6 +490,43 @@ papplSystemGetAuthService(
 }
 
 
+//
+// 'papplSystemGetClientMetrics()' - Get the client connection metrics.
+//
+// This function returns a copy of the client connection metrics, which include
+// the number of accepted connections and, when the client worker pool is
+// enabled with the `PAPPL_SOPTIONS_WORKER_POOL` option, the number of
+// dispatched requests, queue depth, time spent in the queue (in milliseconds),
+// and number of busy workers.
+//
+// @since PAPPL 1.4@
+//
+
+pappl_cmetrics_t *			// O - Metrics data
+papplSystemGetClientMetrics(
+    pappl_system_t   *system,		// I - System
+    pappl_cmetrics_t *metrics)		// I - Buffer for metrics data
+{
+  if (system && metrics)
+  {
+    _papplRWLockRead(system);
+    _papplClientPoolCopyMetrics(system, metrics);
+    _papplRWUnlock(system);
+
+    pthread_mutex_lock(&system->html_mutex);
+    metrics->html_flushes = system->html_flushes;
+    metrics->html_bytes   = system->html_bytes;
+    pthread_mutex_unlock(&system->html_mutex);
+  }
+  else if (metrics)
+  {
+    memset(metrics, 0, sizeof(pappl_cmetrics_t));
+  }
+
+  return (metrics);
+}
+
+
 //
 // 'papplSystemGetContact()' - Get the "system-contact" value.
 //
@@ -567,6 +609,30 @@ papplSystemGetDefaultPrintGroup(
 }
 
 
+//
+// 'papplSystemGetDeviceMetrics()' - Get the device connection metrics.
+//
+// This function returns a copy of the device connection metrics, which include
+// the number of device connections opened, reused between jobs, found stale
+// and reopened, and closed after sitting idle.
+//
+// @since PAPPL 1.4@
+//
+
+pappl_dcmetrics_t *			// O - Metrics data
+papplSystemGetDeviceMetrics(
+    pappl_system_t    *system,		// I - System
+    pappl_dcmetrics_t *metrics)		// I - Buffer for metrics data
+{
+  if (system && metrics)
+    _papplDeviceCopyConnectionMetrics(system, metrics);
+  else if (metrics)
+    memset(metrics, 0, sizeof(pappl_dcmetrics_t));
+
+  return (metrics);
+}
+
+
 //
 // 'papplSystemGetDNSSDName()' - Get the current DNS-SD service name.
 //
@@ -727,6 +793,55 @@ papplSystemGetHostPort(
 }
 
 
+//
+// 'papplSystemGetImageMetrics()' - Get the image filter metrics.
+//
+// This function returns a copy of the image filter metrics, which include the
+// number of images printed using @link papplJobFilterImageRows@, the number
+// of passes through those images, and the number of rows in those images.
+//
+// @since PAPPL 1.4@
+//
+
+pappl_imetrics_t *			// O - Metrics data
+papplSystemGetImageMetrics(
+    pappl_system_t   *system,		// I - System
+    pappl_imetrics_t *metrics)		// I - Buffer for metrics data
+{
+  if (system && metrics)
+    _papplJobFilterCopyImageMetrics(system, metrics);
+  else if (metrics)
+    memset(metrics, 0, sizeof(pappl_imetrics_t));
+
+  return (metrics);
+}
+
+
+//
+// 'papplSystemGetJobMetrics()' - Get the job scheduler metrics.
+//
+// This function returns a copy of the job scheduler metrics, which include the
+// number of jobs dispatched to workers, the number of printers waiting for a
+// worker, the time printers spent waiting (in milliseconds), and the number of
+// jobs being processed.
+//
+// @since PAPPL 1.4@
+//
+
+pappl_jmetrics_t *			// O - Metrics data
+papplSystemGetJobMetrics(
+    pappl_system_t   *system,		// I - System
+    pappl_jmetrics_t *metrics)		// I - Buffer for metrics data
+{
+  if (system && metrics)
+    _papplJobSchedulerCopyMetrics(system, metrics);
+  else if (metrics)
+    memset(metrics, 0, sizeof(pappl_jmetrics_t));
+
+  return (metrics);
+}
+
+
 //
 // 'papplSystemGetLocation()' - Get the system location string, if any.
 //
@@ -764,6 +879,34 @@ papplSystemGetLocation(
 }
 
 
+//
+// 'papplSystemGetLockStats()' - Get the lock contention statistics.
+//
+// This function copies up to "max_stats" lock call site statistics to the
+// "stats" array, sorted by the total time spent waiting for the lock.  Lock
+// statistics are only collected when PAPPL is configured with the
+// `--enable-lock-profile` option, otherwise `0` is returned.
+//
+// The statistics are collected by each thread without locking, so the values
+// are approximate.  The hold time for uncontended locks is sampled and
+// reported as an estimate.
+//
+// @since PAPPL 1.4@
+//
+
+size_t					// O - Number of lock call sites
+papplSystemGetLockStats(
+    pappl_system_t   *system,		// I - System
+    size_t           max_stats,		// I - Maximum number of lock call sites
+    pappl_lockstat_t *stats)		// I - Lock call site statistics
+{
+  if (!system || max_stats == 0 || !stats)
+    return (0);
+
+  return (_papplLockProfileCopyStats(max_stats, stats));
+}
+
+
 //
 // 'papplSystemGetLogLevel()' - Get the system log level.
 //
@@ -778,6 +921,31 @@ papplSystemGetLogLevel(
 }
 
 
+//
+// 'papplSystemGetLogMetrics()' - Get the log metrics.
+//
+// This function returns a copy of the log metrics, which include the number of
+// messages queued for writing, the number of messages dropped because the
+// queue was full, the maximum number of messages waiting to be written, and
+// the number of writes and bytes written to the log file.
+//
+// @since PAPPL 1.4@
+//
+
+pappl_lmetrics_t *			// O - Metrics data
+papplSystemGetLogMetrics(
+    pappl_system_t   *system,		// I - System
+    pappl_lmetrics_t *metrics)		// I - Buffer for metrics data
+{
+  if (system && metrics)
+    _papplLogCopyMetrics(system, metrics);
+  else if (metrics)
+    memset(metrics, 0, sizeof(pappl_lmetrics_t));
+
+  return (metrics);
+}
+
+
 //
 // 'papplSystemGetMaxClients()' - Get the maximum number of clients.
 //
@@ -856,6 +1024,33 @@ papplSystemGetMaxLogSize(
 }
 
 
+//
+// 'papplSystemGetMaxProcessingJobs()' - Get the maximum number of processing jobs.
+//
+// This function gets the maximum number of jobs that are processed at the same
+// time across all printers.
+//
+// @since PAPPL 1.4@
+//
+
+int					// O - Maximum number of processing jobs
+papplSystemGetMaxProcessingJobs(
+    pappl_system_t *system)		// I - System
+{
+  int	max_jobs = 0;			// Maximum number of processing jobs
+
+
+  if (system)
+  {
+    pthread_mutex_lock(&system->sched_mutex);
+    max_jobs = system->max_processing_jobs;
+    pthread_mutex_unlock(&system->sched_mutex);
+  }
+
+  return (max_jobs);
+}
+
+
 //
 // 'papplSystemGetMaxSubscriptions()' - Get the maximum number of event subscriptions.
 //
@@ -1061,6 +1256,55 @@ papplSystemGetPort(
 }
 
 
+//
+// 'papplSystemGetRasterMetrics()' - Get the raster processing metrics.
+//
+// This function returns a copy of the raster processing metrics, which include
+// the number of print options and line buffers that were allocated or reused
+// for raster pages.
+//
+// @since PAPPL 1.4@
+//
+
+pappl_rsmetrics_t *			// O - Metrics data
+papplSystemGetRasterMetrics(
+    pappl_system_t    *system,		// I - System
+    pappl_rsmetrics_t *metrics)		// I - Buffer for metrics data
+{
+  if (system && metrics)
+    _papplJobProcessCopyRasterMetrics(system, metrics);
+  else if (metrics)
+    memset(metrics, 0, sizeof(pappl_rsmetrics_t));
+
+  return (metrics);
+}
+
+
+//
+// 'papplSystemGetResourceMetrics()' - Get the static resource metrics.
+//
+// This function returns a copy of the static resource metrics, which include
+// the number of static and file resources sent, how many of them were sent
+// compressed, the number of uncompressed bytes sent, and an estimate of the
+// number of bytes saved by compression.
+//
+// @since PAPPL 1.4@
+//
+
+pappl_rmetrics_t *			// O - Metrics data
+papplSystemGetResourceMetrics(
+    pappl_system_t   *system,		// I - System
+    pappl_rmetrics_t *metrics)		// I - Buffer for metrics data
+{
+  if (system && metrics)
+    _papplResourceCopyMetrics(system, metrics);
+  else if (metrics)
+    memset(metrics, 0, sizeof(pappl_rmetrics_t));
+
+  return (metrics);
+}
+
+
 //
 // 'papplSystemGetServerHeader()' - Get the Server: header for HTTP responses.
 //
@@ -1120,6 +1364,34 @@ papplSystemGetSessionKey(
 }
 
 
+//
+// 'papplSystemGetStatusInterval()' - Get the printer status interval.
+//
+// This function gets the number of seconds between updates of the printer
+// status by the background status thread.  A value of `0` means that the
+// printer status is updated when it is requested.
+//
+// @since PAPPL 1.4@
+//
+
+int					// O - Status interval in seconds
+papplSystemGetStatusInterval(
+    pappl_system_t *system)		// I - System
+{
+  int	interval = 0;			// Status interval
+
+
+  if (system)
+  {
+    pthread_mutex_lock(&system->status_mutex);
+    interval = system->status_interval;
+    pthread_mutex_unlock(&system->status_mutex);
+  }
+
+  return (interval);
+}
+
+
 //
 // 'papplSystemGetTLSOnly()' - Get the TLS-only state of the system.
 //
@@ -1183,6 +1455,45 @@ papplSystemGetVersions(
 }
 
 
+//
+// 'papplSystemGetWorkerPool()' - Get the client worker pool size.
+//
+// This function returns the number of client worker threads and the maximum
+// number of queued client requests that are used when the
+// `PAPPL_SOPTIONS_WORKER_POOL` system option is specified.
+//
+// @since PAPPL 1.4@
+//
+
+size_t					// O - Number of worker threads
+papplSystemGetWorkerPool(
+    pappl_system_t *system,		// I - System
+    size_t         *max_queue)		// O - Maximum number of queued requests or `NULL` for don't care
+{
+  size_t	num_workers;		// Number of worker threads
+
+
+  if (!system)
+  {
+    if (max_queue)
+      *max_queue = 0;
+
+    return (0);
+  }
+
+  _papplRWLockRead(system);
+
+  num_workers = system->pool_workers;
+
+  if (max_queue)
+    *max_queue = system->pool_queue;
+
+  _papplRWUnlock(system);
+
+  return (num_workers);
+}
+
+
 //
 // 'papplSystemHashPassword()' - Generate a password hash using salt and password strings.
 //
@@ -1416,26 +1727,12 @@ papplSystemRemoveTimerCallback(
     pappl_timer_cb_t cb,		// I - Callback function
     void             *cb_data)		// I - Callback data
 {
-  _pappl_timer_t	*t;		// Current timer
-
-
   // Range check input...
   if (!system || !cb)
     return;
 
-  // Loop through the timers and remove any matches...
-  _papplRWLockWrite(system);
-
-  for (t = (_pappl_timer_t *)cupsArrayGetFirst(system->timers); t; t = (_pappl_timer_t *)cupsArrayGetNext(system->timers))
-  {
-    if (t->cb == cb && t->cb_data == cb_data)
-    {
-      cupsArrayRemove(system->timers, t);
-      free(t);
-    }
-  }
-
-  _papplRWUnlock(system);
+  // Remove any matching timers from the wheel...
+  _papplTimerWheelRemove(system, cb, cb_data);
 }
 
 
@@ -1480,6 +1777,8 @@ papplSystemSetAdminGroup(
     _papplSystemConfigChanged(system);
 
     _papplRWUnlock(system);
+
+    _papplAuthCacheFlush(system);
   }
 }
 
@@ -2052,6 +2351,55 @@ papplSystemSetMaxLogSize(
 }
 
 
+//
+// 'papplSystemSetMaxProcessingJobs()' - Set the maximum number of processing jobs.
+//
+// This function sets the maximum number of jobs that are processed at the same
+// time across all printers.  Each printer processes at most one job at a time,
+// and printers with pending jobs take turns when all of the job worker threads
+// are busy.
+//
+// A value of `0` selects two jobs per CPU (minimum 4, maximum 64).
+//
+// @since PAPPL 1.4@
+//
+
+void
+papplSystemSetMaxProcessingJobs(
+    pappl_system_t *system,		// I - System
+    int            max_jobs)		// I - Maximum number of processing jobs or `0` for auto
+{
+  if (!system)
+    return;
+
+  if (max_jobs <= 0)
+  {
+    // Use 2 jobs per CPU...
+#ifdef _SC_NPROCESSORS_ONLN
+    long num_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+					// Number of CPUs
+
+    if (num_cpus > 0 && num_cpus < 32)
+      max_jobs = 2 * (int)num_cpus;
+    else if (num_cpus >= 32)
+      max_jobs = 64;
+#endif // _SC_NPROCESSORS_ONLN
+
+    if (max_jobs < 4)
+      max_jobs = 4;
+  }
+
+  pthread_mutex_lock(&system->sched_mutex);
+
+  system->max_processing_jobs = max_jobs;
+
+  // Wake up idle workers so that any extras can exit...
+  pthread_cond_broadcast(&system->sched_cond);
+
+  pthread_mutex_unlock(&system->sched_mutex);
+}
+
+
 //
 // 'papplSystemSetMaxSubscriptions()' - Set the maximum number of event subscriptions.
 //
@@ -2361,6 +2709,40 @@ papplSystemSetSaveCallback(
 }
 
 
+//
+// 'papplSystemSetStatusInterval()' - Set the printer status interval.
+//
+// This function sets the number of seconds between updates of the printer
+// status.  The status of each printer is updated by a background thread so that
+// client requests never wait for the driver's status callback.  Printers that
+// fail to report their status are polled less often, up to once every 5
+// minutes, until they respond again.
+//
+// A value of `0` disables the background thread and updates the printer status
+// when it is requested, at most once per second.  The default interval is `0`.
+//
+// @since PAPPL 1.4@
+//
+
+void
+papplSystemSetStatusInterval(
+    pappl_system_t *system,		// I - System
+    int            interval)		// I - Status interval in seconds or `0` for on-demand
+{
+  if (!system || interval < 0)
+    return;
+
+  pthread_mutex_lock(&system->status_mutex);
+
+  system->status_interval = interval;
+
+  // Wake up the status thread so it uses the new interval...
+  pthread_cond_broadcast(&system->status_cond);
+
+  pthread_mutex_unlock(&system->status_mutex);
+}
+
+
 //
 // 'papplSystemSetUUID()' - Set the system UUID.
 //
@@ -2466,6 +2848,66 @@ papplSystemSetWiFiCallbacks(
 }
 
 
+//
+// 'papplSystemSetWorkerPool()' - Set the client worker pool size.
+//
+// This function sets the number of client worker threads and the maximum
+// number of queued client requests that are used when the
+// `PAPPL_SOPTIONS_WORKER_POOL` system option is specified.  With the worker
+// pool, idle keep-alive connections are monitored by a single reactor thread
+// and only connections with pending requests occupy a worker thread.
+//
+// A value of `0` for "num_workers" selects four workers per CPU (minimum 4,
+// maximum 64), while a value of `0` for "max_queue" selects 256 queued
+// requests.  When the queue is full, connections with pending requests wait
+// for queue space without holding up the reactor thread, and no new
+// connections are accepted until a worker takes a request from the queue.
+//
+// > Note: The worker pool can only be configured prior to calling
+// > @link papplSystemRun@.  The worker pool is currently only supported on
+// > Linux; other platforms always use a thread per connection.
+//
+// @since PAPPL 1.4@
+//
+
+void
+papplSystemSetWorkerPool(
+    pappl_system_t *system,		// I - System
+    size_t         num_workers,		// I - Number of worker threads or `0` for auto
+    size_t         max_queue)		// I - Maximum number of queued requests or `0` for auto
+{
+  if (!system || system->is_running)
+    return;
+
+  if (num_workers == 0)
+  {
+    // Use 4 workers per CPU...
+#ifdef _SC_NPROCESSORS_ONLN
+    long num_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+					// Number of CPUs
+
+    if (num_cpus > 0)
+      num_workers = 4 * (size_t)num_cpus;
+#endif // _SC_NPROCESSORS_ONLN
+
+    if (num_workers < 4)
+      num_workers = 4;
+    else if (num_workers > 64)
+      num_workers = 64;
+  }
+
+  if (max_queue == 0)
+    max_queue = 256;
+
+  _papplRWLockWrite(system);
+
+  system->pool_workers = num_workers;
+  system->pool_queue   = max_queue;
+
+  _papplRWUnlock(system);
+}
+
+
 //
 // 'add_listeners()' - Create and add listener sockets to a system.
 //
@@ -2549,27 +2991,6 @@ compare_filters(_pappl_mime_filter_t *a,// I - First filter
 }
 
 
-//
-// 'compare_timers()' - Compare two timers.
-//
-
-static int				// O - Result of comparison
-compare_timers(_pappl_timer_t *a,	// I - First timer
-               _pappl_timer_t *b)	// I - Second timer
-{
-  if (a->next < b->next)
-    return (-1);
-  else if (a->next > b->next)
-    return (1);
-  else if (a < b)
-    return (-1);
-  else if (a > b)
-    return (1);
-  else
-    return (0);
-}
-
-
 //
 // 'copy_filter()' - Copy a filter definition.
 //
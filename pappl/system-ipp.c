@@ -517,10 +517,13 @@ ipp_find_devices(
     pappl_client_t *client)		// I - Client
 {
   http_status_t		auth_status;	// Authorization status
-  ipp_attribute_t	*type_attr;	// "smi55357-device-type" attribute
+  ipp_attribute_t	*type_attr,	// "smi55357-device-type" attribute
+			*refresh_attr;	// "smi55357-device-refresh" attribute
   cups_len_t		i,		// Looping var
 			count;		// Number of values
   pappl_devtype_t	types;		// Device types
+  int			refresh_msecs = 0;
+					// Milliseconds to wait for a refresh
   cups_array_t		*devices;	// Device array
   _pappl_dinfo_t	*d;		// Current device information
 
@@ -586,12 +589,24 @@ ipp_find_devices(
     types = PAPPL_DEVTYPE_ALL;
   }
 
+  // Get the refresh timeout...
+  if ((refresh_attr = ippFindAttribute(client->request, "smi55357-device-refresh", IPP_TAG_ZERO)) != NULL)
+  {
+    if (ippGetGroupTag(refresh_attr) != IPP_TAG_OPERATION || ippGetValueTag(refresh_attr) != IPP_TAG_INTEGER || ippGetCount(refresh_attr) != 1 || ippGetInteger(refresh_attr, 0) < 0 || ippGetInteger(refresh_attr, 0) > 60000)
+    {
+      papplClientRespondIPPUnsupported(client, refresh_attr);
+      return;
+    }
+
+    refresh_msecs = ippGetInteger(refresh_attr, 0);
+  }
+
   // List all devices
   papplClientRespondIPP(client, IPP_STATUS_OK, NULL);
 
   devices = _papplDeviceInfoCreateArray();
 
-  papplDeviceList(types, (pappl_device_cb_t)_papplDeviceInfoCallback, devices, papplLogDevice, client->system);
+  _papplDiscoveryList(client->system, types, refresh_msecs, (pappl_device_cb_t)_papplDeviceInfoCallback, devices);
 
   if (cupsArrayGetCount(devices) == 0)
   {
@@ -1190,10 +1205,10 @@ ipp_set_system_attributes(
     }
   }
 
-  system->config_changes ++;
-
   _papplRWUnlock(system);
 
+  _papplSystemConfigChanged(system);
+
   papplSystemAddEvent(system, NULL, NULL, PAPPL_EVENT_SYSTEM_CONFIG_CHANGED, NULL);
 
   papplClientRespondIPP(client, IPP_STATUS_OK, NULL);
@@ -19,14 +19,58 @@
 //
 
 static cups_len_t add_time(const char *name, time_t value, cups_len_t num_options, cups_option_t **options);
+static int	compare_jrefs(_pappl_jref_t *a, _pappl_jref_t *b);
+static _pappl_jref_t *copy_jref(_pappl_jref_t *jref);
+static pappl_printer_t *find_printer(pappl_system_t *system, int printer_id);
+static bool	load_job(pappl_system_t *system, pappl_printer_t *printer, char *value, const char *filename, int linenum);
+static void	load_journal(pappl_system_t *system, const char *filename);
 static void	parse_contact(char *value, pappl_contact_t *contact);
 static void	parse_media_col(char *value, pappl_media_col_t *media);
 static char	*read_line(cups_file_t *fp, char *line, size_t linesize, char **value, int *linenum);
+static bool	save_journal(pappl_system_t *system, const char *filename, cups_array_t *jobs);
+static bool	save_state(pappl_system_t *system, const char *filename);
 static void	write_contact(cups_file_t *fp, pappl_contact_t *contact);
+static void	write_job(pappl_system_t *system, cups_file_t *fp, pappl_job_t *job, int printer_id);
 static void	write_media_col(cups_file_t *fp, const char *name, pappl_media_col_t *media);
 static void	write_options(cups_file_t *fp, const char *name, cups_len_t num_options, cups_option_t *options);
 
 
+//
+// '_papplSystemJobChanged()' - Mark a job as changed.
+//
+// This function records a job whose state has changed so that the next call to
+// @link papplSystemSaveState@ can append it to the state journal instead of
+// rewriting the whole state file.
+//
+
+void
+_papplSystemJobChanged(
+    pappl_system_t *system,		// I - System
+    pappl_job_t    *job)		// I - Job
+{
+  _pappl_jref_t	jref;			// Job reference
+
+
+  jref.printer_id = job->printer->printer_id;
+  jref.job_id     = job->job_id;
+
+  pthread_mutex_lock(&system->config_mutex);
+
+  if (system->is_running)
+  {
+    if (!system->state_jobs)
+      system->state_jobs = cupsArrayNew((cups_array_cb_t)compare_jrefs, NULL, NULL, 0, (cups_acopy_cb_t)copy_jref, (cups_afree_cb_t)free);
+
+    if (!cupsArrayFind(system->state_jobs, &jref))
+      cupsArrayAdd(system->state_jobs, &jref);
+
+    system->config_changes ++;
+  }
+
+  pthread_mutex_unlock(&system->config_mutex);
+}
+
+
 //
 // 'papplSystemLoadState()' - Load the previous system state.
 //
@@ -119,6 +163,8 @@ papplSystemLoadState(
     }
     else if (!strcasecmp(line, "NextPrinterID") && value)
       papplSystemSetNextPrinterID(system, (int)strtol(value, NULL, 10));
+    else if (!strcasecmp(line, "StateGeneration") && value)
+      system->state_generation = (int)strtol(value, NULL, 10);
     else if (!strcasecmp(line, "UUID") && value)
     {
       if ((system->uuid = strdup(value)) == NULL)
@@ -284,86 +330,8 @@ papplSystemLoadState(
 	else if (!strcasecmp(line, "Job") && value)
 	{
 	  // Read printer job
-	  pappl_job_t	*job;		// Current Job
-	  struct stat	jobbuf;		// Job file buffer
-	  const char	*job_name,	// Job name
-			*job_id,	// Job ID
-			*job_username,	// Job username
-			*job_format,	// Job format
-			*job_value;	// Job option value
-
-	  num_options = cupsParseOptions(value, 0, &options);
-
-	  if ((job_id = cupsGetOption("id", num_options, options)) == NULL || strtol(job_id, NULL, 10) <= 0 || (job_name = cupsGetOption("name", num_options, options)) == NULL || (job_username = cupsGetOption("username", num_options, options)) == NULL || (job_format = cupsGetOption("format", num_options, options)) == NULL)
-	  {
-	    papplLog(system, PAPPL_LOGLEVEL_ERROR, "Bad Job definition on line %d of '%s'.", linenum, filename);
-	    break;
-	  }
-
-	  if ((job = _papplJobCreate(printer, (int)strtol(job_id, NULL, 10), job_username, job_format, job_name, NULL)) == NULL)
-	  {
-	    papplLog(system, PAPPL_LOGLEVEL_ERROR, "Error creating job %s for printer %s", job_name, printer->name);
+	  if (!load_job(system, printer, value, filename, linenum))
 	    break;
-	  }
-
-	  if ((job_value = cupsGetOption("filename", num_options, options)) != NULL)
-	  {
-	    if ((job->filename = strdup(job_value)) == NULL)
-	    {
-	      papplLog(system, PAPPL_LOGLEVEL_ERROR, "Error creating job %s for printer %s", job_name, printer->name);
-	      break;
-	    }
-	  }
-
-	  if ((job_value = cupsGetOption("state", num_options, options)) != NULL)
-	    job->state = (ipp_jstate_t)strtol(job_value, NULL, 10);
-	  if ((job_value = cupsGetOption("state_reasons", num_options, options)) != NULL)
-	    job->state_reasons = (ipp_jstate_t)strtol(job_value, NULL, 10);
-	  if ((job_value = cupsGetOption("created", num_options, options)) != NULL)
-	    job->created = strtol(job_value, NULL, 10);
-	  if ((job_value = cupsGetOption("processing", num_options, options)) != NULL)
-	    job->processing = strtol(job_value, NULL, 10);
-	  if ((job_value = cupsGetOption("completed", num_options, options)) != NULL)
-	    job->completed = strtol(job_value, NULL, 10);
-	  if ((job_value = cupsGetOption("impressions", num_options, options)) != NULL)
-	    job->impressions = (int)strtol(job_value, NULL, 10);
-	  if ((job_value = cupsGetOption("imcompleted", num_options, options)) != NULL)
-	    job->impcompleted = (int)strtol(job_value, NULL, 10);
-
-	  // Add the job to printer completed jobs array...
-	  if (job->state < IPP_JSTATE_STOPPED)
-	  {
-	    // Load the file attributes from the spool directory...
-	    int		attr_fd;	// Attribute file descriptor
-	    char	job_attr_filename[256];
-					// Attribute filename
-
-	    if ((attr_fd = papplJobOpenFile(job, job_attr_filename, sizeof(job_attr_filename), system->directory, "ipp", "r")) < 0)
-	    {
-	      if (errno != ENOENT)
-		papplLog(system, PAPPL_LOGLEVEL_ERROR, "Unable to open file for job attributes: '%s'.", job_attr_filename);
-	      continue;
-	    }
-
-	    ippReadFile(attr_fd, job->attrs);
-	    close(attr_fd);
-
-	    if (!job->filename || stat(job->filename, &jobbuf))
-	    {
-	      // If file removed, then set job state to aborted...
-	      job->state = IPP_JSTATE_ABORTED;
-	    }
-	    else
-	    {
-	      // Add the job to printer active jobs array...
-	      cupsArrayAdd(printer->active_jobs, job);
-	    }
-	  }
-	  else
-	  {
-	    // Add job to printer completed jobs...
-	    cupsArrayAdd(printer->completed_jobs, job);
-	  }
 	}
 	else
 	  papplLog(system, PAPPL_LOGLEVEL_WARN, "Unknown printer directive '%s' on line %d of '%s'.", line, linenum, filename);
@@ -382,6 +350,9 @@ papplSystemLoadState(
 
   cupsFileClose(fp);
 
+  // Replay any changes that were journaled after the state file was written...
+  load_journal(system, filename);
+
   return (true);
 }
 
@@ -398,229 +369,54 @@ papplSystemLoadState(
 // |    (void *)filename);
 // ```
 //
+// When only jobs have changed since the state file was last written, the
+// changed jobs are appended to a journal file (the state filename with a
+// ".journal" extension) that is replayed by @link papplSystemLoadState@.  The
+// state file is rewritten (compacted) when the system or printer configuration
+// changes or the journal gets too large.  The state file is always replaced
+// atomically so that a crash cannot leave a partial file behind.
+//
 
 bool					// O - `true` on success, `false` on failure
 papplSystemSaveState(
     pappl_system_t *system,		// I - System
     const char     *filename)		// I - File to save
 {
-  cups_len_t		i, j,		// Looping vars
-			count;		// Number of printers
-  cups_file_t		*fp;		// Output file
-  pappl_printer_t	*printer;	// Current printer
-  pappl_job_t		*job;		// Current Job
+  bool		ret,			// Return value
+		journal;		// Append to the journal?
+  cups_array_t	*jobs;			// Changed jobs
 
 
-  if ((fp = cupsFileOpen(filename, "w")) == NULL)
-  {
-    papplLog(system, PAPPL_LOGLEVEL_ERROR, "Unable to create system state file '%s': %s", filename, cupsGetErrorString());
+  if (!system || !filename)
     return (false);
-  }
-
-  papplLog(system, PAPPL_LOGLEVEL_INFO, "Saving system state to '%s'.", filename);
-
-  _papplRWLockRead(system);
-
-  if (system->dns_sd_name)
-    cupsFilePutConf(fp, "DNSSDName", system->dns_sd_name);
-  if (system->location)
-    cupsFilePutConf(fp, "Location", system->location);
-  if (system->geo_location)
-    cupsFilePutConf(fp, "Geolocation", system->geo_location);
-  if (system->organization)
-    cupsFilePutConf(fp, "Organization", system->organization);
-  if (system->org_unit)
-    cupsFilePutConf(fp, "OrganizationalUnit", system->org_unit);
-  write_contact(fp, &system->contact);
-  if (system->admin_group)
-    cupsFilePutConf(fp, "AdminGroup", system->admin_group);
-  if (system->default_print_group)
-    cupsFilePutConf(fp, "DefaultPrintGroup", system->default_print_group);
-  if (system->password_hash[0])
-    cupsFilePutConf(fp, "Password", system->password_hash);
-  cupsFilePrintf(fp, "DefaultPrinterID %d\n", system->default_printer_id);
-  cupsFilePrintf(fp, "MaxImageSize %ld %d %d\n", (long)system->max_image_size, system->max_image_width, system->max_image_height);
-  cupsFilePrintf(fp, "NextPrinterID %d\n", system->next_printer_id);
-  cupsFilePutConf(fp, "UUID", system->uuid);
-
-  // Loop through the printers.
-  //
-  // Note: Cannot use cupsArrayGetFirst/Last since other threads might be
-  // enumerating the printers array.
-  for (i = 0, count = cupsArrayGetCount(system->printers); i < count; i ++)
-  {
-    cups_len_t		jcount;		// Number of jobs
-    cups_len_t		num_options = 0;// Number of options
-    cups_option_t	*options = NULL;// Options
-
-    printer = (pappl_printer_t *)cupsArrayGetElement(system->printers, i);
-
-    if (printer->is_deleted)
-      continue;
-
-    _papplRWLockRead(printer);
-
-    num_options = cupsAddIntegerOption("id", printer->printer_id, num_options, &options);
-    num_options = cupsAddOption("name", printer->name, num_options, &options);
-    num_options = cupsAddOption("did", printer->device_id ? printer->device_id : "", num_options, &options);
-    num_options = cupsAddOption("uri", printer->device_uri, num_options, &options);
-    num_options = cupsAddOption("driver", printer->driver_name, num_options, &options);
-
-    if (system->options & PAPPL_SOPTIONS_MULTI_QUEUE)
-      num_options = cupsAddIntegerOption("state", (int)printer->state, num_options, &options);
-
-    write_options(fp, "<Printer", num_options, options);
-    cupsFreeOptions(num_options, options);
-
-    if (printer->dns_sd_name)
-      cupsFilePutConf(fp, "DNSSDName", printer->dns_sd_name);
-    if (printer->location)
-      cupsFilePutConf(fp, "Location", printer->location);
-    if (printer->geo_location)
-      cupsFilePutConf(fp, "Geolocation", printer->geo_location);
-    if (printer->organization)
-      cupsFilePutConf(fp, "Organization", printer->organization);
-    if (printer->org_unit)
-      cupsFilePutConf(fp, "OrganizationalUnit", printer->org_unit);
-    write_contact(fp, &printer->contact);
-    if (printer->hold_new_jobs)
-      cupsFilePuts(fp, "HoldNewJobs\n");
-    if (printer->print_group)
-      cupsFilePutConf(fp, "PrintGroup", printer->print_group);
-    cupsFilePrintf(fp, "MaxActiveJobs %d\n", printer->max_active_jobs);
-    cupsFilePrintf(fp, "MaxCompletedJobs %d\n", printer->max_completed_jobs);
-    cupsFilePrintf(fp, "NextJobId %d\n", printer->next_job_id);
-    cupsFilePrintf(fp, "ImpressionsCompleted %d\n", printer->impcompleted);
-
-    if (printer->driver_data.identify_default)
-      cupsFilePutConf(fp, "identify-actions-default", _papplIdentifyActionsString(printer->driver_data.identify_default));
-
-    if (printer->driver_data.mode_configured)
-      cupsFilePutConf(fp, "label-mode-configured", _papplLabelModeString(printer->driver_data.mode_configured));
-    if (printer->driver_data.tear_offset_configured)
-      cupsFilePrintf(fp, "label-tear-offset-configured %d\n", printer->driver_data.tear_offset_configured);
-
-    write_media_col(fp, "media-col-default", &printer->driver_data.media_default);
-
-    for (j = 0; j < (cups_len_t)printer->driver_data.num_source; j ++)
-    {
-      if (printer->driver_data.media_ready[j].size_name[0])
-      {
-        char	name[128];		// Attribute name
-
-        snprintf(name, sizeof(name), "media-col-ready%u", (unsigned)j);
-        write_media_col(fp, name, printer->driver_data.media_ready + j);
-      }
-    }
-    if (printer->driver_data.orient_default)
-      cupsFilePutConf(fp, "orientation-requested-default", ippEnumString("orientation-requested", (int)printer->driver_data.orient_default));
-    if (printer->driver_data.bin_default && printer->driver_data.num_bin > 0)
-      cupsFilePutConf(fp, "output-bin-default", printer->driver_data.bin[printer->driver_data.bin_default]);
-    if (printer->driver_data.color_default)
-      cupsFilePutConf(fp, "print-color-mode-default", _papplColorModeString(printer->driver_data.color_default));
-    if (printer->driver_data.content_default)
-      cupsFilePutConf(fp, "print-content-optimize-default", _papplContentString(printer->driver_data.content_default));
-    if (printer->driver_data.darkness_default)
-      cupsFilePrintf(fp, "print-darkness-default %d\n", printer->driver_data.darkness_default);
-    if (printer->driver_data.quality_default)
-      cupsFilePutConf(fp, "print-quality-default", ippEnumString("print-quality", (int)printer->driver_data.quality_default));
-    if (printer->driver_data.scaling_default)
-      cupsFilePutConf(fp, "print-scaling-default", _papplScalingString(printer->driver_data.scaling_default));
-    if (printer->driver_data.darkness_configured)
-      cupsFilePrintf(fp, "printer-darkness-configured %d\n", printer->driver_data.darkness_configured);
-    if (printer->driver_data.sides_default)
-      cupsFilePutConf(fp, "sides-default", _papplSidesString(printer->driver_data.sides_default));
-    if (printer->driver_data.x_default)
-      cupsFilePrintf(fp, "printer-resolution-default %dx%ddpi\n", printer->driver_data.x_default, printer->driver_data.y_default);
-    for (j = 0; j < (cups_len_t)printer->driver_data.num_vendor; j ++)
-    {
-      char	defname[128],		// xxx-default name
-	      	defvalue[1024];		// xxx-default value
 
-      snprintf(defname, sizeof(defname), "%s-default", printer->driver_data.vendor[j]);
-      ippAttributeString(ippFindAttribute(printer->driver_attrs, defname, IPP_TAG_ZERO), defvalue, sizeof(defvalue));
-
-      cupsFilePutConf(fp, defname, defvalue);
-    }
-
-    // Note: Cannot use cupsArrayGetFirst/Last since other threads might be
-    // enumerating the all_jobs array.
-
-    for (j = 0, jcount = cupsArrayGetCount(printer->all_jobs); j < jcount; j ++)
-    {
-      job = (pappl_job_t *)cupsArrayGetElement(printer->all_jobs, j);
-
-      _papplRWLockRead(job);
-
-      // Add basic job attributes...
-      num_options = 0;
-      num_options = cupsAddIntegerOption("id", job->job_id, num_options, &options);
-      num_options = cupsAddOption("name", job->name, num_options, &options);
-      num_options = cupsAddOption("username", job->username, num_options, &options);
-      num_options = cupsAddOption("format", job->format, num_options, &options);
-
-      if (job->filename)
-        num_options = cupsAddOption("filename", job->filename, num_options, &options);
-      if (job->is_canceled)
-        num_options = cupsAddIntegerOption("state", (int)IPP_JSTATE_CANCELED, num_options, &options);
-      else if (job->state)
-        num_options = cupsAddIntegerOption("state", (int)job->state, num_options, &options);
-      if (job->state_reasons)
-        num_options = cupsAddIntegerOption("state_reasons", (int)job->state_reasons, num_options, &options);
-      if (job->created)
-        num_options = add_time("created", job->created, num_options, &options);
-      if (job->processing)
-        num_options = add_time("processing", job->processing, num_options, &options);
-      if (job->completed)
-        num_options = add_time("completed", job->completed, num_options, &options);
-      else if (job->is_canceled)
-        num_options = add_time("completed", time(NULL), num_options, &options);
-      if (job->impressions)
-        num_options = cupsAddIntegerOption("impressions", job->impressions, num_options, &options);
-      if (job->impcompleted)
-        num_options = cupsAddIntegerOption("imcompleted", job->impcompleted, num_options, &options);
-
-      if (job->attrs)
-      {
-	int	attr_fd;		// Attribute file descriptor
-	char	job_attr_filename[1024];// Attribute filename
-
-        // Save job attributes to file in spool directory...
-        if (job->state < IPP_JSTATE_STOPPED)
-        {
-          if ((attr_fd = papplJobOpenFile(job, job_attr_filename, sizeof(job_attr_filename), system->directory, "ipp", "w")) < 0)
-          {
-            papplLog(system, PAPPL_LOGLEVEL_ERROR, "Unable to create file for job attributes: '%s'.", job_attr_filename);
-            _papplRWUnlock(job);
-            continue;
-          }
+  // Grab the list of changed jobs and decide whether we can just append them
+  // to the journal...
+  pthread_mutex_lock(&system->config_mutex);
 
-          ippWriteFile(attr_fd, job->attrs);
-          close(attr_fd);
-        }
-        else
-        {
-          // If job completed or aborted, remove job-attributes file...
-          papplJobOpenFile(job, job_attr_filename, sizeof(job_attr_filename), system->directory, "ipp", "x");
-        }
-      }
+  journal            = system->state_file && !strcmp(system->state_file, filename) && !system->state_compact && system->state_records < _PAPPL_MAX_JOURNAL;
+  jobs               = system->state_jobs;
+  system->state_jobs = NULL;
 
-      write_options(fp, "Job", num_options, options);
-      cupsFreeOptions(num_options, options);
+  if (!journal)
+    system->state_compact = false;
 
-      _papplRWUnlock(job);
-    }
+  pthread_mutex_unlock(&system->config_mutex);
 
-    cupsFilePuts(fp, "</Printer>\n");
+  if (journal && (ret = save_journal(system, filename, jobs)) == false)
+    journal = false;			// Rewrite the state file on error
 
-    _papplRWUnlock(printer);
+  if (!journal && (ret = save_state(system, filename)) == false)
+  {
+    // Try again on the next save...
+    pthread_mutex_lock(&system->config_mutex);
+    system->state_compact = true;
+    pthread_mutex_unlock(&system->config_mutex);
   }
 
-  _papplRWUnlock(system);
-
-  cupsFileClose(fp);
+  cupsArrayDelete(jobs);
 
-  return (true);
+  return (ret);
 }
 
 
@@ -646,55 +442,345 @@ add_time(const char    *name,		// I  - Name
 
 
 //
-// 'parse_contact()' - Parse a contact value.
+// 'compare_jrefs()' - Compare two job references.
 //
 
-static void
-parse_contact(char            *value,	// I - Value
-              pappl_contact_t *contact)	// O - Contact
+static int				// O - Result of comparison
+compare_jrefs(_pappl_jref_t *a,		// I - First job reference
+              _pappl_jref_t *b)		// I - Second job reference
 {
-  cups_len_t	i,			// Looping var
-		num_options;		// Number of options
-  cups_option_t	*options = NULL,	// Options
-		*option;		// Current option
+  if (a->printer_id != b->printer_id)
+    return (a->printer_id - b->printer_id);
+  else
+    return (a->job_id - b->job_id);
+}
 
 
-  memset(contact, 0, sizeof(pappl_contact_t));
-  num_options = cupsParseOptions(value, 0, &options);
+//
+// 'copy_jref()' - Copy a job reference.
+//
 
-  for (i = num_options, option = options; i > 0; i --, option ++)
+static _pappl_jref_t *			// O - New job reference
+copy_jref(_pappl_jref_t *jref)		// I - Job reference
+{
+  _pappl_jref_t	*newjref;		// New job reference
+
+
+  if ((newjref = malloc(sizeof(_pappl_jref_t))) != NULL)
+    *newjref = *jref;
+
+  return (newjref);
+}
+
+
+//
+// 'find_printer()' - Find a printer by ID.
+//
+// The caller must hold a lock on the system object.
+//
+
+static pappl_printer_t *		// O - Printer or `NULL` if not found
+find_printer(pappl_system_t *system,	// I - System
+             int            printer_id)	// I - Printer ID
+{
+  cups_len_t		i,		// Looping var
+			count;		// Number of printers
+  pappl_printer_t	*printer;	// Current printer
+
+
+  for (i = 0, count = cupsArrayGetCount(system->printers); i < count; i ++)
   {
-    if (!strcasecmp(option->name, "name"))
-      papplCopyString(contact->name, option->value, sizeof(contact->name));
-    else if (!strcasecmp(option->name, "email"))
-      papplCopyString(contact->email, option->value, sizeof(contact->email));
-    else if (!strcasecmp(option->name, "telephone"))
-      papplCopyString(contact->telephone, option->value, sizeof(contact->telephone));
+    printer = (pappl_printer_t *)cupsArrayGetElement(system->printers, i);
+
+    if (printer->printer_id == printer_id)
+      return (printer->is_deleted ? NULL : printer);
   }
 
-  cupsFreeOptions(num_options, options);
+  return (NULL);
 }
 
 
 //
-// 'parse_media_col()' - Parse a media-col value.
+// 'load_job()' - Load or update a job from a "Job" line.
+//
+// Jobs that have already been loaded (from the state file or an earlier
+// journal record) are updated in place.
 //
 
-static void
-parse_media_col(
-    char              *value,		// I - Value
-    pappl_media_col_t *media)		// O - Media collection
+static bool				// O - `true` to continue, `false` on error
+load_job(pappl_system_t  *system,	// I - System
+         pappl_printer_t *printer,	// I - Printer
+         char            *value,	// I - "Job" line value
+         const char      *filename,	// I - Filename
+         int             linenum)	// I - Line number
 {
-  cups_len_t	i,			// Looping var
-		num_options;		// Number of options
-  cups_option_t	*options = NULL,	// Options
-		*option;		// Current option
+  cups_len_t	num_options;		// Number of options
+  cups_option_t	*options = NULL;	// Options
+  pappl_job_t	*job;			// Current Job
+  bool		is_new;			// New job?
+  struct stat	jobbuf;			// Job file buffer
+  const char	*job_name,		// Job name
+		*job_id,		// Job ID
+		*job_username,		// Job username
+		*job_format,		// Job format
+		*job_value;		// Job option value
 
 
-  memset(media, 0, sizeof(pappl_media_col_t));
   num_options = cupsParseOptions(value, 0, &options);
 
-  for (i = num_options, option = options; i > 0; i --, option ++)
+  if ((job_id = cupsGetOption("id", num_options, options)) == NULL || strtol(job_id, NULL, 10) <= 0 || (job_name = cupsGetOption("name", num_options, options)) == NULL || (job_username = cupsGetOption("username", num_options, options)) == NULL || (job_format = cupsGetOption("format", num_options, options)) == NULL)
+  {
+    papplLog(system, PAPPL_LOGLEVEL_ERROR, "Bad Job definition on line %d of '%s'.", linenum, filename);
+    cupsFreeOptions(num_options, options);
+    return (false);
+  }
+
+  if ((job = papplPrinterFindJob(printer, (int)strtol(job_id, NULL, 10))) != NULL)
+  {
+    // Update an existing job, which gets re-added to the active or completed
+    // jobs array below...
+    is_new = false;
+
+    cupsArrayRemove(printer->active_jobs, job);
+    cupsArrayRemove(printer->completed_jobs, job);
+
+    free(job->filename);
+    job->filename = NULL;
+  }
+  else if ((job = _papplJobCreate(printer, (int)strtol(job_id, NULL, 10), job_username, job_format, job_name, NULL)) != NULL)
+  {
+    // The job name and format point into the options, so they are not freed...
+    is_new = true;
+  }
+  else
+  {
+    papplLog(system, PAPPL_LOGLEVEL_ERROR, "Error creating job %s for printer %s", job_name, printer->name);
+    cupsFreeOptions(num_options, options);
+    return (false);
+  }
+
+  if ((job_value = cupsGetOption("filename", num_options, options)) != NULL)
+  {
+    if ((job->filename = strdup(job_value)) == NULL)
+    {
+      papplLog(system, PAPPL_LOGLEVEL_ERROR, "Error creating job %s for printer %s", job_name, printer->name);
+      if (!is_new)
+        cupsFreeOptions(num_options, options);
+      return (false);
+    }
+  }
+
+  if ((job_value = cupsGetOption("state", num_options, options)) != NULL)
+    job->state = (ipp_jstate_t)strtol(job_value, NULL, 10);
+  if ((job_value = cupsGetOption("state_reasons", num_options, options)) != NULL)
+    job->state_reasons = (ipp_jstate_t)strtol(job_value, NULL, 10);
+  if ((job_value = cupsGetOption("created", num_options, options)) != NULL)
+    job->created = strtol(job_value, NULL, 10);
+  if ((job_value = cupsGetOption("processing", num_options, options)) != NULL)
+    job->processing = strtol(job_value, NULL, 10);
+  if ((job_value = cupsGetOption("completed", num_options, options)) != NULL)
+    job->completed = strtol(job_value, NULL, 10);
+  if ((job_value = cupsGetOption("impressions", num_options, options)) != NULL)
+    job->impressions = (int)strtol(job_value, NULL, 10);
+  if ((job_value = cupsGetOption("imcompleted", num_options, options)) != NULL)
+    job->impcompleted = (int)strtol(job_value, NULL, 10);
+
+  if (!is_new)
+    cupsFreeOptions(num_options, options);
+
+  // Add the job to printer completed jobs array...
+  if (job->state < IPP_JSTATE_STOPPED)
+  {
+    if (is_new)
+    {
+      // Load the file attributes from the spool directory...
+      int	attr_fd;		// Attribute file descriptor
+      char	job_attr_filename[256];	// Attribute filename
+
+      if ((attr_fd = papplJobOpenFile(job, job_attr_filename, sizeof(job_attr_filename), system->directory, "ipp", "r")) < 0)
+      {
+	if (errno != ENOENT)
+	  papplLog(system, PAPPL_LOGLEVEL_ERROR, "Unable to open file for job attributes: '%s'.", job_attr_filename);
+	return (true);
+      }
+
+      ippReadFile(attr_fd, job->attrs);
+      close(attr_fd);
+    }
+
+    if (!job->filename || stat(job->filename, &jobbuf))
+    {
+      // If file removed, then set job state to aborted...
+      job->state = IPP_JSTATE_ABORTED;
+    }
+    else
+    {
+      // Add the job to printer active jobs array...
+      cupsArrayAdd(printer->active_jobs, job);
+    }
+  }
+  else
+  {
+    // Add job to printer completed jobs...
+    cupsArrayAdd(printer->completed_jobs, job);
+  }
+
+  return (true);
+}
+
+
+//
+// 'load_journal()' - Replay the system state journal.
+//
+// The journal is only replayed when its generation matches the state file
+// that was just loaded - otherwise the journal belongs to an older state file
+// and is ignored.
+//
+
+static void
+load_journal(pappl_system_t *system,	// I - System
+             const char     *filename)	// I - State filename
+{
+  cups_file_t		*fp;		// Journal file
+  int			linenum;	// Line number
+  char			journal[1024],	// Journal filename
+			line[2048],	// Line from file
+			*value;		// Value from line
+  cups_len_t		num_options;	// Number of options
+  cups_option_t		*options;	// Options
+  const char		*printer_id,	// Printer ID
+			*job_id,	// Job ID
+			*opt_value;	// Option value
+  pappl_printer_t	*printer;	// Printer
+  pappl_job_t		*job;		// Job
+
+
+  snprintf(journal, sizeof(journal), "%s.journal", filename);
+
+  if ((fp = cupsFileOpen(journal, "r")) == NULL)
+  {
+    if (errno != ENOENT)
+      papplLog(system, PAPPL_LOGLEVEL_ERROR, "Unable to open system state journal '%s': %s", journal, cupsGetErrorString());
+
+    return;
+  }
+
+  linenum = 0;
+
+  if (!read_line(fp, line, sizeof(line), &value, &linenum) || strcasecmp(line, "StateGeneration") || !value || (int)strtol(value, NULL, 10) != system->state_generation)
+  {
+    papplLog(system, PAPPL_LOGLEVEL_WARN, "Ignoring stale system state journal '%s'.", journal);
+    cupsFileClose(fp);
+    return;
+  }
+
+  papplLog(system, PAPPL_LOGLEVEL_INFO, "Loading system state journal from '%s'.", journal);
+
+  while (read_line(fp, line, sizeof(line), &value, &linenum))
+  {
+    if (!value)
+    {
+      papplLog(system, PAPPL_LOGLEVEL_WARN, "Bad journal record '%s' on line %d of '%s'.", line, linenum, journal);
+      continue;
+    }
+
+    options     = NULL;
+    num_options = cupsParseOptions(value, 0, &options);
+
+    if (!strcasecmp(line, "Printer"))
+    {
+      // Update printer job counters...
+      if ((printer_id = cupsGetOption("id", num_options, options)) != NULL && (printer = papplSystemFindPrinter(system, NULL, (int)strtol(printer_id, NULL, 10), NULL)) != NULL)
+      {
+        if ((opt_value = cupsGetOption("nextjobid", num_options, options)) != NULL)
+	  papplPrinterSetNextJobID(printer, (int)strtol(opt_value, NULL, 10));
+        if ((opt_value = cupsGetOption("imcompleted", num_options, options)) != NULL)
+	  papplPrinterSetImpressionsCompleted(printer, (int)strtol(opt_value, NULL, 10));
+      }
+    }
+    else if (!strcasecmp(line, "Job"))
+    {
+      // Add or update a job...
+      if ((printer_id = cupsGetOption("printer", num_options, options)) != NULL && (printer = papplSystemFindPrinter(system, NULL, (int)strtol(printer_id, NULL, 10), NULL)) != NULL)
+        load_job(system, printer, value, journal, linenum);
+    }
+    else if (!strcasecmp(line, "JobDeleted"))
+    {
+      // Remove a job from the history...
+      if ((printer_id = cupsGetOption("printer", num_options, options)) != NULL && (job_id = cupsGetOption("id", num_options, options)) != NULL && (printer = papplSystemFindPrinter(system, NULL, (int)strtol(printer_id, NULL, 10), NULL)) != NULL && (job = papplPrinterFindJob(printer, (int)strtol(job_id, NULL, 10))) != NULL)
+      {
+        _papplRWLockWrite(printer);
+
+	cupsArrayRemove(printer->active_jobs, job);
+	cupsArrayRemove(printer->completed_jobs, job);
+	_papplPrinterRemoveUserJobNoLock(printer, job);
+	cupsArrayRemove(printer->all_jobs, job);
+
+        _papplRWUnlock(printer);
+      }
+    }
+    else
+    {
+      papplLog(system, PAPPL_LOGLEVEL_WARN, "Unknown journal record '%s' on line %d of '%s'.", line, linenum, journal);
+    }
+
+    cupsFreeOptions(num_options, options);
+  }
+
+  cupsFileClose(fp);
+}
+
+
+//
+// 'parse_contact()' - Parse a contact value.
+//
+
+static void
+parse_contact(char            *value,	// I - Value
+              pappl_contact_t *contact)	// O - Contact
+{
+  cups_len_t	i,			// Looping var
+		num_options;		// Number of options
+  cups_option_t	*options = NULL,	// Options
+		*option;		// Current option
+
+
+  memset(contact, 0, sizeof(pappl_contact_t));
+  num_options = cupsParseOptions(value, 0, &options);
+
+  for (i = num_options, option = options; i > 0; i --, option ++)
+  {
+    if (!strcasecmp(option->name, "name"))
+      papplCopyString(contact->name, option->value, sizeof(contact->name));
+    else if (!strcasecmp(option->name, "email"))
+      papplCopyString(contact->email, option->value, sizeof(contact->email));
+    else if (!strcasecmp(option->name, "telephone"))
+      papplCopyString(contact->telephone, option->value, sizeof(contact->telephone));
+  }
+
+  cupsFreeOptions(num_options, options);
+}
+
+
+//
+// 'parse_media_col()' - Parse a media-col value.
+//
+
+static void
+parse_media_col(
+    char              *value,		// I - Value
+    pappl_media_col_t *media)		// O - Media collection
+{
+  cups_len_t	i,			// Looping var
+		num_options;		// Number of options
+  cups_option_t	*options = NULL,	// Options
+		*option;		// Current option
+
+
+  memset(media, 0, sizeof(pappl_media_col_t));
+  num_options = cupsParseOptions(value, 0, &options);
+
+  for (i = num_options, option = options; i > 0; i --, option ++)
   {
     if (!strcasecmp(option->name, "bottom"))
       media->bottom_margin = (int)strtol(option->value, NULL, 10);
@@ -768,6 +854,297 @@ read_line(cups_file_t *fp,		// I  - File
 }
 
 
+//
+// 'save_journal()' - Append the changed jobs to the state journal.
+//
+
+static bool				// O - `true` on success, `false` on failure
+save_journal(pappl_system_t *system,	// I - System
+             const char     *filename,	// I - State filename
+             cups_array_t   *jobs)	// I - Changed jobs
+{
+  cups_file_t		*fp;		// Journal file
+  char			journal[1024];	// Journal filename
+  size_t		records;	// Number of records in journal
+  int			generation;	// State generation
+  _pappl_jref_t		*jref;		// Current job reference
+  pappl_printer_t	*printer;	// Current printer
+  pappl_job_t		key,		// Job search key
+			*job;		// Current job
+  int			last_id = 0;	// Last printer ID
+
+
+  snprintf(journal, sizeof(journal), "%s.journal", filename);
+
+  pthread_mutex_lock(&system->config_mutex);
+  records    = system->state_records;
+  generation = system->state_generation;
+  pthread_mutex_unlock(&system->config_mutex);
+
+  if ((fp = cupsFileOpen(journal, records ? "a" : "w")) == NULL)
+  {
+    papplLog(system, PAPPL_LOGLEVEL_ERROR, "Unable to open system state journal '%s': %s", journal, cupsGetErrorString());
+    return (false);
+  }
+
+  papplLog(system, PAPPL_LOGLEVEL_DEBUG, "Appending %u job(s) to system state journal '%s'.", (unsigned)cupsArrayGetCount(jobs), journal);
+
+  if (!records)
+    cupsFilePrintf(fp, "StateGeneration %d\n", generation);
+
+  _papplRWLockRead(system);
+
+  // The jobs array is sorted by printer and job ID, so the records for each
+  // printer are grouped together...
+  for (jref = (_pappl_jref_t *)cupsArrayGetFirst(jobs); jref; jref = (_pappl_jref_t *)cupsArrayGetNext(jobs))
+  {
+    if ((printer = find_printer(system, jref->printer_id)) == NULL)
+      continue;
+
+    _papplRWLockRead(printer);
+
+    if (printer->printer_id != last_id)
+    {
+      cupsFilePrintf(fp, "Printer id=%d nextjobid=%d imcompleted=%d\n", printer->printer_id, printer->next_job_id, printer->impcompleted);
+      last_id = printer->printer_id;
+      records ++;
+    }
+
+    key.job_id = jref->job_id;
+
+    if ((job = (pappl_job_t *)cupsArrayFind(printer->all_jobs, &key)) != NULL)
+      write_job(system, fp, job, printer->printer_id);
+    else
+      cupsFilePrintf(fp, "JobDeleted printer=%d id=%d\n", jref->printer_id, jref->job_id);
+
+    records ++;
+
+    _papplRWUnlock(printer);
+  }
+
+  _papplRWUnlock(system);
+
+  if (cupsFileClose(fp))
+  {
+    papplLog(system, PAPPL_LOGLEVEL_ERROR, "Unable to write system state journal '%s': %s", journal, cupsGetErrorString());
+    return (false);
+  }
+
+  pthread_mutex_lock(&system->config_mutex);
+  system->state_records = records;
+  pthread_mutex_unlock(&system->config_mutex);
+
+  return (true);
+}
+
+
+//
+// 'save_state()' - Write a new state file.
+//
+// The state file is written to a temporary file that is then renamed over the
+// previous state file, after which the journal is removed.
+//
+
+static bool				// O - `true` on success, `false` on failure
+save_state(pappl_system_t *system,	// I - System
+           const char     *filename)	// I - File to save
+{
+  cups_len_t		i, j,		// Looping vars
+			count;		// Number of printers
+  cups_file_t		*fp;		// Output file
+  pappl_printer_t	*printer;	// Current printer
+  int			generation;	// State generation
+  char			tempfile[1024],	// Temporary state file
+			journal[1024];	// Journal file
+
+
+  snprintf(tempfile, sizeof(tempfile), "%s.N", filename);
+  snprintf(journal, sizeof(journal), "%s.journal", filename);
+
+  if ((fp = cupsFileOpen(tempfile, "w")) == NULL)
+  {
+    papplLog(system, PAPPL_LOGLEVEL_ERROR, "Unable to create system state file '%s': %s", tempfile, cupsGetErrorString());
+    return (false);
+  }
+
+  papplLog(system, PAPPL_LOGLEVEL_INFO, "Saving system state to '%s'.", filename);
+
+  pthread_mutex_lock(&system->config_mutex);
+  generation = ++ system->state_generation;
+  pthread_mutex_unlock(&system->config_mutex);
+
+  _papplRWLockRead(system);
+
+  if (system->dns_sd_name)
+    cupsFilePutConf(fp, "DNSSDName", system->dns_sd_name);
+  if (system->location)
+    cupsFilePutConf(fp, "Location", system->location);
+  if (system->geo_location)
+    cupsFilePutConf(fp, "Geolocation", system->geo_location);
+  if (system->organization)
+    cupsFilePutConf(fp, "Organization", system->organization);
+  if (system->org_unit)
+    cupsFilePutConf(fp, "OrganizationalUnit", system->org_unit);
+  write_contact(fp, &system->contact);
+  if (system->admin_group)
+    cupsFilePutConf(fp, "AdminGroup", system->admin_group);
+  if (system->default_print_group)
+    cupsFilePutConf(fp, "DefaultPrintGroup", system->default_print_group);
+  if (system->password_hash[0])
+    cupsFilePutConf(fp, "Password", system->password_hash);
+  cupsFilePrintf(fp, "DefaultPrinterID %d\n", system->default_printer_id);
+  cupsFilePrintf(fp, "MaxImageSize %ld %d %d\n", (long)system->max_image_size, system->max_image_width, system->max_image_height);
+  cupsFilePrintf(fp, "NextPrinterID %d\n", system->next_printer_id);
+  cupsFilePutConf(fp, "UUID", system->uuid);
+  cupsFilePrintf(fp, "StateGeneration %d\n", generation);
+
+  // Loop through the printers.
+  //
+  // Note: Cannot use cupsArrayGetFirst/Last since other threads might be
+  // enumerating the printers array.
+  for (i = 0, count = cupsArrayGetCount(system->printers); i < count; i ++)
+  {
+    cups_len_t		jcount;		// Number of jobs
+    cups_len_t		num_options = 0;// Number of options
+    cups_option_t	*options = NULL;// Options
+
+    printer = (pappl_printer_t *)cupsArrayGetElement(system->printers, i);
+
+    if (printer->is_deleted)
+      continue;
+
+    _papplRWLockRead(printer);
+
+    num_options = cupsAddIntegerOption("id", printer->printer_id, num_options, &options);
+    num_options = cupsAddOption("name", printer->name, num_options, &options);
+    num_options = cupsAddOption("did", printer->device_id ? printer->device_id : "", num_options, &options);
+    num_options = cupsAddOption("uri", printer->device_uri, num_options, &options);
+    num_options = cupsAddOption("driver", printer->driver_name, num_options, &options);
+
+    if (system->options & PAPPL_SOPTIONS_MULTI_QUEUE)
+      num_options = cupsAddIntegerOption("state", (int)printer->state, num_options, &options);
+
+    write_options(fp, "<Printer", num_options, options);
+    cupsFreeOptions(num_options, options);
+
+    if (printer->dns_sd_name)
+      cupsFilePutConf(fp, "DNSSDName", printer->dns_sd_name);
+    if (printer->location)
+      cupsFilePutConf(fp, "Location", printer->location);
+    if (printer->geo_location)
+      cupsFilePutConf(fp, "Geolocation", printer->geo_location);
+    if (printer->organization)
+      cupsFilePutConf(fp, "Organization", printer->organization);
+    if (printer->org_unit)
+      cupsFilePutConf(fp, "OrganizationalUnit", printer->org_unit);
+    write_contact(fp, &printer->contact);
+    if (printer->hold_new_jobs)
+      cupsFilePuts(fp, "HoldNewJobs\n");
+    if (printer->print_group)
+      cupsFilePutConf(fp, "PrintGroup", printer->print_group);
+    cupsFilePrintf(fp, "MaxActiveJobs %d\n", printer->max_active_jobs);
+    cupsFilePrintf(fp, "MaxCompletedJobs %d\n", printer->max_completed_jobs);
+    cupsFilePrintf(fp, "NextJobId %d\n", printer->next_job_id);
+    cupsFilePrintf(fp, "ImpressionsCompleted %d\n", printer->impcompleted);
+
+    if (printer->driver_data.identify_default)
+      cupsFilePutConf(fp, "identify-actions-default", _papplIdentifyActionsString(printer->driver_data.identify_default));
+
+    if (printer->driver_data.mode_configured)
+      cupsFilePutConf(fp, "label-mode-configured", _papplLabelModeString(printer->driver_data.mode_configured));
+    if (printer->driver_data.tear_offset_configured)
+      cupsFilePrintf(fp, "label-tear-offset-configured %d\n", printer->driver_data.tear_offset_configured);
+
+    write_media_col(fp, "media-col-default", &printer->driver_data.media_default);
+
+    for (j = 0; j < (cups_len_t)printer->driver_data.num_source; j ++)
+    {
+      if (printer->driver_data.media_ready[j].size_name[0])
+      {
+        char	name[128];		// Attribute name
+
+        snprintf(name, sizeof(name), "media-col-ready%u", (unsigned)j);
+        write_media_col(fp, name, printer->driver_data.media_ready + j);
+      }
+    }
+    if (printer->driver_data.orient_default)
+      cupsFilePutConf(fp, "orientation-requested-default", ippEnumString("orientation-requested", (int)printer->driver_data.orient_default));
+    if (printer->driver_data.bin_default && printer->driver_data.num_bin > 0)
+      cupsFilePutConf(fp, "output-bin-default", printer->driver_data.bin[printer->driver_data.bin_default]);
+    if (printer->driver_data.color_default)
+      cupsFilePutConf(fp, "print-color-mode-default", _papplColorModeString(printer->driver_data.color_default));
+    if (printer->driver_data.content_default)
+      cupsFilePutConf(fp, "print-content-optimize-default", _papplContentString(printer->driver_data.content_default));
+    if (printer->driver_data.darkness_default)
+      cupsFilePrintf(fp, "print-darkness-default %d\n", printer->driver_data.darkness_default);
+    if (printer->driver_data.quality_default)
+      cupsFilePutConf(fp, "print-quality-default", ippEnumString("print-quality", (int)printer->driver_data.quality_default));
+    if (printer->driver_data.scaling_default)
+      cupsFilePutConf(fp, "print-scaling-default", _papplScalingString(printer->driver_data.scaling_default));
+    if (printer->driver_data.darkness_configured)
+      cupsFilePrintf(fp, "printer-darkness-configured %d\n", printer->driver_data.darkness_configured);
+    if (printer->driver_data.sides_default)
+      cupsFilePutConf(fp, "sides-default", _papplSidesString(printer->driver_data.sides_default));
+    if (printer->driver_data.x_default)
+      cupsFilePrintf(fp, "printer-resolution-default %dx%ddpi\n", printer->driver_data.x_default, printer->driver_data.y_default);
+    for (j = 0; j < (cups_len_t)printer->driver_data.num_vendor; j ++)
+    {
+      char	defname[128],		// xxx-default name
+	      	defvalue[1024];		// xxx-default value
+
+      snprintf(defname, sizeof(defname), "%s-default", printer->driver_data.vendor[j]);
+      ippAttributeString(ippFindAttribute(printer->driver_attrs, defname, IPP_TAG_ZERO), defvalue, sizeof(defvalue));
+
+      cupsFilePutConf(fp, defname, defvalue);
+    }
+
+    for (j = 0, jcount = cupsArrayGetCount(printer->all_jobs); j < jcount; j ++)
+      write_job(system, fp, (pappl_job_t *)cupsArrayGetElement(printer->all_jobs, j), 0);
+
+    cupsFilePuts(fp, "</Printer>\n");
+
+    _papplRWUnlock(printer);
+  }
+
+  _papplRWUnlock(system);
+
+  if (cupsFileClose(fp))
+  {
+    papplLog(system, PAPPL_LOGLEVEL_ERROR, "Unable to write system state file '%s': %s", tempfile, cupsGetErrorString());
+    unlink(tempfile);
+    return (false);
+  }
+
+  // Replace the old state file and remove the (now stale) journal...
+#if _WIN32
+  unlink(filename);
+#endif // _WIN32
+
+  if (rename(tempfile, filename))
+  {
+    papplLog(system, PAPPL_LOGLEVEL_ERROR, "Unable to rename '%s' to '%s': %s", tempfile, filename, strerror(errno));
+    unlink(tempfile);
+    return (false);
+  }
+
+  unlink(journal);
+
+  pthread_mutex_lock(&system->config_mutex);
+
+  if (!system->state_file || strcmp(system->state_file, filename))
+  {
+    free(system->state_file);
+    system->state_file = strdup(filename);
+  }
+
+  system->state_records = 0;
+
+  pthread_mutex_unlock(&system->config_mutex);
+
+  return (true);
+}
+
+
 //
 // 'write_contact()' - Write an "xxx-contact" value.
 //
@@ -792,6 +1169,88 @@ write_contact(cups_file_t     *fp,	// I - File
 }
 
 
+//
+// 'write_job()' - Write a "Job" line for a job.
+//
+// When "printer_id" is greater than 0 it is included so that the line can be
+// used in the state journal.
+//
+
+static void
+write_job(pappl_system_t *system,	// I - System
+          cups_file_t    *fp,		// I - File
+          pappl_job_t    *job,		// I - Job
+          int            printer_id)	// I - Printer ID or `0` for none
+{
+  cups_len_t	num_options;		// Number of options
+  cups_option_t	*options = NULL;	// Options
+
+
+  _papplRWLockRead(job);
+
+  // Add basic job attributes...
+  num_options = 0;
+  if (printer_id > 0)
+    num_options = cupsAddIntegerOption("printer", printer_id, num_options, &options);
+  num_options = cupsAddIntegerOption("id", job->job_id, num_options, &options);
+  num_options = cupsAddOption("name", job->name, num_options, &options);
+  num_options = cupsAddOption("username", job->username, num_options, &options);
+  num_options = cupsAddOption("format", job->format, num_options, &options);
+
+  if (job->filename)
+    num_options = cupsAddOption("filename", job->filename, num_options, &options);
+  if (job->is_canceled)
+    num_options = cupsAddIntegerOption("state", (int)IPP_JSTATE_CANCELED, num_options, &options);
+  else if (job->state)
+    num_options = cupsAddIntegerOption("state", (int)job->state, num_options, &options);
+  if (job->state_reasons)
+    num_options = cupsAddIntegerOption("state_reasons", (int)job->state_reasons, num_options, &options);
+  if (job->created)
+    num_options = add_time("created", job->created, num_options, &options);
+  if (job->processing)
+    num_options = add_time("processing", job->processing, num_options, &options);
+  if (job->completed)
+    num_options = add_time("completed", job->completed, num_options, &options);
+  else if (job->is_canceled)
+    num_options = add_time("completed", time(NULL), num_options, &options);
+  if (job->impressions)
+    num_options = cupsAddIntegerOption("impressions", job->impressions, num_options, &options);
+  if (job->impcompleted)
+    num_options = cupsAddIntegerOption("imcompleted", job->impcompleted, num_options, &options);
+
+  if (job->attrs)
+  {
+    int		attr_fd;		// Attribute file descriptor
+    char	job_attr_filename[1024];// Attribute filename
+
+    // Save job attributes to file in spool directory...
+    if (job->state < IPP_JSTATE_STOPPED)
+    {
+      if ((attr_fd = papplJobOpenFile(job, job_attr_filename, sizeof(job_attr_filename), system->directory, "ipp", "w")) < 0)
+      {
+        papplLog(system, PAPPL_LOGLEVEL_ERROR, "Unable to create file for job attributes: '%s'.", job_attr_filename);
+        _papplRWUnlock(job);
+        cupsFreeOptions(num_options, options);
+        return;
+      }
+
+      ippWriteFile(attr_fd, job->attrs);
+      close(attr_fd);
+    }
+    else
+    {
+      // If job completed or aborted, remove job-attributes file...
+      papplJobOpenFile(job, job_attr_filename, sizeof(job_attr_filename), system->directory, "ipp", "x");
+    }
+  }
+
+  write_options(fp, "Job", num_options, options);
+  cupsFreeOptions(num_options, options);
+
+  _papplRWUnlock(job);
+}
+
+
 //
 // 'write_media_col()' - Write a media-col value...
 //
@@ -18,6 +18,9 @@
 // Local functions...
 //
 
+static int	compare_pindex_ids(_pappl_pindex_t *a, _pappl_pindex_t *b);
+static int	compare_pindex_resources(_pappl_pindex_t *a, _pappl_pindex_t *b);
+static int	compare_pindex_uris(_pappl_pindex_t *a, _pappl_pindex_t *b);
 static int	compare_printers(pappl_printer_t *a, pappl_printer_t *b);
 
 
@@ -31,6 +34,9 @@ _papplSystemAddPrinter(
     pappl_printer_t *printer,		// I - Printer
     int             printer_id)		// I - Printer ID or `0` for new
 {
+  _pappl_pindex_t	*pindex;	// Printer index entry
+
+
   // Add the printer to the system...
   _papplRWLockWrite(system);
 
@@ -40,10 +46,35 @@ _papplSystemAddPrinter(
     printer->printer_id = system->next_printer_id ++;
 
   if (!system->printers)
-    system->printers = cupsArrayNew((cups_array_cb_t)compare_printers, NULL, NULL, 0, NULL, (cups_afree_cb_t)_papplPrinterDelete);
+  {
+    system->printers             = cupsArrayNew((cups_array_cb_t)compare_printers, NULL, NULL, 0, NULL, (cups_afree_cb_t)_papplPrinterDelete);
+    system->printers_by_id       = cupsArrayNew((cups_array_cb_t)compare_pindex_ids, NULL, NULL, 0, NULL, (cups_afree_cb_t)free);
+    system->printers_by_resource = cupsArrayNew((cups_array_cb_t)compare_pindex_resources, NULL, NULL, 0, NULL, NULL);
+    system->printers_by_uri      = cupsArrayNew((cups_array_cb_t)compare_pindex_uris, NULL, NULL, 0, NULL, NULL);
+  }
 
   cupsArrayAdd(system->printers, printer);
 
+  // Index the printer by ID, resource path, and device URI.  Only the first
+  // printer for a given device URI is indexed...
+  if ((pindex = calloc(1, sizeof(_pappl_pindex_t))) != NULL)
+  {
+    pindex->printer_id = printer->printer_id;
+    pindex->resource   = printer->resource;
+    pindex->device_uri = printer->device_uri;
+    pindex->printer    = printer;
+
+    cupsArrayAdd(system->printers_by_id, pindex);
+    cupsArrayAdd(system->printers_by_resource, pindex);
+
+    if (!cupsArrayFind(system->printers_by_uri, pindex))
+      cupsArrayAdd(system->printers_by_uri, pindex);
+  }
+  else
+  {
+    papplLog(system, PAPPL_LOGLEVEL_ERROR, "Unable to allocate memory for printer index: %s", strerror(errno));
+  }
+
   if (!system->default_printer_id)
     system->default_printer_id = printer->printer_id;
 
@@ -119,6 +150,9 @@ papplSystemCreatePrinters(
 // path, unique integer identifier, or device URI.  If none of these is
 // specified, the current default printer is returned.
 //
+// If more than one printer uses the same device URI, the first printer that
+// was added is returned.
+//
 
 pappl_printer_t *			// O - Printer or `NULL` if none
 papplSystemFindPrinter(
@@ -127,9 +161,11 @@ papplSystemFindPrinter(
     int            printer_id,		// I - Printer ID or `0`
     const char     *device_uri)		// I - Device URI or `NULL`
 {
-  cups_len_t		i,		// Current printer index
-			count;		// Printer count
-  pappl_printer_t	*printer = NULL;// Matching printer
+  _pappl_pindex_t	key,		// Search key
+			*pindex = NULL;	// Matching index entry
+  char			temp[1024],	// Temporary resource path
+			*ptr;		// Pointer into resource path
+  pappl_printer_t	*printer;	// Matching printer
 
 
   // Range check input...
@@ -144,25 +180,30 @@ papplSystemFindPrinter(
     resource   = NULL;
   }
 
-  // Loop through the printers to find the one we want...
-  //
-  // Note: Cannot use cupsArrayGetFirst/Last since other threads might be
-  // enumerating the printers array.
+  if (resource)
+  {
+    // Look up the resource path, then each parent path until we find the
+    // printer...
+    papplCopyString(temp, resource, sizeof(temp));
+    key.resource = temp;
+
+    while ((pindex = (_pappl_pindex_t *)cupsArrayFind(system->printers_by_resource, &key)) == NULL && (ptr = strrchr(temp, '/')) != NULL && ptr > temp)
+      *ptr = '\0';
+  }
+
+  if (!pindex && printer_id > 0)
+  {
+    key.printer_id = printer_id;
+    pindex         = (_pappl_pindex_t *)cupsArrayFind(system->printers_by_id, &key);
+  }
 
-  for (i = 0, count = cupsArrayGetCount(system->printers); i < count; i ++)
+  if (!pindex && device_uri)
   {
-    printer = (pappl_printer_t *)cupsArrayGetElement(system->printers, i);
-
-    if (resource && !strncasecmp(printer->resource, resource, printer->resourcelen) && (!resource[printer->resourcelen] || resource[printer->resourcelen] == '/'))
-      break;
-    else if (printer->printer_id == printer_id)
-      break;
-    else if (device_uri && !strcmp(printer->device_uri, device_uri))
-      break;
+    key.device_uri = device_uri;
+    pindex         = (_pappl_pindex_t *)cupsArrayFind(system->printers_by_uri, &key);
   }
 
-  if (i >= count)
-    printer = NULL;
+  printer = pindex ? pindex->printer : NULL;
 
   _papplRWUnlock(system);
 
@@ -170,6 +211,95 @@ papplSystemFindPrinter(
 }
 
 
+//
+// '_papplSystemRemovePrinterNoLock()' - Remove a printer from the system object.
+//
+// The printer is removed from the printer indices and then freed.  The caller
+// must hold a write lock on the system object.
+//
+
+void
+_papplSystemRemovePrinterNoLock(
+    pappl_system_t  *system,		// I - System
+    pappl_printer_t *printer)		// I - Printer
+{
+  cups_len_t		i,		// Looping var
+			count;		// Number of index entries
+  _pappl_pindex_t	key,		// Search key
+			*pindex,	// Index entry for printer
+			*current;	// Current index entry
+
+
+  // Remove the printer from the indices...
+  key.printer_id = printer->printer_id;
+
+  if ((pindex = (_pappl_pindex_t *)cupsArrayFind(system->printers_by_id, &key)) != NULL && pindex->printer == printer)
+  {
+    cupsArrayRemove(system->printers_by_resource, pindex);
+
+    if (cupsArrayFind(system->printers_by_uri, pindex) == pindex)
+    {
+      // Index the next printer using the same device URI, if any...
+      cupsArrayRemove(system->printers_by_uri, pindex);
+
+      for (i = 0, count = cupsArrayGetCount(system->printers_by_id); i < count; i ++)
+      {
+        current = (_pappl_pindex_t *)cupsArrayGetElement(system->printers_by_id, i);
+
+        if (current != pindex && !strcmp(current->device_uri, pindex->device_uri))
+        {
+          cupsArrayAdd(system->printers_by_uri, current);
+          break;
+        }
+      }
+    }
+
+    cupsArrayRemove(system->printers_by_id, pindex);
+  }
+
+  // Then remove it from the printers array...
+  cupsArrayRemove(system->printers, printer);
+}
+
+
+//
+// 'compare_pindex_ids()' - Compare the IDs of two printer index entries.
+//
+
+static int				// O - Result of comparison
+compare_pindex_ids(_pappl_pindex_t *a,	// I - First index entry
+                   _pappl_pindex_t *b)	// I - Second index entry
+{
+  return (a->printer_id - b->printer_id);
+}
+
+
+//
+// 'compare_pindex_resources()' - Compare the resource paths of two printer index entries.
+//
+
+static int				// O - Result of comparison
+compare_pindex_resources(
+    _pappl_pindex_t *a,			// I - First index entry
+    _pappl_pindex_t *b)			// I - Second index entry
+{
+  return (strcasecmp(a->resource, b->resource));
+}
+
+
+//
+// 'compare_pindex_uris()' - Compare the device URIs of two printer index entries.
+//
+
+static int				// O - Result of comparison
+compare_pindex_uris(
+    _pappl_pindex_t *a,			// I - First index entry
+    _pappl_pindex_t *b)			// I - Second index entry
+{
+  return (strcmp(a->device_uri, b->device_uri));
+}
+
+
 //
 // 'compare_printers()' - Compare two printers.
 //
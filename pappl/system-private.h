@@ -10,6 +10,7 @@
 #ifndef _PAPPL_SYSTEM_PRIVATE_H_
 #  define _PAPPL_SYSTEM_PRIVATE_H_
 #  include "dnssd-private.h"
+#  include "log-private.h"
 #  include "subscription-private.h"
 #  include "system.h"
 
@@ -18,13 +19,32 @@
 // Constants...
 //
 
+#  define _PAPPL_AUTH_CACHE_MAX	100	// Maximum number of cached authentications
+#  define _PAPPL_AUTH_CACHE_TTL	300	// Lifetime of cached authentications in seconds
+#  define _PAPPL_DISCOVERY_MAX_AGE 300	// Maximum age of cached devices in seconds
+#  define _PAPPL_DISCOVERY_REFRESH 60	// Age of cached devices before a background refresh
 #  define _PAPPL_MAX_LISTENERS	32	// Maximum number of listener sockets
+#  define _PAPPL_POOL_TIMEOUT	30	// Idle keep-alive timeout for pooled clients
+#  define _PAPPL_COMPRESS_MIN	256	// Minimum size of compressed resources
+#  define _PAPPL_RFILE_MAX	262144	// Maximum size of resource files cached in memory
+#  define _PAPPL_MAX_JOURNAL	1000	// Maximum state journal records before compaction
+#  define _PAPPL_STATUS_POLL	0	// Default printer status interval in seconds (on-demand)
+#  define _PAPPL_STATUS_BACKOFF	300	// Maximum printer status interval after failures
 
 
 //
 // Types and structures...
 //
 
+typedef struct _pappl_authcache_s	// Authentication cache entry
+{
+  unsigned char	hash[32];			// Salted SHA2-256 hash of "username:password"
+  time_t	expires;			// Expiration time
+  size_t	used;				// Last use (for LRU eviction)
+  int		num_groups;			// Number of groups
+  gid_t		groups[32];			// Group IDs
+} _pappl_authcache_t;
+
 typedef struct _pappl_mime_filter_s	// MIME filter
 {
   const char		*src,			// Source MIME media type
@@ -33,6 +53,41 @@ typedef struct _pappl_mime_filter_s	// MIME filter
   void			*cbdata;		// Filter callback data
 } _pappl_mime_filter_t;
 
+typedef struct _pappl_jref_s		// Job reference for the state journal
+{
+  int			printer_id,		// Printer ID
+			job_id;			// Job ID
+} _pappl_jref_t;
+
+typedef struct _pappl_pindex_s		// Printer index entry
+{
+  int			printer_id;		// Printer ID
+  const char		*resource,		// Resource path
+			*device_uri;		// Device URI
+  pappl_printer_t	*printer;		// Printer
+} _pappl_pindex_t;
+
+typedef struct _pappl_discovery_s _pappl_discovery_t;
+					// Device discovery cache
+typedef struct _pappl_metrics_s _pappl_metrics_t;
+					// Request, job, and device metrics
+typedef struct _pappl_twheel_s _pappl_twheel_t;
+					// Timer wheel
+
+typedef struct _pappl_pool_s _pappl_pool_t;
+					// Client worker pool
+
+typedef struct _pappl_rfile_s		// Cached resource file
+{
+  size_t		use;			// Use count
+  dev_t			device;			// Device number
+  ino_t			inode;			// Inode number
+  time_t		last_modified;		// Modification date/time
+  size_t		length;			// Length of file
+  int			fd;			// File descriptor for large files or `-1` if cached
+  char			data[1];		// File data (up to `_PAPPL_RFILE_MAX` bytes)
+} _pappl_rfile_t;
+
 typedef struct _pappl_resource_s	// Resource
 {
   char			*path,			// Path
@@ -44,6 +99,11 @@ typedef struct _pappl_resource_s	// Resource
   size_t		length;			// Length of file/data
   pappl_resource_cb_t	cb;			// Dynamic callback
   void			*cbdata;		// Callback data
+  pthread_mutex_t	mutex;			// Mutex for cached file and compression data
+  _pappl_rfile_t	*file;			// Cached file data
+  bool			compress_checked,	// Has compression been checked?
+			compress;		// Compress when the client allows it?
+  size_t		gzip_length;		// Compressed length or `0` if unknown
 } _pappl_resource_t;
 
 struct _pappl_system_s			// System data
@@ -58,6 +118,11 @@ struct _pappl_system_s			// System data
   pthread_mutex_t	config_mutex;		// Mutex for configuration changes
   size_t		config_changes,		// Number of configuration changes
 			save_changes;		// Number of saved changes
+  char			*state_file;		// Last state file written
+  int			state_generation;	// Generation of state file and journal
+  bool			state_compact;		// Does the state file need to be rewritten?
+  size_t		state_records;		// Number of records in the state journal
+  cups_array_t		*state_jobs;		// Jobs changed since the last save
   char			*uuid,			// "system-uuid" value
 			*name,			// "system-name" value
 			*dns_sd_name,		// "system-dns-sd-name" value
@@ -78,6 +143,8 @@ struct _pappl_system_s			// System data
   int			logfd;			// Log file descriptor, if any
   pappl_loglevel_t	loglevel;		// Log level
   size_t		logmaxsize;		// Maximum log file size or `0` for none
+  off_t			logsize;		// Current log file size
+  _pappl_logq_t		*logq;			// Asynchronous log queue, if any
   char			*subtypes;		// DNS-SD sub-types, if any
   bool			tls_only;		// Only support TLS?
   char			*auth_service;		// PAM authorization service, if any
@@ -92,12 +159,31 @@ struct _pappl_system_s			// System data
 						// Listener sockets
   int			num_clients,		// Current number of clients
 			max_clients;		// Maximum number of clients
+  size_t		pool_workers,		// Number of client worker threads
+			pool_queue;		// Maximum number of queued client requests
+  _pappl_pool_t		*pool;			// Client worker pool, if any
+  pappl_cmetrics_t	cmetrics;		// Client connection metrics
+  pthread_mutex_t	html_mutex;		// Mutex for HTML output metrics
+  size_t		html_flushes,		// Number of HTML output buffer flushes
+			html_bytes;		// Number of HTML bytes sent
   cups_array_t		*links;			// Web navigation links
   cups_array_t		*resources;		// Array of resources
+  pthread_mutex_t	rmetrics_mutex;		// Mutex for resource metrics
+  pappl_rmetrics_t	rmetrics;		// Resource metrics
+  pthread_mutex_t	dcmetrics_mutex;	// Mutex for device connection metrics
+  pappl_dcmetrics_t	dcmetrics;		// Device connection metrics
+  pthread_mutex_t	imetrics_mutex;		// Mutex for image filter metrics
+  pappl_imetrics_t	imetrics;		// Image filter metrics
+  pthread_mutex_t	rsmetrics_mutex;	// Mutex for raster processing metrics
+  pappl_rsmetrics_t	rsmetrics;		// Raster processing metrics
+  _pappl_metrics_t	*metrics;		// Request, job, and device metrics, if any
   cups_array_t		*localizations;		// Array of localizations
   cups_array_t		*filters;		// Array of filters
   int			next_client;		// Next client number
-  cups_array_t		*printers;		// Array of printers
+  cups_array_t		*printers,		// Array of printers
+			*printers_by_id,	// Printer index by ID
+			*printers_by_resource,	// Printer index by resource path
+			*printers_by_uri;	// Printer index by device URI
   int			default_printer_id,	// Default printer-id
 			next_printer_id;	// Next printer-id
   char			password_hash[100];	// Access password hash
@@ -111,6 +197,11 @@ struct _pappl_system_s			// System data
   char			*auth_scheme;		// Authentication scheme
   pappl_auth_cb_t	auth_cb;		// Authentication callback
   void			*auth_cbdata;		// Authentication callback data
+  pthread_mutex_t	auth_mutex;		// Authentication cache mutex
+  cups_array_t		*auth_cache;		// Authentication cache
+  unsigned char		auth_salt[32];		// Authentication cache salt
+  size_t		auth_uses;		// Authentication cache use counter
+  pappl_ametrics_t	ametrics;		// Authentication cache metrics
   pappl_mime_cb_t	mime_cb;		// MIME typing callback
   void			*mime_cbdata;		// MIME typing callback data
   pappl_ipp_op_cb_t	op_cb;			// IPP operation callback
@@ -146,25 +237,56 @@ struct _pappl_system_s			// System data
   int			next_subscription_id;	// Next "notify-subscription-id" value
   pthread_cond_t	subscription_cond;	// Subscription condition variable
   pthread_mutex_t	subscription_mutex;	// Subscription mutex
-  cups_array_t		*timers;		// Timers array
+  time_t		subscription_time;	// Next subscription clean time
+  _pappl_twheel_t	*twheel;		// Timer wheel
+  _pappl_discovery_t	*discovery;		// Device discovery cache
   size_t		max_image_size;		// Maximum image file size (uncompressed)
   int			max_image_width,	// Maximum image file width
 			max_image_height;	// Maximum image file height
+  pthread_mutex_t	sched_mutex;		// Job scheduler mutex
+  pthread_cond_t	sched_cond;		// Job scheduler condition variable
+  cups_array_t		*sched_printers;	// Printers with pending jobs (FIFO)
+  int			sched_workers,		// Current number of job worker threads
+			sched_idle,		// Number of idle job worker threads
+			max_processing_jobs;	// Maximum number of processing jobs
+  bool			sched_stopping;		// Is the job scheduler stopping?
+  pappl_jmetrics_t	jmetrics;		// Job scheduler metrics
+  pthread_mutex_t	status_mutex;		// Printer status poller mutex
+  pthread_cond_t	status_cond;		// Printer status poller condition variable
+  pthread_t		status_tid;		// Printer status thread
+  int			status_interval;	// Printer status interval in seconds
+  bool			status_running,		// Is the printer status thread running?
+			status_stopping;	// Is the printer status thread stopping?
 };
 
-typedef struct _pappl_timer_s			// Timer callback data
-{
-  pappl_timer_cb_t	cb;			// Callback function
-  void			*cb_data;		// Callback data
-  time_t		next;			// Next time
-  int			interval;		// Timer interval
-} _pappl_timer_t;
-
 
 //
 // Functions...
 //
 
+extern void		_papplAuthCacheAdd(pappl_system_t *system, const char *username, const char *password, int num_groups, const gid_t *groups) _PAPPL_PRIVATE;
+extern void		_papplAuthCacheCopyMetrics(pappl_system_t *system, pappl_ametrics_t *metrics) _PAPPL_PRIVATE;
+extern int		_papplAuthCacheFind(pappl_system_t *system, const char *username, const char *password, gid_t *groups) _PAPPL_PRIVATE;
+extern void		_papplAuthCacheFlush(pappl_system_t *system) _PAPPL_PRIVATE;
+extern _pappl_discovery_t *_papplDiscoveryCreate(void) _PAPPL_PRIVATE;
+extern void		_papplDiscoveryDelete(_pappl_discovery_t *d) _PAPPL_PRIVATE;
+extern bool		_papplDiscoveryList(pappl_system_t *system, pappl_devtype_t types, int refresh_msecs, pappl_device_cb_t cb, void *data) _PAPPL_PRIVATE;
+extern size_t		_papplLockProfileCopyStats(size_t max_stats, pappl_lockstat_t *stats) _PAPPL_PRIVATE;
+extern void		_papplMetricsAddDevice(pappl_printer_t *printer, pappl_devmetrics_t *dmetrics) _PAPPL_PRIVATE;
+extern void		_papplMetricsAddJob(pappl_job_t *job) _PAPPL_PRIVATE;
+extern void		_papplMetricsAddRequest(pappl_client_t *client, ipp_op_t op, const struct timespec *start) _PAPPL_PRIVATE;
+extern _pappl_metrics_t	*_papplMetricsCreate(void) _PAPPL_PRIVATE;
+extern void		_papplMetricsDelete(_pappl_metrics_t *m) _PAPPL_PRIVATE;
+extern void		_papplMetricsRemovePrinter(pappl_printer_t *printer) _PAPPL_PRIVATE;
+extern void		_papplResourceAddMetrics(pappl_system_t *system, _pappl_resource_t *r, size_t length, bool compressed) _PAPPL_PRIVATE;
+extern void		_papplResourceCopyMetrics(pappl_system_t *system, pappl_rmetrics_t *metrics) _PAPPL_PRIVATE;
+extern _pappl_rfile_t	*_papplResourceGetFile(_pappl_resource_t *r) _PAPPL_PRIVATE;
+extern bool		_papplResourceIsCompressible(_pappl_resource_t *r, const void *data, size_t length) _PAPPL_PRIVATE;
+extern ssize_t		_papplResourceReadFile(_pappl_resource_t *r, _pappl_rfile_t *file, size_t offset, char *buffer, size_t bufsize) _PAPPL_PRIVATE;
+extern void		_papplResourceReleaseFile(_pappl_resource_t *r, _pappl_rfile_t *file) _PAPPL_PRIVATE;
+extern void		_papplStatusPollerRemove(pappl_printer_t *printer) _PAPPL_PRIVATE;
+extern void		_papplStatusPollerStart(pappl_system_t *system) _PAPPL_PRIVATE;
+extern void		_papplStatusPollerStop(pappl_system_t *system) _PAPPL_PRIVATE;
 extern void		_papplSystemAddEventNoLock(pappl_system_t *system, pappl_printer_t *printer, pappl_job_t *job, pappl_event_t event, const char *message, ...) _PAPPL_FORMAT(5, 6) _PAPPL_PRIVATE;
 extern void		_papplSystemAddEventNoLockv(pappl_system_t *system, pappl_printer_t *printer, pappl_job_t *job, pappl_event_t event, const char *message, va_list ap) _PAPPL_PRIVATE;
 extern void		_papplSystemAddLoc(pappl_system_t *system, pappl_loc_t *loc) _PAPPL_PRIVATE;
@@ -177,20 +299,31 @@ extern void		_papplSystemExportVersions(pappl_system_t *system, ipp_t *ipp, ipp_
 extern _pappl_mime_filter_t *_papplSystemFindMIMEFilter(pappl_system_t *system, const char *srctype, const char *dsttype) _PAPPL_PRIVATE;
 extern _pappl_resource_t *_papplSystemFindResourceForLanguage(pappl_system_t *system, const char *language) _PAPPL_PRIVATE;
 extern _pappl_resource_t *_papplSystemFindResourceForPath(pappl_system_t *system, const char *path) _PAPPL_PRIVATE;
+extern void		_papplSystemHousekeeping(pappl_system_t *system) _PAPPL_PRIVATE;
+extern void		_papplSystemJobChanged(pappl_system_t *system, pappl_job_t *job) _PAPPL_PRIVATE;
 extern char		*_papplSystemMakeUUID(pappl_system_t *system, const char *printer_name, int job_id, char *buffer, size_t bufsize) _PAPPL_PRIVATE;
 extern void		_papplSystemNeedClean(pappl_system_t *system) _PAPPL_PRIVATE;
 extern void		_papplSystemProcessIPP(pappl_client_t *client) _PAPPL_PRIVATE;
+extern void		_papplSystemRemovePrinterNoLock(pappl_system_t *system, pappl_printer_t *printer) _PAPPL_PRIVATE;
 extern bool		_papplSystemRegisterDNSSDNoLock(pappl_system_t *system) _PAPPL_PRIVATE;
 extern void		_papplSystemSetHostNameNoLock(pappl_system_t *system, const char *value) _PAPPL_PRIVATE;
 extern void		_papplSystemStatusUI(pappl_system_t *system) _PAPPL_PRIVATE;
 extern void		_papplSystemUnregisterDNSSDNoLock(pappl_system_t *system) _PAPPL_PRIVATE;
+extern bool		_papplTimerWheelAdd(pappl_system_t *system, time_t start, int interval, pappl_timer_cb_t cb, void *cb_data) _PAPPL_PRIVATE;
+extern _pappl_twheel_t	*_papplTimerWheelCreate(void) _PAPPL_PRIVATE;
+extern void		_papplTimerWheelDelete(_pappl_twheel_t *tw) _PAPPL_PRIVATE;
+extern void		_papplTimerWheelRemove(pappl_system_t *system, pappl_timer_cb_t cb, void *cb_data) _PAPPL_PRIVATE;
+extern void		_papplTimerWheelStart(pappl_system_t *system) _PAPPL_PRIVATE;
+extern void		_papplTimerWheelStop(pappl_system_t *system) _PAPPL_PRIVATE;
 
 extern void		_papplSystemWebAddPrinter(pappl_client_t *client, pappl_system_t *system) _PAPPL_PRIVATE;
 extern void		_papplSystemWebConfig(pappl_client_t *client, pappl_system_t *system) _PAPPL_PRIVATE;
 extern void		_papplSystemWebConfigFinalize(pappl_system_t *system, cups_len_t num_form, cups_option_t *form) _PAPPL_PRIVATE;
 extern void		_papplSystemWebHome(pappl_client_t *client, pappl_system_t *system) _PAPPL_PRIVATE;
 extern void		_papplSystemWebLogFile(pappl_client_t *client, pappl_system_t *system) _PAPPL_PRIVATE;
+extern void		_papplSystemWebLocks(pappl_client_t *client, pappl_system_t *system) _PAPPL_PRIVATE;
 extern void		_papplSystemWebLogs(pappl_client_t *client, pappl_system_t *system) _PAPPL_PRIVATE;
+extern void		_papplSystemWebMetrics(pappl_client_t *client, pappl_system_t *system) _PAPPL_PRIVATE;
 extern void		_papplSystemWebNetwork(pappl_client_t *client, pappl_system_t *system) _PAPPL_PRIVATE;
 extern void		_papplSystemWebSecurity(pappl_client_t *client, pappl_system_t *system) _PAPPL_PRIVATE;
 extern void		_papplSystemWebSettings(pappl_client_t *client) _PAPPL_PRIVATE;
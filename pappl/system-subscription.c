@@ -92,12 +92,17 @@ _papplSystemAddEventNoLockv(
     va_list         ap)			// I - Pointer to additional arguments
 {
   pappl_subscription_t	*sub;		// Current subscription
-  ipp_t			*n;		// Notify event attributes
-  char			uri[1024] = "",	// "notify-printer/system-uri" value
-			text[1024];	// "notify-text" value
+  _pappl_notify_t	*n = NULL;	// Shared notification
+  char			text[1024];	// "notify-text" value
   va_list		cap;		// Copy of additional arguments
 
 
+  // Record job changes for the state journal.  Progress and fetchable events
+  // don't change any saved values that aren't also updated by the next state
+  // change...
+  if (job && (event & (PAPPL_EVENT_JOB_STATE_ALL | PAPPL_EVENT_JOB_CONFIG_CHANGED)))
+    _papplSystemJobChanged(system, job);
+
   // Loop through all of the subscriptions and deliver any events...
   _papplRWLockRead(system);
 
@@ -111,70 +116,35 @@ _papplSystemAddEventNoLockv(
   {
     if ((sub->mask & event) && (!sub->job || job == sub->job) && (!sub->printer || printer == sub->printer))
     {
-      _papplRWLockWrite(sub);
-
-      n = ippNew();
-      ippAddString(n, IPP_TAG_EVENT_NOTIFICATION, IPP_CONST_TAG(IPP_TAG_CHARSET), "notify-charset", NULL, "utf-8");
-      ippAddString(n, IPP_TAG_EVENT_NOTIFICATION, IPP_CONST_TAG(IPP_TAG_LANGUAGE), "notify-natural-language", NULL, sub->language);
-      if (printer)
-      {
-        if (!uri[0])
-          httpAssembleURI(HTTP_URI_CODING_ALL, uri, sizeof(uri), "ipps", NULL, system->hostname, system->port, printer->resource);
-
-        ippAddString(n, IPP_TAG_EVENT_NOTIFICATION, IPP_TAG_URI, "notify-printer-uri", NULL, uri);
-      }
-      else
-      {
-        if (!uri[0])
-          httpAssembleURI(HTTP_URI_CODING_ALL, uri, sizeof(uri), "ipps", NULL, system->hostname, system->port, "/ipp/system");
-
-        ippAddString(n, IPP_TAG_EVENT_NOTIFICATION, IPP_TAG_URI, "notify-system-uri", NULL, uri);
-      }
-      if (job)
-        ippAddInteger(n, IPP_TAG_EVENT_NOTIFICATION, IPP_TAG_INTEGER, "notify-job-id", job->job_id);
-      ippAddInteger(n, IPP_TAG_EVENT_NOTIFICATION, IPP_TAG_INTEGER, "notify-subscription-id", sub->subscription_id);
-      ippAddString(n, IPP_TAG_EVENT_NOTIFICATION, IPP_CONST_TAG(IPP_TAG_URI), "notify-subscription-uuid", NULL, sub->uuid);
-      ippAddInteger(n, IPP_TAG_EVENT_NOTIFICATION, IPP_TAG_INTEGER, "notify-sequence-number", ++ sub->last_sequence);
-      ippAddString(n, IPP_TAG_EVENT_NOTIFICATION, IPP_CONST_TAG(IPP_TAG_KEYWORD), "notify-subscribed-event", NULL, _papplSubscriptionEventString(event));
-      if (message)
-      {
-        va_copy(cap, ap);
-        vsnprintf(text, sizeof(text), message, cap);
-        va_end(cap);
-        ippAddString(n, IPP_TAG_EVENT_NOTIFICATION, IPP_TAG_TEXT, "notify-text", NULL, text);
-      }
-      if (job && (event & PAPPL_EVENT_JOB_ALL))
+      if (!n)
       {
-        _papplJobCopyStateNoLock(job, IPP_TAG_EVENT_NOTIFICATION, n, NULL);
-
-	if (event == PAPPL_EVENT_JOB_CREATED)
-	{
-	  ippAddString(n, IPP_TAG_EVENT_NOTIFICATION, IPP_TAG_NAME, "job-name", NULL, job->name);
-	  ippAddString(n, IPP_TAG_EVENT_NOTIFICATION, IPP_TAG_NAME, "job-originating-user-name", NULL, job->username);
-	}
-      }
-      if (!sub->job && printer && (event & PAPPL_EVENT_PRINTER_ALL))
-        _papplPrinterCopyStateNoLock(printer, IPP_TAG_EVENT_NOTIFICATION, n, NULL, NULL);
-      // TODO: add system event notifications
-      if (printer)
-	ippAddInteger(n, IPP_TAG_EVENT_NOTIFICATION, IPP_TAG_INTEGER, "printer-up-time", (int)(time(NULL) - printer->start_time));
-      else
-	ippAddInteger(n, IPP_TAG_EVENT_NOTIFICATION, IPP_TAG_INTEGER, "system-up-time", (int)(time(NULL) - system->start_time));
-
-      cupsArrayAdd(sub->events, n);
-      if (cupsArrayGetCount(sub->events) > PAPPL_MAX_EVENTS)
-      {
-	cupsArrayRemove(sub->events, cupsArrayGetFirst(sub->events));
-	sub->first_sequence ++;
+        // Create the notification once for all subscriptions...
+        if (message)
+        {
+          va_copy(cap, ap);
+          vsnprintf(text, sizeof(text), message, cap);
+          va_end(cap);
+        }
+
+        if ((n = _papplNotifyCreate(system, printer, job, event, message ? text : NULL)) == NULL)
+          break;
       }
 
+      _papplRWLockWrite(sub);
+      _papplSubscriptionAddNotifyNoLock(sub, n);
       _papplRWUnlock(sub);
-
-      pthread_cond_broadcast(&system->subscription_cond);
     }
   }
 
   _papplRWUnlock(system);
+
+  if (n)
+  {
+    // Release our reference and wake up any Get-Notifications requests...
+    _papplNotifyRelease(n);
+
+    pthread_cond_broadcast(&system->subscription_cond);
+  }
 }
 
 
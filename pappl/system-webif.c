@@ -79,7 +79,7 @@ static X509_EXTENSION *openssl_create_san(const char *hostname, const char *loca
 #endif // HAVE_OPENSSL
 static bool	system_device_cb(const char *device_info, const char *device_uri, const char *device_id, void *data);
 static void	system_footer(pappl_client_t *client);
-static void	system_header(pappl_client_t *client, const char *title);
+static void	system_header(pappl_client_t *client, const char *title, time_t last_modified);
 static void	system_redirect(pappl_client_t *client, const char *title, const char *resource, int seconds, pappl_timer_cb_t cb, _pappl_redirect_t *cb_data);
 static bool	system_redirect_network_cb(pappl_system_t *system, _pappl_redirect_t *data);
 static bool	system_redirect_wifi_cb(pappl_system_t *system, _pappl_redirect_t *data);
@@ -509,7 +509,7 @@ _papplSystemWebAddPrinter(
     cupsFreeOptions(num_form, form);
   }
 
-  system_header(client, _PAPPL_LOC("Add Printer"));
+  system_header(client, _PAPPL_LOC("Add Printer"), 0);
 
   if (status)
     papplClientHTMLPrintf(client, "<div class=\"banner\">%s</div>\n", papplClientGetLocString(client, status));
@@ -525,7 +525,7 @@ _papplSystemWebAddPrinter(
   devdata.client     = client;
   devdata.device_uri = device_uri;
 
-  papplDeviceList(PAPPL_DEVTYPE_ALL, system_device_cb, &devdata, papplLogDevice, system);
+  _papplDiscoveryList(system, PAPPL_DEVTYPE_ALL, 0, system_device_cb, &devdata);
 
   papplClientHTMLPrintf(client,
 			"<option value=\"socket\">%s</option></tr>\n"
@@ -601,7 +601,7 @@ _papplSystemWebConfig(
     cupsFreeOptions(num_form, form);
   }
 
-  system_header(client, _PAPPL_LOC("Configuration"));
+  system_header(client, _PAPPL_LOC("Configuration"), 0);
   if (status)
     papplClientHTMLPrintf(client, "<div class=\"banner\">%s</div>\n", papplClientGetLocString(client, status));
 
@@ -690,7 +690,52 @@ _papplSystemWebHome(
     pappl_client_t *client,		// I - Client
     pappl_system_t *system)		// I - System
 {
-  system_header(client, NULL);
+  pappl_printer_t	*printer;	// Current printer
+  cups_len_t		i,		// Looping var
+			count;		// Number of printers
+  time_t		curtime,	// Current time
+			page_time,	// Last change to page
+			status_time;	// Last change to printer status
+  char			session_key[65];// Session key
+
+
+  // The page content only changes with the configuration, session key (used
+  // by the forms), printer status, and language, so clients can use their
+  // cached copy if none of these have changed since.  The language is looked
+  // up first so that the response reports it and varies on Accept-Language...
+  papplClientGetLoc(client);
+  papplSystemGetSessionKey(system, session_key, sizeof(session_key));
+
+  pthread_mutex_lock(&system->config_mutex);
+  page_time = system->config_time > system->start_time ? system->config_time : system->start_time;
+  pthread_mutex_unlock(&system->config_mutex);
+
+  pthread_rwlock_rdlock(&system->session_rwlock);
+  if (page_time < system->session_time)
+    page_time = system->session_time;
+  pthread_rwlock_unlock(&system->session_rwlock);
+
+  _papplRWLockRead(system);
+  for (i = 0, count = cupsArrayGetCount(system->printers); i < count; i ++)
+  {
+    printer = (pappl_printer_t *)cupsArrayGetElement(system->printers, i);
+
+    if ((status_time = _papplPrinterWebGetStatusTime(printer)) > page_time)
+      page_time = status_time;
+  }
+  _papplRWUnlock(system);
+
+  if (!_papplClientCheckIfModified(client, page_time))
+  {
+    papplClientRespond(client, HTTP_STATUS_NOT_MODIFIED, NULL, NULL, page_time, 0);
+    return;
+  }
+
+  // Only provide the modification time once it is in the past, since later
+  // changes in the same second could not be detected by the client...
+  curtime = time(NULL);
+
+  system_header(client, NULL, page_time < curtime ? page_time : 0);
 
   papplClientHTMLPrintf(client,
 			"      <div class=\"row\">\n"
@@ -830,6 +875,51 @@ _papplSystemWebLogFile(
 }
 
 
+//
+// '_papplSystemWebLocks()' - Show the lock contention statistics.
+//
+
+void
+_papplSystemWebLocks(
+    pappl_client_t *client,		// I - Client
+    pappl_system_t *system)		// I - System
+{
+  size_t		i,		// Looping var
+			num_stats;	// Number of lock call sites
+  pappl_lockstat_t	stats[50],	// Lock call site statistics
+			*stat;		// Current call site
+
+
+  if (!papplClientHTMLAuthorize(client))
+    return;
+
+  num_stats = papplSystemGetLockStats(system, sizeof(stats) / sizeof(stats[0]), stats);
+
+  system_header(client, _PAPPL_LOC("Lock Statistics"), 0);
+
+  if (num_stats > 0)
+  {
+    papplClientHTMLPrintf(client,
+			  "          <table class=\"list\" summary=\"Locks\">\n"
+			  "            <thead>\n"
+			  "              <tr><th>%s</th><th>%s</th><th>%s</th><th>%s</th><th>%s</th><th>%s</th><th>%s</th></tr>\n"
+			  "            </thead>\n"
+			  "            <tbody>\n", papplClientGetLocString(client, _PAPPL_LOC("Lock")), papplClientGetLocString(client, _PAPPL_LOC("Call Site")), papplClientGetLocString(client, _PAPPL_LOC("Acquired")), papplClientGetLocString(client, _PAPPL_LOC("Contended")), papplClientGetLocString(client, _PAPPL_LOC("Wait Time (ms)")), papplClientGetLocString(client, _PAPPL_LOC("Maximum Wait Time (ms)")), papplClientGetLocString(client, _PAPPL_LOC("Hold Time (ms)")));
+
+    for (i = 0, stat = stats; i < num_stats; i ++, stat ++)
+      papplClientHTMLPrintf(client, "              <tr><td>%s (%s)</td><td>%s() %s:%d</td><td>%lu</td><td>%lu</td><td>%.3f</td><td>%.3f</td><td>%.3f</td></tr>\n", stat->lock, stat->write ? "write" : "read", stat->func, stat->file, stat->line, (unsigned long)stat->acquires, (unsigned long)stat->contended, 0.001 * stat->wait_usecs, 0.001 * stat->max_wait_usecs, 0.001 * stat->hold_usecs);
+
+    papplClientHTMLPuts(client,
+			"            </tbody>\n"
+			"          </table>\n");
+  }
+  else
+    papplClientHTMLPrintf(client, "        <p>%s</p>\n", papplClientGetLocString(client, _PAPPL_LOC("No lock statistics.")));
+
+  system_footer(client);
+}
+
+
 //
 // '_papplSystemWebLogs()' - Show the system logs
 //
@@ -897,7 +987,7 @@ _papplSystemWebLogs(
     cupsFreeOptions(num_form, form);
   }
 
-  system_header(client, _PAPPL_LOC("Logs"));
+  system_header(client, _PAPPL_LOC("Logs"), 0);
 
   if (status)
     papplClientHTMLPrintf(client, "<div class=\"banner\">%s</div>\n", papplClientGetLocString(client, status));
@@ -1149,7 +1239,7 @@ _papplSystemWebNetwork(
     cupsFreeOptions(num_form, form);
   }
 
-  system_header(client, _PAPPL_LOC("Networking"));
+  system_header(client, _PAPPL_LOC("Networking"), 0);
 
   if (status)
     papplClientHTMLPrintf(client, "<div class=\"banner\">%s</div>\n", papplClientGetLocString(client, status));
@@ -1444,7 +1534,7 @@ _papplSystemWebSecurity(
     cupsFreeOptions(num_form, form);
   }
 
-  system_header(client, _PAPPL_LOC("Security"));
+  system_header(client, _PAPPL_LOC("Security"), 0);
 
   if (status)
     papplClientHTMLPrintf(client, "<div class=\"banner\">%s</div>\n", papplClientGetLocString(client, status));
@@ -1660,7 +1750,7 @@ _papplSystemWebTLSInstall(
     cupsFreeOptions(num_form, form);
   }
 
-  system_header(client, _PAPPL_LOC("Install TLS Certificate"));
+  system_header(client, _PAPPL_LOC("Install TLS Certificate"), 0);
 
   if (status)
     papplClientHTMLPrintf(client, "<div class=\"banner\">%s</div>\n", papplClientGetLocString(client, status));
@@ -1748,9 +1838,9 @@ _papplSystemWebTLSNew(
   }
 
   if (!strcmp(client->uri, "/tls-new-crt"))
-    system_header(client, _PAPPL_LOC("Create New TLS Certificate"));
+    system_header(client, _PAPPL_LOC("Create New TLS Certificate"), 0);
   else
-    system_header(client, _PAPPL_LOC("Create TLS Certificate Request"));
+    system_header(client, _PAPPL_LOC("Create TLS Certificate Request"), 0);
 
   if (status)
   {
@@ -1916,7 +2006,7 @@ _papplSystemWebWiFi(
   }
 
   // Show the Wi-Fi configuration
-  system_header(client, _PAPPL_LOC("Wi-Fi Configuration"));
+  system_header(client, _PAPPL_LOC("Wi-Fi Configuration"), 0);
 
   if (status)
     papplClientHTMLPrintf(client, "<div class=\"banner\">%s</div>\n", papplClientGetLocString(client, status));
@@ -2315,13 +2405,15 @@ system_footer(pappl_client_t *client)	// I - Client
 
 static void
 system_header(pappl_client_t *client,	// I - Client
-              const char     *title)	// I - Title
+              const char     *title,	// I - Title
+              time_t         last_modified)
+					// I - Last-Modified date/time or `0` for none
 {
   char		text[1024];		// Localized version number
   const char	*header;		// Header text
 
 
-  if (!papplClientRespond(client, HTTP_STATUS_OK, NULL, "text/html", 0, 0))
+  if (!papplClientRespond(client, HTTP_STATUS_OK, NULL, "text/html", last_modified, 0))
     return;
 
   papplClientHTMLHeader(client, title, 0);
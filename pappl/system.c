@@ -89,8 +89,9 @@ _papplSystemConfigChanged(
 
   if (system->is_running)
   {
-    system->config_time = time(NULL);
+    system->config_time   = time(NULL);
     system->config_changes ++;
+    system->state_compact = true;
   }
 
   pthread_mutex_unlock(&system->config_mutex);
@@ -120,6 +121,10 @@ _papplSystemConfigChanged(
 // - `PAPPL_SOPTIONS_WEB_TLS`: Include the TLS settings page.
 // - `PAPPL_SOPTIONS_USB_PRINTER`: Accept jobs via USB for the default printer
 //   (embedded Linux only).
+// - `PAPPL_SOPTIONS_WORKER_POOL`: Process client connections using a fixed
+//   pool of worker threads instead of a thread per connection (Linux only).
+// - `PAPPL_SOPTIONS_METRICS`: Collect IPP request, job, and device metrics and
+//   provide them in the Prometheus text format at "/metrics".
 //
 // The "name" argument specifies a human-readable name for the system.
 //
@@ -175,8 +180,18 @@ papplSystemCreate(
   pthread_rwlock_init(&system->rwlock, NULL);
   pthread_rwlock_init(&system->session_rwlock, NULL);
   pthread_mutex_init(&system->config_mutex, NULL);
+  pthread_mutex_init(&system->auth_mutex, NULL);
+  pthread_mutex_init(&system->html_mutex, NULL);
+  pthread_mutex_init(&system->rmetrics_mutex, NULL);
+  pthread_mutex_init(&system->dcmetrics_mutex, NULL);
+  pthread_mutex_init(&system->imetrics_mutex, NULL);
+  pthread_mutex_init(&system->rsmetrics_mutex, NULL);
   pthread_mutex_init(&system->subscription_mutex, NULL);
   pthread_cond_init(&system->subscription_cond, NULL);
+  pthread_mutex_init(&system->sched_mutex, NULL);
+  pthread_cond_init(&system->sched_cond, NULL);
+  pthread_mutex_init(&system->status_mutex, NULL);
+  pthread_cond_init(&system->status_cond, NULL);
 
   system->options           = options;
   system->start_time        = time(NULL);
@@ -195,11 +210,21 @@ papplSystemCreate(
   system->admin_gid         = (gid_t)-1;
   system->auth_service      = auth_service ? strdup(auth_service) : NULL;
   system->max_subscriptions = 100;
+  system->sched_printers    = cupsArrayNew(NULL, NULL, NULL, 0, NULL, NULL);
+  system->status_interval   = _PAPPL_STATUS_POLL;
 
   papplSystemSetMaxClients(system, 0);
   papplSystemSetMaxImageSize(system, 0, 0, 0);
+  papplSystemSetMaxProcessingJobs(system, 0);
+  papplSystemSetWorkerPool(system, 0, 0);
 
-  if (!system->name || !system->dns_sd_name || (spooldir && !system->directory) || (logfile && !system->logfile) || (subtypes && !system->subtypes) || (auth_service && !system->auth_service))
+  system->twheel            = _papplTimerWheelCreate();
+  system->discovery         = _papplDiscoveryCreate();
+
+  if (options & PAPPL_SOPTIONS_METRICS)
+    system->metrics = _papplMetricsCreate();
+
+  if (!system->name || !system->dns_sd_name || !system->sched_printers || !system->twheel || !system->discovery || ((options & PAPPL_SOPTIONS_METRICS) && !system->metrics) || (spooldir && !system->directory) || (logfile && !system->logfile) || (subtypes && !system->subtypes) || (auth_service && !system->auth_service))
     goto fatal;
 
   // Make sure the system name and UUID are initialized...
@@ -279,14 +304,21 @@ papplSystemDelete(
     pappl_system_t *system)		// I - System object
 {
   cups_len_t	i;			// Looping var
-  _pappl_timer_t *t;			// Current timer
 
 
   if (!system || system->is_running)
     return;
 
+  if (system->twheel)
+    _papplTimerWheelStop(system);
+  _papplStatusPollerStop(system);
+  _papplJobSchedulerStop(system);
+
   _papplSystemUnregisterDNSSDNoLock(system);
 
+  cupsArrayDelete(system->printers_by_uri);
+  cupsArrayDelete(system->printers_by_resource);
+  cupsArrayDelete(system->printers_by_id);
   cupsArrayDelete(system->printers);
 
   free(system->uuid);
@@ -303,8 +335,7 @@ papplSystemDelete(
   free(system->admin_group);
   free(system->default_print_group);
 
-  if (system->logfd >= 0 && system->logfd != 2)
-    close(system->logfd);
+  _papplLogClose(system);
 
   for (i = 0; i < system->num_listeners; i ++)
 #if _WIN32
@@ -317,27 +348,135 @@ papplSystemDelete(
   cupsArrayDelete(system->links);
   cupsArrayDelete(system->resources);
   cupsArrayDelete(system->localizations);
+  pthread_mutex_destroy(&system->html_mutex);
+  pthread_mutex_destroy(&system->rmetrics_mutex);
+  pthread_mutex_destroy(&system->dcmetrics_mutex);
+  pthread_mutex_destroy(&system->imetrics_mutex);
+  pthread_mutex_destroy(&system->rsmetrics_mutex);
+  cupsArrayDelete(system->auth_cache);
+  pthread_mutex_destroy(&system->auth_mutex);
+  _papplMetricsDelete(system->metrics);
 
   _papplSystemCleanSubscriptions(system, true);
   cupsArrayDelete(system->subscriptions);
   pthread_cond_destroy(&system->subscription_cond);
   pthread_mutex_destroy(&system->subscription_mutex);
 
-  for (t = (_pappl_timer_t *)cupsArrayGetFirst(system->timers); t; t = (_pappl_timer_t *)cupsArrayGetNext(system->timers))
-  {
-    cupsArrayRemove(system->timers, t);
-    free(t);
-  }
-  cupsArrayDelete(system->timers);
+  _papplTimerWheelDelete(system->twheel);
+  _papplDiscoveryDelete(system->discovery);
+
+  cupsArrayDelete(system->sched_printers);
+  pthread_cond_destroy(&system->sched_cond);
+  pthread_mutex_destroy(&system->sched_mutex);
+
+  pthread_cond_destroy(&system->status_cond);
+  pthread_mutex_destroy(&system->status_mutex);
 
   pthread_rwlock_destroy(&system->rwlock);
   pthread_rwlock_destroy(&system->session_rwlock);
   pthread_mutex_destroy(&system->config_mutex);
+  free(system->state_file);
+  cupsArrayDelete(system->state_jobs);
 
   free(system);
 }
 
 
+//
+// '_papplSystemHousekeeping()' - Do periodic housekeeping for a system.
+//
+// This function is called once a second from the timer thread to reopen the
+// log file, handle DNS-SD name collisions and host name changes, save the
+// configuration, clean out old jobs and subscriptions, and close idle device
+// connections.
+//
+
+void
+_papplSystemHousekeeping(
+    pappl_system_t *system)		// I - System
+{
+  cups_len_t		i,		// Looping var
+			count;		// Number of printers
+  pappl_printer_t	*printer;	// Current printer
+  int			dns_sd_host_changes;
+					// Current number of host name changes
+  bool			save_changes;	// Save changes?
+  time_t		curtime;	// Current time
+
+
+  if (restart_logging)
+  {
+    restart_logging = false;
+    _papplLogOpen(system);
+  }
+
+  _papplRWLockRead(system);
+
+  dns_sd_host_changes = _papplDNSSDGetHostChanges();
+
+  if (system->dns_sd_any_collision || system->dns_sd_host_changes != dns_sd_host_changes)
+  {
+    // Handle name collisions...
+    bool		force_dns_sd = system->dns_sd_host_changes != dns_sd_host_changes;
+					// Force re-registration?
+
+    if (force_dns_sd)
+      _papplSystemSetHostNameNoLock(system, NULL);
+
+    if (system->dns_sd_collision || force_dns_sd)
+      _papplSystemRegisterDNSSDNoLock(system);
+
+    for (i = 0, count = cupsArrayGetCount(system->printers); i < count; i ++)
+    {
+      printer = (pappl_printer_t *)cupsArrayGetElement(system->printers, i);
+
+      if (printer->dns_sd_collision || force_dns_sd)
+        _papplPrinterRegisterDNSSDNoLock(printer);
+    }
+
+    system->dns_sd_any_collision = false;
+    system->dns_sd_host_changes  = dns_sd_host_changes;
+  }
+
+  _papplRWUnlock(system);
+
+  pthread_mutex_lock(&system->config_mutex);
+  save_changes = system->config_changes > system->save_changes;
+  pthread_mutex_unlock(&system->config_mutex);
+
+  if (save_changes)
+  {
+    system->save_changes = system->config_changes;
+
+    if (system->save_cb)
+    {
+      // Save the configuration...
+      (system->save_cb)(system, system->save_cbdata);
+    }
+  }
+
+  // Clean out old jobs and subscriptions...
+  curtime = time(NULL);
+
+  if (system->clean_time && curtime >= system->clean_time)
+    papplSystemCleanJobs(system);
+
+  if (curtime >= system->subscription_time)
+  {
+    _papplSystemCleanSubscriptions(system, false);
+    system->subscription_time = curtime + 10;
+  }
+
+  // Close idle device connections...
+  _papplRWLockRead(system);
+
+  for (i = 0, count = cupsArrayGetCount(system->printers); i < count; i ++)
+    _papplPrinterCloseIdleDevice((pappl_printer_t *)cupsArrayGetElement(system->printers, i), curtime);
+
+  _papplRWUnlock(system);
+}
+
+
 //
 // '_papplSystemMakeUUID()' - Make a UUID for a system, printer, or job.
 //
@@ -392,19 +531,12 @@ papplSystemRun(pappl_system_t *system)	// I - System
 {
   cups_len_t		i,		// Looping var
 			count;		// Number of listeners that fired
-  int			pcount,		// Poll count
-			ptimeout;	// Poll timeout
+  int			pcount;		// Poll count
   pappl_client_t	*client;	// New client
   char			header[HTTP_MAX_VALUE];
 					// Server: header value
-  int			dns_sd_host_changes;
-					// Current number of host name changes
   pappl_printer_t	*printer;	// Current printer
   pthread_attr_t	tattr;		// Thread creation attributes
-  struct timeval	curtime;	// Current time
-  time_t		next,		// Next time for scheduling...
-			subtime = 0;	// Subscription checking time
-  _pappl_timer_t	*timer;		// Current timer
   bool			save_changes;	// Save changes?
 
 
@@ -428,6 +560,9 @@ papplSystemRun(pappl_system_t *system)	// I - System
   system->is_running = true;
   _papplRWUnlock(system);
 
+  _papplJobSchedulerStart(system);
+  _papplStatusPollerStart(system);
+
   // Add fallback resources...
   papplSystemAddResourceData(system, "/favicon.png", "image/png", icon_md_png, sizeof(icon_md_png));
   papplSystemAddResourceData(system, "/navicon.png", "image/png", icon_sm_png, sizeof(icon_sm_png));
@@ -440,6 +575,17 @@ papplSystemRun(pappl_system_t *system)	// I - System
     papplSystemAddLink(system, _PAPPL_LOC("View Logs"), "/logs", PAPPL_LOPTIONS_LOGGING | PAPPL_LOPTIONS_HTTPS_REQUIRED);
   }
 
+#ifdef PAPPL_LOCK_PROFILE
+  if (system->options & PAPPL_SOPTIONS_WEB_INTERFACE)
+  {
+    papplSystemAddResourceCallback(system, "/locks", "text/html", (pappl_resource_cb_t)_papplSystemWebLocks, system);
+    papplSystemAddLink(system, _PAPPL_LOC("Lock Statistics"), "/locks", PAPPL_LOPTIONS_LOGGING | PAPPL_LOPTIONS_HTTPS_REQUIRED);
+  }
+#endif // PAPPL_LOCK_PROFILE
+
+  if (system->metrics)
+    papplSystemAddResourceCallback(system, "/metrics", "text/plain", (pappl_resource_cb_t)_papplSystemWebMetrics, system);
+
   if (system->options & PAPPL_SOPTIONS_WEB_INTERFACE)
   {
     if (system->options & PAPPL_SOPTIONS_MULTI_QUEUE)
@@ -550,6 +696,10 @@ papplSystemRun(pappl_system_t *system)	// I - System
     }
   }
 
+  // Start the client worker pool as needed...
+  if ((system->options & PAPPL_SOPTIONS_WORKER_POOL) && !_papplClientPoolStart(system))
+    papplLog(system, PAPPL_LOGLEVEL_WARN, "Client worker pool not available, using a thread per connection.");
+
   // Start the USB gadget as needed...
   if ((system->options & PAPPL_SOPTIONS_USB_PRINTER) && (printer = papplSystemFindPrinter(system, NULL, system->default_printer_id, NULL)) != NULL)
   {
@@ -562,41 +712,15 @@ papplSystemRun(pappl_system_t *system)	// I - System
     }
   }
 
-  // Loop until we are shutdown or have a hard error...
+  // Run timers and housekeeping on a separate thread...
+  _papplTimerWheelStart(system);
+
+  // Loop until we are shutdown or have a hard error.  The timer thread does
+  // everything else, so this loop just accepts connections and wakes up once a
+  // second to check for a shutdown...
   for (;;)
   {
-    if (restart_logging)
-    {
-      restart_logging = false;
-      _papplLogOpen(system);
-    }
-
-    gettimeofday(&curtime, NULL);
-
-    _papplRWLockRead(system);
-
-    if (system->shutdown_time || sigterm_time)
-      next = curtime.tv_sec + 1;
-    else
-      next = curtime.tv_sec + 30;
-
-    if ((timer = (_pappl_timer_t *)cupsArrayGetFirst(system->timers)) != NULL && timer->next < next)
-      next = timer->next;
-
-    if (system->clean_time && system->clean_time < next)
-      next = system->clean_time;
-
-    if (subtime < next && cupsArrayGetCount(system->subscriptions) > 0)
-      next = subtime;
-
-    _papplRWUnlock(system);
-
-    if (next <= curtime.tv_sec)
-      ptimeout = 0;
-    else
-      ptimeout = 1000 * (int)(next - curtime.tv_sec) - (int)curtime.tv_usec / 1000;
-
-    if ((pcount = poll(system->listeners, (nfds_t)system->num_listeners, ptimeout)) < 0 && errno != EINTR && errno != EAGAIN)
+    if ((pcount = poll(system->listeners, (nfds_t)system->num_listeners, 1000)) < 0 && errno != EINTR && errno != EAGAIN)
     {
       papplLog(system, PAPPL_LOGLEVEL_ERROR, "Unable to accept new connections: %s", strerror(errno));
       break;
@@ -613,9 +737,16 @@ papplSystemRun(pappl_system_t *system)	// I - System
 	  {
 	    _papplRWLockWrite(system);
 	    system->num_clients ++;
+	    system->cmetrics.accepts ++;
 	    _papplRWUnlock(system);
 
-	    if (pthread_create(&client->thread_id, &tattr, (void *(*)(void *))_papplClientRun, client))
+	    if (system->pool)
+	    {
+	      // Hand the connection to the worker pool...
+	      if (!_papplClientPoolAdd(system, client))
+		_papplClientDelete(client);
+	    }
+	    else if (pthread_create(&client->thread_id, &tattr, (void *(*)(void *))_papplClientRun, client))
 	    {
 	      // Unable to create client thread...
 	      papplLog(system, PAPPL_LOGLEVEL_ERROR, "Unable to create client thread: %s", strerror(errno));
@@ -627,7 +758,7 @@ papplSystemRun(pappl_system_t *system)	// I - System
 
       _papplRWLockRead(system);
 
-      if (system->num_clients >= system->max_clients)
+      if (system->num_clients >= system->max_clients || _papplClientPoolIsFull(system))
       {
 	for (i = 0; i < system->num_listeners; i ++)
 	  system->listeners[i].events = 0;
@@ -637,57 +768,13 @@ papplSystemRun(pappl_system_t *system)	// I - System
     {
       _papplRWLockRead(system);
 
-      if (system->num_clients < system->max_clients)
+      if (system->num_clients < system->max_clients && !_papplClientPoolIsFull(system))
       {
 	for (i = 0; i < system->num_listeners; i ++)
 	  system->listeners[i].events = POLLIN;
       }
     }
 
-    dns_sd_host_changes = _papplDNSSDGetHostChanges();
-
-    if (system->dns_sd_any_collision || system->dns_sd_host_changes != dns_sd_host_changes)
-    {
-      // Handle name collisions...
-      bool		force_dns_sd = system->dns_sd_host_changes != dns_sd_host_changes;
-					// Force re-registration?
-
-      if (force_dns_sd)
-        _papplSystemSetHostNameNoLock(system, NULL);
-
-      if (system->dns_sd_collision || force_dns_sd)
-        _papplSystemRegisterDNSSDNoLock(system);
-
-      for (i = 0, count = cupsArrayGetCount(system->printers); i < count; i ++)
-      {
-	printer = (pappl_printer_t *)cupsArrayGetElement(system->printers, i);
-
-        if (printer->dns_sd_collision || force_dns_sd)
-          _papplPrinterRegisterDNSSDNoLock(printer);
-      }
-
-      system->dns_sd_any_collision = false;
-      system->dns_sd_host_changes  = dns_sd_host_changes;
-    }
-
-    _papplRWUnlock(system);
-
-    pthread_mutex_lock(&system->config_mutex);
-    save_changes = system->config_changes > system->save_changes;
-    pthread_mutex_unlock(&system->config_mutex);
-
-    if (save_changes)
-    {
-      system->save_changes = system->config_changes;
-
-      if (system->save_cb)
-      {
-        // Save the configuration...
-	(system->save_cb)(system, system->save_cbdata);
-      }
-    }
-
-    _papplRWLockRead(system);
     if (system->shutdown_time || sigterm_time)
     {
       // Shutdown requested, see if we can do so safely...
@@ -724,39 +811,14 @@ papplSystemRun(pappl_system_t *system)	// I - System
     {
       _papplRWUnlock(system);
     }
-
-    // Run any timers...
-    gettimeofday(&curtime, NULL);
-
-    _papplRWLockRead(system);
-    for (timer = (_pappl_timer_t *)cupsArrayGetFirst(system->timers); timer; timer = (_pappl_timer_t *)cupsArrayGetNext(system->timers))
-    {
-      if (timer->next > curtime.tv_sec)
-        break;
-
-      cupsArrayRemove(system->timers, timer);
-
-      if ((timer->cb)(system, timer->cb_data) && timer->interval)
-      {
-	timer->next += timer->interval;
-	cupsArrayAdd(system->timers, timer);
-      }
-    }
-    _papplRWUnlock(system);
-
-    // Clean out old jobs and subscriptions...
-    if (system->clean_time && curtime.tv_sec >= system->clean_time)
-      papplSystemCleanJobs(system);
-
-    if (curtime.tv_sec >= subtime)
-    {
-      _papplSystemCleanSubscriptions(system, false);
-      subtime = curtime.tv_sec + 10;
-    }
   }
 
   papplLog(system, PAPPL_LOGLEVEL_INFO, "Shutting down system.");
 
+  _papplTimerWheelStop(system);
+
+  _papplClientPoolStop(system);
+
   _papplRWLockWrite(system);
 
   ippDelete(system->attrs);
@@ -780,6 +842,10 @@ papplSystemRun(pappl_system_t *system)	// I - System
 
   _papplRWUnlock(system);
 
+  // Stop polling printer status and wait for processing jobs to stop...
+  _papplStatusPollerStop(system);
+  _papplJobSchedulerStop(system);
+
   pthread_mutex_lock(&system->config_mutex);
   save_changes = system->config_changes > system->save_changes;
   pthread_mutex_unlock(&system->config_mutex);
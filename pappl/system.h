@@ -21,6 +21,97 @@ extern "C" {
 // Types...
 //
 
+typedef struct pappl_ametrics_s		// Authentication cache metrics @since PAPPL 1.4@
+{
+  size_t	hits;				// Number of requests that used a cached authentication
+  size_t	misses;				// Number of requests that needed a full authentication
+  size_t	evictions;			// Number of cached authentications removed to make room
+  size_t	flushes;			// Number of times the cache was invalidated
+  size_t	entries;			// Current number of cached authentications
+} pappl_ametrics_t;
+
+typedef struct pappl_cmetrics_s		// Client connection metrics @since PAPPL 1.4@
+{
+  size_t	accepts;			// Total number of accepted connections
+  size_t	requests;			// Total number of requests dispatched to workers
+  size_t	idle_clients;			// Current number of idle keep-alive connections
+  size_t	queued;				// Current number of queued requests
+  size_t	max_queued;			// Maximum number of queued requests
+  size_t	deferred;			// Total number of requests deferred because the queue was full
+  size_t	queue_msecs;			// Total number of milliseconds requests spent queued
+  size_t	max_queue_msecs;		// Maximum number of milliseconds a request spent queued
+  size_t	active_workers;			// Current number of busy workers
+  size_t	max_active_workers;		// Maximum number of busy workers
+  size_t	html_flushes;			// Number of HTML output buffer flushes
+  size_t	html_bytes;			// Number of HTML bytes sent
+} pappl_cmetrics_t;
+
+typedef struct pappl_dcmetrics_s	// Device connection metrics @since PAPPL 1.4@
+{
+  size_t	opens;				// Number of device connections opened for jobs
+  size_t	reuses;				// Number of jobs that reused an open device connection
+  size_t	stale;				// Number of kept-alive device connections closed by the printer
+  size_t	idle_closes;			// Number of kept-alive device connections closed after the idle timeout
+} pappl_dcmetrics_t;
+
+typedef struct pappl_imetrics_s		// Image filter metrics @since PAPPL 1.4@
+{
+  size_t	images;				// Number of images printed using papplJobFilterImageRows
+  size_t	reads;				// Number of passes through those images
+  size_t	rows;				// Number of rows in those images
+} pappl_imetrics_t;
+
+typedef struct pappl_jmetrics_s		// Job scheduler metrics @since PAPPL 1.4@
+{
+  size_t	dispatched;			// Total number of jobs dispatched to workers
+  size_t	queued;				// Current number of printers waiting for a worker
+  size_t	max_queued;			// Maximum number of printers waiting for a worker
+  size_t	queue_msecs;			// Total number of milliseconds printers spent queued
+  size_t	max_queue_msecs;		// Maximum number of milliseconds a printer spent queued
+  size_t	processing_jobs;		// Current number of processing jobs
+  size_t	max_processing_jobs;		// Maximum number of processing jobs
+} pappl_jmetrics_t;
+
+typedef struct pappl_lockstat_s		// Lock call site statistics @since PAPPL 1.4@
+{
+  const char	*lock;				// Lock expression, for example "printer"
+  const char	*func;				// Function name
+  const char	*file;				// Source filename
+  int		line;				// Source line number
+  bool		write;				// Write (exclusive) lock?
+  size_t	acquires;			// Number of times the lock was acquired
+  size_t	contended;			// Number of times the lock was busy
+  size_t	wait_usecs;			// Total microseconds spent waiting for the lock
+  size_t	max_wait_usecs;			// Maximum microseconds spent waiting for the lock
+  size_t	hold_usecs;			// Estimated total microseconds the lock was held
+  size_t	max_hold_usecs;			// Maximum (sampled) microseconds the lock was held
+} pappl_lockstat_t;
+
+typedef struct pappl_lmetrics_s		// Log metrics @since PAPPL 1.4@
+{
+  size_t	queued;				// Total number of messages queued for writing
+  size_t	dropped;			// Number of messages dropped because the queue was full
+  size_t	max_queued;			// Maximum number of messages waiting to be written
+  size_t	writes;				// Number of writes to the log file
+  size_t	bytes;				// Number of bytes written to the log file
+} pappl_lmetrics_t;
+
+typedef struct pappl_rmetrics_s		// Static resource metrics @since PAPPL 1.4@
+{
+  size_t	responses;			// Number of static resources sent
+  size_t	compressed;			// Number of static resources sent compressed
+  size_t	bytes;				// Number of uncompressed bytes in static resources sent
+  size_t	saved_bytes;			// Estimated number of bytes saved by compression
+} pappl_rmetrics_t;
+
+typedef struct pappl_rsmetrics_s	// Raster processing metrics @since PAPPL 1.4@
+{
+  size_t	options;			// Number of print options created for raster pages
+  size_t	options_reused;			// Number of raster pages that reused the print options
+  size_t	buffers;			// Number of raster line buffers allocated
+  size_t	buffers_reused;			// Number of raster line buffers reused for another page
+} pappl_rsmetrics_t;
+
 typedef enum pappl_netconf_e		// Network configuration mode
 {
   PAPPL_NETCONF_OFF,				// Turn network interface off
@@ -68,7 +159,9 @@ enum pappl_soptions_e			// System option bits
   PAPPL_SOPTIONS_WEB_REMOTE = 0x0080,		// Allow remote queue management (vs. localhost only)
   PAPPL_SOPTIONS_WEB_SECURITY = 0x0100,		// Enable the user/password settings page
   PAPPL_SOPTIONS_WEB_TLS = 0x0200,		// Enable the TLS settings page
-  PAPPL_SOPTIONS_NO_TLS = 0x0400		// Disable TLS support @since PAPPL 1.1@
+  PAPPL_SOPTIONS_NO_TLS = 0x0400,		// Disable TLS support @since PAPPL 1.1@
+  PAPPL_SOPTIONS_WORKER_POOL = 0x0800,		// Use an event-driven worker pool for client connections @since PAPPL 1.4@
+  PAPPL_SOPTIONS_METRICS = 0x1000		// Collect request, job, and device metrics for the "/metrics" resource @since PAPPL 1.4@
 };
 typedef unsigned pappl_soptions_t;	// Bitfield for system options
 
@@ -159,21 +252,29 @@ extern pappl_loc_t	*papplSystemFindLoc(pappl_system_t *system, const char *langu
 extern pappl_printer_t	*papplSystemFindPrinter(pappl_system_t *system, const char *resource, int printer_id, const char *device_uri) _PAPPL_PUBLIC;
 extern pappl_subscription_t *papplSystemFindSubscription(pappl_system_t *system, int sub_id) _PAPPL_PUBLIC;
 extern char		*papplSystemGetAdminGroup(pappl_system_t *system, char *buffer, size_t bufsize) _PAPPL_PUBLIC;
+extern pappl_ametrics_t	*papplSystemGetAuthMetrics(pappl_system_t *system, pappl_ametrics_t *metrics) _PAPPL_PUBLIC;
 extern const char	*papplSystemGetAuthService(pappl_system_t *system) _PAPPL_PUBLIC;
+extern pappl_cmetrics_t	*papplSystemGetClientMetrics(pappl_system_t *system, pappl_cmetrics_t *metrics) _PAPPL_PUBLIC;
 extern pappl_contact_t	*papplSystemGetContact(pappl_system_t *system, pappl_contact_t *contact) _PAPPL_PUBLIC;
 extern int		papplSystemGetDefaultPrinterID(pappl_system_t *system) _PAPPL_PUBLIC;
 extern char		*papplSystemGetDefaultPrintGroup(pappl_system_t *system, char *buffer, size_t bufsize) _PAPPL_PUBLIC;
+extern pappl_dcmetrics_t *papplSystemGetDeviceMetrics(pappl_system_t *system, pappl_dcmetrics_t *metrics) _PAPPL_PUBLIC;
 extern char		*papplSystemGetDNSSDName(pappl_system_t *system, char *buffer, size_t bufsize) _PAPPL_PUBLIC;
 extern const char	*papplSystemGetFooterHTML(pappl_system_t *system) _PAPPL_PUBLIC;
 extern char		*papplSystemGetGeoLocation(pappl_system_t *system, char *buffer, size_t bufsize) _PAPPL_PUBLIC;
 extern char		*papplSystemGetHostname(pappl_system_t *system, char *buffer, size_t bufsize) _PAPPL_DEPRECATED("Use papplSystemGetHostName instead.");
 extern char		*papplSystemGetHostName(pappl_system_t *system, char *buffer, size_t bufsize) _PAPPL_PUBLIC;
 extern int		papplSystemGetHostPort(pappl_system_t *system) _PAPPL_PUBLIC;
+extern pappl_imetrics_t	*papplSystemGetImageMetrics(pappl_system_t *system, pappl_imetrics_t *metrics) _PAPPL_PUBLIC;
+extern pappl_jmetrics_t	*papplSystemGetJobMetrics(pappl_system_t *system, pappl_jmetrics_t *metrics) _PAPPL_PUBLIC;
 extern char		*papplSystemGetLocation(pappl_system_t *system, char *buffer, size_t bufsize) _PAPPL_PUBLIC;
+extern size_t		papplSystemGetLockStats(pappl_system_t *system, size_t max_stats, pappl_lockstat_t *stats) _PAPPL_PUBLIC;
 extern pappl_loglevel_t	papplSystemGetLogLevel(pappl_system_t *system) _PAPPL_PUBLIC;
+extern pappl_lmetrics_t	*papplSystemGetLogMetrics(pappl_system_t *system, pappl_lmetrics_t *metrics) _PAPPL_PUBLIC;
 extern int		papplSystemGetMaxClients(pappl_system_t *system) _PAPPL_PUBLIC;
 extern size_t		papplSystemGetMaxImageSize(pappl_system_t *system, int *max_width, int *max_height) _PAPPL_PUBLIC;
 extern size_t		papplSystemGetMaxLogSize(pappl_system_t *system) _PAPPL_PUBLIC;
+extern int		papplSystemGetMaxProcessingJobs(pappl_system_t *system) _PAPPL_PUBLIC;
 extern size_t		papplSystemGetMaxSubscriptions(pappl_system_t *system) _PAPPL_PUBLIC;
 extern char		*papplSystemGetName(pappl_system_t *system, char *buffer, size_t bufsize) _PAPPL_PUBLIC;
 extern int		papplSystemGetNextPrinterID(pappl_system_t *system) _PAPPL_PUBLIC;
@@ -182,11 +283,15 @@ extern char		*papplSystemGetOrganization(pappl_system_t *system, char *buffer, s
 extern char		*papplSystemGetOrganizationalUnit(pappl_system_t *system, char *buffer, size_t bufsize) _PAPPL_PUBLIC;
 extern char		*papplSystemGetPassword(pappl_system_t *system, char *buffer, size_t bufsize) _PAPPL_PUBLIC;
 extern int		papplSystemGetPort(pappl_system_t *system) _PAPPL_DEPRECATED("Use papplSystemGetHostPort instead.");
+extern pappl_rsmetrics_t *papplSystemGetRasterMetrics(pappl_system_t *system, pappl_rsmetrics_t *metrics) _PAPPL_PUBLIC;
+extern pappl_rmetrics_t	*papplSystemGetResourceMetrics(pappl_system_t *system, pappl_rmetrics_t *metrics) _PAPPL_PUBLIC;
 extern const char	*papplSystemGetServerHeader(pappl_system_t *system) _PAPPL_PUBLIC;
 extern char		*papplSystemGetSessionKey(pappl_system_t *system, char *buffer, size_t bufsize) _PAPPL_PUBLIC;
+extern int		papplSystemGetStatusInterval(pappl_system_t *system) _PAPPL_PUBLIC;
 extern bool		papplSystemGetTLSOnly(pappl_system_t *system) _PAPPL_PUBLIC;
 extern const char	*papplSystemGetUUID(pappl_system_t *system) _PAPPL_PUBLIC;
 extern int		papplSystemGetVersions(pappl_system_t *system, int max_versions, pappl_version_t *versions) _PAPPL_PUBLIC;
+extern size_t		papplSystemGetWorkerPool(pappl_system_t *system, size_t *max_queue) _PAPPL_PUBLIC;
 extern char		*papplSystemHashPassword(pappl_system_t *system, const char *salt, const char *password, char *buffer, size_t bufsize) _PAPPL_PUBLIC;
 extern bool		papplSystemIsRunning(pappl_system_t *system) _PAPPL_PUBLIC;
 extern bool		papplSystemIsShutdown(pappl_system_t *system) _PAPPL_PUBLIC;
@@ -215,6 +320,7 @@ extern void		papplSystemSetLogLevel(pappl_system_t *system, pappl_loglevel_t log
 extern void		papplSystemSetMaxClients(pappl_system_t *system, int max_clients) _PAPPL_PUBLIC;
 extern void		papplSystemSetMaxImageSize(pappl_system_t *system, size_t max_size, int max_width, int max_height) _PAPPL_PUBLIC;
 extern void		papplSystemSetMaxLogSize(pappl_system_t *system, size_t max_size) _PAPPL_PUBLIC;
+extern void		papplSystemSetMaxProcessingJobs(pappl_system_t *system, int max_jobs) _PAPPL_PUBLIC;
 extern void		papplSystemSetMaxSubscriptions(pappl_system_t *system, size_t max_subscriptions) _PAPPL_PUBLIC;
 extern void		papplSystemSetMIMECallback(pappl_system_t *system, pappl_mime_cb_t cb, void *data) _PAPPL_PUBLIC;
 extern void		papplSystemSetNetworkCallbacks(pappl_system_t *system, pappl_network_get_cb_t get_cb, pappl_network_set_cb_t set_cb, void *cb_data) _PAPPL_PUBLIC;
@@ -225,9 +331,11 @@ extern void		papplSystemSetOrganizationalUnit(pappl_system_t *system, const char
 extern void		papplSystemSetPassword(pappl_system_t *system, const char *hash) _PAPPL_PUBLIC;
 extern void		papplSystemSetPrinterDrivers(pappl_system_t *system, int num_drivers, pappl_pr_driver_t *drivers, pappl_pr_autoadd_cb_t autoadd_cb, pappl_pr_create_cb_t create_cb, pappl_pr_driver_cb_t driver_cb, void *data) _PAPPL_PUBLIC;
 extern void		papplSystemSetSaveCallback(pappl_system_t *system, pappl_save_cb_t cb, void *data) _PAPPL_PUBLIC;
+extern void		papplSystemSetStatusInterval(pappl_system_t *system, int interval) _PAPPL_PUBLIC;
 extern void		papplSystemSetUUID(pappl_system_t *system, const char *value) _PAPPL_PUBLIC;
 extern void		papplSystemSetVersions(pappl_system_t *system, int num_versions, pappl_version_t *versions) _PAPPL_PUBLIC;
 extern void		papplSystemSetWiFiCallbacks(pappl_system_t *system, pappl_wifi_join_cb_t join_cb, pappl_wifi_list_cb_t list_cb, pappl_wifi_status_cb_t status_cb, void *data) _PAPPL_PUBLIC;
+extern void		papplSystemSetWorkerPool(pappl_system_t *system, size_t num_workers, size_t max_queue) _PAPPL_PUBLIC;
 extern void		papplSystemShutdown(pappl_system_t *system) _PAPPL_PUBLIC;
 
 
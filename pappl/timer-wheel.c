@@ -0,0 +1,522 @@
+//
+// Timer wheel for the Printer Application Framework
+//
+// Copyright © 2023 by Michael R Sweet.
+//
+// Licensed under Apache License v2.0.  See the file "LICENSE" for more
+// information.
+//
+// Timer callbacks and system housekeeping run on a separate thread so that the
+// main run loop only needs to accept client connections.  Timers are kept in
+// a hierarchical timer wheel with four levels of 64 slots - level 0 holds the
+// timers for the next 64 ticks, level 1 the next 64 * 64 ticks, and so forth.
+// Whenever level 0 wraps around, the next slot of the level above is moved
+// ("cascaded") down.  Adding and running a timer is O(1) and the wheel is
+// advanced using the monotonic clock so that changes to the system time do
+// not affect repeating timers.
+//
+
+//
+// Include necessary headers...
+//
+
+#include "pappl-private.h"
+
+
+//
+// Local constants...
+//
+
+#define _PAPPL_TIMER_BITS	6	// Bits per wheel level
+#define _PAPPL_TIMER_HZ		10	// Ticks per second
+#define _PAPPL_TIMER_LEVELS	4	// Number of wheel levels
+#define _PAPPL_TIMER_SLOTS	64	// Slots per wheel level
+#define _PAPPL_TIMER_MASK	(_PAPPL_TIMER_SLOTS - 1)
+#define _PAPPL_TIMER_MAX	(1ULL << (_PAPPL_TIMER_BITS * _PAPPL_TIMER_LEVELS))
+					// Maximum number of ticks in the wheel
+
+
+//
+// Local types...
+//
+
+typedef struct _pappl_timer_s		// Timer callback data
+{
+  struct _pappl_timer_s	*next;		// Next timer in slot
+  pappl_timer_cb_t	cb;		// Callback function
+  void			*cb_data;	// Callback data
+  unsigned long long	expires;	// Tick when the timer expires
+  int			interval;	// Timer interval in seconds
+  bool			removed;	// Was the timer removed while running?
+} _pappl_timer_t;
+
+struct _pappl_twheel_s			// Timer wheel
+{
+  pthread_mutex_t	mutex;		// Timer mutex
+  pthread_cond_t	cond;		// Timer condition variable
+  pthread_t		tid;		// Timer thread
+  bool			running,	// Is the timer thread running?
+			stopping;	// Is the timer thread stopping?
+  unsigned long long	start,		// Start time in nanoseconds
+			ticks;		// Last tick processed
+  _pappl_timer_t	*slots[_PAPPL_TIMER_LEVELS][_PAPPL_TIMER_SLOTS],
+					// Wheel slots
+			*due,		// Timers to run
+			*current;	// Currently running timer
+};
+
+
+//
+// Local functions...
+//
+
+static void		timer_advance(_pappl_twheel_t *tw);
+static void		timer_free(_pappl_timer_t *t);
+static unsigned long long timer_get_ticks(_pappl_twheel_t *tw);
+static void		timer_insert(_pappl_twheel_t *tw, _pappl_timer_t *t);
+static void		*timer_thread(pappl_system_t *system);
+
+
+//
+// '_papplTimerWheelAdd()' - Add a timer.
+//
+
+bool					// O - `true` on success, `false` on error
+_papplTimerWheelAdd(
+    pappl_system_t   *system,		// I - System
+    time_t           start,		// I - Start time in seconds or `0` for the current time plus the interval
+    int              interval,		// I - Repeat interval in seconds or `0` for no repeat
+    pappl_timer_cb_t cb,		// I - Callback function
+    void             *cb_data)		// I - Callback data
+{
+  _pappl_twheel_t	*tw = system->twheel;
+					// Timer wheel
+  _pappl_timer_t	*t;		// New timer
+  long long		delay;		// Delay in seconds
+
+
+  if ((t = (_pappl_timer_t *)calloc(1, sizeof(_pappl_timer_t))) == NULL)
+    return (false);
+
+  t->cb       = cb;
+  t->cb_data  = cb_data;
+  t->interval = interval;
+
+  // Convert the start time to monotonic ticks...
+  if (start)
+    delay = (long long)(start - time(NULL));
+  else
+    delay = interval;
+
+  pthread_mutex_lock(&tw->mutex);
+
+  if (delay > 0)
+    t->expires = timer_get_ticks(tw) + (unsigned long long)delay * _PAPPL_TIMER_HZ;
+
+  if (t->expires <= tw->ticks)
+    t->expires = tw->ticks + 1;
+
+  timer_insert(tw, t);
+
+  pthread_cond_signal(&tw->cond);
+  pthread_mutex_unlock(&tw->mutex);
+
+  return (true);
+}
+
+
+//
+// '_papplTimerWheelCreate()' - Create a timer wheel.
+//
+
+_pappl_twheel_t *			// O - Timer wheel or `NULL` on error
+_papplTimerWheelCreate(void)
+{
+  _pappl_twheel_t	*tw;		// Timer wheel
+  struct timespec	curtime;	// Current time
+
+
+  if ((tw = (_pappl_twheel_t *)calloc(1, sizeof(_pappl_twheel_t))) == NULL)
+    return (NULL);
+
+  pthread_mutex_init(&tw->mutex, NULL);
+  pthread_cond_init(&tw->cond, NULL);
+
+  clock_gettime(CLOCK_MONOTONIC, &curtime);
+
+  tw->start = (unsigned long long)curtime.tv_sec * 1000000000ULL + (unsigned long long)curtime.tv_nsec;
+
+  return (tw);
+}
+
+
+//
+// '_papplTimerWheelDelete()' - Delete a timer wheel and its timers.
+//
+// The timer thread must be stopped before calling this function.
+//
+
+void
+_papplTimerWheelDelete(
+    _pappl_twheel_t *tw)		// I - Timer wheel
+{
+  int	level,				// Current level
+	slot;				// Current slot
+
+
+  if (!tw)
+    return;
+
+  for (level = 0; level < _PAPPL_TIMER_LEVELS; level ++)
+  {
+    for (slot = 0; slot < _PAPPL_TIMER_SLOTS; slot ++)
+      timer_free(tw->slots[level][slot]);
+  }
+
+  timer_free(tw->due);
+
+  pthread_cond_destroy(&tw->cond);
+  pthread_mutex_destroy(&tw->mutex);
+
+  free(tw);
+}
+
+
+//
+// '_papplTimerWheelRemove()' - Remove matching timers.
+//
+
+void
+_papplTimerWheelRemove(
+    pappl_system_t   *system,		// I - System
+    pappl_timer_cb_t cb,		// I - Callback function
+    void             *cb_data)		// I - Callback data
+{
+  _pappl_twheel_t	*tw = system->twheel;
+					// Timer wheel
+  int			level,		// Current level
+			slot;		// Current slot
+  _pappl_timer_t	**tptr,		// Pointer to current timer
+			*t;		// Current timer
+
+
+  pthread_mutex_lock(&tw->mutex);
+
+  for (level = 0; level <= _PAPPL_TIMER_LEVELS; level ++)
+  {
+    for (slot = 0; slot < _PAPPL_TIMER_SLOTS; slot ++)
+    {
+      // The "due" list is checked after the last level...
+      tptr = level < _PAPPL_TIMER_LEVELS ? &tw->slots[level][slot] : &tw->due;
+
+      while ((t = *tptr) != NULL)
+      {
+        if (t->cb == cb && t->cb_data == cb_data)
+        {
+          *tptr = t->next;
+          free(t);
+        }
+        else
+          tptr = &t->next;
+      }
+
+      if (level == _PAPPL_TIMER_LEVELS)
+        break;
+    }
+  }
+
+  // The running timer is freed by the timer thread when its callback returns...
+  if (tw->current && tw->current->cb == cb && tw->current->cb_data == cb_data)
+    tw->current->removed = true;
+
+  pthread_mutex_unlock(&tw->mutex);
+}
+
+
+//
+// '_papplTimerWheelStart()' - Start the timer thread.
+//
+
+void
+_papplTimerWheelStart(
+    pappl_system_t *system)		// I - System
+{
+  _pappl_twheel_t	*tw = system->twheel;
+					// Timer wheel
+
+
+  pthread_mutex_lock(&tw->mutex);
+
+  if (!tw->running)
+  {
+    tw->stopping = false;
+
+    if (pthread_create(&tw->tid, NULL, (void *(*)(void *))timer_thread, system))
+      papplLog(system, PAPPL_LOGLEVEL_ERROR, "Unable to create timer thread: %s", strerror(errno));
+    else
+      tw->running = true;
+  }
+
+  pthread_mutex_unlock(&tw->mutex);
+}
+
+
+//
+// '_papplTimerWheelStop()' - Stop the timer thread.
+//
+// This function waits for the timer thread to exit, which may take as long as
+// the current timer callback or housekeeping.
+//
+
+void
+_papplTimerWheelStop(
+    pappl_system_t *system)		// I - System
+{
+  _pappl_twheel_t	*tw = system->twheel;
+					// Timer wheel
+
+
+  pthread_mutex_lock(&tw->mutex);
+
+  if (!tw->running)
+  {
+    pthread_mutex_unlock(&tw->mutex);
+    return;
+  }
+
+  tw->stopping = true;
+
+  pthread_cond_broadcast(&tw->cond);
+  pthread_mutex_unlock(&tw->mutex);
+
+  pthread_join(tw->tid, NULL);
+
+  pthread_mutex_lock(&tw->mutex);
+  tw->running = false;
+  pthread_mutex_unlock(&tw->mutex);
+}
+
+
+//
+// 'timer_advance()' - Advance the wheel by one tick.
+//
+// Expired timers are moved to the "due" list.  The timer mutex must be held
+// when calling this function.
+//
+
+static void
+timer_advance(_pappl_twheel_t *tw)	// I - Timer wheel
+{
+  int			level,		// Current level
+			slot;		// Current slot
+  _pappl_timer_t	*t,		// Current timer
+			*next;		// Next timer
+
+
+  tw->ticks ++;
+
+  // Cascade timers from the upper levels when level 0 wraps around...
+  for (level = 1; level < _PAPPL_TIMER_LEVELS && !(tw->ticks & ((1ULL << (_PAPPL_TIMER_BITS * level)) - 1)); level ++)
+  {
+    slot = (int)((tw->ticks >> (_PAPPL_TIMER_BITS * level)) & _PAPPL_TIMER_MASK);
+
+    for (t = tw->slots[level][slot], tw->slots[level][slot] = NULL; t; t = next)
+    {
+      next = t->next;
+      timer_insert(tw, t);
+    }
+  }
+
+  // Move the expired timers to the "due" list...
+  slot = (int)(tw->ticks & _PAPPL_TIMER_MASK);
+
+  for (t = tw->slots[0][slot], tw->slots[0][slot] = NULL; t; t = next)
+  {
+    next = t->next;
+
+    if (t->expires > tw->ticks)
+    {
+      // Timer is further out than the wheel can hold...
+      timer_insert(tw, t);
+    }
+    else
+    {
+      t->next = tw->due;
+      tw->due = t;
+    }
+  }
+}
+
+
+//
+// 'timer_free()' - Free a list of timers.
+//
+
+static void
+timer_free(_pappl_timer_t *t)		// I - First timer
+{
+  _pappl_timer_t	*next;		// Next timer
+
+
+  for (; t; t = next)
+  {
+    next = t->next;
+    free(t);
+  }
+}
+
+
+//
+// 'timer_get_ticks()' - Get the current monotonic tick.
+//
+
+static unsigned long long		// O - Current tick
+timer_get_ticks(_pappl_twheel_t *tw)	// I - Timer wheel
+{
+  struct timespec	curtime;	// Current time
+
+
+  clock_gettime(CLOCK_MONOTONIC, &curtime);
+
+  return (((unsigned long long)curtime.tv_sec * 1000000000ULL + (unsigned long long)curtime.tv_nsec - tw->start) / (1000000000ULL / _PAPPL_TIMER_HZ));
+}
+
+
+//
+// 'timer_insert()' - Insert a timer into the wheel.
+//
+// The timer mutex must be held when calling this function.
+//
+
+static void
+timer_insert(_pappl_twheel_t *tw,	// I - Timer wheel
+             _pappl_timer_t  *t)	// I - Timer
+{
+  int			level,		// Wheel level
+			slot;		// Wheel slot
+  unsigned long long	expires,	// Tick for slot
+			delta;		// Ticks until expiration
+
+
+  expires = t->expires < tw->ticks ? tw->ticks : t->expires;
+  delta   = expires - tw->ticks;
+
+  if (delta >= _PAPPL_TIMER_MAX)
+  {
+    // Put the timer in the last slot, it will be re-inserted when it comes up...
+    expires = tw->ticks + _PAPPL_TIMER_MAX - 1;
+    delta   = _PAPPL_TIMER_MAX - 1;
+  }
+
+  for (level = 0; level < (_PAPPL_TIMER_LEVELS - 1) && delta >= (1ULL << (_PAPPL_TIMER_BITS * (level + 1))); level ++);
+
+  slot = (int)((expires >> (_PAPPL_TIMER_BITS * level)) & _PAPPL_TIMER_MASK);
+
+  t->next                = tw->slots[level][slot];
+  tw->slots[level][slot] = t;
+}
+
+
+//
+// 'timer_thread()' - Run timers and housekeeping.
+//
+
+static void *				// O - Thread exit status
+timer_thread(pappl_system_t *system)	// I - System
+{
+  _pappl_twheel_t	*tw = system->twheel;
+					// Timer wheel
+  _pappl_timer_t	*t;		// Current timer
+  pappl_timer_cb_t	cb;		// Callback function
+  void			*cb_data;	// Callback data
+  bool			repeat;		// Repeat the timer?
+  unsigned long long	curticks,	// Current tick
+			houseticks,	// Tick for next housekeeping
+			waketicks;	// Tick to wake up
+  struct timeval	curtime;	// Current time
+  struct timespec	timeout;	// Timeout for wait
+
+
+  papplLog(system, PAPPL_LOGLEVEL_DEBUG, "Starting timer thread.");
+
+  pthread_mutex_lock(&tw->mutex);
+
+  houseticks = tw->ticks;
+
+  while (!tw->stopping)
+  {
+    // Advance the wheel to the current time...
+    curticks = timer_get_ticks(tw);
+
+    while (tw->ticks < curticks)
+      timer_advance(tw);
+
+    // Run expired timers without holding the mutex...
+    while ((t = tw->due) != NULL && !tw->stopping)
+    {
+      tw->due     = t->next;
+      tw->current = t;
+      cb          = t->cb;
+      cb_data     = t->cb_data;
+
+      pthread_mutex_unlock(&tw->mutex);
+      repeat = (cb)(system, cb_data);
+      pthread_mutex_lock(&tw->mutex);
+
+      tw->current = NULL;
+
+      if (repeat && t->interval > 0 && !t->removed)
+      {
+        t->expires += (unsigned long long)t->interval * _PAPPL_TIMER_HZ;
+        if (t->expires <= tw->ticks)
+          t->expires = tw->ticks + 1;
+
+        timer_insert(tw, t);
+      }
+      else
+        free(t);
+    }
+
+    // Do housekeeping once a second...
+    if (curticks >= houseticks && !tw->stopping)
+    {
+      pthread_mutex_unlock(&tw->mutex);
+      _papplSystemHousekeeping(system);
+      pthread_mutex_lock(&tw->mutex);
+
+      houseticks = curticks + _PAPPL_TIMER_HZ;
+    }
+
+    if (tw->stopping || tw->due)
+      continue;
+
+    // Wait until the next timer slot, cascade, or housekeeping...
+    for (waketicks = tw->ticks + 1; waketicks < houseticks; waketicks ++)
+    {
+      if (tw->slots[0][waketicks & _PAPPL_TIMER_MASK] || !(waketicks & _PAPPL_TIMER_MASK))
+        break;
+    }
+
+    if ((curticks = timer_get_ticks(tw)) < waketicks)
+    {
+      gettimeofday(&curtime, NULL);
+
+      timeout.tv_sec  = curtime.tv_sec + (time_t)((waketicks - curticks) / _PAPPL_TIMER_HZ);
+      timeout.tv_nsec = curtime.tv_usec * 1000 + (long)((waketicks - curticks) % _PAPPL_TIMER_HZ) * (1000000000 / _PAPPL_TIMER_HZ);
+
+      if (timeout.tv_nsec >= 1000000000)
+      {
+        timeout.tv_sec ++;
+        timeout.tv_nsec -= 1000000000;
+      }
+
+      pthread_cond_timedwait(&tw->cond, &tw->mutex, &timeout);
+    }
+  }
+
+  pthread_mutex_unlock(&tw->mutex);
+
+  papplLog(system, PAPPL_LOGLEVEL_DEBUG, "Timer thread exiting.");
+
+  return (NULL);
+}
@@ -283,6 +283,9 @@ pwg_callback(
 
     driver_data->finishings = PAPPL_FINISHINGS_PUNCH | PAPPL_FINISHINGS_STAPLE;
 
+    driver_data->raster_pipeline = true;// Exercise the raster pipeline
+    driver_data->raw_streaming   = true;// Exercise raw socket streaming
+
     driver_data->num_media = (int)(sizeof(pwg_common_media) / sizeof(pwg_common_media[0]));
     memcpy((void *)driver_data->media, pwg_common_media, sizeof(pwg_common_media));
 
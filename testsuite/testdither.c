@@ -0,0 +1,263 @@
+//
+// Dither unit tests and benchmark for the Printer Application Framework
+//
+// Copyright © 2023 by Michael R Sweet.
+//
+// Licensed under Apache License v2.0.  See the file "LICENSE" for more
+// information.
+//
+// Usage:
+//
+//   ./testdither [--benchmark]
+//
+
+//
+// Include necessary headers...
+//
+
+#include <pappl/dither-private.h>
+#include "test.h"
+#include <time.h>
+
+
+//
+// Local constants...
+//
+
+#define BENCH_WIDTH	5100		// 8.5" at 600dpi
+#define BENCH_SECONDS	2		// Seconds to run each benchmark
+#define TEST_WIDTH	600		// Maximum test line width
+
+
+//
+// Local globals...
+//
+
+static const char * const variants[] =	// Dither variants
+{
+  "scalar",
+  "sse2",
+  "avx2",
+  "neon"
+};
+
+
+//
+// Local functions...
+//
+
+static void	dither_line(unsigned char *line, const unsigned char *pixels, unsigned width, const unsigned char *dither, bool black);
+static double	get_time(void);
+static bool	run_benchmark(void);
+static bool	run_tests(void);
+
+
+//
+// 'main()' - Main entry.
+//
+
+int					// O - Exit status
+main(int  argc,				// I - Number of command-line arguments
+     char *argv[])			// I - Command-line arguments
+{
+  if (argc == 1)
+  {
+    return (run_tests() ? 0 : 1);
+  }
+  else if (argc == 2 && !strcmp(argv[1], "--benchmark"))
+  {
+    return (run_benchmark() ? 0 : 1);
+  }
+  else
+  {
+    puts("Usage: ./testdither [--benchmark]");
+    return (1);
+  }
+}
+
+
+//
+// 'dither_line()' - Dither a line one pixel at a time for comparison.
+//
+
+static void
+dither_line(
+    unsigned char       *line,		// I - Output bitmap line
+    const unsigned char *pixels,	// I - Input pixels
+    unsigned            width,		// I - Number of pixels
+    const unsigned char *dither,	// I - Dither matrix line
+    bool                black)		// I - `true` for black pixels, `false` for grayscale pixels
+{
+  unsigned	x;			// Current column
+  unsigned char	byte,			// Byte in line
+		bit;			// Current bit
+
+
+  for (x = 0, bit = 128, byte = 0; x < width; x ++, pixels ++)
+  {
+    if (black ? *pixels > dither[x & 15] : *pixels <= dither[x & 15])
+      byte |= bit;
+
+    if (bit == 1)
+    {
+      *line++ = byte;
+      byte    = 0;
+      bit     = 128;
+    }
+    else
+      bit /= 2;
+  }
+
+  if (bit < 128)
+    *line = byte;
+}
+
+
+//
+// 'get_time()' - Get the current time in seconds.
+//
+
+static double				// O - Time in seconds
+get_time(void)
+{
+  struct timespec	curtime;	// Current time
+
+
+  clock_gettime(CLOCK_MONOTONIC, &curtime);
+
+  return ((double)curtime.tv_sec + 0.000000001 * curtime.tv_nsec);
+}
+
+
+//
+// 'run_benchmark()' - Report the dither performance of each variant.
+//
+
+static bool				// O - `true` on success, `false` on failure
+run_benchmark(void)
+{
+  size_t	i;			// Looping var
+  unsigned	y;			// Current line
+  unsigned char	dither[16][16],		// Dither matrix
+		pixels[BENCH_WIDTH],	// Pixels
+		line[(BENCH_WIDTH + 7) / 8];
+					// Bitmap line
+  double	start,			// Start time
+		secs;			// Elapsed time
+  unsigned	count;			// Number of lines
+
+
+  srand(1);
+
+  for (i = 0; i < sizeof(dither); i ++)
+    dither[i / 16][i % 16] = (unsigned char)(rand() & 255);
+
+  for (i = 0; i < sizeof(pixels); i ++)
+    pixels[i] = (unsigned char)(rand() & 255);
+
+  for (i = 0; i < (sizeof(variants) / sizeof(variants[0])); i ++)
+  {
+    if (!_papplDitherSetVariant(variants[i]))
+      continue;
+
+    start = get_time();
+    count = 0;
+
+    do
+    {
+      for (y = 0; y < 1000; y ++)
+        _papplDitherLine(line, pixels, BENCH_WIDTH, dither[y & 15], (y & 1) != 0);
+
+      count += 1000;
+      secs  = get_time() - start;
+    }
+    while (secs < BENCH_SECONDS);
+
+    printf("%-6s %u pixels: %.0f lines/sec\n", variants[i], BENCH_WIDTH, count / secs);
+  }
+
+  _papplDitherSetVariant(NULL);
+
+  return (true);
+}
+
+
+//
+// 'run_tests()' - Compare each variant against the reference implementation.
+//
+
+static bool				// O - `true` on success, `false` on failure
+run_tests(void)
+{
+  bool		pass = true;		// Pass or fail
+  size_t	i, j,			// Looping vars
+		trial;			// Current trial
+  unsigned	width,			// Line width
+		bytes;			// Bytes in line
+  bool		black;			// Black pixels?
+  unsigned char	dither[16],		// Dither matrix line
+		pixels[TEST_WIDTH],	// Pixels
+		expected[TEST_WIDTH / 8 + 2],
+					// Expected bitmap line
+		line[TEST_WIDTH / 8 + 2];
+					// Bitmap line
+
+
+  testBegin("_papplDitherGetVariant");
+  if (_papplDitherGetVariant())
+    testEndMessage(true, "%s", _papplDitherGetVariant());
+  else
+  {
+    testEnd(false);
+    pass = false;
+  }
+
+  srand(1);
+
+  for (i = 0; i < (sizeof(variants) / sizeof(variants[0])); i ++)
+  {
+    testBegin("_papplDitherLine(%s)", variants[i]);
+
+    if (!_papplDitherSetVariant(variants[i]))
+    {
+      testEndMessage(true, "not supported");
+      continue;
+    }
+
+    for (trial = 0; trial < 2000; trial ++)
+    {
+      // Pick random values, including the extremes of the dither matrix...
+      width = trial < TEST_WIDTH ? (unsigned)trial : (unsigned)(rand() % TEST_WIDTH);
+      bytes = (width + 7) / 8;
+      black = (trial & 1) != 0;
+
+      for (j = 0; j < sizeof(dither); j ++)
+        dither[j] = (unsigned char)((trial & 2) ? rand() & 255 : j < 2 ? j * 255 : rand() & 255);
+
+      for (j = 0; j < width; j ++)
+        pixels[j] = (unsigned char)((trial & 4) ? dither[j & 15] + (rand() % 3) - 1 : rand() & 255);
+
+      memset(expected, 0x55, sizeof(expected));
+      memset(line, 0x55, sizeof(line));
+
+      dither_line(expected, pixels, width, dither, black);
+      _papplDitherLine(line, pixels, width, dither, black);
+
+      if (memcmp(line, expected, sizeof(line)))
+      {
+	testEndMessage(false, "width=%u, black=%s", width, black ? "true" : "false");
+	testHexDump(expected, bytes + 1);
+	testHexDump(line, bytes + 1);
+	pass = false;
+	break;
+      }
+    }
+
+    if (trial >= 2000)
+      testEnd(true);
+  }
+
+  _papplDitherSetVariant(NULL);
+
+  return (pass);
+}
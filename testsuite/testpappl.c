@@ -20,6 +20,7 @@
 //   --no-tls                   Don't support TLS
 //   --ps-query DEVICE-URI      Do a PostScript query to get the product string
 //   --version                  Show version
+//   --worker-pool              Use a client worker pool
 //   -1                         Single queue
 //   -A PAM-SERVICE             Enable authentication using PAM service
 //   -c                         Do a clean run (no loading of state)
@@ -40,6 +41,13 @@
 //   jpeg                 JPEG image tests
 //   png                  PNG image tests
 //   pwg-raster           PWG Raster tests
+//   raw-socket           Raw socket printing tests
+//   worker-pool          Client worker pool tests
+//
+// Benchmarks:
+//
+//   get-jobs             Get-Jobs with 100000 retained jobs
+//   save-state           Save state with 100000 retained jobs
 //
 
 //
@@ -47,6 +55,7 @@
 //
 
 #include <pappl/system-private.h>
+#include <pappl/job-private.h>
 #include <cups/dir.h>
 #include "testpappl.h"
 #include "test.h"
@@ -109,6 +118,9 @@ static inline char *win32_realpath(const char *relpath, char *abspath)
 // Constants...
 //
 
+#define _PAPPL_BENCH_JOBS	100000
+#define _PAPPL_BENCH_REQUESTS	100
+#define _PAPPL_BENCH_SAVES	10
 #define _PAPPL_MAX_TIMER_COUNT	32
 #define _PAPPL_TIMER_INTERVAL	5
 
@@ -128,6 +140,10 @@ static int		output_count = 0;
 					// Number of expected output files
 static char		output_directory[1024] = "";
 					// Output directory
+static pthread_mutex_t	discovery_mutex = PTHREAD_MUTEX_INITIALIZER;
+					// Mutex for discovery scan count
+static int		discovery_scans = 0;
+					// Number of discovery scans
 
 
 //
@@ -146,6 +162,12 @@ typedef struct _pappl_testdata_s	// Test data
 					// Timestamps for each timer callback
 } _pappl_testdata_t;
 
+typedef struct _pappl_testdisc_s	// Discovery test data
+{
+  pappl_system_t	*system;	// System
+  char			uri[256];	// Device URI from discovery
+} _pappl_testdisc_t;
+
 typedef struct _pappl_testprinter_s	// Printer test data
 {
   bool			pass;		// Pass/fail
@@ -160,6 +182,9 @@ typedef struct _pappl_testprinter_s	// Printer test data
 static http_t	*connect_to_printer(pappl_system_t *system, bool remote, char *uri, size_t urisize);
 static void	device_error_cb(const char *message, void *err_data);
 static bool	device_list_cb(const char *device_info, const char *device_uri, const char *device_id, void *data);
+static bool	discovery_device_cb(const char *device_info, const char *device_uri, const char *device_id, char *uri);
+static bool	discovery_list_cb(pappl_device_cb_t cb, void *data, pappl_deverror_cb_t err_cb, void *err_data);
+static void	*discovery_refresh_thread(_pappl_testdisc_t *disc);
 static int	do_ps_query(const char *device_uri);
 static void	event_cb(pappl_system_t *system, pappl_printer_t *printer, pappl_job_t *job, pappl_event_t event, void *data);
 static const char *make_raster_file(ipp_t *response, bool grayscale, char *tempname, size_t tempsize);
@@ -168,16 +193,21 @@ static bool	test_api(pappl_system_t *system);
 static bool	test_api_printer(pappl_printer_t *printer);
 static bool	test_api_printer_cb(pappl_printer_t *printer, _pappl_testprinter_t *tp);
 static bool	test_client(pappl_system_t *system);
+static bool	test_get_jobs(pappl_system_t *system);
 #if defined(HAVE_LIBJPEG) || defined(HAVE_LIBPNG)
 static bool	test_image_files(pappl_system_t *system, const char *prompt, const char *format, int num_files, const char * const *files);
 #endif // HAVE_LIBJPEG || HAVE_LIBPNG
 static size_t	test_network_get_cb(pappl_system_t *system, void *data, size_t max_networks, pappl_network_t *networks);
 static bool	test_network_set_cb(pappl_system_t *system, void *data, size_t num_networks, pappl_network_t *networks);
 static bool	test_pwg_raster(pappl_system_t *system);
+static bool	test_raw_socket(pappl_system_t *system);
+static bool	test_save_state(pappl_system_t *system);
 static bool	test_wifi_join_cb(pappl_system_t *system, void *data, const char *ssid, const char *psk);
 static int	test_wifi_list_cb(pappl_system_t *system, void *data, cups_dest_t **ssids);
 static pappl_wifi_t *test_wifi_status_cb(pappl_system_t *system, void *data, pappl_wifi_t *wifi_data);
+static bool	test_worker_pool(pappl_system_t *system);
 static bool	timer_cb(pappl_system_t *system, _pappl_testdata_t *data);
+static bool	timer_once_cb(pappl_system_t *system, int *count);
 static int	usage(int status);
 
 
@@ -196,7 +226,8 @@ main(int  argc,				// I - Number of command-line arguments
 			*outdir = ".",	// Output directory
 			*log = NULL,	// Log file, if any
 			*auth = NULL,	// Auth service, if any
-			*model;		// Current printer model
+			*model,		// Current printer model
+			*test;		// Current test name
   cups_array_t		*models;	// Printer models, if any
   int			port = 0;	// Port number, if any
   pappl_loglevel_t	level = PAPPL_LOGLEVEL_DEBUG;
@@ -208,7 +239,7 @@ main(int  argc,				// I - Number of command-line arguments
 					// Output directory name
 			device_uri[1024];
 					// Device URI for printers
-  pappl_soptions_t	soptions = PAPPL_SOPTIONS_MULTI_QUEUE | PAPPL_SOPTIONS_WEB_INTERFACE | PAPPL_SOPTIONS_WEB_LOG | PAPPL_SOPTIONS_WEB_NETWORK | PAPPL_SOPTIONS_WEB_SECURITY | PAPPL_SOPTIONS_WEB_TLS | PAPPL_SOPTIONS_RAW_SOCKET;
+  pappl_soptions_t	soptions = PAPPL_SOPTIONS_MULTI_QUEUE | PAPPL_SOPTIONS_WEB_INTERFACE | PAPPL_SOPTIONS_WEB_LOG | PAPPL_SOPTIONS_WEB_NETWORK | PAPPL_SOPTIONS_WEB_SECURITY | PAPPL_SOPTIONS_WEB_TLS | PAPPL_SOPTIONS_RAW_SOCKET | PAPPL_SOPTIONS_METRICS;
 					// System options
   pappl_system_t	*system;	// System
 #ifdef __APPLE__
@@ -463,6 +494,10 @@ main(int  argc,				// I - Number of command-line arguments
       puts(PAPPL_VERSION);
       return (0);
     }
+    else if (!strcmp(argv[i], "--worker-pool"))
+    {
+      soptions |= PAPPL_SOPTIONS_WORKER_POOL;
+    }
     else if (!strncmp(argv[i], "--", 2))
     {
       printf("testpappl: Unknown option '%s'.\n", argv[i]);
@@ -584,6 +619,8 @@ main(int  argc,				// I - Number of command-line arguments
 		cupsArrayAdd(testdata.names, "jpeg");
 		cupsArrayAdd(testdata.names, "png");
 		cupsArrayAdd(testdata.names, "pwg-raster");
+		cupsArrayAdd(testdata.names, "raw-socket");
+		cupsArrayAdd(testdata.names, "worker-pool");
 	      }
 	      else if (strchr(argv[i], ','))
 	      {
@@ -634,6 +671,13 @@ main(int  argc,				// I - Number of command-line arguments
     }
   }
 
+  // The worker-pool tests need the worker pool...
+  for (test = (const char *)cupsArrayGetFirst(testdata.names); test; test = (const char *)cupsArrayGetNext(testdata.names))
+  {
+    if (!strcmp(test, "worker-pool"))
+      soptions |= PAPPL_SOPTIONS_WORKER_POOL;
+  }
+
   // Clean the log and output directory if necessary
   if (clean && log && strcmp(log, "-") && strcmp(log, "syslog"))
     unlink(log);
@@ -668,6 +712,8 @@ main(int  argc,				// I - Number of command-line arguments
   // Initialize the system and any printers...
   system = papplSystemCreate(soptions, name ? name : "Test System", port, "_print,_universal", spool, log, level, auth, tls_only);
   papplSystemAddListeners(system, NULL);
+  if (soptions & PAPPL_SOPTIONS_WORKER_POOL)
+    papplSystemSetWorkerPool(system, 2, 2);	// Small pool so the queue fills up
   papplSystemAddTimerCallback(system, 0, _PAPPL_TIMER_INTERVAL, (pappl_timer_cb_t)timer_cb, &testdata);
   papplSystemSetEventCallback(system, event_cb, (void *)"testpappl");
   papplSystemSetPrinterDrivers(system, (int)(sizeof(pwg_drivers) / sizeof(pwg_drivers[0])), pwg_drivers, pwg_autoadd, /* create_cb */NULL, pwg_callback, "testpappl");
@@ -855,6 +901,71 @@ device_list_cb(const char *device_info,	// I - Device description
 }
 
 
+//
+// 'discovery_device_cb()' - Save the URI of a discovered device.
+//
+
+static bool				// O - `true` to stop, `false` to continue
+discovery_device_cb(
+    const char *device_info,		// I - Device description
+    const char *device_uri,		// I - Device URI
+    const char *device_id,		// I - IEEE-1284 device ID
+    char       *uri)			// I - URI buffer (256 bytes)
+{
+  (void)device_info;
+  (void)device_id;
+
+  papplCopyString(uri, device_uri, 256);
+
+  return (false);
+}
+
+
+//
+// 'discovery_list_cb()' - Slowly list a device for each discovery scan.
+//
+
+static bool				// O - `true` if the callback returned `true`
+discovery_list_cb(
+    pappl_device_cb_t   cb,		// I - Callback function
+    void                *data,		// I - Callback data
+    pappl_deverror_cb_t err_cb,		// I - Error callback (unused)
+    void                *err_data)	// I - Error callback data (unused)
+{
+  int	scan;				// Scan number
+  char	uri[256];			// Device URI
+
+
+  (void)err_cb;
+  (void)err_data;
+
+  pthread_mutex_lock(&discovery_mutex);
+  scan = ++ discovery_scans;
+  pthread_mutex_unlock(&discovery_mutex);
+
+  // Take long enough for a refresh to be requested during the scan...
+  sleep(1);
+
+  snprintf(uri, sizeof(uri), "testpappl-discovery://scan-%d", scan);
+
+  return ((cb)("Test Discovery Device", uri, "MFG:Test;MDL:Discovery;", data));
+}
+
+
+//
+// 'discovery_refresh_thread()' - Refresh the device discovery cache.
+//
+
+static void *				// O - Thread exit status
+discovery_refresh_thread(
+    _pappl_testdisc_t *disc)		// I - Discovery test data
+{
+  _papplDiscoveryList(disc->system, PAPPL_DEVTYPE_CUSTOM_LOCAL, 10000, (pappl_device_cb_t)discovery_device_cb, disc->uri);
+
+  return (NULL);
+}
+
+
 //
 // 'do_ps_query()' - Try doing a simple PostScript device query.
 //
@@ -1248,6 +1359,11 @@ run_tests(_pappl_testdata_t *testdata)	// I - Testing data
       if (!test_client(testdata->system))
         ret = (void *)1;
     }
+    else if (!strcmp(name, "get-jobs"))
+    {
+      if (!test_get_jobs(testdata->system))
+        ret = (void *)1;
+    }
 #ifdef HAVE_LIBJPEG
     else if (!strcmp(name, "jpeg"))
     {
@@ -1267,6 +1383,21 @@ run_tests(_pappl_testdata_t *testdata)	// I - Testing data
       if (!test_pwg_raster(testdata->system))
         ret = (void *)1;
     }
+    else if (!strcmp(name, "raw-socket"))
+    {
+      if (!test_raw_socket(testdata->system))
+        ret = (void *)1;
+    }
+    else if (!strcmp(name, "worker-pool"))
+    {
+      if (!test_worker_pool(testdata->system))
+        ret = (void *)1;
+    }
+    else if (!strcmp(name, "save-state"))
+    {
+      if (!test_save_state(testdata->system))
+        ret = (void *)1;
+    }
     else
     {
       testBegin("%s", name);
@@ -1416,9 +1547,29 @@ test_api(pappl_system_t *system)	// I - System
   const char		*get_value;	// Value for "get" call
   pappl_loglevel_t	get_loglevel,	// Log level for "get" call
 			set_loglevel;	// Log level for ", set" call
+  pappl_lmetrics_t	get_lmetrics;	// Log metrics for "get" call
+  pappl_ametrics_t	get_ametrics,	// Authentication cache metrics for "get" call
+			prev_ametrics;	// Previous authentication cache metrics
+  gid_t			auth_groups[32],// Cached authentication groups
+			auth_gid = getgid();
+					// Group for cached authentications
+  _pappl_authcache_t	*auth_entry;	// Cached authentication
+  _pappl_testdisc_t	disc;		// Discovery test data
+  pthread_t		disc_tid;	// Discovery refresh thread
+  pappl_lockstat_t	get_lockstats[10];
+					// Lock statistics for "get" call
   size_t		get_size,	// Size for "get" call
 			set_size;	// Size for ", set" call
+  size_t		changes;	// Configuration changes
   pappl_printer_t	*printer;	// Current printer
+  pappl_job_t		*job;		// Current job
+  pappl_jmetrics_t	get_jmetrics;	// Job metrics for "get" call
+  pappl_device_t	*device;	// Device
+  pappl_devbuf_t	bufs[2];	// Device write buffers
+  pappl_devmetrics_t	dmetrics,	// Device metrics
+			dmetrics2;	// Device metrics after gather write
+  char			data[1000],	// Device write data
+			*bigdata;	// Large device write data
   pappl_loc_t		*loc;		// Current localization
   _pappl_testprinter_t	pdata;		// Printer test data
   const char		*key = "A printer with that name already exists.",
@@ -1460,6 +1611,119 @@ test_api(pappl_system_t *system)	// I - System
   };
 
 
+  // papplDeviceOpen
+  testBegin("api: papplDeviceOpen(file:///dev/null)");
+  if ((device = papplDeviceOpen("file:///dev/null", "api", NULL, NULL)) == NULL)
+  {
+    testEnd(false);
+    pass = false;
+  }
+  else
+  {
+    testEnd(true);
+
+    // papplDeviceWritev
+    testBegin("api: papplDeviceWritev");
+
+    memset(data, 'x', sizeof(data));
+
+    bufs[0].data   = "\033E";
+    bufs[0].length = 2;
+    bufs[1].data   = data;
+    bufs[1].length = sizeof(data);
+
+    for (i = 0; i < 10000; i ++)
+    {
+      if (papplDeviceWritev(device, bufs, 2) != (ssize_t)(sizeof(data) + 2))
+        break;
+    }
+
+    papplDeviceFlush(device);
+    papplDeviceGetMetrics(device, &dmetrics);
+
+    if (i < 10000)
+    {
+      testEndMessage(false, "write %d failed", i + 1);
+      pass = false;
+    }
+    else if (dmetrics.write_bytes != (10000 * (sizeof(data) + 2)) || dmetrics.write_requests >= 1000)
+    {
+      testEndMessage(false, "got write_bytes=%lu, write_requests=%lu", (unsigned long)dmetrics.write_bytes, (unsigned long)dmetrics.write_requests);
+      pass = false;
+    }
+    else
+      testEndMessage(true, "write_requests=%lu, write_msecs=%lu", (unsigned long)dmetrics.write_requests, (unsigned long)dmetrics.write_msecs);
+
+    // papplDeviceGet/SetBufferSize
+    testBegin("api: papplDeviceGetBufferSize");
+    if ((get_size = papplDeviceGetBufferSize(device)) <= 8192)
+    {
+      testEndMessage(false, "got %lu, expected more than 8192", (unsigned long)get_size);
+      pass = false;
+    }
+    else
+      testEndMessage(true, "%lu", (unsigned long)get_size);
+
+    testBegin("api: papplDeviceSetBufferSize(65536)");
+    if (!papplDeviceSetBufferSize(device, 65536))
+    {
+      testEnd(false);
+      pass = false;
+    }
+    else if ((get_size = papplDeviceGetBufferSize(device)) != 65536)
+    {
+      testEndMessage(false, "got %lu, expected 65536", (unsigned long)get_size);
+      pass = false;
+    }
+    else
+      testEnd(true);
+
+    // papplDeviceWritev with buffered data and a buffer larger than the write
+    // buffer should only need a single gather write...
+    testBegin("api: papplDeviceWritev(gather)");
+
+    if ((bigdata = calloc(1, 70000)) == NULL)
+    {
+      testEndMessage(false, "%s", strerror(errno));
+      pass = false;
+    }
+    else
+    {
+      papplDeviceFlush(device);
+      papplDeviceGetMetrics(device, &dmetrics);
+
+      bufs[1].data   = bigdata;
+      bufs[1].length = 70000;
+
+      if (papplDeviceWrite(device, data, sizeof(data)) != (ssize_t)sizeof(data))
+      {
+        testEndMessage(false, "write failed");
+        pass = false;
+      }
+      else if (papplDeviceWritev(device, bufs, 2) != 70002)
+      {
+        testEndMessage(false, "gather write failed");
+        pass = false;
+      }
+      else
+      {
+        papplDeviceGetMetrics(device, &dmetrics2);
+
+        if ((dmetrics2.write_requests - dmetrics.write_requests) != 1 || (dmetrics2.write_bytes - dmetrics.write_bytes) != (sizeof(data) + 70002))
+        {
+          testEndMessage(false, "got %lu write requests for %lu bytes, expected 1 for %lu bytes", (unsigned long)(dmetrics2.write_requests - dmetrics.write_requests), (unsigned long)(dmetrics2.write_bytes - dmetrics.write_bytes), (unsigned long)(sizeof(data) + 70002));
+          pass = false;
+        }
+        else
+          testEnd(true);
+      }
+
+      free(bigdata);
+    }
+
+    papplDeviceClose(device);
+  }
+
   for (i = 0; i < (int)(sizeof(languages) / sizeof(languages[0])); i ++)
   {
     // papplSystemFindLoc
@@ -1547,6 +1811,115 @@ test_api(pappl_system_t *system)	// I - System
   else
     testEnd(true);
 
+  // _papplAuthCacheAdd/Find and papplSystemGetAuthMetrics
+  testBegin("api: _papplAuthCacheFind(not cached)");
+  papplSystemGetAuthMetrics(system, &prev_ametrics);
+  get_int = _papplAuthCacheFind(system, "test-user", "test-password", auth_groups);
+  papplSystemGetAuthMetrics(system, &get_ametrics);
+
+  if (get_int != -1)
+  {
+    testEndMessage(false, "got %d groups, expected -1", get_int);
+    pass = false;
+  }
+  else if (get_ametrics.misses != (prev_ametrics.misses + 1))
+  {
+    testEndMessage(false, "got misses=%lu, expected %lu", (unsigned long)get_ametrics.misses, (unsigned long)(prev_ametrics.misses + 1));
+    pass = false;
+  }
+  else
+    testEnd(true);
+
+  testBegin("api: _papplAuthCacheFind(cached)");
+  _papplAuthCacheAdd(system, "test-user", "test-password", 1, &auth_gid);
+  get_int = _papplAuthCacheFind(system, "test-user", "test-password", auth_groups);
+  papplSystemGetAuthMetrics(system, &get_ametrics);
+
+  if (get_int != 1 || auth_groups[0] != auth_gid)
+  {
+    testEndMessage(false, "got %d groups, expected 1", get_int);
+    pass = false;
+  }
+  else if (get_ametrics.hits != (prev_ametrics.hits + 1) || get_ametrics.entries != 1)
+  {
+    testEndMessage(false, "got hits=%lu, entries=%lu, expected %lu and 1", (unsigned long)get_ametrics.hits, (unsigned long)get_ametrics.entries, (unsigned long)(prev_ametrics.hits + 1));
+    pass = false;
+  }
+  else
+    testEnd(true);
+
+  testBegin("api: _papplAuthCacheFind(wrong password)");
+  if ((get_int = _papplAuthCacheFind(system, "test-user", "wrong-password", auth_groups)) != -1)
+  {
+    testEndMessage(false, "got %d groups, expected -1", get_int);
+    pass = false;
+  }
+  else
+    testEnd(true);
+
+  testBegin("api: _papplAuthCacheFind(expired)");
+  pthread_mutex_lock(&system->auth_mutex);
+  for (auth_entry = (_pappl_authcache_t *)cupsArrayGetFirst(system->auth_cache); auth_entry; auth_entry = (_pappl_authcache_t *)cupsArrayGetNext(system->auth_cache))
+    auth_entry->expires = time(NULL) - 1;
+  pthread_mutex_unlock(&system->auth_mutex);
+
+  get_int = _papplAuthCacheFind(system, "test-user", "test-password", auth_groups);
+  papplSystemGetAuthMetrics(system, &get_ametrics);
+
+  if (get_int != -1)
+  {
+    testEndMessage(false, "got %d groups, expected -1", get_int);
+    pass = false;
+  }
+  else if (get_ametrics.entries != 0)
+  {
+    testEndMessage(false, "got entries=%lu, expected 0", (unsigned long)get_ametrics.entries);
+    pass = false;
+  }
+  else
+    testEnd(true);
+
+  testBegin("api: _papplAuthCacheAdd(least recently used)");
+  for (i = 0; i < _PAPPL_AUTH_CACHE_MAX; i ++)
+  {
+    snprintf(set_str, sizeof(set_str), "user-%d", i);
+    _papplAuthCacheAdd(system, set_str, "test-password", 1, &auth_gid);
+  }
+
+  _papplAuthCacheFind(system, "user-0", "test-password", auth_groups);
+  _papplAuthCacheAdd(system, "test-user", "test-password", 1, &auth_gid);
+
+  papplSystemGetAuthMetrics(system, &get_ametrics);
+  if (get_ametrics.entries != _PAPPL_AUTH_CACHE_MAX || get_ametrics.evictions != (prev_ametrics.evictions + 1))
+  {
+    testEndMessage(false, "got entries=%lu, evictions=%lu, expected %d and %lu", (unsigned long)get_ametrics.entries, (unsigned long)get_ametrics.evictions, _PAPPL_AUTH_CACHE_MAX, (unsigned long)(prev_ametrics.evictions + 1));
+    pass = false;
+  }
+  else if (_papplAuthCacheFind(system, "user-0", "test-password", auth_groups) != 1)
+  {
+    testEndMessage(false, "recently used 'user-0' was evicted");
+    pass = false;
+  }
+  else if (_papplAuthCacheFind(system, "user-1", "test-password", auth_groups) != -1)
+  {
+    testEndMessage(false, "least recently used 'user-1' was not evicted");
+    pass = false;
+  }
+  else
+    testEnd(true);
+
+  testBegin("api: papplSystemGetAuthMetrics(after changing the admin group)");
+  papplSystemSetAdminGroup(system, "admin-flush");
+  papplSystemSetAdminGroup(system, NULL);
+  papplSystemGetAuthMetrics(system, &get_ametrics);
+  if (get_ametrics.entries != 0 || get_ametrics.flushes != (prev_ametrics.flushes + 1))
+  {
+    testEndMessage(false, "got entries=%lu, flushes=%lu, expected 0 and %lu", (unsigned long)get_ametrics.entries, (unsigned long)get_ametrics.flushes, (unsigned long)(prev_ametrics.flushes + 1));
+    pass = false;
+  }
+  else
+    testEndMessage(true, "hits=%lu, misses=%lu", (unsigned long)get_ametrics.hits, (unsigned long)get_ametrics.misses);
+
   // papplSystemGet/SetContact
   testBegin("api: papplSystemGetContact");
   if (!papplSystemGetContact(system, &get_contact))
@@ -1928,6 +2301,38 @@ test_api(pappl_system_t *system)	// I - System
       testEnd(true);
   }
 
+  // papplSystemGetLogMetrics
+  testBegin("api: papplSystemGetLogMetrics");
+  papplSystemGetLogMetrics(system, &get_lmetrics);
+  if (get_lmetrics.writes > get_lmetrics.queued || get_lmetrics.max_queued > get_lmetrics.queued)
+  {
+    testEndMessage(false, "got queued=%lu, max_queued=%lu, writes=%lu", (unsigned long)get_lmetrics.queued, (unsigned long)get_lmetrics.max_queued, (unsigned long)get_lmetrics.writes);
+    pass = false;
+  }
+  else
+    testEndMessage(true, "queued=%lu, dropped=%lu, max_queued=%lu, writes=%lu", (unsigned long)get_lmetrics.queued, (unsigned long)get_lmetrics.dropped, (unsigned long)get_lmetrics.max_queued, (unsigned long)get_lmetrics.writes);
+
+  // papplSystemGetLockStats
+  testBegin("api: papplSystemGetLockStats");
+  get_size = papplSystemGetLockStats(system, sizeof(get_lockstats) / sizeof(get_lockstats[0]), get_lockstats);
+#ifdef PAPPL_LOCK_PROFILE
+  if (get_size == 0 || get_lockstats[0].acquires == 0)
+  {
+    testEndMessage(false, "got %lu call sites", (unsigned long)get_size);
+    pass = false;
+  }
+  else
+    testEndMessage(true, "%lu call sites, most contended is %s() %s:%d", (unsigned long)get_size, get_lockstats[0].func, get_lockstats[0].file, get_lockstats[0].line);
+#else
+  if (get_size != 0)
+  {
+    testEndMessage(false, "got %lu call sites, expected 0", (unsigned long)get_size);
+    pass = false;
+  }
+  else
+    testEndMessage(true, "not enabled");
+#endif // PAPPL_LOCK_PROFILE
+
   // papplSystemGet/SetMaxLogSize
   testBegin("api: papplSystemGetMaxLogSize");
   if ((get_size = papplSystemGetMaxLogSize(system)) != (size_t)(1024 * 1024))
@@ -1961,6 +2366,90 @@ test_api(pappl_system_t *system)	// I - System
   else
     testEnd(true);
 
+  // papplSystemGet/SetMaxProcessingJobs
+  testBegin("api: papplSystemGetMaxProcessingJobs");
+  if ((get_int = papplSystemGetMaxProcessingJobs(system)) < 4 || get_int > 64)
+  {
+    testEndMessage(false, "got %d, expected 4 to 64", get_int);
+    pass = false;
+  }
+  else
+    testEnd(true);
+
+  for (set_int = 1; set_int <= 16; set_int *= 2)
+  {
+    testBegin("api: papplSystemSetMaxProcessingJobs(%d)", set_int);
+    papplSystemSetMaxProcessingJobs(system, set_int);
+    if ((get_int = papplSystemGetMaxProcessingJobs(system)) != set_int)
+    {
+      testEndMessage(false, "got %d, expected %d", get_int, set_int);
+      pass = false;
+    }
+    else
+      testEnd(true);
+  }
+
+  testBegin("api: papplSystemSetMaxProcessingJobs(0)");
+  papplSystemSetMaxProcessingJobs(system, 0);
+  if ((get_int = papplSystemGetMaxProcessingJobs(system)) < 4 || get_int > 64)
+  {
+    testEndMessage(false, "got %d, expected 4 to 64", get_int);
+    pass = false;
+  }
+  else
+    testEnd(true);
+
+  // papplSystemGet/SetStatusInterval
+  testBegin("api: papplSystemGetStatusInterval");
+  if ((get_int = papplSystemGetStatusInterval(system)) != 0)
+  {
+    testEndMessage(false, "got %d, expected 0", get_int);
+    pass = false;
+  }
+  else
+    testEnd(true);
+
+  for (set_int = 0; set_int <= 10; set_int += 5)
+  {
+    testBegin("api: papplSystemSetStatusInterval(%d)", set_int);
+    papplSystemSetStatusInterval(system, set_int);
+    if ((get_int = papplSystemGetStatusInterval(system)) != set_int)
+    {
+      testEndMessage(false, "got %d, expected %d", get_int, set_int);
+      pass = false;
+    }
+    else
+      testEnd(true);
+  }
+
+  // Keep the status thread polling for the remaining tests...
+  papplSystemSetStatusInterval(system, 5);
+
+  // papplSystemAdd/RemoveTimerCallback
+  if (papplSystemIsRunning(system))
+  {
+    testBegin("api: papplSystemRemoveTimerCallback");
+    get_int = set_int = 0;
+    if (!papplSystemAddTimerCallback(system, time(NULL), 0, (pappl_timer_cb_t)timer_once_cb, &get_int) || !papplSystemAddTimerCallback(system, time(NULL) + 1, 0, (pappl_timer_cb_t)timer_once_cb, &set_int))
+    {
+      testEndMessage(false, "unable to add timers");
+      pass = false;
+    }
+    else
+    {
+      papplSystemRemoveTimerCallback(system, (pappl_timer_cb_t)timer_once_cb, &set_int);
+      sleep(2);
+
+      if (get_int != 1 || set_int != 0)
+      {
+        testEndMessage(false, "got %d and %d calls, expected 1 and 0", get_int, set_int);
+        pass = false;
+      }
+      else
+        testEnd(true);
+    }
+  }
+
   // papplSystemGet/SetNextPrinterID
   testBegin("api: papplSystemGetNextPrinterID");
   if ((get_int = papplSystemGetNextPrinterID(system)) != 3)
@@ -2230,23 +2719,63 @@ test_api(pappl_system_t *system)	// I - System
     }
   }
 
-  // papplPrinterCreate/Delete
-  for (i = 0; i < 10; i ++)
+  if ((printer = papplSystemFindPrinter(system, NULL, 2, NULL)) != NULL)
   {
-    char	name[128];		// Printer name
+    pappl_printer_t	*match;		// Matching printer
 
-    snprintf(name, sizeof(name), "test%d", i);
-    testBegin("api: papplPrinterCreate(%s)", name);
-    if ((printer = papplPrinterCreate(system, 0, name, "pwg_common-300dpi-black_1-sgray_8", "MFG:PWG;MDL:Office Printer;CMD:PWGRaster;", "file:///dev/null")) == NULL)
+    papplPrinterGetPath(printer, NULL, get_str, sizeof(get_str));
+    snprintf(set_str, sizeof(set_str), "/ipp/print%s/%d", get_str, papplPrinterGetNextJobID(printer));
+
+    testBegin("api: papplSystemFindPrinter('%s')", set_str);
+    if ((match = papplSystemFindPrinter(system, set_str, 0, NULL)) != printer)
     {
-      testEndMessage(false, "got NULL");
+      testEndMessage(false, "got printer #%d, expected #2", match ? papplPrinterGetID(match) : 0);
       pass = false;
     }
     else
-    {
       testEnd(true);
 
-      get_int = papplPrinterGetID(printer);
+    testBegin("api: papplSystemFindPrinter('%s')", papplPrinterGetDeviceURI(printer));
+    if ((match = papplSystemFindPrinter(system, NULL, 0, papplPrinterGetDeviceURI(printer))) == NULL)
+    {
+      testEndMessage(false, "got NULL");
+      pass = false;
+    }
+    else if (strcmp(papplPrinterGetDeviceURI(match), papplPrinterGetDeviceURI(printer)))
+    {
+      testEndMessage(false, "got printer #%d with device URI '%s'", papplPrinterGetID(match), papplPrinterGetDeviceURI(match));
+      pass = false;
+    }
+    else
+      testEnd(true);
+  }
+
+  testBegin("api: papplSystemFindPrinter('/unknown/printer')");
+  if ((printer = papplSystemFindPrinter(system, "/unknown/printer", 0, NULL)) != NULL)
+  {
+    testEndMessage(false, "got printer #%d", papplPrinterGetID(printer));
+    pass = false;
+  }
+  else
+    testEnd(true);
+
+  // papplPrinterCreate/Delete
+  for (i = 0; i < 10; i ++)
+  {
+    char	name[128];		// Printer name
+
+    snprintf(name, sizeof(name), "test%d", i);
+    testBegin("api: papplPrinterCreate(%s)", name);
+    if ((printer = papplPrinterCreate(system, 0, name, "pwg_common-300dpi-black_1-sgray_8", "MFG:PWG;MDL:Office Printer;CMD:PWGRaster;", "file:///dev/null")) == NULL)
+    {
+      testEndMessage(false, "got NULL");
+      pass = false;
+    }
+    else
+    {
+      testEnd(true);
+
+      get_int = papplPrinterGetID(printer);
 
       testBegin("api: papplPrinterDelete(%s)", name);
       papplPrinterDelete(printer);
@@ -2277,6 +2806,94 @@ test_api(pappl_system_t *system)	// I - System
     }
   }
 
+  // papplPrinterDelete with jobs queued in the job scheduler - the printer is
+  // paused so that the workers look at the printer but don't start the jobs...
+  testBegin("api: papplPrinterDelete(with queued jobs)");
+  for (i = 0; i < 20; i ++)
+  {
+    if ((printer = papplPrinterCreate(system, 0, "test-queued", "pwg_common-300dpi-black_1-sgray_8", "MFG:PWG;MDL:Office Printer;CMD:PWGRaster;", "file:///dev/null")) == NULL)
+    {
+      testEndMessage(false, "papplPrinterCreate returned NULL");
+      pass = false;
+      break;
+    }
+
+    papplPrinterPause(printer);
+
+    for (j = 0; j < 5; j ++)
+    {
+      if ((job = _papplJobCreate(printer, 0, "test-user", NULL, "Queued Job", NULL)) != NULL)
+        _papplJobSubmitFile(job, "portrait-gray.png");
+    }
+
+    for (j = 0; j < 10; j ++)
+      _papplJobSchedulerAdd(printer);
+
+    get_int = papplPrinterGetID(printer);
+
+    papplPrinterDelete(printer);
+
+    if (papplSystemFindPrinter(system, NULL, get_int, NULL) != NULL)
+    {
+      testEndMessage(false, "printer not deleted");
+      pass = false;
+      break;
+    }
+  }
+
+  if (i >= 20)
+  {
+    papplSystemGetJobMetrics(system, &get_jmetrics);
+
+    if (get_jmetrics.queued != 0)
+    {
+      testEndMessage(false, "got queued=%lu, expected 0", (unsigned long)get_jmetrics.queued);
+      pass = false;
+    }
+    else
+      testEnd(true);
+  }
+
+  // Job progress events should not be saved to the state journal...
+  testBegin("api: papplSystemAddEvent(job-progress)");
+  if ((printer = papplPrinterCreate(system, 0, "test-events", "pwg_common-300dpi-black_1-sgray_8", "MFG:PWG;MDL:Office Printer;CMD:PWGRaster;", "file:///dev/null")) == NULL)
+  {
+    testEndMessage(false, "papplPrinterCreate returned NULL");
+    pass = false;
+  }
+  else
+  {
+    papplPrinterPause(printer);
+
+    if ((job = _papplJobCreate(printer, 0, "test-user", NULL, "Progress Job", NULL)) == NULL)
+    {
+      testEndMessage(false, "_papplJobCreate returned NULL");
+      pass = false;
+    }
+    else
+    {
+      pthread_mutex_lock(&system->config_mutex);
+      changes = system->config_changes;
+      pthread_mutex_unlock(&system->config_mutex);
+
+      papplSystemAddEvent(system, printer, job, PAPPL_EVENT_JOB_PROGRESS, NULL);
+
+      pthread_mutex_lock(&system->config_mutex);
+      get_size = system->config_changes;
+      pthread_mutex_unlock(&system->config_mutex);
+
+      if (get_size != changes)
+      {
+        testEndMessage(false, "got config_changes=%lu, expected %lu", (unsigned long)get_size, (unsigned long)changes);
+        pass = false;
+      }
+      else
+        testEnd(true);
+    }
+
+    papplPrinterDelete(printer);
+  }
+
   // papplSystemIteratePrinters
   testBegin("api: papplSystemIteratePrinters");
 
@@ -2298,6 +2915,48 @@ test_api(pappl_system_t *system)	// I - System
   else
     testEnd(true);
 
+  // _papplDiscoveryList with a refresh during a scan
+  testBegin("api: _papplDiscoveryList(refresh during scan)");
+
+  papplDeviceAddScheme("testpappl-discovery", PAPPL_DEVTYPE_CUSTOM_LOCAL, discovery_list_cb, NULL, NULL, NULL, NULL, NULL, NULL);
+
+  disc.system = system;
+  disc.uri[0] = '\0';
+
+  if (pthread_create(&disc_tid, NULL, (void *(*)(void *))discovery_refresh_thread, &disc))
+  {
+    testEndMessage(false, "unable to create thread: %s", strerror(errno));
+    pass = false;
+  }
+  else
+  {
+    // Wait for the first scan to start, then refresh again...
+    for (i = 0; i < 200; i ++)
+    {
+      pthread_mutex_lock(&discovery_mutex);
+      get_int = discovery_scans;
+      pthread_mutex_unlock(&discovery_mutex);
+
+      if (get_int > 0)
+        break;
+
+      usleep(10000);
+    }
+
+    get_str[0] = '\0';
+    _papplDiscoveryList(system, PAPPL_DEVTYPE_CUSTOM_LOCAL, 10000, (pappl_device_cb_t)discovery_device_cb, get_str);
+
+    pthread_join(disc_tid, NULL);
+
+    if (strcmp(disc.uri, "testpappl-discovery://scan-1") || strcmp(get_str, "testpappl-discovery://scan-2"))
+    {
+      testEndMessage(false, "got '%s' and '%s', expected 'testpappl-discovery://scan-1' and 'testpappl-discovery://scan-2'", disc.uri, get_str);
+      pass = false;
+    }
+    else
+      testEnd(true);
+  }
+
   return (pass);
 }
 
@@ -2434,6 +3093,38 @@ test_api_printer(
   else
     testEnd(true);
 
+  // papplPrinterGet/SetDeviceKeepAlive
+  testBegin("api: papplPrinterGetDeviceKeepAlive");
+  if ((get_int = papplPrinterGetDeviceKeepAlive(printer)) != 0)
+  {
+    testEndMessage(false, "got %d, expected 0", get_int);
+    pass = false;
+  }
+  else
+    testEnd(true);
+
+  testBegin("api: papplPrinterGet/SetDeviceKeepAlive(30)");
+  papplPrinterSetDeviceKeepAlive(printer, 30);
+  if ((get_int = papplPrinterGetDeviceKeepAlive(printer)) != 30)
+  {
+    testEndMessage(false, "got %d, expected 30", get_int);
+    pass = false;
+  }
+  else
+    testEnd(true);
+
+  testBegin("api: papplPrinterGet/SetDeviceKeepAlive(-1)");
+  papplPrinterSetDeviceKeepAlive(printer, -1);
+  if ((get_int = papplPrinterGetDeviceKeepAlive(printer)) != 30)
+  {
+    testEndMessage(false, "got %d, expected 30", get_int);
+    pass = false;
+  }
+  else
+    testEnd(true);
+
+  papplPrinterSetDeviceKeepAlive(printer, 0);
+
   // papplPrinterGet/SetDNSSDName
   testBegin("api: papplPrinterGetDNSSDName");
   if (!papplPrinterGetDNSSDName(printer, get_str, sizeof(get_str)))
@@ -2733,9 +3424,13 @@ test_client(pappl_system_t *system)	// I - System
 {
   bool		ret = false;		// Return value
   http_t	*http;			// HTTP connection
+  pappl_printer_t *printer;		// Printer
   char		uri[1024],		// "printer-uri" value
 		filename[1024] = "",	// Print file
-	        outfile[1024];		// Output file
+	        outfile[1024],		// Output file
+		resfile[1024],		// Resource file
+		location[256];		// Original "printer-location" value
+  FILE		*fp;			// Resource file pointer
   ipp_t		*request,		// Request
 		*response,		// Response
 		*supported = NULL;	// Supported values
@@ -2745,8 +3440,24 @@ test_client(pappl_system_t *system)	// I - System
   int		i,			// Looping var
 		job_id,			// "job-id" value
 		subscription_id;	// "notify-subscription-id" value
+  pappl_subscription_t *sub;		// Subscription for sequence test
   ipp_jstate_t	job_state;		// "job-state" value
   time_t	end;			// End time
+  http_status_t	status;			// HTTP status
+  char		buffer[8192],		// Resource buffer
+		encoding[256];		// Content-Encoding value
+  ssize_t	bytes;			// Bytes read
+  size_t	total,			// Total bytes read
+		responses;		// Number of resource responses
+  pappl_cmetrics_t cmetrics;		// Client metrics
+  size_t	html_flushes;		// HTML output buffer flushes before page
+  char		last_modified[256];	// Last-Modified value
+  pappl_rmetrics_t rmetrics;		// Resource metrics
+  static const char * const contents[] =// Resource file contents
+  {
+    "Original resource file.\n",
+    "Changed resource file with a different length.\n"
+  };
   static const char * const events[] =	// "notify-events" attribute
   {
     "job-completed",
@@ -2827,6 +3538,355 @@ test_client(pappl_system_t *system)	// I - System
     ippDelete(response);
   }
 
+  // Test static resource compression
+  testBegin("client: GET /style.css (Accept-Encoding: gzip)");
+
+  papplSystemGetResourceMetrics(system, &rmetrics);
+  responses = rmetrics.responses;
+
+  httpClearFields(http);
+  httpSetField(http, HTTP_FIELD_ACCEPT_ENCODING, "gzip");
+
+  if (httpGet(http, "/style.css"))
+  {
+    testEndMessage(false, "%s", cupsGetErrorString());
+    goto done;
+  }
+
+  while ((status = httpUpdate(http)) == HTTP_STATUS_CONTINUE);
+
+  papplCopyString(encoding, httpGetField(http, HTTP_FIELD_CONTENT_ENCODING), sizeof(encoding));
+
+  for (total = 0; (bytes = httpRead(http, buffer, sizeof(buffer))) > 0;)
+    total += (size_t)bytes;
+
+  httpClearFields(http);
+  papplSystemGetResourceMetrics(system, &rmetrics);
+
+  if (status != HTTP_STATUS_OK)
+  {
+    testEndMessage(false, "%s", httpStatusString(status));
+    goto done;
+  }
+  else if (total == 0)
+  {
+    testEndMessage(false, "no content");
+    goto done;
+  }
+  else if (rmetrics.responses <= responses || (encoding[0] && rmetrics.compressed == 0))
+  {
+    testEndMessage(false, "got responses=%lu, compressed=%lu", (unsigned long)rmetrics.responses, (unsigned long)rmetrics.compressed);
+    goto done;
+  }
+  else
+  {
+    testEndMessage(true, "%s, %lu bytes, compressed=%lu, saved_bytes=%lu", encoding[0] ? encoding : "identity", (unsigned long)total, (unsigned long)rmetrics.compressed, (unsigned long)rmetrics.saved_bytes);
+  }
+
+  // HEAD must report the same Content-Encoding as GET...
+  testBegin("client: HEAD /style.css (Accept-Encoding: gzip)");
+
+  httpClearFields(http);
+  httpSetField(http, HTTP_FIELD_ACCEPT_ENCODING, "gzip");
+
+  if (httpHead(http, "/style.css"))
+  {
+    testEndMessage(false, "%s", cupsGetErrorString());
+    goto done;
+  }
+
+  while ((status = httpUpdate(http)) == HTTP_STATUS_CONTINUE);
+
+  if (status != HTTP_STATUS_OK)
+  {
+    testEndMessage(false, "%s", httpStatusString(status));
+    httpClearFields(http);
+    goto done;
+  }
+  else if (strcmp(encoding, httpGetField(http, HTTP_FIELD_CONTENT_ENCODING)))
+  {
+    testEndMessage(false, "got Content-Encoding \"%s\", expected \"%s\"", httpGetField(http, HTTP_FIELD_CONTENT_ENCODING), encoding);
+    httpClearFields(http);
+    goto done;
+  }
+  else
+  {
+    testEndMessage(true, "%s", encoding[0] ? encoding : "identity");
+  }
+
+  httpFlush(http);
+  httpClearFields(http);
+
+  // Test that changes to file resources are served...
+  snprintf(resfile, sizeof(resfile), "%s/resource.txt", output_directory);
+  papplSystemAddResourceFile(system, "/testpappl.txt", "text/plain", resfile);
+
+  for (i = 0; i < (int)(sizeof(contents) / sizeof(contents[0])); i ++)
+  {
+    testBegin("client: GET /testpappl.txt (%lu bytes)", (unsigned long)strlen(contents[i]));
+
+    if ((fp = fopen(resfile, "w")) == NULL)
+    {
+      testEndMessage(false, "%s: %s", resfile, strerror(errno));
+      goto done;
+    }
+
+    fputs(contents[i], fp);
+    fclose(fp);
+
+    if (httpGet(http, "/testpappl.txt"))
+    {
+      testEndMessage(false, "%s", cupsGetErrorString());
+      goto done;
+    }
+
+    while ((status = httpUpdate(http)) == HTTP_STATUS_CONTINUE);
+
+    for (total = 0; total < (sizeof(buffer) - 1) && (bytes = httpRead(http, buffer + total, sizeof(buffer) - 1 - total)) > 0;)
+      total += (size_t)bytes;
+
+    buffer[total] = '\0';
+
+    if (status != HTTP_STATUS_OK)
+    {
+      testEndMessage(false, "%s", httpStatusString(status));
+      goto done;
+    }
+    else if (strcmp(buffer, contents[i]))
+    {
+      testEndMessage(false, "got %lu bytes, expected %lu", (unsigned long)total, (unsigned long)strlen(contents[i]));
+      goto done;
+    }
+    else
+    {
+      testEnd(true);
+    }
+  }
+
+  // Test that files too large to cache are served in full...
+  testBegin("client: GET /testpappl.txt (%lu bytes)", (unsigned long)(_PAPPL_RFILE_MAX + 1000));
+
+  if ((fp = fopen(resfile, "w")) == NULL)
+  {
+    testEndMessage(false, "%s: %s", resfile, strerror(errno));
+    goto done;
+  }
+
+  for (total = 0; total < (_PAPPL_RFILE_MAX + 1000); total ++)
+    putc('a' + (int)(total % 26), fp);
+
+  fclose(fp);
+
+  if (httpGet(http, "/testpappl.txt"))
+  {
+    testEndMessage(false, "%s", cupsGetErrorString());
+    goto done;
+  }
+
+  while ((status = httpUpdate(http)) == HTTP_STATUS_CONTINUE);
+
+  for (total = 0, i = 0; (bytes = httpRead(http, buffer, sizeof(buffer))) > 0; total += (size_t)bytes)
+  {
+    ssize_t j;				// Looping var
+
+    for (j = 0; j < bytes; j ++)
+    {
+      if (buffer[j] != ('a' + (int)((total + (size_t)j) % 26)))
+        i ++;
+    }
+  }
+
+  if (status != HTTP_STATUS_OK)
+  {
+    testEndMessage(false, "%s", httpStatusString(status));
+    goto done;
+  }
+  else if (total != (_PAPPL_RFILE_MAX + 1000) || i)
+  {
+    testEndMessage(false, "got %lu bytes with %d differences", (unsigned long)total, i);
+    goto done;
+  }
+  else
+  {
+    testEnd(true);
+  }
+
+  papplSystemRemoveResource(system, "/testpappl.txt");
+  unlink(resfile);
+
+  // Test buffered HTML output
+  testBegin("client: GET / (HTML)");
+
+  papplSystemGetClientMetrics(system, &cmetrics);
+  html_flushes = cmetrics.html_flushes;
+
+  if (httpGet(http, "/"))
+  {
+    testEndMessage(false, "%s", cupsGetErrorString());
+    goto done;
+  }
+
+  while ((status = httpUpdate(http)) == HTTP_STATUS_CONTINUE);
+
+  // Keep the end of the page in the encoding buffer to check for the closing
+  // tag...
+  memset(encoding, ' ', sizeof(encoding) - 1);
+  encoding[sizeof(encoding) - 1] = '\0';
+
+  for (total = 0; (bytes = httpRead(http, buffer, sizeof(buffer))) > 0;)
+  {
+    total += (size_t)bytes;
+
+    if ((size_t)bytes >= (sizeof(encoding) - 1))
+    {
+      memcpy(encoding, buffer + (size_t)bytes - (sizeof(encoding) - 1), sizeof(encoding) - 1);
+    }
+    else
+    {
+      memmove(encoding, encoding + bytes, sizeof(encoding) - 1 - (size_t)bytes);
+      memcpy(encoding + sizeof(encoding) - 1 - (size_t)bytes, buffer, (size_t)bytes);
+    }
+  }
+
+  if (status != HTTP_STATUS_OK)
+  {
+    testEndMessage(false, "%s", httpStatusString(status));
+    goto done;
+  }
+  else if (total == 0 || !strstr(encoding, "</html>"))
+  {
+    testEndMessage(false, "incomplete page (%lu bytes)", (unsigned long)total);
+    goto done;
+  }
+  else
+  {
+    testEndMessage(true, "%lu bytes", (unsigned long)total);
+  }
+
+  // Test conditional GET of the home page, which only provides a Last-Modified
+  // date once it is at least a second old...
+  if (papplSystemGetOptions(system) & PAPPL_SOPTIONS_MULTI_QUEUE)
+  {
+    testBegin("client: GET / (If-Modified-Since)");
+
+    for (i = 0, last_modified[0] = '\0'; i < 3 && !last_modified[0]; i ++)
+    {
+      if (i > 0)
+        sleep(1);
+
+      if (httpGet(http, "/"))
+      {
+	testEndMessage(false, "%s", cupsGetErrorString());
+	goto done;
+      }
+
+      while ((status = httpUpdate(http)) == HTTP_STATUS_CONTINUE);
+
+      papplCopyString(last_modified, httpGetField(http, HTTP_FIELD_LAST_MODIFIED), sizeof(last_modified));
+      papplCopyString(encoding, httpGetField(http, HTTP_FIELD_CONTENT_LANGUAGE), sizeof(encoding));
+      httpFlush(http);
+
+      if (status != HTTP_STATUS_OK)
+      {
+	testEndMessage(false, "%s", httpStatusString(status));
+	goto done;
+      }
+      else if (last_modified[0] && strcmp(encoding, "en"))
+      {
+	testEndMessage(false, "got Content-Language '%s', expected 'en'", encoding);
+	goto done;
+      }
+    }
+
+    if (!last_modified[0])
+    {
+      testEndMessage(false, "no Last-Modified date");
+      goto done;
+    }
+
+    httpClearFields(http);
+    httpSetField(http, HTTP_FIELD_IF_MODIFIED_SINCE, last_modified);
+
+    if (httpGet(http, "/"))
+    {
+      testEndMessage(false, "%s", cupsGetErrorString());
+      goto done;
+    }
+
+    while ((status = httpUpdate(http)) == HTTP_STATUS_CONTINUE);
+
+    papplCopyString(encoding, httpGetField(http, HTTP_FIELD_LAST_MODIFIED), sizeof(encoding));
+    httpFlush(http);
+    httpClearFields(http);
+
+    if (status == HTTP_STATUS_OK && (!encoding[0] || httpGetDateTime(encoding) > httpGetDateTime(last_modified)))
+    {
+      // The printer status changed in the meantime...
+      testEndMessage(true, "modified since %s", last_modified);
+    }
+    else if (status != HTTP_STATUS_NOT_MODIFIED)
+    {
+      testEndMessage(false, "got %s, expected %s", httpStatusString(status), httpStatusString(HTTP_STATUS_NOT_MODIFIED));
+      goto done;
+    }
+    else
+    {
+      testEndMessage(true, "not modified since %s", last_modified);
+    }
+  }
+
+  // Test metrics
+  testBegin("client: GET /metrics");
+
+  if (httpGet(http, "/metrics"))
+  {
+    testEndMessage(false, "%s", cupsGetErrorString());
+    goto done;
+  }
+
+  while ((status = httpUpdate(http)) == HTTP_STATUS_CONTINUE);
+
+  // Keep the first buffer of metrics and skip the rest...
+  for (total = 0; (bytes = httpRead(http, buffer + total, sizeof(buffer) - total - 1)) > 0;)
+  {
+    if ((total += (size_t)bytes) >= (sizeof(buffer) - 1))
+      break;
+  }
+
+  buffer[total] = '\0';
+
+  while (httpRead(http, encoding, sizeof(encoding)) > 0);
+
+  if (status != HTTP_STATUS_OK)
+  {
+    testEndMessage(false, "%s", httpStatusString(status));
+    goto done;
+  }
+  else if (!strstr(buffer, "# TYPE pappl_clients gauge\n") || !strstr(buffer, "pappl_ipp_request_duration_seconds_count{operation=\""))
+  {
+    testEndMessage(false, "missing metrics");
+    testMessage("%s", buffer);
+    goto done;
+  }
+  else
+  {
+    testEndMessage(true, "%lu bytes", (unsigned long)total);
+  }
+
+  // The client metrics for the HTML page are updated once the request is
+  // complete, which is before the /metrics request is processed...
+  testBegin("client: papplSystemGetClientMetrics");
+  papplSystemGetClientMetrics(system, &cmetrics);
+  if (cmetrics.html_flushes <= html_flushes || cmetrics.html_bytes == 0)
+  {
+    testEndMessage(false, "got html_flushes=%lu, html_bytes=%lu", (unsigned long)cmetrics.html_flushes, (unsigned long)cmetrics.html_bytes);
+    goto done;
+  }
+  else
+  {
+    testEndMessage(true, "html_flushes=%lu, html_bytes=%lu", (unsigned long)cmetrics.html_flushes, (unsigned long)cmetrics.html_bytes);
+  }
+
   // Test Get-Printers
   testBegin("client: Get-Printers");
 
@@ -2917,6 +3977,49 @@ test_client(pappl_system_t *system)	// I - System
     testEnd(true);
   }
 
+  // Test Get-Printer-Attributes after configuration changes...
+  if ((printer = papplSystemFindPrinter(system, "/ipp/print", 0, NULL)) == NULL)
+    goto done;
+
+  if (!papplPrinterGetLocation(printer, location, sizeof(location)))
+    location[0] = '\0';
+
+  for (i = 0; i < 3; i ++)
+  {
+    const char	*expected = i == 1 ? "Cache Test" : location;
+					// Expected "printer-location" value
+    const char	*value;			// Actual "printer-location" value
+
+    testBegin("client: Get-Printer-Attributes(printer-location='%s')", expected);
+
+    if (i > 0)
+      papplPrinterSetLocation(printer, *expected ? expected : NULL);
+
+    request = ippNewRequest(IPP_OP_GET_PRINTER_ATTRIBUTES);
+    ippAddString(request, IPP_TAG_OPERATION, IPP_CONST_TAG(IPP_TAG_URI), "printer-uri", NULL, "ipp://localhost/ipp/print");
+    ippAddString(request, IPP_TAG_OPERATION, IPP_TAG_NAME, "requesting-user-name", NULL, cupsGetUser());
+    ippAddString(request, IPP_TAG_OPERATION, IPP_CONST_TAG(IPP_TAG_KEYWORD), "requested-attributes", NULL, "printer-location");
+
+    response = cupsDoRequest(http, request, "/ipp/print");
+    value    = ippGetString(ippFindAttribute(response, "printer-location", IPP_TAG_TEXT), 0, NULL);
+
+    if (cupsGetError() != IPP_STATUS_OK)
+    {
+      testEndMessage(false, "%s", cupsGetErrorString());
+      ippDelete(response);
+      goto done;
+    }
+    else if (!value || strcmp(value, expected))
+    {
+      testEndMessage(false, "got '%s', expected '%s'", value ? value : "(null)", expected);
+      ippDelete(response);
+      goto done;
+    }
+
+    testEnd(true);
+    ippDelete(response);
+  }
+
   // Create a system subscription for a variety of events...
   testBegin("client: Create-System-Subscriptions");
 
@@ -3348,6 +4451,51 @@ test_client(pappl_system_t *system)	// I - System
     testEnd(true);
   }
 
+  // Get the first event of a new subscription...
+  testBegin("client: Get-Notifications(notify-sequence-numbers=1)");
+
+  if ((sub = papplSubscriptionCreate(system, NULL, NULL, 0, PAPPL_EVENT_SYSTEM_STATE_CHANGED, cupsGetUser(), "en", NULL, 0, 0, 60)) == NULL)
+  {
+    testEndMessage(false, "papplSubscriptionCreate returned NULL");
+    goto done;
+  }
+
+  papplSystemAddEvent(system, NULL, NULL, PAPPL_EVENT_SYSTEM_STATE_CHANGED, "Sequence test.");
+
+  request = ippNewRequest(IPP_OP_GET_NOTIFICATIONS);
+  ippAddString(request, IPP_TAG_OPERATION, IPP_CONST_TAG(IPP_TAG_URI), "system-uri", NULL, "ipp://localhost/ipp/system");
+  ippAddInteger(request, IPP_TAG_OPERATION, IPP_TAG_INTEGER, "notify-subscription-ids", papplSubscriptionGetID(sub));
+  ippAddInteger(request, IPP_TAG_OPERATION, IPP_TAG_INTEGER, "notify-sequence-numbers", 1);
+  ippAddString(request, IPP_TAG_OPERATION, IPP_TAG_NAME, "requesting-user-name", NULL, cupsGetUser());
+
+  response = cupsDoRequest(http, request, "/ipp/system");
+
+  papplSubscriptionCancel(sub);
+
+  if (cupsGetError() != IPP_STATUS_OK)
+  {
+    testEndMessage(false, "%s", cupsGetErrorString());
+    ippDelete(response);
+    goto done;
+  }
+  else if ((i = ippGetInteger(ippFindAttribute(response, "notify-sequence-number", IPP_TAG_INTEGER), 0)) != 1)
+  {
+    testEndMessage(false, "got notify-sequence-number=%d, expected 1", i);
+    ippDelete(response);
+    goto done;
+  }
+  else if (!ippGetString(ippFindAttribute(response, "notify-subscription-uuid", IPP_TAG_URI), 0, NULL) || !*ippGetString(ippFindAttribute(response, "notify-subscription-uuid", IPP_TAG_URI), 0, NULL))
+  {
+    testEndMessage(false, "missing or empty notify-subscription-uuid");
+    ippDelete(response);
+    goto done;
+  }
+  else
+  {
+    testEndMessage(true, "notify-subscription-uuid=\"%s\"", ippGetString(ippFindAttribute(response, "notify-subscription-uuid", IPP_TAG_URI), 0, NULL));
+    ippDelete(response);
+  }
+
   // PAPPL-Find-Devices
   testBegin("client: PAPPL-Find-Devices");
   request = ippNewRequest(IPP_OP_PAPPL_FIND_DEVICES);
@@ -3364,6 +4512,23 @@ test_client(pappl_system_t *system)	// I - System
 
   ippDelete(response);
 
+  // PAPPL-Find-Devices (refresh)
+  testBegin("client: PAPPL-Find-Devices (refresh)");
+  request = ippNewRequest(IPP_OP_PAPPL_FIND_DEVICES);
+  ippAddString(request, IPP_TAG_OPERATION, IPP_CONST_TAG(IPP_TAG_URI), "system-uri", NULL, "ipp://localhost/ipp/system");
+  ippAddInteger(request, IPP_TAG_OPERATION, IPP_TAG_INTEGER, "smi55357-device-refresh", 1000);
+
+  response = cupsDoRequest(http, request, "/ipp/system");
+
+  if ((attr = ippFindAttribute(response, "smi55357-device-col", IPP_TAG_BEGIN_COLLECTION)) != NULL)
+    testEndMessage(true, "%u devices found", (unsigned)ippGetCount(attr));
+  else if (cupsGetError() == IPP_STATUS_ERROR_NOT_FOUND)
+    testEndMessage(true, "no devices found");
+  else
+    testEndMessage(false, "failed: %s", cupsGetErrorString());
+
+  ippDelete(response);
+
   // PAPPL-Find-Drivers
   testBegin("client: PAPPL-Find-Drivers");
   request = ippNewRequest(IPP_OP_PAPPL_FIND_DRIVERS);
@@ -3456,6 +4621,158 @@ test_client(pappl_system_t *system)	// I - System
 }
 
 
+//
+// 'test_get_jobs()' - Benchmark Get-Jobs with a large number of retained jobs.
+//
+
+static bool				// O - `true` on success, `false` on failure
+test_get_jobs(pappl_system_t *system)	// I - System
+{
+  bool		ret = false;		// Return value
+  pappl_printer_t *printer;		// Benchmark printer
+  pappl_job_t	*job;			// Current job
+  http_t	*http = NULL;		// HTTP connection
+  char		uri[1024],		// "printer-uri" value
+		resource[1024];		// Printer resource path
+  ipp_t		*request,		// Request
+		*response;		// Response
+  ipp_attribute_t *attr;		// Current attribute
+  int		i,			// Looping var
+		j,			// Looping var
+		count;			// Number of jobs returned
+  struct timeval start,			// Start time
+		end;			// End time
+  double	secs;			// Elapsed seconds
+  static const char * const users[] =	// Usernames for the jobs
+  {
+    "bench-user",
+    "bench-rare"
+  };
+  static const struct
+  {
+    const char	*which_jobs;		// "which-jobs" value
+    const char	*username;		// "my-jobs" username, if any
+    int		limit;			// "limit" value
+    int		expected;		// Expected number of jobs
+  } tests[] =				// Get-Jobs requests to benchmark
+  {
+    { "not-completed", NULL, 0, 0 },
+    { "completed", NULL, 10, 10 },
+    { "all", NULL, 10, 10 },
+    { "completed", "bench-rare", 10, 10 },
+    { "all", "bench-rare", 0, _PAPPL_BENCH_JOBS / 1000 }
+  };
+
+
+  // Create a printer with lots of completed jobs...
+  testBegin("get-jobs: Create %d jobs", _PAPPL_BENCH_JOBS);
+
+  if ((printer = papplPrinterCreate(system, 0, "Get-Jobs Benchmark", "pwg_common-300dpi-black_1-sgray_8", "MFG:PWG;MDL:Office Printer;CMD:PWGRaster;", "file:///dev/null")) == NULL)
+  {
+    testEndMessage(false, "%s", strerror(errno));
+    return (false);
+  }
+
+  papplPrinterSetMaxCompletedJobs(printer, _PAPPL_BENCH_JOBS);
+
+  gettimeofday(&start, NULL);
+
+  for (i = 0; i < _PAPPL_BENCH_JOBS; i ++)
+  {
+    if ((job = _papplJobCreate(printer, 0, users[(i % 1000) == 0], "application/octet-stream", "Benchmark Job", NULL)) == NULL)
+    {
+      testEndMessage(false, "Unable to create job %d: %s", i + 1, strerror(errno));
+      goto done;
+    }
+
+    papplJobCancel(job);
+  }
+
+  gettimeofday(&end, NULL);
+  secs = end.tv_sec - start.tv_sec + 0.000001 * (end.tv_usec - start.tv_usec);
+
+  testEndMessage(true, "%.0f jobs/sec", _PAPPL_BENCH_JOBS / secs);
+
+  // Connect to the system...
+  testBegin("get-jobs: Connect to server");
+  if ((http = connect_to_printer(system, false, uri, sizeof(uri))) == NULL)
+  {
+    testEndMessage(false, "%s", cupsGetErrorString());
+    goto done;
+  }
+
+  testEnd(true);
+
+  papplPrinterGetPath(printer, NULL, resource, sizeof(resource));
+  httpAssembleURI(HTTP_URI_CODING_ALL, uri, sizeof(uri), "ipp", NULL, "localhost", papplSystemGetHostPort(system), resource);
+
+  // Time Get-Jobs requests...
+  for (i = 0; i < (int)(sizeof(tests) / sizeof(tests[0])); i ++)
+  {
+    testBegin("get-jobs: Get-Jobs(which-jobs=%s, my-jobs=%s, limit=%d)", tests[i].which_jobs, tests[i].username ? tests[i].username : "false", tests[i].limit);
+
+    gettimeofday(&start, NULL);
+
+    for (j = 0; j < _PAPPL_BENCH_REQUESTS; j ++)
+    {
+      request = ippNewRequest(IPP_OP_GET_JOBS);
+      ippAddString(request, IPP_TAG_OPERATION, IPP_TAG_URI, "printer-uri", NULL, uri);
+      ippAddString(request, IPP_TAG_OPERATION, IPP_TAG_NAME, "requesting-user-name", NULL, tests[i].username ? tests[i].username : cupsGetUser());
+      ippAddString(request, IPP_TAG_OPERATION, IPP_CONST_TAG(IPP_TAG_KEYWORD), "which-jobs", NULL, tests[i].which_jobs);
+      ippAddString(request, IPP_TAG_OPERATION, IPP_CONST_TAG(IPP_TAG_KEYWORD), "requested-attributes", NULL, "job-originating-user-name");
+      if (tests[i].username)
+        ippAddBoolean(request, IPP_TAG_OPERATION, "my-jobs", 1);
+      if (tests[i].limit)
+        ippAddInteger(request, IPP_TAG_OPERATION, IPP_TAG_INTEGER, "limit", tests[i].limit);
+
+      response = cupsDoRequest(http, request, resource);
+
+      if (cupsGetError() != IPP_STATUS_OK)
+      {
+        testEndMessage(false, "%s", cupsGetErrorString());
+        ippDelete(response);
+        goto done;
+      }
+
+      for (count = 0, attr = ippFindAttribute(response, "job-originating-user-name", IPP_TAG_NAME); attr; attr = ippFindNextAttribute(response, "job-originating-user-name", IPP_TAG_NAME))
+      {
+        count ++;
+
+        if (tests[i].username && strcmp(ippGetString(attr, 0, NULL), tests[i].username))
+        {
+          testEndMessage(false, "got job for '%s'", ippGetString(attr, 0, NULL));
+          ippDelete(response);
+          goto done;
+        }
+      }
+
+      ippDelete(response);
+
+      if (count != tests[i].expected)
+      {
+        testEndMessage(false, "got %d jobs, expected %d", count, tests[i].expected);
+        goto done;
+      }
+    }
+
+    gettimeofday(&end, NULL);
+    secs = end.tv_sec - start.tv_sec + 0.000001 * (end.tv_usec - start.tv_usec);
+
+    testEndMessage(true, "%.0f requests/sec", _PAPPL_BENCH_REQUESTS / secs);
+  }
+
+  ret = true;
+
+  // Clean up and return...
+  done:
+
+  httpClose(http);
+  papplPrinterDelete(printer);
+
+  return (ret);
+}
+
+
 #if defined(HAVE_LIBJPEG) || defined(HAVE_LIBPNG)
 //
 // 'test_image_files()' - Run image file tests.
@@ -3478,6 +4795,8 @@ test_image_files(
 		*response;		// Response
   int		job_id;			// "job-id" value
   ipp_jstate_t	job_state;		// "job-state" value
+  pappl_imetrics_t before,		// Image metrics before job
+		after;			// Image metrics after job
   static const int orients[] =		// "orientation-requested" values
   {
     IPP_ORIENT_NONE,
@@ -3531,6 +4850,8 @@ test_image_files(
 	    return (false);
 
 	  // Print the job...
+	  papplSystemGetImageMetrics(system, &before);
+
 	  snprintf(job_name, sizeof(job_name), "%s+%s+%s+%s", files[i], ippEnumString("orientation-requested", orients[j]), modes[k], scalings[m]);
 	  testBegin("%s: Print-Job(%s)", prompt, job_name);
 
@@ -3584,10 +4905,28 @@ test_image_files(
 
 	    job_state = (ipp_jstate_t)ippGetInteger(ippFindAttribute(response, "job-state", IPP_TAG_ENUM), 0);
 
-            testEndMessage(job_state != (ipp_jstate_t)0, "job-state=%d", job_state);
-	    ippDelete(response);
+            testEndMessage(job_state != (ipp_jstate_t)0, "job-state=%d", job_state);
+	    ippDelete(response);
+	  }
+	  while (job_state < IPP_JSTATE_CANCELED);
+
+	  if (orients[j] == IPP_ORIENT_REVERSE_PORTRAIT)
+	  {
+	    // The test images fit in a single band, so each one should only be
+	    // decoded once...
+	    testBegin("%s: Image reads(%s)", prompt, job_name);
+
+	    papplSystemGetImageMetrics(system, &after);
+
+	    if (after.images == before.images || (after.reads - before.reads) != (after.images - before.images))
+	    {
+	      testEndMessage(false, "got images=%lu, image_reads=%lu", (unsigned long)(after.images - before.images), (unsigned long)(after.reads - before.reads));
+	      httpClose(http);
+	      return (false);
+	    }
+
+	    testEndMessage(true, "image_reads=%lu, image_rows=%lu", (unsigned long)(after.reads - before.reads), (unsigned long)(after.rows - before.rows));
 	  }
-	  while (job_state < IPP_JSTATE_CANCELED);
 	}
       }
     }
@@ -3717,6 +5056,7 @@ test_pwg_raster(pappl_system_t *system)	// I - System
   int		i;			// Looping var
   int		job_id;			// "job-id" value
   ipp_jstate_t	job_state;		// "job-state" value
+  pappl_rsmetrics_t rsmetrics;		// Raster metrics
   static const char * const modes[] =	// "print-color-mode" values
   {
     "auto",
@@ -3837,6 +5177,16 @@ test_pwg_raster(pappl_system_t *system)	// I - System
     unlink(filename);
   }
 
+  // Make sure the print options were reused for the first page of each job...
+  testBegin("pwg-raster: papplSystemGetRasterMetrics");
+  papplSystemGetRasterMetrics(system, &rsmetrics);
+  if (rsmetrics.options == 0 || rsmetrics.options_reused == 0 || rsmetrics.buffers == 0)
+  {
+    testEndMessage(false, "raster_options=%u, raster_options_reused=%u, raster_buffers=%u", (unsigned)rsmetrics.options, (unsigned)rsmetrics.options_reused, (unsigned)rsmetrics.buffers);
+    goto done;
+  }
+  testEndMessage(true, "raster_options=%u, raster_options_reused=%u, raster_buffers=%u, raster_buffers_reused=%u", (unsigned)rsmetrics.options, (unsigned)rsmetrics.options_reused, (unsigned)rsmetrics.buffers, (unsigned)rsmetrics.buffers_reused);
+
   // If we complete the loop without errors, it is a successful run...
   ret = true;
 
@@ -3852,6 +5202,328 @@ test_pwg_raster(pappl_system_t *system)	// I - System
 }
 
 
+//
+// 'test_raw_socket()' - Test printing over a raw socket.
+//
+
+static bool				// O - `true` on success, `false` on failure
+test_raw_socket(pappl_system_t *system)	// I - System
+{
+  bool		ret = false;		// Return value
+  pappl_printer_t *printer,		// Default printer
+		*kprinter = NULL;	// Keep-alive printer
+  pappl_job_t	*job;			// Raw socket job
+  int		job_id,			// Job ID
+		recv_id;		// Job ID for kept-alive connection
+  http_addrlist_t *addrlist = NULL;	// Address list
+  int		sock = -1,		// Socket
+		fd;			// Print file
+  pappl_dcmetrics_t before,		// Device metrics before keep-alive jobs
+		after;			// Device metrics after keep-alive jobs
+  char		device_uri[1024],	// Keep-alive device URI
+		filename[1024];		// Keep-alive print file
+  char		service[32];		// Port number
+  size_t	i,			// Looping var
+		total = 0;		// Total bytes sent
+  ssize_t	bytes;			// Bytes sent
+  time_t	endtime;		// End time
+  ipp_jstate_t	job_state;		// Job state
+  char		buffer[65536];		// Print data
+
+
+  // Connect to the raw socket listener for the default printer...
+  testBegin("raw-socket: Connect to printer");
+
+  if ((printer = papplSystemFindPrinter(system, NULL, papplSystemGetDefaultPrinterID(system), NULL)) == NULL)
+  {
+    testEndMessage(false, "no default printer");
+    return (false);
+  }
+
+  snprintf(service, sizeof(service), "%d", 9099 + papplPrinterGetID(printer));
+
+  job_id = papplPrinterGetNextJobID(printer);
+
+  if ((addrlist = httpAddrGetList("localhost", AF_UNSPEC, service)) == NULL || !httpAddrConnect(addrlist, &sock, 30000, NULL))
+  {
+    testEndMessage(false, "Unable to connect to port %s: %s", service, cupsGetErrorString());
+    goto done;
+  }
+
+  testEndMessage(true, "port %s", service);
+
+  // Send more data than fits in the memory buffer...
+  testBegin("raw-socket: Send print data");
+
+  for (i = 0; i < sizeof(buffer); i ++)
+    buffer[i] = (char)(i & 255);
+
+  for (i = 0; i < 16; i ++)
+  {
+    if ((bytes = send(sock, buffer, sizeof(buffer), 0)) < 0)
+    {
+      testEndMessage(false, "%s", strerror(errno));
+      goto done;
+    }
+
+    total += (size_t)bytes;
+  }
+
+  close(sock);
+  sock = -1;
+
+  testEndMessage(true, "%u bytes", (unsigned)total);
+  output_count ++;
+
+  // Wait for the job to complete...
+  testBegin("raw-socket: Wait for job %d", job_id);
+
+  for (endtime = time(NULL) + 60, job_state = IPP_JSTATE_PENDING; time(NULL) < endtime; sleep(1))
+  {
+    if ((job = papplPrinterFindJob(printer, job_id)) != NULL && (job_state = papplJobGetState(job)) >= IPP_JSTATE_CANCELED)
+      break;
+  }
+
+  if (job_state != IPP_JSTATE_COMPLETED)
+  {
+    testEndMessage(false, "job-state=%d", job_state);
+    goto done;
+  }
+
+  testEnd(true);
+
+  // Print two jobs to a printer that uses the raw socket listener as its
+  // device and check that the second job reuses the connection...
+  testBegin("raw-socket: Device keep-alive");
+
+  httpAssembleURI(HTTP_URI_CODING_ALL, device_uri, sizeof(device_uri), "socket", NULL, "localhost", atoi(service), "/");
+
+  if ((kprinter = papplPrinterCreate(system, 0, "Keep-Alive Printer", "pwg_common-300dpi-black_1-sgray_8", "MFG:PWG;MDL:Office Printer;CMD:PWGRaster;", device_uri)) == NULL)
+  {
+    testEndMessage(false, "papplPrinterCreate returned NULL");
+    goto done;
+  }
+
+  papplPrinterSetDeviceKeepAlive(kprinter, 5);
+  papplSystemGetDeviceMetrics(system, &before);
+
+  recv_id = papplPrinterGetNextJobID(printer);
+
+  for (i = 0; i < 2; i ++)
+  {
+    // Job files in the temporary directory are removed when the job is done...
+    snprintf(filename, sizeof(filename), "%s/testpappl-keepalive%u.pwg", papplGetTempDir(), (unsigned)i);
+
+    if ((fd = open(filename, O_WRONLY | O_CREAT | O_TRUNC, 0600)) < 0 || write(fd, buffer, 1024) < 1024)
+    {
+      testEndMessage(false, "%s: %s", filename, strerror(errno));
+
+      if (fd >= 0)
+        close(fd);
+      goto done;
+    }
+
+    close(fd);
+
+    if ((job = _papplJobCreate(kprinter, 0, "test-user", "image/pwg-raster", "Keep-Alive Job", NULL)) == NULL)
+    {
+      testEndMessage(false, "_papplJobCreate returned NULL");
+      unlink(filename);
+      goto done;
+    }
+
+    job_id = papplJobGetID(job);
+
+    _papplJobSubmitFile(job, filename);
+
+    for (endtime = time(NULL) + 60, job_state = IPP_JSTATE_PENDING; time(NULL) < endtime; usleep(100000))
+    {
+      if ((job = papplPrinterFindJob(kprinter, job_id)) != NULL && (job_state = papplJobGetState(job)) >= IPP_JSTATE_CANCELED)
+        break;
+    }
+
+    if (job_state != IPP_JSTATE_COMPLETED)
+    {
+      testEndMessage(false, "job %d: job-state=%d", job_id, job_state);
+      goto done;
+    }
+  }
+
+  papplSystemGetDeviceMetrics(system, &after);
+
+  if ((after.reuses - before.reuses) != 1)
+  {
+    testEndMessage(false, "got %lu reuses, expected 1", (unsigned long)(after.reuses - before.reuses));
+    goto done;
+  }
+
+  testEndMessage(true, "%lu reuses", (unsigned long)(after.reuses - before.reuses));
+
+  // Then wait for the housekeeping to close the idle connection, which also
+  // completes the job on the default printer...
+  testBegin("raw-socket: Device idle close");
+
+  for (endtime = time(NULL) + 30; time(NULL) < endtime; sleep(1))
+  {
+    papplSystemGetDeviceMetrics(system, &after);
+
+    if (after.idle_closes > before.idle_closes)
+      break;
+  }
+
+  if ((after.idle_closes - before.idle_closes) != 1)
+  {
+    testEndMessage(false, "got %lu idle closes, expected 1", (unsigned long)(after.idle_closes - before.idle_closes));
+    goto done;
+  }
+
+  output_count ++;
+
+  for (endtime = time(NULL) + 60, job_state = IPP_JSTATE_PENDING; time(NULL) < endtime; sleep(1))
+  {
+    if ((job = papplPrinterFindJob(printer, recv_id)) != NULL && (job_state = papplJobGetState(job)) >= IPP_JSTATE_CANCELED)
+      break;
+  }
+
+  if (job_state != IPP_JSTATE_COMPLETED)
+  {
+    testEndMessage(false, "job %d: job-state=%d", recv_id, job_state);
+    goto done;
+  }
+
+  testEndMessage(true, "%lu idle closes", (unsigned long)(after.idle_closes - before.idle_closes));
+
+  ret = true;
+
+  done:
+
+  if (sock >= 0)
+    close(sock);
+
+  if (kprinter)
+    papplPrinterDelete(kprinter);
+
+  httpAddrFreeList(addrlist);
+
+  return (ret);
+}
+
+
+//
+// 'test_save_state()' - Benchmark saving the state with a large number of
+//                       retained jobs.
+//
+
+static bool				// O - `true` on success, `false` on failure
+test_save_state(pappl_system_t *system)	// I - System
+{
+  bool		ret = false;		// Return value
+  pappl_printer_t *printer;		// Benchmark printer
+  pappl_job_t	*job;			// Current job
+  int		i;			// Looping var
+  struct stat	fileinfo;		// State/journal file information
+  struct timeval start,			// Start time
+		end;			// End time
+  double	secs;			// Elapsed seconds
+
+
+  // Create a printer with lots of completed jobs...
+  testBegin("save-state: Create %d jobs", _PAPPL_BENCH_JOBS);
+
+  if ((printer = papplPrinterCreate(system, 0, "Save-State Benchmark", "pwg_common-300dpi-black_1-sgray_8", "MFG:PWG;MDL:Office Printer;CMD:PWGRaster;", "file:///dev/null")) == NULL)
+  {
+    testEndMessage(false, "%s", strerror(errno));
+    return (false);
+  }
+
+  papplPrinterSetMaxCompletedJobs(printer, _PAPPL_BENCH_JOBS + _PAPPL_BENCH_REQUESTS);
+
+  for (i = 0; i < _PAPPL_BENCH_JOBS; i ++)
+  {
+    if ((job = _papplJobCreate(printer, 0, "bench-user", "application/octet-stream", "Benchmark Job", NULL)) == NULL)
+    {
+      testEndMessage(false, "Unable to create job %d: %s", i + 1, strerror(errno));
+      goto done;
+    }
+
+    papplJobCancel(job);
+  }
+
+  testEnd(true);
+
+  // Time rewriting the whole state file...
+  testBegin("save-state: Write state file");
+
+  gettimeofday(&start, NULL);
+
+  for (i = 0; i < _PAPPL_BENCH_SAVES; i ++)
+  {
+    pthread_mutex_lock(&system->config_mutex);
+    system->state_compact = true;
+    pthread_mutex_unlock(&system->config_mutex);
+
+    if (!papplSystemSaveState(system, "testpappl.state"))
+    {
+      testEndMessage(false, "Unable to save state");
+      goto done;
+    }
+  }
+
+  gettimeofday(&end, NULL);
+  secs = end.tv_sec - start.tv_sec + 0.000001 * (end.tv_usec - start.tv_usec);
+
+  if (stat("testpappl.state", &fileinfo))
+  {
+    testEndMessage(false, "testpappl.state: %s", strerror(errno));
+    goto done;
+  }
+
+  testEndMessage(true, "%.1f saves/sec, %ld bytes", _PAPPL_BENCH_SAVES / secs, (long)fileinfo.st_size);
+
+  // Time appending single job changes to the journal...
+  testBegin("save-state: Append to journal");
+
+  gettimeofday(&start, NULL);
+
+  for (i = 0; i < _PAPPL_BENCH_REQUESTS; i ++)
+  {
+    if ((job = _papplJobCreate(printer, 0, "bench-user", "application/octet-stream", "Benchmark Job", NULL)) == NULL)
+    {
+      testEndMessage(false, "Unable to create job %d: %s", i + 1, strerror(errno));
+      goto done;
+    }
+
+    papplJobCancel(job);
+
+    if (!papplSystemSaveState(system, "testpappl.state"))
+    {
+      testEndMessage(false, "Unable to save state");
+      goto done;
+    }
+  }
+
+  gettimeofday(&end, NULL);
+  secs = end.tv_sec - start.tv_sec + 0.000001 * (end.tv_usec - start.tv_usec);
+
+  if (stat("testpappl.state.journal", &fileinfo))
+  {
+    testEndMessage(false, "testpappl.state.journal: %s", strerror(errno));
+    goto done;
+  }
+
+  testEndMessage(true, "%.0f saves/sec, %ld bytes", _PAPPL_BENCH_REQUESTS / secs, (long)fileinfo.st_size);
+
+  ret = true;
+
+  // Clean up and return...
+  done:
+
+  papplPrinterDelete(printer);
+
+  return (ret);
+}
+
+
 //
 // 'test_wifi_join_cb()' - Try joining a Wi-Fi network.
 //
@@ -4179,6 +5851,107 @@ test_wifi_status_cb(
 }
 
 
+//
+// 'test_worker_pool()' - Test the client worker pool.
+//
+
+static bool				// O - `true` on success, `false` on failure
+test_worker_pool(pappl_system_t *system)// I - System
+{
+  bool		ret = false;		// Return value
+  http_t	*http[8];		// HTTP connections
+  char		uri[1024],		// "printer-uri" value
+		buffer[8192];		// Response buffer
+  size_t	i,			// Looping var
+		max_queue;		// Maximum number of queued requests
+  http_status_t	status;			// HTTP status
+  pappl_cmetrics_t before,		// Client metrics before requests
+		after;			// Client metrics after requests
+
+
+  memset(http, 0, sizeof(http));
+
+  testBegin("worker-pool: Start");
+  if (!(papplSystemGetOptions(system) & PAPPL_SOPTIONS_WORKER_POOL))
+  {
+    testEndMessage(false, "worker pool not enabled");
+    return (false);
+  }
+
+  testEndMessage(true, "%lu workers", (unsigned long)papplSystemGetWorkerPool(system, &max_queue));
+
+  // Send more simultaneous requests than there are workers and queue entries...
+  testBegin("worker-pool: Queue full");
+
+  papplSystemGetClientMetrics(system, &before);
+
+  for (i = 0; i < (sizeof(http) / sizeof(http[0])); i ++)
+  {
+    if ((http[i] = connect_to_printer(system, false, uri, sizeof(uri))) == NULL || httpGet(http[i], "/"))
+    {
+      testEndMessage(false, "%s", cupsGetErrorString());
+      goto done;
+    }
+  }
+
+  for (i = 0; i < (sizeof(http) / sizeof(http[0])); i ++)
+  {
+    while ((status = httpUpdate(http[i])) == HTTP_STATUS_CONTINUE);
+
+    while (httpRead(http[i], buffer, sizeof(buffer)) > 0);
+
+    if (status != HTTP_STATUS_OK)
+    {
+      testEndMessage(false, "request %u: %s", (unsigned)i + 1, httpStatusString(status));
+      goto done;
+    }
+  }
+
+  papplSystemGetClientMetrics(system, &after);
+
+  if ((after.requests - before.requests) < (sizeof(http) / sizeof(http[0])) || after.max_queued > max_queue)
+  {
+    testEndMessage(false, "got requests=%lu, max_queued=%lu, expected requests>=%lu, max_queued<=%lu", (unsigned long)(after.requests - before.requests), (unsigned long)after.max_queued, (unsigned long)(sizeof(http) / sizeof(http[0])), (unsigned long)max_queue);
+    goto done;
+  }
+
+  testEndMessage(true, "requests=%lu, max_queued=%lu, deferred=%lu", (unsigned long)(after.requests - before.requests), (unsigned long)after.max_queued, (unsigned long)(after.deferred - before.deferred));
+
+  // Then wait for the idle connections to be closed...
+  testBegin("worker-pool: Idle expiry");
+
+  sleep(_PAPPL_POOL_TIMEOUT + 2);
+
+  papplSystemGetClientMetrics(system, &after);
+
+  if (after.idle_clients != 0)
+  {
+    testEndMessage(false, "got idle_clients=%lu, expected 0", (unsigned long)after.idle_clients);
+    goto done;
+  }
+
+  for (i = 0; i < (sizeof(http) / sizeof(http[0])); i ++)
+  {
+    if (recv(httpGetFd(http[i]), buffer, 1, MSG_DONTWAIT) != 0)
+    {
+      testEndMessage(false, "connection %u not closed", (unsigned)i + 1);
+      goto done;
+    }
+  }
+
+  testEnd(true);
+
+  ret = true;
+
+  done:
+
+  for (i = 0; i < (sizeof(http) / sizeof(http[0])); i ++)
+    httpClose(http[i]);
+
+  return (ret);
+}
+
+
 //
 // 'timer_cb()' - Timer callback.
 //
@@ -4200,6 +5973,22 @@ timer_cb(pappl_system_t    *system,	// I - System
 }
 
 
+//
+// 'timer_once_cb()' - One-shot timer callback.
+//
+
+static bool				// O - `true` to continue, `false` to stop
+timer_once_cb(pappl_system_t *system,	// I - System
+              int            *count)	// I - Call count
+{
+  (void)system;
+
+  (*count) ++;
+
+  return (true);
+}
+
+
 //
 // 'usage()' - Show usage.
 //
@@ -4218,6 +6007,7 @@ usage(int status)			// I - Exit status
   puts("  --no-tls                   Do not support TLS");
   puts("  --ps-query DEVICE-URI      Do a PostScript query to get the product string.");
   puts("  --version                  Show version");
+  puts("  --worker-pool              Use a client worker pool");
   puts("  -1                         Single queue");
   puts("  -A PAM-SERVICE             Enable authentication using PAM service");
   puts("  -c                         Do a clean run (no loading of state)");
@@ -4237,6 +6027,12 @@ usage(int status)			// I - Exit status
   puts("  jpeg                 JPEG image tests");
   puts("  png                  PNG image tests");
   puts("  pwg-raster           PWG Raster tests");
+  puts("  raw-socket           Raw socket printing tests");
+  puts("  worker-pool          Client worker pool tests");
+  puts("");
+  puts("Benchmarks:");
+  puts("  get-jobs             Get-Jobs with 100000 retained jobs");
+  puts("  save-state           Save state with 100000 retained jobs");
 
   return (status);
 }
@@ -143,6 +143,10 @@ typedef unsigned long useconds_t;
 #define HAVE_LIBPNG 1
 
 
+// zlib
+#define HAVE_LIBZ 1
+
+
 // libusb
 /* #undef HAVE_LIBUSB */
 
@@ -157,6 +161,18 @@ typedef unsigned long useconds_t;
 /* #undef HAVE_STRLCPY */
 
 
+// Event notification support
+/* #undef HAVE_SYS_EPOLL_H */
+
+
+// Lock contention profiling
+/* #undef PAPPL_LOCK_PROFILE */
+
+
+// Atomic operation support
+/* #undef HAVE_STDATOMIC_H */
+
+
 // Random number support
 /* #undef HAVE_SYS_RANDOM_H */
 /* #undef HAVE_ARC4RANDOM */
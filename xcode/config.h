@@ -44,6 +44,10 @@
 #define HAVE_LIBPNG 1
 
 
+// zlib
+#define HAVE_LIBZ 1
+
+
 // libusb
 #define HAVE_LIBUSB 1
 
@@ -58,6 +62,18 @@
 #define HAVE_STRLCPY 1
 
 
+// Event notification support
+/* #undef HAVE_SYS_EPOLL_H */
+
+
+// Lock contention profiling
+/* #undef PAPPL_LOCK_PROFILE */
+
+
+// Atomic operation support
+#define HAVE_STDATOMIC_H 1
+
+
 // Random number support
 #define HAVE_SYS_RANDOM_H 1
 #define HAVE_ARC4RANDOM 1